@@ -103,6 +103,7 @@
  */
 #include <linux/seq_file.h>
 #include <linux/log2.h>
+#include <linux/rculist.h>
 
 #include <libcfs/linux/linux-list.h>
 #include <libcfs/libcfs.h>
@@ -278,6 +279,10 @@ cfs_hash_lock_setup(struct cfs_hash *hs)
 /**
  * Simple hash head without depth tracking
  * new element is always added to head of hlist
+ *
+ * Elements are added and removed with the RCU list primitives, so that
+ * a table which is never rehashed can be walked under rcu_read_lock(),
+ * provided that the elements are freed after a grace period.
  */
 struct cfs_hash_head {
 	struct hlist_head	hh_head;	/**< entries list */
@@ -302,7 +307,7 @@ static int
 cfs_hash_hh_hnode_add(struct cfs_hash *hs, struct cfs_hash_bd *bd,
 		      struct hlist_node *hnode)
 {
-	hlist_add_head(hnode, cfs_hash_hh_hhead(hs, bd));
+	hlist_add_head_rcu(hnode, cfs_hash_hh_hhead(hs, bd));
 	return -1; /* unknown depth */
 }
 
@@ -310,13 +315,13 @@ static int
 cfs_hash_hh_hnode_del(struct cfs_hash *hs, struct cfs_hash_bd *bd,
 		      struct hlist_node *hnode)
 {
-	hlist_del_init(hnode);
+	hlist_del_init_rcu(hnode);
 	return -1; /* unknown depth */
 }
 
 /**
  * Simple hash head with depth tracking
- * new element is always added to head of hlist
+ * new element is always added to head of hlist, RCU-safe as above
  */
 struct cfs_hash_head_dep {
 	struct hlist_head	hd_head;	/**< entries list */
@@ -346,7 +351,7 @@ cfs_hash_hd_hnode_add(struct cfs_hash *hs, struct cfs_hash_bd *bd,
 
 	hh = container_of(cfs_hash_hd_hhead(hs, bd),
 			  struct cfs_hash_head_dep, hd_head);
-	hlist_add_head(hnode, &hh->hd_head);
+	hlist_add_head_rcu(hnode, &hh->hd_head);
 	return ++hh->hd_depth;
 }
 
@@ -358,7 +363,7 @@ cfs_hash_hd_hnode_del(struct cfs_hash *hs, struct cfs_hash_bd *bd,
 
 	hh = container_of(cfs_hash_hd_hhead(hs, bd),
 			  struct cfs_hash_head_dep, hd_head);
-	hlist_del_init(hnode);
+	hlist_del_init_rcu(hnode);
 	return --hh->hd_depth;
 }
 
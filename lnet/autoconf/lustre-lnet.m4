@@ -781,6 +781,52 @@ kern_sock_getname_2args, [
 EXTRA_KCFLAGS="$tmp_flags"
 ]) # LN_CONFIG_SOCK_GETNAME
 
+#
+# LN_CONFIG_SK_BUSY_LOOP
+#
+# kernel 3.11 commit 076bb0c82a44fbe46fe2c8527a5b5b64b69f679d
+# net: rename include/net/ll_poll.h to include/net/busy_poll.h
+# sk_busy_loop() lets a socket user poll the device queue of the socket
+#
+AC_DEFUN([LN_CONFIG_SK_BUSY_LOOP], [
+tmp_flags="$EXTRA_KCFLAGS"
+EXTRA_KCFLAGS="-Werror"
+LB_CHECK_COMPILE([if 'sk_busy_loop' exists],
+sk_busy_loop, [
+	#include <net/busy_poll.h>
+],[
+	sk_busy_loop(NULL, 1);
+],[
+	AC_DEFINE(HAVE_SK_BUSY_LOOP, 1,
+		['sk_busy_loop' exists])
+])
+EXTRA_KCFLAGS="$tmp_flags"
+]) # LN_CONFIG_SK_BUSY_LOOP
+
+#
+# LN_CONFIG_SK_INCOMING_CPU
+#
+# kernel 3.19 commit 2c8c56e15df3d4c2af3d656e44feb18789f75837
+# net: introduce SO_INCOMING_CPU
+# records the CPU the packets of a socket were last received on
+#
+AC_DEFUN([LN_CONFIG_SK_INCOMING_CPU], [
+tmp_flags="$EXTRA_KCFLAGS"
+EXTRA_KCFLAGS="-Werror"
+LB_CHECK_COMPILE([if 'struct sock' has 'sk_incoming_cpu'],
+sk_incoming_cpu, [
+	#include <net/sock.h>
+],[
+	struct sock sk = { .sk_incoming_cpu = 0 };
+
+	(void)sk;
+],[
+	AC_DEFINE(HAVE_SK_INCOMING_CPU, 1,
+		['struct sock' has 'sk_incoming_cpu'])
+])
+EXTRA_KCFLAGS="$tmp_flags"
+]) # LN_CONFIG_SK_INCOMING_CPU
+
 #
 # LN_HAVE_IN_DEV_FOR_EACH_IFA_RTNL
 #
@@ -895,8 +941,12 @@ LN_CONFIG_GNILND
 LN_CONFIG_STRSCPY_EXISTS
 # 3.10
 LN_EXPORT_KMAP_TO_PAGE
+# 3.11
+LN_CONFIG_SK_BUSY_LOOP
 # 3.15
 LN_CONFIG_SK_DATA_READY
+# 3.19
+LN_CONFIG_SK_INCOMING_CPU
 # 4.x
 LN_CONFIG_SOCK_CREATE_KERN
 # 4.14
@@ -38,6 +38,7 @@
 
 /* LNET has 0xeXXX */
 #define CFS_FAIL_PTLRPC_OST_BULK_CB2	0xe000
+#define CFS_FAIL_LNET_RTRBUF_WAIT	0xe001
 
 #include <linux/netdevice.h>
 
@@ -474,13 +475,22 @@ lnet_rspt_alloc(int cpt)
 	return rspt;
 }
 
+void lnet_stripe_get_done_locked(struct lnet_nid *ni_nid, unsigned int nob,
+				 int cpt, bool replied);
+
 static inline void
 lnet_rspt_free(struct lnet_rsp_tracker *rspt, int cpt)
 {
+	struct lnet_nid ni_nid = rspt->rspt_local_nid;
+	unsigned int stripe_nob = rspt->rspt_stripe_nob;
+
 	CDEBUG(D_MALLOC, "rspt free %p\n", rspt);
 
 	kmem_cache_free(lnet_rspt_cachep, rspt);
 	lnet_net_lock(cpt);
+	/* the REPLY of the striped GET did not arrive */
+	if (stripe_nob)
+		lnet_stripe_get_done_locked(&ni_nid, stripe_nob, cpt, false);
 	the_lnet.ln_counters[cpt]->lct_health.lch_rst_alloc--;
 	lnet_net_unlock(cpt);
 }
@@ -527,6 +537,7 @@ extern int lnet_cpt_of_nid(lnet_nid_t nid, struct lnet_ni *ni);
 extern int lnet_nid2cpt(struct lnet_nid *nid, struct lnet_ni *ni);
 extern struct lnet_ni *lnet_nid2ni_locked(lnet_nid_t nid, int cpt);
 extern struct lnet_ni *lnet_nid2ni_addref(lnet_nid_t nid);
+extern struct lnet_ni *lnet_nid_to_ni_locked(struct lnet_nid *nid, int cpt);
 extern struct lnet_ni *lnet_net2ni_locked(__u32 net, int cpt);
 extern struct lnet_ni *lnet_net2ni_addref(__u32 net);
 extern struct lnet_ni *lnet_nid_to_ni_addref(struct lnet_nid *nid);
@@ -543,6 +554,7 @@ extern unsigned int lnet_numa_range;
 extern unsigned int lnet_health_sensitivity;
 extern unsigned int lnet_recovery_interval;
 extern unsigned int lnet_recovery_limit;
+extern unsigned int lnet_bulk_stripe;
 extern unsigned int lnet_peer_discovery_disabled;
 extern unsigned int lnet_drop_asym_route;
 extern unsigned int router_sensitivity_percentage;
@@ -594,6 +606,11 @@ void lnet_router_debugfs_fini(void);
 int  lnet_rtrpools_alloc(int im_a_router);
 void lnet_destroy_rtrbuf(struct lnet_rtrbuf *rb, int npages);
 int  lnet_rtrpools_adjust(int tiny, int small, int large);
+void lnet_rtrpools_auto_adjust(void);
+/* how often router buffer pools are auto-sized, in seconds */
+#define LNET_RTRPOOL_AUTO_INTERVAL	10
+/* most memory auto-sizing allocates for router buffers at a time, in MB */
+#define LNET_RTRPOOL_AUTO_GROW_MAX	64
 int lnet_rtrpools_enable(void);
 void lnet_rtrpools_disable(void);
 void lnet_rtrpools_free(int keep_pools);
@@ -937,7 +954,8 @@ int lnet_peer_add_pref_rtr(struct lnet_peer_ni *lpni, lnet_nid_t nid);
 int lnet_peer_ni_set_non_mr_pref_nid(struct lnet_peer_ni *lpni, lnet_nid_t nid);
 int lnet_add_peer_ni(lnet_nid_t key_nid, lnet_nid_t nid, bool mr, bool temp);
 int lnet_del_peer_ni(lnet_nid_t key_nid, lnet_nid_t nid);
-int lnet_get_peer_info(struct lnet_ioctl_peer_cfg *cfg, void __user *bulk);
+int lnet_get_peer_info(struct lnet_ioctl_peer_cfg *cfg, void __user *bulk,
+		       bool perf);
 int lnet_get_peer_ni_info(__u32 peer_index, __u64 *nid,
 			  char alivness[LNET_MAX_STR_LEN],
 			  __u32 *cpt_iter, __u32 *refcount,
@@ -91,8 +91,14 @@ struct lnet_rsp_tracker {
 	int rspt_cpt;
 	/* nid of next hop */
 	struct lnet_nid rspt_next_hop_nid;
+	/* local NI the message was sent from */
+	struct lnet_nid rspt_local_nid;
+	/* payload of a striped GET accounted in ni_stripe_qnob of that NI */
+	unsigned int rspt_stripe_nob;
 	/* deadline of the REPLY/ACK */
 	ktime_t rspt_deadline;
+	/* when the message was sent to the next hop */
+	ktime_t rspt_sent;
 	/* parent MD */
 	struct lnet_handle_md rspt_mdh;
 };
@@ -121,6 +127,9 @@ struct lnet_msg {
 	 */
 	ktime_t			msg_deadline;
 
+	/* when the message started waiting for a router buffer */
+	ktime_t			msg_rtrbuf_wait;
+
 	/* The message health status. */
 	enum lnet_msg_hstatus	msg_health_status;
 	/* This is a recovery message */
@@ -159,6 +168,8 @@ struct lnet_msg {
 	unsigned int          msg_peerrtrcredit:1; /* taken a peer router credit */
 	unsigned int          msg_onactivelist:1; /* on the activelist */
 	unsigned int	      msg_rdma_get:1;
+	/* striped over the rails of a multi-rail peer */
+	unsigned int	      msg_stripe:1;
 
 	struct lnet_peer_ni  *msg_txpeer;         /* peer I'm sending to */
 	struct lnet_peer_ni  *msg_rxpeer;         /* peer I received from */
@@ -171,6 +182,8 @@ struct lnet_msg {
 
 	unsigned int          msg_len;
 	unsigned int          msg_wanted;
+	/* payload accounted in ni_stripe_qnob of msg_txni */
+	unsigned int          msg_stripe_nob;
 	unsigned int          msg_offset;
 	unsigned int          msg_niov;
 	struct bio_vec	     *msg_kiov;
@@ -369,6 +382,21 @@ struct lnet_element_stats {
 	struct lnet_comm_count el_send_stats;
 	struct lnet_comm_count el_recv_stats;
 	struct lnet_comm_count el_drop_stats;
+	atomic64_t el_send_bytes;
+	atomic64_t el_recv_bytes;
+};
+
+/*
+ * Goodput of an NI or peer NI, sampled over the intervals it is kept busy
+ * sending, see lnet_goodput_done()
+ */
+struct lnet_goodput {
+	/* smoothed goodput in bytes/s, 0 until measured */
+	__u64		lg_rate;
+	/* start of the current sampling interval, in ns */
+	atomic64_t	lg_start;
+	/* bytes sent since lg_start */
+	atomic64_t	lg_bytes;
 };
 
 struct lnet_health_local_stats {
@@ -527,6 +555,20 @@ struct lnet_ni {
 	/* the relative selection priority of this NI */
 	__u32			ni_sel_priority;
 
+	/* bytes of the striped messages in flight over this NI */
+	atomic64_t		ni_stripe_qnob;
+	/* striped messages sent over this NI */
+	atomic64_t		ni_stripe_count;
+	/* measured bandwidth of the striped traffic */
+	struct lnet_goodput	ni_stripe_bw;
+
+	/* bytes of all the messages in flight over this NI */
+	atomic64_t		ni_txqnob;
+	/* goodput of the messages sent over this NI */
+	struct lnet_goodput	ni_goodput;
+	/* smoothed round-trip time of its REPLY/ACK, in usecs */
+	__u32			ni_rtt;
+
 	/*
 	 * equivalent interface to use
 	 */
@@ -594,6 +636,10 @@ struct lnet_peer_ni {
 	int			lpni_minrtrcredits;
 	/* bytes queued for sending */
 	long			lpni_txqnob;
+	/* goodput of the messages sent to the peer NI */
+	struct lnet_goodput	lpni_goodput;
+	/* smoothed round-trip time of its REPLY/ACK, in usecs */
+	__u32			lpni_rtt;
 	/* network peer is on */
 	struct lnet_net		*lpni_net;
 	/* peer's NID */
@@ -913,6 +959,9 @@ struct lnet_remotenet {
 /** lnet message is waiting for discovery */
 #define LNET_DC_WAIT		2
 
+/* router buffer wait histogram buckets: < 2us, < 4us, ... >= 1s */
+#define LNET_RTRPOOL_WAIT_BUCKETS	21
+
 struct lnet_rtrbufpool {
 	/* my free buffer pool */
 	struct list_head	rbp_bufs;
@@ -928,6 +977,12 @@ struct lnet_rtrbufpool {
 	int			rbp_credits;
 	/* low water mark */
 	int			rbp_mincredits;
+	/* low water mark since the pool was last auto-sized */
+	int			rbp_win_mincredits;
+	/* # messages which waited for a buffer */
+	__u64			rbp_nwaits;
+	/* their wait times, by power of 2 of usecs */
+	__u64			rbp_wait_hist[LNET_RTRPOOL_WAIT_BUCKETS];
 };
 
 struct lnet_rtrbuf {
@@ -1209,6 +1264,8 @@ struct lnet {
 	struct semaphore		ln_mt_signal;
 
 	struct mutex			ln_api_mutex;
+	/* serialise router buffer pool resizing, nests in ln_api_mutex */
+	struct mutex			ln_rtrpool_mutex;
 	struct mutex			ln_lnd_mutex;
 	/* Have I called LNetNIInit myself? */
 	int				ln_niinit_self;
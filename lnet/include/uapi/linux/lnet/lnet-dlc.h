@@ -213,6 +213,16 @@ struct lnet_ioctl_peer_ni_hstats {
 	__u64 hlpni_next_ping;
 };
 
+/*
+ * Measured performance of a peer NI, following its hstats in the bulk of
+ * IOC_LIBCFS_GET_PEER_NI when LNET_PEER_CFG_F_PERF is requested
+ */
+struct lnet_ioctl_peer_ni_perf {
+	__u32 ipp_rtt;			/* usecs */
+	__u32 ipp_padding;
+	__u64 ipp_goodput;		/* bytes/s */
+};
+
 struct lnet_ioctl_element_msg_stats {
 	struct libcfs_ioctl_hdr im_hdr;
 	__u32 im_idx;
@@ -221,6 +231,24 @@ struct lnet_ioctl_element_msg_stats {
 	struct lnet_ioctl_comm_count im_drop_stats;
 };
 
+/*
+ * Traffic of a local NI, of the messages striped over it, and its measured
+ * round-trip time and goodput
+ */
+struct lnet_ioctl_rail_stats {
+	struct libcfs_ioctl_hdr irs_hdr;
+	__u32 irs_idx;
+	__u32 irs_padding;
+	lnet_nid_t irs_nid;
+	__u64 irs_send_bytes;
+	__u64 irs_recv_bytes;
+	__u64 irs_stripe_count;
+	__u64 irs_stripe_inflight;
+	__u64 irs_stripe_bw;		/* bytes/s */
+	__u64 irs_rtt;			/* usecs */
+	__u64 irs_goodput;		/* bytes/s */
+};
+
 /*
  * lnet_ioctl_config_ni
  *  This structure describes an NI configuration. There are multiple components
@@ -277,8 +305,17 @@ struct lnet_ioctl_peer_cfg {
 	__u32 prcfg_state;
 	__u32 prcfg_size;
 	void __user *prcfg_bulk;
+	/*
+	 * Only used if prcfg_hdr.ioc_len covers it, older tools pass the
+	 * structure without it
+	 */
+	__u32 prcfg_flags;		/* LNET_PEER_CFG_F_* */
+	__u32 prcfg_padding;
 };
 
+/* IOC_LIBCFS_GET_PEER_NI: append a lnet_ioctl_peer_ni_perf per peer NI */
+#define LNET_PEER_CFG_F_PERF	0x1
+
 struct lnet_ioctl_reset_health_cfg {
 	struct libcfs_ioctl_hdr rh_hdr;
 	enum lnet_health_type rh_type:32;
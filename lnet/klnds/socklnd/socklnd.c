@@ -1072,6 +1072,19 @@ ksocknal_create_conn(struct lnet_ni *ni, struct ksock_conn_cb *conn_cb,
 	peer_ni->ksnp_send_keepalive = 0;
 	peer_ni->ksnp_error = 0;
 
+	/* Schedule the conn on the CPT its packets are received on, so that
+	 * its receive processing stays local to the device queue. */
+	if (*ksocknal_tunables.ksnd_sched_affinity) {
+		int cpu = ksocknal_lib_rx_cpu(conn);
+
+		if (cpu >= 0 && cpu < nr_cpu_ids) {
+			int rx_cpt = cfs_cpt_of_cpu(lnet_cpt_table(), cpu);
+
+			if (rx_cpt >= 0)
+				cpt = rx_cpt;
+		}
+	}
+
 	sched = ksocknal_choose_scheduler_locked(cpt);
 	if (!sched) {
 		CERROR("no schedulers available. node is unhealthy\n");
@@ -2502,8 +2515,54 @@ fail_0:
 	return -ENETDOWN;
 }
 
+DEFINE_PER_CPU(struct ksock_rx_stats, ksocknal_rx_stats);
+
+static int ksocknal_proc_rx_stats(struct ctl_table *table, int write,
+				  void __user *buffer, size_t *lenp,
+				  loff_t *ppos)
+{
+	struct ksock_rx_stats *stats;
+	char tmpstr[64]; /* 2 u64 */
+	u64 direct = 0;
+	u64 recvmsg = 0;
+	int len;
+	int cpu;
+
+	for_each_possible_cpu(cpu) {
+		stats = per_cpu_ptr(&ksocknal_rx_stats, cpu);
+		if (write) {
+			stats->ksrs_direct_nob = 0;
+			stats->ksrs_recvmsg_nob = 0;
+		} else {
+			direct += READ_ONCE(stats->ksrs_direct_nob);
+			recvmsg += READ_ONCE(stats->ksrs_recvmsg_nob);
+		}
+	}
+
+	if (write)
+		return 0;
+
+	len = scnprintf(tmpstr, sizeof(tmpstr), "direct: %llu\nrecvmsg: %llu",
+			direct, recvmsg);
+
+	if (*ppos >= len)
+		return 0;
+
+	return cfs_trace_copyout_string(buffer, *lenp, tmpstr + *ppos, "\n");
+}
+
+static struct ctl_table ksocknal_debugfs_table[] = {
+	{
+		.procname	= "socklnd_rx_stats",
+		.mode		= 0644,
+		.proc_handler	= &ksocknal_proc_rx_stats,
+	},
+	{ .procname = NULL }
+};
+
 static void __exit ksocklnd_exit(void)
 {
+	lnet_remove_debugfs(ksocknal_debugfs_table);
 	lnet_unregister_lnd(&the_ksocklnd);
 }
 
@@ -2531,6 +2590,7 @@ static int __init ksocklnd_init(void)
 		return rc;
 
 	lnet_register_lnd(&the_ksocklnd);
+	lnet_insert_debugfs(ksocknal_debugfs_table);
 
 	return 0;
 }
@@ -42,6 +42,7 @@
 #include <linux/mm.h>
 #include <linux/module.h>
 #include <linux/pagemap.h>
+#include <linux/percpu.h>
 #include <linux/refcount.h>
 #include <linux/stat.h>
 #include <linux/string.h>
@@ -102,8 +103,18 @@ struct ksock_sched {
 	int kss_nthreads;
 	/* CPT id */
 	int kss_cpt;
+	/* a thread is busy-polling, no need to wake one up */
+	int kss_busy_polling;
 };
 
+/* payload bytes received through read_sock and recvmsg, per CPU */
+struct ksock_rx_stats {
+	u64			ksrs_direct_nob;
+	u64			ksrs_recvmsg_nob;
+};
+
+DECLARE_PER_CPU(struct ksock_rx_stats, ksocknal_rx_stats);
+
 #define KSOCK_CPT_SHIFT			16
 #define KSOCK_THREAD_ID(cpt, sid)	(((cpt) << KSOCK_CPT_SHIFT) | (sid))
 #define KSOCK_THREAD_CPT(id)		((id) >> KSOCK_CPT_SHIFT)
@@ -148,6 +159,7 @@ struct ksock_tunables {
         unsigned int     *ksnd_zc_min_payload;  /* minimum zero copy payload size */
         int              *ksnd_zc_recv;         /* enable ZC receive (for Chelsio TOE) */
         int              *ksnd_zc_recv_min_nfrags; /* minimum # of fragments to enable ZC receive */
+	int		 *ksnd_rx_direct;	/* rx payload via read_sock */
         int              *ksnd_irq_affinity;    /* enable IRQ affinity? */
 #ifdef SOCKNAL_BACKOFF
         int              *ksnd_backoff_init;    /* initial TCP backoff */
@@ -161,6 +173,9 @@ struct ksock_tunables {
 						 * for untyped:
 						 * conns_per_peer total
 						 */
+	int		 *ksnd_sched_busy_poll;	/* usecs to poll for work */
+	int		 *ksnd_sched_rx_batch;	/* max rx msgs per conn/pass */
+	int		 *ksnd_sched_affinity;/* sched conns on RX CPT */
 };
 
 struct ksock_net {
@@ -655,6 +670,8 @@ extern void ksocknal_lib_set_callback(struct socket *sock,  struct ksock_conn *c
 extern void ksocknal_lib_reset_callback(struct socket *sock,
 					struct ksock_conn *conn);
 extern void ksocknal_lib_push_conn(struct ksock_conn *conn);
+extern void ksocknal_lib_busy_poll(struct ksock_conn *conn);
+extern int ksocknal_lib_rx_cpu(struct ksock_conn *conn);
 extern int ksocknal_lib_get_conn_addrs(struct ksock_conn *conn);
 extern int ksocknal_lib_setup_sock(struct socket *so);
 extern int ksocknal_lib_send_hdr(struct ksock_conn *conn, struct ksock_tx *tx,
@@ -1427,10 +1427,65 @@ ksocknal_sched_cansleep(struct ksock_sched *sched)
 	return rc;
 }
 
+/*
+ * Busy-poll for up to sched_busy_poll usecs for work to arrive for @sched,
+ * rather than sleeping until the socket callbacks wake a thread up. The
+ * device queue of @conn, the connection last received from, is polled
+ * meanwhile so that its packets are processed without waiting for an
+ * interrupt. Only one thread of a scheduler polls at a time.
+ * Return true if there is work to do.
+ */
+static bool
+ksocknal_sched_busy_poll(struct ksock_sched *sched, struct ksock_conn *conn)
+{
+	int usecs = *ksocknal_tunables.ksnd_sched_busy_poll;
+	bool found = false;
+	ktime_t end;
+
+	if (usecs <= 0)
+		return false;
+
+	spin_lock_bh(&sched->kss_lock);
+	if (sched->kss_busy_polling) {
+		spin_unlock_bh(&sched->kss_lock);
+		return false;
+	}
+	sched->kss_busy_polling = 1;
+	spin_unlock_bh(&sched->kss_lock);
+
+	/* pin the socket for the whole window, not once per poll */
+	if (conn && ksocknal_connsock_addref(conn) != 0) /* being shut down */
+		conn = NULL;
+
+	end = ktime_add_us(ktime_get(), usecs);
+	do {
+		if (conn)
+			ksocknal_lib_busy_poll(conn);
+
+		if (!list_empty_careful(&sched->kss_rx_conns) ||
+		    !list_empty_careful(&sched->kss_tx_conns)) {
+			found = true;
+			break;
+		}
+		cpu_relax();
+	} while (!ksocknal_data.ksnd_shuttingdown && !need_resched() &&
+		 ktime_before(ktime_get(), end));
+
+	if (conn)
+		ksocknal_connsock_decref(conn);
+
+	spin_lock_bh(&sched->kss_lock);
+	sched->kss_busy_polling = 0;
+	spin_unlock_bh(&sched->kss_lock);
+
+	return found;
+}
+
 int ksocknal_scheduler(void *arg)
 {
 	struct ksock_sched *sched;
 	struct ksock_conn *conn;
+	struct ksock_conn *poll_conn = NULL;
 	struct ksock_tx	*tx;
 	int rc;
 	long id = (long)arg;
@@ -1469,6 +1524,9 @@ int ksocknal_scheduler(void *arg)
 						struct ksock_conn,
 						ksnc_rx_list);
 		if (conn) {
+			int batch = *ksocknal_tunables.ksnd_sched_rx_batch;
+			int nmsgs = 0;
+
 			list_del(&conn->ksnc_rx_list);
 
 			LASSERT(conn->ksnc_rx_scheduled);
@@ -1481,8 +1539,15 @@ int ksocknal_scheduler(void *arg)
 			conn->ksnc_rx_ready = 0;
 			spin_unlock_bh(&sched->kss_lock);
 
-			rc = ksocknal_process_receive(conn, rx_scratch_pgs,
-						      scratch_iov);
+			/* Receive up to sched_rx_batch messages in a row, as
+			 * long as the previous one is done with and the next
+			 * header is ready, before going back to the queue. */
+			do {
+				rc = ksocknal_process_receive(conn,
+							      rx_scratch_pgs,
+							      scratch_iov);
+			} while (rc == 0 && ++nmsgs < batch &&
+				 conn->ksnc_rx_state == SOCKNAL_RX_KSM_HEADER);
 
 			spin_lock_bh(&sched->kss_lock);
 
@@ -1508,6 +1573,15 @@ int ksocknal_scheduler(void *arg)
 				ksocknal_conn_decref(conn);
 			}
 
+			/* poll the queue of the last conn received from */
+			if (*ksocknal_tunables.ksnd_sched_busy_poll > 0 &&
+			    conn != poll_conn) {
+				ksocknal_conn_addref(conn);
+				if (poll_conn)
+					ksocknal_conn_decref(poll_conn);
+				poll_conn = conn;
+			}
+
 			did_something = true;
 		}
 
@@ -1583,13 +1657,19 @@ int ksocknal_scheduler(void *arg)
 		    need_resched()) {	/* hogging CPU? */
 			spin_unlock_bh(&sched->kss_lock);
 
-			if (!did_something) {   /* wait for something to do */
+			if (did_something) {
+				cond_resched();
+			} else if (!ksocknal_sched_busy_poll(sched,
+							     poll_conn)) {
+				/* wait for something to do */
+				if (poll_conn) {
+					ksocknal_conn_decref(poll_conn);
+					poll_conn = NULL;
+				}
 				rc = wait_event_interruptible_exclusive(
 					sched->kss_waitq,
 					!ksocknal_sched_cansleep(sched));
 				LASSERT (rc == 0);
-			} else {
-				cond_resched();
 			}
 
 			spin_lock_bh(&sched->kss_lock);
@@ -1597,6 +1677,8 @@ int ksocknal_scheduler(void *arg)
 	}
 
 	spin_unlock_bh(&sched->kss_lock);
+	if (poll_conn)
+		ksocknal_conn_decref(poll_conn);
 	CFS_FREE_PTR_ARRAY(rx_scratch_pgs, LNET_MAX_IOV);
 	CFS_FREE_PTR_ARRAY(scratch_iov, LNET_MAX_IOV);
 	ksocknal_thread_fini();
@@ -1625,7 +1707,9 @@ void ksocknal_read_callback(struct ksock_conn *conn)
 		/* extra ref for scheduler */
 		ksocknal_conn_addref(conn);
 
-		wake_up (&sched->kss_waitq);
+		/* a busy-polling thread will notice it */
+		if (!sched->kss_busy_polling)
+			wake_up(&sched->kss_waitq);
 	}
 	spin_unlock_bh(&sched->kss_lock);
 
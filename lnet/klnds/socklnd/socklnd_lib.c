@@ -29,6 +29,9 @@
  * This file is part of Lustre, http://www.lustre.org/
  */
 
+#ifdef HAVE_SK_BUSY_LOOP
+#include <net/busy_poll.h>
+#endif
 #include "socklnd.h"
 
 int
@@ -289,6 +292,97 @@ ksocknal_lib_kiov_vmap(struct bio_vec *kiov, int niov,
 	return addr;
 }
 
+struct ksock_rx_desc {
+	struct ksock_conn	*rxd_conn;
+	struct bio_vec		*rxd_kiov;	/* fragment being filled */
+	unsigned int		 rxd_offset;	/* offset in rxd_kiov */
+};
+
+/*
+ * read_sock() actor: copy @len bytes at @offset of @skb to the next
+ * fragments of the payload, and checksum them while they're hot.
+ */
+static int
+ksocknal_lib_recv_actor(read_descriptor_t *desc, struct sk_buff *skb,
+			unsigned int offset, size_t len)
+{
+	struct ksock_rx_desc *rxd = desc->arg.data;
+	struct ksock_conn *conn = rxd->rxd_conn;
+	size_t copied = 0;
+	int rc;
+
+	len = min(len, desc->count);
+	while (copied < len) {
+		struct bio_vec *kiov = rxd->rxd_kiov;
+		unsigned int fragnob;
+		void *base;
+
+		fragnob = min_t(size_t, kiov->bv_len - rxd->rxd_offset,
+				len - copied);
+		base = kmap(kiov->bv_page) + kiov->bv_offset +
+		       rxd->rxd_offset;
+
+		rc = skb_copy_bits(skb, offset + copied, base, fragnob);
+		if (rc == 0 && conn->ksnc_msg.ksm_csum != 0)
+			conn->ksnc_rx_csum = ksocknal_csum(conn->ksnc_rx_csum,
+							   base, fragnob);
+		kunmap(kiov->bv_page);
+
+		if (rc != 0) {
+			desc->error = rc;
+			break;
+		}
+
+		copied += fragnob;
+		rxd->rxd_offset += fragnob;
+		if (rxd->rxd_offset == kiov->bv_len) {
+			rxd->rxd_kiov++;
+			rxd->rxd_offset = 0;
+		}
+	}
+
+	desc->count -= copied;
+	return copied;
+}
+
+/*
+ * Receive the payload by handing the socket buffers to an actor which
+ * copies them straight into the payload pages, instead of going through
+ * recvmsg() and an iovec of mapped pages.
+ */
+static int
+ksocknal_lib_recv_kiov_direct(struct ksock_conn *conn)
+{
+	struct socket *sock = conn->ksnc_sock;
+	struct sock *sk = sock->sk;
+	struct ksock_rx_desc rxd = {
+		.rxd_conn	= conn,
+		.rxd_kiov	= conn->ksnc_rx_kiov,
+	};
+	read_descriptor_t desc = {
+		.arg.data	= &rxd,
+	};
+	int i;
+	int rc;
+
+	for (i = 0; i < conn->ksnc_rx_nkiov; i++)
+		desc.count += conn->ksnc_rx_kiov[i].bv_len;
+
+	LASSERT(desc.count <= conn->ksnc_rx_nob_wanted);
+
+	lock_sock(sk);
+	rc = sock->ops->read_sock(sk, &desc, ksocknal_lib_recv_actor);
+	/* nothing read: an error, EOF or nothing to read yet */
+	if (rc == 0 && !(sk->sk_shutdown & RCV_SHUTDOWN))
+		rc = desc.error ?: sock_error(sk) ?: -EAGAIN;
+	release_sock(sk);
+
+	if (rc > 0)
+		this_cpu_add(ksocknal_rx_stats.ksrs_direct_nob, rc);
+
+	return rc;
+}
+
 int
 ksocknal_lib_recv_kiov(struct ksock_conn *conn, struct page **pages,
 		       struct kvec *scratchiov)
@@ -317,6 +411,10 @@ ksocknal_lib_recv_kiov(struct ksock_conn *conn, struct page **pages,
         int          fragnob;
 	int n;
 
+	if (*ksocknal_tunables.ksnd_rx_direct &&
+	    conn->ksnc_sock->ops->read_sock)
+		return ksocknal_lib_recv_kiov_direct(conn);
+
         /* NB we can't trust socket ops to either consume our iovs
          * or leave them alone. */
 	if ((addr = ksocknal_lib_kiov_vmap(kiov, niov, scratchiov, pages)) != NULL) {
@@ -336,6 +434,8 @@ ksocknal_lib_recv_kiov(struct ksock_conn *conn, struct page **pages,
 
 	rc = kernel_recvmsg(conn->ksnc_sock, &msg, scratchiov, n, nob,
 			    MSG_DONTWAIT);
+	if (rc > 0)
+		this_cpu_add(ksocknal_rx_stats.ksrs_recvmsg_nob, rc);
 
 	if (conn->ksnc_msg.ksm_csum != 0) {
 		for (i = 0, sum = rc; sum > 0; i++, sum -= fragnob) {
@@ -561,6 +661,29 @@ ksocknal_lib_push_conn(struct ksock_conn *conn)
 	ksocknal_connsock_decref(conn);
 }
 
+/*
+ * Poll the device queue the packets of @conn arrive on, if there is one.
+ * The caller holds a reference on the socket of @conn.
+ */
+void
+ksocknal_lib_busy_poll(struct ksock_conn *conn)
+{
+#ifdef HAVE_SK_BUSY_LOOP
+	sk_busy_loop(conn->ksnc_sock->sk, 1);
+#endif
+}
+
+/* CPU the packets of @conn were last received on, or -1 if unknown */
+int
+ksocknal_lib_rx_cpu(struct ksock_conn *conn)
+{
+#ifdef HAVE_SK_INCOMING_CPU
+	return READ_ONCE(conn->ksnc_sock->sk->sk_incoming_cpu);
+#else
+	return -1;
+#endif
+}
+
 void ksocknal_read_callback(struct ksock_conn *conn);
 void ksocknal_write_callback(struct ksock_conn *conn);
 /*
@@ -148,10 +148,26 @@ static unsigned int zc_recv_min_nfrags = 16;
 module_param(zc_recv_min_nfrags, int, 0644);
 MODULE_PARM_DESC(zc_recv_min_nfrags, "minimum # of fragments to enable ZC recv");
 
+static int rx_direct;
+module_param(rx_direct, int, 0644);
+MODULE_PARM_DESC(rx_direct, "receive payload from socket buffers straight into pages");
+
 static unsigned int conns_per_peer = DEFAULT_CONNS_PER_PEER;
 module_param(conns_per_peer, uint, 0644);
 MODULE_PARM_DESC(conns_per_peer, "number of connections per peer");
 
+static int sched_busy_poll;
+module_param(sched_busy_poll, int, 0644);
+MODULE_PARM_DESC(sched_busy_poll, "usecs to busy-poll for work before sleeping");
+
+static int sched_rx_batch = 1;
+module_param(sched_rx_batch, int, 0644);
+MODULE_PARM_DESC(sched_rx_batch, "max # messages received per connection per pass");
+
+static int sched_affinity;
+module_param(sched_affinity, int, 0444);
+MODULE_PARM_DESC(sched_affinity, "schedule connections on the CPT they receive on");
+
 #ifdef SOCKNAL_BACKOFF
 static int backoff_init = 3;
 module_param(backoff_init, int, 0644);
@@ -290,11 +306,15 @@ int ksocknal_tunables_init(void)
 	ksocknal_tunables.ksnd_zc_min_payload     = &zc_min_payload;
 	ksocknal_tunables.ksnd_zc_recv            = &zc_recv;
 	ksocknal_tunables.ksnd_zc_recv_min_nfrags = &zc_recv_min_nfrags;
+	ksocknal_tunables.ksnd_rx_direct          = &rx_direct;
 	if (conns_per_peer > ((1 << SOCKNAL_CONN_COUNT_MAX_BITS)-1)) {
 		CWARN("socklnd conns_per_peer is capped at %u.\n",
 		      (1 << SOCKNAL_CONN_COUNT_MAX_BITS)-1);
 	}
 	ksocknal_tunables.ksnd_conns_per_peer     = &conns_per_peer;
+	ksocknal_tunables.ksnd_sched_busy_poll    = &sched_busy_poll;
+	ksocknal_tunables.ksnd_sched_rx_batch     = &sched_rx_batch;
+	ksocknal_tunables.ksnd_sched_affinity     = &sched_affinity;
 
 	if (enable_irq_affinity) {
 		CWARN("irq_affinity is removed from socklnd because modern "
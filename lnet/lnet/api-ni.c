@@ -128,6 +128,11 @@ module_param(lnet_recovery_limit, uint, 0644);
 MODULE_PARM_DESC(lnet_recovery_limit,
 		 "How long to attempt recovery of unhealthy peer interfaces in seconds. Set to 0 to allow indefinite recovery");
 
+unsigned int lnet_bulk_stripe;
+module_param(lnet_bulk_stripe, uint, 0644);
+MODULE_PARM_DESC(lnet_bulk_stripe,
+		 "Minimum PUT/GET payload in bytes to stripe over the interfaces of multi-rail peers. Set to 0 to disable");
+
 static int lnet_interfaces_max = LNET_INTERFACES_MAX_DEFAULT;
 static int intf_max_set(const char *val, cfs_kernel_param_arg_t *kp);
 
@@ -573,6 +578,7 @@ lnet_init_locks(void)
 	spin_lock_init(&the_lnet.ln_msg_resend_lock);
 	init_completion(&the_lnet.ln_mt_wait_complete);
 	mutex_init(&the_lnet.ln_lnd_mutex);
+	mutex_init(&the_lnet.ln_rtrpool_mutex);
 }
 
 struct kmem_cache *lnet_mes_cachep;	   /* MEs kmem_cache */
@@ -3386,6 +3392,35 @@ int lnet_get_ni_stats(struct lnet_ioctl_element_msg_stats *msg_stats)
 	return rc;
 }
 
+static int lnet_get_ni_rail_stats(struct lnet_ioctl_rail_stats *stats)
+{
+	struct lnet_ni *ni;
+	int cpt;
+	int rc = -ENOENT;
+
+	cpt = lnet_net_lock_current();
+
+	ni = lnet_get_ni_idx_locked(stats->irs_idx);
+	if (ni) {
+		stats->irs_nid = lnet_nid_to_nid4(&ni->ni_nid);
+		stats->irs_send_bytes =
+			atomic64_read(&ni->ni_stats.el_send_bytes);
+		stats->irs_recv_bytes =
+			atomic64_read(&ni->ni_stats.el_recv_bytes);
+		stats->irs_stripe_count = atomic64_read(&ni->ni_stripe_count);
+		stats->irs_stripe_inflight =
+			atomic64_read(&ni->ni_stripe_qnob);
+		stats->irs_stripe_bw = READ_ONCE(ni->ni_stripe_bw.lg_rate);
+		stats->irs_rtt = READ_ONCE(ni->ni_rtt);
+		stats->irs_goodput = READ_ONCE(ni->ni_goodput.lg_rate);
+		rc = 0;
+	}
+
+	lnet_net_unlock(cpt);
+
+	return rc;
+}
+
 static int lnet_add_net_common(struct lnet_net *net,
 			       struct lnet_ioctl_config_lnd_tunables *tun)
 {
@@ -3924,6 +3959,10 @@ lnet_get_peer_ni_recovery_list(struct lnet_ioctl_recovery_list *list)
 	return 0;
 }
 
+/* struct lnet_ioctl_peer_cfg as passed by tools predating prcfg_flags */
+#define LNET_PEER_CFG_SIZE_V1	offsetof(struct lnet_ioctl_peer_cfg, \
+					 prcfg_flags)
+
 /**
  * LNet ioctl handler.
  *
@@ -4044,6 +4083,19 @@ LNetCtl(unsigned int cmd, void *arg)
 		return rc;
 	}
 
+	case IOC_LIBCFS_GET_LOCAL_NI_RAIL_STATS: {
+		struct lnet_ioctl_rail_stats *rail_stats = arg;
+
+		if (rail_stats->irs_hdr.ioc_len != sizeof(*rail_stats))
+			return -EINVAL;
+
+		mutex_lock(&the_lnet.ln_api_mutex);
+		rc = lnet_get_ni_rail_stats(rail_stats);
+		mutex_unlock(&the_lnet.ln_api_mutex);
+
+		return rc;
+	}
+
 	case IOC_LIBCFS_GET_NET: {
 		size_t total = sizeof(*config) +
 			       sizeof(struct lnet_ioctl_net_config);
@@ -4178,7 +4230,7 @@ LNetCtl(unsigned int cmd, void *arg)
 	case IOC_LIBCFS_ADD_PEER_NI: {
 		struct lnet_ioctl_peer_cfg *cfg = arg;
 
-		if (cfg->prcfg_hdr.ioc_len < sizeof(*cfg))
+		if (cfg->prcfg_hdr.ioc_len < LNET_PEER_CFG_SIZE_V1)
 			return -EINVAL;
 
 		mutex_lock(&the_lnet.ln_api_mutex);
@@ -4192,7 +4244,7 @@ LNetCtl(unsigned int cmd, void *arg)
 	case IOC_LIBCFS_DEL_PEER_NI: {
 		struct lnet_ioctl_peer_cfg *cfg = arg;
 
-		if (cfg->prcfg_hdr.ioc_len < sizeof(*cfg))
+		if (cfg->prcfg_hdr.ioc_len < LNET_PEER_CFG_SIZE_V1)
 			return -EINVAL;
 
 		mutex_lock(&the_lnet.ln_api_mutex);
@@ -4226,13 +4278,16 @@ LNetCtl(unsigned int cmd, void *arg)
 
 	case IOC_LIBCFS_GET_PEER_NI: {
 		struct lnet_ioctl_peer_cfg *cfg = arg;
+		bool perf;
 
-		if (cfg->prcfg_hdr.ioc_len < sizeof(*cfg))
+		if (cfg->prcfg_hdr.ioc_len < LNET_PEER_CFG_SIZE_V1)
 			return -EINVAL;
+		perf = cfg->prcfg_hdr.ioc_len >= sizeof(*cfg) &&
+		       (cfg->prcfg_flags & LNET_PEER_CFG_F_PERF);
 
 		mutex_lock(&the_lnet.ln_api_mutex);
 		rc = lnet_get_peer_info(cfg,
-					(void __user *)cfg->prcfg_bulk);
+					(void __user *)cfg->prcfg_bulk, perf);
 		mutex_unlock(&the_lnet.ln_api_mutex);
 		return rc;
 	}
@@ -4240,7 +4295,7 @@ LNetCtl(unsigned int cmd, void *arg)
 	case IOC_LIBCFS_GET_PEER_LIST: {
 		struct lnet_ioctl_peer_cfg *cfg = arg;
 
-		if (cfg->prcfg_hdr.ioc_len < sizeof(*cfg))
+		if (cfg->prcfg_hdr.ioc_len < LNET_PEER_CFG_SIZE_V1)
 			return -EINVAL;
 
 		mutex_lock(&the_lnet.ln_api_mutex);
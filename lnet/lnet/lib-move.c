@@ -917,6 +917,8 @@ lnet_post_send_locked(struct lnet_msg *msg, int do_send)
 		msg->msg_txcredit = 1;
 		tq->tq_credits--;
 		atomic_dec(&ni->ni_tx_credits);
+		atomic64_add(msg->msg_len + sizeof(struct lnet_hdr),
+			     &ni->ni_txqnob);
 
 		if (tq->tq_credits < tq->tq_credits_min)
 			tq->tq_credits_min = tq->tq_credits;
@@ -1021,11 +1023,14 @@ lnet_post_routed_recv_locked(struct lnet_msg *msg, int do_recv)
 		rbp->rbp_credits--;
 		if (rbp->rbp_credits < rbp->rbp_mincredits)
 			rbp->rbp_mincredits = rbp->rbp_credits;
+		if (rbp->rbp_credits < rbp->rbp_win_mincredits)
+			rbp->rbp_win_mincredits = rbp->rbp_credits;
 
 		if (rbp->rbp_credits < 0) {
 			/* must have checked eager_recv before here */
 			LASSERT(msg->msg_rx_ready_delay);
 			msg->msg_rx_delayed = 1;
+			msg->msg_rtrbuf_wait = ktime_get();
 			list_add_tail(&msg->msg_list, &rbp->rbp_msgs);
 			return LNET_CREDIT_WAIT;
 		}
@@ -1071,6 +1076,8 @@ lnet_return_tx_credits_locked(struct lnet_msg *msg)
 
 		tq->tq_credits++;
 		atomic_inc(&ni->ni_tx_credits);
+		atomic64_sub(msg->msg_len + sizeof(struct lnet_hdr),
+			     &ni->ni_txqnob);
 		if (tq->tq_credits <= 0) {
 			msg2 = list_entry(tq->tq_delayed.next,
 					  struct lnet_msg, msg_list);
@@ -1135,6 +1142,9 @@ lnet_return_tx_credits_locked(struct lnet_msg *msg)
         }
 
 	if (txni != NULL) {
+		if (msg->msg_stripe)
+			atomic64_sub(msg->msg_stripe_nob,
+				     &txni->ni_stripe_qnob);
 		msg->msg_txni = NULL;
 		lnet_ni_decref_locked(txni, msg->msg_tx_cpt);
 	}
@@ -1149,6 +1159,8 @@ void
 lnet_schedule_blocked_locked(struct lnet_rtrbufpool *rbp)
 {
 	struct lnet_msg	*msg;
+	s64 usecs;
+	int idx;
 
 	if (list_empty(&rbp->rbp_msgs))
 		return;
@@ -1156,6 +1168,12 @@ lnet_schedule_blocked_locked(struct lnet_rtrbufpool *rbp)
 			 struct lnet_msg, msg_list);
 	list_del(&msg->msg_list);
 
+	usecs = ktime_us_delta(ktime_get(), msg->msg_rtrbuf_wait);
+	idx = usecs < 2 ? 0 : min_t(int, ilog2(usecs),
+				    LNET_RTRPOOL_WAIT_BUCKETS - 1);
+	rbp->rbp_nwaits++;
+	rbp->rbp_wait_hist[idx]++;
+
 	(void)lnet_post_routed_recv_locked(msg, 1);
 }
 
@@ -1291,6 +1309,58 @@ routing_off:
 	}
 }
 
+/*
+ * Compare two paths on the time they are expected to take to complete a
+ * message: their round-trip time, plus the time for the bytes already in
+ * flight over them to drain at their measured goodput. Costs within 1/4
+ * of each other are considered equal, and so are paths whose goodput is
+ * not measured yet, which leaves the choice to the credits and round-robin.
+ * Return < 0 if the first path is the faster one.
+ */
+static int
+lnet_compare_path_cost(__u32 rtt1, struct lnet_goodput *lg1, __u64 qnob1,
+		       __u32 rtt2, struct lnet_goodput *lg2, __u64 qnob2)
+{
+	__u64 rate1 = READ_ONCE(lg1->lg_rate);
+	__u64 rate2 = READ_ONCE(lg2->lg_rate);
+	__u64 cost1;
+	__u64 cost2;
+
+	if (!rate1 || !rate2)
+		return 0;
+
+	cost1 = rtt1 + div64_u64(qnob1 * USEC_PER_SEC, rate1);
+	cost2 = rtt2 + div64_u64(qnob2 * USEC_PER_SEC, rate2);
+
+	if (cost1 + (cost1 >> 2) < cost2)
+		return -1;
+	if (cost2 + (cost2 >> 2) < cost1)
+		return 1;
+	return 0;
+}
+
+static inline int
+lnet_compare_lpni_cost(struct lnet_peer_ni *lpni1, struct lnet_peer_ni *lpni2)
+{
+	return lnet_compare_path_cost(READ_ONCE(lpni1->lpni_rtt),
+				      &lpni1->lpni_goodput,
+				      READ_ONCE(lpni1->lpni_txqnob),
+				      READ_ONCE(lpni2->lpni_rtt),
+				      &lpni2->lpni_goodput,
+				      READ_ONCE(lpni2->lpni_txqnob));
+}
+
+static inline int
+lnet_compare_ni_cost(struct lnet_ni *ni1, struct lnet_ni *ni2)
+{
+	return lnet_compare_path_cost(READ_ONCE(ni1->ni_rtt),
+				      &ni1->ni_goodput,
+				      atomic64_read(&ni1->ni_txqnob),
+				      READ_ONCE(ni2->ni_rtt),
+				      &ni2->ni_goodput,
+				      atomic64_read(&ni2->ni_txqnob));
+}
+
 static struct lnet_peer_ni *
 lnet_select_peer_ni(struct lnet_ni *best_ni, lnet_nid_t dst_nid,
 		    struct lnet_peer *peer,
@@ -1302,8 +1372,9 @@ lnet_select_peer_ni(struct lnet_ni *best_ni, lnet_nid_t dst_nid,
 	 * to the chosen net. If a peer_ni is preferred when using the
 	 * best_ni to communicate, we use that one. If there is no
 	 * preferred peer_ni, or there are multiple preferred peer_ni,
-	 * the available transmit credits are used. If the transmit
-	 * credits are equal, we round-robin over the peer_ni.
+	 * the measured round-trip time and goodput are used, then the
+	 * available transmit credits. If the transmit credits are equal,
+	 * we round-robin over the peer_ni.
 	 */
 	struct lnet_peer_ni *lpni = NULL;
 	int best_lpni_credits = (best_lpni) ? best_lpni->lpni_txcredits :
@@ -1315,6 +1386,7 @@ lnet_select_peer_ni(struct lnet_ni *best_ni, lnet_nid_t dst_nid,
 	int lpni_healthv;
 	__u32 lpni_sel_prio;
 	__u32 best_sel_prio = LNET_MAX_SELECTION_PRIORITY;
+	int rc;
 
 	while ((lpni = lnet_get_next_peer_ni_locked(peer, peer_net, lpni))) {
 		/*
@@ -1374,6 +1446,12 @@ lnet_select_peer_ni(struct lnet_ni *best_ni, lnet_nid_t dst_nid,
 			continue;
 		}
 
+		rc = lnet_compare_lpni_cost(lpni, best_lpni);
+		if (rc > 0)
+			continue;
+		else if (rc < 0)
+			goto select_lpni;
+
 		if (lpni->lpni_txcredits < best_lpni_credits)
 			/* We already have a peer that has more credits
 			 * available than this one. No need to consider
@@ -1453,6 +1531,11 @@ lnet_find_best_lpni(struct lnet_ni *lni, lnet_nid_t dst_nid,
 static int
 lnet_compare_gw_lpnis(struct lnet_peer_ni *lpni1, struct lnet_peer_ni *lpni2)
 {
+	int rc = lnet_compare_lpni_cost(lpni1, lpni2);
+
+	if (rc)
+		return -rc;
+
 	if (lpni1->lpni_txqnob < lpni2->lpni_txqnob)
 		return 1;
 
@@ -1669,6 +1752,7 @@ lnet_get_best_ni(struct lnet_net *local_net, struct lnet_ni *best_ni,
 		int ni_fatal;
 		__u32 ni_sel_prio;
 		unsigned int ni_dev_prio;
+		int rc;
 
 		ni_credits = atomic_read(&ni->ni_tx_credits);
 		ni_healthv = atomic_read(&ni->ni_healthv);
@@ -1695,7 +1779,8 @@ lnet_get_best_ni(struct lnet_net *local_net, struct lnet_ni *best_ni,
 
 		/*
 		 * Select on health, selection policy, direct dma prio,
-		 * shorter distance, available credits, then round-robin.
+		 * shorter distance, expected completion time, available
+		 * credits, then round-robin.
 		 */
 		if (ni_fatal)
 			continue;
@@ -1731,6 +1816,12 @@ lnet_get_best_ni(struct lnet_net *local_net, struct lnet_ni *best_ni,
 		else if (distance < shortest_distance)
 			goto select_ni;
 
+		rc = lnet_compare_ni_cost(ni, best_ni);
+		if (rc > 0)
+			continue;
+		else if (rc < 0)
+			goto select_ni;
+
 		if (ni_credits < best_credits)
 			continue;
 		else if (ni_credits > best_credits)
@@ -1892,6 +1983,9 @@ lnet_handle_send(struct lnet_send_data *sd)
 	 */
 	lnet_ni_addref_locked(msg->msg_txni, sd->sd_cpt);
 
+	if (msg->msg_stripe)
+		atomic64_add(msg->msg_stripe_nob, &best_ni->ni_stripe_qnob);
+
 	/*
 	 * Always set the target.nid to the best peer picked. Either the
 	 * NID will be one of the peer NIDs selected, or the same NID as
@@ -1949,8 +2043,27 @@ lnet_handle_send(struct lnet_send_data *sd)
 	if (msg->msg_md) {
 		rspt = msg->msg_md->md_rspt_ptr;
 		if (rspt) {
+			/* an earlier try of the GET was striped */
+			if (rspt->rspt_stripe_nob) {
+				lnet_stripe_get_done_locked(
+					&rspt->rspt_local_nid,
+					rspt->rspt_stripe_nob, sd->sd_cpt,
+					false);
+				rspt->rspt_stripe_nob = 0;
+			}
+			/*
+			 * the payload of a striped GET is in flight until
+			 * its REPLY arrives, not until the GET is sent
+			 */
+			if (msg->msg_stripe &&
+			    msg->msg_type == LNET_MSG_GET) {
+				rspt->rspt_stripe_nob = msg->msg_stripe_nob;
+				msg->msg_stripe = 0;
+			}
 			rspt->rspt_next_hop_nid =
 				msg->msg_txpeer->lpni_nid;
+			rspt->rspt_local_nid = msg->msg_txni->ni_nid;
+			rspt->rspt_sent = ktime_get();
 			CDEBUG(D_NET, "rspt_next_hop_nid = %s\n",
 			       libcfs_nidstr(&rspt->rspt_next_hop_nid));
 		}
@@ -2846,6 +2959,217 @@ lnet_handle_any_router_nmr_dst(struct lnet_send_data *sd)
 	return lnet_handle_send(sd);
 }
 
+/*
+ * Large PUTs and GETs to a multi-rail peer are striped over the rails when
+ * lnet_bulk_stripe is set: each message goes over the NI pair expected to
+ * complete it first. ptlrpc already splits a bulk transfer into one message
+ * per LNET_MTU and counts their completion per MD, so this is enough for a
+ * single large transfer to use all the rails.
+ *
+ * The payload of a GET comes back in its REPLY, long after the GET itself
+ * is sent, so it stays accounted to the NI through the response tracker.
+ * GETs without one are not striped.
+ */
+static unsigned int
+lnet_msg_stripe_nob(struct lnet_msg *msg)
+{
+	if (msg->msg_type == LNET_MSG_PUT)
+		return msg->msg_len;
+
+	if (msg->msg_type == LNET_MSG_GET && msg->msg_md &&
+	    msg->msg_md->md_rspt_ptr)
+		return le32_to_cpu(msg->msg_hdr.msg.get.sink_length);
+
+	return 0;
+}
+
+static bool
+lnet_msg_stripe(struct lnet_msg *msg)
+{
+	if (!lnet_bulk_stripe || msg->msg_routing || msg->msg_recovery ||
+	    !lnet_msg_discovery(msg))
+		return false;
+
+	return lnet_msg_stripe_nob(msg) >= lnet_bulk_stripe;
+}
+
+/*
+ * Compare the time two NIs are expected to take to complete a striped
+ * message of @nob bytes: the striped bytes already in flight over the NI
+ * plus @nob, divided by its measured bandwidth. Until the bandwidth of
+ * both is known, the bytes in flight are compared, which also favours the
+ * rails draining faster.
+ * Return < 0 if @ni1 is the better one.
+ */
+static int
+lnet_ni_stripe_cmp(struct lnet_ni *ni1, struct lnet_ni *ni2, unsigned int nob)
+{
+	__u64 bw1 = READ_ONCE(ni1->ni_stripe_bw.lg_rate) >> 10;
+	__u64 bw2 = READ_ONCE(ni2->ni_stripe_bw.lg_rate) >> 10;
+	__u64 cost1 = atomic64_read(&ni1->ni_stripe_qnob) + nob;
+	__u64 cost2 = atomic64_read(&ni2->ni_stripe_qnob) + nob;
+
+	if (bw1 && bw2) {
+		cost1 *= bw2;
+		cost2 *= bw1;
+	}
+
+	if (cost1 < cost2)
+		return -1;
+	if (cost1 > cost2)
+		return 1;
+	return 0;
+}
+
+/*
+ * Select the NI to stripe a message over, among the healthiest NIs of all
+ * the local nets the peer has NIs on.
+ */
+static struct lnet_ni *
+lnet_find_stripe_ni(struct lnet_peer *peer, unsigned int nob)
+{
+	struct lnet_peer_net *lpn;
+	struct lnet_ni *best_ni = NULL;
+	int best_healthv = 0;
+	__u32 best_sel_prio = LNET_MAX_SELECTION_PRIORITY;
+
+	list_for_each_entry(lpn, &peer->lp_peer_nets, lpn_peer_nets) {
+		struct lnet_net *net = lnet_get_net_locked(lpn->lpn_net_id);
+		struct lnet_ni *ni = NULL;
+
+		if (!net || LNET_NETTYP(net->net_id) == LOLND ||
+		    !lnet_get_next_peer_ni_locked(peer, lpn, NULL))
+			continue;
+
+		while ((ni = lnet_get_next_ni_locked(net, ni))) {
+			int ni_healthv = atomic_read(&ni->ni_healthv);
+			int rc;
+
+			if (atomic_read(&ni->ni_fatal_error_on))
+				continue;
+
+			if (!best_ni)
+				goto select_ni;
+
+			if (ni_healthv < best_healthv)
+				continue;
+			else if (ni_healthv > best_healthv)
+				goto select_ni;
+
+			if (ni->ni_sel_priority > best_sel_prio)
+				continue;
+			else if (ni->ni_sel_priority < best_sel_prio)
+				goto select_ni;
+
+			rc = lnet_ni_stripe_cmp(ni, best_ni, nob);
+			if (rc > 0)
+				continue;
+			else if (rc < 0)
+				goto select_ni;
+
+			if (best_ni->ni_seq <= ni->ni_seq)
+				continue;
+select_ni:
+			best_ni = ni;
+			best_healthv = ni_healthv;
+			best_sel_prio = ni->ni_sel_priority;
+		}
+	}
+
+	return best_ni;
+}
+
+/*
+ * Select the peer NI to stripe a message to: the healthiest one with the
+ * fewest bytes queued to it, round-robin otherwise.
+ */
+static struct lnet_peer_ni *
+lnet_find_stripe_lpni(struct lnet_peer *peer, struct lnet_peer_net *lpn)
+{
+	struct lnet_peer_ni *best_lpni = NULL;
+	struct lnet_peer_ni *lpni = NULL;
+	int best_healthv = 0;
+
+	while ((lpni = lnet_get_next_peer_ni_locked(peer, lpn, lpni))) {
+		int lpni_healthv = atomic_read(&lpni->lpni_healthv);
+
+		if (!best_lpni)
+			goto select_lpni;
+
+		if (lpni_healthv < best_healthv)
+			continue;
+		else if (lpni_healthv > best_healthv)
+			goto select_lpni;
+
+		if (lpni->lpni_sel_priority > best_lpni->lpni_sel_priority)
+			continue;
+		else if (lpni->lpni_sel_priority <
+			 best_lpni->lpni_sel_priority)
+			goto select_lpni;
+
+		if (lpni->lpni_txqnob > best_lpni->lpni_txqnob)
+			continue;
+		else if (lpni->lpni_txqnob < best_lpni->lpni_txqnob)
+			goto select_lpni;
+
+		if (best_lpni->lpni_seq <= lpni->lpni_seq)
+			continue;
+select_lpni:
+		best_lpni = lpni;
+		best_healthv = lpni_healthv;
+	}
+
+	return best_lpni;
+}
+
+/*
+ * Source specified or not
+ * Local destination
+ * MR peer
+ * PUT or tracked GET of at least lnet_bulk_stripe bytes
+ *
+ * Stripe over the peer NIs, and over the local NIs too unless the source
+ * NID is specified.
+ */
+static int
+lnet_handle_stripe_mr_dst(struct lnet_send_data *sd)
+{
+	struct lnet_msg *msg = sd->sd_msg;
+	struct lnet_peer_net *lpn;
+	unsigned int nob = lnet_msg_stripe_nob(msg);
+
+	if (sd->sd_send_case & SRC_SPEC)
+		sd->sd_best_ni = lnet_nid2ni_locked(sd->sd_src_nid,
+						    sd->sd_cpt);
+	else
+		sd->sd_best_ni = lnet_find_stripe_ni(sd->sd_peer, nob);
+	/* let the regular path deal with a bad or loopback source NID */
+	if (!sd->sd_best_ni ||
+	    LNET_NETTYP(sd->sd_best_ni->ni_net->net_id) == LOLND) {
+		sd->sd_best_ni = NULL;
+		return PASS_THROUGH;
+	}
+
+	lpn = lnet_peer_get_net_locked(sd->sd_peer,
+				       sd->sd_best_ni->ni_net->net_id);
+	sd->sd_best_lpni = lpn ? lnet_find_stripe_lpni(sd->sd_peer, lpn) :
+				 NULL;
+	if (!sd->sd_best_lpni) {
+		sd->sd_best_ni = NULL;
+		sd->sd_best_lpni = sd->sd_final_dst_lpni;
+		return PASS_THROUGH;
+	}
+
+	CDEBUG(D_NET, "stripe %u bytes over %s -> %s\n", nob,
+	       libcfs_nidstr(&sd->sd_best_ni->ni_nid),
+	       libcfs_nidstr(&sd->sd_best_lpni->lpni_nid));
+
+	msg->msg_stripe = 1;
+	msg->msg_stripe_nob = nob;
+
+	return lnet_handle_send(sd);
+}
+
 static int
 lnet_handle_send_case_locked(struct lnet_send_data *sd)
 {
@@ -2862,6 +3186,17 @@ lnet_handle_send_case_locked(struct lnet_send_data *sd)
 		libcfs_nid2str(sd->sd_dst_nid),
 		(send_case & LOCAL_DST) ? "local" : "routed");
 
+	sd->sd_msg->msg_stripe = 0;
+	if ((send_case == SRC_SPEC_LOCAL_MR_DST ||
+	     send_case == SRC_ANY_LOCAL_MR_DST) &&
+	    !lnet_msg_is_response(sd->sd_msg) &&
+	    lnet_msg_stripe(sd->sd_msg)) {
+		int rc = lnet_handle_stripe_mr_dst(sd);
+
+		if (rc != PASS_THROUGH)
+			return rc;
+	}
+
 	switch (send_case) {
 	/*
 	 * For all cases where the source is specified, we should always
@@ -3135,6 +3470,20 @@ lnet_detach_rsp_tracker(struct lnet_libmd *md, int cpt)
 
 	md->md_rspt_ptr = NULL;
 
+	/*
+	 * the REPLY of an optimized GET is not parsed, its payload has
+	 * landed once the MD is done with
+	 */
+	if (rspt->rspt_stripe_nob) {
+		lnet_net_lock(cpt);
+		lnet_stripe_get_done_locked(&rspt->rspt_local_nid,
+					    rspt->rspt_stripe_nob, cpt,
+					    !(md->md_flags &
+					      LNET_MD_FLAG_ABORTED));
+		lnet_net_unlock(cpt);
+		rspt->rspt_stripe_nob = 0;
+	}
+
 	if (LNetMDHandleIsInvalid(rspt->rspt_mdh)) {
 		/*
 		 * The monitor thread has invalidated this handle because the
@@ -3790,6 +4139,7 @@ static int
 lnet_monitor_thread(void *arg)
 {
 	time64_t rsp_timeout = 0;
+	time64_t rtrpool_timeout = 0;
 	time64_t now;
 
 	wait_for_completion(&the_lnet.ln_started);
@@ -3802,6 +4152,7 @@ lnet_monitor_thread(void *arg)
 	 *     pings them
 	 *  4. Checks if there are any NIs on the remote recovery queue
 	 *     and pings them.
+	 *  5. Resizes the router buffer pools with their usage.
 	 */
 	while (the_lnet.ln_mt_state == LNET_MT_STATE_RUNNING) {
 		now = ktime_get_real_seconds();
@@ -3819,6 +4170,11 @@ lnet_monitor_thread(void *arg)
 		lnet_recover_local_nis();
 		lnet_recover_peer_nis();
 
+		if (now >= rtrpool_timeout) {
+			lnet_rtrpools_auto_adjust();
+			rtrpool_timeout = now + LNET_RTRPOOL_AUTO_INTERVAL;
+		}
+
 		/*
 		 * TODO do we need to check if we should sleep without
 		 * timeout?  Technically, an active system will always
@@ -4278,15 +4634,121 @@ lnet_parse_get(struct lnet_ni *ni, struct lnet_msg *msg, int rdma_get)
 	return 0;
 }
 
+/* payload up to which the time to get an ACK is taken as is */
+#define LNET_RTT_MAX_NOB	4096
+
+static inline void
+lnet_rtt_update(__u32 *rtt, __u32 sample)
+{
+	__u32 old = READ_ONCE(*rtt);
+
+	WRITE_ONCE(*rtt, old ? old - (old >> 3) + (sample >> 3) : sample);
+}
+
+/*
+ * Called with the res_lock held when the REPLY/ACK for @md arrives.
+ * Returns the time since its GET/PUT was sent, in usecs, and the NIDs of
+ * the local and peer NIs it was sent over, or 0 if it is not tracked.
+ */
+static __u32
+lnet_rtt_sample(struct lnet_libmd *md, struct lnet_nid *ni_nid,
+		struct lnet_nid *lpni_nid)
+{
+	struct lnet_rsp_tracker *rspt = md->md_rspt_ptr;
+	s64 usecs;
+
+	if (!rspt || LNetMDHandleIsInvalid(rspt->rspt_mdh) ||
+	    !ktime_to_ns(rspt->rspt_sent))
+		return 0;
+
+	usecs = ktime_us_delta(ktime_get(), rspt->rspt_sent);
+	if (usecs <= 0 || usecs > U32_MAX)
+		return 0;
+
+	*ni_nid = rspt->rspt_local_nid;
+	*lpni_nid = rspt->rspt_next_hop_nid;
+	return usecs;
+}
+
+/*
+ * Credit the round-trip time @usecs sampled by lnet_rtt_sample() to the
+ * local and peer NIs the GET/PUT was sent over, which may not be the ones
+ * its REPLY/ACK arrived over. The time to send the @nob bytes of payload
+ * acknowledged by an ACK, at the measured goodput of the peer NI, is taken
+ * out of the sample. Both are smoothed with a weight of 1/8.
+ */
+static void
+lnet_rtt_credit(struct lnet_nid *ni_nid, struct lnet_nid *lpni_nid,
+		__u32 usecs, unsigned int nob)
+{
+	struct lnet_peer_ni *lpni;
+	struct lnet_ni *ni;
+	__u64 drain;
+	int cpt;
+
+	if (!usecs)
+		return;
+
+	cpt = lnet_net_lock_current();
+	lpni = lnet_peer_ni_find_locked(lpni_nid);
+	if (!lpni)
+		goto out;
+
+	if (nob > LNET_RTT_MAX_NOB) {
+		__u64 rate = READ_ONCE(lpni->lpni_goodput.lg_rate);
+
+		if (!rate)
+			goto out_decref;
+		drain = div64_u64((__u64)nob * USEC_PER_SEC, rate);
+		if (drain >= usecs)
+			goto out_decref;
+		usecs -= drain;
+	}
+
+	lnet_rtt_update(&lpni->lpni_rtt, usecs);
+	ni = lnet_nid_to_ni_locked(ni_nid, cpt);
+	if (ni)
+		lnet_rtt_update(&ni->ni_rtt, usecs);
+out_decref:
+	lnet_peer_ni_decref_locked(lpni);
+out:
+	lnet_net_unlock(cpt);
+}
+
+/*
+ * Called with the res_lock held when the REPLY for @md arrives. Returns the
+ * payload of the striped GET it answers, still accounted to the local NI
+ * @ni_nid, and takes it off the response tracker, or 0 if none.
+ */
+static unsigned int
+lnet_stripe_reply(struct lnet_libmd *md, struct lnet_nid *ni_nid)
+{
+	struct lnet_rsp_tracker *rspt = md->md_rspt_ptr;
+	unsigned int nob;
+
+	if (!rspt || !rspt->rspt_stripe_nob)
+		return 0;
+
+	nob = rspt->rspt_stripe_nob;
+	rspt->rspt_stripe_nob = 0;
+	*ni_nid = rspt->rspt_local_nid;
+	return nob;
+}
+
 static int
 lnet_parse_reply(struct lnet_ni *ni, struct lnet_msg *msg)
 {
 	void *private = msg->msg_private;
 	struct lnet_hdr *hdr = &msg->msg_hdr;
 	struct lnet_process_id src = {0};
+	struct lnet_nid stripe_nid;
+	struct lnet_nid lpni_nid;
+	struct lnet_nid ni_nid;
 	struct lnet_libmd *md;
+	unsigned int stripe_nob;
 	unsigned int rlength;
 	unsigned int mlength;
+	__u32 rtt;
 	int cpt;
 
 	cpt = lnet_cpt_of_cookie(hdr->msg.reply.dst_wmd.wh_object_cookie);
@@ -4332,6 +4794,8 @@ lnet_parse_reply(struct lnet_ni *ni, struct lnet_msg *msg)
 	       libcfs_nidstr(&ni->ni_nid), libcfs_id2str(src),
 	       mlength, rlength, hdr->msg.reply.dst_wmd.wh_object_cookie);
 
+	rtt = lnet_rtt_sample(md, &ni_nid, &lpni_nid);
+	stripe_nob = lnet_stripe_reply(md, &stripe_nid);
 	lnet_msg_attach_md(msg, md, 0, mlength);
 
 	if (mlength != 0)
@@ -4339,6 +4803,15 @@ lnet_parse_reply(struct lnet_ni *ni, struct lnet_msg *msg)
 
 	lnet_res_unlock(cpt);
 
+	/* the payload of the REPLY follows its header */
+	lnet_rtt_credit(&ni_nid, &lpni_nid, rtt, 0);
+
+	if (stripe_nob) {
+		cpt = lnet_net_lock_current();
+		lnet_stripe_get_done_locked(&stripe_nid, stripe_nob, cpt, true);
+		lnet_net_unlock(cpt);
+	}
+
 	lnet_build_msg_event(msg, LNET_EVENT_REPLY);
 
 	lnet_ni_recv(ni, private, msg, 0, 0, mlength, rlength);
@@ -4350,7 +4823,10 @@ lnet_parse_ack(struct lnet_ni *ni, struct lnet_msg *msg)
 {
 	struct lnet_hdr *hdr = &msg->msg_hdr;
 	struct lnet_process_id src = {0};
+	struct lnet_nid lpni_nid;
+	struct lnet_nid ni_nid;
 	struct lnet_libmd *md;
+	__u32 rtt;
 	int cpt;
 
 	src.nid = hdr->src_nid;
@@ -4385,10 +4861,13 @@ lnet_parse_ack(struct lnet_ni *ni, struct lnet_msg *msg)
 	       libcfs_nidstr(&ni->ni_nid), libcfs_id2str(src),
 	       hdr->msg.ack.dst_wmd.wh_object_cookie);
 
+	rtt = lnet_rtt_sample(md, &ni_nid, &lpni_nid);
 	lnet_msg_attach_md(msg, md, 0, 0);
 
 	lnet_res_unlock(cpt);
 
+	lnet_rtt_credit(&ni_nid, &lpni_nid, rtt, hdr->msg.ack.mlength);
+
 	lnet_build_msg_event(msg, LNET_EVENT_ACK);
 
 	lnet_ni_recv(ni, msg->msg_private, msg, 0, 0, 0, msg->msg_len);
@@ -176,11 +176,71 @@ lnet_msg_commit(struct lnet_msg *msg, int cpt)
 		common->lcc_msgs_max = common->lcc_msgs_alloc;
 }
 
+/* interval to sample the goodput over */
+#define LNET_GOODPUT_INTERVAL_NS	(100 * NSEC_PER_MSEC)
+
+/*
+ * Account @nob bytes sent in the goodput of an NI or peer NI, @busy
+ * telling whether other messages are still in flight over it.
+ *
+ * The goodput is only sampled over intervals during which the NI or peer NI
+ * was kept busy, so that it measures what it can carry rather than what it
+ * was offered, and is smoothed with a weight of 1/8.
+ */
+static void
+lnet_goodput_done(struct lnet_goodput *lg, unsigned int nob, bool busy)
+{
+	s64 now = ktime_get_ns();
+	s64 start = atomic64_read(&lg->lg_start);
+	s64 elapsed = now - start;
+	__u64 bytes;
+	__u64 rate;
+	__u64 old;
+
+	atomic64_add(nob, &lg->lg_bytes);
+
+	if (elapsed < LNET_GOODPUT_INTERVAL_NS ||
+	    atomic64_cmpxchg(&lg->lg_start, start, now) != start)
+		return;
+
+	bytes = atomic64_xchg(&lg->lg_bytes, 0);
+	if (elapsed > 2 * LNET_GOODPUT_INTERVAL_NS || !busy)
+		return;
+
+	rate = div64_u64(bytes * USEC_PER_SEC, div_u64(elapsed, NSEC_PER_USEC));
+	old = READ_ONCE(lg->lg_rate);
+	WRITE_ONCE(lg->lg_rate, old ? old - (old >> 3) + (rate >> 3) : rate);
+}
+
+/*
+ * Release the @nob bytes of a striped GET accounted in ni_stripe_qnob of
+ * the local NI @ni_nid, once its REPLY has arrived (@replied) or its
+ * response tracker is freed without one. Called with the net lock @cpt
+ * held.
+ */
+void
+lnet_stripe_get_done_locked(struct lnet_nid *ni_nid, unsigned int nob,
+			    int cpt, bool replied)
+{
+	struct lnet_ni *ni = lnet_nid_to_ni_locked(ni_nid, cpt);
+
+	if (!ni)
+		return;
+
+	if (replied) {
+		atomic64_inc(&ni->ni_stripe_count);
+		lnet_goodput_done(&ni->ni_stripe_bw, nob,
+				  atomic64_read(&ni->ni_stripe_qnob) > nob);
+	}
+	atomic64_sub(nob, &ni->ni_stripe_qnob);
+}
+
 static void
 lnet_msg_decommit_tx(struct lnet_msg *msg, int status)
 {
 	struct lnet_counters_common *common;
 	struct lnet_event *ev = &msg->msg_ev;
+	unsigned int nob;
 
 	LASSERT(msg->msg_tx_committed);
 	if (status != 0)
@@ -223,14 +283,35 @@ lnet_msg_decommit_tx(struct lnet_msg *msg, int status)
 	common->lcc_send_count++;
 
 incr_stats:
-	if (msg->msg_txpeer)
-		lnet_incr_stats(&msg->msg_txpeer->lpni_stats,
+	/* this message is still accounted in the bytes in flight */
+	nob = msg->msg_len + sizeof(struct lnet_hdr);
+	if (msg->msg_txpeer) {
+		struct lnet_peer_ni *txpeer = msg->msg_txpeer;
+
+		lnet_incr_stats(&txpeer->lpni_stats,
 				msg->msg_type,
 				LNET_STATS_TYPE_SEND);
-	if (msg->msg_txni)
-		lnet_incr_stats(&msg->msg_txni->ni_stats,
+		atomic64_add(msg->msg_len, &txpeer->lpni_stats.el_send_bytes);
+		lnet_goodput_done(&txpeer->lpni_goodput, nob,
+				  READ_ONCE(txpeer->lpni_txqnob) > nob);
+	}
+	if (msg->msg_txni) {
+		struct lnet_ni *txni = msg->msg_txni;
+
+		lnet_incr_stats(&txni->ni_stats,
 				msg->msg_type,
 				LNET_STATS_TYPE_SEND);
+		atomic64_add(msg->msg_len, &txni->ni_stats.el_send_bytes);
+		lnet_goodput_done(&txni->ni_goodput, nob,
+				  atomic64_read(&txni->ni_txqnob) > nob);
+		if (msg->msg_stripe) {
+			atomic64_inc(&txni->ni_stripe_count);
+			lnet_goodput_done(&txni->ni_stripe_bw,
+					  msg->msg_stripe_nob,
+					  atomic64_read(&txni->ni_stripe_qnob) >
+					  msg->msg_stripe_nob);
+		}
+	}
  out:
 	lnet_return_tx_credits_locked(msg);
 	msg->msg_tx_committed = 0;
@@ -284,14 +365,20 @@ lnet_msg_decommit_rx(struct lnet_msg *msg, int status)
 	common->lcc_recv_count++;
 
 incr_stats:
-	if (msg->msg_rxpeer)
+	if (msg->msg_rxpeer) {
 		lnet_incr_stats(&msg->msg_rxpeer->lpni_stats,
 				msg->msg_type,
 				LNET_STATS_TYPE_RECV);
-	if (msg->msg_rxni)
+		atomic64_add(msg->msg_len,
+			     &msg->msg_rxpeer->lpni_stats.el_recv_bytes);
+	}
+	if (msg->msg_rxni) {
 		lnet_incr_stats(&msg->msg_rxni->ni_stats,
 				msg->msg_type,
 				LNET_STATS_TYPE_RECV);
+		atomic64_add(msg->msg_len,
+			     &msg->msg_rxni->ni_stats.el_recv_bytes);
+	}
 	if (ev->type == LNET_EVENT_PUT || ev->type == LNET_EVENT_REPLY)
 		common->lcc_recv_length += msg->msg_wanted;
 
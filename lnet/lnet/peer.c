@@ -4069,13 +4069,18 @@ int lnet_get_peer_ni_info(__u32 peer_index, __u64 *nid,
 	return found ? 0 : -ENOENT;
 }
 
-/* ln_api_mutex is held, which keeps the peer list stable */
-int lnet_get_peer_info(struct lnet_ioctl_peer_cfg *cfg, void __user *bulk)
+/*
+ * ln_api_mutex is held, which keeps the peer list stable. With @perf, the
+ * hstats of each peer NI are followed by its struct lnet_ioctl_peer_ni_perf.
+ */
+int lnet_get_peer_info(struct lnet_ioctl_peer_cfg *cfg, void __user *bulk,
+		       bool perf)
 {
 	struct lnet_ioctl_element_stats *lpni_stats;
 	struct lnet_ioctl_element_msg_stats *lpni_msg_stats;
 	struct lnet_ioctl_peer_ni_hstats *lpni_hstats;
 	struct lnet_peer_ni_credit_info *lpni_info;
+	struct lnet_ioctl_peer_ni_perf lpni_perf;
 	struct lnet_peer_ni *lpni;
 	struct lnet_peer *lp;
 	lnet_nid_t nid;
@@ -4091,6 +4096,8 @@ int lnet_get_peer_info(struct lnet_ioctl_peer_cfg *cfg, void __user *bulk)
 
 	size = sizeof(nid) + sizeof(*lpni_info) + sizeof(*lpni_stats)
 		+ sizeof(*lpni_msg_stats) + sizeof(*lpni_hstats);
+	if (perf)
+		size += sizeof(lpni_perf);
 	size *= lp->lp_nnis;
 	if (size > cfg->prcfg_size) {
 		cfg->prcfg_size = size;
@@ -4179,6 +4186,15 @@ int lnet_get_peer_info(struct lnet_ioctl_peer_cfg *cfg, void __user *bulk)
 		if (copy_to_user(bulk, lpni_hstats, sizeof(*lpni_hstats)))
 			goto out_free_hstats;
 		bulk += sizeof(*lpni_hstats);
+
+		if (!perf)
+			continue;
+		memset(&lpni_perf, 0, sizeof(lpni_perf));
+		lpni_perf.ipp_rtt = READ_ONCE(lpni->lpni_rtt);
+		lpni_perf.ipp_goodput = READ_ONCE(lpni->lpni_goodput.lg_rate);
+		if (copy_to_user(bulk, &lpni_perf, sizeof(lpni_perf)))
+			goto out_free_hstats;
+		bulk += sizeof(lpni_perf);
 	}
 	rc = 0;
 
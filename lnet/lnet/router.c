@@ -48,6 +48,12 @@ MODULE_PARM_DESC(small_router_buffers, "# of small (1 page) messages to buffer i
 static int large_router_buffers;
 module_param(large_router_buffers, int, 0444);
 MODULE_PARM_DESC(large_router_buffers, "# of large messages to buffer in the router");
+static int auto_router_buffers;
+module_param(auto_router_buffers, int, 0644);
+MODULE_PARM_DESC(auto_router_buffers, "Resize router buffer pools with their usage");
+static int router_buffers_budget;
+module_param(router_buffers_budget, int, 0644);
+MODULE_PARM_DESC(router_buffers_budget, "MB auto-sized router buffers may use (0 for 1/8 of RAM)");
 static int peer_buffer_credits;
 module_param(peer_buffer_credits, int, 0444);
 MODULE_PARM_DESC(peer_buffer_credits, "# router buffer credits per peer");
@@ -1335,6 +1341,7 @@ lnet_rtrpool_free_bufs(struct lnet_rtrbufpool *rbp, int cpt)
 	rbp->rbp_req_nbuffers = 0;
 	rbp->rbp_nbuffers = rbp->rbp_credits = 0;
 	rbp->rbp_mincredits = 0;
+	rbp->rbp_win_mincredits = 0;
 	lnet_net_unlock(cpt);
 
 	/* Free buffers on the free list. */
@@ -1354,20 +1361,29 @@ lnet_rtrpool_adjust_bufs(struct lnet_rtrbufpool *rbp, int nbufs, int cpt)
 	int		num_buffers = 0;
 	int		old_req_nbufs;
 	int		npages = rbp->rbp_npages;
+	int		rc = 0;
 
 	lnet_net_lock(cpt);
 	/* If we are called for less buffers than already in the pool, we
-	 * just lower the req_nbuffers number and excess buffers will be
-	 * thrown away as they are returned to the free list.  Credits
-	 * then get adjusted as well.
+	 * lower the req_nbuffers number and free the excess buffers which
+	 * are idle, the others will be thrown away as they are returned
+	 * to the free list.  Credits then get adjusted as well.
 	 * If we already have enough buffers allocated to serve the
 	 * increase requested, then we can treat that the same way as we
 	 * do the decrease. */
 	num_rb = nbufs - rbp->rbp_nbuffers;
 	if (nbufs <= rbp->rbp_req_nbuffers || num_rb <= 0) {
 		rbp->rbp_req_nbuffers = nbufs;
+		while (rbp->rbp_nbuffers > nbufs && rbp->rbp_credits > 0) {
+			rb = list_first_entry(&rbp->rbp_bufs,
+					      struct lnet_rtrbuf, rb_list);
+			list_move(&rb->rb_list, &rb_list);
+			rbp->rbp_nbuffers--;
+			rbp->rbp_credits--;
+			rbp->rbp_win_mincredits = rbp->rbp_credits;
+		}
 		lnet_net_unlock(cpt);
-		return 0;
+		goto out_free;
 	}
 	/* store the older value of rbp_req_nbuffers and then set it to
 	 * the new request to prevent lnet_return_rx_credits_locked() from
@@ -1389,7 +1405,8 @@ lnet_rtrpool_adjust_bufs(struct lnet_rtrbufpool *rbp, int nbufs, int cpt)
 			rbp->rbp_req_nbuffers = old_req_nbufs;
 			lnet_net_unlock(cpt);
 
-			goto failed;
+			rc = -ENOMEM;
+			goto out_free;
 		}
 
 		list_add(&rb->rb_list, &rb_list);
@@ -1402,6 +1419,7 @@ lnet_rtrpool_adjust_bufs(struct lnet_rtrbufpool *rbp, int nbufs, int cpt)
 	rbp->rbp_nbuffers += num_buffers;
 	rbp->rbp_credits += num_buffers;
 	rbp->rbp_mincredits = rbp->rbp_credits;
+	rbp->rbp_win_mincredits = rbp->rbp_credits;
 	/* We need to schedule blocked msg using the newly
 	 * added buffers. */
 	while (!list_empty(&rbp->rbp_bufs) &&
@@ -1412,14 +1430,14 @@ lnet_rtrpool_adjust_bufs(struct lnet_rtrbufpool *rbp, int nbufs, int cpt)
 
 	return 0;
 
-failed:
+out_free:
 	while (!list_empty(&rb_list)) {
 		rb = list_entry(rb_list.next, struct lnet_rtrbuf, rb_list);
 		list_del(&rb->rb_list);
 		lnet_destroy_rtrbuf(rb, npages);
 	}
 
-	return -ENOMEM;
+	return rc;
 }
 
 static void
@@ -1431,6 +1449,7 @@ lnet_rtrpool_init(struct lnet_rtrbufpool *rbp, int npages)
 	rbp->rbp_npages = npages;
 	rbp->rbp_credits = 0;
 	rbp->rbp_mincredits = 0;
+	rbp->rbp_win_mincredits = 0;
 }
 
 void
@@ -1645,10 +1664,126 @@ lnet_rtrpools_adjust(int tiny, int small, int large)
 	 * failed.  It's up to the user space caller to revert the
 	 * changes. */
 
+	int rc;
+
 	if (!the_lnet.ln_routing)
 		return 0;
 
-	return lnet_rtrpools_adjust_helper(tiny, small, large);
+	mutex_lock(&the_lnet.ln_rtrpool_mutex);
+	rc = lnet_rtrpools_adjust_helper(tiny, small, large);
+	mutex_unlock(&the_lnet.ln_rtrpool_mutex);
+
+	return rc;
+}
+
+/* memory used by a buffer of @rbp */
+static int
+lnet_rtrbuf_size(struct lnet_rtrbufpool *rbp)
+{
+	return offsetof(struct lnet_rtrbuf, rb_kiov[rbp->rbp_npages]) +
+	       rbp->rbp_npages * PAGE_SIZE;
+}
+
+/*
+ * Resize the router buffer pools of each CPT with their usage since this was
+ * last called, if auto_router_buffers is set.  A pool which messages had to
+ * wait for grows by the number of buffers it was short of, plus a quarter,
+ * as long as all the pools fit in router_buffers_budget.  At most
+ * LNET_RTRPOOL_AUTO_GROW_MAX MB are allocated per call, a pool still short
+ * of buffers grows further the next time.  A pool which had more than half
+ * of its buffers idle all along gives half of them back, down to the
+ * minimum size of the pool.
+ *
+ * ln_api_mutex is only held to check that routing is on: the buffers are
+ * allocated under ln_rtrpool_mutex, so that configuration is not blocked
+ * meanwhile.
+ */
+void
+lnet_rtrpools_auto_adjust(void)
+{
+	static const int min_nbufs[LNET_NRBPOOLS] = {
+		[LNET_TINY_BUF_IDX]	= LNET_NRB_TINY_MIN,
+		[LNET_SMALL_BUF_IDX]	= LNET_NRB_SMALL_MIN,
+		[LNET_LARGE_BUF_IDX]	= LNET_NRB_LARGE_MIN,
+	};
+	struct lnet_rtrbufpool *rtrp;
+	s64 budget;
+	s64 round;
+	int i;
+	int j;
+
+	if (!auto_router_buffers)
+		return;
+
+	/* don't wait for configuration changes, nor shutdown */
+	if (!mutex_trylock(&the_lnet.ln_api_mutex))
+		return;
+
+	if (!the_lnet.ln_routing || !the_lnet.ln_rtrpools) {
+		mutex_unlock(&the_lnet.ln_api_mutex);
+		return;
+	}
+
+	/* only taken with ln_api_mutex held otherwise, so not contended */
+	mutex_lock(&the_lnet.ln_rtrpool_mutex);
+	mutex_unlock(&the_lnet.ln_api_mutex);
+
+	if (router_buffers_budget > 0)
+		budget = (s64)router_buffers_budget << 20;
+	else
+		budget = (s64)cfs_totalram_pages() << (PAGE_SHIFT - 3);
+
+	lnet_net_lock(LNET_LOCK_EX);
+	cfs_percpt_for_each(rtrp, i, the_lnet.ln_rtrpools) {
+		for (j = 0; j < LNET_NRBPOOLS; j++)
+			budget -= (s64)rtrp[j].rbp_nbuffers *
+				  lnet_rtrbuf_size(&rtrp[j]);
+	}
+	lnet_net_unlock(LNET_LOCK_EX);
+
+	round = min_t(s64, budget, (s64)LNET_RTRPOOL_AUTO_GROW_MAX << 20);
+
+	cfs_percpt_for_each(rtrp, i, the_lnet.ln_rtrpools) {
+		for (j = 0; j < LNET_NRBPOOLS; j++) {
+			struct lnet_rtrbufpool *rbp = &rtrp[j];
+			int size = lnet_rtrbuf_size(rbp);
+			int nbufs;
+			int grow;
+			int low;
+
+			lnet_net_lock(i);
+			nbufs = rbp->rbp_req_nbuffers;
+			low = rbp->rbp_win_mincredits;
+			rbp->rbp_win_mincredits = rbp->rbp_credits;
+			lnet_net_unlock(i);
+
+			/* as if a message had waited for a buffer */
+			if (CFS_FAIL_CHECK(CFS_FAIL_LNET_RTRBUF_WAIT))
+				low = min(low, -1);
+
+			if (low < 0) {
+				grow = -low + (nbufs >> 2);
+				if (round < (s64)grow * size)
+					grow = div_s64(max_t(s64, round, 0),
+						       size);
+				round -= (s64)grow * size;
+				nbufs += grow;
+			} else if (low > nbufs >> 1) {
+				nbufs = max(nbufs - low / 2, min_nbufs[j]);
+			}
+
+			if (nbufs == rbp->rbp_req_nbuffers)
+				continue;
+
+			CDEBUG(D_NET,
+			       "resizing %d page router buffer pool on CPT %d: %d -> %d buffers, low water mark %d\n",
+			       rbp->rbp_npages, i, rbp->rbp_req_nbuffers,
+			       nbufs, low);
+			lnet_rtrpool_adjust_bufs(rbp, nbufs, i);
+		}
+	}
+
+	mutex_unlock(&the_lnet.ln_rtrpool_mutex);
 }
 
 int
@@ -1659,6 +1794,7 @@ lnet_rtrpools_enable(void)
 	if (the_lnet.ln_routing)
 		return 0;
 
+	mutex_lock(&the_lnet.ln_rtrpool_mutex);
 	if (the_lnet.ln_rtrpools == NULL)
 		/* If routing is turned off, and we have never
 		 * initialized the pools before, just call the
@@ -1668,6 +1804,7 @@ lnet_rtrpools_enable(void)
 		rc = lnet_rtrpools_alloc(1);
 	else
 		rc = lnet_rtrpools_adjust_helper(0, 0, 0);
+	mutex_unlock(&the_lnet.ln_rtrpool_mutex);
 	if (rc != 0)
 		return rc;
 
@@ -1700,7 +1837,10 @@ lnet_rtrpools_disable(void)
 	small_router_buffers = 0;
 	large_router_buffers = 0;
 	lnet_net_unlock(LNET_LOCK_EX);
+
+	mutex_lock(&the_lnet.ln_rtrpool_mutex);
 	lnet_rtrpools_free(1);
+	mutex_unlock(&the_lnet.ln_rtrpool_mutex);
 }
 
 static inline void
@@ -595,6 +595,89 @@ static int proc_lnet_buffers(struct ctl_table *table, int write,
 	return rc;
 }
 
+static int proc_lnet_buffer_waits(struct ctl_table *table, int write,
+				  void __user *buffer, size_t *lenp,
+				  loff_t *ppos)
+{
+	struct lnet_rtrbufpool *rbp;
+	size_t nob = *lenp;
+	loff_t pos = *ppos;
+	char *s;
+	char *tmpstr;
+	int tmpsiz;
+	int idx;
+	int len;
+	int rc;
+	int i;
+	int j;
+
+	if (write) {
+		/* Just reset the wait stats. */
+		lnet_net_lock(LNET_LOCK_EX);
+		if (the_lnet.ln_rtrpools != NULL) {
+			cfs_percpt_for_each(rbp, i, the_lnet.ln_rtrpools) {
+				for (idx = 0; idx < LNET_NRBPOOLS; idx++) {
+					rbp[idx].rbp_nwaits = 0;
+					memset(rbp[idx].rbp_wait_hist, 0,
+					       sizeof(rbp[idx].rbp_wait_hist));
+				}
+			}
+		}
+		lnet_net_unlock(LNET_LOCK_EX);
+		return 0;
+	}
+
+	/* 3 %d and up to LNET_RTRPOOL_WAIT_BUCKETS %d:%llu per line */
+	tmpsiz = (32 + 32 * LNET_RTRPOOL_WAIT_BUCKETS) *
+		 (LNET_NRBPOOLS * LNET_CPT_NUMBER + 1);
+	LIBCFS_ALLOC(tmpstr, tmpsiz);
+	if (tmpstr == NULL)
+		return -ENOMEM;
+
+	s = tmpstr; /* points to current position in tmpstr[] */
+
+	s += scnprintf(s, tmpstr + tmpsiz - s,
+		       "%5s %3s %10s %s\n",
+		       "pages", "cpt", "waits", "usecs:count");
+	LASSERT(tmpstr + tmpsiz - s > 0);
+
+	if (the_lnet.ln_rtrpools == NULL)
+		goto out; /* I'm not a router */
+
+	for (idx = 0; idx < LNET_NRBPOOLS; idx++) {
+		lnet_net_lock(LNET_LOCK_EX);
+		cfs_percpt_for_each(rbp, i, the_lnet.ln_rtrpools) {
+			s += scnprintf(s, tmpstr + tmpsiz - s,
+				       "%5d %3d %10llu",
+				       rbp[idx].rbp_npages, i,
+				       rbp[idx].rbp_nwaits);
+			/* buckets from 2^j usecs, the first one from 0 */
+			for (j = 0; j < LNET_RTRPOOL_WAIT_BUCKETS; j++) {
+				if (rbp[idx].rbp_wait_hist[j] == 0)
+					continue;
+				s += scnprintf(s, tmpstr + tmpsiz - s,
+					       " %u:%llu", j ? 1U << j : 0,
+					       rbp[idx].rbp_wait_hist[j]);
+			}
+			s += scnprintf(s, tmpstr + tmpsiz - s, "\n");
+			LASSERT(tmpstr + tmpsiz - s > 0);
+		}
+		lnet_net_unlock(LNET_LOCK_EX);
+	}
+
+ out:
+	len = s - tmpstr;
+
+	if (pos >= min_t(int, len, strlen(tmpstr)))
+		rc = 0;
+	else
+		rc = cfs_trace_copyout_string(buffer, nob,
+					      tmpstr + pos, NULL);
+
+	LIBCFS_FREE(tmpstr, tmpsiz);
+	return rc;
+}
+
 static int
 proc_lnet_nis(struct ctl_table *table, int write, void __user *buffer,
 	      size_t *lenp, loff_t *ppos)
@@ -871,6 +954,11 @@ static struct ctl_table lnet_table[] = {
 		.mode		= 0444,
 		.proc_handler	= &proc_lnet_buffers,
 	},
+	{
+		.procname	= "buffer_waits",
+		.mode		= 0644,
+		.proc_handler	= &proc_lnet_buffer_waits,
+	},
 	{
 		.procname	= "nis",
 		.mode		= 0644,
@@ -46,6 +46,11 @@ MODULE_PARM_DESC(ping_srv_workitems, "# PING server workitems");
 struct lst_ping_data {
 	spinlock_t	pnd_lock;	/* serialize */
 	int		pnd_counter;	/* sequence counter */
+	/* round-trip times of the replies, in nsec */
+	__u64		pnd_rtt_count;
+	__u64		pnd_rtt_min;
+	__u64		pnd_rtt_max;
+	__u64		pnd_rtt_sum;
 };
 
 static struct lst_ping_data lst_ping_data;
@@ -60,6 +65,10 @@ ping_client_init(struct sfw_test_instance *tsi)
 
 	spin_lock_init(&lst_ping_data.pnd_lock);
 	lst_ping_data.pnd_counter = 0;
+	lst_ping_data.pnd_rtt_count = 0;
+	lst_ping_data.pnd_rtt_min = U64_MAX;
+	lst_ping_data.pnd_rtt_max = 0;
+	lst_ping_data.pnd_rtt_sum = 0;
 
 	return 0;
 }
@@ -68,6 +77,10 @@ static void
 ping_client_fini(struct sfw_test_instance *tsi)
 {
 	struct sfw_session *sn = tsi->tsi_batch->bat_session;
+	__u64 count;
+	__u64 min;
+	__u64 max;
+	__u64 sum;
         int            errors;
 
         LASSERT (sn != NULL);
@@ -78,6 +91,19 @@ ping_client_fini(struct sfw_test_instance *tsi)
                 CWARN ("%d pings have failed.\n", errors);
         else
                 CDEBUG (D_NET, "Ping test finished OK.\n");
+
+	spin_lock(&lst_ping_data.pnd_lock);
+	count = lst_ping_data.pnd_rtt_count;
+	min = lst_ping_data.pnd_rtt_min;
+	max = lst_ping_data.pnd_rtt_max;
+	sum = lst_ping_data.pnd_rtt_sum;
+	spin_unlock(&lst_ping_data.pnd_lock);
+
+	if (count > 0)
+		LCONSOLE_INFO("%llu pings, round-trip min/avg/max %llu/%llu/%llu usec\n",
+			      count, div_u64(min, NSEC_PER_USEC),
+			      div64_u64(sum, count * NSEC_PER_USEC),
+			      div_u64(max, NSEC_PER_USEC));
 }
 
 static int
@@ -120,6 +146,7 @@ ping_client_done_rpc(struct sfw_test_unit *tsu, struct srpc_client_rpc *rpc)
 	struct srpc_ping_reqst *reqst = &rpc->crpc_reqstmsg.msg_body.ping_reqst;
 	struct srpc_ping_reply *reply = &rpc->crpc_replymsg.msg_body.ping_reply;
 	struct timespec64 ts;
+	__u64 nsec;
 
 	LASSERT(sn != NULL);
 
@@ -157,9 +184,18 @@ ping_client_done_rpc(struct sfw_test_unit *tsu, struct srpc_client_rpc *rpc)
         }
 
 	ktime_get_real_ts64(&ts);
-	CDEBUG(D_NET, "%d reply in %llu nsec\n", reply->pnr_seq,
-	       (u64)((ts.tv_sec - reqst->pnr_time_sec) * NSEC_PER_SEC +
-		    (ts.tv_nsec - reqst->pnr_time_nsec)));
+	nsec = (ts.tv_sec - reqst->pnr_time_sec) * NSEC_PER_SEC +
+	       (ts.tv_nsec - reqst->pnr_time_nsec);
+	CDEBUG(D_NET, "%d reply in %llu nsec\n", reply->pnr_seq, nsec);
+
+	spin_lock(&lst_ping_data.pnd_lock);
+	lst_ping_data.pnd_rtt_count++;
+	lst_ping_data.pnd_rtt_sum += nsec;
+	if (nsec < lst_ping_data.pnd_rtt_min)
+		lst_ping_data.pnd_rtt_min = nsec;
+	if (nsec > lst_ping_data.pnd_rtt_max)
+		lst_ping_data.pnd_rtt_max = nsec;
+	spin_unlock(&lst_ping_data.pnd_lock);
 }
 
 static int
@@ -2622,6 +2622,36 @@ int lustre_lnet_config_recovery_limit(int val, int seq_no,
 	return rc;
 }
 
+int lustre_lnet_config_bulk_stripe(int val, int seq_no,
+				   struct cYAML **err_rc)
+{
+	int rc = LUSTRE_CFG_RC_NO_ERR;
+	char err_str[LNET_MAX_STR_LEN];
+	char val_str[LNET_MAX_STR_LEN];
+
+	if (val < 0) {
+		rc = LUSTRE_CFG_RC_BAD_PARAM;
+		snprintf(err_str, sizeof(err_str),
+			 "\"Must be greater than or equal to 0\"");
+	} else {
+		snprintf(err_str, sizeof(err_str), "\"success\"");
+
+		snprintf(val_str, sizeof(val_str), "%d", val);
+
+		rc = write_sysfs_file(modparam_path, "lnet_bulk_stripe",
+				      val_str, 1, strlen(val_str) + 1);
+		if (rc)
+			snprintf(err_str, sizeof(err_str),
+				 "\"cannot configure bulk stripe: %s\"",
+				 strerror(errno));
+	}
+
+	cYAML_build_error(rc, seq_no, ADD_CMD, "bulk_stripe", err_str,
+			  err_rc);
+
+	return rc;
+}
+
 int lustre_lnet_config_max_intf(int max, int seq_no, struct cYAML **err_rc)
 {
 	int rc = LUSTRE_CFG_RC_NO_ERR;
@@ -2915,8 +2945,10 @@ int lustre_lnet_show_peer(char *knid, int detail, int seq_no,
 	struct lnet_ioctl_element_stats *lpni_stats;
 	struct lnet_ioctl_element_msg_stats *msg_stats;
 	struct lnet_ioctl_peer_ni_hstats *hstats;
+	struct lnet_ioctl_peer_ni_perf *perf;
 	struct lnet_ioctl_construct_udsp_info udsp_info;
 	lnet_nid_t *nidp;
+	size_t rec_size;
 	int rc = LUSTRE_CFG_RC_OUT_OF_MEM;
 	int i, j, k;
 	int l_errno = 0;
@@ -2999,6 +3031,7 @@ int lustre_lnet_show_peer(char *knid, int detail, int seq_no,
 			peer_info.prcfg_prim_nid = list[i].nid;
 			peer_info.prcfg_size = size;
 			peer_info.prcfg_bulk = data;
+			peer_info.prcfg_flags = LNET_PEER_CFG_F_PERF;
 
 			l_errno = 0;
 			rc = l_ioctl(LNET_DEV_ID, IOC_LIBCFS_GET_PEER_NI,
@@ -3024,6 +3057,14 @@ int lustre_lnet_show_peer(char *knid, int detail, int seq_no,
 		}
 		exist = true;
 
+		/* older modules ignore prcfg_flags and append no perf record */
+		rec_size = sizeof(*nidp) + sizeof(*lpni_cri) +
+			   sizeof(*lpni_stats) + sizeof(*msg_stats) +
+			   sizeof(*hstats);
+		if (peer_info.prcfg_count &&
+		    peer_info.prcfg_size / peer_info.prcfg_count > rec_size)
+			rec_size += sizeof(*perf);
+
 		peer = cYAML_create_seq_item(peer_root);
 		if (peer == NULL)
 			goto out;
@@ -3063,7 +3104,10 @@ int lustre_lnet_show_peer(char *knid, int detail, int seq_no,
 			lpni_stats = (void *)lpni_cri + sizeof(*lpni_cri);
 			msg_stats = (void *)lpni_stats + sizeof(*lpni_stats);
 			hstats = (void *)msg_stats + sizeof(*msg_stats);
-			lpni_data = (void *)hstats + sizeof(*hstats);
+			perf = (void *)hstats + sizeof(*hstats);
+			if ((void *)perf - lpni_data == rec_size)
+				perf = NULL;
+			lpni_data += rec_size;
 
 			peer_ni = cYAML_create_seq_item(tmp);
 			if (peer_ni == NULL)
@@ -3140,6 +3184,16 @@ continue_without_udsp_info:
 						lpni_cri->cr_refcount) == NULL)
 				goto out;
 
+			if (perf &&
+			    cYAML_create_number(peer_ni, "rtt_usec",
+						perf->ipp_rtt) == NULL)
+				goto out;
+
+			if (perf &&
+			    cYAML_create_number(peer_ni, "goodput",
+						perf->ipp_goodput) == NULL)
+				goto out;
+
 			statistics = cYAML_create_object(peer_ni, "statistics");
 			if (statistics == NULL)
 				goto out;
@@ -3769,6 +3823,31 @@ int lustre_lnet_show_recovery_limit(int seq_no, struct cYAML **show_rc,
 				       show_rc, err_rc, l_errno);
 }
 
+int lustre_lnet_show_bulk_stripe(int seq_no, struct cYAML **show_rc,
+				 struct cYAML **err_rc)
+{
+	int rc = LUSTRE_CFG_RC_OUT_OF_MEM;
+	char val[LNET_MAX_STR_LEN];
+	int bulk_stripe = -1, l_errno = 0;
+	char err_str[LNET_MAX_STR_LEN];
+
+	snprintf(err_str, sizeof(err_str), "\"out of memory\"");
+
+	rc = read_sysfs_file(modparam_path, "lnet_bulk_stripe", val,
+			     1, sizeof(val));
+	if (rc) {
+		l_errno = -errno;
+		snprintf(err_str, sizeof(err_str),
+			 "\"cannot get lnet_bulk_stripe value: %d\"", rc);
+	} else {
+		bulk_stripe = atoi(val);
+	}
+
+	return build_global_yaml_entry(err_str, sizeof(err_str), seq_no,
+				       "bulk_stripe", bulk_stripe,
+				       show_rc, err_rc, l_errno);
+}
+
 int lustre_lnet_show_max_intf(int seq_no, struct cYAML **show_rc,
 			      struct cYAML **err_rc)
 {
@@ -3850,6 +3929,70 @@ int lustre_lnet_show_numa_range(int seq_no, struct cYAML **show_rc,
 					"numa_range", show_rc, err_rc);
 }
 
+/*
+ * per local NI byte counters, how messages are striped over them, and their
+ * measured round-trip time and goodput
+ */
+static bool add_rail_stats_to_yaml(struct cYAML *stats)
+{
+	struct lnet_ioctl_rail_stats rail_stats;
+	struct cYAML *rails = NULL, *item;
+	int i;
+
+	for (i = 0; ; i++) {
+		LIBCFS_IOC_INIT_V2(rail_stats, irs_hdr);
+		rail_stats.irs_idx = i;
+
+		if (l_ioctl(LNET_DEV_ID, IOC_LIBCFS_GET_LOCAL_NI_RAIL_STATS,
+			    &rail_stats) != 0)
+			break;
+
+		if (!rails) {
+			rails = cYAML_create_seq(stats, "rails");
+			if (!rails)
+				return false;
+		}
+
+		item = cYAML_create_seq_item(rails);
+		if (!item)
+			return false;
+
+		if (!cYAML_create_string(item, "nid",
+					 libcfs_nid2str(rail_stats.irs_nid)))
+			return false;
+
+		if (!cYAML_create_number(item, "send_bytes",
+					 rail_stats.irs_send_bytes))
+			return false;
+
+		if (!cYAML_create_number(item, "recv_bytes",
+					 rail_stats.irs_recv_bytes))
+			return false;
+
+		if (!cYAML_create_number(item, "stripe_count",
+					 rail_stats.irs_stripe_count))
+			return false;
+
+		if (!cYAML_create_number(item, "stripe_inflight",
+					 rail_stats.irs_stripe_inflight))
+			return false;
+
+		if (!cYAML_create_number(item, "stripe_bandwidth",
+					 rail_stats.irs_stripe_bw))
+			return false;
+
+		if (!cYAML_create_number(item, "rtt_usec",
+					 rail_stats.irs_rtt))
+			return false;
+
+		if (!cYAML_create_number(item, "goodput",
+					 rail_stats.irs_goodput))
+			return false;
+	}
+
+	return true;
+}
+
 int lustre_lnet_show_stats(int seq_no, struct cYAML **show_rc,
 			   struct cYAML **err_rc)
 {
@@ -3981,6 +4124,9 @@ int lustre_lnet_show_stats(int seq_no, struct cYAML **show_rc,
 				 cntrs->lct_common.lcc_drop_length))
 		goto out;
 
+	if (!add_rail_stats_to_yaml(stats))
+		goto out;
+
 	if (!show_rc)
 		cYAML_print_tree(root);
 
@@ -4834,7 +4980,7 @@ static int handle_yaml_config_global_settings(struct cYAML *tree,
 {
 	struct cYAML *max_intf, *numa, *discovery, *retry, *tto, *seq_no,
 		     *sen, *recov, *rsen, *drop_asym_route, *rsp_tracking,
-		     *recov_limit;
+		     *recov_limit, *bulk_stripe;
 	int rc = 0;
 
 	seq_no = cYAML_get_object_item(tree, "seq_no");
@@ -4917,6 +5063,13 @@ static int handle_yaml_config_global_settings(struct cYAML *tree,
 							: -1,
 						       err_rc);
 
+	bulk_stripe = cYAML_get_object_item(tree, "bulk_stripe");
+	if (bulk_stripe)
+		rc = lustre_lnet_config_bulk_stripe(bulk_stripe->cy_valueint,
+						    seq_no ? seq_no->cy_valueint
+							: -1,
+						    err_rc);
+
 	return rc;
 }
 
@@ -4967,7 +5120,7 @@ static int handle_yaml_show_global_settings(struct cYAML *tree,
 {
 	struct cYAML *max_intf, *numa, *discovery, *retry, *tto, *seq_no,
 		     *sen, *recov, *rsen, *drop_asym_route, *rsp_tracking,
-		     *recov_limit;
+		     *recov_limit, *bulk_stripe;
 	int rc = 0;
 
 	seq_no = cYAML_get_object_item(tree, "seq_no");
@@ -5041,6 +5194,13 @@ static int handle_yaml_show_global_settings(struct cYAML *tree,
 						     -1,
 						     show_rc, err_rc);
 
+	bulk_stripe = cYAML_get_object_item(tree, "bulk_stripe");
+	if (bulk_stripe)
+		rc = lustre_lnet_show_bulk_stripe(seq_no ?
+						  seq_no->cy_valueint :
+						  -1,
+						  show_rc, err_rc);
+
 	return rc;
 }
 
@@ -498,6 +498,10 @@ int lustre_lnet_config_recovery_limit(int val, int seq_no,
 				      struct cYAML **err_rc);
 int lustre_lnet_show_recovery_limit(int seq_no, struct cYAML **show_rc,
 				    struct cYAML **err_rc);
+int lustre_lnet_config_bulk_stripe(int val, int seq_no,
+				   struct cYAML **err_rc);
+int lustre_lnet_show_bulk_stripe(int seq_no, struct cYAML **show_rc,
+				 struct cYAML **err_rc);
 
 /*
  * lustre_lnet_config_max_intf
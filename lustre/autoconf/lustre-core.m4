@@ -1923,6 +1923,24 @@ key_usage_refcount, [
 ])
 ]) #LC_HAVE_KEY_USAGE_REFCOUNT
 
+#
+# LC_HAVE_CRYPTO_ACOMP
+#
+# Kernel version 4.10 commit 2ebda74fd6c9d3fc3b9f0234fc519795e23025a5
+# added the asynchronous compression API, crypto_alloc_acomp().
+#
+AC_DEFUN([LC_HAVE_CRYPTO_ACOMP], [
+LB_CHECK_COMPILE([if crypto_alloc_acomp is defined],
+crypto_alloc_acomp, [
+	#include <crypto/acompress.h>
+],[
+	crypto_alloc_acomp(NULL, 0, 0);
+],[
+	AC_DEFINE(HAVE_CRYPTO_ACOMP, 1,
+		[crypto_alloc_acomp is defined])
+])
+]) # LC_HAVE_CRYPTO_ACOMP
+
 #
 # LC_HAVE_CRYPTO_MAX_ALG_NAME_128
 #
@@ -2546,6 +2564,7 @@ AC_DEFUN([LC_PROG_LINUX], [
 	# 4.10
 	LC_IOP_GENERIC_READLINK
 	LC_HAVE_VM_FAULT_ADDRESS
+	LC_HAVE_CRYPTO_ACOMP
 
 	# 4.11
 	LC_INODEOPS_ENHANCED_GETATTR
@@ -2332,6 +2332,25 @@ void cl_lock_descr_print(const struct lu_env *env, void *cookie,
 			 const struct cl_lock_descr *descr);
 /* @} helper */
 
+/**
+ * Per-CPT part of the LRU budget of a cl_client_cache.
+ *
+ * Free LRU slots are kept close to the CPUs using them, so that allocating
+ * and freeing cached pages does not bounce a single counter between all the
+ * CPUs of the client. A CPT running short borrows slots from the others,
+ * see cl_cache_lru_get().
+ */
+struct cl_lru_budget {
+	/**
+	 * # of LRU entries available in this CPT
+	 */
+	atomic_long_t		clb_left;
+	/**
+	 * stats: # of LRU entries borrowed from other CPTs
+	 */
+	atomic_long_t		clb_borrowed;
+};
+
 /**
  * Data structure managing a client's cached pages. A count of
  * "unstable" pages is maintained, and an LRU of clean pages is
@@ -2349,9 +2368,9 @@ struct cl_client_cache {
 	 */
 	unsigned int		ccc_lru_shrinkers;
 	/**
-	 * # of LRU entries available
+	 * # of LRU entries available, per CPT
 	 */
-	atomic_long_t		ccc_lru_left;
+	struct cl_lru_budget	**ccc_lru_budget;
 	/**
 	 * List of entities(OSCs) for this LRU cache
 	 */
@@ -2388,6 +2407,11 @@ struct cl_client_cache {
 struct cl_client_cache *cl_cache_init(unsigned long lru_page_max);
 void cl_cache_incref(struct cl_client_cache *cache);
 void cl_cache_decref(struct cl_client_cache *cache);
+long cl_cache_lru_left(struct cl_client_cache *cache);
+long cl_cache_lru_left_cpt(struct cl_client_cache *cache, int cpt);
+long cl_cache_lru_get(struct cl_client_cache *cache, int cpt, long nr,
+		      long extra);
+void cl_cache_lru_put(struct cl_client_cache *cache, int cpt, long nr);
 
 /** @} cl_page */
 
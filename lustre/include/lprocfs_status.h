@@ -156,12 +156,18 @@ struct rename_stats {
  * squares (for multi-valued counter samples only). This allows
  * external computation of standard deviation, but involves a 64-bit
  * multiply per counter increment.
+ *
+ * LPROCFS_CNTR_HISTOGRAM indicates that the counter also keeps a log2
+ * histogram of its samples, so that percentiles can be computed. It is
+ * updated locklessly, but costs a per-CPU struct lprocfs_counter_hist
+ * for every possible CPU, so keep it for the few counters that need it.
  */
 
 enum {
 	LPROCFS_CNTR_EXTERNALLOCK	= 0x0001,
 	LPROCFS_CNTR_AVGMINMAX		= 0x0002,
 	LPROCFS_CNTR_STDDEV		= 0x0004,
+	LPROCFS_CNTR_HISTOGRAM		= 0x0008,
 
 	/* counter data type */
 	LPROCFS_TYPE_REQS		= 0x0100,
@@ -178,10 +184,31 @@ enum {
 };
 #define LC_MIN_INIT ((~(__u64)0) >> 1)
 
+/*
+ * Bucket 0 of an LPROCFS_CNTR_HISTOGRAM counter counts the samples below 1,
+ * bucket i the samples in [2^(i-1), 2^i), and the last bucket also all the
+ * bigger samples.
+ */
+#define LPROCFS_HIST_BUCKETS	32
+
+struct lprocfs_counter_hist {
+	__u64	lh_buckets[LPROCFS_HIST_BUCKETS];
+};
+
+static inline unsigned int lprocfs_hist_bucket(long amount)
+{
+	if (amount <= 0)
+		return 0;
+
+	return min_t(unsigned int, fls64(amount), LPROCFS_HIST_BUCKETS - 1);
+}
+
 struct lprocfs_counter_header {
 	unsigned int		lc_config;
 	const char		*lc_name;   /* must be static */
 	const char		*lc_units;  /* must be static */
+	/* only with LPROCFS_CNTR_HISTOGRAM */
+	struct lprocfs_counter_hist __percpu *lc_hist;
 };
 
 struct lprocfs_counter {
@@ -214,6 +241,9 @@ enum lprocfs_stats_flags {
 	LPROCFS_STATS_FLAG_NOPERCPU = 0x0001, /* stats have no percpu
 					       * area and need locking */
 	LPROCFS_STATS_FLAG_IRQ_SAFE = 0x0002, /* alloc need irq safe */
+	LPROCFS_STATS_FLAG_NOHIST   = 0x0004, /* histograms are kept by the
+					       * user of the stats, e.g. job
+					       * stats, not per-CPU ones */
 };
 
 enum lprocfs_fields_flags {
@@ -384,6 +414,8 @@ enum {
         PTLRPC_REQACTIVE_CNTR,
         PTLRPC_TIMEOUT,
         PTLRPC_REQBUF_AVAIL_CNTR,
+	PTLRPC_REPCOMMIT_CNTR,
+	PTLRPC_REQSERVICE_CNTR,
         PTLRPC_LAST_CNTR
 };
 
@@ -426,14 +458,25 @@ struct obd_histogram;
 typedef void (*cntr_init_callback)(struct lprocfs_stats *stats,
 				   unsigned int offset);
 
+struct job_stats_ring;
+
+#define OJS_NO_HIST	((unsigned short)~0)
+
 struct obd_job_stats {
 	struct cfs_hash	       *ojs_hash;	/* hash of jobids */
 	struct list_head	ojs_list;	/* list of job_stat structs */
 	rwlock_t		ojs_lock;	/* protect ojs_list/js_list */
+	struct list_head	ojs_dirty;	/* jobs to publish */
+	spinlock_t		ojs_dirty_lock;	/* protect ojs_dirty/js_dirty */
+	struct job_stats_ring  *ojs_ring;	/* binary export, once opened */
+	struct mutex		ojs_ring_mutex;	/* protect ojs_ring */
 	ktime_t			ojs_cleanup_interval;/* 1/2 expiry seconds */
 	ktime_t			ojs_cleanup_last;/* previous cleanup time */
 	cntr_init_callback	ojs_cntr_init_fn;/* lprocfs_stats initializer */
 	unsigned short		ojs_cntr_num;	/* number of stats in struct */
+	unsigned short		ojs_hist_num;	/* per-job histograms */
+	/* histogram of each LPROCFS_CNTR_HISTOGRAM counter, or OJS_NO_HIST */
+	unsigned short	       *ojs_hist_idx;
 	bool			ojs_cleaning;	/* currently expiring stats */
 };
 
@@ -546,6 +589,10 @@ extern int lprocfs_nid_stats_clear_seq_show(struct seq_file *file, void *data);
 extern int lprocfs_register_stats(struct proc_dir_entry *root, const char *name,
 				  struct lprocfs_stats *stats);
 extern const struct file_operations ldebugfs_stats_seq_fops;
+extern int lprocfs_register_stats_hist(struct proc_dir_entry *root,
+				       const char *name,
+				       struct lprocfs_stats *stats);
+extern const struct file_operations ldebugfs_stats_hist_seq_fops;
 
 /* lprocfs_status.c */
 extern void ldebugfs_add_vars(struct dentry *parent, struct ldebugfs_vars *var,
@@ -633,6 +680,8 @@ unsigned long lprocfs_oh_sum(struct obd_histogram *oh);
 
 void lprocfs_stats_collect(struct lprocfs_stats *stats, int idx,
                            struct lprocfs_counter *cnt);
+void lprocfs_stats_collect_hist(struct lprocfs_stats *stats, int idx,
+				struct lprocfs_counter_hist *hist);
 
 #ifdef HAVE_SERVER_SUPPORT
 /* lprocfs_status.c: recovery status */
@@ -837,8 +886,14 @@ extern const struct sysfs_ops lustre_sysfs_ops;
 struct ptlrpc_request;
 extern void target_print_req(void *seq_file, struct ptlrpc_request *req);
 
-#ifdef HAVE_SERVER_SUPPORT
 /* lprocfs_jobstats.c */
+int lprocfs_job_stats_register(struct obd_job_stats *stats,
+			       struct proc_dir_entry *parent, int cntr_num,
+			       cntr_init_callback fn);
+void lprocfs_job_stats_unregister(struct obd_job_stats *stats);
+int lprocfs_job_stats_add(struct obd_job_stats *stats, const char *jobid,
+			  int event, long amount);
+#ifdef HAVE_SERVER_SUPPORT
 int lprocfs_job_stats_log(struct obd_device *obd, char *jobid,
 			  int event, long amount);
 void lprocfs_job_stats_fini(struct obd_device *obd);
@@ -916,6 +971,10 @@ static inline int lprocfs_register_stats(struct proc_dir_entry *root,
                                          const char *name,
                                          struct lprocfs_stats *stats)
 { return 0; }
+static inline int lprocfs_register_stats_hist(struct proc_dir_entry *root,
+					      const char *name,
+					      struct lprocfs_stats *stats)
+{ return 0; }
 static inline void lprocfs_init_ldlm_stats(struct lprocfs_stats *ldlm_stats)
 { return; }
 static inline int lprocfs_alloc_obd_stats(struct obd_device *obd,
@@ -1058,6 +1117,10 @@ void lprocfs_stats_collect(struct lprocfs_stats *stats, int idx,
                            struct lprocfs_counter *cnt)
 { return; }
 static inline
+void lprocfs_stats_collect_hist(struct lprocfs_stats *stats, int idx,
+				struct lprocfs_counter_hist *hist)
+{ return; }
+static inline
 u64 lprocfs_stats_collector(struct lprocfs_stats *stats, int idx,
 			    enum lprocfs_fields_flags field)
 { return (__u64)0; }
@@ -1070,6 +1133,18 @@ u64 lprocfs_stats_collector(struct lprocfs_stats *stats, int idx,
 
 /* lprocfs_jobstats.c */
 static inline
+int lprocfs_job_stats_register(struct obd_job_stats *stats,
+			       struct proc_dir_entry *parent, int cntr_num,
+			       cntr_init_callback fn)
+{ return 0; }
+static inline
+void lprocfs_job_stats_unregister(struct obd_job_stats *stats)
+{ return; }
+static inline
+int lprocfs_job_stats_add(struct obd_job_stats *stats, const char *jobid,
+			  int event, long amount)
+{ return 0; }
+static inline
 int lprocfs_job_stats_log(struct obd_device *obd, char *jobid, int event,
 			  long amount)
 { return 0; }
@@ -218,6 +218,12 @@ struct lu_target {
 	/* FMD (file modification data) values */
 	int			 lut_fmd_max_num;
 	time64_t		 lut_fmd_max_age;
+
+	/* compressed BRW write bulk stats, see tgt_brw_decompress() */
+	atomic64_t		 lut_compr_rpcs;
+	atomic64_t		 lut_compr_bulk_bytes;
+	atomic64_t		 lut_compr_data_bytes;
+	atomic64_t		 lut_compr_usec;
 };
 
 #define LUT_FMD_MAX_NUM_DEFAULT 128
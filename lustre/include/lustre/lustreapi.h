@@ -486,6 +486,7 @@ int llapi_get_lum_file_fd(int dir_fd, const char *fname, __u64 *valid,
 			  size_t lumsize);
 int llapi_get_lum_dir_fd(int dir_fd, __u64 *valid, lstatx_t *statx,
 			 struct lov_user_md *lum, size_t lumsize);
+int llapi_readdir_plus(int dir_fd, __u64 *offset, void *buf, size_t size);
 
 int llapi_fd2fid(int fd, struct lu_fid *fid);
 /* get FID of parent dir + the related name of entry in this parent dir */
@@ -644,6 +645,7 @@ int llapi_hole_punch(int fd, off_t start, size_t length);
 /* Ladvise */
 int llapi_ladvise(int fd, unsigned long long flags, int num_advise,
 		  struct llapi_lu_ladvise *ladvise);
+int llapi_statahead_names(int dirfd, int count, const char **names);
 
 /* PCC */
 int llapi_pcc_attach(const char *path, __u32 id, enum lu_pcc_type type);
@@ -1094,6 +1096,16 @@ static const struct comp_flag_name {
 	{ LCME_FL_EXTENSION,	"extension" },
 };
 
+/**
+ * Gets the compression type of BRW writes of the current component.
+ */
+int llapi_layout_compress_get(const struct llapi_layout *layout,
+			      enum ll_compr_type *type);
+/**
+ * Sets the compression type of BRW writes of the current component.
+ */
+int llapi_layout_compress_set(struct llapi_layout *layout,
+			      enum ll_compr_type type);
 /**
  * Gets the attribute flags of the current component.
  */
@@ -1057,13 +1057,12 @@ struct ldlm_resource {
 
 	/**
 	 * List item for list in namespace hash.
-	 * protected by ns_lock.
-	 * Shared with linkage for RCU-delayed free.
+	 * Modified under the hash bucket lock, walked under rcu_read_lock()
+	 * by ldlm_resource_get(), so it must stay valid until lr_rcu fires.
 	 */
-	union {
-		struct hlist_node	lr_hash;
-		struct rcu_head		lr_rcu;
-	};
+	struct hlist_node	lr_hash;
+	/** Linkage for RCU-delayed free */
+	struct rcu_head		lr_rcu;
 
 	/** Reference count for this resource */
 	atomic_t		lr_refcount;
@@ -1257,6 +1256,8 @@ struct ldlm_enqueue_info {
 	u64		ei_inodebits;	/** lock inode bits **/
 	unsigned int	ei_enq_slave:1;	/** whether enqueue slave stripes */
 	unsigned int	ei_enq_slot:1;	/** whether acquire rpc slot */
+	unsigned int	ei_batch:1;	/** packed into a batched RPC, which
+					 * holds the rpc slot itself */
 };
 
 #define ei_res_id	ei_cb_gl
@@ -50,6 +50,7 @@
  * @{
  */
 #include <linux/kobject.h>
+#include <linux/llist.h>
 #include <linux/rhashtable.h>
 #include <linux/uio.h>
 #include <libcfs/libcfs.h>
@@ -373,6 +374,15 @@
 #define OUT_MAXREQSIZE	(1000 * 1024)
 #define OUT_MAXREPSIZE	MDS_MAXREPSIZE
 
+/**
+ * The batched RPC (MDS_MSG_BATCH) is served on the regular
+ * MDS_REQUEST_PORTAL, so the request with all packed sub-requests must fit
+ * into MDS_REG_MAXREQSIZE.  The reply holds all the sub-replies, its size is
+ * limited to MSG_BATCH_MAXREPSIZE.
+ */
+#define MSG_BATCH_MAXREQSIZE	MDS_REG_MAXREQSIZE
+#define MSG_BATCH_MAXREPSIZE	(256 * 1024)
+
 /** MDS_BUFSIZE = max_reqsize (w/o LOV EA) + max sptlrpc payload size */
 #define MDS_BUFSIZE		max(MDS_MAXREQSIZE + SPTLRPC_MAX_PAYLOAD, \
 				    8 * 1024)
@@ -643,6 +653,8 @@ struct ptlrpc_reply_state {
 	struct ptlrpc_cb_id	rs_cb_id;
 	/** Linkage for list of all reply states in a system */
 	struct list_head	rs_list;
+	/** Linkage to the queue of the reply handling thread */
+	struct llist_node	rs_hr_node;
 	/** Linkage for list of all reply states on same export */
 	struct list_head	rs_exp_list;
 	/** Linkage for list of all reply states for same obd */
@@ -669,6 +681,8 @@ struct ptlrpc_reply_state {
 	atomic_t		rs_refcount;	/* number of users */
 	/** Number of locks awaiting client ACK */
 	int			rs_nlocks;
+	/** When the transaction was committed, see ptlrpc_commit_replies() */
+	ktime_t			rs_commit_time;
 
         /** Size of the state */
         int                    rs_size;
@@ -786,6 +800,8 @@ struct ptlrpc_cli_req {
 	time64_t			 cr_queued_time;
 	/** request sent in nanoseconds */
 	ktime_t				 cr_sent_ns;
+	/** request sent, monotonic clock, to measure the RPC time */
+	ktime_t				 cr_sent_mono;
 	/** time for request really sent out */
 	time64_t			 cr_sent_out;
 	/** when req reply unlink must finish. */
@@ -1566,6 +1582,40 @@ struct ptlrpc_service_ops {
  */
 #define PTLRPC_SVC_HP_RATIO 10
 
+/**
+ * Last decision of the adaptive thread pool controller of a partition
+ */
+enum ptlrpc_thrctl_decision {
+	PTLRPC_THRCTL_OFF = 0,
+	PTLRPC_THRCTL_HOLD,
+	PTLRPC_THRCTL_GROW,
+	PTLRPC_THRCTL_SHRINK,
+	/** requests wait, but the CPUs of the partition are saturated */
+	PTLRPC_THRCTL_CPU_BUSY,
+};
+
+/**
+ * State of the adaptive thread pool controller of a service partition,
+ * sampled every interval by ptlrpc_thrctl_work()
+ */
+struct ptlrpc_thrctl {
+	/** average queue wait of the requests started, usec */
+	__u64				tcl_wait_us;
+	/** CPU busy percentage of the partition, -1 if unknown */
+	int				tcl_cpu_busy;
+	/** most requests served at once */
+	int				tcl_active;
+	/** consecutive intervals with short waits and idle threads */
+	int				tcl_quiet;
+	enum ptlrpc_thrctl_decision	tcl_decision;
+	/** # times the pool was grown or shrunk */
+	__u64				tcl_grown;
+	__u64				tcl_shrunk;
+	/** idle and wall time of the CPUs at the last sample, usec */
+	__u64				tcl_cpu_idle;
+	__u64				tcl_cpu_wall;
+};
+
 /**
  * Definition of PortalRPC service.
  * The service is listening on a particular portal (like tcp port)
@@ -1617,6 +1667,14 @@ struct ptlrpc_service {
         unsigned                        srv_is_stopping:1;
 	/** Whether or not to restrict service threads to CPUs in this CPT */
 	unsigned			srv_cpt_bind:1;
+	/** size thread pools from queue wait and CPU usage */
+	bool				srv_thrctl_enabled;
+	/** queue wait above which the adaptive controller adds threads */
+	__u32				srv_thrctl_wait_us;
+	/** runs the adaptive thread pool controller */
+	struct delayed_work		srv_thrctl_work;
+	/** idle threads take requests queued on other partitions */
+	bool				srv_steal_enabled;
 
 	/** max # request buffers */
 	int				srv_nrqbds_max;
@@ -1671,6 +1729,15 @@ struct ptlrpc_service_part {
 	int				scp_nthrs_running;
 	/** service threads list */
 	struct list_head		scp_threads;
+	/** # threads wanted by the adaptive controller, 0 if it is off */
+	int				scp_nthrs_target;
+	/** adaptive thread pool controller state */
+	struct ptlrpc_thrctl		scp_thrctl;
+	/**
+	 * indexes in ptlrpc_service::srv_parts of the other partitions,
+	 * nearest first, NULL if the service has a single partition
+	 */
+	int				*scp_steal_order;
 
 	/**
 	 * serialize the following fields, used for protecting
@@ -1719,12 +1786,22 @@ struct ptlrpc_service_part {
 	 */
 	spinlock_t			scp_req_lock __cfs_cacheline_aligned;
 	/** # reqs in either of the NRS heads below */
-	/** # reqs being served */
+	/** # reqs being served by threads of this partition */
 	int				scp_nreqs_active;
 	/** # HPreqs being served */
 	int				scp_nhreqs_active;
 	/** # hp requests handled */
 	int				scp_hreq_count;
+	/** queue wait of the requests started in this interval, usec */
+	__u64				scp_thrctl_wait_sum;
+	/** # requests started in this interval */
+	__u32				scp_thrctl_nreqs;
+	/** most requests served at once in this interval */
+	int				scp_thrctl_active_max;
+	/** # requests of this partition handled by threads of others */
+	__u64				scp_nreqs_stolen;
+	/** # requests of other partitions handled by threads of this one */
+	__u64				scp_nreqs_steals;
 
 	/** NRS head for regular requests */
 	struct ptlrpc_nrs		scp_nrs_reg;
@@ -2089,6 +2166,8 @@ int ptlrpc_request_bufs_pack(struct ptlrpc_request *request,
 void ptlrpc_req_finished(struct ptlrpc_request *request);
 void ptlrpc_req_finished_with_imp_lock(struct ptlrpc_request *request);
 struct ptlrpc_request *ptlrpc_request_addref(struct ptlrpc_request *req);
+int ptlrpc_batch_subreq_reply(struct ptlrpc_request *req,
+			      struct lustre_msg *msg, int *len);
 struct ptlrpc_bulk_desc *ptlrpc_prep_bulk_imp(struct ptlrpc_request *req,
 					      unsigned nfrags, unsigned max_brw,
 					      unsigned int type,
@@ -2207,6 +2286,10 @@ int ptlrpc_service_health_check(struct ptlrpc_service *);
 void ptlrpc_server_drop_request(struct ptlrpc_request *req);
 void ptlrpc_request_change_export(struct ptlrpc_request *req,
 				  struct obd_export *export);
+int ptlrpc_batch_subreq_init(struct ptlrpc_request *req,
+			     struct ptlrpc_request *sub,
+			     struct lustre_msg *msg, int *len);
+int ptlrpc_batch_subreq_fini(struct ptlrpc_request *sub, void *buf, int size);
 void ptlrpc_update_export_timer(struct obd_export *exp,
 				time64_t extra_delay);
 
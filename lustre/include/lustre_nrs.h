@@ -686,6 +686,8 @@ struct binheap_node {
 #include <lustre_nrs_tbf.h>
 #include <lustre_nrs_crr.h>
 #include <lustre_nrs_orr.h>
+#include <lustre_nrs_wfq.h>
+#include <lustre_nrs_edf.h>
 #endif /* HAVE_SERVER_SUPPORT */
 #include <lustre_nrs_delay.h>
 
@@ -735,6 +737,14 @@ struct ptlrpc_nrs_request {
 		 * TBF request definition
 		 */
 		struct nrs_tbf_req	tbf;
+		/**
+		 * WFQ request definition
+		 */
+		struct nrs_wfq_req	wfq;
+		/**
+		 * EDF request definition
+		 */
+		struct nrs_edf_req	edf;
 #endif /* HAVE_SERVER_SUPPORT */
 		/**
 		 * Fields for the delay policy
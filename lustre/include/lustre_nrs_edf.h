@@ -0,0 +1,114 @@
+/*
+ * GPL HEADER START
+ *
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 only,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License version 2 for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; If not, see
+ * http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * GPL HEADER END
+ */
+/*
+ *
+ * Network Request Scheduler (NRS) Earliest Deadline First (EDF) policy
+ *
+ */
+
+#ifndef _LUSTRE_NRS_EDF_H
+#define _LUSTRE_NRS_EDF_H
+
+/**
+ * \name EDF
+ *
+ * EDF, Earliest Deadline First scheduling against per-class latency targets
+ * @{
+ */
+
+/**
+ * Queue latency histogram: four buckets per power of two of microseconds,
+ * enough for the 99.9th percentile to be within 25% of the exact value.
+ */
+#define NRS_EDF_HIST_SUB_BITS	2
+#define NRS_EDF_HIST_BUCKETS	((32 - NRS_EDF_HIST_SUB_BITS + 1) << \
+				 NRS_EDF_HIST_SUB_BITS)
+
+/**
+ * A class of requests, as defined by a rule written to nrs_edf_rule, and the
+ * queue latency target of its requests.
+ */
+struct nrs_edf_class {
+	/**
+	 * Linkage to nrs_edf_head::eh_classes; the value of the class is its
+	 * latency target, in milliseconds, and it is referenced by the class
+	 * list and by each request of the class
+	 */
+	struct nrs_cond_class		 ec_class;
+	/** Requests of the class hold this resource */
+	struct ptlrpc_nrs_resource	 ec_res;
+	__u64				 ec_served;
+	/** Requests started after their deadline */
+	__u64				 ec_missed;
+	__u64				 ec_hist[NRS_EDF_HIST_BUCKETS];
+};
+
+/**
+ * Private data of an EDF policy instance.
+ */
+struct nrs_edf_head {
+	struct ptlrpc_nrs_resource	 eh_res;
+	/**
+	 * Protects the classes and their statistics, which are also used
+	 * outside of the service partition lock, by res_get() and res_put().
+	 */
+	spinlock_t			 eh_lock;
+	/** Classes, newest first; the default class is always the last one */
+	struct list_head		 eh_classes;
+	/** Queued requests, sorted by deadline */
+	struct binheap			*eh_binheap;
+	/** Orders requests of the same deadline by arrival */
+	__u64				 eh_sequence;
+};
+
+/**
+ * EDF NRS request definition
+ */
+struct nrs_edf_req {
+	/** Arrival time plus the latency target of the class */
+	ktime_t			er_deadline;
+	__u64			er_sequence;
+};
+
+/**
+ * EDF policy operations.
+ */
+enum nrs_ctl_edf {
+	/**
+	 * Read the classes of an EDF policy.
+	 */
+	NRS_CTL_EDF_RD_RULE = PTLRPC_NRS_CTL_1ST_POL_SPEC,
+	/**
+	 * Start, change or stop a class of an EDF policy.
+	 */
+	NRS_CTL_EDF_WR_RULE,
+	/**
+	 * Read the per-class latency statistics of an EDF policy.
+	 */
+	NRS_CTL_EDF_RD_STATS,
+	/**
+	 * Clear the per-class latency statistics of an EDF policy.
+	 */
+	NRS_CTL_EDF_CLEAR_STATS,
+};
+
+/** @} EDF */
+#endif
@@ -358,6 +358,37 @@ struct nrs_tbf_req {
 	__u64			tr_sequence;
 };
 
+/**
+ * A class of requests of the WFQ or EDF policy, as defined by a rule whose
+ * conditions have the format of the TBF generic rules. It is the first member
+ * of the class structure of the policy.
+ */
+struct nrs_cond_class {
+	/** Linkage to the class list of the policy instance */
+	struct list_head	 cc_linkage;
+	char			 cc_name[MAX_TBF_NAME];
+	/** NULL for the default class, which matches any request */
+	char			*cc_conds_str;
+	struct list_head	 cc_conds;
+	/** Weight or latency target of the class */
+	__u32			 cc_value;
+	/** One for the class list, plus one per user of the class */
+	int			 cc_ref;
+};
+
+enum nrs_cond_cmd_type {
+	NRS_COND_CMD_START = 0,
+	NRS_COND_CMD_CHANGE,
+	NRS_COND_CMD_STOP,
+};
+
+struct nrs_cond_cmd {
+	enum nrs_cond_cmd_type	 cc_cmd;
+	char			*cc_name;
+	char			*cc_conds_str;
+	__u32			 cc_value;
+};
+
 /**
  * TBF policy operations.
  */
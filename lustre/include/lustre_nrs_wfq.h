@@ -0,0 +1,153 @@
+/*
+ * GPL HEADER START
+ *
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 only,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License version 2 for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; If not, see
+ * http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * GPL HEADER END
+ */
+/*
+ *
+ * Network Request Scheduler (NRS) Weighted Fair Queueing (WFQ) policy
+ *
+ */
+
+#ifndef _LUSTRE_NRS_WFQ_H
+#define _LUSTRE_NRS_WFQ_H
+
+/**
+ * \name WFQ
+ *
+ * WFQ, Weighted Fair Queueing by Deficit Round Robin over request flows
+ * @{
+ */
+#include <libcfs/linux/linux-hash.h>
+
+#define NRS_WFQ_KEY_LEN		(LUSTRE_JOBID_SIZE > LNET_NIDSTR_SIZE ? \
+				 LUSTRE_JOBID_SIZE : LNET_NIDSTR_SIZE)
+
+/**
+ * The property of requests by which flows are formed, chosen when the policy
+ * is started, i.e. "lctl set_param ost.OSS.ost_io.nrs_policies='wfq uid'".
+ */
+enum nrs_wfq_key_type {
+	NRS_WFQ_KEY_JOBID = 0,
+	NRS_WFQ_KEY_UID,
+	NRS_WFQ_KEY_GID,
+	NRS_WFQ_KEY_PROJID,
+	NRS_WFQ_KEY_NID,
+};
+
+/**
+ * A class of requests, as defined by a rule written to nrs_wfq_rule. Each
+ * flow of the class is given a share of the service proportional to the
+ * weight of the class.
+ */
+struct nrs_wfq_class {
+	/**
+	 * Linkage to nrs_wfq_head::wh_classes; the value of the class is its
+	 * weight, and it is referenced by the class list and by each flow of
+	 * the class
+	 */
+	struct nrs_cond_class	 wc_class;
+	__u64			 wc_served_rpcs;
+	__u64			 wc_served_bytes;
+	/** Time spent by requests in the queue, in log2 of microseconds */
+	struct obd_histogram	 wc_delay_hist;
+};
+
+struct nrs_wfq_key {
+	struct nrs_wfq_class	*wk_class;
+	char			 wk_id[NRS_WFQ_KEY_LEN];
+};
+
+/**
+ * A flow of requests, i.e. all requests of a class having the same key.
+ */
+struct nrs_wfq_flow {
+	struct ptlrpc_nrs_resource	wf_res;
+	struct rhash_head		wf_rhead;
+	struct nrs_wfq_key		wf_key;
+	/** Linkage to nrs_wfq_head::wh_active while requests are queued */
+	struct list_head		wf_active;
+	/** Queued requests, in arrival order */
+	struct list_head		wf_queue;
+	/** Bytes the flow may still be served in the current round */
+	__u64				wf_deficit;
+	/** References from requests holding this resource */
+	int				wf_ref;
+};
+
+/**
+ * Private data of a WFQ policy instance.
+ */
+struct nrs_wfq_head {
+	struct ptlrpc_nrs_resource	wh_res;
+	/**
+	 * Protects the classes, their statistics and the flow hash, which are
+	 * also used outside of the service partition lock, by res_get() and
+	 * res_put().
+	 */
+	spinlock_t			wh_lock;
+	struct rhashtable		wh_flow_hash;
+	/** Classes, newest first; the default class is always the last one */
+	struct list_head		wh_classes;
+	/** Flows having queued requests, in round robin order */
+	struct list_head		wh_active;
+	enum nrs_wfq_key_type		wh_key_type;
+	/** Bytes added to the deficit of a flow of weight 1 every round */
+	__u32				wh_quantum;
+};
+
+/**
+ * WFQ NRS request definition
+ */
+struct nrs_wfq_req {
+	/** Linkage to nrs_wfq_flow::wf_queue */
+	struct list_head	wr_list;
+	/** Bytes of bulk data moved by the request */
+	__u32			wr_bytes;
+	/** Cost charged to the deficit of the flow of the request */
+	__u32			wr_cost;
+};
+
+/**
+ * WFQ policy operations.
+ */
+enum nrs_ctl_wfq {
+	/**
+	 * Read the classes and statistics of a WFQ policy.
+	 */
+	NRS_CTL_WFQ_RD_RULE = PTLRPC_NRS_CTL_1ST_POL_SPEC,
+	/**
+	 * Start, change or stop a class of a WFQ policy.
+	 */
+	NRS_CTL_WFQ_WR_RULE,
+	/**
+	 * Read the per-class statistics of a WFQ policy.
+	 */
+	NRS_CTL_WFQ_RD_STATS,
+	/**
+	 * Read the DRR quantum of a WFQ policy.
+	 */
+	NRS_CTL_WFQ_RD_QUANTUM,
+	/**
+	 * Write the DRR quantum of a WFQ policy.
+	 */
+	NRS_CTL_WFQ_WR_QUANTUM,
+};
+
+/** @} WFQ */
+#endif
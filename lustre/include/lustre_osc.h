@@ -110,6 +110,18 @@ struct osc_device {
 		uint64_t	os_lockless_reads;     /* by bytes */
 	} od_stats;
 
+	/* BRW write bulk compression stats, protected by client_obd's lock */
+	struct osc_compr_stats {
+		ktime_t		ocs_init;
+		uint64_t	ocs_rpcs;		/* compressed RPCs */
+		uint64_t	ocs_rpcs_skipped;	/* sent uncompressed */
+		uint64_t	ocs_chunks;
+		uint64_t	ocs_chunks_raw;		/* incompressible */
+		uint64_t	ocs_bytes_in;		/* data bytes */
+		uint64_t	ocs_bytes_out;		/* bulk bytes */
+		uint64_t	ocs_usec;		/* compression time */
+	} od_compr_stats;
+
 	/* configuration item(s) */
 	time64_t		od_contention_time;
 };
@@ -532,6 +544,11 @@ struct osc_page {
 	 * lru page list. See osc_lru_{del|use}() in osc_page.c for usage.
 	 */
 	struct list_head	ops_lru;
+	/**
+	 * CPT of the client_obd::cl_lru_shards this page is accounted in,
+	 * and of the LRU budget its slot is given back to.
+	 */
+	int			ops_lru_cpt;
 	/**
 	 * Submit time - the time when the page is starting RPC. For debugging.
 	 */
@@ -257,6 +257,7 @@ extern struct req_format RQF_MDS_SWAP_LAYOUTS;
 extern struct req_format RQF_MDS_REINT_MIGRATE;
 extern struct req_format RQF_MDS_REINT_RESYNC;
 extern struct req_format RQF_MDS_RMFID;
+extern struct req_format RQF_MDS_MSG_BATCH;
 /* MDS hsm formats */
 extern struct req_format RQF_MDS_HSM_STATE_GET;
 extern struct req_format RQF_MDS_HSM_STATE_SET;
@@ -417,6 +418,11 @@ extern struct req_msg_field RMF_OUT_UPDATE_REPLY;
 extern struct req_msg_field RMF_OUT_UPDATE_HEADER;
 extern struct req_msg_field RMF_OUT_UPDATE_BUF;
 
+/* Batched RPC format */
+extern struct req_msg_field RMF_MSG_BATCH_HEADER;
+extern struct req_msg_field RMF_MSG_BATCH_BUF;
+extern struct req_msg_field RMF_MSG_BATCH_REPLY;
+
 /* LFSCK format */
 extern struct req_msg_field RMF_LFSCK_REQUEST;
 extern struct req_msg_field RMF_LFSCK_REPLY;
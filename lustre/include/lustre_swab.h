@@ -71,6 +71,7 @@ void lustre_swab_hsm_state_set(struct hsm_state_set *hss);
 void lustre_swab_obd_statfs(struct obd_statfs *os);
 void lustre_swab_obd_ioobj(struct obd_ioobj *ioo);
 void lustre_swab_niobuf_remote(struct niobuf_remote *nbr);
+void lustre_swab_ll_compr_chunk_hdr(struct ll_compr_chunk_hdr *hdr);
 void lustre_swab_ost_lvb_v1(struct ost_lvb_v1 *lvb);
 void lustre_swab_ost_lvb(struct ost_lvb *lvb);
 int lustre_swab_obd_quotactl(struct obd_quotactl *q, __u32 len);
@@ -123,6 +124,8 @@ void lustre_swab_hsm_request(struct hsm_request *hr);
 void lustre_swab_swap_layouts(struct mdc_swap_layouts *msl);
 void lustre_swab_close_data(struct close_data *data);
 void lustre_swab_close_data_resync_done(struct close_data_resync_done *resync);
+void lustre_swab_msg_batch_header(struct msg_batch_header *mbh);
+void lustre_swab_msg_batch_reply(struct msg_batch_reply *mbr);
 void lustre_swab_lmv_user_md(struct lmv_user_md *lum);
 void lustre_swab_ladvise(struct lu_ladvise *ladvise);
 void lustre_swab_ladvise_hdr(struct ladvise_hdr *ladvise_hdr);
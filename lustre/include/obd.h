@@ -69,6 +69,7 @@ struct lov_oinfo {                 /* per-stripe data structure */
 	int loi_ost_gen;           /* generation of this loi_ost_idx */
 
 	unsigned long loi_kms_valid:1;
+	__u8 loi_compr_type;       /* enum ll_compr_type of BRW write bulk */
 	__u64 loi_kms;             /* known minimum size */
 	struct ost_lvb loi_lvb;
 	struct osc_async_rc     loi_ar;
@@ -175,6 +176,83 @@ enum obd_cl_sem_lock_class {
 	OBD_CLI_SEM_MDCOSC,
 };
 
+/**
+ * Per-CPT part of the page LRU of a client_obd. Pages are added to the shard
+ * of the CPT which allocated them, so that I/O threads running on different
+ * CPTs do not contend on the same list lock and counters.
+ */
+struct cl_lru_shard {
+	/** List of LRU pages of this shard */
+	struct list_head	cls_list;
+	/** Lock for cls_list */
+	spinlock_t		cls_lock;
+	/** # of LRU pages in cls_list */
+	atomic_long_t		cls_in_list;
+	/** # of busy LRU pages allocated in this CPT, see cl_lru_busy() */
+	atomic_long_t		cls_busy;
+	/** stats: # of times cls_lock was taken, and found held by others,
+	 * both protected by cls_lock */
+	__u64			cls_lock_count;
+	__u64			cls_lock_contended;
+};
+
+/** Why the RPCs in flight window of a client_obd was changed */
+enum client_rif_reason {
+	RIF_START	= 0,	/* auto-tuning enabled */
+	RIF_GROW,		/* window was full, no queueing on the server */
+	RIF_LATENCY,		/* RPC time grew well over its base */
+	RIF_RESEND,		/* RPC timed out or server asked to retry */
+	RIF_BOUNDS,		/* admin changed the bounds of the window */
+};
+
+struct client_rif_change {
+	ktime_t			rcc_time;
+	__u32			rcc_old;
+	__u32			rcc_new;
+	enum client_rif_reason	rcc_reason;
+	__u32			rcc_srtt_us;
+	__u32			rcc_load_pct;
+};
+
+#define CLIENT_RIF_LOG_SIZE	16
+/* RPC sizes are bucketed by log2 of their number of pages */
+#define CLIENT_RIF_BUCKETS	16
+
+/**
+ * Auto-tuning of the number of RPCs in flight of a client_obd, by additive
+ * increase and multiplicative decrease of a window between crt_min and
+ * cl_max_rpcs_in_flight, driven by the time of the BRW RPCs compared to the
+ * lowest time seen recently for RPCs of the same direction and size. All
+ * fields are protected by cl_loi_list_lock.
+ */
+struct client_rif_tuner {
+	bool			crt_enabled;
+	/** Window was full while the current round of RPCs was sent */
+	bool			crt_limited;
+	__u32			crt_min;
+	__u32			crt_window;
+	/** RPCs completed since the window was last considered */
+	__u32			crt_acked;
+	/** Smoothed RPC time, from send to reply */
+	__u32			crt_srtt_us;
+	/** Smoothed RPC time, in % of the base time of its direction/size */
+	__u32			crt_load_pct;
+	/**
+	 * Lowest RPC time of the previous and of the current period, by
+	 * direction (read, write) and size bucket
+	 */
+	__u32			crt_base_us[2][CLIENT_RIF_BUCKETS];
+	__u32			crt_base_next_us[2][CLIENT_RIF_BUCKETS];
+	ktime_t			crt_base_start;
+	/** Monotonic time of the last change of the window */
+	ktime_t			crt_changed;
+	__u64			crt_grown;
+	__u64			crt_shrunk;
+	/** Last changes of the window, in a ring indexed by crt_nchanges */
+	__u64			crt_nchanges;
+	struct client_rif_change crt_log[CLIENT_RIF_LOG_SIZE];
+};
+
 struct mdc_rpc_lock;
 struct obd_import;
 struct client_obd {
@@ -216,7 +294,10 @@ struct client_obd {
 
 	unsigned int		 cl_checksum:1, /* 0 = disabled, 1 = enabled */
 				 cl_checksum_dump:1, /* same */
-				 cl_ocd_grant_param:1;
+				 cl_ocd_grant_param:1,
+				 /* pack any number of discontiguous extents
+				  * in a write RPC, one niobuf each */
+				 cl_write_coalesce:1;
 	enum lustre_sec_part	 cl_sp_me;
 	enum lustre_sec_part	 cl_sp_to;
 	struct sptlrpc_flavor	 cl_flvr_mgc; /* fixed flavor of mgc->mgs */
@@ -279,6 +360,7 @@ struct client_obd {
 	atomic_t		cl_pending_r_pages;
 	u32			cl_max_pages_per_rpc;
 	u32			cl_max_rpcs_in_flight;
+	struct client_rif_tuner	cl_rif;
 	u32			cl_max_short_io_bytes;
 	ktime_t			cl_stats_init;
 	struct obd_histogram	cl_read_rpc_hist;
@@ -287,21 +369,22 @@ struct client_obd {
 	struct obd_histogram	cl_write_page_hist;
 	struct obd_histogram	cl_read_offset_hist;
 	struct obd_histogram	cl_write_offset_hist;
+	struct obd_histogram	cl_read_nio_hist;
+	struct obd_histogram	cl_write_nio_hist;
+	/* total niobufs of the RPCs accounted in cl_{read,write}_page_hist */
+	unsigned long		cl_read_niobufs;
+	unsigned long		cl_write_niobufs;
+	/* per-job BRW statistics, keyed by the jobid of the RPCs */
+	struct obd_job_stats	cl_jobstats;
 
 	/** LRU for osc caching pages */
 	struct cl_client_cache  *cl_cache;
 	/** member of cl_cache->ccc_lru */
 	struct list_head         cl_lru_osc;
-	/** # of available LRU slots left in the per-OSC cache.
-	 * Available LRU slots are shared by all OSCs of the same file system,
-	 * therefore this is a pointer to cl_client_cache::ccc_lru_left. */
-	atomic_long_t           *cl_lru_left;
-	/** # of busy LRU pages. A page is considered busy if it's in writeback
-	 * queue, or in transfer. Busy pages can't be discarded so they are not
-	 * in LRU cache. */
-	atomic_long_t            cl_lru_busy;
-	/** # of LRU pages in the cache for this client_obd */
-	atomic_long_t            cl_lru_in_list;
+	/** Per-CPT LRU lists and counters of this client_obd. Available LRU
+	 * slots are shared by all OSCs of the same file system, they are
+	 * accounted in cl_client_cache::ccc_lru_budget. */
+	struct cl_lru_shard	**cl_lru_shards;
 	/** # of threads are shrinking LRU cache. To avoid contention, it's not
 	 * allowed to have multiple threads shrinking LRU cache. */
 	atomic_t                 cl_lru_shrinkers;
@@ -312,10 +395,6 @@ struct client_obd {
 	 * reclaim is sync, initiated by IO thread when the LRU slots are
 	 * in shortage. */
 	__u64                    cl_lru_reclaim;
-	/** List of LRU pages for this client_obd */
-	struct list_head         cl_lru_list;
-	/** Lock for LRU page list */
-	spinlock_t		 cl_lru_list_lock;
 	/** # of unstable pages in this client_obd.
 	 * An unstable page is a page state that WRITE RPC has finished but
 	 * the transaction has NOT yet committed. */
@@ -854,6 +933,7 @@ enum md_cli_flags {
 	CLI_API32	= BIT(3),
 	CLI_MIGRATE	= BIT(4),
 	CLI_DIRTY_DATA	= BIT(5),
+	CLI_READDIR_PLUS = BIT(6),
 };
 
 enum md_op_code {
@@ -979,6 +1059,14 @@ struct md_enqueue_info {
 	void			       *mi_cbdata;
 };
 
+/**
+ * Handle of a batch of metadata sub-requests which are sent to the MDT in
+ * batched RPCs of up to \a lbt_max_count sub-requests, see md_batch_create().
+ */
+struct lu_batch {
+	__u32				lbt_max_count;
+};
+
 struct obd_ops {
 	struct module *o_owner;
 	int (*o_iocontrol)(unsigned int cmd, struct obd_export *exp, int len,
@@ -1176,6 +1264,12 @@ struct md_ops {
 	int (*m_intent_getattr_async)(struct obd_export *,
 				      struct md_enqueue_info *);
 
+	struct lu_batch *(*m_batch_create)(struct obd_export *, __u32);
+	int (*m_batch_add)(struct obd_export *, struct lu_batch *,
+			   struct md_enqueue_info *);
+	int (*m_batch_flush)(struct obd_export *, struct lu_batch *);
+	int (*m_batch_stop)(struct obd_export *, struct lu_batch *);
+
         int (*m_revalidate_lock)(struct obd_export *, struct lookup_intent *,
                                  struct lu_fid *, __u64 *bits);
 
@@ -1259,6 +1353,44 @@ static inline int client_should_resend(int resend, struct client_obd *cli)
 	       atomic_read(&cli->cl_resends) > resend : 1;
 }
 
+/**
+ * # of LRU pages in the cache for this client_obd
+ */
+static inline long cl_lru_in_list(struct client_obd *cli)
+{
+	struct cl_lru_shard *shard;
+	long count = 0;
+	int i;
+
+	if (cli->cl_lru_shards == NULL)
+		return 0;
+
+	cfs_percpt_for_each(shard, i, cli->cl_lru_shards)
+		count += atomic_long_read(&shard->cls_in_list);
+
+	return count;
+}
+
+/**
+ * # of busy LRU pages of this client_obd. A page is considered busy if it's
+ * in writeback queue, or in transfer. Busy pages can't be discarded so they
+ * are not in LRU cache.
+ */
+static inline long cl_lru_busy(struct client_obd *cli)
+{
+	struct cl_lru_shard *shard;
+	long count = 0;
+	int i;
+
+	if (cli->cl_lru_shards == NULL)
+		return 0;
+
+	cfs_percpt_for_each(shard, i, cli->cl_lru_shards)
+		count += atomic_long_read(&shard->cls_busy);
+
+	return count;
+}
+
 /**
  * Return device name for this device
  *
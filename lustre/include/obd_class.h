@@ -1328,6 +1328,10 @@ enum mps_stat_idx {
 	LPROC_MD_GETXATTR,
 	LPROC_MD_INTENT_GETATTR_ASYNC,
 	LPROC_MD_REVALIDATE_LOCK,
+	LPROC_MD_BATCH_CREATE,
+	LPROC_MD_BATCH_ADD,
+	LPROC_MD_BATCH_FLUSH,
+	LPROC_MD_BATCH_STOP,
 	LPROC_MD_LAST_OPC,
 };
 
@@ -1745,6 +1749,74 @@ static inline int md_intent_getattr_async(struct obd_export *exp,
 	return MDP(exp->exp_obd, intent_getattr_async)(exp, minfo);
 }
 
+/**
+ * Create a batch handle to pack up to \a max_count sub-requests into each
+ * batched RPC sent to the MDT.  Sub-requests are added by md_batch_add(),
+ * a batch is sent when it is full or upon md_batch_flush(), and the handle
+ * is released by md_batch_stop(), which flushes the pending sub-requests.
+ */
+static inline struct lu_batch *md_batch_create(struct obd_export *exp,
+					       __u32 max_count)
+{
+	int rc;
+
+	rc = exp_check_ops(exp);
+	if (rc)
+		return ERR_PTR(rc);
+
+	lprocfs_counter_incr(exp->exp_obd->obd_md_stats,
+			     LPROC_MD_BATCH_CREATE);
+
+	return MDP(exp->exp_obd, batch_create)(exp, max_count);
+}
+
+/**
+ * Add an asynchronous intent getattr to the batch \a bh, \a minfo is
+ * completed by its mi_cb callback just as with md_intent_getattr_async().
+ */
+static inline int md_batch_add(struct obd_export *exp, struct lu_batch *bh,
+			       struct md_enqueue_info *minfo)
+{
+	int rc;
+
+	rc = exp_check_ops(exp);
+	if (rc)
+		return rc;
+
+	lprocfs_counter_incr(exp->exp_obd->obd_md_stats,
+			     LPROC_MD_BATCH_ADD);
+
+	return MDP(exp->exp_obd, batch_add)(exp, bh, minfo);
+}
+
+static inline int md_batch_flush(struct obd_export *exp, struct lu_batch *bh)
+{
+	int rc;
+
+	rc = exp_check_ops(exp);
+	if (rc)
+		return rc;
+
+	lprocfs_counter_incr(exp->exp_obd->obd_md_stats,
+			     LPROC_MD_BATCH_FLUSH);
+
+	return MDP(exp->exp_obd, batch_flush)(exp, bh);
+}
+
+static inline int md_batch_stop(struct obd_export *exp, struct lu_batch *bh)
+{
+	int rc;
+
+	rc = exp_check_ops(exp);
+	if (rc)
+		return rc;
+
+	lprocfs_counter_incr(exp->exp_obd->obd_md_stats,
+			     LPROC_MD_BATCH_STOP);
+
+	return MDP(exp->exp_obd, batch_stop)(exp, bh);
+}
+
 static inline int md_revalidate_lock(struct obd_export *exp,
                                      struct lookup_intent *it,
                                      struct lu_fid *fid, __u64 *bits)
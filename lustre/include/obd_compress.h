@@ -0,0 +1,63 @@
+/*
+ * GPL HEADER START
+ *
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 only,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License version 2 for more details (a copy is included
+ * in the LICENSE file that accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License
+ * version 2 along with this program; If not, see
+ * http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * GPL HEADER END
+ */
+/*
+ * This file is part of Lustre, http://www.lustre.org/
+ *
+ * Compression of BRW bulk data, see struct ll_compr_chunk_hdr
+ */
+
+#ifndef __OBD_COMPRESS_H
+#define __OBD_COMPRESS_H
+
+#include <libcfs/libcfs.h>
+#include <uapi/linux/lustre/lustre_idl.h>
+#include <uapi/linux/lustre/lustre_user.h>
+
+/* chunk header and data are aligned on 8 bytes in the compressed bulk */
+#define LL_COMPR_ALIGN		8
+#define ll_compr_round(len)	(((len) + LL_COMPR_ALIGN - 1) & \
+				 ~(LL_COMPR_ALIGN - 1))
+
+/* largest compressed bulk for @nob bytes of data, if nothing compresses */
+static inline unsigned int ll_compr_bulk_max(unsigned int nob)
+{
+	unsigned int chunks = DIV_ROUND_UP(nob, LL_COMPR_CHUNK_SIZE);
+
+	return chunks * ll_compr_round(sizeof(struct ll_compr_chunk_hdr)) +
+	       ll_compr_round(nob) + chunks * LL_COMPR_ALIGN;
+}
+
+static inline bool ll_compr_type_valid(enum ll_compr_type type)
+{
+	return type > LL_COMPR_TYPE_NONE && type < LL_COMPR_TYPE_MAX;
+}
+
+bool obd_compress_supported(enum ll_compr_type type);
+int obd_compress_chunk(enum ll_compr_type type, const void *src,
+		       unsigned int src_len, void *dst, unsigned int *dst_len);
+int obd_decompress_chunk(enum ll_compr_type type, const void *src,
+			 unsigned int src_len, void *dst,
+			 unsigned int *dst_len);
+void obd_compress_init(void);
+void obd_compress_fini(void);
+
+#endif /* __OBD_COMPRESS_H */
@@ -246,6 +246,8 @@ extern char obd_jobid_var[];
 #define OBD_FAIL_MDS_REINT_OPEN2	 0x16a
 #define OBD_FAIL_MDS_COMMITRW_DELAY	 0x16b
 #define OBD_FAIL_MDS_CHANGELOG_DEL	 0x16c
+#define OBD_FAIL_MDS_BATCH_NET		 0x16d
+#define OBD_FAIL_MDS_BATCH_REPLY_SHORT	 0x16e
 
 /* layout lock */
 #define OBD_FAIL_MDS_NO_LL_GETATTR	 0x170
@@ -461,6 +463,7 @@ extern char obd_jobid_var[];
 #define OBD_FAIL_NET_ERROR_RPC		 0x532
 #define OBD_FAIL_PTLRPC_IDLE_RACE	 0x533
 #define OBD_FAIL_PTLRPC_ENQ_RESEND	 0x534
+#define OBD_FAIL_PTLRPC_OST_IO_SERIAL	 0x535
 
 #define OBD_FAIL_OBD_PING_NET            0x600
 /*	OBD_FAIL_OBD_LOG_CANCEL_NET      0x601 obsolete since 1.5 */
@@ -398,6 +398,8 @@ enum lu_dirent_attrs {
 	LUDA_FID		= 0x0001,
 	LUDA_TYPE		= 0x0002,
 	LUDA_64BITHASH		= 0x0004,
+	LUDA_ATTRS		= 0x0008,
+	LUDA_LAYOUT		= 0x0010,
 
 	/* The following attrs are used for MDT internal only,
 	 * not visible to client */
@@ -469,6 +471,34 @@ struct luda_type {
         __u16 lt_type;
 };
 
+/**
+ * Attributes of the object referenced by the entry, as found on the MDT
+ * when the directory page was built.  No lock is held on the object, so
+ * these are only a hint, like the lazy size (LSOM) they come with.
+ *
+ * If LUDA_LAYOUT was asked for and there was room left in the page, the
+ * LOV EA of a regular file follows, padded to 8 bytes, and lda_lmm_size
+ * is its size.
+ *
+ * Aligned to 8 bytes.
+ */
+struct luda_attrs {
+	__u64	lda_valid;	/* OBD_MD_FL* of valid fields */
+	__u64	lda_size;	/* OBD_MD_FLSIZE or OBD_MD_FLLAZYSIZE */
+	__u64	lda_blocks;	/* OBD_MD_FLBLOCKS or OBD_MD_FLLAZYBLOCKS */
+	__s64	lda_atime;
+	__s64	lda_mtime;
+	__s64	lda_ctime;
+	__u32	lda_mode;
+	__u32	lda_uid;
+	__u32	lda_gid;
+	__u32	lda_nlink;
+	__u32	lda_flags;
+	__u32	lda_projid;
+	__u32	lda_lmm_size;	/* size of the LOV EA following, or 0 */
+	__u32	lda_padding;
+};
+
 struct lu_dirpage {
         __u64            ldp_hash_start;
         __u64            ldp_hash_end;
@@ -521,8 +551,12 @@ static inline __kernel_size_t lu_dirent_calc_size(size_t namelen, __u16 attr)
 	} else {
 		size = sizeof(struct lu_dirent) + namelen + 1;
 	}
+	size = (size + 7) & ~7;
+
+	if (attr & LUDA_ATTRS)
+		size += sizeof(struct luda_attrs);
 
-	return (size + 7) & ~7;
+	return size;
 }
 
 static inline __u16 lu_dirent_type_get(struct lu_dirent *ent)
@@ -543,6 +577,38 @@ static inline __u16 lu_dirent_type_get(struct lu_dirent *ent)
 	return type;
 }
 
+static inline struct luda_attrs *lu_dirent_attrs_get(struct lu_dirent *ent)
+{
+	__u32 attrs = __le32_to_cpu(ent->lde_attrs);
+
+	if (!(attrs & LUDA_ATTRS))
+		return NULL;
+
+	return (void *)ent +
+	       lu_dirent_calc_size(__le16_to_cpu(ent->lde_namelen),
+				   attrs & ~LUDA_ATTRS);
+}
+
+/* size of @ent, including the LOV EA packed by readdir-plus, if any.  This
+ * also works for the last entry of a page, which has lde_reclen == 0.
+ */
+static inline __kernel_size_t lu_dirent_size(struct lu_dirent *ent)
+{
+	struct luda_attrs *lda;
+	__kernel_size_t size;
+
+	if (ent->lde_reclen != 0)
+		return __le16_to_cpu(ent->lde_reclen);
+
+	size = lu_dirent_calc_size(__le16_to_cpu(ent->lde_namelen),
+				   __le32_to_cpu(ent->lde_attrs));
+	lda = lu_dirent_attrs_get(ent);
+	if (lda != NULL)
+		size += (__le32_to_cpu(lda->lda_lmm_size) + 7) & ~7;
+
+	return size;
+}
+
 #define MDS_DIR_END_OFF 0xfffffffffffffffeULL
 
 /**
@@ -850,6 +916,10 @@ struct ptlrpc_body_v2 {
 #define OBD_CONNECT2_BATCH_RPC        0x400000ULL /* Multi-RPC batch request */
 #define OBD_CONNECT2_PCCRO	      0x800000ULL /* Read-only PCC */
 #define OBD_CONNECT2_ATOMIC_OPEN_LOCK 0x4000000ULL/* request lock on 1st open */
+/* 0x8000000 - 0x400000000 are used on other branches, see obd_connect_names */
+#define OBD_CONNECT2_WIRE_COMPRESS 0x800000000ULL /* compress BRW write bulk */
+#define OBD_CONNECT2_READDIR_PLUS 0x1000000000ULL /* attrs in dir pages */
+#define OBD_CONNECT2_MSG_BATCH    0x2000000000ULL /* MDS_MSG_BATCH RPC */
 /* XXX README XXX:
  * Please DO NOT add flag values here before first ensuring that this same
  * flag value is not in use on some other branch.  Please clear any such
@@ -912,7 +982,9 @@ struct ptlrpc_body_v2 {
 				OBD_CONNECT2_GETATTR_PFID |\
 				OBD_CONNECT2_LSEEK | OBD_CONNECT2_DOM_LVB |\
 				OBD_CONNECT2_REP_MBITS | \
-				OBD_CONNECT2_ATOMIC_OPEN_LOCK)
+				OBD_CONNECT2_ATOMIC_OPEN_LOCK | \
+				OBD_CONNECT2_READDIR_PLUS | \
+				OBD_CONNECT2_MSG_BATCH)
 
 #define OST_CONNECT_SUPPORTED  (OBD_CONNECT_SRVLOCK | OBD_CONNECT_GRANT | \
 				OBD_CONNECT_REQPORTAL | OBD_CONNECT_VERSION | \
@@ -935,7 +1007,8 @@ struct ptlrpc_body_v2 {
 
 #define OST_CONNECT_SUPPORTED2 (OBD_CONNECT2_LOCKAHEAD | OBD_CONNECT2_INC_XID |\
 				OBD_CONNECT2_ENCRYPT | OBD_CONNECT2_LSEEK |\
-				OBD_CONNECT2_REP_MBITS)
+				OBD_CONNECT2_REP_MBITS | \
+				OBD_CONNECT2_WIRE_COMPRESS)
 
 #define ECHO_CONNECT_SUPPORTED (OBD_CONNECT_FID | OBD_CONNECT_FLAGS2)
 #define ECHO_CONNECT_SUPPORTED2 OBD_CONNECT2_REP_MBITS
@@ -1101,6 +1174,7 @@ enum obdo_flags {
 	OBD_FL_FLUSH	    = 0x00200000, /* flush pages on the OST */
 	OBD_FL_SHORT_IO	    = 0x00400000, /* short io request */
 	OBD_FL_ROOT_SQUASH  = 0x00800000, /* root squash */
+	OBD_FL_COMPRESSED   = 0x01000000, /* bulk holds compressed chunks */
 	/* OBD_FL_LOCAL_MASK = 0xF0000000, was local-only flags until 2.10 */
 
 	/*
@@ -1671,6 +1745,9 @@ enum mds_cmd {
 	MDS_HSM_CT_UNREGISTER	= 60,
 	MDS_SWAP_LAYOUTS	= 61,
 	MDS_RMFID		= 62,
+	MDS_BATCH		= 63, /* used on other branches */
+	MDS_HSM_DATA_VERSION	= 64, /* used on other branches */
+	MDS_MSG_BATCH		= 65,
 	MDS_LAST_OPC
 };
 
@@ -3098,8 +3175,8 @@ struct obdo {
 						 * brw: grant space consumed on
 						 * the client for the write */
 	__u32			o_projid;
-	__u32			o_padding_4;	/* also fix
-						 * lustre_swab_obdo() */
+	__u32			o_compr_nob;	/* brw: bytes of compressed
+						 * bulk, OBD_FL_COMPRESSED */
 	__u64			o_padding_5;
 	__u64			o_padding_6;
 };
@@ -3111,6 +3188,29 @@ struct obdo {
 #define o_grant_used o_data_version
 #define o_falloc_mode o_nlink
 
+/**
+ * OST_WRITE bulk with OBD_FL_COMPRESSED set in o_flags holds the data of all
+ * the niobufs, in order, split into chunks of at most LL_COMPR_CHUNK_SIZE
+ * bytes.  Each chunk starts on an 8-byte boundary with ll_compr_chunk_hdr,
+ * followed by lcch_compr_size bytes compressed with lcch_type, or stored as
+ * is if lcch_type is LL_COMPR_TYPE_NONE.  o_compr_nob is the bulk size.
+ *
+ * This only compresses the write transfer: the target decompresses the bulk
+ * before the data reaches the OSD, so objects are stored uncompressed and
+ * OST_READ bulk is never compressed.
+ */
+#define LL_COMPR_CHUNK_MAGIC	0xC0DEC0DE
+#define LL_COMPR_CHUNK_SIZE	(64 * 1024)
+
+struct ll_compr_chunk_hdr {
+	__u32	lcch_magic;
+	__u8	lcch_type;		/* enum ll_compr_type */
+	__u8	lcch_padding_1;
+	__u16	lcch_padding_2;
+	__u32	lcch_uncompr_size;	/* size of the data once decompressed */
+	__u32	lcch_compr_size;	/* size of the data following header */
+};
+
 struct lfsck_request {
 	__u32		lr_event;
 	__u32		lr_index;
@@ -3484,6 +3584,58 @@ struct out_read_reply {
 	char	orr_data[0];
 };
 
+/**
+ * MDS_MSG_BATCH RPC Format
+ *
+ * A batched RPC carries several complete sub-requests to the MDT in a single
+ * round trip, e.g. the intent getattr enqueues issued by statahead for a
+ * group of directory entries.  Every sub-request is a lustre_msg on its own,
+ * packed exactly as it would have been sent standalone, and every sub-reply
+ * is the lustre_msg that would have been replied, so the status of each
+ * sub-request is carried in the ptlrpc_body of its own sub-reply.
+ *
+ * Request Format
+ *
+ *   msg_batch_header
+ *   lustre_msg (1st)
+ *   lustre_msg (2nd)
+ *   ...
+ *   lustre_msg (mbh_count-th)
+ *
+ * Reply Format
+ *
+ *   msg_batch_reply
+ *   lustre_msg (1st)
+ *   ...
+ *   lustre_msg (mbr_count-th)
+ *
+ * Each sub-message starts on an 8-byte boundary.  mbh_reply_size is the sum
+ * of the lm_repsize of the sub-requests, each rounded up to 8 bytes, and a
+ * sub-request is only executed if its lm_repsize is left in the reply
+ * buffer.  mbr_count may be less than mbh_count if the reply buffer was
+ * exhausted, the sub-requests which have no sub-reply were not executed.
+ *
+ * Only intent getattr/lookup lock enqueues are batched.
+ */
+#define MSG_BATCH_HEADER_MAGIC	0xBA7C0001
+#define MSG_BATCH_MAX_COUNT	64
+/* Header for batched updates request */
+struct msg_batch_header {
+	__u32	mbh_magic;
+	__u32	mbh_count;	/* number of sub-requests */
+	__u32	mbh_reply_size;	/* reply buffer size prepared by client */
+	__u32	mbh_padding;
+};
+
+#define MSG_BATCH_REPLY_MAGIC	0xBA7C0002
+/* Hold sub-replies of a batched RPC */
+struct msg_batch_reply {
+	__u32			mbr_magic;
+	__u16			mbr_count;	/* number of mbr_repmsg[] */
+	__u16			mbr_padding;
+	struct lustre_msg	mbr_repmsg[0];
+};
+
 /** layout swap request structure
  * fid1 and fid2 are in mdt_body
  */
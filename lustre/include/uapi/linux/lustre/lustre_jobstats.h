@@ -0,0 +1,108 @@
+/*
+ * LGPL HEADER START
+ *
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.
+ *
+ * LGPL HEADER END
+ */
+/*
+ * This file is part of Lustre, http://www.lustre.org/
+ *
+ * Binary export of job stats through the "job_stats_ring" proc files.
+ * The definitions below are used in the kernel and userspace.
+ *
+ * A collector opens job_stats_ring read-write and mmaps it.  The mapping
+ * starts with a struct jobstats_ring_header, followed by jrh_nrecords
+ * slots of jrh_record_size bytes each, starting at jrh_header_size.
+ *
+ * Each record is a struct jobstats_ring_record with jrh_ncounters counters,
+ * followed by jrh_nhists latency histograms of jrh_hist_buckets __u32
+ * each.  Bucket 0 counts the samples below 1, bucket i the samples in
+ * [2^(i-1), 2^i), and the last bucket also all the bigger samples.
+ *
+ * Writing "sync" to the file copies the jobs updated since they were last
+ * published into the ring, and advances jrh_head.  Record number N lives in
+ * slot N % jrh_nrecords.  The collector consumes records jrh_tail to
+ * jrh_head - 1 and then stores the new jrh_tail; the kernel never overwrites
+ * records that are not consumed yet, jobs that do not fit stay pending for
+ * the next "sync" and are counted in jrh_deferred.
+ */
+
+#ifndef _UAPI_LUSTRE_JOBSTATS_H
+#define _UAPI_LUSTRE_JOBSTATS_H
+
+#include <linux/types.h>
+#include <linux/lustre/lustre_user.h>
+
+#define JOBSTATS_RING_MAGIC		0x4a534252	/* "JSBR" */
+#define JOBSTATS_RING_VERSION		2
+#define JOBSTATS_RING_NAME_LEN		32
+#define JOBSTATS_RING_UNITS_LEN		8
+#define JOBSTATS_RING_HIST_BUCKETS	32
+#define JOBSTATS_RING_NO_HIST		0xffffffff
+
+/* Description of counter i of every record, in jrh_counters[i] */
+struct jobstats_ring_counter_desc {
+	char	jcd_name[JOBSTATS_RING_NAME_LEN];
+	char	jcd_units[JOBSTATS_RING_UNITS_LEN];
+	__u32	jcd_config;	/* LPROCFS_CNTR_* flags of the counter */
+	__u32	jcd_hist;	/* histogram index or JOBSTATS_RING_NO_HIST */
+};
+
+struct jobstats_ring_header {
+	__u32	jrh_magic;
+	__u32	jrh_version;
+	__u32	jrh_header_size;	/* offset of the first slot */
+	__u32	jrh_record_size;	/* size of one slot */
+	__u32	jrh_nrecords;		/* number of slots */
+	__u32	jrh_ncounters;		/* counters in each record */
+	__u64	jrh_head;		/* records published, kernel-owned */
+	__u64	jrh_tail;		/* records consumed, collector-owned */
+	__u64	jrh_deferred;		/* jobs left pending as ring was full */
+	__u32	jrh_nhists;		/* histograms in each record */
+	__u32	jrh_hist_buckets;	/* buckets of each histogram */
+	struct jobstats_ring_counter_desc jrh_counters[0];
+};
+
+struct jobstats_ring_counter {
+	__u64	jrc_count;
+	__u64	jrc_min;
+	__u64	jrc_max;
+	__u64	jrc_sum;
+	__u64	jrc_sumsq;
+};
+
+/* Times are CLOCK_MONOTONIC, in nanoseconds */
+struct jobstats_ring_record {
+	char	jrr_jobid[LUSTRE_JOBID_SIZE];
+	__s64	jrr_start_ns;		/* first stat of the job */
+	__s64	jrr_latest_ns;		/* most recent stat of the job */
+	__s64	jrr_snapshot_ns;	/* when the record was published */
+	__u32	jrr_flags;		/* JRR_F_* */
+	__u32	jrr_padding;
+	struct jobstats_ring_counter jrr_counters[0];
+};
+
+struct jobstats_ring_hist {
+	__u32	jrhi_buckets[JOBSTATS_RING_HIST_BUCKETS];
+};
+
+enum jobstats_ring_record_flags {
+	/* job was cleared or expired, this is its final record */
+	JRR_F_REMOVED	= 0x00000001,
+};
+
+#endif /* _UAPI_LUSTRE_JOBSTATS_H */
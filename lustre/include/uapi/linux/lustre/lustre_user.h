@@ -634,6 +634,8 @@ struct ll_ioc_lease_id {
 #define LL_IOC_PCC_DETACH_BY_FID	_IOW('f', 252, struct lu_pcc_detach_fid)
 #define LL_IOC_PCC_STATE		_IOR('f', 252, struct lu_pcc_state)
 #define LL_IOC_PROJECT			_IOW('f', 253, struct lu_project)
+#define LL_IOC_STATAHEAD_NAMES		_IOW('f', 254, struct ll_statahead_names)
+#define LL_IOC_READDIR_PLUS		_IOWR('f', 255, struct ll_readdir_plus)
 
 #ifndef	FS_IOC_FSGETXATTR
 /*
@@ -899,6 +901,28 @@ enum lcme_id {
 
 #define LCME_ID_MASK	LCME_ID_MAX
 
+/* data compression algorithm of a layout component, see lcme_compr_type */
+enum ll_compr_type {
+	LL_COMPR_TYPE_NONE	= 0,
+	LL_COMPR_TYPE_LZ4	= 1,
+	LL_COMPR_TYPE_ZSTD	= 2,
+	LL_COMPR_TYPE_MAX
+};
+
+static inline const char *ll_compr_type2name(enum ll_compr_type type)
+{
+	switch (type) {
+	case LL_COMPR_TYPE_NONE:
+		return "none";
+	case LL_COMPR_TYPE_LZ4:
+		return "lz4";
+	case LL_COMPR_TYPE_ZSTD:
+		return "zstd";
+	default:
+		return "unknown";
+	}
+}
+
 struct lov_comp_md_entry_v1 {
 	__u32			lcme_id;        /* unique id of component */
 	__u32			lcme_flags;     /* LCME_FL_XXX */
@@ -908,7 +932,9 @@ struct lov_comp_md_entry_v1 {
 	__u32			lcme_size;      /* size of component blob */
 	__u32			lcme_layout_gen;
 	__u64			lcme_timestamp;	/* snapshot time if applicable*/
-	__u32			lcme_padding_1;
+	__u8			lcme_compr_type; /* enum ll_compr_type */
+	__u8			lcme_padding_1;
+	__u16			lcme_padding_2;
 } __attribute__((packed));
 
 #define SEQ_ID_MAX		0x0000FFFF
@@ -2692,6 +2718,52 @@ struct lu_project {
 	char	project_name[NAME_MAX + 1];
 };
 
+/* names of a directory whose attributes the client should fetch ahead of
+ * stat(), see LL_IOC_STATAHEAD_NAMES
+ */
+struct ll_statahead_names {
+	__u32	lsn_count;	/* number of names in lsn_names */
+	__u32	lsn_size;	/* size of lsn_names in bytes */
+	char	lsn_names[0];	/* NUL-terminated names, in stat order */
+};
+
+/* directory entry and the attributes of its object, see LL_IOC_READDIR_PLUS.
+ * The attributes are read by the MDT without any lock, so they are lazy like
+ * the size of regular files (OBD_MD_FLLAZYSIZE).  lrpe_flags holds the
+ * OBD_MD_FL* flags of the valid attributes as lmd_flags, it is 0 if the MDT
+ * did not return the attributes of this entry.  The layout of a regular file
+ * (as the "lustre.lov" xattr), if returned, is lrpe_lmm_size bytes at the next
+ * 8-byte boundary after the name, see ll_readdir_plus_lmm().
+ */
+struct ll_readdir_plus_ent {
+	__u16		lrpe_reclen;	/* record size, multiple of 8 bytes */
+	__u16		lrpe_namelen;
+	__u32		lrpe_lmm_size;
+	__u64		lrpe_flags;
+	struct lu_fid	lrpe_fid;
+	lstatx_t	lrpe_stx;
+	char		lrpe_name[0];	/* NUL-terminated */
+};
+
+static inline void *ll_readdir_plus_lmm(struct ll_readdir_plus_ent *lrpe)
+{
+	if (lrpe->lrpe_lmm_size == 0)
+		return NULL;
+
+	return (char *)lrpe + ((sizeof(*lrpe) + lrpe->lrpe_namelen + 1 + 7) &
+			       ~7);
+}
+
+struct ll_readdir_plus {
+	__u64	lrp_offset;	/* in: directory hash to start from, 0 for the
+				 * first call; out: hash to continue from,
+				 * LUSTRE_EOF once all entries were returned
+				 */
+	__u32	lrp_size;	/* size of lrp_buf in bytes */
+	__u32	lrp_count;	/* out: number of entries in lrp_buf */
+	char	lrp_buf[0];	/* struct ll_readdir_plus_ent records */
+};
+
 struct fid_array {
 	__u32 fa_nr;
 	/* make header's size equal lu_fid */
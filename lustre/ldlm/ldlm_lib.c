@@ -319,6 +319,7 @@ static int osc_on_mdt(char *obdname)
 int client_obd_setup(struct obd_device *obd, struct lustre_cfg *lcfg)
 {
 	struct client_obd *cli = &obd->u.cli;
+	struct cl_lru_shard *shard;
 	struct obd_import *imp;
 	struct obd_uuid server_uuid;
 	int rq_portal, rp_portal, connect_op;
@@ -328,6 +329,7 @@ int client_obd_setup(struct obd_device *obd, struct lustre_cfg *lcfg)
 	struct ptlrpc_connection fake_conn = { .c_self = 0,
 					       .c_remote_uuid.uuid[0] = 0 };
 	int rc;
+	int i;
 
 	ENTRY;
 
@@ -440,14 +442,13 @@ int client_obd_setup(struct obd_device *obd, struct lustre_cfg *lcfg)
 	spin_lock_init(&cli->cl_write_page_hist.oh_lock);
 	spin_lock_init(&cli->cl_read_offset_hist.oh_lock);
 	spin_lock_init(&cli->cl_write_offset_hist.oh_lock);
+	spin_lock_init(&cli->cl_read_nio_hist.oh_lock);
+	spin_lock_init(&cli->cl_write_nio_hist.oh_lock);
 
 	/* lru for osc. */
 	INIT_LIST_HEAD(&cli->cl_lru_osc);
 	atomic_set(&cli->cl_lru_shrinkers, 0);
-	atomic_long_set(&cli->cl_lru_busy, 0);
-	atomic_long_set(&cli->cl_lru_in_list, 0);
-	INIT_LIST_HEAD(&cli->cl_lru_list);
-	spin_lock_init(&cli->cl_lru_list_lock);
+	cli->cl_lru_shards = NULL;
 	atomic_long_set(&cli->cl_unstable_count, 0);
 	INIT_LIST_HEAD(&cli->cl_shrink_list);
 	INIT_LIST_HEAD(&cli->cl_grant_chain);
@@ -501,6 +502,8 @@ int client_obd_setup(struct obd_device *obd, struct lustre_cfg *lcfg)
 		else
 			cli->cl_max_rpcs_in_flight = OBD_MAX_RIF_DEFAULT;
 	}
+	/* auto-tuning is off until enabled by osc.*.rpcs_in_flight_auto */
+	cli->cl_rif.crt_min = 1;
 
 	spin_lock_init(&cli->cl_mod_rpcs_lock);
 	spin_lock_init(&cli->cl_mod_rpcs_hist.oh_lock);
@@ -520,6 +523,18 @@ int client_obd_setup(struct obd_device *obd, struct lustre_cfg *lcfg)
 			GOTO(err, rc = -ENOMEM);
 	}
 
+	cli->cl_lru_shards = cfs_percpt_alloc(cfs_cpt_tab,
+					      sizeof(struct cl_lru_shard));
+	if (cli->cl_lru_shards == NULL)
+		GOTO(err, rc = -ENOMEM);
+
+	cfs_percpt_for_each(shard, i, cli->cl_lru_shards) {
+		INIT_LIST_HEAD(&shard->cls_list);
+		spin_lock_init(&shard->cls_lock);
+		atomic_long_set(&shard->cls_in_list, 0);
+		atomic_long_set(&shard->cls_busy, 0);
+	}
+
 	rc = ldlm_get_ref();
 	if (rc) {
 		CERROR("ldlm_get_ref failed: %d\n", rc);
@@ -593,6 +608,9 @@ err_import:
 err_ldlm:
 	ldlm_put_ref();
 err:
+	if (cli->cl_lru_shards != NULL)
+		cfs_percpt_free(cli->cl_lru_shards);
+	cli->cl_lru_shards = NULL;
 	if (cli->cl_mod_tag_bitmap != NULL)
 		OBD_FREE(cli->cl_mod_tag_bitmap,
 			 BITS_TO_LONGS(OBD_MAX_RIF_MAX) * sizeof(long));
@@ -616,6 +634,10 @@ int client_obd_cleanup(struct obd_device *obd)
 
 	ldlm_put_ref();
 
+	if (cli->cl_lru_shards != NULL)
+		cfs_percpt_free(cli->cl_lru_shards);
+	cli->cl_lru_shards = NULL;
+
 	if (cli->cl_mod_tag_bitmap != NULL)
 		OBD_FREE(cli->cl_mod_tag_bitmap,
 			 BITS_TO_LONGS(OBD_MAX_RIF_MAX) * sizeof(long));
@@ -697,7 +719,6 @@ out_sem:
 		LASSERT(cli->cl_cache == NULL); /* only once */
 		cli->cl_cache = (struct cl_client_cache *)localdata;
 		cl_cache_incref(cli->cl_cache);
-		cli->cl_lru_left = &cli->cl_cache->ccc_lru_left;
 
 		/* add this osc into entity list */
 		LASSERT(list_empty(&cli->cl_lru_osc));
@@ -593,7 +593,11 @@ static bool ldlm_request_slot_needed(struct ldlm_enqueue_info *einfo)
 {
 	/* exclude EXTENT locks and DOM-only IBITS locks because they
 	 * are asynchronous and don't wait on server being blocked.
+	 * Sub-requests of a batched RPC share the slot of the batch.
 	 */
+	if (einfo->ei_batch)
+		return false;
+
 	return einfo->ei_type == LDLM_FLOCK ||
 	       (einfo->ei_type == LDLM_IBITS &&
 		einfo->ei_inodebits != MDS_INODELOCK_DOM);
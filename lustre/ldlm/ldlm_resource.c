@@ -1474,10 +1474,40 @@ static void ldlm_resource_free(struct ldlm_resource *res)
 	call_rcu(&res->lr_rcu, __ldlm_resource_free);
 }
 
+/**
+ * Lockless lookup of the resource \a name in the hash bucket \a bd.
+ *
+ * The namespace hash is never rehashed, and resources are freed after an
+ * RCU grace period, so the bucket can be walked under rcu_read_lock().  A
+ * resource whose last reference is being dropped is skipped, it is removed
+ * from the hash under the bucket lock by ldlm_resource_putref().
+ *
+ * \retval referenced resource, or NULL if not found
+ */
+static struct ldlm_resource *
+ldlm_resource_lookup_rcu(struct ldlm_namespace *ns, struct cfs_hash_bd *bd,
+			 const struct ldlm_res_id *name)
+{
+	struct hlist_head *hhead = cfs_hash_bd_hhead(ns->ns_rs_hash, bd);
+	struct ldlm_resource *res;
+
+	rcu_read_lock();
+	hlist_for_each_entry_rcu(res, hhead, lr_hash) {
+		if (ldlm_res_eq(name, &res->lr_name) &&
+		    atomic_inc_not_zero(&res->lr_refcount)) {
+			rcu_read_unlock();
+			return res;
+		}
+	}
+	rcu_read_unlock();
+
+	return NULL;
+}
+
 /**
  * Return a reference to resource with given name, creating it if necessary.
  * Args: namespace with ns_lock unlocked
- * Locks: takes and releases NS hash-lock and res->lr_lock
+ * Locks: takes and releases NS hash-lock only to add a new resource
  * Returns: referenced, unlocked ldlm_resource or ERR_PTR
  */
 struct ldlm_resource *
@@ -1488,7 +1518,6 @@ ldlm_resource_get(struct ldlm_namespace *ns, struct ldlm_resource *parent,
 	struct hlist_node	*hnode;
 	struct ldlm_resource	*res = NULL;
 	struct cfs_hash_bd		bd;
-	__u64			version;
 	int			ns_refcount = 0;
 	int hash;
 
@@ -1497,15 +1526,10 @@ ldlm_resource_get(struct ldlm_namespace *ns, struct ldlm_resource *parent,
 	LASSERT(ns->ns_rs_hash != NULL);
 	LASSERT(name->name[0] != 0);
 
-	cfs_hash_bd_get_and_lock(ns->ns_rs_hash, (void *)name, &bd, 0);
-	hnode = cfs_hash_bd_lookup_locked(ns->ns_rs_hash, &bd, (void *)name);
-	if (hnode != NULL) {
-		cfs_hash_bd_unlock(ns->ns_rs_hash, &bd, 0);
-		GOTO(found, res);
-	}
-
-	version = cfs_hash_bd_version_get(&bd);
-	cfs_hash_bd_unlock(ns->ns_rs_hash, &bd, 0);
+	cfs_hash_bd_get(ns->ns_rs_hash, (void *)name, &bd);
+	res = ldlm_resource_lookup_rcu(ns, &bd, name);
+	if (res != NULL)
+		return res;
 
 	if (create == 0)
 		return ERR_PTR(-ENOENT);
@@ -1521,17 +1545,17 @@ ldlm_resource_get(struct ldlm_namespace *ns, struct ldlm_resource *parent,
 	res->lr_name = *name;
 	res->lr_type = type;
 
+	/* The lockless lookup gives no guarantee that the resource was not
+	 * added in the meantime, so check again under the bucket lock.
+	 */
 	cfs_hash_bd_lock(ns->ns_rs_hash, &bd, 1);
-	hnode = (version == cfs_hash_bd_version_get(&bd)) ? NULL :
-		cfs_hash_bd_lookup_locked(ns->ns_rs_hash, &bd, (void *)name);
-
+	hnode = cfs_hash_bd_lookup_locked(ns->ns_rs_hash, &bd, (void *)name);
 	if (hnode != NULL) {
 		/* Someone won the race and already added the resource. */
 		cfs_hash_bd_unlock(ns->ns_rs_hash, &bd, 1);
 		/* Clean lu_ref for failed resource. */
 		lu_ref_fini(&res->lr_reference);
 		ldlm_resource_free(res);
-found:
 		res = hlist_entry(hnode, struct ldlm_resource, lr_hash);
 		return res;
 	}
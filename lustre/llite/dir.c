@@ -178,6 +178,107 @@ void ll_release_page(struct inode *inode, struct page *page,
 	put_page(page);
 }
 
+/**
+ * Set up the inode and dentry of entry \a ent of directory \a parent from
+ * the attributes and layout packed by readdir-plus, unless they are cached
+ * already.  The attributes were read without a lock, so the dentry expires
+ * llite.*.readdir_plus_max_age seconds later, unless a lookup lock is got
+ * for it meanwhile, and stat uses the attributes without a getattr RPC until
+ * then, see ll_getattr_dentry().
+ *
+ * Directories and device files are skipped, the striping of directories and
+ * the device number are not packed.
+ */
+static void ll_dir_prime_entry(struct dentry *parent, struct lu_dirent *ent)
+{
+	struct inode *dir = parent->d_inode;
+	struct ll_sb_info *sbi = ll_i2sbi(dir);
+	struct luda_attrs *lda = lu_dirent_attrs_get(ent);
+	struct mdt_body body = { 0 };
+	struct lustre_md md = { .body = &body };
+	struct dentry *dentry;
+	struct inode *inode;
+	struct qstr name;
+	__u32 lmm_size;
+#ifdef HAVE_D_IN_LOOKUP
+	DECLARE_WAIT_QUEUE_HEAD_ONSTACK(wq);
+	struct dentry *alias;
+#endif
+
+	if (lda == NULL)
+		return;
+
+	body.mbo_valid = le64_to_cpu(lda->lda_valid);
+	body.mbo_mode = le32_to_cpu(lda->lda_mode);
+	if (!(body.mbo_valid & OBD_MD_FLTYPE) || S_ISDIR(body.mbo_mode) ||
+	    S_ISCHR(body.mbo_mode) || S_ISBLK(body.mbo_mode))
+		return;
+
+	name.name = ent->lde_name;
+	name.len = le16_to_cpu(ent->lde_namelen);
+	name.hash = ll_full_name_hash(parent, name.name, name.len);
+	dentry = d_lookup(parent, &name);
+	if (dentry != NULL) {
+		dput(dentry);
+		return;
+	}
+
+	fid_le_to_cpu(&body.mbo_fid1, &ent->lde_fid);
+	body.mbo_valid |= OBD_MD_FLID;
+	body.mbo_size = le64_to_cpu(lda->lda_size);
+	body.mbo_blocks = le64_to_cpu(lda->lda_blocks);
+	body.mbo_atime = le64_to_cpu(lda->lda_atime);
+	body.mbo_mtime = le64_to_cpu(lda->lda_mtime);
+	body.mbo_ctime = le64_to_cpu(lda->lda_ctime);
+	body.mbo_uid = le32_to_cpu(lda->lda_uid);
+	body.mbo_gid = le32_to_cpu(lda->lda_gid);
+	body.mbo_nlink = le32_to_cpu(lda->lda_nlink);
+	body.mbo_flags = le32_to_cpu(lda->lda_flags);
+	body.mbo_projid = le32_to_cpu(lda->lda_projid);
+
+	lmm_size = le32_to_cpu(lda->lda_lmm_size);
+	if (lmm_size != 0 && S_ISREG(body.mbo_mode)) {
+		md.layout.lb_buf = lda + 1;
+		md.layout.lb_len = lmm_size;
+		body.mbo_eadatasize = lmm_size;
+		body.mbo_valid |= OBD_MD_FLEASIZE;
+	}
+
+	inode = ll_iget_new(dir->i_sb,
+			    cl_fid_build_ino(&body.mbo_fid1,
+					     ll_need_32bit_api(sbi)), &md);
+	if (IS_ERR(inode))
+		return;
+
+#ifdef HAVE_D_IN_LOOKUP
+	dentry = d_alloc_parallel(parent, &name, &wq);
+	if (IS_ERR(dentry)) {
+		iput(inode);
+		return;
+	}
+	/* looked up meanwhile */
+	if (!d_in_lookup(dentry)) {
+		dput(dentry);
+		iput(inode);
+		return;
+	}
+
+	alias = ll_splice_alias(inode, dentry);
+	if (!IS_ERR(alias)) {
+		spin_lock(&alias->d_lock);
+		ll_d2d(alias)->lld_rdp_expire = ktime_get_seconds() +
+						sbi->ll_rdp_max_age;
+		spin_unlock(&alias->d_lock);
+		if (alias != dentry)
+			dput(alias);
+	}
+	d_lookup_done(dentry);
+	dput(dentry);
+#else
+	iput(inode);
+#endif
+}
+
 #ifdef HAVE_DIR_CONTEXT
 int ll_dir_read(struct inode *inode, __u64 *ppos, struct md_op_data *op_data,
 		struct dir_context *ctx)
@@ -194,6 +295,7 @@ int ll_dir_read(struct inode *inode, __u64 *ppos, struct md_op_data *op_data,
 	struct page *page;
 	bool done = false;
 	struct llcrypt_str lltr = LLTR_INIT(NULL, 0);
+	struct dentry *parent = NULL;
 	int rc = 0;
 	ENTRY;
 
@@ -201,6 +303,8 @@ int ll_dir_read(struct inode *inode, __u64 *ppos, struct md_op_data *op_data,
 		rc = llcrypt_fname_alloc_buffer(inode, NAME_MAX, &lltr);
 		if (rc < 0)
 			RETURN(rc);
+	} else if (op_data->op_cli_flags & CLI_READDIR_PLUS) {
+		parent = d_find_alias(inode);
 	}
 
 	page = ll_get_dir_page(inode, op_data, pos);
@@ -241,6 +345,9 @@ int ll_dir_read(struct inode *inode, __u64 *ppos, struct md_op_data *op_data,
 			fid_le_to_cpu(&fid, &ent->lde_fid);
 			ino = cl_fid_build_ino(&fid, is_api32);
 			type = S_DT(lu_dirent_type_get(ent));
+			if (parent != NULL &&
+			    !name_is_dot_or_dotdot(ent->lde_name, namelen))
+				ll_dir_prime_entry(parent, ent);
 			/* For ll_nfs_get_name_filldir(), it will try to access
 			 * 'ent' through 'lde_name', so the parameter 'name'
 			 * for 'filldir()' must be part of the 'ent'. */
@@ -308,6 +415,8 @@ int ll_dir_read(struct inode *inode, __u64 *ppos, struct md_op_data *op_data,
 	*ppos = pos;
 #endif
 	llcrypt_fname_free_buffer(&lltr);
+	if (parent != NULL)
+		dput(parent);
 	RETURN(rc);
 }
 
@@ -389,6 +498,15 @@ static int ll_readdir(struct file *filp, void *cookie, filldir_t filldir)
 
 	op_data->op_fid3 = pfid;
 
+	/* a new listing gets fresh attributes rather than those of the
+	 * cached pages, see ll_dir_prime_entry()
+	 */
+	if (sbi->ll_rdp_max_age != 0 && !IS_ENCRYPTED(inode)) {
+		op_data->op_cli_flags |= CLI_READDIR_PLUS;
+		if (pos == 0)
+			truncate_inode_pages(inode->i_mapping, 0);
+	}
+
 #ifdef HAVE_DIR_CONTEXT
 	ctx->pos = pos;
 	rc = ll_dir_read(inode, &pos, op_data, ctx);
@@ -423,6 +541,226 @@ out:
 	RETURN(rc);
 }
 
+static void ll_luda_attrs2stx(struct inode *dir, struct lu_dirent *ent,
+			      struct ll_readdir_plus_ent *lrpe)
+{
+	struct luda_attrs *lda = lu_dirent_attrs_get(ent);
+	lstatx_t *stx = &lrpe->lrpe_stx;
+	__u64 valid;
+
+	stx->stx_blksize = PAGE_SIZE;
+	stx->stx_ino = cl_fid_build_ino(&lrpe->lrpe_fid,
+					ll_need_32bit_api(ll_i2sbi(dir)));
+	stx->stx_dev_major = MAJOR(dir->i_sb->s_dev);
+	stx->stx_dev_minor = MINOR(dir->i_sb->s_dev);
+	stx->stx_mask = STATX_INO;
+
+	if (lda == NULL)
+		return;
+
+	valid = le64_to_cpu(lda->lda_valid);
+	if (valid & OBD_MD_FLMODE) {
+		stx->stx_mode = le32_to_cpu(lda->lda_mode);
+		stx->stx_mask |= STATX_TYPE | STATX_MODE;
+	}
+	if (valid & OBD_MD_FLUID) {
+		stx->stx_uid = le32_to_cpu(lda->lda_uid);
+		stx->stx_mask |= STATX_UID;
+	}
+	if (valid & OBD_MD_FLGID) {
+		stx->stx_gid = le32_to_cpu(lda->lda_gid);
+		stx->stx_mask |= STATX_GID;
+	}
+	if (valid & OBD_MD_FLNLINK) {
+		stx->stx_nlink = le32_to_cpu(lda->lda_nlink);
+		stx->stx_mask |= STATX_NLINK;
+	}
+	if (valid & OBD_MD_FLATIME) {
+		stx->stx_atime.tv_sec = le64_to_cpu(lda->lda_atime);
+		stx->stx_mask |= STATX_ATIME;
+	}
+	if (valid & OBD_MD_FLMTIME) {
+		stx->stx_mtime.tv_sec = le64_to_cpu(lda->lda_mtime);
+		stx->stx_mask |= STATX_MTIME;
+	}
+	if (valid & OBD_MD_FLCTIME) {
+		stx->stx_ctime.tv_sec = le64_to_cpu(lda->lda_ctime);
+		stx->stx_mask |= STATX_CTIME;
+	}
+	/* as for LL_IOC_MDC_GETINFO, a lazy size is only told by the flags */
+	if (valid & (OBD_MD_FLSIZE | OBD_MD_FLLAZYSIZE))
+		stx->stx_size = le64_to_cpu(lda->lda_size);
+	if (valid & OBD_MD_FLSIZE)
+		stx->stx_mask |= STATX_SIZE;
+	if (valid & (OBD_MD_FLBLOCKS | OBD_MD_FLLAZYBLOCKS))
+		stx->stx_blocks = le64_to_cpu(lda->lda_blocks);
+	if (valid & OBD_MD_FLBLOCKS)
+		stx->stx_mask |= STATX_BLOCKS;
+
+	lrpe->lrpe_flags = valid;
+}
+
+/* largest ll_readdir_plus_ent, the LOV EA is within one directory page */
+#define LL_READDIR_PLUS_ENT_MAX	(sizeof(struct ll_readdir_plus_ent) + \
+				 round_up(NAME_MAX + 1, 8) + LU_PAGE_SIZE)
+
+/* copy the LOV EA readdir-plus packed after the attributes of \a ent */
+static void ll_luda_lmm2lrpe(struct lu_dirent *ent,
+			     struct ll_readdir_plus_ent *lrpe)
+{
+	struct luda_attrs *lda = lu_dirent_attrs_get(ent);
+	struct lov_user_md *lum;
+	__u32 lmm_size;
+
+	if (lda == NULL)
+		return;
+
+	lmm_size = le32_to_cpu(lda->lda_lmm_size);
+	if (lmm_size == 0 || lmm_size > LU_PAGE_SIZE)
+		return;
+
+	lrpe->lrpe_lmm_size = lmm_size;
+	lum = ll_readdir_plus_lmm(lrpe);
+	memcpy(lum, lda + 1, lmm_size);
+	memset((void *)lum + lmm_size, 0, round_up(lmm_size, 8) - lmm_size);
+	if (LOV_MAGIC != cpu_to_le32(LOV_MAGIC))
+		lustre_swab_lov_user_md(lum, 0);
+}
+
+/**
+ * Copy the entries of directory \a file from arg->lrp_offset on, with the
+ * attributes the MDT packed in the directory pages (readdir-plus), so that
+ * scanners do not need a getattr RPC per entry.  "." and ".." are skipped.
+ *
+ * The pages are dropped from the cache once copied, so that another call
+ * gets fresh attributes from the MDT.  Entries from pages cached by a plain
+ * readdir, or from an MDT without readdir-plus support, have no attributes.
+ */
+static int ll_dir_readdir_plus(struct file *file,
+			       struct ll_readdir_plus __user *arg)
+{
+	struct inode *inode = file_inode(file);
+	struct ll_readdir_plus lrp;
+	struct ll_readdir_plus_ent *lrpe;
+	struct md_op_data *op_data;
+	struct page *page;
+	char __user *ubuf = arg->lrp_buf;
+	__u32 used = 0;
+	__u64 pos;
+	bool done = false;
+	int rc = 0;
+
+	ENTRY;
+
+	if (copy_from_user(&lrp, arg, sizeof(lrp)))
+		RETURN(-EFAULT);
+
+	/* names are not decrypted here */
+	if (IS_ENCRYPTED(inode))
+		RETURN(-EOPNOTSUPP);
+
+	/* the attributes of the entries need search permission, as a stat */
+	rc = inode_permission(inode, MAY_EXEC);
+	if (rc)
+		RETURN(rc);
+
+	lrp.lrp_count = 0;
+	if (lrp.lrp_offset == LUSTRE_EOF)
+		GOTO(out_copy, rc = 0);
+
+	OBD_ALLOC(lrpe, LL_READDIR_PLUS_ENT_MAX);
+	if (lrpe == NULL)
+		RETURN(-ENOMEM);
+
+	op_data = ll_prep_md_op_data(NULL, inode, inode, NULL, 0, 0,
+				     LUSTRE_OPC_ANY, inode);
+	if (IS_ERR(op_data))
+		GOTO(out_free, rc = PTR_ERR(op_data));
+
+	if (unlikely(op_data->op_mea1 != NULL &&
+		     op_data->op_mea1->lsm_md_magic == LMV_MAGIC_FOREIGN))
+		GOTO(out_op_data, rc = -ENODATA);
+
+	op_data->op_cli_flags |= CLI_READDIR_PLUS;
+
+	pos = lrp.lrp_offset;
+	while (!done) {
+		struct lu_dirpage *dp;
+		struct lu_dirent *ent;
+
+		page = ll_get_dir_page(inode, op_data, pos);
+		if (IS_ERR(page))
+			GOTO(out_op_data, rc = PTR_ERR(page));
+
+		dp = page_address(page);
+		for (ent = lu_dirent_start(dp); ent != NULL;
+		     ent = lu_dirent_next(ent)) {
+			__u64 hash = le64_to_cpu(ent->lde_hash);
+			int namelen = le16_to_cpu(ent->lde_namelen);
+			__u16 reclen;
+
+			if (hash < pos || namelen == 0 || namelen > NAME_MAX)
+				continue;
+
+			if (name_is_dot_or_dotdot(ent->lde_name, namelen))
+				continue;
+
+			/* padding is copied out too */
+			memset(lrpe, 0, round_up(sizeof(*lrpe) + namelen + 1,
+						 8));
+			lrpe->lrpe_namelen = namelen;
+			fid_le_to_cpu(&lrpe->lrpe_fid, &ent->lde_fid);
+			ll_luda_attrs2stx(inode, ent, lrpe);
+			memcpy(lrpe->lrpe_name, ent->lde_name, namelen);
+			lrpe->lrpe_name[namelen] = '\0';
+			ll_luda_lmm2lrpe(ent, lrpe);
+
+			reclen = round_up(sizeof(*lrpe) + namelen + 1, 8) +
+				 round_up(lrpe->lrpe_lmm_size, 8);
+			if (used + reclen > lrp.lrp_size) {
+				pos = hash;
+				done = true;
+				break;
+			}
+			lrpe->lrpe_reclen = reclen;
+
+			if (copy_to_user(ubuf + used, lrpe, reclen)) {
+				ll_release_page(inode, page, true);
+				GOTO(out_op_data, rc = -EFAULT);
+			}
+			used += reclen;
+			lrp.lrp_count++;
+		}
+
+		if (!done) {
+			pos = le64_to_cpu(dp->ldp_hash_end);
+			if (pos == MDS_DIR_END_OFF) {
+				pos = LUSTRE_EOF;
+				done = true;
+			}
+		}
+		ll_release_page(inode, page, true);
+	}
+
+	/* the first entry does not fit in the buffer */
+	if (lrp.lrp_count == 0 && pos != LUSTRE_EOF)
+		GOTO(out_op_data, rc = -EOVERFLOW);
+
+	lrp.lrp_offset = pos;
+	EXIT;
+out_op_data:
+	ll_finish_md_op_data(op_data);
+out_free:
+	OBD_FREE(lrpe, LL_READDIR_PLUS_ENT_MAX);
+	if (rc)
+		return rc;
+out_copy:
+	if (copy_to_user(arg, &lrp, sizeof(lrp)))
+		return -EFAULT;
+
+	return 0;
+}
+
 /**
  * Create striped directory with specified stripe(@lump)
  *
@@ -2183,6 +2521,12 @@ migrate_free:
 		RETURN(ll_ioctl_fssetxattr(inode, cmd, arg));
 	case LL_IOC_PROJECT:
 		RETURN(ll_ioctl_project(file, cmd, arg));
+	case LL_IOC_STATAHEAD_NAMES:
+		RETURN(ll_statahead_names(file,
+				(struct ll_statahead_names __user *)arg));
+	case LL_IOC_READDIR_PLUS:
+		RETURN(ll_dir_readdir_plus(file,
+				(struct ll_readdir_plus __user *)arg));
 	case LL_IOC_PCC_DETACH_BY_FID: {
 		struct lu_pcc_detach_fid *detach;
 		struct lu_fid *fid;
@@ -79,6 +79,11 @@ static struct ll_file_data *ll_file_data_get(void)
 		return NULL;
 
 	fd->fd_write_failed = false;
+	fd->fd_ras_streams = NULL;
+	fd->fd_ras_count = 1;
+	fd->fd_ras_clock = 0;
+	fd->fd_ras_last = NULL;
+	spin_lock_init(&fd->fd_ras_lock);
 	pcc_file_init(&fd->fd_pcc_file);
 
 	return fd;
@@ -86,8 +91,10 @@ static struct ll_file_data *ll_file_data_get(void)
 
 static void ll_file_data_put(struct ll_file_data *fd)
 {
-        if (fd != NULL)
-                OBD_SLAB_FREE_PTR(fd, ll_file_data_slab);
+	if (fd != NULL) {
+		ll_readahead_streams_fini(fd);
+		OBD_SLAB_FREE_PTR(fd, ll_file_data_slab);
+	}
 }
 
 /**
@@ -301,6 +308,113 @@ int ll_md_real_close(struct inode *inode, fmode_t fmode)
 	RETURN(rc);
 }
 
+/*
+ * Release the open handles cached on \a inode once it was left unused for
+ * ll_oc_hold_ms.  The OPEN locks are cancelled the same way as when they are
+ * revoked by the MDS, so the handles are closed by ll_md_blocking_ast().
+ */
+static void ll_opencache_release(struct inode *inode)
+{
+	union ldlm_policy_data policy = {
+		.l_inodebits	= { MDS_INODELOCK_OPEN },
+	};
+	struct ll_inode_info *lli = ll_i2info(inode);
+	bool busy;
+
+	mutex_lock(&lli->lli_och_mutex);
+	busy = lli->lli_open_fd_read_count || lli->lli_open_fd_write_count ||
+	       lli->lli_open_fd_exec_count;
+	mutex_unlock(&lli->lli_och_mutex);
+	if (busy)
+		return;
+
+	CDEBUG(D_INODE, "release cached open handles of "DFID"\n",
+	       PFID(ll_inode2fid(inode)));
+	md_cancel_unused(ll_i2mdexp(inode), ll_inode2fid(inode), &policy,
+			 LCK_MINMODE, LCF_ASYNC, NULL);
+}
+
+static void ll_opencache_hold_work(struct work_struct *work)
+{
+	struct ll_sb_info *sbi = container_of(to_delayed_work(work),
+					      struct ll_sb_info,
+					      ll_oc_hold_work);
+	struct ll_inode_info *lli;
+	struct inode *inode;
+	ktime_t now = ktime_get();
+
+	/* inodes are queued in the order of their last close */
+	spin_lock(&sbi->ll_oc_hold_lock);
+	while ((lli = list_first_entry_or_null(&sbi->ll_oc_hold_list,
+					       struct ll_inode_info,
+					       lli_oc_hold_list)) != NULL) {
+		if (ktime_before(now, lli->lli_oc_hold_expire)) {
+			schedule_delayed_work(&sbi->ll_oc_hold_work,
+				msecs_to_jiffies(ktime_ms_delta(
+					lli->lli_oc_hold_expire, now)) + 1);
+			break;
+		}
+		list_del_init(&lli->lli_oc_hold_list);
+		spin_unlock(&sbi->ll_oc_hold_lock);
+
+		inode = ll_info2i(lli);
+		ll_opencache_release(inode);
+		iput(inode);
+
+		spin_lock(&sbi->ll_oc_hold_lock);
+	}
+	spin_unlock(&sbi->ll_oc_hold_lock);
+}
+
+/* Keep the open handles of closed @inode cached for ll_oc_hold_ms */
+static void ll_opencache_hold(struct inode *inode)
+{
+	struct ll_sb_info *sbi = ll_i2sbi(inode);
+	struct ll_inode_info *lli = ll_i2info(inode);
+	u32 hold_ms = sbi->ll_oc_hold_ms;
+
+	if (hold_ms == 0)
+		return;
+
+	spin_lock(&sbi->ll_oc_hold_lock);
+	if (list_empty(&lli->lli_oc_hold_list) && !igrab(inode)) {
+		spin_unlock(&sbi->ll_oc_hold_lock);
+		return;
+	}
+	lli->lli_oc_hold_expire = ktime_add_ms(ktime_get(), hold_ms);
+	list_move_tail(&lli->lli_oc_hold_list, &sbi->ll_oc_hold_list);
+	spin_unlock(&sbi->ll_oc_hold_lock);
+
+	schedule_delayed_work(&sbi->ll_oc_hold_work, msecs_to_jiffies(hold_ms));
+}
+
+void ll_opencache_hold_init(struct ll_sb_info *sbi)
+{
+	sbi->ll_oc_hold_ms = SBI_DEFAULT_OPENCACHE_HOLD_MS;
+	spin_lock_init(&sbi->ll_oc_hold_lock);
+	INIT_LIST_HEAD(&sbi->ll_oc_hold_list);
+	INIT_DELAYED_WORK(&sbi->ll_oc_hold_work, ll_opencache_hold_work);
+}
+
+/* Drop the inodes still queued, their OPEN locks go away with the mount */
+void ll_opencache_hold_fini(struct ll_sb_info *sbi)
+{
+	struct ll_inode_info *lli;
+
+	cancel_delayed_work_sync(&sbi->ll_oc_hold_work);
+
+	spin_lock(&sbi->ll_oc_hold_lock);
+	while ((lli = list_first_entry_or_null(&sbi->ll_oc_hold_list,
+					       struct ll_inode_info,
+					       lli_oc_hold_list)) != NULL) {
+		list_del_init(&lli->lli_oc_hold_list);
+		spin_unlock(&sbi->ll_oc_hold_lock);
+		iput(ll_info2i(lli));
+		spin_lock(&sbi->ll_oc_hold_lock);
+	}
+	spin_unlock(&sbi->ll_oc_hold_lock);
+}
+
 static int ll_md_close(struct inode *inode, struct file *file)
 {
 	union ldlm_policy_data policy = {
@@ -371,6 +485,8 @@ static int ll_md_close(struct inode *inode, struct file *file)
 	    !md_lock_match(ll_i2mdexp(inode), flags, ll_inode2fid(inode),
 			   LDLM_IBITS, &policy, lockmode, &lockh))
 		rc = ll_md_real_close(inode, fd->fd_omode);
+	else
+		ll_opencache_hold(inode);
 
 out:
 	file->private_data = NULL;
@@ -890,6 +1006,15 @@ restart:
 			}
 
 			ll_release_openhandle(file_dentry(file), it);
+			ll_stats_ops_tally(ll_i2sbi(inode),
+					   LPROC_LL_OPENCACHE_MISS, 1);
+		} else if (*och_usecount == 0) {
+			/* handle kept by the open lock after its last close
+			 * reused without any RPC, as opposed to one shared
+			 * with other opens still using it
+			 */
+			ll_stats_ops_tally(ll_i2sbi(inode),
+					   LPROC_LL_OPENCACHE_HIT, 1);
 		}
 		(*och_usecount)++;
 
@@ -971,6 +1096,7 @@ restart:
 
 			goto restart;
 		}
+		ll_stats_ops_tally(ll_i2sbi(inode), LPROC_LL_OPENCACHE_MISS, 1);
 		OBD_ALLOC(*och_p, sizeof(struct obd_client_handle));
 		if (!*och_p)
 			GOTO(out_och_free, rc = -ENOMEM);
@@ -1547,6 +1673,9 @@ void ll_io_init(struct cl_io *io, struct file *file, enum cl_io_type iot,
 		io->u.ci_wr.wr_sync   = !!(file->f_flags & O_SYNC ||
 					   file->f_flags & O_DIRECT ||
 					   IS_SYNC(inode));
+		/* buffered writes switched to DIO by hybrid IO */
+		io->u.ci_wr.wr_sync  |= !!(args &&
+					   ll_iocb_is_dio(args->u.normal.via_iocb));
 #ifdef HAVE_GENERIC_WRITE_SYNC_2ARGS
 		io->u.ci_wr.wr_sync  |= !!(args &&
 					   (args->u.normal.via_iocb->ki_flags &
@@ -1620,6 +1749,7 @@ ll_file_io_generic(const struct lu_env *env, struct vvp_io_args *args,
 	int rc = 0;
 	int rc2 = 0;
 	unsigned int retried = 0, dio_lock = 0;
+	bool is_dio = ll_iocb_is_dio(args->u.normal.via_iocb);
 	bool is_aio = false;
 	bool is_parallel_dio = false;
 	struct cl_dio_aio *ci_aio = NULL;
@@ -1639,7 +1769,7 @@ ll_file_io_generic(const struct lu_env *env, struct vvp_io_args *args,
 		max_io_pages = max_cached_pages >> 2;
 
 	io = vvp_env_thread_io(env);
-	if (file->f_flags & O_DIRECT) {
+	if (is_dio) {
 		if (!is_sync_kiocb(args->u.normal.via_iocb))
 			is_aio = true;
 
@@ -1665,7 +1795,7 @@ restart:
 	 * if we have small max_cached_mb but large block IO issued, io
 	 * could not be finished and blocked whole client.
 	 */
-	if (file->f_flags & O_DIRECT)
+	if (is_dio)
 		per_bytes = count;
 	else
 		per_bytes = min(max_io_pages << PAGE_SHIFT, count);
@@ -1691,7 +1821,7 @@ restart:
 		 * See LU-6227 for details.
 		 */
 		if (((iot == CIT_WRITE) ||
-		    (iot == CIT_READ && (file->f_flags & O_DIRECT))) &&
+		    (iot == CIT_READ && is_dio)) &&
 		    !(vio->vui_fd->fd_flags & LL_FILE_GROUP_LOCKED)) {
 			CDEBUG(D_VFSTRACE, "Range lock "RL_FMT"\n",
 			       RL_PARA(&range));
@@ -1731,6 +1861,8 @@ restart:
 			rc = 0;
 
 		rc2 = cl_sync_io_wait_recycle(env, anchor, 0, 0);
+		/* unaligned reads can only be copied out once complete */
+		rc2 = ll_dio_bounce_fini(vio, rc2);
 		if (rc2 < 0)
 			rc = rc2;
 
@@ -1886,7 +2018,7 @@ ll_do_fast_read(struct kiocb *iocb, struct iov_iter *iter)
 
 	/* NB: we can't do direct IO for fast read because it will need a lock
 	 * to make IO engine happy. */
-	if (iocb->ki_filp->f_flags & O_DIRECT)
+	if (ll_iocb_is_dio(iocb))
 		return 0;
 
 	result = generic_file_read_iter(iocb, iter);
@@ -1906,6 +2038,68 @@ ll_do_fast_read(struct kiocb *iocb, struct iov_iter *iter)
 	return result;
 }
 
+/**
+ * Decide whether buffered IO should be done as direct IO (hybrid IO).
+ *
+ * Large streaming IO gains nothing from the page cache, while page setup and
+ * LRU management cost more CPU than the network transfer itself on fast
+ * clients.  Such IO is switched to the DIO path by setting IOCB_DIRECT on the
+ * kiocb, which also makes the kernel flush and invalidate cached pages in the
+ * IO range.  Extent locking is the same as for O_DIRECT, i.e. lockless with
+ * the OST taking the lock, so other clients' caches are revoked as usual.
+ *
+ * Only sync IO is switched, and only if the DIO path can handle it: the file
+ * must not be mmapped, unaligned IO needs unaligned DIO support, and appends
+ * are never switched as their position isn't known yet.
+ *
+ * \retval true if the IO was switched to DIO
+ */
+static bool ll_hybrid_io_switch(struct kiocb *iocb, struct iov_iter *iter,
+				enum cl_io_type iot)
+{
+#ifdef IOCB_DIRECT
+	struct file *file = iocb->ki_filp;
+	struct inode *inode = file_inode(file);
+	struct ll_sb_info *sbi = ll_i2sbi(inode);
+	size_t count = iov_iter_count(iter);
+	u64 threshold;
+
+	if (!ll_sbi_has_hybrid_io(sbi) || ll_iocb_is_dio(iocb) ||
+	    !is_sync_kiocb(iocb) || iov_iter_is_pipe(iter))
+		return false;
+
+	threshold = iot == CIT_READ ? sbi->ll_hybrid_io_read_threshold :
+				      sbi->ll_hybrid_io_write_threshold;
+	if (count < threshold)
+		return false;
+
+	if (ll_file_nolock(file) || mapping_mapped(file->f_mapping))
+		return false;
+
+	/* the position of an append is only known once the size is locked,
+	 * so its alignment can't be checked here */
+	if (iot == CIT_WRITE && (file->f_flags & O_APPEND))
+		return false;
+#ifdef IOCB_APPEND
+	if (iot == CIT_WRITE && (iocb->ki_flags & IOCB_APPEND))
+		return false;
+#endif
+
+	if (((iocb->ki_pos | iov_iter_alignment(iter)) & ~PAGE_MASK) &&
+	    (!ll_sbi_has_unaligned_dio(sbi) || IS_ENCRYPTED(inode)))
+		return false;
+
+	CDEBUG(D_VFSTRACE, "%s: switch %s of %zu bytes at %lld to DIO\n",
+	       file_dentry(file)->d_name.name,
+	       iot == CIT_READ ? "read" : "write", count, iocb->ki_pos);
+	iocb->ki_flags |= IOCB_DIRECT;
+
+	return true;
+#else
+	return false;
+#endif
+}
+
 /*
  * Read from a file (through the page cache).
  */
@@ -1918,6 +2112,7 @@ static ssize_t ll_file_read_iter(struct kiocb *iocb, struct iov_iter *to)
 	ssize_t rc2;
 	__u16 refcheck;
 	ktime_t kstart = ktime_get();
+	bool hybrid = false;
 	bool cached;
 
 	if (!iov_iter_count(to))
@@ -1944,9 +2139,12 @@ static ssize_t ll_file_read_iter(struct kiocb *iocb, struct iov_iter *to)
 	if (result < 0 || iov_iter_count(to) == 0)
 		GOTO(out, result);
 
+	/* whatever was cached has been read, the rest may be done as DIO */
+	hybrid = ll_hybrid_io_switch(iocb, to, CIT_READ);
+
 	env = cl_env_get(&refcheck);
 	if (IS_ERR(env))
-		return PTR_ERR(env);
+		GOTO(out_hybrid, result = PTR_ERR(env));
 
 	args = ll_env_args(env);
 	args->u.normal.via_iter = to;
@@ -1960,6 +2158,15 @@ static ssize_t ll_file_read_iter(struct kiocb *iocb, struct iov_iter *to)
 		result = rc2;
 
 	cl_env_put(env, &refcheck);
+
+	if (hybrid && rc2 > 0)
+		ll_stats_ops_tally(ll_i2sbi(file_inode(file)),
+				   LPROC_LL_HYBRID_READ_BYTES, rc2);
+out_hybrid:
+#ifdef IOCB_DIRECT
+	if (hybrid)
+		iocb->ki_flags &= ~IOCB_DIRECT;
+#endif
 out:
 	if (result > 0) {
 		ll_rw_stats_tally(ll_i2sbi(file_inode(file)), current->pid,
@@ -2041,6 +2248,7 @@ static ssize_t ll_file_write_iter(struct kiocb *iocb, struct iov_iter *from)
 	ssize_t rc_tiny = 0, rc_normal;
 	struct file *file = iocb->ki_filp;
 	__u16 refcheck;
+	bool hybrid;
 	bool cached;
 	ktime_t kstart = ktime_get();
 	int result;
@@ -2079,9 +2287,11 @@ static ssize_t ll_file_write_iter(struct kiocb *iocb, struct iov_iter *from)
 	if (iov_iter_count(from) == 0)
 		GOTO(out, rc_normal = rc_tiny);
 
+	hybrid = ll_hybrid_io_switch(iocb, from, CIT_WRITE);
+
 	env = cl_env_get(&refcheck);
 	if (IS_ERR(env))
-		return PTR_ERR(env);
+		GOTO(out_hybrid, rc_normal = PTR_ERR(env));
 
 	args = ll_env_args(env);
 	args->u.normal.via_iter = from;
@@ -2089,6 +2299,9 @@ static ssize_t ll_file_write_iter(struct kiocb *iocb, struct iov_iter *from)
 
 	rc_normal = ll_file_io_generic(env, args, file, CIT_WRITE,
 				       &iocb->ki_pos, iov_iter_count(from));
+	if (hybrid && rc_normal > 0)
+		ll_stats_ops_tally(ll_i2sbi(file_inode(file)),
+				   LPROC_LL_HYBRID_WRITE_BYTES, rc_normal);
 
 	/* On success, combine bytes written. */
 	if (rc_tiny >= 0 && rc_normal > 0)
@@ -2100,6 +2313,11 @@ static ssize_t ll_file_write_iter(struct kiocb *iocb, struct iov_iter *from)
 		rc_normal = rc_tiny;
 
 	cl_env_put(env, &refcheck);
+out_hybrid:
+#ifdef IOCB_DIRECT
+	if (hybrid)
+		iocb->ki_flags &= ~IOCB_DIRECT;
+#endif
 out:
 	if (rc_normal > 0) {
 		ll_rw_stats_tally(ll_i2sbi(file_inode(file)), current->pid,
@@ -5187,9 +5405,14 @@ int ll_getattr_dentry(struct dentry *de, struct kstat *stat, u32 request_mask,
 	if (flags & AT_STATX_DONT_SYNC)
 		GOTO(fill_attr, rc = 0);
 
-	rc = ll_inode_revalidate(de, IT_GETATTR);
-	if (rc < 0)
-		RETURN(rc);
+	/* attributes set up by readdir-plus are used without a lock for a
+	 * while, see ll_dir_prime_entry()
+	 */
+	if (!ll_d_rdp_fresh(de)) {
+		rc = ll_inode_revalidate(de, IT_GETATTR);
+		if (rc < 0)
+			RETURN(rc);
+	}
 
 	/* foreign file/dir are always of zero length, so don't
 	 * need to validate size.
@@ -80,11 +80,27 @@ struct ll_dentry_data {
 	unsigned int			lld_sa_generation;
 	unsigned int			lld_invalid:1;
 	unsigned int			lld_nfs_dentry:1;
+	/* set up by readdir-plus and used without a lock until then */
+	time64_t			lld_rdp_expire;
 	struct rcu_head			lld_rcu_head;
 };
 
 #define ll_d2d(de) ((struct ll_dentry_data*)((de)->d_fsdata))
 
+/* the dentry and its inode were set up from the attributes packed by
+ * readdir-plus, which are still used without a lock, see ll_dir_prime_entry()
+ */
+static inline bool ll_d_rdp_fresh(const struct dentry *dentry)
+{
+	struct ll_dentry_data *ldd = ll_d2d(dentry);
+
+	return ldd != NULL && ldd->lld_rdp_expire != 0 &&
+	       ktime_get_seconds() < ldd->lld_rdp_expire;
+}
+
+/* llite.*.readdir_plus_max_age limit, in seconds */
+#define LL_RDP_MAX_AGE_MAX	60
+
 #define LLI_INODE_MAGIC                 0x111d0de5
 #define LLI_INODE_DEAD                  0xdeadd00d
 
@@ -114,6 +130,17 @@ struct ll_trunc_sem {
 	atomic_t	ll_trunc_waiters;
 };
 
+/* processes whose stats are checked for a file name pattern at once */
+#define LL_SA_FNAME_NR	4
+
+/* file name pattern detection of a process, see start_statahead_fname() */
+struct ll_sa_fname_detect {
+	pid_t		lsfd_pid;
+	u32		lsfd_hash;
+	u64		lsfd_index;
+	unsigned int	lsfd_count;
+};
+
 struct ll_inode_info {
 	__u32				lli_inode_magic;
 	rwlock_t			lli_lock;
@@ -139,6 +166,10 @@ struct ll_inode_info {
 	u64				lli_open_fd_count;
 	/* When last close was performed on this inode */
 	ktime_t				lli_close_fd_time;
+	/* Linkage into ll_sb_info::ll_oc_hold_list while the open handles
+	 * of a closed inode are kept cached, and when to release them */
+	struct list_head		lli_oc_hold_list;
+	ktime_t				lli_oc_hold_expire;
 
 	/* Protects access to och pointers and their usage counters */
 	struct mutex			lli_och_mutex;
@@ -163,7 +194,8 @@ struct ll_inode_info {
 			 * case of parent exit before child -- it is me should
 			 * cleanup the dir readahead. */
 			void			       *lli_opendir_key;
-			struct ll_statahead_info       *lli_sai;
+			/* statahead contexts, one per process at most */
+			struct list_head		lli_sa_list;
 			/* protect statahead stuff. */
 			spinlock_t			lli_sa_lock;
 			/* "opendir_pid" is the token when lookup/revalid
@@ -179,6 +211,12 @@ struct ll_inode_info {
 			unsigned short			lli_sa_enabled:1;
 			/* generation for statahead */
 			unsigned int			lli_sa_generation;
+			/* file name pattern detection of the processes
+			 * stat'ing names in this directory, replaced round
+			 * robin from lli_sa_fname_next
+			 */
+			struct ll_sa_fname_detect lli_sa_fname[LL_SA_FNAME_NR];
+			unsigned int			lli_sa_fname_next;
 			/* rw lock protects lli_lsm_md */
 			struct rw_semaphore		lli_lsm_sem;
 			/* directory stripe information */
@@ -516,6 +554,10 @@ static inline struct pcc_inode *ll_i2pcci(struct inode *inode)
 /* Min range pages */
 #define RA_MIN_MMAP_RANGE_PAGES			16UL
 
+/* max and default number of read streams tracked per open file */
+#define LL_RA_STREAMS_MAX			8
+#define SBI_DEFAULT_RA_STREAMS			4
+
 enum ra_stat {
         RA_STAT_HIT = 0,
         RA_STAT_MISS,
@@ -533,7 +575,11 @@ enum ra_stat {
 	RA_STAT_ASYNC,
 	RA_STAT_FAILED_FAST_READ,
 	RA_STAT_MMAP_RANGE_READ,
-	_NR_RA_STAT,
+	RA_STAT_STREAM_NEW,
+	RA_STAT_STREAM_RECYCLED,
+	/* hits of each read stream slot of a file, see ll_ras_find() */
+	RA_STAT_STREAM_HIT,
+	_NR_RA_STAT = RA_STAT_STREAM_HIT + LL_RA_STREAMS_MAX,
 };
 
 struct ll_ra_info {
@@ -552,6 +598,8 @@ struct ll_ra_info {
 	atomic_t ra_async_inflight;
 	/* Threshold to control when to trigger async readahead */
 	unsigned long ra_async_pages_per_file_threshold;
+	/* max number of read streams tracked per open file */
+	unsigned int ra_streams;
 };
 
 /* ra_io_arg will be filled in the beginning of ll_readahead with
@@ -643,6 +691,10 @@ enum ll_sbi_flags {
 	LL_SBI_TINY_WRITE,		/* tiny write support */
 	LL_SBI_FILE_HEAT,		/* file heat support */
 	LL_SBI_PARALLEL_DIO,		/* parallel (async) O_DIRECT RPCs */
+	LL_SBI_UNALIGNED_DIO,		/* unaligned O_DIRECT via bounce pages */
+	LL_SBI_HYBRID_IO,		/* switch large buffered IO to DIO */
+	LL_SBI_STATAHEAD_FNAME,		/* statahead by file name pattern */
+	LL_SBI_JOB_STATS,		/* per-job llite stats */
 	LL_SBI_NUM_FLAGS
 };
 
@@ -661,6 +713,20 @@ struct lustre_client_ocd {
 	struct obd_export	*lco_dt_exp;
 };
 
+/* how statahead finds the names to stat ahead */
+enum ll_sa_pattern {
+	LSA_PATTERN_LS = 0,	/* readdir of the dir opened, "ls -l" */
+	LSA_PATTERN_FNAME,	/* names with increasing number suffix */
+	LSA_PATTERN_ADVISE,	/* names given with LL_IOC_STATAHEAD_NAMES */
+	LSA_PATTERN_MAX
+};
+
+struct ll_sa_pattern_stats {
+	atomic_t		lsps_total;	/* statahead threads started */
+	atomic64_t		lsps_hit;	/* stats served from cache */
+	atomic64_t		lsps_miss;	/* stats not in cache */
+};
+
 struct ll_sb_info {
 	/* this protects pglist and ra_info.  It isn't safe to
 	 * grab from interrupt contexts */
@@ -673,6 +739,8 @@ struct ll_sb_info {
 	struct obd_device	*ll_md_obd;
 	struct obd_device	*ll_dt_obd;
 	struct dentry		*ll_debugfs_entry;
+	/* procfs, for the files debugfs cannot provide */
+	struct proc_dir_entry	*ll_proc_entry;
 	struct lu_fid		 ll_root_fid; /* root object fid */
 
 	DECLARE_BITMAP(ll_flags, LL_SBI_NUM_FLAGS); /* enum ll_sbi_flags */
@@ -684,6 +752,7 @@ struct ll_sb_info {
 	struct lustre_client_ocd ll_lco;
 
 	struct lprocfs_stats     *ll_stats; /* lprocfs stats counter */
+	struct obd_job_stats	  ll_jobstats; /* ll_stats per jobid */
 
 	/* Used to track "unstable" pages on a client, and maintain a
 	 * LRU list of clean pages. An "unstable" page is defined as
@@ -716,6 +785,8 @@ struct ll_sb_info {
 	unsigned int		  ll_sa_running_max;/* max concurrent
 						     * statahead instances */
 	unsigned int		  ll_sa_max;     /* max statahead RPCs */
+	unsigned int		  ll_sa_batch_max;/* max getattrs per batched
+						   * statahead RPC */
 	atomic_t		  ll_sa_total;   /* statahead thread started
 						  * count */
 	atomic_t		  ll_sa_wrong;   /* statahead thread stopped for
@@ -723,6 +794,7 @@ struct ll_sb_info {
 	atomic_t		  ll_sa_running; /* running statahead thread
 						  * count */
 	atomic_t		  ll_agl_total;  /* AGL thread started count */
+	struct ll_sa_pattern_stats ll_sa_stats[LSA_PATTERN_MAX];
 
 	dev_t			  ll_sdev_orig; /* save s_dev before assign for
 						 * clustred nfs */
@@ -736,6 +808,11 @@ struct ll_sb_info {
 	/* maximum relative age of cached statfs results */
 	unsigned int		  ll_statfs_max_age;
 
+	/* seconds the attributes got by readdir-plus are used without a lock,
+	 * readdir-plus is not used by readdir if 0
+	 */
+	unsigned int		  ll_rdp_max_age;
+
 	struct kset		  ll_kset;	/* sysfs object */
 	struct completion	  ll_kobj_unregister;
 
@@ -754,6 +831,21 @@ struct ll_sb_info {
 	/* Time in ms after last file close that we no longer count prior opens*/
 	u32			  ll_oc_max_ms;
 
+	/* Time in ms the open handles cached under an OPEN lock are kept after
+	 * the last close of the file, 0 to keep them until the lock is
+	 * cancelled
+	 */
+	u32			  ll_oc_hold_ms;
+	spinlock_t		  ll_oc_hold_lock;
+	struct list_head	  ll_oc_hold_list;
+	struct delayed_work	  ll_oc_hold_work;
+
+	/* Buffered IO of at least this many bytes is done as direct IO
+	 * when hybrid IO is enabled
+	 */
+	u64			  ll_hybrid_io_read_threshold;
+	u64			  ll_hybrid_io_write_threshold;
+
 	/* filesystem fsname */
 	char			  ll_fsname[LUSTRE_MAXFSNAME + 1];
 
@@ -780,6 +872,10 @@ struct ll_sb_info {
 #define SBI_DEFAULT_OPENCACHE_THRESHOLD_COUNT	(5)
 #define SBI_DEFAULT_OPENCACHE_THRESHOLD_MS	(100) /* 0.1 second */
 #define SBI_DEFAULT_OPENCACHE_THRESHOLD_MAX_MS	(60000) /* 1 minute */
+#define SBI_DEFAULT_OPENCACHE_HOLD_MS		(0) /* until lock cancel */
+
+#define SBI_DEFAULT_HYBRID_IO_READ_THRESHOLD	(8 << 20) /* 8 MiB */
+#define SBI_DEFAULT_HYBRID_IO_WRITE_THRESHOLD	(2 << 20) /* 2 MiB */
 
 /*
  * per file-descriptor read-ahead data.
@@ -870,11 +966,17 @@ struct ll_readahead_state {
 	bool		ras_need_increase_window;
 	/* whether ra miss check should be skipped */
 	bool		ras_no_miss_check;
+	/* slot of this stream in ll_file_data, see ll_ras_find() */
+	unsigned int	ras_stream_idx;
+	/* ll_file_data::fd_ras_clock at the last access of this stream */
+	unsigned long	ras_last_used;
 };
 
 struct ll_readahead_work {
 	/** File to readahead */
 	struct file			*lrw_file;
+	/** read stream of lrw_file which triggered this readahead */
+	struct ll_readahead_state	*lrw_ras;
 	pgoff_t				 lrw_start_idx;
 	pgoff_t				 lrw_end_idx;
 
@@ -886,7 +988,20 @@ struct ll_readahead_work {
 extern struct kmem_cache *ll_file_data_slab;
 struct lustre_handle;
 struct ll_file_data {
+	/* first read stream of this file */
 	struct ll_readahead_state fd_ras;
+	/* other read streams, allocated when reads of several streams are
+	 * interleaved on this file, see ll_ras_find() */
+	struct ll_readahead_state *fd_ras_streams;
+	/* number of read streams in use, including fd_ras */
+	unsigned int fd_ras_count;
+	/* access counter for LRU replacement of read streams */
+	unsigned long fd_ras_clock;
+	/* read stream last returned by ll_ras_find() */
+	struct ll_readahead_state *fd_ras_last;
+	/* protects fd_ras_streams, fd_ras_count, fd_ras_clock and
+	 * fd_ras_last */
+	spinlock_t fd_ras_lock;
 	struct ll_grouplock fd_grouplock;
 	__u64 lfd_pos;
 	__u32 fd_flags;
@@ -969,6 +1084,26 @@ static inline bool ll_sbi_has_parallel_dio(struct ll_sb_info *sbi)
 	return test_bit(LL_SBI_PARALLEL_DIO, sbi->ll_flags);
 }
 
+static inline bool ll_sbi_has_unaligned_dio(struct ll_sb_info *sbi)
+{
+	return test_bit(LL_SBI_UNALIGNED_DIO, sbi->ll_flags);
+}
+
+static inline bool ll_sbi_has_hybrid_io(struct ll_sb_info *sbi)
+{
+	return test_bit(LL_SBI_HYBRID_IO, sbi->ll_flags);
+}
+
+/* IO goes through the direct IO path, either O_DIRECT or hybrid IO */
+static inline bool ll_iocb_is_dio(const struct kiocb *iocb)
+{
+#ifdef IOCB_DIRECT
+	return iocb->ki_flags & IOCB_DIRECT;
+#else
+	return iocb->ki_filp->f_flags & O_DIRECT;
+#endif
+}
+
 void ll_ras_enter(struct file *f, loff_t pos, size_t count);
 
 /* llite/lcommon_misc.c */
@@ -1019,6 +1154,10 @@ enum {
 	LPROC_LL_FALLOCATE,
 	LPROC_LL_INODE_OCOUNT,
 	LPROC_LL_INODE_OPCLTM,
+	LPROC_LL_OPENCACHE_HIT,
+	LPROC_LL_OPENCACHE_MISS,
+	LPROC_LL_HYBRID_READ_BYTES,
+	LPROC_LL_HYBRID_WRITE_BYTES,
 	LPROC_LL_FILE_OPCODES
 };
 
@@ -1048,6 +1187,8 @@ extern const struct inode_operations ll_special_inode_operations;
 
 struct inode *ll_iget(struct super_block *sb, ino_t hash,
                       struct lustre_md *lic);
+struct inode *ll_iget_new(struct super_block *sb, ino_t hash,
+			  struct lustre_md *md);
 int ll_test_inode_by_fid(struct inode *inode, void *opaque);
 int ll_md_blocking_ast(struct ldlm_lock *, struct ldlm_lock_desc *,
                        void *data, int flag);
@@ -1062,6 +1203,7 @@ int ll_readpage(struct file *file, struct page *page);
 int ll_io_read_page(const struct lu_env *env, struct cl_io *io,
 			   struct cl_page *page, struct file *file);
 void ll_readahead_init(struct inode *inode, struct ll_readahead_state *ras);
+void ll_readahead_streams_fini(struct ll_file_data *fd);
 int vvp_io_write_commit(const struct lu_env *env, struct cl_io *io);
 
 enum lcc_type;
@@ -1071,6 +1213,7 @@ void ll_cl_remove(struct inode *inode, const struct lu_env *env);
 struct ll_cl_context *ll_cl_find(struct inode *inode);
 
 extern const struct address_space_operations ll_aops;
+int ll_dio_bounce_fini(struct vvp_io *vio, int ioret);
 
 /* llite/file.c */
 extern const struct inode_operations ll_file_inode_operations;
@@ -1085,6 +1228,8 @@ int ll_file_open(struct inode *inode, struct file *file);
 int ll_file_release(struct inode *inode, struct file *file);
 int ll_release_openhandle(struct dentry *, struct lookup_intent *);
 int ll_md_real_close(struct inode *inode, fmode_t fmode);
+void ll_opencache_hold_init(struct ll_sb_info *sbi);
+void ll_opencache_hold_fini(struct ll_sb_info *sbi);
 void ll_track_file_opens(struct inode *inode);
 extern void ll_rw_stats_tally(struct ll_sb_info *sbi, pid_t pid,
                               struct ll_file_data *file, loff_t pos,
@@ -1427,6 +1572,19 @@ void ll_ra_stats_inc(struct inode *inode, enum ra_stat which);
 #define LL_SA_RPC_DEF           32
 #define LL_SA_RPC_MAX           512
 
+/* max count of getattrs packed in one batched RPC, 0 disables batching */
+#define LL_SA_BATCH_DEF		32
+#define LL_SA_BATCH_MAX		MSG_BATCH_MAX_COUNT
+
+/* consecutive stats of names with increasing index to start statahead */
+#define LL_SA_FNAME_MIN		3
+
+/* statahead thread not driven by readdir quits when not used for so long */
+#define LL_SA_IDLE_TIMEOUT	cfs_time_seconds(1)
+
+/* maximum size of the names of LL_IOC_STATAHEAD_NAMES */
+#define LL_SA_NAMES_SIZE_MAX	(1 << 20)
+
 /* XXX: If want to support more concurrent statahead instances,
  *	please consider to decentralize the RPC lists attached
  *	on related import, such as imp_{sending,delayed}_list.
@@ -1441,8 +1599,13 @@ void ll_ra_stats_inc(struct inode *inode, enum ra_stat which);
 /* per inode struct, for dir only */
 struct ll_statahead_info {
 	struct dentry	       *sai_dentry;
+	struct list_head	sai_list;	/* link into lli_sa_list */
 	atomic_t		sai_refcount;   /* when access this struct, hold
 						 * refcount */
+	enum ll_sa_pattern	sai_pattern;	/* how names are found */
+	pid_t			sai_pid;	/* process served */
+	unsigned long		sai_access;	/* jiffies of last cache access
+						 * by sai_pid */
 	unsigned int            sai_max;        /* max ahead of lookup */
 	__u64                   sai_sent;       /* stat requests sent count */
 	__u64                   sai_replied;    /* stat requests which received
@@ -1470,6 +1633,7 @@ struct ll_statahead_info {
 	wait_queue_head_t	sai_waitq;	/* stat-ahead wait queue */
 	struct task_struct	*sai_task;	/* stat-ahead thread */
 	struct task_struct	*sai_agl_task;	/* AGL thread */
+	struct lu_batch		*sai_bh;	/* batch of getattrs to send */
 	struct list_head	sai_interim_entries; /* entries which got async
 						      * stat reply, but not
 						      * instantiated */
@@ -1478,6 +1642,17 @@ struct ll_statahead_info {
 	struct list_head	sai_cache[LL_SA_CACHE_SIZE];
 	spinlock_t		sai_cache_lock[LL_SA_CACHE_SIZE];
 	atomic_t		sai_cache_count; /* entry count in cache */
+	/* LSA_PATTERN_FNAME: names are sai_fname followed by sai_fname_index
+	 * printed on sai_fname_width digits */
+	__u64			sai_fname_index;
+	unsigned int		sai_fname_width;
+	unsigned int		sai_fname_enoent; /* consecutive -ENOENT */
+	char			sai_fname[NAME_MAX + 1];
+	/* LSA_PATTERN_ADVISE: NUL-terminated names given by the user */
+	char		       *sai_names;
+	unsigned int		sai_names_size;
+	unsigned int		sai_names_pos;
+	unsigned int		sai_names_count; /* names left to stat */
 };
 
 int ll_revalidate_statahead(struct inode *dir, struct dentry **dentry,
@@ -1485,6 +1660,7 @@ int ll_revalidate_statahead(struct inode *dir, struct dentry **dentry,
 int ll_start_statahead(struct inode *dir, struct dentry *dentry, bool agl);
 void ll_authorize_statahead(struct inode *dir, void *key);
 void ll_deauthorize_statahead(struct inode *dir, void *key);
+int ll_statahead_names(struct file *file, struct ll_statahead_names __user *arg);
 
 /* glimpse.c */
 blkcnt_t dirty_cnt(struct inode *inode);
@@ -1527,25 +1703,15 @@ static inline int ll_glimpse_size(struct inode *inode)
 static inline bool
 dentry_may_statahead(struct inode *dir, struct dentry *dentry)
 {
+	struct ll_sb_info     *sbi = ll_i2sbi(dir);
 	struct ll_inode_info  *lli;
 	struct ll_dentry_data *ldd;
 
-	if (ll_i2sbi(dir)->ll_sa_max == 0)
+	if (sbi->ll_sa_max == 0)
 		return false;
 
 	lli = ll_i2info(dir);
 
-	/* statahead is not allowed for this dir, there may be three causes:
-	 * 1. dir is not opened.
-	 * 2. statahead hit ratio is too low.
-	 * 3. previous stat started statahead thread failed. */
-	if (!lli->lli_sa_enabled)
-		return false;
-
-	/* not the same process, don't statahead */
-	if (lli->lli_opendir_pid != current->pid)
-		return false;
-
 	/*
 	 * When stating a dentry, kernel may trigger 'revalidate' or 'lookup'
 	 * multiple times, eg. for 'getattr', 'getxattr' and etc.
@@ -1565,7 +1731,23 @@ dentry_may_statahead(struct inode *dir, struct dentry *dentry)
 	    ldd->lld_sa_generation == lli->lli_sa_generation)
 		return false;
 
-	return true;
+	/* attributes were just got by readdir-plus */
+	if (ll_d_rdp_fresh(dentry))
+		return false;
+
+	/* statahead by readdir is done for the process which opened the dir,
+	 * unless it is disabled because the hit ratio is too low or starting
+	 * the statahead thread failed.
+	 */
+	if (lli->lli_sa_enabled && lli->lli_opendir_pid == current->pid)
+		return true;
+
+	/* other processes may find names to stat ahead by pattern */
+	if (!list_empty(&lli->lli_sa_list))
+		return true;
+
+	return test_bit(LL_SBI_STATAHEAD_FNAME, sbi->ll_flags) &&
+	       !IS_ENCRYPTED(dir);
 }
 
 int cl_sync_file_range(struct inode *inode, loff_t start, loff_t end,
@@ -1619,7 +1801,13 @@ static inline void ll_set_lock_data(struct obd_export *exp, struct inode *inode,
 
 static inline int d_lustre_invalid(const struct dentry *dentry)
 {
-	return !ll_d2d(dentry) || ll_d2d(dentry)->lld_invalid;
+	struct ll_dentry_data *ldd = ll_d2d(dentry);
+
+	/* dentries set up by readdir-plus have no lookup lock to be
+	 * invalidated by, they expire instead
+	 */
+	return !ldd || ldd->lld_invalid ||
+	       (ldd->lld_rdp_expire != 0 && !ll_d_rdp_fresh(dentry));
 }
 
 /*
@@ -1645,6 +1833,7 @@ static inline void d_lustre_revalidate(struct dentry *dentry)
 	spin_lock(&dentry->d_lock);
 	LASSERT(ll_d2d(dentry));
 	ll_d2d(dentry)->lld_invalid = 0;
+	ll_d2d(dentry)->lld_rdp_expire = 0;
 	spin_unlock(&dentry->d_lock);
 }
 
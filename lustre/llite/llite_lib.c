@@ -155,6 +155,7 @@ static struct ll_sb_info *ll_init_sbi(void)
 	sbi->ll_ra_info.ra_async_pages_per_file_threshold =
 				sbi->ll_ra_info.ra_max_pages_per_file;
 	sbi->ll_ra_info.ra_range_pages = SBI_DEFAULT_RA_RANGE_PAGES;
+	sbi->ll_ra_info.ra_streams = SBI_DEFAULT_RA_STREAMS;
 	sbi->ll_ra_info.ra_max_read_ahead_whole_pages = -1;
 	atomic_set(&sbi->ll_ra_info.ra_async_inflight, 0);
 
@@ -181,14 +182,21 @@ static struct ll_sb_info *ll_init_sbi(void)
 	/* metadata statahead is enabled by default */
 	sbi->ll_sa_running_max = LL_SA_RUNNING_DEF;
 	sbi->ll_sa_max = LL_SA_RPC_DEF;
+	sbi->ll_sa_batch_max = LL_SA_BATCH_DEF;
 	atomic_set(&sbi->ll_sa_total, 0);
 	atomic_set(&sbi->ll_sa_wrong, 0);
 	atomic_set(&sbi->ll_sa_running, 0);
 	atomic_set(&sbi->ll_agl_total, 0);
+	for (i = 0; i < LSA_PATTERN_MAX; i++) {
+		atomic_set(&sbi->ll_sa_stats[i].lsps_total, 0);
+		atomic64_set(&sbi->ll_sa_stats[i].lsps_hit, 0);
+		atomic64_set(&sbi->ll_sa_stats[i].lsps_miss, 0);
+	}
 	set_bit(LL_SBI_AGL_ENABLED, sbi->ll_flags);
 	set_bit(LL_SBI_FAST_READ, sbi->ll_flags);
 	set_bit(LL_SBI_TINY_WRITE, sbi->ll_flags);
 	set_bit(LL_SBI_PARALLEL_DIO, sbi->ll_flags);
+	set_bit(LL_SBI_UNALIGNED_DIO, sbi->ll_flags);
 	ll_sbi_set_encrypt(sbi, true);
 
 	/* root squash */
@@ -205,6 +213,12 @@ static struct ll_sb_info *ll_init_sbi(void)
 	sbi->ll_oc_thrsh_count = SBI_DEFAULT_OPENCACHE_THRESHOLD_COUNT;
 	sbi->ll_oc_max_ms = SBI_DEFAULT_OPENCACHE_THRESHOLD_MAX_MS;
 	sbi->ll_oc_thrsh_ms = SBI_DEFAULT_OPENCACHE_THRESHOLD_MS;
+	ll_opencache_hold_init(sbi);
+
+	/* hybrid IO is disabled by default, see ll_hybrid_io_switch() */
+	sbi->ll_hybrid_io_read_threshold = SBI_DEFAULT_HYBRID_IO_READ_THRESHOLD;
+	sbi->ll_hybrid_io_write_threshold =
+		SBI_DEFAULT_HYBRID_IO_WRITE_THRESHOLD;
 	RETURN(sbi);
 out_destroy_ra:
 	if (sbi->ll_foreign_symlink_prefix)
@@ -341,7 +355,9 @@ static int client_common_fill_super(struct super_block *sb, char *md, char *dt)
 				   OBD_CONNECT2_GETATTR_PFID |
 				   OBD_CONNECT2_DOM_LVB |
 				   OBD_CONNECT2_REP_MBITS |
-				   OBD_CONNECT2_ATOMIC_OPEN_LOCK;
+				   OBD_CONNECT2_ATOMIC_OPEN_LOCK |
+				   OBD_CONNECT2_MSG_BATCH |
+				   OBD_CONNECT2_READDIR_PLUS;
 
 #ifdef HAVE_LRU_RESIZE_SUPPORT
 	if (test_bit(LL_SBI_LRU_RESIZE, sbi->ll_flags))
@@ -534,7 +550,8 @@ static int client_common_fill_super(struct super_block *sb, char *md, char *dt)
 				  OBD_CONNECT_FLAGS2 | OBD_CONNECT_GRANT_SHRINK;
 	data->ocd_connect_flags2 = OBD_CONNECT2_LOCKAHEAD |
 				   OBD_CONNECT2_INC_XID | OBD_CONNECT2_LSEEK |
-				   OBD_CONNECT2_REP_MBITS;
+				   OBD_CONNECT2_REP_MBITS |
+				   OBD_CONNECT2_WIRE_COMPRESS;
 
 	if (!OBD_FAIL_CHECK(OBD_FAIL_OSC_CONNECT_GRANT_PARAM))
 		data->ocd_connect_flags |= OBD_CONNECT_GRANT_PARAM;
@@ -936,6 +953,10 @@ static const match_table_t ll_sbi_flags_name = {
 	{LL_SBI_TINY_WRITE,		"tiny_write"},
 	{LL_SBI_FILE_HEAT,		"file_heat"},
 	{LL_SBI_PARALLEL_DIO,		"parallel_dio"},
+	{LL_SBI_UNALIGNED_DIO,		"unaligned_dio"},
+	{LL_SBI_HYBRID_IO,		"hybrid_io"},
+	{LL_SBI_STATAHEAD_FNAME,	"statahead_fname"},
+	{LL_SBI_JOB_STATS,		"job_stats"},
 };
 
 int ll_sbi_flags_seq_show(struct seq_file *m, void *v)
@@ -1129,6 +1150,7 @@ void ll_lli_init(struct ll_inode_info *lli)
         lli->lli_open_fd_write_count = 0;
         lli->lli_open_fd_exec_count = 0;
 	mutex_init(&lli->lli_och_mutex);
+	INIT_LIST_HEAD(&lli->lli_oc_hold_list);
 	spin_lock_init(&lli->lli_agl_lock);
 	spin_lock_init(&lli->lli_layout_lock);
 	ll_layout_version_set(lli, CL_LAYOUT_GEN_NONE);
@@ -1140,10 +1162,12 @@ void ll_lli_init(struct ll_inode_info *lli)
 	LASSERT(lli->lli_vfs_inode.i_mode != 0);
 	if (S_ISDIR(lli->lli_vfs_inode.i_mode)) {
 		lli->lli_opendir_key = NULL;
-		lli->lli_sai = NULL;
+		INIT_LIST_HEAD(&lli->lli_sa_list);
 		spin_lock_init(&lli->lli_sa_lock);
 		lli->lli_opendir_pid = 0;
 		lli->lli_sa_enabled = 0;
+		memset(lli->lli_sa_fname, 0, sizeof(lli->lli_sa_fname));
+		lli->lli_sa_fname_next = 0;
 		init_rwsem(&lli->lli_lsm_sem);
 	} else {
 		mutex_init(&lli->lli_size_mutex);
@@ -1413,6 +1437,8 @@ void ll_put_super(struct super_block *sb)
 		}
 	}
 
+	ll_opencache_hold_fini(sbi);
+
 	if (sbi->ll_client_common_fill_super_succeeded) {
 		/* Only if client_common_fill_super succeeded */
 		client_common_put_super(sb);
@@ -1756,7 +1782,7 @@ void ll_clear_inode(struct inode *inode)
 	if (S_ISDIR(inode->i_mode)) {
 		/* these should have been cleared in ll_file_release */
 		LASSERT(lli->lli_opendir_key == NULL);
-		LASSERT(lli->lli_sai == NULL);
+		LASSERT(list_empty(&lli->lli_sa_list));
 		LASSERT(lli->lli_opendir_pid == 0);
 	} else {
 		pcc_inode_free(inode);
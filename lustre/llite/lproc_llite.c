@@ -43,6 +43,7 @@
 
 static struct kobject *llite_kobj;
 static struct dentry *llite_root;
+static struct proc_dir_entry *llite_proc_root;
 
 static void llite_kobj_release(struct kobject *kobj)
 {
@@ -74,6 +75,12 @@ int llite_tunables_register(void)
 		goto free_kobj;
 
 	llite_root = debugfs_create_dir("llite", debugfs_lustre_root);
+
+	/* per-job stats need mmap, which debugfs does not proxy */
+	llite_proc_root = lprocfs_register("llite", proc_lustre_root,
+					   NULL, NULL);
+	if (IS_ERR(llite_proc_root))
+		llite_proc_root = NULL;
 	return 0;
 
 free_kobj:
@@ -85,6 +92,7 @@ free_kobj:
 
 void llite_tunables_unregister(void)
 {
+	lprocfs_remove(&llite_proc_root);
 	kobject_put(llite_kobj);
 	llite_kobj = NULL;
 }
@@ -463,7 +471,7 @@ static int ll_max_cached_mb_seq_show(struct seq_file *m, void *v)
 
 	mutex_lock(&cache->ccc_max_cache_mb_lock);
 	max_cached_mb = PAGES_TO_MiB(cache->ccc_lru_max);
-	unused_mb = PAGES_TO_MiB(atomic_long_read(&cache->ccc_lru_left));
+	unused_mb = PAGES_TO_MiB(cl_cache_lru_left(cache));
 	mutex_unlock(&cache->ccc_max_cache_mb_lock);
 
 	seq_printf(m, "users: %d\n"
@@ -528,7 +536,7 @@ static ssize_t ll_max_cached_mb_seq_write(struct file *file,
 
 	/* easy - add more LRU slots. */
 	if (diff >= 0) {
-		atomic_long_add(diff, &cache->ccc_lru_left);
+		cl_cache_lru_put(cache, CFS_CPT_ANY, diff);
 		GOTO(out, rc = 0);
 	}
 
@@ -540,26 +548,11 @@ static ssize_t ll_max_cached_mb_seq_write(struct file *file,
 	while (diff > 0) {
 		long tmp;
 
-		/* reduce LRU budget from free slots. */
-		do {
-			long lru_left_old, lru_left_new, lru_left_ret;
-
-			lru_left_old = atomic_long_read(&cache->ccc_lru_left);
-			if (lru_left_old == 0)
-				break;
-
-			lru_left_new = lru_left_old > diff ?
-					lru_left_old - diff : 0;
-			lru_left_ret =
-				atomic_long_cmpxchg(&cache->ccc_lru_left,
-						    lru_left_old,
-						    lru_left_new);
-			if (likely(lru_left_old == lru_left_ret)) {
-				diff -= lru_left_old - lru_left_new;
-				nrpages += lru_left_old - lru_left_new;
-				break;
-			}
-		} while (1);
+		/* reduce LRU budget from free slots of all CPTs. */
+		tmp = cl_cache_lru_get(cache, cfs_cpt_current(cfs_cpt_tab, 1),
+				       diff, 0);
+		diff -= tmp;
+		nrpages += tmp;
 
 		if (diff <= 0)
 			break;
@@ -588,7 +581,7 @@ out:
 		cache->ccc_lru_max = pages_number;
 		rc = count;
 	} else {
-		atomic_long_add(nrpages, &cache->ccc_lru_left);
+		cl_cache_lru_put(cache, CFS_CPT_ANY, nrpages);
 	}
 out_unlock:
 	mutex_unlock(&cache->ccc_max_cache_mb_lock);
@@ -792,6 +785,42 @@ static ssize_t statahead_max_store(struct kobject *kobj,
 }
 LUSTRE_RW_ATTR(statahead_max);
 
+static ssize_t statahead_batch_max_show(struct kobject *kobj,
+					struct attribute *attr,
+					char *buf)
+{
+	struct ll_sb_info *sbi = container_of(kobj, struct ll_sb_info,
+					      ll_kset.kobj);
+
+	return sprintf(buf, "%u\n", sbi->ll_sa_batch_max);
+}
+
+static ssize_t statahead_batch_max_store(struct kobject *kobj,
+					 struct attribute *attr,
+					 const char *buffer,
+					 size_t count)
+{
+	struct ll_sb_info *sbi = container_of(kobj, struct ll_sb_info,
+					      ll_kset.kobj);
+	unsigned long val;
+	int rc;
+
+	rc = kstrtoul(buffer, 0, &val);
+	if (rc)
+		return rc;
+
+	if (val > LL_SA_BATCH_MAX) {
+		CERROR("Bad statahead_batch_max value %lu. Valid values are in the range [0, %d]\n",
+		       val, LL_SA_BATCH_MAX);
+		return -ERANGE;
+	}
+
+	sbi->ll_sa_batch_max = val;
+
+	return count;
+}
+LUSTRE_RW_ATTR(statahead_batch_max);
+
 static ssize_t statahead_agl_show(struct kobject *kobj,
 				  struct attribute *attr,
 				  char *buf)
@@ -826,10 +855,86 @@ static ssize_t statahead_agl_store(struct kobject *kobj,
 }
 LUSTRE_RW_ATTR(statahead_agl);
 
+static ssize_t statahead_fname_show(struct kobject *kobj,
+				    struct attribute *attr,
+				    char *buf)
+{
+	struct ll_sb_info *sbi = container_of(kobj, struct ll_sb_info,
+					      ll_kset.kobj);
+
+	return scnprintf(buf, PAGE_SIZE, "%u\n",
+			 test_bit(LL_SBI_STATAHEAD_FNAME, sbi->ll_flags));
+}
+
+static ssize_t statahead_fname_store(struct kobject *kobj,
+				     struct attribute *attr,
+				     const char *buffer,
+				     size_t count)
+{
+	struct ll_sb_info *sbi = container_of(kobj, struct ll_sb_info,
+					      ll_kset.kobj);
+	bool val;
+	int rc;
+
+	rc = kstrtobool(buffer, &val);
+	if (rc)
+		return rc;
+
+	if (val)
+		set_bit(LL_SBI_STATAHEAD_FNAME, sbi->ll_flags);
+	else
+		clear_bit(LL_SBI_STATAHEAD_FNAME, sbi->ll_flags);
+
+	return count;
+}
+LUSTRE_RW_ATTR(statahead_fname);
+
+static ssize_t job_stats_enable_show(struct kobject *kobj,
+				     struct attribute *attr,
+				     char *buf)
+{
+	struct ll_sb_info *sbi = container_of(kobj, struct ll_sb_info,
+					      ll_kset.kobj);
+
+	return scnprintf(buf, PAGE_SIZE, "%u\n",
+			 test_bit(LL_SBI_JOB_STATS, sbi->ll_flags));
+}
+
+/* off by default, it looks up the jobid of every tallied operation */
+static ssize_t job_stats_enable_store(struct kobject *kobj,
+				      struct attribute *attr,
+				      const char *buffer,
+				      size_t count)
+{
+	struct ll_sb_info *sbi = container_of(kobj, struct ll_sb_info,
+					      ll_kset.kobj);
+	bool val;
+	int rc;
+
+	rc = kstrtobool(buffer, &val);
+	if (rc)
+		return rc;
+
+	if (val)
+		set_bit(LL_SBI_JOB_STATS, sbi->ll_flags);
+	else
+		clear_bit(LL_SBI_JOB_STATS, sbi->ll_flags);
+
+	return count;
+}
+LUSTRE_RW_ATTR(job_stats_enable);
+
+static const char *const ll_sa_pattern_names[LSA_PATTERN_MAX] = {
+	[LSA_PATTERN_LS]	= "ls",
+	[LSA_PATTERN_FNAME]	= "fname",
+	[LSA_PATTERN_ADVISE]	= "advise",
+};
+
 static int ll_statahead_stats_seq_show(struct seq_file *m, void *v)
 {
 	struct super_block *sb = m->private;
 	struct ll_sb_info *sbi = ll_s2sbi(sb);
+	int i;
 
 	seq_printf(m, "statahead total: %u\n"
 		      "statahead wrong: %u\n"
@@ -837,6 +942,16 @@ static int ll_statahead_stats_seq_show(struct seq_file *m, void *v)
 		   atomic_read(&sbi->ll_sa_total),
 		   atomic_read(&sbi->ll_sa_wrong),
 		   atomic_read(&sbi->ll_agl_total));
+
+	for (i = 0; i < LSA_PATTERN_MAX; i++) {
+		struct ll_sa_pattern_stats *stats = &sbi->ll_sa_stats[i];
+
+		seq_printf(m, "%s total: %u hit: %lld miss: %lld\n",
+			   ll_sa_pattern_names[i],
+			   atomic_read(&stats->lsps_total),
+			   (s64)atomic64_read(&stats->lsps_hit),
+			   (s64)atomic64_read(&stats->lsps_miss));
+	}
 	return 0;
 }
 
@@ -906,6 +1021,36 @@ static ssize_t statfs_max_age_store(struct kobject *kobj,
 }
 LUSTRE_RW_ATTR(statfs_max_age);
 
+static ssize_t readdir_plus_max_age_show(struct kobject *kobj,
+					 struct attribute *attr, char *buf)
+{
+	struct ll_sb_info *sbi = container_of(kobj, struct ll_sb_info,
+					      ll_kset.kobj);
+
+	return scnprintf(buf, PAGE_SIZE, "%u\n", sbi->ll_rdp_max_age);
+}
+
+static ssize_t readdir_plus_max_age_store(struct kobject *kobj,
+					  struct attribute *attr,
+					  const char *buffer, size_t count)
+{
+	struct ll_sb_info *sbi = container_of(kobj, struct ll_sb_info,
+					      ll_kset.kobj);
+	unsigned int val;
+	int rc;
+
+	rc = kstrtouint(buffer, 10, &val);
+	if (rc)
+		return rc;
+	if (val > LL_RDP_MAX_AGE_MAX)
+		return -EINVAL;
+
+	sbi->ll_rdp_max_age = val;
+
+	return count;
+}
+LUSTRE_RW_ATTR(readdir_plus_max_age);
+
 static ssize_t max_easize_show(struct kobject *kobj,
 			       struct attribute *attr,
 			       char *buf)
@@ -1103,6 +1248,137 @@ static ssize_t parallel_dio_store(struct kobject *kobj,
 }
 LUSTRE_RW_ATTR(parallel_dio);
 
+static ssize_t unaligned_dio_show(struct kobject *kobj,
+				  struct attribute *attr,
+				  char *buf)
+{
+	struct ll_sb_info *sbi = container_of(kobj, struct ll_sb_info,
+					      ll_kset.kobj);
+
+	return snprintf(buf, PAGE_SIZE, "%u\n",
+			test_bit(LL_SBI_UNALIGNED_DIO, sbi->ll_flags));
+}
+
+static ssize_t unaligned_dio_store(struct kobject *kobj,
+				   struct attribute *attr,
+				   const char *buffer,
+				   size_t count)
+{
+	struct ll_sb_info *sbi = container_of(kobj, struct ll_sb_info,
+					      ll_kset.kobj);
+	bool val;
+	int rc;
+
+	rc = kstrtobool(buffer, &val);
+	if (rc)
+		return rc;
+
+	spin_lock(&sbi->ll_lock);
+	if (val)
+		set_bit(LL_SBI_UNALIGNED_DIO, sbi->ll_flags);
+	else
+		clear_bit(LL_SBI_UNALIGNED_DIO, sbi->ll_flags);
+	spin_unlock(&sbi->ll_lock);
+
+	return count;
+}
+LUSTRE_RW_ATTR(unaligned_dio);
+
+static ssize_t hybrid_io_show(struct kobject *kobj, struct attribute *attr,
+			      char *buf)
+{
+	struct ll_sb_info *sbi = container_of(kobj, struct ll_sb_info,
+					      ll_kset.kobj);
+
+	return snprintf(buf, PAGE_SIZE, "%u\n",
+			test_bit(LL_SBI_HYBRID_IO, sbi->ll_flags));
+}
+
+static ssize_t hybrid_io_store(struct kobject *kobj, struct attribute *attr,
+			       const char *buffer, size_t count)
+{
+	struct ll_sb_info *sbi = container_of(kobj, struct ll_sb_info,
+					      ll_kset.kobj);
+	bool val;
+	int rc;
+
+	rc = kstrtobool(buffer, &val);
+	if (rc)
+		return rc;
+
+	spin_lock(&sbi->ll_lock);
+	if (val)
+		set_bit(LL_SBI_HYBRID_IO, sbi->ll_flags);
+	else
+		clear_bit(LL_SBI_HYBRID_IO, sbi->ll_flags);
+	spin_unlock(&sbi->ll_lock);
+
+	return count;
+}
+LUSTRE_RW_ATTR(hybrid_io);
+
+static ssize_t hybrid_io_read_threshold_bytes_show(struct kobject *kobj,
+						   struct attribute *attr,
+						   char *buf)
+{
+	struct ll_sb_info *sbi = container_of(kobj, struct ll_sb_info,
+					      ll_kset.kobj);
+
+	return snprintf(buf, PAGE_SIZE, "%llu\n",
+			sbi->ll_hybrid_io_read_threshold);
+}
+
+static ssize_t hybrid_io_read_threshold_bytes_store(struct kobject *kobj,
+						    struct attribute *attr,
+						    const char *buffer,
+						    size_t count)
+{
+	struct ll_sb_info *sbi = container_of(kobj, struct ll_sb_info,
+					      ll_kset.kobj);
+	u64 val;
+	int rc;
+
+	rc = sysfs_memparse(buffer, count, &val, "B");
+	if (rc)
+		return rc;
+
+	sbi->ll_hybrid_io_read_threshold = val;
+
+	return count;
+}
+LUSTRE_RW_ATTR(hybrid_io_read_threshold_bytes);
+
+static ssize_t hybrid_io_write_threshold_bytes_show(struct kobject *kobj,
+						    struct attribute *attr,
+						    char *buf)
+{
+	struct ll_sb_info *sbi = container_of(kobj, struct ll_sb_info,
+					      ll_kset.kobj);
+
+	return snprintf(buf, PAGE_SIZE, "%llu\n",
+			sbi->ll_hybrid_io_write_threshold);
+}
+
+static ssize_t hybrid_io_write_threshold_bytes_store(struct kobject *kobj,
+						     struct attribute *attr,
+						     const char *buffer,
+						     size_t count)
+{
+	struct ll_sb_info *sbi = container_of(kobj, struct ll_sb_info,
+					      ll_kset.kobj);
+	u64 val;
+	int rc;
+
+	rc = sysfs_memparse(buffer, count, &val, "B");
+	if (rc)
+		return rc;
+
+	sbi->ll_hybrid_io_write_threshold = val;
+
+	return count;
+}
+LUSTRE_RW_ATTR(hybrid_io_write_threshold_bytes);
+
 static ssize_t max_read_ahead_async_active_show(struct kobject *kobj,
 					       struct attribute *attr,
 					       char *buf)
@@ -1234,6 +1510,42 @@ out:
 }
 LUSTRE_RW_ATTR(read_ahead_range_kb);
 
+static ssize_t read_ahead_streams_show(struct kobject *kobj,
+				       struct attribute *attr, char *buf)
+{
+	struct ll_sb_info *sbi = container_of(kobj, struct ll_sb_info,
+					      ll_kset.kobj);
+
+	return scnprintf(buf, PAGE_SIZE, "%u\n", sbi->ll_ra_info.ra_streams);
+}
+
+static ssize_t read_ahead_streams_store(struct kobject *kobj,
+					struct attribute *attr,
+					const char *buffer, size_t count)
+{
+	struct ll_sb_info *sbi = container_of(kobj, struct ll_sb_info,
+					      ll_kset.kobj);
+	unsigned int val;
+	int rc;
+
+	rc = kstrtouint(buffer, 10, &val);
+	if (rc)
+		return rc;
+
+	if (val < 1 || val > LL_RA_STREAMS_MAX) {
+		CERROR("%s: read_ahead_streams=%u must be between 1 and %u\n",
+		       sbi->ll_fsname, val, LL_RA_STREAMS_MAX);
+		return -ERANGE;
+	}
+
+	spin_lock(&sbi->ll_lock);
+	sbi->ll_ra_info.ra_streams = val;
+	spin_unlock(&sbi->ll_lock);
+
+	return count;
+}
+LUSTRE_RW_ATTR(read_ahead_streams);
+
 static ssize_t fast_read_show(struct kobject *kobj,
 			      struct attribute *attr,
 			      char *buf)
@@ -1472,6 +1784,36 @@ static ssize_t opencache_max_ms_store(struct kobject *kobj,
 }
 LUSTRE_RW_ATTR(opencache_max_ms);
 
+static ssize_t opencache_hold_ms_show(struct kobject *kobj,
+				      struct attribute *attr,
+				      char *buf)
+{
+	struct ll_sb_info *sbi = container_of(kobj, struct ll_sb_info,
+					      ll_kset.kobj);
+
+	return snprintf(buf, PAGE_SIZE, "%u\n", sbi->ll_oc_hold_ms);
+}
+
+static ssize_t opencache_hold_ms_store(struct kobject *kobj,
+				       struct attribute *attr,
+				       const char *buffer,
+				       size_t count)
+{
+	struct ll_sb_info *sbi = container_of(kobj, struct ll_sb_info,
+					      ll_kset.kobj);
+	unsigned int val;
+	int rc;
+
+	rc = kstrtouint(buffer, 10, &val);
+	if (rc)
+		return rc;
+
+	sbi->ll_oc_hold_ms = val;
+
+	return count;
+}
+LUSTRE_RW_ATTR(opencache_hold_ms);
+
 static int ll_unstable_stats_seq_show(struct seq_file *m, void *v)
 {
 	struct super_block	*sb    = m->private;
@@ -1673,26 +2015,36 @@ static struct attribute *llite_attrs[] = {
 	&lustre_attr_max_read_ahead_async_active.attr,
 	&lustre_attr_read_ahead_async_file_threshold_mb.attr,
 	&lustre_attr_read_ahead_range_kb.attr,
+	&lustre_attr_read_ahead_streams.attr,
 	&lustre_attr_stats_track_pid.attr,
 	&lustre_attr_stats_track_ppid.attr,
 	&lustre_attr_stats_track_gid.attr,
+	&lustre_attr_job_stats_enable.attr,
 	&lustre_attr_statahead_running_max.attr,
 	&lustre_attr_statahead_max.attr,
+	&lustre_attr_statahead_batch_max.attr,
 	&lustre_attr_statahead_agl.attr,
+	&lustre_attr_statahead_fname.attr,
 	&lustre_attr_lazystatfs.attr,
 	&lustre_attr_statfs_max_age.attr,
+	&lustre_attr_readdir_plus_max_age.attr,
 	&lustre_attr_max_easize.attr,
 	&lustre_attr_default_easize.attr,
 	&lustre_attr_xattr_cache.attr,
 	&lustre_attr_fast_read.attr,
 	&lustre_attr_tiny_write.attr,
 	&lustre_attr_parallel_dio.attr,
+	&lustre_attr_unaligned_dio.attr,
+	&lustre_attr_hybrid_io.attr,
+	&lustre_attr_hybrid_io_read_threshold_bytes.attr,
+	&lustre_attr_hybrid_io_write_threshold_bytes.attr,
 	&lustre_attr_file_heat.attr,
 	&lustre_attr_heat_decay_percentage.attr,
 	&lustre_attr_heat_period_second.attr,
 	&lustre_attr_opencache_threshold_count.attr,
 	&lustre_attr_opencache_threshold_ms.attr,
 	&lustre_attr_opencache_max_ms.attr,
+	&lustre_attr_opencache_hold_ms.attr,
 	NULL,
 };
 
@@ -1732,6 +2084,12 @@ static const struct llite_file_opcode {
 				LPROCFS_CNTR_AVGMINMAX |
 				LPROCFS_CNTR_STDDEV,	"opencount" },
 	{ LPROC_LL_INODE_OPCLTM,LPROCFS_TYPE_LATENCY,	"openclosetime" },
+	{ LPROC_LL_OPENCACHE_HIT, LPROCFS_TYPE_REQS,	"opencache_hit" },
+	{ LPROC_LL_OPENCACHE_MISS, LPROCFS_TYPE_REQS,	"opencache_miss" },
+	{ LPROC_LL_HYBRID_READ_BYTES,  LPROCFS_TYPE_BYTES_FULL,
+						"hybrid_read_bytes" },
+	{ LPROC_LL_HYBRID_WRITE_BYTES, LPROCFS_TYPE_BYTES_FULL,
+						"hybrid_write_bytes" },
 	/* inode operation */
 	{ LPROC_LL_SETATTR,	LPROCFS_TYPE_LATENCY,	"setattr" },
 	{ LPROC_LL_TRUNC,	LPROCFS_TYPE_LATENCY,	"truncate" },
@@ -1757,11 +2115,82 @@ static const struct llite_file_opcode {
 	{ LPROC_LL_INODE_PERM,	LPROCFS_TYPE_LATENCY,	"inode_permission" },
 };
 
+/* operations with a latency histogram in the per-job stats */
+static bool ll_job_stats_hist(__u32 opcode)
+{
+	switch (opcode) {
+	case LPROC_LL_READ:
+	case LPROC_LL_WRITE:
+	case LPROC_LL_OPEN:
+	case LPROC_LL_RELEASE:
+	case LPROC_LL_FSYNC:
+	case LPROC_LL_READDIR:
+	case LPROC_LL_SETATTR:
+	case LPROC_LL_GETATTR:
+	case LPROC_LL_CREATE:
+	case LPROC_LL_UNLINK:
+	case LPROC_LL_MKDIR:
+	case LPROC_LL_RENAME:
+		return true;
+	default:
+		return false;
+	}
+}
+
+static void __ll_stats_counter_init(struct lprocfs_stats *stats,
+				    unsigned int offset, bool job)
+{
+	int id;
+
+	for (id = 0; id < LPROC_LL_FILE_OPCODES; id++) {
+		u32 type = llite_opcode_table[id].type;
+		void *ptr = "unknown";
+
+		if (job && ll_job_stats_hist(llite_opcode_table[id].opcode))
+			type |= LPROCFS_CNTR_HISTOGRAM;
+
+		if (type & LPROCFS_TYPE_REQS)
+			ptr = "reqs";
+		else if (type & LPROCFS_TYPE_BYTES)
+			ptr = "bytes";
+		else if (type & LPROCFS_TYPE_USEC)
+			ptr = "usec";
+		lprocfs_counter_init(stats,
+				     offset + llite_opcode_table[id].opcode,
+				     type, llite_opcode_table[id].opname, ptr);
+	}
+}
+
+static void ll_stats_counter_init(struct lprocfs_stats *stats,
+				  unsigned int offset)
+{
+	__ll_stats_counter_init(stats, offset, false);
+}
+
+static void ll_job_stats_counter_init(struct lprocfs_stats *stats,
+				      unsigned int offset)
+{
+	__ll_stats_counter_init(stats, offset, true);
+}
+
+static void ll_job_stats_tally(struct ll_sb_info *sbi, int op, long count)
+{
+	char jobid[LUSTRE_JOBID_SIZE];
+
+	if (lustre_get_jobid(jobid, sizeof(jobid)) == 0 && jobid[0] != '\0')
+		lprocfs_job_stats_add(&sbi->ll_jobstats, jobid, op, count);
+}
+
 void ll_stats_ops_tally(struct ll_sb_info *sbi, int op, long count)
 {
 	if (!sbi->ll_stats)
 		return;
 
+	/* unlike ll_stats, not restricted by stats_track_* */
+	if (test_bit(LL_SBI_JOB_STATS, sbi->ll_flags) &&
+	    sbi->ll_jobstats.ojs_hash != NULL)
+		ll_job_stats_tally(sbi, op, count);
+
 	if (sbi->ll_stats_track_type == STATS_TRACK_ALL)
 		lprocfs_counter_add(sbi->ll_stats, op, count);
 	else if (sbi->ll_stats_track_type == STATS_TRACK_PID &&
@@ -1794,6 +2223,16 @@ static const char *const ra_stat_string[] = {
 	[RA_STAT_ASYNC]			= "async_readahead",
 	[RA_STAT_FAILED_FAST_READ]	= "failed_to_fast_read",
 	[RA_STAT_MMAP_RANGE_READ]	= "mmap_range_read",
+	[RA_STAT_STREAM_NEW]		= "stream_new",
+	[RA_STAT_STREAM_RECYCLED]	= "stream_recycled",
+	[RA_STAT_STREAM_HIT + 0]	= "stream0_hits",
+	[RA_STAT_STREAM_HIT + 1]	= "stream1_hits",
+	[RA_STAT_STREAM_HIT + 2]	= "stream2_hits",
+	[RA_STAT_STREAM_HIT + 3]	= "stream3_hits",
+	[RA_STAT_STREAM_HIT + 4]	= "stream4_hits",
+	[RA_STAT_STREAM_HIT + 5]	= "stream5_hits",
+	[RA_STAT_STREAM_HIT + 6]	= "stream6_hits",
+	[RA_STAT_STREAM_HIT + 7]	= "stream7_hits",
 };
 
 int ll_debugfs_register_super(struct super_block *sb, const char *name)
@@ -1831,24 +2270,12 @@ int ll_debugfs_register_super(struct super_block *sb, const char *name)
 		GOTO(out_debugfs, err = -ENOMEM);
 
 	/* do counter init */
-	for (id = 0; id < LPROC_LL_FILE_OPCODES; id++) {
-		u32 type = llite_opcode_table[id].type;
-		void *ptr = "unknown";
-
-		if (type & LPROCFS_TYPE_REQS)
-			ptr = "reqs";
-		else if (type & LPROCFS_TYPE_BYTES)
-			ptr = "bytes";
-		else if (type & LPROCFS_TYPE_USEC)
-			ptr = "usec";
-		lprocfs_counter_init(sbi->ll_stats,
-				     llite_opcode_table[id].opcode, type,
-				     llite_opcode_table[id].opname, ptr);
-	}
+	ll_stats_counter_init(sbi->ll_stats, 0);
 
 	debugfs_create_file("stats", 0644, sbi->ll_debugfs_entry,
 			    sbi->ll_stats, &ldebugfs_stats_seq_fops);
 
+	BUILD_BUG_ON(ARRAY_SIZE(ra_stat_string) != _NR_RA_STAT);
 	sbi->ll_ra_stats = lprocfs_alloc_stats(ARRAY_SIZE(ra_stat_string),
 					       LPROCFS_STATS_FLAG_NONE);
 	if (sbi->ll_ra_stats == NULL)
@@ -1861,6 +2288,23 @@ int ll_debugfs_register_super(struct super_block *sb, const char *name)
 	debugfs_create_file("read_ahead_stats", 0644, sbi->ll_debugfs_entry,
 			    sbi->ll_ra_stats, &ldebugfs_stats_seq_fops);
 
+	if (llite_proc_root) {
+		sbi->ll_proc_entry = lprocfs_register(name, llite_proc_root,
+						      NULL, NULL);
+		if (IS_ERR(sbi->ll_proc_entry)) {
+			err = PTR_ERR(sbi->ll_proc_entry);
+			sbi->ll_proc_entry = NULL;
+			GOTO(out_ra_stats, err);
+		}
+
+		err = lprocfs_job_stats_register(&sbi->ll_jobstats,
+						 sbi->ll_proc_entry,
+						 LPROC_LL_FILE_OPCODES,
+						 ll_job_stats_counter_init);
+		if (err)
+			GOTO(out_proc, err);
+	}
+
 out_ll_kset:
 	/* Yes we also register sysfs mount kset here as well */
 	sbi->ll_kset.kobj.parent = llite_kobj;
@@ -1868,15 +2312,18 @@ out_ll_kset:
 	init_completion(&sbi->ll_kobj_unregister);
 	err = kobject_set_name(&sbi->ll_kset.kobj, "%s", name);
 	if (err)
-		GOTO(out_ra_stats, err);
+		GOTO(out_proc, err);
 
 	err = kset_register(&sbi->ll_kset);
 	if (err)
-		GOTO(out_ra_stats, err);
+		GOTO(out_proc, err);
 
 	lsi->lsi_kobj = kobject_get(&sbi->ll_kset.kobj);
 
 	RETURN(0);
+out_proc:
+	lprocfs_remove(&sbi->ll_proc_entry);
+	lprocfs_job_stats_unregister(&sbi->ll_jobstats);
 out_ra_stats:
 	lprocfs_free_stats(&sbi->ll_ra_stats);
 out_stats:
@@ -1893,6 +2340,8 @@ void ll_debugfs_unregister_super(struct super_block *sb)
 	struct ll_sb_info *sbi = ll_s2sbi(sb);
 
 	debugfs_remove_recursive(sbi->ll_debugfs_entry);
+	lprocfs_remove(&sbi->ll_proc_entry);
+	lprocfs_job_stats_unregister(&sbi->ll_jobstats);
 
 	if (sbi->ll_dt_obd)
 		sysfs_remove_link(&sbi->ll_kset.kobj,
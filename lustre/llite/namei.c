@@ -98,6 +98,35 @@ static int ll_set_inode(struct inode *inode, void *opaque)
 }
 
 
+/* set up a new inode got from iget5_locked() */
+static struct inode *ll_iget_init(struct inode *inode, struct lustre_md *md)
+{
+	int rc;
+
+	rc = ll_read_inode2(inode, md);
+	if (rc == 0 && S_ISREG(inode->i_mode) &&
+	    ll_i2info(inode)->lli_clob == NULL)
+		rc = cl_file_inode_init(inode, md);
+
+	if (rc != 0) {
+		/* Let's clear directory lsm here, otherwise
+		 * make_bad_inode() will reset the inode mode
+		 * to regular, then ll_clear_inode will not
+		 * be able to clear lsm_md */
+		if (S_ISDIR(inode->i_mode))
+			ll_dir_clear_lsm_md(inode);
+		make_bad_inode(inode);
+		unlock_new_inode(inode);
+		iput(inode);
+		inode = ERR_PTR(rc);
+	} else {
+		inode_has_no_xattr(inode);
+		unlock_new_inode(inode);
+	}
+
+	return inode;
+}
+
 /**
  * Get an inode by inode number(@hash), which is already instantiated by
  * the intent lookup).
@@ -116,26 +145,7 @@ struct inode *ll_iget(struct super_block *sb, ino_t hash,
 		RETURN(ERR_PTR(-ENOMEM));
 
 	if (inode->i_state & I_NEW) {
-		rc = ll_read_inode2(inode, md);
-		if (rc == 0 && S_ISREG(inode->i_mode) &&
-		    ll_i2info(inode)->lli_clob == NULL)
-			rc = cl_file_inode_init(inode, md);
-
-		if (rc != 0) {
-			/* Let's clear directory lsm here, otherwise
-			 * make_bad_inode() will reset the inode mode
-			 * to regular, then ll_clear_inode will not
-			 * be able to clear lsm_md */
-			if (S_ISDIR(inode->i_mode))
-				ll_dir_clear_lsm_md(inode);
-			make_bad_inode(inode);
-			unlock_new_inode(inode);
-			iput(inode);
-			inode = ERR_PTR(rc);
-		} else {
-			inode_has_no_xattr(inode);
-			unlock_new_inode(inode);
-		}
+		inode = ll_iget_init(inode, md);
 	} else if (is_bad_inode(inode)) {
 		iput(inode);
 		inode = ERR_PTR(-ESTALE);
@@ -154,6 +164,29 @@ struct inode *ll_iget(struct super_block *sb, ino_t hash,
         RETURN(inode);
 }
 
+/**
+ * Get a new inode for @md as ll_iget() does, but fail with -EEXIST instead
+ * of updating the inode if it is cached already: @md was got without a lock
+ * and must not overwrite the attributes of a cached inode.
+ */
+struct inode *ll_iget_new(struct super_block *sb, ino_t hash,
+			  struct lustre_md *md)
+{
+	struct inode *inode;
+
+	LASSERT(hash != 0);
+	inode = iget5_locked(sb, hash, ll_test_inode, ll_set_inode, md);
+	if (inode == NULL)
+		return ERR_PTR(-ENOMEM);
+
+	if (!(inode->i_state & I_NEW)) {
+		iput(inode);
+		return ERR_PTR(-EEXIST);
+	}
+
+	return ll_iget_init(inode, md);
+}
+
 /* mark negative sub file dentries invalid and prune unused dentries */
 static void ll_prune_negative_children(struct inode *dir)
 {
@@ -586,7 +586,7 @@ static void ll_readahead_handle_work(struct work_struct *wq)
 	work = container_of(wq, struct ll_readahead_work,
 			    lrw_readahead_work);
 	fd = work->lrw_file->private_data;
-	ras = &fd->fd_ras;
+	ras = work->lrw_ras;
 	file = work->lrw_file;
 	inode = file_inode(file);
 	sbi = ll_i2sbi(inode);
@@ -1214,11 +1214,162 @@ static void ras_detect_read_pattern(struct ll_readahead_state *ras,
 	ras->ras_last_read_end_bytes = pos + count - 1;
 }
 
+/* read stream \a i of \a fd */
+static inline struct ll_readahead_state *
+ll_ras_stream(struct ll_file_data *fd, unsigned int i)
+{
+	return i == 0 ? &fd->fd_ras : &fd->fd_ras_streams[i - 1];
+}
+
+/*
+ * Check whether the read of \a count bytes at \a pos continues the stream
+ * \a ras: it is within or just after the reads since the last seek of the
+ * stream, it matches its stride pattern, or it is in its read-ahead window.
+ */
+static bool ras_stream_match(struct ll_readahead_state *ras,
+			     loff_t pos, size_t count)
+{
+	pgoff_t index = pos >> PAGE_SHIFT;
+
+	if (pos <= ras->ras_last_read_end_bytes &&
+	    pos + ras->ras_consecutive_bytes > ras->ras_last_read_end_bytes)
+		return true;
+
+	if (is_loose_seq_read(ras, pos) ||
+	    read_in_stride_window(ras, pos, count))
+		return true;
+
+	return ras->ras_window_pages > 0 &&
+	       pos_in_window(index, ras->ras_window_start_idx, 0,
+			     ras->ras_window_pages);
+}
+
+/* set up \a ras for a new stream starting at \a pos */
+static void ras_stream_reset(struct ll_readahead_state *ras, loff_t pos)
+{
+	spin_lock(&ras->ras_lock);
+	ras_reset(ras, pos >> PAGE_SHIFT);
+	ras_stride_reset(ras);
+	ras->ras_last_read_end_bytes = pos > 0 ? pos - 1 : 0;
+	ras->ras_requests = 0;
+	ras->ras_range_min_start_idx = 0;
+	ras->ras_range_max_end_idx = 0;
+	ras->ras_range_requests = 0;
+	ras->ras_last_range_pages = 0;
+	ras->ras_async_last_readpage_idx = 0;
+	spin_unlock(&ras->ras_lock);
+}
+
+/**
+ * Find the read stream of \a fd which the read of \a count bytes at \a pos
+ * belongs to.
+ *
+ * Several threads sharing a file descriptor, or an application reading
+ * several parts of a file in turn, interleave reads of independent streams,
+ * which would reset a single read-ahead state at every switch. Up to
+ * ll_ra_info::ra_streams streams are tracked per file instead, each with its
+ * own sequential and stride detection.
+ *
+ * If no stream matches, a forward seek is given to the most recently used
+ * stream so that its stride detector can see it. Otherwise, if \a create is
+ * set, a new stream is started, replacing the least recently used one if
+ * all the streams are in use.
+ *
+ * Streams are checked without their ras_lock held, a wrong guess only costs
+ * read-ahead efficiency. For the same reason, the pages read without
+ * \a create are looked up in the read-ahead window of the stream last
+ * found first, to take fd_ras_lock once per window rather than per page.
+ */
+static struct ll_readahead_state *ll_ras_find(struct inode *inode,
+					      struct ll_file_data *fd,
+					      loff_t pos, size_t count,
+					      bool create)
+{
+	struct ll_sb_info *sbi = ll_i2sbi(inode);
+	struct ll_readahead_state *streams = NULL;
+	struct ll_readahead_state *ras;
+	struct ll_readahead_state *lru = NULL;
+	struct ll_readahead_state *mru = NULL;
+	unsigned int max_streams;
+	unsigned int i;
+
+	max_streams = min_t(unsigned int, sbi->ll_ra_info.ra_streams,
+			    LL_RA_STREAMS_MAX);
+	if (max_streams <= 1 && fd->fd_ras_count <= 1)
+		return &fd->fd_ras;
+
+	ras = READ_ONCE(fd->fd_ras_last);
+	if (!create && ras != NULL && ras->ras_window_pages > 0 &&
+	    pos_in_window(pos >> PAGE_SHIFT, ras->ras_window_start_idx, 0,
+			  ras->ras_window_pages))
+		return ras;
+
+	/* extra streams are allocated on the first sign of a second stream */
+	if (create && max_streams > 1 && fd->fd_ras_streams == NULL &&
+	    !ras_stream_match(&fd->fd_ras, pos, count)) {
+		OBD_ALLOC(streams, sizeof(*streams) * (LL_RA_STREAMS_MAX - 1));
+		for (i = 0; streams != NULL && i < LL_RA_STREAMS_MAX - 1; i++) {
+			ll_readahead_init(inode, &streams[i]);
+			streams[i].ras_stream_idx = i + 1;
+		}
+	}
+
+	spin_lock(&fd->fd_ras_lock);
+	if (streams != NULL && fd->fd_ras_streams == NULL) {
+		fd->fd_ras_streams = streams;
+		streams = NULL;
+	}
+
+	for (i = 0; i < fd->fd_ras_count; i++) {
+		ras = ll_ras_stream(fd, i);
+		if (ras_stream_match(ras, pos, count))
+			goto found;
+
+		if (lru == NULL || ras->ras_last_used < lru->ras_last_used)
+			lru = ras;
+		if (mru == NULL || ras->ras_last_used > mru->ras_last_used)
+			mru = ras;
+	}
+
+	ras = mru;
+	if (!create || pos > mru->ras_last_read_end_bytes)
+		goto found;
+
+	if (fd->fd_ras_count < max_streams && fd->fd_ras_streams != NULL) {
+		ras = ll_ras_stream(fd, fd->fd_ras_count++);
+		ll_ra_stats_inc_sbi(sbi, RA_STAT_STREAM_NEW);
+	} else {
+		ras = lru;
+		ll_ra_stats_inc_sbi(sbi, RA_STAT_STREAM_RECYCLED);
+	}
+	ras_stream_reset(ras, pos);
+found:
+	ras->ras_last_used = ++fd->fd_ras_clock;
+	WRITE_ONCE(fd->fd_ras_last, ras);
+	spin_unlock(&fd->fd_ras_lock);
+
+	if (streams != NULL)
+		OBD_FREE(streams, sizeof(*streams) * (LL_RA_STREAMS_MAX - 1));
+
+	return ras;
+}
+
+void ll_readahead_streams_fini(struct ll_file_data *fd)
+{
+	if (fd->fd_ras_streams != NULL)
+		OBD_FREE(fd->fd_ras_streams,
+			 sizeof(*fd->fd_ras_streams) * (LL_RA_STREAMS_MAX - 1));
+	fd->fd_ras_streams = NULL;
+	fd->fd_ras_count = 1;
+	fd->fd_ras_last = NULL;
+}
+
 void ll_ras_enter(struct file *f, loff_t pos, size_t count)
 {
 	struct ll_file_data *fd = f->private_data;
-	struct ll_readahead_state *ras = &fd->fd_ras;
 	struct inode *inode = file_inode(f);
+	struct ll_readahead_state *ras = ll_ras_find(inode, fd, pos, count,
+						     true);
 	unsigned long index = pos >> PAGE_SHIFT;
 	struct ll_sb_info *sbi = ll_i2sbi(inode);
 
@@ -1304,6 +1455,9 @@ static void ras_update(struct ll_sb_info *sbi, struct inode *inode,
 		CDEBUG(D_READA, DFID " pages at %lu miss.\n",
 		       PFID(ll_inode2fid(inode)), index);
 	ll_ra_stats_inc_sbi(sbi, hit ? RA_STAT_HIT : RA_STAT_MISS);
+	if (hit)
+		ll_ra_stats_inc_sbi(sbi,
+				    RA_STAT_STREAM_HIT + ras->ras_stream_idx);
 
 	/*
 	 * The readahead window has been expanded to cover whole
@@ -1628,14 +1782,16 @@ int ll_io_read_page(const struct lu_env *env, struct cl_io *io,
 	pgoff_t io_end_index;
 	ENTRY;
 
+	vpg = cl2vvp_page(cl_object_page_slice(page->cp_obj, page));
+	uptodate = vpg->vpg_defer_uptodate;
+
 	if (file) {
 		fd = file->private_data;
-		ras = &fd->fd_ras;
+		ras = ll_ras_find(inode, fd,
+				  (loff_t)vvp_index(vpg) << PAGE_SHIFT,
+				  PAGE_SIZE, false);
 	}
 
-	vpg = cl2vvp_page(cl_object_page_slice(page->cp_obj, page));
-	uptodate = vpg->vpg_defer_uptodate;
-
 	if (ll_readahead_enabled(sbi) && !vpg->vpg_ra_updated && ras) {
 		struct vvp_io *vio = vvp_env_io(env);
 		enum ras_update_flags flags = 0;
@@ -1723,13 +1879,13 @@ int ll_io_read_page(const struct lu_env *env, struct cl_io *io,
  * 2 async readahead triggered and fast read could be used too.
  * < 0 on error.
  */
-static int kickoff_async_readahead(struct file *file, unsigned long pages)
+static int kickoff_async_readahead(struct file *file,
+				   struct ll_readahead_state *ras,
+				   unsigned long pages)
 {
 	struct ll_readahead_work *lrw;
 	struct inode *inode = file_inode(file);
 	struct ll_sb_info *sbi = ll_i2sbi(inode);
-	struct ll_file_data *fd = file->private_data;
-	struct ll_readahead_state *ras = &fd->fd_ras;
 	struct ll_ra_info *ra = &sbi->ll_ra_info;
 	unsigned long throttle;
 	pgoff_t start_idx = ras_align(ras, ras->ras_next_readahead_idx);
@@ -1767,6 +1923,7 @@ static int kickoff_async_readahead(struct file *file, unsigned long pages)
 	if (lrw) {
 		atomic_inc(&sbi->ll_ra_info.ra_async_inflight);
 		lrw->lrw_file = get_file(file);
+		lrw->lrw_ras = ras;
 		lrw->lrw_start_idx = start_idx;
 		lrw->lrw_end_idx = end_idx;
 		spin_lock(&ras->ras_lock);
@@ -1806,7 +1963,7 @@ static bool ll_use_fast_io(struct file *file,
 
 	if (ras->ras_window_start_idx + ras->ras_window_pages <
 	    ras->ras_next_readahead_idx + skip_pages ||
-	    kickoff_async_readahead(file, fast_read_pages) > 0)
+	    kickoff_async_readahead(file, ras, fast_read_pages) > 0)
 		return true;
 
 	return false;
@@ -1833,7 +1990,7 @@ int ll_readpage(struct file *file, struct page *vmpage)
 	if (io == NULL) { /* fast read */
 		struct inode *inode = file_inode(file);
 		struct ll_file_data *fd = file->private_data;
-		struct ll_readahead_state *ras = &fd->fd_ras;
+		struct ll_readahead_state *ras;
 		struct lu_env  *local_env = NULL;
 		struct vvp_page *vpg;
 
@@ -1855,6 +2012,9 @@ int ll_readpage(struct file *file, struct page *vmpage)
 			if (lcc && lcc->lcc_type == LCC_MMAP)
 				flags |= LL_RAS_MMAP;
 
+			ras = ll_ras_find(inode, fd,
+					  (loff_t)vvp_index(vpg) << PAGE_SHIFT,
+					  PAGE_SIZE, false);
 			/* For fast read, it updates read ahead state only
 			 * if the page is hit in cache because non cache page
 			 * case will be handled by slow read later. */
@@ -1894,8 +2054,9 @@ int ll_readpage(struct file *file, struct page *vmpage)
 	 * with lockless i/o, and buffered requires LDLM locking, so in
 	 * this case we must restart without lockless.
 	 */
-	if (file->f_flags & O_DIRECT &&
-	    lcc && lcc->lcc_type == LCC_RW &&
+	if (lcc && lcc->lcc_type == LCC_RW &&
+	    vvp_env_io(env)->vui_iocb &&
+	    ll_iocb_is_dio(vvp_env_io(env)->vui_iocb) &&
 	    !io->ci_dio_lock) {
 		unlock_page(vmpage);
 		io->ci_dio_lock = 1;
@@ -324,6 +324,26 @@ struct ll_dio_pages {
 	loff_t			ldp_file_offset;
 };
 
+/**
+ * Bounce buffer for one chunk of unaligned direct IO.
+ *
+ * The data is placed at the same offset within each page as it has in the
+ * file, so only the first and last pages are partial and the chunk can be
+ * sent as a regular (clipped) transient page array.
+ */
+struct ll_dio_bounce {
+	struct list_head	 ldb_linkage;
+	struct page		**ldb_pages;
+	/** # of pages in the array. */
+	size_t			 ldb_count;
+	/** offset of the data in the first page. */
+	size_t			 ldb_offset;
+	/** # of bytes of data in the bounce pages. */
+	size_t			 ldb_bytes;
+	/** user buffer the data is copied to when a read completes */
+	struct iov_iter		 ldb_iter;
+};
+
 static int
 ll_direct_rw_pages(const struct lu_env *env, struct cl_io *io, size_t size,
 		   int rw, struct inode *inode, struct ll_dio_pages *pv)
@@ -342,7 +362,11 @@ ll_direct_rw_pages(const struct lu_env *env, struct cl_io *io, size_t size,
 
 	cl_2queue_init(queue);
 	for (i = 0; i < pv->ldp_count; i++) {
-		LASSERT(!(offset & (PAGE_SIZE - 1)));
+		/* only the first page may start at a non-zero offset */
+		size_t from = offset & (page_size - 1);
+		size_t to = min_t(size_t, page_size, from + size);
+
+		LASSERT(i == 0 || from == 0);
 		page = cl_page_find(env, obj, cl_index(obj, offset),
 				    pv->ldp_pages[i], CPT_TRANSIENT);
 		if (IS_ERR(page)) {
@@ -375,12 +399,12 @@ ll_direct_rw_pages(const struct lu_env *env, struct cl_io *io, size_t size,
 		 * Set page clip to tell transfer formation engine
 		 * that page has to be sent even if it is beyond KMS.
 		 */
-		if (size < page_size)
-			cl_page_clip(env, page, 0, size);
+		if (from != 0 || to < page_size)
+			cl_page_clip(env, page, from, to);
 		++io_pages;
 
-		offset += page_size;
-		size -= page_size;
+		offset += to - from;
+		size -= to - from;
 	}
 	if (rc == 0 && io_pages > 0) {
 		int iot = rw == READ ? CRT_READ : CRT_WRITE;
@@ -417,6 +441,178 @@ ll_direct_rw_pages(const struct lu_env *env, struct cl_io *io, size_t size,
 	RETURN(rc);
 }
 
+static void ll_dio_bounce_free(struct ll_dio_bounce *ldb)
+{
+	size_t i;
+
+	for (i = 0; i < ldb->ldb_count; i++) {
+		if (ldb->ldb_pages[i])
+			put_page(ldb->ldb_pages[i]);
+	}
+	OBD_FREE_PTR_ARRAY_LARGE(ldb->ldb_pages, ldb->ldb_count);
+	OBD_FREE_PTR(ldb);
+}
+
+static struct ll_dio_bounce *ll_dio_bounce_alloc(loff_t file_offset,
+						 size_t count)
+{
+	struct ll_dio_bounce *ldb;
+	size_t i;
+
+	OBD_ALLOC_PTR(ldb);
+	if (ldb == NULL)
+		return NULL;
+
+	INIT_LIST_HEAD(&ldb->ldb_linkage);
+	ldb->ldb_offset = file_offset & ~PAGE_MASK;
+	ldb->ldb_bytes = count;
+	ldb->ldb_count = DIV_ROUND_UP(ldb->ldb_offset + count, PAGE_SIZE);
+	OBD_ALLOC_PTR_ARRAY_LARGE(ldb->ldb_pages, ldb->ldb_count);
+	if (ldb->ldb_pages == NULL) {
+		OBD_FREE_PTR(ldb);
+		return NULL;
+	}
+
+	for (i = 0; i < ldb->ldb_count; i++) {
+		ldb->ldb_pages[i] = alloc_page(GFP_NOFS);
+		if (ldb->ldb_pages[i] == NULL) {
+			ll_dio_bounce_free(ldb);
+			return NULL;
+		}
+	}
+
+	return ldb;
+}
+
+/* copy data between the bounce pages and the user buffer described by @iter */
+static int ll_dio_bounce_copy(struct ll_dio_bounce *ldb, struct iov_iter *iter,
+			      int rw)
+{
+	size_t offset = ldb->ldb_offset;
+	size_t left = ldb->ldb_bytes;
+	size_t i;
+
+	for (i = 0; i < ldb->ldb_count && left > 0; i++) {
+		size_t bytes = min_t(size_t, PAGE_SIZE - offset, left);
+		size_t copied;
+
+		if (rw == WRITE)
+			copied = copy_page_from_iter(ldb->ldb_pages[i], offset,
+						     bytes, iter);
+		else
+			copied = copy_page_to_iter(ldb->ldb_pages[i], offset,
+						   bytes, iter);
+		if (copied != bytes)
+			return -EFAULT;
+
+		left -= bytes;
+		offset = 0;
+	}
+
+	return 0;
+}
+
+/**
+ * Finish unaligned DIO reads queued on \a vio once their RPCs are done.
+ *
+ * The data is copied to the user buffers if \a ioret is zero, and the bounce
+ * pages are released in any case.  This must be called in the context of the
+ * thread that issued the IO, since it accesses user memory.
+ *
+ * \retval	\a ioret if it is an error, -EFAULT if the copy failed, or 0
+ */
+int ll_dio_bounce_fini(struct vvp_io *vio, int ioret)
+{
+	struct ll_dio_bounce *ldb;
+	struct ll_dio_bounce *tmp;
+	int rc = ioret;
+
+	list_for_each_entry_safe(ldb, tmp, &vio->vui_dio_bounce, ldb_linkage) {
+		list_del_init(&ldb->ldb_linkage);
+		if (rc == 0)
+			rc = ll_dio_bounce_copy(ldb, &ldb->ldb_iter, READ);
+		ll_dio_bounce_free(ldb);
+	}
+
+	return rc;
+}
+
+/**
+ * Submit one chunk of unaligned direct IO through bounce pages.
+ *
+ * Writes copy the user data into the bounce pages before submission, and the
+ * bounce pages are then only referenced by the transient cl_pages, which
+ * release them when the DIO completes.
+ *
+ * Reads are queued on the vvp_io and copied out by ll_dio_bounce_fini() once
+ * the RPCs complete, either at the end of ll_direct_IO_impl() or, for
+ * parallel DIO, once ll_file_io_generic() has waited for all the stripes.
+ * AIO has no such point in the context of the issuing thread, so unaligned
+ * AIO reads are waited for here, using a private sync aio.
+ */
+static ssize_t
+ll_direct_rw_bounce(const struct lu_env *env, struct cl_io *io, size_t count,
+		    int rw, struct inode *inode, struct cl_dio_aio *aio,
+		    struct iov_iter *iter, loff_t file_offset)
+{
+	struct vvp_io *vio = vvp_env_io(env);
+	struct ll_dio_pages pvec = { .ldp_aio = aio };
+	struct ll_dio_bounce *ldb;
+	struct cl_dio_aio *sync_aio = NULL;
+	struct kiocb sync_iocb;
+	ssize_t rc;
+
+	ENTRY;
+
+	ldb = ll_dio_bounce_alloc(file_offset, count);
+	if (ldb == NULL)
+		RETURN(-ENOMEM);
+
+	if (rw == WRITE) {
+		rc = ll_dio_bounce_copy(ldb, iter, WRITE);
+		if (rc < 0)
+			GOTO(out, rc);
+	} else {
+		ldb->ldb_iter = *iter;
+		if (!is_sync_kiocb(aio->cda_iocb)) {
+			init_sync_kiocb(&sync_iocb, aio->cda_iocb->ki_filp);
+			sync_aio = cl_aio_alloc(&sync_iocb, aio->cda_obj);
+			if (sync_aio == NULL)
+				GOTO(out, rc = -ENOMEM);
+			pvec.ldp_aio = sync_aio;
+		}
+	}
+
+	pvec.ldp_pages = ldb->ldb_pages;
+	pvec.ldp_count = ldb->ldb_count;
+	pvec.ldp_file_offset = file_offset;
+	rc = ll_direct_rw_pages(env, io, count, rw, inode, &pvec);
+
+	if (sync_aio) {
+		ssize_t rc2;
+
+		rc2 = cl_sync_io_wait_recycle(env, &sync_aio->cda_sync, 0, rc);
+		if (rc == 0)
+			rc = rc2;
+		cl_aio_free(env, sync_aio);
+		if (rc == 0)
+			rc = ll_dio_bounce_copy(ldb, &ldb->ldb_iter, READ);
+		if (rc == 0)
+			iov_iter_advance(iter, count);
+		GOTO(out, rc);
+	}
+
+	if (rc < 0 || rw == WRITE)
+		GOTO(out, rc);
+
+	iov_iter_advance(iter, count);
+	list_add_tail(&ldb->ldb_linkage, &vio->vui_dio_bounce);
+	RETURN(0);
+out:
+	ll_dio_bounce_free(ldb);
+	RETURN(rc);
+}
+
 #ifdef KMALLOC_MAX_SIZE
 #define MAX_MALLOC KMALLOC_MAX_SIZE
 #else
@@ -444,23 +640,28 @@ ll_direct_IO_impl(struct kiocb *iocb, struct iov_iter *iter, int rw)
 	ssize_t tot_bytes = 0, result = 0;
 	loff_t file_offset = iocb->ki_pos;
 	struct vvp_io *vio;
+	bool unaligned;
 
 	/* Check EOF by ourselves */
 	if (rw == READ && file_offset >= i_size_read(inode))
 		return 0;
 
-	/* FIXME: io smaller than PAGE_SIZE is broken on ia64 ??? */
-	if (file_offset & ~PAGE_MASK)
-		RETURN(-EINVAL);
-
 	CDEBUG(D_VFSTRACE, "VFS Op:inode="DFID"(%p), size=%zd (max %lu), "
 	       "offset=%lld=%llx, pages %zd (max %lu)\n",
 	       PFID(ll_inode2fid(inode)), inode, count, MAX_DIO_SIZE,
 	       file_offset, file_offset, count >> PAGE_SHIFT,
 	       MAX_DIO_SIZE >> PAGE_SHIFT);
 
-	/* Check that all user buffers are aligned as well */
-	if (ll_iov_iter_alignment(iter) & ~PAGE_MASK)
+	/* Unaligned file offset or user buffers are copied through bounce
+	 * pages. This is not possible for encrypted files, since partial
+	 * encryption units would be sent, nor for pipes, which cannot be
+	 * copied to after the fact.
+	 */
+	unaligned = (file_offset & ~PAGE_MASK) ||
+		    (ll_iov_iter_alignment(iter) & ~PAGE_MASK);
+	if (unaligned &&
+	    (!ll_sbi_has_unaligned_dio(ll_i2sbi(inode)) ||
+	     IS_ENCRYPTED(inode) || iov_iter_is_pipe(iter)))
 		RETURN(-EINVAL);
 
 	lcc = ll_cl_find(inode);
@@ -490,6 +691,20 @@ ll_direct_IO_impl(struct kiocb *iocb, struct iov_iter *iter, int rw)
 				count = i_size_read(inode) - file_offset;
 		}
 
+		if (unaligned) {
+			/* keep the page count within MAX_DIO_SIZE */
+			count = min_t(size_t, count, MAX_DIO_SIZE -
+				      (file_offset & ~PAGE_MASK));
+			result = ll_direct_rw_bounce(env, io, count, rw, inode,
+						     aio, iter, file_offset);
+			if (unlikely(result < 0))
+				GOTO(out, result);
+
+			tot_bytes += count;
+			file_offset += count;
+			continue;
+		}
+
 		result = ll_get_user_pages(rw, iter, &pages,
 					   &pvec.ldp_count, count);
 		if (unlikely(result <= 0))
@@ -536,6 +751,13 @@ out:
 		if (result == 0 && rc2)
 			result = rc2;
 
+		/* this also completes unaligned reads queued earlier in a
+		 * parallel DIO, since they were waited for above as well
+		 */
+		rc2 = ll_dio_bounce_fini(vio, result);
+		if (result == 0 && rc2)
+			result = rc2;
+
 		if (result == 0)
 			result = tot_bytes;
 	} else if (result == 0) {
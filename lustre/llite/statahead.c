@@ -30,6 +30,8 @@
  */
 
 #include <linux/fs.h>
+#include <linux/ctype.h>
+#include <linux/jhash.h>
 #include <linux/sched.h>
 #include <linux/kthread.h>
 #include <linux/mm.h>
@@ -62,6 +64,8 @@ typedef enum {
 struct sa_entry {
 	/* link into sai_interim_entries or sai_entries */
 	struct list_head	se_list;
+	/* statahead context the entry belongs to */
+	struct ll_statahead_info *se_sai;
 	/* link into sai hash table locally */
 	struct list_head	se_hash;
 	/* entry index in the sai */
@@ -200,6 +204,7 @@ sa_alloc(struct dentry *parent, struct ll_statahead_info *sai, __u64 index,
 	CDEBUG(D_READA, "alloc sa entry %.*s(%p) index %llu\n",
 	       len, name, entry, index);
 
+	entry->se_sai = sai;
 	entry->se_index = index;
 
 	entry->se_state = SA_ENTRY_INIT;
@@ -210,7 +215,9 @@ sa_alloc(struct dentry *parent, struct ll_statahead_info *sai, __u64 index,
 	entry->se_qstr.hash = ll_full_name_hash(parent, name, len);
 	entry->se_qstr.len = len;
 	entry->se_qstr.name = dname;
-	entry->se_fid = *fid;
+	/* the fid is not known for names not found by readdir */
+	if (fid)
+		entry->se_fid = *fid;
 
 	lli = ll_i2info(sai->sai_dentry->d_inode);
 
@@ -282,17 +289,19 @@ sa_kill(struct ll_statahead_info *sai, struct sa_entry *entry)
 static void
 sa_put(struct ll_statahead_info *sai, struct sa_entry *entry)
 {
+	struct ll_sb_info *sbi = ll_i2sbi(sai->sai_dentry->d_inode);
+	struct ll_sa_pattern_stats *stats = &sbi->ll_sa_stats[sai->sai_pattern];
 	struct sa_entry *tmp, *next;
 
 	if (entry && entry->se_state == SA_ENTRY_SUCC) {
-		struct ll_sb_info *sbi = ll_i2sbi(sai->sai_dentry->d_inode);
-
 		sai->sai_hit++;
 		sai->sai_consecutive_miss = 0;
 		sai->sai_max = min(2 * sai->sai_max, sbi->ll_sa_max);
+		atomic64_inc(&stats->lsps_hit);
 	} else {
 		sai->sai_miss++;
 		sai->sai_consecutive_miss++;
+		atomic64_inc(&stats->lsps_miss);
 	}
 
 	if (entry)
@@ -458,8 +467,9 @@ static void ll_agl_add(struct ll_statahead_info *sai,
 	}
 }
 
-/* allocate sai */
-static struct ll_statahead_info *ll_sai_alloc(struct dentry *dentry)
+/* allocate sai to stat ahead names of @dentry found by @pattern */
+static struct ll_statahead_info *ll_sai_alloc(struct dentry *dentry,
+					      enum ll_sa_pattern pattern)
 {
 	struct ll_statahead_info *sai;
 	struct ll_inode_info *lli = ll_i2info(dentry->d_inode);
@@ -472,7 +482,11 @@ static struct ll_statahead_info *ll_sai_alloc(struct dentry *dentry)
 		RETURN(NULL);
 
 	sai->sai_dentry = dget(dentry);
+	INIT_LIST_HEAD(&sai->sai_list);
 	atomic_set(&sai->sai_refcount, 1);
+	sai->sai_pattern = pattern;
+	sai->sai_pid = current->pid;
+	sai->sai_access = jiffies;
 	sai->sai_max = LL_SA_RPC_MIN;
 	sai->sai_index = 1;
 	init_waitqueue_head(&sai->sai_waitq);
@@ -500,13 +514,46 @@ static struct ll_statahead_info *ll_sai_alloc(struct dentry *dentry)
 static inline void ll_sai_free(struct ll_statahead_info *sai)
 {
 	LASSERT(sai->sai_dentry != NULL);
+	LASSERT(list_empty(&sai->sai_list));
 	dput(sai->sai_dentry);
+	if (sai->sai_names)
+		OBD_FREE_LARGE(sai->sai_names, sai->sai_names_size + 1);
 	OBD_FREE_PTR(sai);
 }
 
 /*
- * take refcount of sai if sai for @dir exists, which means statahead is on for
- * this directory.
+ * find the statahead context of process @pid in @dir, the most recent one
+ * comes first, called with lli_sa_lock held.
+ */
+static struct ll_statahead_info *__ll_sai_find(struct ll_inode_info *lli,
+					       pid_t pid)
+{
+	struct ll_statahead_info *sai;
+
+	list_for_each_entry(sai, &lli->lli_sa_list, sai_list) {
+		if (sai->sai_pid == pid)
+			return sai;
+	}
+
+	return NULL;
+}
+
+/* find the readdir statahead context of @dir, called with lli_sa_lock held */
+static struct ll_statahead_info *__ll_sai_find_ls(struct ll_inode_info *lli)
+{
+	struct ll_statahead_info *sai;
+
+	list_for_each_entry(sai, &lli->lli_sa_list, sai_list) {
+		if (sai->sai_pattern == LSA_PATTERN_LS)
+			return sai;
+	}
+
+	return NULL;
+}
+
+/*
+ * take refcount of sai if sai of current process for @dir exists, which means
+ * statahead is on for this directory and process.
  */
 static inline struct ll_statahead_info *ll_sai_get(struct inode *dir)
 {
@@ -514,7 +561,7 @@ static inline struct ll_statahead_info *ll_sai_get(struct inode *dir)
 	struct ll_statahead_info *sai = NULL;
 
 	spin_lock(&lli->lli_sa_lock);
-	sai = lli->lli_sai;
+	sai = __ll_sai_find(lli, current->pid);
 	if (sai)
 		atomic_inc(&sai->sai_refcount);
 	spin_unlock(&lli->lli_sa_lock);
@@ -534,7 +581,7 @@ static void ll_sai_put(struct ll_statahead_info *sai)
 		struct sa_entry *entry, *next;
 		struct ll_sb_info *sbi = ll_i2sbi(sai->sai_dentry->d_inode);
 
-		lli->lli_sai = NULL;
+		list_del_init(&sai->sai_list);
 		spin_unlock(&lli->lli_sa_lock);
 
 		LASSERT(!sai->sai_task);
@@ -663,7 +710,8 @@ static void sa_instantiate(struct ll_statahead_info *sai,
 
 	child = entry->se_inode;
 	/* revalidate; unlinked and re-created with the same name */
-	if (unlikely(!lu_fid_eq(&minfo->mi_data.op_fid2, &body->mbo_fid1))) {
+	if (unlikely(!fid_is_zero(&minfo->mi_data.op_fid2) &&
+		     !lu_fid_eq(&minfo->mi_data.op_fid2, &body->mbo_fid1))) {
 		if (child) {
 			entry->se_inode = NULL;
 			iput(child);
@@ -759,8 +807,8 @@ static int ll_statahead_interpret(struct ptlrpc_request *req,
 	struct lookup_intent *it = &minfo->mi_it;
 	struct inode *dir = minfo->mi_dir;
 	struct ll_inode_info *lli = ll_i2info(dir);
-	struct ll_statahead_info *sai = lli->lli_sai;
 	struct sa_entry *entry = (struct sa_entry *)minfo->mi_cbdata;
+	struct ll_statahead_info *sai;
 	__u64 handle = 0;
 
 	ENTRY;
@@ -772,8 +820,9 @@ static int ll_statahead_interpret(struct ptlrpc_request *req,
 	 * because statahead thread will wait for all inflight RPC to finish,
 	 * sai should be always valid, no need to refcount
 	 */
-	LASSERT(sai != NULL);
 	LASSERT(entry != NULL);
+	sai = entry->se_sai;
+	LASSERT(sai != NULL);
 
 	CDEBUG(D_READA, "sa_entry %.*s rc %d\n",
 	       entry->se_qstr.len, entry->se_qstr.name, rc);
@@ -816,6 +865,10 @@ static int ll_statahead_interpret(struct ptlrpc_request *req,
 		if (first && sai->sai_task)
 			wake_up_process(sai->sai_task);
 	}
+	if (rc == -ENOENT)
+		sai->sai_fname_enoent++;
+	else if (rc == 0)
+		sai->sai_fname_enoent = 0;
 	sai->sai_replied++;
 
 	spin_unlock(&lli->lli_sa_lock);
@@ -823,6 +876,18 @@ static int ll_statahead_interpret(struct ptlrpc_request *req,
 	RETURN(rc);
 }
 
+/* send async stat, packed into the batched RPC if batching is enabled */
+static int sa_getattr(struct ll_statahead_info *sai,
+		      struct md_enqueue_info *minfo)
+{
+	struct inode *dir = sai->sai_dentry->d_inode;
+
+	if (sai->sai_bh)
+		return md_batch_add(ll_i2mdexp(dir), sai->sai_bh, minfo);
+
+	return md_intent_getattr_async(ll_i2mdexp(dir), minfo);
+}
+
 /* async stat for file not found in dcache */
 static int sa_lookup(struct inode *dir, struct sa_entry *entry)
 {
@@ -835,7 +900,7 @@ static int sa_lookup(struct inode *dir, struct sa_entry *entry)
 	if (IS_ERR(minfo))
 		RETURN(PTR_ERR(minfo));
 
-	rc = md_intent_getattr_async(ll_i2mdexp(dir), minfo);
+	rc = sa_getattr(entry->se_sai, minfo);
 	if (rc < 0)
 		sa_fini_data(minfo);
 
@@ -880,7 +945,7 @@ static int sa_revalidate(struct inode *dir, struct sa_entry *entry,
 		RETURN(1);
 	}
 
-	rc = md_intent_getattr_async(ll_i2mdexp(dir), minfo);
+	rc = sa_getattr(entry->se_sai, minfo);
 	if (rc < 0) {
 		entry->se_inode = NULL;
 		iput(inode);
@@ -890,13 +955,12 @@ static int sa_revalidate(struct inode *dir, struct sa_entry *entry,
 	RETURN(rc);
 }
 
-/* async stat for file with @name */
-static void sa_statahead(struct dentry *parent, const char *name, int len,
-			 const struct lu_fid *fid)
+/* async stat for file with @name, @fid is NULL if not known */
+static void sa_statahead(struct ll_statahead_info *sai, const char *name,
+			 int len, const struct lu_fid *fid)
 {
+	struct dentry *parent = sai->sai_dentry;
 	struct inode *dir = parent->d_inode;
-	struct ll_inode_info *lli = ll_i2info(dir);
-	struct ll_statahead_info *sai = lli->lli_sai;
 	struct dentry *dentry = NULL;
 	struct sa_entry *entry;
 	int rc;
@@ -932,15 +996,12 @@ static void sa_statahead(struct dentry *parent, const char *name, int len,
 /* async glimpse (agl) thread main function */
 static int ll_agl_thread(void *arg)
 {
-	struct dentry *parent = (struct dentry *)arg;
+	/* We already own a reference of sai, taken by ll_start_agl() */
+	struct ll_statahead_info *sai = arg;
+	struct dentry *parent = sai->sai_dentry;
 	struct inode *dir = parent->d_inode;
 	struct ll_inode_info *plli = ll_i2info(dir);
 	struct ll_inode_info *clli;
-	/*
-	 * We already own this reference, so it is safe to take it
-	 * without a lock.
-	 */
-	struct ll_statahead_info *sai = plli->lli_sai;
 
 	ENTRY;
 
@@ -1003,10 +1064,10 @@ static void ll_stop_agl(struct ll_statahead_info *sai)
 }
 
 /* start agl thread */
-static void ll_start_agl(struct dentry *parent, struct ll_statahead_info *sai)
+static void ll_start_agl(struct ll_statahead_info *sai)
 {
 	int node = cfs_cpt_spread_node(cfs_cpt_tab, CFS_CPT_ANY);
-	struct ll_inode_info *plli;
+	struct dentry *parent = sai->sai_dentry;
 	struct task_struct *task;
 
 	ENTRY;
@@ -1014,9 +1075,8 @@ static void ll_start_agl(struct dentry *parent, struct ll_statahead_info *sai)
 	CDEBUG(D_READA, "start agl thread: sai %p, parent %pd\n",
 	       sai, parent);
 
-	plli = ll_i2info(parent->d_inode);
-	task = kthread_create_on_node(ll_agl_thread, parent, node, "ll_agl_%d",
-				      plli->lli_opendir_pid);
+	task = kthread_create_on_node(ll_agl_thread, sai, node, "ll_agl_%d",
+				      sai->sai_pid);
 	if (IS_ERR(task)) {
 		CERROR("can't start ll_agl thread, rc: %ld\n", PTR_ERR(task));
 		RETURN_EXIT;
@@ -1024,21 +1084,99 @@ static void ll_start_agl(struct dentry *parent, struct ll_statahead_info *sai)
 	sai->sai_agl_task = task;
 	atomic_inc(&ll_i2sbi(d_inode(parent))->ll_agl_total);
 	/* Get an extra reference that the thread holds */
-	ll_sai_get(d_inode(parent));
+	atomic_inc(&sai->sai_refcount);
 
 	wake_up_process(task);
 
 	EXIT;
 }
 
-/* statahead thread main function */
-static int ll_statahead_thread(void *arg)
+/*
+ * statahead thread of a pattern other than readdir quits when its process has
+ * not accessed the statahead cache for a while, since no dir close tells it
+ * to.
+ */
+static bool sa_stop_idle(struct ll_statahead_info *sai)
+{
+	struct ll_inode_info *lli = ll_i2info(sai->sai_dentry->d_inode);
+
+	if (sai->sai_pattern == LSA_PATTERN_LS ||
+	    !time_after(jiffies, READ_ONCE(sai->sai_access) +
+				 LL_SA_IDLE_TIMEOUT))
+		return false;
+
+	CDEBUG(D_READA, "statahead thread idle: sai %p, parent %pd\n",
+	       sai, sai->sai_dentry);
+
+	spin_lock(&lli->lli_sa_lock);
+	sai->sai_task = NULL;
+	spin_unlock(&lli->lli_sa_lock);
+
+	return true;
+}
+
+static void sa_schedule(struct ll_statahead_info *sai)
+{
+	if (sai->sai_pattern == LSA_PATTERN_LS)
+		schedule();
+	else
+		schedule_timeout(LL_SA_IDLE_TIMEOUT);
+}
+
+/*
+ * wait until there is room in the statahead window, handle async stat replies
+ * and AGLs meanwhile.
+ *
+ * \retval	false if the statahead thread is told to quit
+ */
+static bool sa_wait_window(struct ll_statahead_info *sai)
 {
-	struct dentry *parent = (struct dentry *)arg;
+	struct inode *dir = sai->sai_dentry->d_inode;
+	struct ll_inode_info *lli = ll_i2info(dir);
+
+	/* no reply can come for the getattrs not sent yet */
+	if (sai->sai_bh && sa_sent_full(sai))
+		md_batch_flush(ll_i2mdexp(dir), sai->sai_bh);
+
+	while (({set_current_state(TASK_IDLE);
+		 sai->sai_task; })) {
+		if (sa_has_callback(sai)) {
+			__set_current_state(TASK_RUNNING);
+			sa_handle_callback(sai);
+		}
+
+		spin_lock(&lli->lli_agl_lock);
+		while (sa_sent_full(sai) &&
+		       !agl_list_empty(sai)) {
+			struct ll_inode_info *clli;
+
+			__set_current_state(TASK_RUNNING);
+			clli = agl_first_entry(sai);
+			list_del_init(&clli->lli_agl_list);
+			spin_unlock(&lli->lli_agl_lock);
+
+			ll_agl_trigger(&clli->lli_vfs_inode, sai);
+			cond_resched();
+			spin_lock(&lli->lli_agl_lock);
+		}
+		spin_unlock(&lli->lli_agl_lock);
+
+		if (!sa_sent_full(sai) || sa_stop_idle(sai))
+			break;
+		sa_schedule(sai);
+	}
+	__set_current_state(TASK_RUNNING);
+
+	return sai->sai_task != NULL;
+}
+
+/* stat ahead the entries of the directory opened, in readdir order */
+static int sa_readdir_ahead(struct ll_statahead_info *sai)
+{
+	struct dentry *parent = sai->sai_dentry;
 	struct inode *dir = parent->d_inode;
 	struct ll_inode_info *lli = ll_i2info(dir);
 	struct ll_sb_info *sbi = ll_i2sbi(dir);
-	struct ll_statahead_info *sai = lli->lli_sai;
 	int first = 0;
 	struct md_op_data *op_data;
 	struct page *page = NULL;
@@ -1047,12 +1185,9 @@ static int ll_statahead_thread(void *arg)
 
 	ENTRY;
 
-	CDEBUG(D_READA, "statahead thread starting: sai %p, parent %pd\n",
-	       sai, parent);
-
 	OBD_ALLOC_PTR(op_data);
 	if (!op_data)
-		GOTO(out, rc = -ENOMEM);
+		RETURN(-ENOMEM);
 
 	while (pos != MDS_DIR_END_OFF && sai->sai_task) {
 		struct lu_dirpage *dp;
@@ -1132,35 +1267,8 @@ static int ll_statahead_thread(void *arg)
 
 			fid_le_to_cpu(&fid, &ent->lde_fid);
 
-			while (({set_current_state(TASK_IDLE);
-				 sai->sai_task; })) {
-				if (sa_has_callback(sai)) {
-					__set_current_state(TASK_RUNNING);
-					sa_handle_callback(sai);
-				}
-
-				spin_lock(&lli->lli_agl_lock);
-				while (sa_sent_full(sai) &&
-				       !agl_list_empty(sai)) {
-					struct ll_inode_info *clli;
-
-					__set_current_state(TASK_RUNNING);
-					clli = agl_first_entry(sai);
-					list_del_init(&clli->lli_agl_list);
-					spin_unlock(&lli->lli_agl_lock);
-
-					ll_agl_trigger(&clli->lli_vfs_inode,
-						       sai);
-					cond_resched();
-					spin_lock(&lli->lli_agl_lock);
-				}
-				spin_unlock(&lli->lli_agl_lock);
-
-				if (!sa_sent_full(sai))
-					break;
-				schedule();
-			}
-			__set_current_state(TASK_RUNNING);
+			if (!sa_wait_window(sai))
+				break;
 
 			if (IS_ENCRYPTED(dir)) {
 				struct llcrypt_str de_name =
@@ -1183,7 +1291,7 @@ static int ll_statahead_thread(void *arg)
 				namelen = lltr.len;
 			}
 
-			sa_statahead(parent, name, namelen, &fid);
+			sa_statahead(sai, name, namelen, &fid);
 			llcrypt_fname_free_buffer(&lltr);
 		}
 
@@ -1191,6 +1299,10 @@ static int ll_statahead_thread(void *arg)
 		ll_release_page(dir, page,
 				le32_to_cpu(dp->ldp_flags) & LDF_COLLIDE);
 
+		/* don't hold the getattrs back while reading the next page */
+		if (sai->sai_bh)
+			md_batch_flush(ll_i2mdexp(dir), sai->sai_bh);
+
 		if (sa_low_hit(sai)) {
 			rc = -EFAULT;
 			atomic_inc(&sbi->ll_sa_wrong);
@@ -1204,30 +1316,129 @@ static int ll_statahead_thread(void *arg)
 	}
 	ll_finish_md_op_data(op_data);
 
+	RETURN(rc);
+}
+
+/*
+ * stat ahead the names made of sai_fname followed by increasing indexes,
+ * until names are not found or not accessed by the process.
+ */
+static int sa_fname_ahead(struct ll_statahead_info *sai)
+{
+	char name[NAME_MAX + 1];
+	int len;
+
+	while (sai->sai_task && !sa_low_hit(sai) &&
+	       sai->sai_fname_enoent <= SA_OMITTED_ENTRY_MAX) {
+		if (!sa_wait_window(sai))
+			break;
+
+		len = snprintf(name, sizeof(name), "%s%0*llu", sai->sai_fname,
+			       sai->sai_fname_width, sai->sai_fname_index);
+		if (len >= sizeof(name))
+			break;
+
+		sa_statahead(sai, name, len, NULL);
+		sai->sai_fname_index++;
+	}
+
+	return sa_low_hit(sai) ? -EFAULT : 0;
+}
+
+/* stat ahead the names given by the user with LL_IOC_STATAHEAD_NAMES */
+static int sa_names_ahead(struct ll_statahead_info *sai)
+{
+	while (sai->sai_task && !sa_low_hit(sai) && sai->sai_names_count &&
+	       sai->sai_names_pos < sai->sai_names_size) {
+		char *name = sai->sai_names + sai->sai_names_pos;
+		int len = strlen(name);
+
+		sai->sai_names_pos += len + 1;
+		if (len == 0 || len > NAME_MAX || memchr(name, '/', len) ||
+		    (name[0] == '.' &&
+		     (len == 1 || (len == 2 && name[1] == '.'))))
+			continue;
+
+		if (!sa_wait_window(sai))
+			break;
+
+		sa_statahead(sai, name, len, NULL);
+		sai->sai_names_count--;
+	}
+
+	return sa_low_hit(sai) ? -EFAULT : 0;
+}
+
+/* statahead thread main function */
+static int ll_statahead_thread(void *arg)
+{
+	struct ll_statahead_info *sai = arg;
+	struct dentry *parent = sai->sai_dentry;
+	struct inode *dir = parent->d_inode;
+	struct ll_inode_info *lli = ll_i2info(dir);
+	struct ll_sb_info *sbi = ll_i2sbi(dir);
+	int rc = 0;
+
+	ENTRY;
+
+	CDEBUG(D_READA, "statahead thread starting: sai %p, parent %pd, pattern %d\n",
+	       sai, parent, sai->sai_pattern);
+
+	if (sbi->ll_sa_batch_max > 0) {
+		sai->sai_bh = md_batch_create(ll_i2mdexp(dir),
+					      sbi->ll_sa_batch_max);
+		if (IS_ERR(sai->sai_bh))
+			sai->sai_bh = NULL;
+	}
+
+	switch (sai->sai_pattern) {
+	case LSA_PATTERN_LS:
+		rc = sa_readdir_ahead(sai);
+		break;
+	case LSA_PATTERN_FNAME:
+		rc = sa_fname_ahead(sai);
+		break;
+	case LSA_PATTERN_ADVISE:
+		rc = sa_names_ahead(sai);
+		break;
+	default:
+		LBUG();
+	}
+
+	if (sai->sai_bh)
+		md_batch_flush(ll_i2mdexp(dir), sai->sai_bh);
+
 	if (rc < 0) {
+		if (rc == -EFAULT && sai->sai_pattern != LSA_PATTERN_LS)
+			atomic_inc(&sbi->ll_sa_wrong);
+
 		spin_lock(&lli->lli_sa_lock);
 		sai->sai_task = NULL;
-		lli->lli_sa_enabled = 0;
+		if (sai->sai_pattern == LSA_PATTERN_LS)
+			lli->lli_sa_enabled = 0;
 		spin_unlock(&lli->lli_sa_lock);
 	}
 
 	/*
 	 * statahead is finished, but statahead entries need to be cached, wait
-	 * for file release to stop me.
+	 * for file release or idle timeout to stop me.
 	 */
 	while (({set_current_state(TASK_IDLE);
 		 sai->sai_task; })) {
 		if (sa_has_callback(sai)) {
 			__set_current_state(TASK_RUNNING);
 			sa_handle_callback(sai);
-		} else {
-			schedule();
+		} else if (!sa_stop_idle(sai)) {
+			sa_schedule(sai);
 		}
 	}
 	__set_current_state(TASK_RUNNING);
 
-	EXIT;
-out:
+	if (sai->sai_bh) {
+		md_batch_stop(ll_i2mdexp(dir), sai->sai_bh);
+		sai->sai_bh = NULL;
+	}
+
 	ll_stop_agl(sai);
 
 	/*
@@ -1251,7 +1462,7 @@ out:
 
 	ll_sai_put(sai);
 
-	return rc;
+	RETURN(rc);
 }
 
 /* authorize opened dir handle @key to statahead */
@@ -1260,10 +1471,11 @@ void ll_authorize_statahead(struct inode *dir, void *key)
 	struct ll_inode_info *lli = ll_i2info(dir);
 
 	spin_lock(&lli->lli_sa_lock);
-	if (!lli->lli_opendir_key && !lli->lli_sai) {
+	if (!lli->lli_opendir_key && !__ll_sai_find_ls(lli)) {
 		/*
-		 * if lli_sai is not NULL, it means previous statahead is not
-		 * finished yet, we'd better not start a new statahead for now.
+		 * if a readdir statahead context exists, it means previous
+		 * statahead is not finished yet, we'd better not start a new
+		 * statahead for now.
 		 */
 		LASSERT(lli->lli_opendir_pid == 0);
 		lli->lli_opendir_key = key;
@@ -1292,7 +1504,7 @@ void ll_deauthorize_statahead(struct inode *dir, void *key)
 	lli->lli_opendir_key = NULL;
 	lli->lli_opendir_pid = 0;
 	lli->lli_sa_enabled = 0;
-	sai = lli->lli_sai;
+	sai = __ll_sai_find_ls(lli);
 	if (sai && sai->sai_task) {
 		/*
 		 * statahead thread may not have quit yet because it needs to
@@ -1489,7 +1701,10 @@ static int revalidate_statahead_dentry(struct inode *dir,
 
 	ENTRY;
 
-	if ((*dentryp)->d_name.name[0] == '.') {
+	WRITE_ONCE(sai->sai_access, jiffies);
+
+	if (sai->sai_pattern == LSA_PATTERN_LS &&
+	    (*dentryp)->d_name.name[0] == '.') {
 		if (sai->sai_ls_all ||
 		    sai->sai_miss_hidden >= sai->sai_skip_hidden) {
 			/*
@@ -1612,38 +1827,24 @@ out:
 }
 
 /**
- * start statahead thread
+ * publish @sai in @dir and start its statahead thread, @sai is freed upon
+ * failure.
  *
- * \param[in] dir	parent directory
- * \param[in] dentry	dentry that triggers statahead, normally the first
- *			dirent under @dir
- * \param[in] agl	indicate whether AGL is needed
- * \retval		-EAGAIN on success, because when this function is
- *			called, it's already in lookup call, so client should
- *			do it itself instead of waiting for statahead thread
- *			to do it asynchronously.
- * \retval		negative number upon error
+ * A statahead context other than readdir replaces the previous one of the
+ * same process, which is told to quit.
  */
-static int start_statahead_thread(struct inode *dir, struct dentry *dentry,
-				  bool agl)
+static int sa_start_thread(struct inode *dir, struct ll_statahead_info *sai,
+			   bool agl)
 {
 	int node = cfs_cpt_spread_node(cfs_cpt_tab, CFS_CPT_ANY);
 	struct ll_inode_info *lli = ll_i2info(dir);
-	struct ll_statahead_info *sai = NULL;
-	struct dentry *parent = dentry->d_parent;
+	struct ll_sb_info *sbi = ll_i2sbi(dir);
+	struct ll_statahead_info *tmp;
 	struct task_struct *task;
-	struct ll_sb_info *sbi = ll_i2sbi(parent->d_inode);
-	int first = LS_FIRST_DE;
 	int rc = 0;
 
 	ENTRY;
 
-	/* I am the "lli_opendir_pid" owner, only me can set "lli_sai". */
-	first = is_first_dirent(dir, dentry);
-	if (first == LS_NOT_FIRST_DE)
-		/* It is not "ls -{a}l" operation, no need statahead for it. */
-		GOTO(out, rc = -EFAULT);
-
 	if (unlikely(atomic_inc_return(&sbi->ll_sa_running) >
 				       sbi->ll_sa_running_max)) {
 		CDEBUG(D_READA,
@@ -1651,54 +1852,111 @@ static int start_statahead_thread(struct inode *dir, struct dentry *dentry,
 		GOTO(out, rc = -EMFILE);
 	}
 
-	sai = ll_sai_alloc(parent);
-	if (!sai)
-		GOTO(out, rc = -ENOMEM);
-
-	sai->sai_ls_all = (first == LS_FIRST_DOT_DE);
-
-	/*
-	 * if current lli_opendir_key was deauthorized, or dir re-opened by
-	 * another process, don't start statahead, otherwise the newly spawned
-	 * statahead thread won't be notified to quit.
-	 */
 	spin_lock(&lli->lli_sa_lock);
-	if (unlikely(lli->lli_sai || !lli->lli_opendir_key ||
-		     lli->lli_opendir_pid != current->pid)) {
-		spin_unlock(&lli->lli_sa_lock);
-		GOTO(out, rc = -EPERM);
+	if (sai->sai_pattern == LSA_PATTERN_LS) {
+		/*
+		 * if current lli_opendir_key was deauthorized, or dir re-opened
+		 * by another process, don't start statahead, otherwise the
+		 * newly spawned statahead thread won't be notified to quit.
+		 */
+		if (unlikely(__ll_sai_find_ls(lli) || !lli->lli_opendir_key ||
+			     lli->lli_opendir_pid != current->pid))
+			rc = -EPERM;
+	} else {
+		list_for_each_entry(tmp, &lli->lli_sa_list, sai_list) {
+			if (tmp->sai_pid != sai->sai_pid || !tmp->sai_task)
+				continue;
+
+			if (tmp->sai_pattern == LSA_PATTERN_LS) {
+				rc = -EBUSY;
+				break;
+			}
+			task = tmp->sai_task;
+			tmp->sai_task = NULL;
+			wake_up_process(task);
+		}
 	}
-	lli->lli_sai = sai;
+	if (rc == 0)
+		list_add(&sai->sai_list, &lli->lli_sa_list);
 	spin_unlock(&lli->lli_sa_lock);
+	if (rc)
+		GOTO(out, rc);
 
 	CDEBUG(D_READA, "start statahead thread: [pid %d] [parent %pd]\n",
-	       current->pid, parent);
+	       current->pid, sai->sai_dentry);
 
-	task = kthread_create_on_node(ll_statahead_thread, parent, node,
-				      "ll_sa_%u", lli->lli_opendir_pid);
+	task = kthread_create_on_node(ll_statahead_thread, sai, node,
+				      "ll_sa_%u", sai->sai_pid);
 	if (IS_ERR(task)) {
 		spin_lock(&lli->lli_sa_lock);
-		lli->lli_sai = NULL;
+		list_del_init(&sai->sai_list);
 		spin_unlock(&lli->lli_sa_lock);
 		rc = PTR_ERR(task);
 		CERROR("can't start ll_sa thread, rc: %d\n", rc);
 		GOTO(out, rc);
 	}
 
-	if (test_bit(LL_SBI_AGL_ENABLED, ll_i2sbi(parent->d_inode)->ll_flags) &&
-	    agl)
-		ll_start_agl(parent, sai);
+	if (test_bit(LL_SBI_AGL_ENABLED, sbi->ll_flags) && agl)
+		ll_start_agl(sai);
 
-	atomic_inc(&ll_i2sbi(parent->d_inode)->ll_sa_total);
+	atomic_inc(&sbi->ll_sa_total);
+	atomic_inc(&sbi->ll_sa_stats[sai->sai_pattern].lsps_total);
 	sai->sai_task = task;
 
 	wake_up_process(task);
-	/*
-	 * We don't stat-ahead for the first dirent since we are already in
-	 * lookup.
+
+	RETURN(0);
+out:
+	atomic_dec(&sbi->ll_sa_running);
+	ll_sai_free(sai);
+
+	RETURN(rc);
+}
+
+/**
+ * start statahead thread
+ *
+ * \param[in] dir	parent directory
+ * \param[in] dentry	dentry that triggers statahead, normally the first
+ *			dirent under @dir
+ * \param[in] agl	indicate whether AGL is needed
+ * \retval		-EAGAIN on success, because when this function is
+ *			called, it's already in lookup call, so client should
+ *			do it itself instead of waiting for statahead thread
+ *			to do it asynchronously.
+ * \retval		negative number upon error
+ */
+static int start_statahead_thread(struct inode *dir, struct dentry *dentry,
+				  bool agl)
+{
+	struct ll_inode_info *lli = ll_i2info(dir);
+	struct ll_statahead_info *sai;
+	int first;
+	int rc;
+
+	ENTRY;
+
+	/* I am the "lli_opendir_pid" owner, only me can start readdir
+	 * statahead.
 	 */
-	RETURN(-EAGAIN);
+	first = is_first_dirent(dir, dentry);
+	if (first == LS_NOT_FIRST_DE)
+		/* It is not "ls -{a}l" operation, no need statahead for it. */
+		GOTO(out, rc = -EFAULT);
 
+	sai = ll_sai_alloc(dentry->d_parent, LSA_PATTERN_LS);
+	if (!sai)
+		GOTO(out, rc = -ENOMEM);
+
+	sai->sai_ls_all = (first == LS_FIRST_DOT_DE);
+
+	rc = sa_start_thread(dir, sai, agl);
+	if (rc == 0)
+		/*
+		 * We don't stat-ahead for the first dirent since we are
+		 * already in lookup.
+		 */
+		RETURN(-EAGAIN);
 out:
 	/*
 	 * once we start statahead thread failed, disable statahead so that
@@ -1709,16 +1967,100 @@ out:
 		lli->lli_sa_enabled = 0;
 	spin_unlock(&lli->lli_sa_lock);
 
-	if (sai)
-		ll_sai_free(sai);
-	if (first != LS_NOT_FIRST_DE)
-		atomic_dec(&sbi->ll_sa_running);
-
 	RETURN(rc);
 }
 
+/**
+ * detect stats of names with an increasing number suffix in @dir, such as
+ * "out.00001", "out.00002"... and start statahead of the following names once
+ * the same process has stat'ed LL_SA_FNAME_MIN of them in a row. The stats
+ * of up to LL_SA_FNAME_NR processes are followed at once, so that workers
+ * interleaving their stats in the same directory do not reset each other.
+ *
+ * \retval		0 if no statahead is started, or on success
+ * \retval		negative number upon error
+ */
+static int start_statahead_fname(struct inode *dir, struct dentry *dentry,
+				 bool agl)
+{
+	struct ll_inode_info *lli = ll_i2info(dir);
+	const struct qstr *name = &dentry->d_name;
+	struct ll_sa_fname_detect *lsfd = NULL;
+	struct ll_statahead_info *sai;
+	unsigned int digits = 0;
+	unsigned int width;
+	unsigned int prefix;
+	bool start = false;
+	__u64 index = 0;
+	u32 hash;
+	int i;
+
+	if (!test_bit(LL_SBI_STATAHEAD_FNAME, ll_i2sbi(dir)->ll_flags) ||
+	    IS_ENCRYPTED(dir))
+		return 0;
+
+	/* the index must fit in __u64 */
+	while (digits < name->len && digits < 19 &&
+	       isdigit(name->name[name->len - digits - 1]))
+		digits++;
+	if (digits == 0)
+		return 0;
+
+	prefix = name->len - digits;
+	for (i = prefix; i < name->len; i++)
+		index = index * 10 + name->name[i] - '0';
+	/* "out.00001" is printed zero-padded, "out.1" is not */
+	width = name->name[prefix] == '0' ? digits : 0;
+	hash = jhash(name->name, prefix, width);
+
+	spin_lock(&lli->lli_sa_lock);
+	for (i = 0; i < LL_SA_FNAME_NR; i++) {
+		if (lli->lli_sa_fname[i].lsfd_pid == current->pid) {
+			lsfd = &lli->lli_sa_fname[i];
+			break;
+		}
+	}
+
+	if (lsfd && lsfd->lsfd_hash == hash &&
+	    lsfd->lsfd_index + 1 == index) {
+		if (++lsfd->lsfd_count >= LL_SA_FNAME_MIN) {
+			lsfd->lsfd_count = 0;
+			start = true;
+		}
+	} else {
+		if (!lsfd) {
+			lsfd = &lli->lli_sa_fname[lli->lli_sa_fname_next];
+			lli->lli_sa_fname_next = (lli->lli_sa_fname_next + 1) %
+						 LL_SA_FNAME_NR;
+			lsfd->lsfd_pid = current->pid;
+		}
+		lsfd->lsfd_hash = hash;
+		lsfd->lsfd_count = 1;
+	}
+	lsfd->lsfd_index = index;
+	spin_unlock(&lli->lli_sa_lock);
+
+	if (!start)
+		return 0;
+
+	CDEBUG(D_READA, "%s: statahead %.*s%0*llu... in "DFID"\n",
+	       ll_i2sbi(dir)->ll_fsname, prefix, name->name, width, index + 1,
+	       PFID(ll_inode2fid(dir)));
+
+	sai = ll_sai_alloc(dentry->d_parent, LSA_PATTERN_FNAME);
+	if (!sai)
+		return -ENOMEM;
+
+	memcpy(sai->sai_fname, name->name, prefix);
+	sai->sai_fname[prefix] = '\0';
+	sai->sai_fname_width = width;
+	sai->sai_fname_index = index + 1;
+
+	return sa_start_thread(dir, sai, agl);
+}
+
 /*
- * Check whether statahead for @dir was started.
+ * Check whether statahead for @dir was started for the current process.
  */
 static inline bool ll_statahead_started(struct inode *dir, bool agl)
 {
@@ -1726,7 +2068,7 @@ static inline bool ll_statahead_started(struct inode *dir, bool agl)
 	struct ll_statahead_info *sai;
 
 	spin_lock(&lli->lli_sa_lock);
-	sai = lli->lli_sai;
+	sai = __ll_sai_find(lli, current->pid);
 	if (sai && (sai->sai_agl_task != NULL) != agl)
 		CDEBUG(D_READA,
 		       "%s: Statahead AGL hint changed from %d to %d\n",
@@ -1739,8 +2081,8 @@ static inline bool ll_statahead_started(struct inode *dir, bool agl)
 
 /**
  * statahead entry function, this is called when client getattr on a file, it
- * will start statahead thread if this is the first dir entry, else revalidate
- * dentry from statahead cache.
+ * will start statahead thread if this is the first dir entry of the dir opened
+ * by the current process, or if the names stat'ed follow a pattern.
  *
  * \param[in]  dir	parent directory
  * \param[out] dentryp	dentry to getattr
@@ -1754,9 +2096,73 @@ static inline bool ll_statahead_started(struct inode *dir, bool agl)
  */
 int ll_start_statahead(struct inode *dir, struct dentry *dentry, bool agl)
 {
-	if (!ll_statahead_started(dir, agl))
+	struct ll_inode_info *lli = ll_i2info(dir);
+
+	if (ll_statahead_started(dir, agl))
+		return 0;
+
+	if (lli->lli_sa_enabled && lli->lli_opendir_pid == current->pid)
 		return start_statahead_thread(dir, dentry, agl);
-	return 0;
+
+	return start_statahead_fname(dir, dentry, agl);
+}
+
+/**
+ * start statahead of the names given by the user for the directory opened
+ * as @file, on behalf of the current process.
+ */
+int ll_statahead_names(struct file *file, struct ll_statahead_names __user *arg)
+{
+	struct inode *dir = file_inode(file);
+	struct ll_sb_info *sbi = ll_i2sbi(dir);
+	struct ll_statahead_names lsn;
+	struct ll_statahead_info *sai;
+	int rc;
+
+	ENTRY;
+
+	if (copy_from_user(&lsn, arg, sizeof(lsn)))
+		RETURN(-EFAULT);
+
+	if (lsn.lsn_count == 0 || lsn.lsn_size == 0)
+		RETURN(-EINVAL);
+
+	if (lsn.lsn_size > LL_SA_NAMES_SIZE_MAX)
+		RETURN(-E2BIG);
+
+	if (sbi->ll_sa_max == 0 || IS_ENCRYPTED(dir))
+		RETURN(-EOPNOTSUPP);
+
+	/* the names are looked up by the statahead thread, as the caller */
+	rc = inode_permission(dir, MAY_EXEC);
+	if (rc)
+		RETURN(rc);
+
+	sai = ll_sai_alloc(file_dentry(file), LSA_PATTERN_ADVISE);
+	if (!sai)
+		RETURN(-ENOMEM);
+
+	/* terminate the last name */
+	OBD_ALLOC_LARGE(sai->sai_names, lsn.lsn_size + 1);
+	if (!sai->sai_names) {
+		ll_sai_free(sai);
+		RETURN(-ENOMEM);
+	}
+	sai->sai_names_size = lsn.lsn_size;
+	sai->sai_names_count = lsn.lsn_count;
+
+	if (copy_from_user(sai->sai_names, arg->lsn_names, lsn.lsn_size)) {
+		ll_sai_free(sai);
+		RETURN(-EFAULT);
+	}
+
+	CDEBUG(D_READA, "%s: statahead %u names in "DFID"\n",
+	       sbi->ll_fsname, lsn.lsn_count, PFID(ll_inode2fid(dir)));
+
+	rc = sa_start_thread(dir, sai, test_bit(LL_SBI_AGL_ENABLED,
+						sbi->ll_flags));
+
+	RETURN(rc);
 }
 
 /**
@@ -106,6 +106,8 @@ struct vvp_io {
 	pgoff_t			vui_ra_pages;
 	/* Set when vui_ra_{start,count} have been initialized. */
 	bool			vui_ra_valid;
+	/* Unaligned DIO reads waiting to be copied to the user buffer */
+	struct list_head	vui_dio_bounce;
 };
 
 extern struct lu_device_type vvp_device_type;
@@ -311,6 +311,9 @@ static void vvp_io_fini(const struct lu_env *env, const struct cl_io_slice *ios)
 	       vio->vui_layout_gen, io->ci_need_write_intent,
 	       io->ci_restore_needed);
 
+	/* any bounce pages left here belong to a failed unaligned DIO */
+	ll_dio_bounce_fini(vio, -EIO);
+
 	if (io->ci_restore_needed) {
 		/* file was detected release, we need to restore it
 		 * before finishing the io
@@ -572,7 +575,7 @@ static int vvp_io_rw_lock(const struct lu_env *env, struct cl_io *io,
 			io->ci_dio_lock = 1;
 
 		if (ll_file_nolock(vio->vui_fd->fd_file) ||
-		    (vio->vui_fd->fd_file->f_flags & O_DIRECT &&
+		    (vio->vui_iocb && ll_iocb_is_dio(vio->vui_iocb) &&
 		     !io->ci_dio_lock))
 			ast_flags |= CEF_NEVER;
 	}
@@ -834,7 +837,7 @@ static int vvp_io_read_start(const struct lu_env *env,
 	if (!can_populate_pages(env, io, inode))
 		RETURN(0);
 
-	if (!(file->f_flags & O_DIRECT)) {
+	if (!ll_iocb_is_dio(vio->vui_iocb)) {
 		result = cl_io_lru_reserve(env, io, pos, cnt);
 		if (result)
 			RETURN(result);
@@ -1264,7 +1267,7 @@ static int vvp_io_write_start(const struct lu_env *env,
 	if (OBD_FAIL_CHECK(OBD_FAIL_LLITE_IMUTEX_NOSEC) && lock_inode)
 		RETURN(-EINVAL);
 
-	if (!(file->f_flags & O_DIRECT)) {
+	if (!(vio->vui_iocb && ll_iocb_is_dio(vio->vui_iocb))) {
 		result = cl_io_lru_reserve(env, io, pos, cnt);
 		if (result)
 			RETURN(result);
@@ -1750,6 +1753,7 @@ int vvp_io_init(const struct lu_env *env, struct cl_object *obj,
 	CL_IO_SLICE_CLEAN(vio, vui_cl);
 	cl_io_slice_add(io, &vio->vui_cl, obj, &vvp_io_ops);
 	vio->vui_ra_valid = false;
+	INIT_LIST_HEAD(&vio->vui_dio_bounce);
 	result = 0;
 	if (io->ci_type == CIT_READ || io->ci_type == CIT_WRITE) {
 		size_t count;
@@ -2894,14 +2894,9 @@ static int lmv_striped_read_page(struct obd_export *exp,
 		}
 		ctxt->ldc_hash = le64_to_cpu(next->lde_hash);
 
-		ent_size = le16_to_cpu(next->lde_reclen);
-
 		/* the last entry lde_reclen is 0, but it might not be the last
 		 * one of this temporay dir page */
-		if (!ent_size)
-			ent_size = lu_dirent_calc_size(
-					le16_to_cpu(next->lde_namelen),
-					le32_to_cpu(next->lde_attrs));
+		ent_size = lu_dirent_size(next);
 		/* page full */
 		if (ent_size > left_bytes)
 			break;
@@ -3647,37 +3642,180 @@ static int lmv_clear_open_replay_data(struct obd_export *exp,
 	RETURN(md_clear_open_replay_data(tgt->ltd_exp, och));
 }
 
-static int lmv_intent_getattr_async(struct obd_export *exp,
-				    struct md_enqueue_info *minfo)
+static struct lmv_tgt_desc *
+lmv_intent_getattr_tgt(struct lmv_obd *lmv, struct md_op_data *op_data)
 {
-	struct md_op_data *op_data = &minfo->mi_data;
-	struct obd_device *obd = exp->exp_obd;
-	struct lmv_obd *lmv = &obd->u.lmv;
 	struct lmv_tgt_desc *ptgt;
 	struct lmv_tgt_desc *ctgt;
-	int rc;
 
-	ENTRY;
-
-	if (!fid_is_sane(&op_data->op_fid2))
-		RETURN(-EINVAL);
+	if (!fid_is_zero(&op_data->op_fid2) && !fid_is_sane(&op_data->op_fid2))
+		return ERR_PTR(-EINVAL);
 
 	ptgt = lmv_locate_tgt(lmv, op_data);
 	if (IS_ERR(ptgt))
-		RETURN(PTR_ERR(ptgt));
+		return ptgt;
+
+	/* statahead by name, the child fid is not known before lookup */
+	if (fid_is_zero(&op_data->op_fid2))
+		return ptgt;
 
 	ctgt = lmv_fid2tgt(lmv, &op_data->op_fid2);
 	if (IS_ERR(ctgt))
-		RETURN(PTR_ERR(ctgt));
+		return ctgt;
 
 	/*
 	 * remote object needs two RPCs to lookup and getattr, considering the
 	 * complexity don't support statahead for now.
 	 */
 	if (ctgt != ptgt)
-		RETURN(-EREMOTE);
+		return ERR_PTR(-EREMOTE);
+
+	return ptgt;
+}
+
+static int lmv_intent_getattr_async(struct obd_export *exp,
+				    struct md_enqueue_info *minfo)
+{
+	struct obd_device *obd = exp->exp_obd;
+	struct lmv_obd *lmv = &obd->u.lmv;
+	struct lmv_tgt_desc *tgt;
+	int rc;
+
+	ENTRY;
+
+	tgt = lmv_intent_getattr_tgt(lmv, &minfo->mi_data);
+	if (IS_ERR(tgt))
+		RETURN(PTR_ERR(tgt));
+
+	rc = md_intent_getattr_async(tgt->ltd_exp, minfo);
+
+	RETURN(rc);
+}
+
+/**
+ * Per-MDT part of an LMV batch. Entries of one batch may live on different
+ * MDTs, so a sub-batch is created lazily on each target that is used.
+ */
+struct lmv_sub_batch {
+	struct lu_batch		*sbh_sub;
+	struct lmv_tgt_desc	*sbh_tgt;
+	struct list_head	 sbh_sub_item;
+};
+
+struct lmv_batch {
+	struct lu_batch		 lbh_super;
+	struct list_head	 lbh_sub_batch_list;
+};
+
+static struct lu_batch *lmv_batch_create(struct obd_export *exp,
+					 __u32 max_count)
+{
+	struct lmv_batch *lbh;
+
+	ENTRY;
+
+	OBD_ALLOC_PTR(lbh);
+	if (!lbh)
+		RETURN(ERR_PTR(-ENOMEM));
+
+	lbh->lbh_super.lbt_max_count = max_count;
+	INIT_LIST_HEAD(&lbh->lbh_sub_batch_list);
+
+	RETURN(&lbh->lbh_super);
+}
+
+static struct lmv_sub_batch *
+lmv_batch_lookup_sub(struct lmv_batch *lbh, struct lmv_tgt_desc *tgt)
+{
+	struct lmv_sub_batch *sub;
+
+	list_for_each_entry(sub, &lbh->lbh_sub_batch_list, sbh_sub_item) {
+		if (sub->sbh_tgt == tgt)
+			return sub;
+	}
+
+	OBD_ALLOC_PTR(sub);
+	if (!sub)
+		return ERR_PTR(-ENOMEM);
+
+	sub->sbh_sub = md_batch_create(tgt->ltd_exp,
+				       lbh->lbh_super.lbt_max_count);
+	if (IS_ERR(sub->sbh_sub)) {
+		struct lu_batch *bh = sub->sbh_sub;
+
+		OBD_FREE_PTR(sub);
+		return ERR_CAST(bh);
+	}
+
+	sub->sbh_tgt = tgt;
+	list_add_tail(&sub->sbh_sub_item, &lbh->lbh_sub_batch_list);
+
+	return sub;
+}
+
+static int lmv_batch_add(struct obd_export *exp, struct lu_batch *bh,
+			 struct md_enqueue_info *minfo)
+{
+	struct lmv_batch *lbh = container_of(bh, struct lmv_batch, lbh_super);
+	struct obd_device *obd = exp->exp_obd;
+	struct lmv_obd *lmv = &obd->u.lmv;
+	struct lmv_sub_batch *sub;
+	struct lmv_tgt_desc *tgt;
+	int rc;
+
+	ENTRY;
+
+	tgt = lmv_intent_getattr_tgt(lmv, &minfo->mi_data);
+	if (IS_ERR(tgt))
+		RETURN(PTR_ERR(tgt));
+
+	sub = lmv_batch_lookup_sub(lbh, tgt);
+	if (IS_ERR(sub))
+		RETURN(PTR_ERR(sub));
+
+	rc = md_batch_add(tgt->ltd_exp, sub->sbh_sub, minfo);
+
+	RETURN(rc);
+}
+
+static int lmv_batch_flush(struct obd_export *exp, struct lu_batch *bh)
+{
+	struct lmv_batch *lbh = container_of(bh, struct lmv_batch, lbh_super);
+	struct lmv_sub_batch *sub;
+	int rc = 0;
+	int rc2;
+
+	ENTRY;
+
+	list_for_each_entry(sub, &lbh->lbh_sub_batch_list, sbh_sub_item) {
+		rc2 = md_batch_flush(sub->sbh_tgt->ltd_exp, sub->sbh_sub);
+		if (rc2 && !rc)
+			rc = rc2;
+	}
+
+	RETURN(rc);
+}
+
+static int lmv_batch_stop(struct obd_export *exp, struct lu_batch *bh)
+{
+	struct lmv_batch *lbh = container_of(bh, struct lmv_batch, lbh_super);
+	struct lmv_sub_batch *sub;
+	struct lmv_sub_batch *tmp;
+	int rc = 0;
+	int rc2;
+
+	ENTRY;
+
+	list_for_each_entry_safe(sub, tmp, &lbh->lbh_sub_batch_list,
+				 sbh_sub_item) {
+		list_del(&sub->sbh_sub_item);
+		rc2 = md_batch_stop(sub->sbh_tgt->ltd_exp, sub->sbh_sub);
+		if (rc2 && !rc)
+			rc = rc2;
+		OBD_FREE_PTR(sub);
+	}
 
-	rc = md_intent_getattr_async(ptgt->ltd_exp, minfo);
+	OBD_FREE_PTR(lbh);
 
 	RETURN(rc);
 }
@@ -3863,6 +4001,10 @@ static const struct md_ops lmv_md_ops = {
         .m_set_open_replay_data = lmv_set_open_replay_data,
         .m_clear_open_replay_data = lmv_clear_open_replay_data,
         .m_intent_getattr_async = lmv_intent_getattr_async,
+	.m_batch_create		= lmv_batch_create,
+	.m_batch_add		= lmv_batch_add,
+	.m_batch_flush		= lmv_batch_flush,
+	.m_batch_stop		= lmv_batch_stop,
 	.m_revalidate_lock      = lmv_revalidate_lock,
 	.m_get_fid_from_lsm	= lmv_get_fid_from_lsm,
 	.m_unpackmd		= lmv_unpackmd,
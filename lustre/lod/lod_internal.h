@@ -173,6 +173,7 @@ struct lod_layout_component {
 	__u16			  llc_stripe_count;
 	__u16			  llc_stripes_allocated;
 	__u64			  llc_timestamp; /* snapshot time */
+	__u8			  llc_compr_type; /* enum ll_compr_type */
 	char			 *llc_pool;
 	/* ost list specified with LOV_USER_MAGIC_SPECIFIC lum */
 	struct lu_tgt_pool	  llc_ostlist;
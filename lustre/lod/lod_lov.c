@@ -910,6 +910,7 @@ int lod_generate_lovea(const struct lu_env *env, struct lod_object *lo,
 		if (lod_comp->llc_flags & LCME_FL_NOSYNC)
 			lcme->lcme_timestamp =
 				cpu_to_le64(lod_comp->llc_timestamp);
+		lcme->lcme_compr_type = lod_comp->llc_compr_type;
 		if (lod_comp->llc_flags & LCME_FL_EXTENSION && !is_dir)
 			lcm->lcm_magic = cpu_to_le32(LOV_MAGIC_SEL);
 
@@ -1255,6 +1256,8 @@ int lod_parse_striping(const struct lu_env *env, struct lod_object *lo,
 			if (lod_comp->llc_flags & LCME_FL_NOSYNC)
 				lod_comp->llc_timestamp = le64_to_cpu(
 					comp_v1->lcm_entries[i].lcme_timestamp);
+			lod_comp->llc_compr_type =
+				comp_v1->lcm_entries[i].lcme_compr_type;
 			lod_comp->llc_id =
 				le32_to_cpu(comp_v1->lcm_entries[i].lcme_id);
 			if (lod_comp->llc_id == LCME_ID_INVAL)
@@ -1992,6 +1995,12 @@ recheck:
 			RETURN(-EINVAL);
 		}
 
+		if (ent->lcme_compr_type >= LL_COMPR_TYPE_MAX) {
+			CDEBUG(D_LAYOUT, "invalid compression type %u\n",
+			       ent->lcme_compr_type);
+			RETURN(-EINVAL);
+		}
+
 		if (is_from_disk) {
 			/* lcme_id contains valid value */
 			if (le32_to_cpu(ent->lcme_id) == 0 ||
@@ -2781,6 +2781,8 @@ static int lod_declare_layout_add(const struct lu_env *env,
 		lod_comp->llc_extent.e_end = ext->e_end;
 		lod_comp->llc_stripe_offset = v1->lmm_stripe_offset;
 		lod_comp->llc_flags = comp_v1->lcm_entries[i].lcme_flags;
+		lod_comp->llc_compr_type =
+			comp_v1->lcm_entries[i].lcme_compr_type;
 
 		lod_comp->llc_stripe_count = v1->lmm_stripe_count;
 		lod_comp->llc_stripe_size = v1->lmm_stripe_size;
@@ -5202,6 +5204,8 @@ static int lod_get_default_lov_striping(const struct lu_env *env,
 			lod_comp->llc_flags =
 					comp_v1->lcm_entries[i].lcme_flags &
 					LCME_TEMPLATE_FLAGS;
+			lod_comp->llc_compr_type =
+				comp_v1->lcm_entries[i].lcme_compr_type;
 		}
 
 		if (!lov_pattern_supported(v1->lmm_pattern) &&
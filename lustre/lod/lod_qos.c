@@ -2046,6 +2046,10 @@ int lod_use_defined_striping(const struct lu_env *env,
 				le32_to_cpu(comp_v1->lcm_entries[i].lcme_id);
 			if (lod_comp->llc_id == LCME_ID_INVAL)
 				GOTO(out, rc = -EINVAL);
+			lod_comp->llc_compr_type =
+				comp_v1->lcm_entries[i].lcme_compr_type;
+			if (lod_comp->llc_compr_type >= LL_COMPR_TYPE_MAX)
+				GOTO(out, rc = -EINVAL);
 		}
 
 		pool_name = NULL;
@@ -534,6 +534,18 @@ lsm_unpackmd_comp_md_v1(struct lov_obd *lov, void *buf, size_t buf_size)
 		if (lsme->lsme_flags & LCME_FL_NOSYNC)
 			lsme->lsme_timestamp =
 				le64_to_cpu(lcme->lcme_timestamp);
+		lsme->lsme_compr_type = lcme->lcme_compr_type;
+		if (lsme->lsme_compr_type >= LL_COMPR_TYPE_MAX)
+			lsme->lsme_compr_type = LL_COMPR_TYPE_NONE;
+		/* OSC picks the compression type up from its stripe */
+		if (lsme_inited(lsme) && !lsme_is_dom(lsme) &&
+		    !(lsme->lsme_pattern & LOV_PATTERN_F_RELEASED)) {
+			int j;
+
+			for (j = 0; j < lsme->lsme_stripe_count; j++)
+				lsme->lsme_oinfo[j]->loi_compr_type =
+					lsme->lsme_compr_type;
+		}
 		lu_extent_le_to_cpu(&lsme->lsme_extent, &lcme->lcme_extent);
 
 		if (i == entry_count - 1) {
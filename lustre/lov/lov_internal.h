@@ -50,6 +50,7 @@ struct lov_stripe_md_entry {
 	u32			lsme_stripe_size;
 	u16			lsme_stripe_count;
 	u16			lsme_layout_gen;
+	u8			lsme_compr_type;
 	char			lsme_pool_name[LOV_MAXPOOLNAME + 1];
 	struct lov_oinfo       *lsme_oinfo[];
 };
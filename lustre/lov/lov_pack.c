@@ -231,6 +231,7 @@ ssize_t lov_lsm_pack(const struct lov_stripe_md *lsm, void *buf,
 		if (lsme->lsme_flags & LCME_FL_NOSYNC)
 			lcme->lcme_timestamp =
 				cpu_to_le64(lsme->lsme_timestamp);
+		lcme->lcme_compr_type = lsme->lsme_compr_type;
 		lcme->lcme_extent.e_start =
 			cpu_to_le64(lsme->lsme_extent.e_start);
 		lcme->lcme_extent.e_end =
@@ -332,9 +332,8 @@ static int mdc_cached_mb_seq_show(struct seq_file *m, void *v)
 	seq_printf(m, "used_mb: %ld\n"
 		   "busy_cnt: %ld\n"
 		   "reclaim: %llu\n",
-		   (atomic_long_read(&cli->cl_lru_in_list) +
-		    atomic_long_read(&cli->cl_lru_busy)) >> shift,
-		    atomic_long_read(&cli->cl_lru_busy),
+		   (cl_lru_in_list(cli) + cl_lru_busy(cli)) >> shift,
+		   cl_lru_busy(cli),
 		   cli->cl_lru_reclaim);
 
 	return 0;
@@ -367,7 +366,7 @@ mdc_cached_mb_seq_write(struct file *file, const char __user *buffer,
 
 	pages_number >>= PAGE_SHIFT;
 
-	rc = atomic_long_read(&cli->cl_lru_in_list) - pages_number;
+	rc = cl_lru_in_list(cli) - pages_number;
 	if (rc > 0) {
 		struct lu_env *env;
 		__u16 refcheck;
@@ -41,7 +41,7 @@ void mdc_pack_body(struct req_capsule *pill, const struct lu_fid *fid,
 void mdc_swap_layouts_pack(struct req_capsule *pill,
 			   struct md_op_data *op_data);
 void mdc_readdir_pack(struct req_capsule *pill, __u64 pgoff, size_t size,
-		      const struct lu_fid *fid);
+		      const struct lu_fid *fid, __u32 attrs);
 void mdc_getattr_pack(struct req_capsule *pill, __u64 valid, __u32 flags,
 		      struct md_op_data *data, size_t ea_size);
 void mdc_setattr_pack(struct req_capsule *pill, struct md_op_data *op_data,
@@ -131,6 +131,11 @@ int mdc_revalidate_lock(struct obd_export *exp, struct lookup_intent *it,
 
 int mdc_intent_getattr_async(struct obd_export *exp,
 			     struct md_enqueue_info *minfo);
+struct lu_batch *mdc_batch_create(struct obd_export *exp, __u32 max_count);
+int mdc_batch_add(struct obd_export *exp, struct lu_batch *bh,
+		  struct md_enqueue_info *minfo);
+int mdc_batch_flush(struct obd_export *exp, struct lu_batch *bh);
+int mdc_batch_stop(struct obd_export *exp, struct lu_batch *bh);
 
 enum ldlm_mode mdc_lock_match(struct obd_export *exp, __u64 flags,
 			      const struct lu_fid *fid, enum ldlm_type type,
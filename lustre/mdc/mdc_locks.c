@@ -1408,8 +1408,12 @@ out:
 	return 0;
 }
 
-int mdc_intent_getattr_async(struct obd_export *exp,
-			     struct md_enqueue_info *minfo)
+/*
+ * Pack the intent getattr enqueue of \a minfo into a request ready to be
+ * sent, either on its own or as a sub-request of a batched RPC.
+ */
+static struct ptlrpc_request *
+mdc_intent_getattr_prep(struct obd_export *exp, struct md_enqueue_info *minfo)
 {
 	struct md_op_data *op_data = &minfo->mi_data;
 	struct lookup_intent *it = &minfo->mi_it;
@@ -1435,7 +1439,7 @@ int mdc_intent_getattr_async(struct obd_export *exp,
 	req = mdc_intent_getattr_pack(exp, it, op_data,
 				      LUSTRE_POSIX_ACL_MAX_SIZE_OLD);
 	if (IS_ERR(req))
-		RETURN(PTR_ERR(req));
+		RETURN(req);
 
 	/* With Data-on-MDT the glimpse callback is needed too.
 	 * It is set here in advance but not in mdc_finish_enqueue()
@@ -1449,7 +1453,7 @@ int mdc_intent_getattr_async(struct obd_export *exp,
 			      &flags, NULL, 0, LVB_T_NONE, &minfo->mi_lockh, 1);
 	if (rc < 0) {
 		ptlrpc_req_finished(req);
-		RETURN(rc);
+		RETURN(ERR_PTR(rc));
 	}
 
 	ga = ptlrpc_req_async_args(ga, req);
@@ -1457,7 +1461,310 @@ int mdc_intent_getattr_async(struct obd_export *exp,
 	ga->ga_minfo = minfo;
 
 	req->rq_interpret_reply = mdc_intent_getattr_async_interpret;
+
+	RETURN(req);
+}
+
+int mdc_intent_getattr_async(struct obd_export *exp,
+			     struct md_enqueue_info *minfo)
+{
+	struct ptlrpc_request *req;
+
+	ENTRY;
+
+	minfo->mi_einfo.ei_batch = 0;
+	req = mdc_intent_getattr_prep(exp, minfo);
+	if (IS_ERR(req))
+		RETURN(PTR_ERR(req));
+
+	ptlrpcd_add_req(req);
+
+	RETURN(0);
+}
+
+/* Batch of intent getattr sub-requests for one MDT */
+struct mdc_batch {
+	struct lu_batch			  mbh_super;
+	/* sub-requests packed but not sent yet */
+	struct ptlrpc_request		**mbh_reqs;
+	__u32				  mbh_count;
+	/* total size of the sub-requests and of their expected replies */
+	__u32				  mbh_reqsize;
+	__u32				  mbh_repsize;
+};
+
+/* room left in a batched request for lustre_msg, ptlrpc_body and header */
+#define MDC_BATCH_REQSIZE	(MSG_BATCH_MAXREQSIZE - 1024)
+#define MDC_BATCH_REPSIZE	(MSG_BATCH_MAXREPSIZE - 1024)
+
+struct mdc_batch_args {
+	struct ptlrpc_request		**mba_reqs;
+	__u32				  mba_count;
+	__u32				  mba_max;
+};
+
+/* Complete sub-request \a sub of a batch with status \a rc and release it. */
+static void mdc_batch_subreq_done(const struct lu_env *env,
+				  struct ptlrpc_request *sub, int rc)
+{
+	sub->rq_interpret_reply(env, sub, &sub->rq_async_args, rc);
+	ptlrpc_req_finished(sub);
+}
+
+/*
+ * The batched RPC could not be built, send the sub-requests \a reqs on their
+ * own, so they are completed by ptlrpcd like unbatched intent getattrs.
+ *
+ * They did not take a request slot in ldlm_cli_enqueue() as sub-requests,
+ * each takes one now to stay within max_rpcs_in_flight, and is completed
+ * with the error if it cannot.
+ */
+static void mdc_batch_send_unbatched(struct ptlrpc_request **reqs,
+				     __u32 count)
+{
+	struct mdc_getattr_args *ga;
+	__u32 i;
+	int rc;
+
+	for (i = 0; i < count; i++) {
+		rc = obd_get_request_slot(&reqs[i]->rq_import->imp_obd->u.cli);
+		if (rc) {
+			mdc_batch_subreq_done(NULL, reqs[i], rc);
+			continue;
+		}
+
+		/* ldlm_cli_enqueue_fini() puts the slot back */
+		ga = ptlrpc_req_async_args(ga, reqs[i]);
+		ga->ga_minfo->mi_einfo.ei_batch = 0;
+		ptlrpcd_add_req(reqs[i]);
+	}
+}
+
+static int mdc_batch_interpret(const struct lu_env *env,
+			       struct ptlrpc_request *req,
+			       void *args, int rc)
+{
+	struct mdc_batch_args *mba = args;
+	struct msg_batch_reply *reply = NULL;
+	struct lustre_msg *repmsg = NULL;
+	int replen = 0;
+	__u32 i;
+
+	ENTRY;
+
+	obd_put_request_slot(&req->rq_import->imp_obd->u.cli);
+
+	if (rc == 0) {
+		reply = req_capsule_server_get(&req->rq_pill,
+					       &RMF_MSG_BATCH_REPLY);
+		if (reply == NULL ||
+		    reply->mbr_magic != MSG_BATCH_REPLY_MAGIC) {
+			CERROR("%s: invalid batched reply: rc = %d\n",
+			       req->rq_import->imp_obd->obd_name, -EPROTO);
+			rc = -EPROTO;
+		} else {
+			repmsg = reply->mbr_repmsg;
+			replen = req_capsule_get_size(&req->rq_pill,
+						      &RMF_MSG_BATCH_REPLY,
+						      RCL_SERVER) -
+				 sizeof(*reply);
+		}
+	}
+
+	for (i = 0; i < mba->mba_count; i++) {
+		struct ptlrpc_request *sub = mba->mba_reqs[i];
+		int len = replen;
+		int subrc = rc;
+
+		/* the reply buffer was exhausted on the server, and the
+		 * remaining sub-requests were not executed
+		 */
+		if (subrc == 0 && i >= reply->mbr_count)
+			subrc = -EOVERFLOW;
+
+		if (subrc == 0) {
+			subrc = ptlrpc_batch_subreq_reply(sub, repmsg, &len);
+			if (subrc < 0) {
+				/* unable to find the next sub-reply */
+				DEBUG_REQ(D_ERROR, req,
+					  "bad sub-reply %u: rc = %d", i,
+					  subrc);
+				rc = subrc;
+			} else {
+				subrc = sub->rq_status;
+				len = cfs_size_round(len);
+				repmsg = (struct lustre_msg *)((char *)repmsg +
+							       len);
+				replen = max(replen - len, 0);
+			}
+		}
+
+		mdc_batch_subreq_done(env, sub, subrc);
+	}
+
+	OBD_FREE_PTR_ARRAY(mba->mba_reqs, mba->mba_max);
+
+	RETURN(0);
+}
+
+struct lu_batch *mdc_batch_create(struct obd_export *exp, __u32 max_count)
+{
+	struct mdc_batch *mbh;
+
+	ENTRY;
+
+	OBD_ALLOC_PTR(mbh);
+	if (mbh == NULL)
+		RETURN(ERR_PTR(-ENOMEM));
+
+	mbh->mbh_super.lbt_max_count = clamp_t(__u32, max_count, 1,
+					       MSG_BATCH_MAX_COUNT);
+
+	RETURN(&mbh->mbh_super);
+}
+
+int mdc_batch_flush(struct obd_export *exp, struct lu_batch *bh)
+{
+	struct mdc_batch *mbh = container_of(bh, struct mdc_batch, mbh_super);
+	struct ptlrpc_request **reqs = mbh->mbh_reqs;
+	__u32 count = mbh->mbh_count;
+	__u32 reqsize = mbh->mbh_reqsize;
+	__u32 repsize = mbh->mbh_repsize;
+	struct msg_batch_header *header;
+	struct mdc_batch_args *mba;
+	struct ptlrpc_request *req;
+	char *buf;
+	__u32 i;
+	int rc;
+
+	ENTRY;
+
+	if (count == 0)
+		RETURN(0);
+
+	mbh->mbh_reqs = NULL;
+	mbh->mbh_count = 0;
+	mbh->mbh_reqsize = 0;
+	mbh->mbh_repsize = 0;
+
+	req = ptlrpc_request_alloc(class_exp2cliimp(exp), &RQF_MDS_MSG_BATCH);
+	if (req == NULL)
+		GOTO(out, rc = -ENOMEM);
+
+	req_capsule_set_size(&req->rq_pill, &RMF_MSG_BATCH_BUF, RCL_CLIENT,
+			     reqsize);
+	rc = ptlrpc_request_pack(req, LUSTRE_MDS_VERSION, MDS_MSG_BATCH);
+	if (rc) {
+		ptlrpc_request_free(req);
+		GOTO(out, rc);
+	}
+
+	header = req_capsule_client_get(&req->rq_pill, &RMF_MSG_BATCH_HEADER);
+	header->mbh_magic = MSG_BATCH_HEADER_MAGIC;
+	header->mbh_count = count;
+	header->mbh_reply_size = repsize;
+
+	buf = req_capsule_client_get(&req->rq_pill, &RMF_MSG_BATCH_BUF);
+	for (i = 0; i < count; i++) {
+		lustre_msg_set_type(reqs[i]->rq_reqmsg, PTL_RPC_MSG_REQUEST);
+		memcpy(buf, reqs[i]->rq_reqmsg, reqs[i]->rq_reqlen);
+		buf += cfs_size_round(reqs[i]->rq_reqlen);
+	}
+
+	req_capsule_set_size(&req->rq_pill, &RMF_MSG_BATCH_REPLY, RCL_SERVER,
+			     sizeof(struct msg_batch_reply) + repsize);
+	ptlrpc_request_set_replen(req);
+
+	/* the sub-requests do not take a request slot on their own */
+	rc = obd_get_request_slot(&class_exp2cliimp(exp)->imp_obd->u.cli);
+	if (rc) {
+		ptlrpc_req_finished(req);
+		GOTO(out, rc);
+	}
+
+	mba = ptlrpc_req_async_args(mba, req);
+	mba->mba_reqs = reqs;
+	mba->mba_count = count;
+	mba->mba_max = bh->lbt_max_count;
+
+	req->rq_interpret_reply = mdc_batch_interpret;
 	ptlrpcd_add_req(req);
 
 	RETURN(0);
+out:
+	CDEBUG(D_HA, "%s: cannot send batched RPC, send %u requests: rc = %d\n",
+	       exp->exp_obd->obd_name, count, rc);
+	mdc_batch_send_unbatched(reqs, count);
+	OBD_FREE_PTR_ARRAY(reqs, bh->lbt_max_count);
+
+	RETURN(0);
+}
+
+int mdc_batch_add(struct obd_export *exp, struct lu_batch *bh,
+		  struct md_enqueue_info *minfo)
+{
+	struct mdc_batch *mbh = container_of(bh, struct mdc_batch, mbh_super);
+	struct ptlrpc_request *req;
+	__u32 reqsize;
+	__u32 repsize;
+
+	ENTRY;
+
+	/* the MDT executes only intent getattr/lookup inside a batch */
+	if (!(minfo->mi_it.it_op & (IT_GETATTR | IT_LOOKUP)))
+		RETURN(-EOPNOTSUPP);
+
+	/* MDT without batched RPC support, send it on its own */
+	if (!(exp_connect_flags2(exp) & OBD_CONNECT2_MSG_BATCH))
+		RETURN(mdc_intent_getattr_async(exp, minfo));
+
+	if (mbh->mbh_reqs == NULL) {
+		OBD_ALLOC_PTR_ARRAY(mbh->mbh_reqs, bh->lbt_max_count);
+		if (mbh->mbh_reqs == NULL)
+			RETURN(-ENOMEM);
+	}
+
+	minfo->mi_einfo.ei_batch = 1;
+	req = mdc_intent_getattr_prep(exp, minfo);
+	if (IS_ERR(req))
+		RETURN(PTR_ERR(req));
+
+	reqsize = cfs_size_round(req->rq_reqlen);
+	/* the MDT reserves lm_repsize for the reply of each sub-request */
+	repsize = cfs_size_round(ptlrpc_req_get_repsize(req));
+	/* send what is packed already if this one does not fit */
+	if (mbh->mbh_count > 0 &&
+	    (mbh->mbh_reqsize + reqsize > MDC_BATCH_REQSIZE ||
+	     mbh->mbh_repsize + repsize > MDC_BATCH_REPSIZE)) {
+		mdc_batch_flush(exp, bh);
+		OBD_ALLOC_PTR_ARRAY(mbh->mbh_reqs, bh->lbt_max_count);
+		if (mbh->mbh_reqs == NULL) {
+			mdc_batch_send_unbatched(&req, 1);
+			RETURN(0);
+		}
+	}
+
+	mbh->mbh_reqs[mbh->mbh_count++] = req;
+	mbh->mbh_reqsize += reqsize;
+	mbh->mbh_repsize += repsize;
+	if (mbh->mbh_count == bh->lbt_max_count)
+		/* errors are reported through the sub-request callbacks */
+		mdc_batch_flush(exp, bh);
+
+	RETURN(0);
+}
+
+int mdc_batch_stop(struct obd_export *exp, struct lu_batch *bh)
+{
+	struct mdc_batch *mbh = container_of(bh, struct mdc_batch, mbh_super);
+	int rc;
+
+	ENTRY;
+
+	rc = mdc_batch_flush(exp, bh);
+	if (mbh->mbh_reqs != NULL)
+		OBD_FREE_PTR_ARRAY(mbh->mbh_reqs, bh->lbt_max_count);
+	OBD_FREE_PTR(mbh);
+
+	RETURN(rc);
 }
@@ -1009,7 +1009,7 @@ out:
 }
 
 static int mdc_getpage(struct obd_export *exp, const struct lu_fid *fid,
-		       u64 offset, struct page **pages, int npages,
+		       u64 offset, __u32 attrs, struct page **pages, int npages,
 		       struct ptlrpc_request **request)
 {
 	struct ptlrpc_request   *req;
@@ -1049,7 +1049,7 @@ restart_bulk:
 		desc->bd_frag_ops->add_kiov_frag(desc, pages[i], 0,
 						 PAGE_SIZE);
 
-	mdc_readdir_pack(&req->rq_pill, offset, PAGE_SIZE * npages, fid);
+	mdc_readdir_pack(&req->rq_pill, offset, PAGE_SIZE * npages, fid, attrs);
 
 	ptlrpc_request_set_replen(req);
 	rc = ptlrpc_queue_wait(req);
@@ -1312,6 +1312,7 @@ static int mdc_read_page_remote(void *data, struct page *page0)
 	int max_pages;
 	struct inode *inode;
 	struct lu_fid *fid;
+	__u32 attrs = 0;
 	int rd_pgs = 0; /* number of pages actually read */
 	int npages;
 	int i;
@@ -1338,7 +1339,12 @@ static int mdc_read_page_remote(void *data, struct page *page0)
 		page_pool[npages] = page;
 	}
 
-	rc = mdc_getpage(rp->rp_exp, fid, rp->rp_off, page_pool, npages, &req);
+	if (op_data->op_cli_flags & CLI_READDIR_PLUS &&
+	    exp_connect_flags2(rp->rp_exp) & OBD_CONNECT2_READDIR_PLUS)
+		attrs |= LUDA_ATTRS | LUDA_LAYOUT;
+
+	rc = mdc_getpage(rp->rp_exp, fid, rp->rp_off, attrs, page_pool, npages,
+			 &req);
 	if (rc < 0) {
 		/* page0 is special, which was added into page cache early */
 		delete_from_page_cache(page0);
@@ -2954,6 +2960,10 @@ static const struct md_ops mdc_md_ops = {
 	.m_set_open_replay_data = mdc_set_open_replay_data,
 	.m_clear_open_replay_data = mdc_clear_open_replay_data,
 	.m_intent_getattr_async = mdc_intent_getattr_async,
+	.m_batch_create		= mdc_batch_create,
+	.m_batch_add		= mdc_batch_add,
+	.m_batch_flush		= mdc_batch_flush,
+	.m_batch_stop		= mdc_batch_stop,
 	.m_revalidate_lock      = mdc_revalidate_lock,
 	.m_rmfid		= mdc_rmfid,
 };
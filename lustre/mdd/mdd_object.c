@@ -3600,6 +3600,104 @@ static int mdd_readpage_sanity_check(const struct lu_env *env,
         RETURN(rc);
 }
 
+/**
+ * Append the attributes of the object referenced by \a ent to the entry, for
+ * readdir-plus.  They are read without locking the object, so the client may
+ * only use them as a hint.  The entry is left as is if the object is remote or
+ * its attributes cannot be read.
+ *
+ * With LUDA_LAYOUT in \a attr, the LOV EA of a regular file is appended too
+ * if it fits in the \a nob bytes left in the page.
+ */
+static void mdd_dir_page_attrs(const struct lu_env *env,
+			       struct mdd_device *mdd, struct lu_dirent *ent,
+			       __u32 attr, size_t nob)
+{
+	struct lu_attr *la = &mdd_env_info(env)->mdi_cattr;
+	struct lu_buf *som_buf = &mdd_env_info(env)->mdi_buf[1];
+	struct lu_buf *lmm_buf = &mdd_env_info(env)->mdi_buf[2];
+	struct lustre_som_attrs som;
+	struct mdd_object *obj;
+	struct luda_attrs *lda;
+	struct lu_fid fid;
+	size_t recsize;
+	__u64 valid;
+	int rc;
+
+	if (!(le32_to_cpu(ent->lde_attrs) & LUDA_FID))
+		return;
+
+	fid_le_to_cpu(&fid, &ent->lde_fid);
+	obj = mdd_object_find(env, mdd, &fid);
+	if (IS_ERR(obj))
+		return;
+
+	if (mdd_object_remote(obj))
+		GOTO(out, rc = 0);
+
+	rc = mdd_la_get(env, obj, la);
+	if (rc)
+		GOTO(out, rc);
+
+	recsize = lu_dirent_calc_size(le16_to_cpu(ent->lde_namelen),
+				      le32_to_cpu(ent->lde_attrs));
+	lda = (void *)ent + recsize;
+	memset(lda, 0, sizeof(*lda));
+	valid = OBD_MD_FLMODE | OBD_MD_FLTYPE | OBD_MD_FLUID | OBD_MD_FLGID |
+		OBD_MD_FLNLINK | OBD_MD_FLATIME | OBD_MD_FLMTIME |
+		OBD_MD_FLCTIME | OBD_MD_FLFLAGS | OBD_MD_FLPROJID;
+
+	if (S_ISREG(la->la_mode)) {
+		/* the size of regular files is on the OSTs, use LSOM */
+		som_buf->lb_buf = &som;
+		som_buf->lb_len = sizeof(som);
+		rc = mdo_xattr_get(env, obj, som_buf, XATTR_NAME_SOM);
+		if (rc == sizeof(som)) {
+			lustre_som_swab(&som);
+			lda->lda_size = cpu_to_le64(som.lsa_size);
+			lda->lda_blocks = cpu_to_le64(som.lsa_blocks);
+			/* as mdt_get_som() does for getattr */
+			if (som.lsa_valid & SOM_FL_STRICT)
+				valid |= OBD_MD_FLSIZE | OBD_MD_FLBLOCKS;
+			else
+				valid |= OBD_MD_FLLAZYSIZE |
+					 OBD_MD_FLLAZYBLOCKS;
+		}
+
+		if (attr & LUDA_LAYOUT && nob > recsize + sizeof(*lda)) {
+			lmm_buf->lb_buf = lda + 1;
+			lmm_buf->lb_len = nob - recsize - sizeof(*lda);
+			rc = mdo_xattr_get(env, obj, lmm_buf, XATTR_NAME_LOV);
+			/* -ERANGE if it does not fit, sent without layout */
+			if (rc > 0)
+				lda->lda_lmm_size = cpu_to_le32(rc);
+		}
+	} else if (!S_ISDIR(la->la_mode)) {
+		/* the size of striped directories is summed up by clients */
+		lda->lda_size = cpu_to_le64(la->la_size);
+		lda->lda_blocks = cpu_to_le64(la->la_blocks);
+		valid |= OBD_MD_FLSIZE | OBD_MD_FLBLOCKS;
+	}
+
+	lda->lda_valid = cpu_to_le64(valid);
+	lda->lda_atime = cpu_to_le64(la->la_atime);
+	lda->lda_mtime = cpu_to_le64(la->la_mtime);
+	lda->lda_ctime = cpu_to_le64(la->la_ctime);
+	lda->lda_mode = cpu_to_le32(la->la_mode);
+	lda->lda_uid = cpu_to_le32(la->la_uid);
+	lda->lda_gid = cpu_to_le32(la->la_gid);
+	lda->lda_nlink = cpu_to_le32(la->la_nlink);
+	lda->lda_flags = cpu_to_le32(la->la_flags);
+	lda->lda_projid = cpu_to_le32(la->la_projid);
+
+	ent->lde_attrs = cpu_to_le32(le32_to_cpu(ent->lde_attrs) | LUDA_ATTRS);
+	ent->lde_reclen = cpu_to_le16(recsize + sizeof(*lda) +
+				      round_up(le32_to_cpu(lda->lda_lmm_size),
+					       8));
+out:
+	mdd_object_put(env, obj);
+}
+
 static int mdd_dir_page_build(const struct lu_env *env, union lu_page *lp,
 			      size_t nob, const struct dt_it_ops *iops,
 			      struct dt_it *it, __u32 attr, void *arg)
@@ -3641,21 +3739,26 @@ static int mdd_dir_page_build(const struct lu_env *env, union lu_page *lp,
                 recsize = lu_dirent_calc_size(len, attr);
 
                 if (nob >= recsize) {
-                        result = iops->rec(env, it, (struct dt_rec *)ent, attr);
+			/* osd packs the entry, attributes are added below */
+			result = iops->rec(env, it, (struct dt_rec *)ent,
+					   attr & ~(LUDA_ATTRS | LUDA_LAYOUT));
                         if (result == -ESTALE)
                                 goto next;
                         if (result != 0)
                                 goto out;
 
-                        /* osd might not able to pack all attributes,
-                         * so recheck rec length */
-                        recsize = le16_to_cpu(ent->lde_reclen);
-
 			if (le32_to_cpu(ent->lde_attrs) & LUDA_FID) {
 				fid_le_to_cpu(&fid, &ent->lde_fid);
 				if (fid_is_dot_lustre(&fid))
 					goto next;
 			}
+
+			if (attr & LUDA_ATTRS)
+				mdd_dir_page_attrs(env, arg, ent, attr, nob);
+
+                        /* osd might not able to pack all attributes,
+                         * so recheck rec length */
+                        recsize = le16_to_cpu(ent->lde_reclen);
                 } else {
                         result = (last != NULL) ? 0 :-EINVAL;
                         goto out;
@@ -3729,7 +3832,7 @@ int mdd_readpage(const struct lu_env *env, struct md_object *obj,
         }
 
 	rc = dt_index_walk(env, mdd_object_child(mdd_obj), rdpg,
-			   mdd_dir_page_build, NULL);
+			   mdd_dir_page_build, mdo2mdd(obj));
 	if (rc >= 0) {
 		struct lu_dirpage	*dp;
 
@@ -0,0 +1,233 @@
+/*
+ * GPL HEADER START
+ *
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 only,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License version 2 for more details (a copy is included
+ * in the LICENSE file that accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License
+ * version 2 along with this program; If not, see
+ * http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * GPL HEADER END
+ */
+/*
+ * This file is part of Lustre, http://www.lustre.org/
+ *
+ * lustre/mdt/mdt_batch.c
+ *
+ * Batched RPC (MDS_MSG_BATCH) handler
+ */
+
+#define DEBUG_SUBSYSTEM S_MDS
+
+#include "mdt_internal.h"
+
+/*
+ * Execute one sub-request of a batched RPC.  Clients pack only intent
+ * getattr/lookup lock enqueues into a batch (see mdc_batch_add()), so any
+ * other sub-request is refused.  Reint sub-requests are not supported: each
+ * would need its own XID for last_rcvd reply reconstruction on resend, and
+ * its own replay on the client, which the batch format does not carry.
+ */
+static int mdt_batch_subreq(struct tgt_session_info *tsi,
+			    struct ptlrpc_request *sub)
+{
+	struct ldlm_request *dlm_req;
+	union ldlm_wire_policy_data *policy;
+	__u32 opc = lustre_msg_get_opc(sub->rq_reqmsg);
+
+	ENTRY;
+
+	if (opc != LDLM_ENQUEUE) {
+		DEBUG_REQ(D_ERROR, sub, "unsupported batched sub-request");
+		RETURN(-EOPNOTSUPP);
+	}
+
+	req_capsule_set(&sub->rq_pill, &RQF_LDLM_ENQUEUE);
+	dlm_req = req_capsule_client_get(&sub->rq_pill, &RMF_DLM_REQ);
+	if (dlm_req == NULL)
+		RETURN(err_serious(-EFAULT));
+
+	/* see tgt_request_preprocess() */
+	policy = &dlm_req->lock_desc.l_policy_data;
+	if (dlm_req->lock_desc.l_resource.lr_type != LDLM_IBITS ||
+	    (policy->l_inodebits.bits | policy->l_inodebits.try_bits) == 0)
+		RETURN(err_serious(-EPROTO));
+
+	tsi->tsi_dlm_req = dlm_req;
+
+	RETURN(tgt_enqueue(tsi));
+}
+
+/*
+ * The reply of \a sub does not fit into the batched reply, so the client
+ * never learns about the lock it was granted.  Cancel the lock as the client
+ * would have, rather than leave it to a blocking AST or to eviction.
+ */
+static void mdt_batch_subreq_cancel(struct ptlrpc_request *sub)
+{
+	struct ldlm_resource *res;
+	struct ldlm_reply *dlm_rep;
+	struct ldlm_lock *lock;
+
+	if (sub->rq_repmsg == NULL ||
+	    !req_capsule_has_field(&sub->rq_pill, &RMF_DLM_REP, RCL_SERVER))
+		return;
+
+	dlm_rep = req_capsule_server_get(&sub->rq_pill, &RMF_DLM_REP);
+	if (dlm_rep == NULL)
+		return;
+
+	lock = ldlm_handle2lock(&dlm_rep->lock_handle);
+	if (lock == NULL)
+		return;
+
+	LDLM_DEBUG(lock, "no room in batched reply, cancel");
+	/* the lock reference holds the resource */
+	res = lock->l_resource;
+	ldlm_lock_cancel(lock);
+	ldlm_reprocess_all(res, NULL);
+	LDLM_LOCK_PUT(lock);
+}
+
+/**
+ * Handler of MDS_MSG_BATCH RPC.
+ *
+ * Every sub-request is executed as if it had been received on its own, and
+ * its reply is packed into the batched reply in the same order, carrying its
+ * own status.  The handler returns an error only if the batched RPC itself
+ * is malformed.
+ */
+int mdt_batch(struct tgt_session_info *tsi)
+{
+	struct ptlrpc_request *req = tgt_ses_req(tsi);
+	struct req_capsule *pill = tsi->tsi_pill;
+	struct msg_batch_header *mbh;
+	struct msg_batch_reply *reply;
+	struct ptlrpc_request *sub;
+	struct lustre_msg *reqmsg;
+	char *repbuf;
+	int reqlen;
+	int replen;
+	int used;
+	__u32 i;
+	int rc;
+
+	ENTRY;
+
+	mbh = req_capsule_client_get(pill, &RMF_MSG_BATCH_HEADER);
+	if (mbh == NULL)
+		RETURN(err_serious(-EPROTO));
+
+	if (mbh->mbh_magic != MSG_BATCH_HEADER_MAGIC ||
+	    mbh->mbh_count == 0 || mbh->mbh_count > MSG_BATCH_MAX_COUNT) {
+		CERROR("%s: invalid batch header: magic %x, count %u\n",
+		       tgt_name(tsi->tsi_tgt), mbh->mbh_magic, mbh->mbh_count);
+		RETURN(err_serious(-EPROTO));
+	}
+
+	reqmsg = req_capsule_client_get(pill, &RMF_MSG_BATCH_BUF);
+	if (reqmsg == NULL)
+		RETURN(err_serious(-EPROTO));
+	reqlen = req_capsule_get_size(pill, &RMF_MSG_BATCH_BUF, RCL_CLIENT);
+
+	replen = min_t(__u32, mbh->mbh_reply_size,
+		       MSG_BATCH_MAXREPSIZE - sizeof(*reply));
+	/* leave room for the replies of only half of the sub-requests */
+	if (OBD_FAIL_CHECK(OBD_FAIL_MDS_BATCH_REPLY_SHORT))
+		replen /= 2;
+	req_capsule_set_size(pill, &RMF_MSG_BATCH_REPLY, RCL_SERVER,
+			     sizeof(*reply) + replen);
+	rc = req_capsule_server_pack(pill);
+	if (rc)
+		RETURN(err_serious(rc));
+
+	reply = req_capsule_server_get(pill, &RMF_MSG_BATCH_REPLY);
+	reply->mbr_magic = MSG_BATCH_REPLY_MAGIC;
+	reply->mbr_count = 0;
+	repbuf = (char *)reply->mbr_repmsg;
+	used = 0;
+
+	OBD_ALLOC_PTR(sub);
+	if (sub == NULL)
+		GOTO(out, rc = -ENOMEM);
+
+	for (i = 0; i < mbh->mbh_count; i++) {
+		struct req_capsule *saved_pill = tsi->tsi_pill;
+		struct ldlm_request *saved_dlm_req = tsi->tsi_dlm_req;
+		const struct mdt_body *saved_body = tsi->tsi_mdt_body;
+		int saved_fail_id = tsi->tsi_reply_fail_id;
+		int len = reqlen;
+
+		if (reqlen <= 0)
+			break;
+
+		rc = ptlrpc_batch_subreq_init(req, sub, reqmsg, &len);
+		if (rc)
+			break;
+
+		/* the client reserved lm_repsize bytes of the batched reply
+		 * for each sub-request, do not execute one without that room
+		 * left, it will be failed by the client
+		 */
+		if (cfs_size_round(ptlrpc_req_get_repsize(sub)) >
+		    replen - used) {
+			CDEBUG(D_INFO, "%s: batch reply full at %u/%u\n",
+			       tgt_name(tsi->tsi_tgt), i, mbh->mbh_count);
+			req_capsule_fini(&sub->rq_pill);
+			break;
+		}
+
+		tsi->tsi_pill = &sub->rq_pill;
+		tsi->tsi_dlm_req = NULL;
+		tsi->tsi_mdt_body = NULL;
+
+		rc = mdt_batch_subreq(tsi, sub);
+		sub->rq_status = clear_serious(rc);
+
+		tsi->tsi_pill = saved_pill;
+		tsi->tsi_dlm_req = saved_dlm_req;
+		tsi->tsi_mdt_body = saved_body;
+		tsi->tsi_reply_fail_id = saved_fail_id;
+
+		/* the reply is larger than reserved and the rest of the
+		 * batched reply, the remaining sub-requests are not executed
+		 */
+		if (sub->rq_repmsg != NULL &&
+		    lustre_packed_msg_size(sub->rq_repmsg) > replen - used)
+			mdt_batch_subreq_cancel(sub);
+
+		rc = ptlrpc_batch_subreq_fini(sub, repbuf + used,
+					      replen - used);
+		req_capsule_fini(&sub->rq_pill);
+		if (rc < 0) {
+			CDEBUG(D_INFO, "%s: batch reply full at %u/%u: rc = %d\n",
+			       tgt_name(tsi->tsi_tgt), i, mbh->mbh_count, rc);
+			break;
+		}
+
+		used += cfs_size_round(rc);
+		reply->mbr_count++;
+
+		len = cfs_size_round(len);
+		reqmsg = (struct lustre_msg *)((char *)reqmsg + len);
+		reqlen -= len;
+	}
+	rc = 0;
+
+	OBD_FREE_PTR(sub);
+out:
+	req_capsule_shrink(pill, &RMF_MSG_BATCH_REPLY, sizeof(*reply) + used,
+			   RCL_SERVER);
+
+	RETURN(rc);
+}
@@ -2739,6 +2739,63 @@ static int mdt_set_info(struct tgt_session_info *tsi)
 	RETURN(rc);
 }
 
+/*
+ * Map the IDs in the attributes packed by readdir-plus to the client view,
+ * as mdt_pack_attr2body() does for getattr.  The IDs are dropped if the
+ * nodemap of the export cannot be found.
+ */
+static void mdt_readpage_map_ids(struct mdt_thread_info *info,
+				 struct lu_rdpg *rdpg, int nob)
+{
+	struct lu_nodemap *nodemap;
+	int i;
+
+	nodemap = nodemap_get_from_exp(info->mti_exp);
+
+	for (i = 0; i < rdpg->rp_npages && nob > 0; i++) {
+		void *addr = kmap(rdpg->rp_pages[i]);
+		int off;
+
+		for (off = 0; off < PAGE_SIZE && nob > 0;
+		     off += LU_PAGE_SIZE, nob -= LU_PAGE_SIZE) {
+			struct lu_dirent *ent;
+
+			for (ent = lu_dirent_start(addr + off); ent != NULL;
+			     ent = lu_dirent_next(ent)) {
+				struct luda_attrs *lda = lu_dirent_attrs_get(ent);
+				__u32 id;
+
+				if (lda == NULL)
+					continue;
+
+				if (IS_ERR(nodemap)) {
+					lda->lda_valid &= ~cpu_to_le64(
+						OBD_MD_FLUID | OBD_MD_FLGID |
+						OBD_MD_FLPROJID);
+					continue;
+				}
+
+				id = nodemap_map_id(nodemap, NODEMAP_UID,
+						    NODEMAP_FS_TO_CLIENT,
+						    le32_to_cpu(lda->lda_uid));
+				lda->lda_uid = cpu_to_le32(id);
+				id = nodemap_map_id(nodemap, NODEMAP_GID,
+						    NODEMAP_FS_TO_CLIENT,
+						    le32_to_cpu(lda->lda_gid));
+				lda->lda_gid = cpu_to_le32(id);
+				id = nodemap_map_id(nodemap, NODEMAP_PROJID,
+						    NODEMAP_FS_TO_CLIENT,
+						    le32_to_cpu(lda->lda_projid));
+				lda->lda_projid = cpu_to_le32(id);
+			}
+		}
+		kunmap(rdpg->rp_pages[i]);
+	}
+
+	if (!IS_ERR(nodemap))
+		nodemap_putref(nodemap);
+}
+
 static int mdt_readpage(struct tgt_session_info *tsi)
 {
 	struct mdt_thread_info	*info = mdt_th_info(tsi->tsi_env);
@@ -2773,6 +2830,8 @@ static int mdt_readpage(struct tgt_session_info *tsi)
 	rdpg->rp_attrs = reqbody->mbo_mode;
 	if (exp_connect_flags(tsi->tsi_exp) & OBD_CONNECT_64BITHASH)
 		rdpg->rp_attrs |= LUDA_64BITHASH;
+	if (!(exp_connect_flags2(tsi->tsi_exp) & OBD_CONNECT2_READDIR_PLUS))
+		rdpg->rp_attrs &= ~(LUDA_ATTRS | LUDA_LAYOUT);
 	rdpg->rp_count  = min_t(unsigned int, reqbody->mbo_nlink,
 				exp_max_brw_size(tsi->tsi_exp));
 	rdpg->rp_npages = (rdpg->rp_count + PAGE_SIZE - 1) >>
@@ -2792,6 +2851,9 @@ static int mdt_readpage(struct tgt_session_info *tsi)
 	if (rc < 0)
 		GOTO(free_rdpg, rc);
 
+	if (rdpg->rp_attrs & LUDA_ATTRS)
+		mdt_readpage_map_ids(info, rdpg, rc);
+
 	/* send pages to client */
 	rc = tgt_sendpage(tsi, rdpg, rc);
 
@@ -5706,6 +5768,7 @@ TGT_MDT_HDL(HAS_KEY | HAS_BODY | HAS_REPLY | IS_MUTABLE,
 	    MDS_SWAP_LAYOUTS,
 	    mdt_swap_layouts),
 TGT_MDT_HDL(IS_MUTABLE,		MDS_RMFID,	mdt_rmfid),
+TGT_MDT_HDL(0,			MDS_MSG_BATCH,	mdt_batch),
 };
 
 static struct tgt_handler mdt_io_ops[] = {
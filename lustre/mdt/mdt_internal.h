@@ -1445,4 +1445,7 @@ int mdt_is_remote_object(struct mdt_thread_info *info,
 			 struct mdt_object *parent,
 			 struct mdt_object *child);
 
+/* batched RPC */
+int mdt_batch(struct tgt_session_info *tsi);
+
 #endif /* _MDT_INTERNAL_H */
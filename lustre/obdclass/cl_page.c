@@ -1246,9 +1246,16 @@ struct cl_client_cache *cl_cache_init(unsigned long lru_page_max)
 		RETURN(NULL);
 
 	/* Initialize cache data */
+	cache->ccc_lru_budget = cfs_percpt_alloc(cfs_cpt_tab,
+						 sizeof(struct cl_lru_budget));
+	if (cache->ccc_lru_budget == NULL) {
+		OBD_FREE(cache, sizeof(*cache));
+		RETURN(NULL);
+	}
+
 	atomic_set(&cache->ccc_users, 1);
 	cache->ccc_lru_max = lru_page_max;
-	atomic_long_set(&cache->ccc_lru_left, lru_page_max);
+	cl_cache_lru_put(cache, CFS_CPT_ANY, lru_page_max);
 	spin_lock_init(&cache->ccc_lru_lock);
 	INIT_LIST_HEAD(&cache->ccc_lru);
 
@@ -1278,7 +1285,121 @@ EXPORT_SYMBOL(cl_cache_incref);
  */
 void cl_cache_decref(struct cl_client_cache *cache)
 {
-	if (atomic_dec_and_test(&cache->ccc_users))
+	if (atomic_dec_and_test(&cache->ccc_users)) {
+		cfs_percpt_free(cache->ccc_lru_budget);
 		OBD_FREE(cache, sizeof(*cache));
+	}
 }
 EXPORT_SYMBOL(cl_cache_decref);
+
+/**
+ * Total # of LRU entries available in all the CPTs of \a cache.
+ *
+ * This reads the counter of every CPT, it should not be used in the page
+ * allocation and freeing paths.
+ */
+long cl_cache_lru_left(struct cl_client_cache *cache)
+{
+	struct cl_lru_budget *clb;
+	long left = 0;
+	int i;
+
+	cfs_percpt_for_each(clb, i, cache->ccc_lru_budget)
+		left += atomic_long_read(&clb->clb_left);
+
+	return left;
+}
+EXPORT_SYMBOL(cl_cache_lru_left);
+
+/**
+ * # of LRU entries available in CPT \a cpt of \a cache.
+ */
+long cl_cache_lru_left_cpt(struct cl_client_cache *cache, int cpt)
+{
+	return atomic_long_read(&cache->ccc_lru_budget[cpt]->clb_left);
+}
+EXPORT_SYMBOL(cl_cache_lru_left_cpt);
+
+/* take up to \a nr LRU entries from \a clb */
+static long cl_lru_budget_take(struct cl_lru_budget *clb, long nr)
+{
+	long left;
+	long take;
+
+	while ((left = atomic_long_read(&clb->clb_left)) > 0) {
+		take = min(left, nr);
+		if (atomic_long_cmpxchg(&clb->clb_left, left,
+					left - take) == left)
+			return take;
+	}
+
+	return 0;
+}
+
+/**
+ * Take up to \a nr LRU entries from \a cache for a thread running in CPT
+ * \a cpt.
+ *
+ * Entries are taken from the budget of \a cpt first. If that is short, they
+ * are borrowed from the other CPTs, and up to \a extra more entries are moved
+ * to the budget of \a cpt at the same time, so that the next allocations in
+ * this CPT do not have to go remote again.
+ *
+ * \retval	# of entries taken, it can be less than \a nr if \a cache is
+ *		running out of LRU entries
+ */
+long cl_cache_lru_get(struct cl_client_cache *cache, int cpt, long nr,
+		      long extra)
+{
+	struct cl_lru_budget *local;
+	int ncpt = cfs_percpt_number(cache->ccc_lru_budget);
+	long got;
+	int i;
+
+	LASSERT(cpt >= 0 && cpt < ncpt);
+	local = cache->ccc_lru_budget[cpt];
+
+	got = cl_lru_budget_take(local, nr);
+	for (i = 1; i < ncpt && got < nr; i++) {
+		struct cl_lru_budget *clb;
+		long want = nr - got;
+		long n;
+
+		clb = cache->ccc_lru_budget[(cpt + i) % ncpt];
+		n = cl_lru_budget_take(clb, want + extra);
+		if (n == 0)
+			continue;
+
+		atomic_long_add(n, &local->clb_borrowed);
+		if (n > want) {
+			atomic_long_add(n - want, &local->clb_left);
+			n = want;
+		}
+		got += n;
+	}
+
+	return got;
+}
+EXPORT_SYMBOL(cl_cache_lru_get);
+
+/**
+ * Give \a nr LRU entries back to CPT \a cpt of \a cache, or spread them
+ * over all the CPTs if \a cpt is CFS_CPT_ANY.
+ */
+void cl_cache_lru_put(struct cl_client_cache *cache, int cpt, long nr)
+{
+	struct cl_lru_budget *clb;
+	int ncpt;
+	int i;
+
+	if (cpt != CFS_CPT_ANY) {
+		atomic_long_add(nr, &cache->ccc_lru_budget[cpt]->clb_left);
+		return;
+	}
+
+	ncpt = cfs_percpt_number(cache->ccc_lru_budget);
+	cfs_percpt_for_each(clb, i, cache->ccc_lru_budget)
+		atomic_long_add(nr / ncpt + (i < nr % ncpt),
+				&clb->clb_left);
+}
+EXPORT_SYMBOL(cl_cache_lru_put);
@@ -39,6 +39,7 @@
 
 #include <obd_support.h>
 #include <obd_class.h>
+#include <obd_compress.h>
 #include <uapi/linux/lnet/lnetctl.h>
 #include <lustre_kernelcomm.h>
 #include <lprocfs_status.h>
@@ -678,6 +679,8 @@ static int __init obdclass_init(void)
 			     LPROCFS_CNTR_AVGMINMAX,
 			     "memused", "bytes");
 #endif
+	obd_compress_init();
+
 	err = obd_zombie_impexp_init();
 	if (err)
 		goto cleanup_obd_memory;
@@ -838,6 +841,7 @@ static void __exit obdclass_exit(void)
 	lu_global_fini();
 
 	obd_cleanup_caches();
+	obd_compress_fini();
 
 	class_procfs_clean();
 
@@ -87,6 +87,10 @@ void lprocfs_counter_add(struct lprocfs_stats *stats, int idx, long amount)
 		if (amount > percpu_cntr->lc_max)
 			percpu_cntr->lc_max = amount;
 	}
+	/* a single per-CPU increment, safe in any context */
+	if (header->lc_hist)
+		this_cpu_inc(header->lc_hist->lh_buckets[
+				lprocfs_hist_bucket(amount)]);
 	lprocfs_stats_unlock(stats, LPROCFS_GET_SMP_ID, &flags);
 }
 EXPORT_SYMBOL(lprocfs_counter_add);
@@ -30,8 +30,12 @@
 
 #define DEBUG_SUBSYSTEM S_CLASS
 
+#include <linux/kref.h>
+#include <linux/mm.h>
+#include <linux/vmalloc.h>
 #include <obd_class.h>
 #include <lprocfs_status.h>
+#include <uapi/linux/lustre/lustre_jobstats.h>
 
 #ifdef CONFIG_PROC_FS
 
@@ -64,11 +68,14 @@
 struct job_stat {
 	struct hlist_node	js_hash;	/* hash struct for this jobid */
 	struct list_head	js_list;	/* on ojs_list, with ojs_lock */
+	struct list_head	js_dirty;	/* on ojs_dirty, to publish */
 	atomic_t		js_refcount;	/* num users of this struct */
 	char			js_jobid[LUSTRE_JOBID_SIZE]; /* job name + NUL*/
 	ktime_t			js_time_init;	/* time of initial stat*/
 	ktime_t			js_time_latest;	/* time of most recent stat*/
 	struct lprocfs_stats	*js_stats;	/* per-job statistics */
+	/* ojs_hist_num histograms of LPROCFS_HIST_BUCKETS, if any */
+	atomic_t		*js_hist;
 	struct obd_job_stats	*js_jobstats;	/* for accessing ojs_lock */
 };
 
@@ -115,6 +122,10 @@ static void job_free(struct job_stat *job)
 	write_unlock(&job->js_jobstats->ojs_lock);
 
 	lprocfs_free_stats(&job->js_stats);
+	if (job->js_hist != NULL)
+		OBD_FREE_PTR_ARRAY(job->js_hist,
+				   job->js_jobstats->ojs_hist_num *
+				   LPROCFS_HIST_BUCKETS);
 	OBD_FREE_PTR(job);
 }
 
@@ -125,6 +136,30 @@ static void job_putref(struct job_stat *job)
 		job_free(job);
 }
 
+/**
+ * Queue \a job to be published to the job_stats_ring of its device.
+ *
+ * The job is only queued once until it is published, and the queue holds a
+ * reference on it, so that the final values of expired or cleared jobs are
+ * published too.  Nothing is queued until the ring has been opened.
+ *
+ * The caller must hold a reference on \a job.
+ */
+static void job_stat_dirty(struct job_stat *job)
+{
+	struct obd_job_stats *stats = job->js_jobstats;
+
+	if (READ_ONCE(stats->ojs_ring) == NULL || !list_empty(&job->js_dirty))
+		return;
+
+	spin_lock(&stats->ojs_dirty_lock);
+	if (list_empty(&job->js_dirty)) {
+		atomic_inc(&job->js_refcount);
+		list_add_tail(&job->js_dirty, &stats->ojs_dirty);
+	}
+	spin_unlock(&stats->ojs_dirty_lock);
+}
+
 static void job_stat_put_locked(struct cfs_hash *hs, struct hlist_node *hnode)
 {
 	struct job_stat *job;
@@ -167,8 +202,10 @@ static int job_cleanup_iter_callback(struct cfs_hash *hs,
 	struct job_stat *job;
 
 	job = hlist_entry(hnode, struct job_stat, js_hash);
-	if (ktime_before(job->js_time_latest, oldest_time))
+	if (ktime_before(job->js_time_latest, oldest_time)) {
+		job_stat_dirty(job);
 		cfs_hash_bd_del_locked(hs, bd, hnode);
+	}
 
 	return 0;
 }
@@ -246,7 +283,8 @@ static void lprocfs_job_cleanup(struct obd_job_stats *stats, bool clear)
 	write_unlock(&stats->ojs_lock);
 }
 
-static struct job_stat *job_alloc(char *jobid, struct obd_job_stats *jobs)
+static struct job_stat *job_alloc(const char *jobid,
+				  struct obd_job_stats *jobs)
 {
 	struct job_stat *job;
 
@@ -254,29 +292,52 @@ static struct job_stat *job_alloc(char *jobid, struct obd_job_stats *jobs)
 	if (job == NULL)
 		return NULL;
 
-	job->js_stats = lprocfs_alloc_stats(jobs->ojs_cntr_num, 0);
+	/* the histograms of a job are not worth per-CPU copies */
+	job->js_stats = lprocfs_alloc_stats(jobs->ojs_cntr_num,
+					    LPROCFS_STATS_FLAG_NOHIST);
 	if (job->js_stats == NULL) {
 		OBD_FREE_PTR(job);
 		return NULL;
 	}
 
+	if (jobs->ojs_hist_num > 0) {
+		OBD_ALLOC_PTR_ARRAY(job->js_hist, jobs->ojs_hist_num *
+						  LPROCFS_HIST_BUCKETS);
+		if (job->js_hist == NULL) {
+			lprocfs_free_stats(&job->js_stats);
+			OBD_FREE_PTR(job);
+			return NULL;
+		}
+	}
+
 	jobs->ojs_cntr_init_fn(job->js_stats, 0);
 
-	memcpy(job->js_jobid, jobid, sizeof(job->js_jobid));
+	strlcpy(job->js_jobid, jobid, sizeof(job->js_jobid));
 	job->js_time_init = ktime_get();
 	job->js_time_latest = job->js_time_init;
 	job->js_jobstats = jobs;
 	INIT_HLIST_NODE(&job->js_hash);
 	INIT_LIST_HEAD(&job->js_list);
+	INIT_LIST_HEAD(&job->js_dirty);
 	atomic_set(&job->js_refcount, 1);
 
 	return job;
 }
 
-int lprocfs_job_stats_log(struct obd_device *obd, char *jobid,
+/**
+ * Account \a amount to counter \a event of job \a jobid.
+ *
+ * \param[in] stats	job stats set up by lprocfs_job_stats_register()
+ * \param[in] jobid	jobid of the request or process
+ * \param[in] event	counter index, less than the number of counters
+ * \param[in] amount	value to add to the counter
+ *
+ * \retval		0 on success
+ * \retval		negative errno on failure
+ */
+int lprocfs_job_stats_add(struct obd_job_stats *stats, const char *jobid,
 			  int event, long amount)
 {
-	struct obd_job_stats *stats = &obd->u.obt.obt_jobstats;
 	struct job_stat *job, *job2;
 	ENTRY;
 
@@ -326,26 +387,395 @@ found:
 	LASSERT(stats == job->js_jobstats);
 	job->js_time_latest = ktime_get();
 	lprocfs_counter_add(job->js_stats, event, amount);
+	if (stats->ojs_hist_idx[event] != OJS_NO_HIST)
+		atomic_inc(&job->js_hist[stats->ojs_hist_idx[event] *
+					 LPROCFS_HIST_BUCKETS +
+					 lprocfs_hist_bucket(amount)]);
+	job_stat_dirty(job);
 
 	job_putref(job);
 
 	RETURN(0);
 }
-EXPORT_SYMBOL(lprocfs_job_stats_log);
+EXPORT_SYMBOL(lprocfs_job_stats_add);
 
-void lprocfs_job_stats_fini(struct obd_device *obd)
+/*
+ * Binary export of the job stats, see lustre_jobstats.h for the layout.
+ *
+ * The ring is allocated when job_stats_ring is first opened and stays until
+ * the job stats are unregistered, or the last mapping of it goes away.  All
+ * the jobs are queued for publishing when it is allocated, after that only
+ * the ones updated, expired or cleared since they were last published.
+ */
+#define JOBSTATS_RING_RECORDS	1024	/* must be a power of two */
+
+struct job_stats_ring {
+	struct kref			 jsr_ref;	/* ojs_ring + mappings */
+	struct jobstats_ring_header	*jsr_hdr;	/* vmalloc_user() */
+	size_t				 jsr_size;
+	/* copies of the layout, the mapped header may be scribbled on */
+	unsigned int			 jsr_header_size;
+	unsigned int			 jsr_record_size;
+	unsigned int			 jsr_nrecords;
+	unsigned int			 jsr_ncounters;
+	unsigned int			 jsr_nhists;
+	__u64				 jsr_head;
+};
+
+static void jobstats_ring_free(struct kref *kref)
+{
+	struct job_stats_ring *ring = container_of(kref, struct job_stats_ring,
+						   jsr_ref);
+
+	vfree(ring->jsr_hdr);
+	OBD_FREE_PTR(ring);
+}
+
+static struct job_stats_ring *jobstats_ring_alloc(struct obd_job_stats *stats)
+{
+	struct jobstats_ring_header *hdr;
+	struct job_stats_ring *ring;
+	struct lprocfs_stats *tmpl;
+	int i;
+
+	/* for the names and units of the counters */
+	tmpl = lprocfs_alloc_stats(stats->ojs_cntr_num,
+				   LPROCFS_STATS_FLAG_NOHIST);
+	if (tmpl == NULL)
+		return ERR_PTR(-ENOMEM);
+	stats->ojs_cntr_init_fn(tmpl, 0);
+
+	OBD_ALLOC_PTR(ring);
+	if (ring == NULL) {
+		lprocfs_free_stats(&tmpl);
+		return ERR_PTR(-ENOMEM);
+	}
+
+	kref_init(&ring->jsr_ref);
+	ring->jsr_ncounters = stats->ojs_cntr_num;
+	ring->jsr_nhists = stats->ojs_hist_num;
+	ring->jsr_nrecords = JOBSTATS_RING_RECORDS;
+	ring->jsr_header_size = round_up(sizeof(*hdr) + ring->jsr_ncounters *
+					 sizeof(hdr->jrh_counters[0]), 64);
+	ring->jsr_record_size = sizeof(struct jobstats_ring_record) +
+				ring->jsr_ncounters *
+				sizeof(struct jobstats_ring_counter) +
+				ring->jsr_nhists *
+				sizeof(struct jobstats_ring_hist);
+	ring->jsr_size = PAGE_ALIGN(ring->jsr_header_size +
+				    (size_t)ring->jsr_nrecords *
+				    ring->jsr_record_size);
+
+	/* zeroed, and suitable for remap_vmalloc_range() */
+	hdr = vmalloc_user(ring->jsr_size);
+	if (hdr == NULL) {
+		OBD_FREE_PTR(ring);
+		lprocfs_free_stats(&tmpl);
+		return ERR_PTR(-ENOMEM);
+	}
+	ring->jsr_hdr = hdr;
+
+	hdr->jrh_magic = JOBSTATS_RING_MAGIC;
+	hdr->jrh_version = JOBSTATS_RING_VERSION;
+	hdr->jrh_header_size = ring->jsr_header_size;
+	hdr->jrh_record_size = ring->jsr_record_size;
+	hdr->jrh_nrecords = ring->jsr_nrecords;
+	hdr->jrh_ncounters = ring->jsr_ncounters;
+	hdr->jrh_nhists = ring->jsr_nhists;
+	hdr->jrh_hist_buckets = JOBSTATS_RING_HIST_BUCKETS;
+	for (i = 0; i < ring->jsr_ncounters; i++) {
+		struct lprocfs_counter_header *header = &tmpl->ls_cnt_header[i];
+		struct jobstats_ring_counter_desc *desc = &hdr->jrh_counters[i];
+
+		strlcpy(desc->jcd_name, header->lc_name,
+			sizeof(desc->jcd_name));
+		if (header->lc_units != NULL)
+			strlcpy(desc->jcd_units, header->lc_units,
+				sizeof(desc->jcd_units));
+		desc->jcd_config = header->lc_config;
+		desc->jcd_hist = stats->ojs_hist_idx[i] == OJS_NO_HIST ?
+				 JOBSTATS_RING_NO_HIST : stats->ojs_hist_idx[i];
+	}
+	lprocfs_free_stats(&tmpl);
+
+	return ring;
+}
+
+static void jobstats_ring_put(struct job_stats_ring *ring)
 {
-	struct obd_job_stats *stats = &obd->u.obt.obt_jobstats;
+	kref_put(&ring->jsr_ref, jobstats_ring_free);
+}
+
+static void jobstats_ring_fill(struct job_stats_ring *ring, __u64 index,
+			       struct job_stat *job)
+{
+	struct jobstats_ring_record *rec;
+	struct jobstats_ring_hist *hist;
+	struct lprocfs_counter ret;
+	int i, j;
+
+	BUILD_BUG_ON(JOBSTATS_RING_HIST_BUCKETS != LPROCFS_HIST_BUCKETS);
+
+	rec = (void *)ring->jsr_hdr + ring->jsr_header_size +
+	      (index & (ring->jsr_nrecords - 1)) * ring->jsr_record_size;
+	memset(rec, 0, ring->jsr_record_size);
+
+	strlcpy(rec->jrr_jobid, job->js_jobid, sizeof(rec->jrr_jobid));
+	rec->jrr_start_ns = ktime_to_ns(job->js_time_init);
+	rec->jrr_latest_ns = ktime_to_ns(job->js_time_latest);
+	rec->jrr_snapshot_ns = ktime_get_ns();
+	/* jobs are never hashed again once removed */
+	if (hlist_unhashed(&job->js_hash))
+		rec->jrr_flags |= JRR_F_REMOVED;
+
+	for (i = 0; i < ring->jsr_ncounters; i++) {
+		struct jobstats_ring_counter *cntr = &rec->jrr_counters[i];
+
+		lprocfs_stats_collect(job->js_stats, i, &ret);
+		cntr->jrc_count = ret.lc_count;
+		if (ret.lc_count == 0)
+			continue;
+		cntr->jrc_min = ret.lc_min;
+		cntr->jrc_max = ret.lc_max;
+		cntr->jrc_sum = ret.lc_sum;
+		cntr->jrc_sumsq = ret.lc_sumsquare;
+	}
+
+	/* jobs and the ring are both sized from ojs_hist_num */
+	hist = (void *)&rec->jrr_counters[ring->jsr_ncounters];
+	for (i = 0; i < ring->jsr_nhists; i++)
+		for (j = 0; j < JOBSTATS_RING_HIST_BUCKETS; j++)
+			hist[i].jrhi_buckets[j] = atomic_read(
+				&job->js_hist[i * LPROCFS_HIST_BUCKETS + j]);
+}
+
+/**
+ * Publish the queued jobs to the ring, as long as there are free slots.
+ *
+ * Called with ojs_ring_mutex held.
+ *
+ * \retval		number of records published
+ */
+static int jobstats_ring_publish(struct obd_job_stats *stats)
+{
+	struct job_stats_ring *ring = stats->ojs_ring;
+	struct jobstats_ring_header *hdr = ring->jsr_hdr;
+	__u64 head = ring->jsr_head;
+	struct job_stat *job;
+	LIST_HEAD(pending);
+	int published = 0;
+	int deferred = 0;
+	__u64 tail;
+
+	/* the collector is done with the records before it moves the tail */
+	tail = READ_ONCE(hdr->jrh_tail);
+	smp_mb();
+	if (tail > head || head - tail > ring->jsr_nrecords)
+		tail = head;
+
+	spin_lock(&stats->ojs_dirty_lock);
+	list_splice_init(&stats->ojs_dirty, &pending);
+	spin_unlock(&stats->ojs_dirty_lock);
+
+	while (!list_empty(&pending) && head - tail < ring->jsr_nrecords) {
+		job = list_entry(pending.next, struct job_stat, js_dirty);
+
+		/* dequeue first, so that later updates queue it again */
+		spin_lock(&stats->ojs_dirty_lock);
+		list_del_init(&job->js_dirty);
+		spin_unlock(&stats->ojs_dirty_lock);
+
+		jobstats_ring_fill(ring, head++, job);
+		job_putref(job);
+		published++;
+	}
+
+	if (!list_empty(&pending)) {
+		list_for_each_entry(job, &pending, js_dirty)
+			deferred++;
+		spin_lock(&stats->ojs_dirty_lock);
+		list_splice(&pending, &stats->ojs_dirty);
+		spin_unlock(&stats->ojs_dirty_lock);
+		hdr->jrh_deferred += deferred;
+	}
+
+	/* the records are complete before the collector can see them */
+	smp_wmb();
+	ring->jsr_head = head;
+	WRITE_ONCE(hdr->jrh_head, head);
+
+	return published;
+}
+
+/* Drop the jobs queued for publishing, once the ring is gone */
+static void jobstats_dirty_drain(struct obd_job_stats *stats)
+{
+	struct job_stat *job;
+	LIST_HEAD(pending);
+
+	spin_lock(&stats->ojs_dirty_lock);
+	list_splice_init(&stats->ojs_dirty, &pending);
+	spin_unlock(&stats->ojs_dirty_lock);
+
+	while (!list_empty(&pending)) {
+		job = list_entry(pending.next, struct job_stat, js_dirty);
+		list_del_init(&job->js_dirty);
+		job_putref(job);
+	}
+}
+
+static int lprocfs_jobstats_ring_open(struct inode *inode, struct file *file)
+{
+	struct obd_job_stats *stats = PDE_DATA(inode);
+	struct job_stats_ring *ring;
+	struct job_stat *job;
+	int rc = 0;
+
+	if (stats->ojs_hash == NULL)
+		return -ENODEV;
+
+	mutex_lock(&stats->ojs_ring_mutex);
+	if (stats->ojs_ring == NULL) {
+		ring = jobstats_ring_alloc(stats);
+		if (IS_ERR(ring)) {
+			rc = PTR_ERR(ring);
+			goto out;
+		}
+		WRITE_ONCE(stats->ojs_ring, ring);
+
+		/* the first records are a full snapshot */
+		read_lock(&stats->ojs_lock);
+		spin_lock(&stats->ojs_dirty_lock);
+		list_for_each_entry(job, &stats->ojs_list, js_list) {
+			/* may be waiting for ojs_lock in job_free() */
+			if (!list_empty(&job->js_dirty) ||
+			    !atomic_inc_not_zero(&job->js_refcount))
+				continue;
+			list_add_tail(&job->js_dirty, &stats->ojs_dirty);
+		}
+		spin_unlock(&stats->ojs_dirty_lock);
+		read_unlock(&stats->ojs_lock);
+	}
+	file->private_data = stats;
+out:
+	mutex_unlock(&stats->ojs_ring_mutex);
+
+	return rc;
+}
+
+static ssize_t lprocfs_jobstats_ring_write(struct file *file,
+					   const char __user *buf,
+					   size_t len, loff_t *off)
+{
+	struct obd_job_stats *stats = file->private_data;
+	char kernbuf[8];
+
+	if (len == 0 || len >= sizeof(kernbuf))
+		return -EINVAL;
+
+	if (copy_from_user(kernbuf, buf, len))
+		return -EFAULT;
+	kernbuf[len] = 0;
+
+	if (strcmp(kernbuf, "sync") != 0 && strcmp(kernbuf, "sync\n") != 0)
+		return -EINVAL;
+
+	mutex_lock(&stats->ojs_ring_mutex);
+	if (stats->ojs_ring == NULL) {
+		mutex_unlock(&stats->ojs_ring_mutex);
+		return -ENODEV;
+	}
+	jobstats_ring_publish(stats);
+	mutex_unlock(&stats->ojs_ring_mutex);
+
+	return len;
+}
+
+static void lprocfs_jobstats_ring_vm_open(struct vm_area_struct *vma)
+{
+	struct job_stats_ring *ring = vma->vm_private_data;
+
+	kref_get(&ring->jsr_ref);
+}
+
+static void lprocfs_jobstats_ring_vm_close(struct vm_area_struct *vma)
+{
+	jobstats_ring_put(vma->vm_private_data);
+}
+
+static const struct vm_operations_struct lprocfs_jobstats_ring_vm_ops = {
+	.open	= lprocfs_jobstats_ring_vm_open,
+	.close	= lprocfs_jobstats_ring_vm_close,
+};
+
+static int lprocfs_jobstats_ring_mmap(struct file *file,
+				      struct vm_area_struct *vma)
+{
+	struct obd_job_stats *stats = file->private_data;
+	struct job_stats_ring *ring;
+	int rc;
+
+	if (vma->vm_pgoff != 0)
+		return -EINVAL;
+
+	mutex_lock(&stats->ojs_ring_mutex);
+	ring = stats->ojs_ring;
+	if (ring == NULL)
+		GOTO(out, rc = -ENODEV);
+
+	if (vma->vm_end - vma->vm_start > ring->jsr_size)
+		GOTO(out, rc = -EINVAL);
+
+	rc = remap_vmalloc_range(vma, ring->jsr_hdr, 0);
+	if (rc)
+		GOTO(out, rc);
+
+	kref_get(&ring->jsr_ref);
+	vma->vm_private_data = ring;
+	vma->vm_ops = &lprocfs_jobstats_ring_vm_ops;
+out:
+	mutex_unlock(&stats->ojs_ring_mutex);
+
+	return rc;
+}
+
+static const struct proc_ops lprocfs_jobstats_ring_fops = {
+	PROC_OWNER(THIS_MODULE)
+	.proc_open	= lprocfs_jobstats_ring_open,
+	.proc_write	= lprocfs_jobstats_ring_write,
+	.proc_mmap	= lprocfs_jobstats_ring_mmap,
+};
+
+/**
+ * Stop tracking job stats, and free all of them.
+ *
+ * \param[in] stats	job stats set up by lprocfs_job_stats_register()
+ */
+void lprocfs_job_stats_unregister(struct obd_job_stats *stats)
+{
+	struct job_stats_ring *ring;
 
 	if (stats->ojs_hash == NULL)
 		return;
 
+	mutex_lock(&stats->ojs_ring_mutex);
+	ring = stats->ojs_ring;
+	WRITE_ONCE(stats->ojs_ring, NULL);
+	mutex_unlock(&stats->ojs_ring_mutex);
+
 	lprocfs_job_cleanup(stats, true);
+	jobstats_dirty_drain(stats);
+	if (ring != NULL)
+		jobstats_ring_put(ring);
+
 	cfs_hash_putref(stats->ojs_hash);
 	stats->ojs_hash = NULL;
 	LASSERT(list_empty(&stats->ojs_list));
+
+	OBD_FREE_PTR_ARRAY(stats->ojs_hist_idx, stats->ojs_cntr_num);
+	stats->ojs_hist_idx = NULL;
 }
-EXPORT_SYMBOL(lprocfs_job_stats_fini);
+EXPORT_SYMBOL(lprocfs_job_stats_unregister);
 
 static void *lprocfs_jobstats_seq_start(struct seq_file *p, loff_t *pos)
 {
@@ -421,6 +851,11 @@ static void *lprocfs_jobstats_seq_next(struct seq_file *p, void *v, loff_t *pos)
  *   elapsed_time:  9.135802468
  *   read:          { samples: 0, unit: bytes, min:  0, max:  0, sum:  0 }
  *   write:         { samples: 1, unit: bytes, min: 4096, max: 4096, sum: 4096 }
+ *
+ * Counters set up with LPROCFS_CNTR_HISTOGRAM also have their histogram,
+ * each bucket counts the samples from its key to twice its key:
+ *
+ *   write:         { samples: 2, ..., hist: { 256: 1, 512: 1 } }
  *   setattr:       { samples: 0, unit: reqs }
  *   punch:         { samples: 0, unit: reqs }
  *   sync:          { samples: 0, unit: reqs }
@@ -439,7 +874,10 @@ static int lprocfs_jobstats_seq_show(struct seq_file *p, void *v)
 	struct lprocfs_stats *s;
 	struct lprocfs_counter ret;
 	struct lprocfs_counter_header *cntr_header;
-	int i;
+	struct obd_job_stats *stats;
+	atomic_t *hist;
+	int first;
+	int i, j;
 
 	if (v == SEQ_START_TOKEN) {
 		seq_printf(p, "job_stats:\n");
@@ -461,6 +899,7 @@ static int lprocfs_jobstats_seq_show(struct seq_file *p, void *v)
 			     ":", true);
 
 	s = job->js_stats;
+	stats = job->js_jobstats;
 	for (i = 0; i < s->ls_num; i++) {
 		cntr_header = &s->ls_cnt_header[i];
 		lprocfs_stats_collect(s, i, &ret);
@@ -482,6 +921,21 @@ static int lprocfs_jobstats_seq_show(struct seq_file *p, void *v)
 			seq_printf(p, ", sumsq: %18llu",
 				   ret.lc_count ? ret.lc_sumsquare : 0);
 		}
+		if (stats->ojs_hist_idx[i] != OJS_NO_HIST && ret.lc_count) {
+			hist = &job->js_hist[stats->ojs_hist_idx[i] *
+					     LPROCFS_HIST_BUCKETS];
+			first = 1;
+			seq_puts(p, ", hist: {");
+			for (j = 0; j < LPROCFS_HIST_BUCKETS; j++) {
+				if (!atomic_read(&hist[j]))
+					continue;
+				seq_printf(p, "%s %llu: %d", first ? "" : ",",
+					   j == 0 ? 0 : 1ULL << (j - 1),
+					   atomic_read(&hist[j]));
+				first = 0;
+			}
+			seq_puts(p, " }");
+		}
 
 		seq_printf(p, " }\n");
 
@@ -545,6 +999,7 @@ static ssize_t lprocfs_jobstats_seq_write(struct file *file,
 	if (!job)
 		return -EINVAL;
 
+	job_stat_dirty(job);
 	cfs_hash_del_key(stats->ojs_hash, jobid);
 
 	job_putref(job);
@@ -582,30 +1037,51 @@ static const struct proc_ops lprocfs_jobstats_seq_fops = {
 	.proc_release	= lprocfs_jobstats_seq_release,
 };
 
-int lprocfs_job_stats_init(struct obd_device *obd, int cntr_num,
-			   cntr_init_callback init_fn)
+/**
+ * Set up per-job statistics, and their "job_stats" and "job_stats_ring"
+ * files under \a parent.
+ *
+ * \param[in] stats	job stats to set up
+ * \param[in] parent	proc directory of the files
+ * \param[in] cntr_num	number of counters of each job
+ * \param[in] init_fn	initializes the counters of each job
+ *
+ * \retval		0 on success
+ * \retval		negative errno on failure
+ */
+int lprocfs_job_stats_register(struct obd_job_stats *stats,
+			       struct proc_dir_entry *parent, int cntr_num,
+			       cntr_init_callback init_fn)
 {
+	struct lprocfs_stats *tmpl;
 	struct proc_dir_entry *entry;
-	struct obd_job_stats *stats;
+	int i;
 	ENTRY;
 
-	LASSERT(obd->obd_proc_entry != NULL);
-	LASSERT(obd->obd_type->typ_name);
-
 	if (cntr_num <= 0)
 		RETURN(-EINVAL);
 
 	if (init_fn == NULL)
 		RETURN(-EINVAL);
 
-	/* Currently needs to be a target due to the use of obt_jobstats. */
-	if (strcmp(obd->obd_type->typ_name, LUSTRE_MDT_NAME) != 0 &&
-	    strcmp(obd->obd_type->typ_name, LUSTRE_OST_NAME) != 0) {
-		CERROR("%s: invalid device type %s for job stats: rc = %d\n",
-		       obd->obd_name, obd->obd_type->typ_name, -EINVAL);
-		RETURN(-EINVAL);
+	/* number the counters which want a per-job histogram */
+	tmpl = lprocfs_alloc_stats(cntr_num, LPROCFS_STATS_FLAG_NOHIST);
+	if (tmpl == NULL)
+		RETURN(-ENOMEM);
+	init_fn(tmpl, 0);
+
+	OBD_ALLOC_PTR_ARRAY(stats->ojs_hist_idx, cntr_num);
+	if (stats->ojs_hist_idx == NULL) {
+		lprocfs_free_stats(&tmpl);
+		RETURN(-ENOMEM);
 	}
-	stats = &obd->u.obt.obt_jobstats;
+	stats->ojs_hist_num = 0;
+	for (i = 0; i < cntr_num; i++)
+		stats->ojs_hist_idx[i] =
+			tmpl->ls_cnt_header[i].lc_config &
+			LPROCFS_CNTR_HISTOGRAM ?
+			stats->ojs_hist_num++ : OJS_NO_HIST;
+	lprocfs_free_stats(&tmpl);
 
 	LASSERT(stats->ojs_hash == NULL);
 	stats->ojs_hash = cfs_hash_create("JOB_STATS",
@@ -616,11 +1092,18 @@ int lprocfs_job_stats_init(struct obd_device *obd, int cntr_num,
 					  CFS_HASH_MAX_THETA,
 					  &job_stats_hash_ops,
 					  CFS_HASH_DEFAULT);
-	if (stats->ojs_hash == NULL)
+	if (stats->ojs_hash == NULL) {
+		OBD_FREE_PTR_ARRAY(stats->ojs_hist_idx, cntr_num);
+		stats->ojs_hist_idx = NULL;
 		RETURN(-ENOMEM);
+	}
 
 	INIT_LIST_HEAD(&stats->ojs_list);
 	rwlock_init(&stats->ojs_lock);
+	INIT_LIST_HEAD(&stats->ojs_dirty);
+	spin_lock_init(&stats->ojs_dirty_lock);
+	mutex_init(&stats->ojs_ring_mutex);
+	stats->ojs_ring = NULL;
 	stats->ojs_cntr_num = cntr_num;
 	stats->ojs_cntr_init_fn = init_fn;
 	/* Store 1/2 the actual interval, since we use that the most, and
@@ -629,17 +1112,65 @@ int lprocfs_job_stats_init(struct obd_device *obd, int cntr_num,
 	stats->ojs_cleanup_interval = ktime_set(600 / 2, 0); /* default 10 min*/
 	stats->ojs_cleanup_last = ktime_get();
 
-	entry = lprocfs_add_simple(obd->obd_proc_entry, "job_stats", stats,
+	entry = lprocfs_add_simple(parent, "job_stats", stats,
 				   &lprocfs_jobstats_seq_fops);
 	if (IS_ERR(entry)) {
-		lprocfs_job_stats_fini(obd);
+		lprocfs_job_stats_unregister(stats);
+		RETURN(-ENOMEM);
+	}
+
+	/* mmap needs read access, but there is nothing to read() */
+	entry = proc_create_data("job_stats_ring", 0600, parent,
+				 &lprocfs_jobstats_ring_fops, stats);
+	if (entry == NULL) {
+		remove_proc_entry("job_stats", parent);
+		lprocfs_job_stats_unregister(stats);
 		RETURN(-ENOMEM);
 	}
 	RETURN(0);
 }
+EXPORT_SYMBOL(lprocfs_job_stats_register);
+
+#ifdef HAVE_SERVER_SUPPORT
+int lprocfs_job_stats_log(struct obd_device *obd, char *jobid,
+			  int event, long amount)
+{
+	return lprocfs_job_stats_add(&obd->u.obt.obt_jobstats, jobid, event,
+				     amount);
+}
+EXPORT_SYMBOL(lprocfs_job_stats_log);
+
+void lprocfs_job_stats_fini(struct obd_device *obd)
+{
+	lprocfs_job_stats_unregister(&obd->u.obt.obt_jobstats);
+}
+EXPORT_SYMBOL(lprocfs_job_stats_fini);
+
+int lprocfs_job_stats_init(struct obd_device *obd, int cntr_num,
+			   cntr_init_callback init_fn)
+{
+	ENTRY;
+
+	LASSERT(obd->obd_proc_entry != NULL);
+	LASSERT(obd->obd_type->typ_name);
+
+	/* Currently needs to be a target due to the use of obt_jobstats. */
+	if (strcmp(obd->obd_type->typ_name, LUSTRE_MDT_NAME) != 0 &&
+	    strcmp(obd->obd_type->typ_name, LUSTRE_OST_NAME) != 0) {
+		CERROR("%s: invalid device type %s for job stats: rc = %d\n",
+		       obd->obd_name, obd->obd_type->typ_name, -EINVAL);
+		RETURN(-EINVAL);
+	}
+
+	RETURN(lprocfs_job_stats_register(&obd->u.obt.obt_jobstats,
+					  obd->obd_proc_entry, cntr_num,
+					  init_fn));
+}
 EXPORT_SYMBOL(lprocfs_job_stats_init);
+#endif /* HAVE_SERVER_SUPPORT */
 #endif /* CONFIG_PROC_FS*/
 
+#ifdef HAVE_SERVER_SUPPORT
 ssize_t job_cleanup_interval_show(struct kobject *kobj, struct attribute *attr,
 				  char *buf)
 {
@@ -677,3 +1208,4 @@ ssize_t job_cleanup_interval_store(struct kobject *kobj,
 	return count;
 }
 EXPORT_SYMBOL(job_cleanup_interval_store);
+#endif /* HAVE_SERVER_SUPPORT */
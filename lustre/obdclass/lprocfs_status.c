@@ -534,6 +534,38 @@ void lprocfs_stats_collect(struct lprocfs_stats *stats, int idx,
 	lprocfs_stats_unlock(stats, LPROCFS_GET_NUM_CPU, &flags);
 }
 
+/** add up the per-cpu histograms of an LPROCFS_CNTR_HISTOGRAM counter */
+void lprocfs_stats_collect_hist(struct lprocfs_stats *stats, int idx,
+				struct lprocfs_counter_hist *hist)
+{
+	struct lprocfs_counter_hist __percpu *percpu_hist;
+	int cpu;
+	int i;
+
+	memset(hist, 0, sizeof(*hist));
+
+	percpu_hist = stats->ls_cnt_header[idx].lc_hist;
+	if (!percpu_hist)
+		return;
+
+	for_each_possible_cpu(cpu) {
+		struct lprocfs_counter_hist *cpu_hist;
+
+		cpu_hist = per_cpu_ptr(percpu_hist, cpu);
+		for (i = 0; i < LPROCFS_HIST_BUCKETS; i++)
+			hist->lh_buckets[i] += cpu_hist->lh_buckets[i];
+	}
+}
+EXPORT_SYMBOL(lprocfs_stats_collect_hist);
+
+static void lprocfs_hist_clear(struct lprocfs_counter_hist __percpu *hist)
+{
+	int cpu;
+
+	for_each_possible_cpu(cpu)
+		memset(per_cpu_ptr(hist, cpu), 0, sizeof(*hist));
+}
+
 static void obd_import_flags2str(struct obd_import *imp, struct seq_file *m)
 {
 	bool first = true;
@@ -648,6 +680,17 @@ static const char *const obd_connect_names[] = {
 	"mne_nid_type",		/* 0x1000000 */
 	"lock_contend",		/* 0x2000000 */
 	"atomic_open_lock",	/* 0x4000000 */
+	"name_encryption",	/* 0x8000000 */
+	"dmv_imp_inherit",	/* 0x10000000 */
+	"encryption_fid2path",	/* 0x20000000 */
+	"replay_create",	/* 0x40000000 */
+	"large_nid",		/* 0x80000000 */
+	"compressed_file",	/* 0x100000000 */
+	"unaligned_dio",	/* 0x200000000 */
+	"conn_policy",		/* 0x400000000 */
+	"wire_compress",	/* 0x800000000 */
+	"readdir_plus",		/* 0x1000000000 */
+	"msg_batch",		/* 0x2000000000 */
 	NULL
 };
 
@@ -1269,8 +1312,12 @@ void lprocfs_free_stats(struct lprocfs_stats **statsh)
 	for (i = 0; i < num_entry; i++)
 		if (stats->ls_percpu[i])
 			LIBCFS_FREE(stats->ls_percpu[i], percpusize);
-	if (stats->ls_cnt_header)
+	if (stats->ls_cnt_header) {
+		for (i = 0; i < stats->ls_num; i++)
+			if (stats->ls_cnt_header[i].lc_hist)
+				free_percpu(stats->ls_cnt_header[i].lc_hist);
 		CFS_FREE_PTR_ARRAY(stats->ls_cnt_header, stats->ls_num);
+	}
 	LIBCFS_FREE(stats, offsetof(typeof(*stats), ls_percpu[num_entry]));
 }
 EXPORT_SYMBOL(lprocfs_free_stats);
@@ -1327,6 +1374,10 @@ void lprocfs_clear_stats(struct lprocfs_stats *stats)
 	}
 
 	lprocfs_stats_unlock(stats, LPROCFS_GET_NUM_CPU, &flags);
+
+	for (j = 0; j < stats->ls_num; j++)
+		if (stats->ls_cnt_header[j].lc_hist)
+			lprocfs_hist_clear(stats->ls_cnt_header[j].lc_hist);
 }
 EXPORT_SYMBOL(lprocfs_clear_stats);
 
@@ -1461,6 +1512,146 @@ int lprocfs_register_stats(struct proc_dir_entry *root, const char *name,
 }
 EXPORT_SYMBOL(lprocfs_register_stats);
 
+/*
+ * Percentile of the samples of a histogram, as the upper bound of the bucket
+ * holding it, \a permille is in 1/1000
+ */
+static __u64 lprocfs_hist_percentile(struct lprocfs_counter_hist *hist,
+				     __u64 count, unsigned int permille)
+{
+	__u64 rank = div_u64(count * permille + 999, 1000);
+	__u64 cum = 0;
+	int i;
+
+	for (i = 0; i < LPROCFS_HIST_BUCKETS - 1; i++) {
+		cum += hist->lh_buckets[i];
+		if (cum >= rank)
+			break;
+	}
+
+	return i == 0 ? 0 : 1ULL << i;
+}
+
+/*
+ * Example of output:
+ *
+ * snapshot_time:            1322494486.123456789 secs.nsecs
+ * start_time:               1322494476.012345678 secs.nsecs
+ * elapsed_time:             10.111111111 secs.nsecs
+ * req_waittime:
+ *   unit:    usec
+ *   samples: 1000
+ *   p50:     64
+ *   p90:     256
+ *   p99:     2048
+ *   p99.9:   8192
+ *   hist:    { 16: 12, 32: 300, 64: 400, 128: 200, 1024: 80, 4096: 8 }
+ *
+ * The percentiles are upper bounds, each bucket of the histogram counts
+ * the samples from its key to twice its key.
+ */
+static int lprocfs_stats_hist_seq_show(struct seq_file *p, void *v)
+{
+	static const struct {
+		const char	*name;
+		unsigned int	 permille;
+	} pcts[] = {
+		{ "p50:",	500 },
+		{ "p90:",	900 },
+		{ "p99:",	990 },
+		{ "p99.9:",	999 },
+	};
+	struct lprocfs_stats *stats = p->private;
+	struct lprocfs_counter_header *hdr;
+	struct lprocfs_counter_hist hist;
+	int first, last;
+	__u64 count;
+	int idx;
+	int i;
+
+	lprocfs_stats_header(p, ktime_get(), stats->ls_init, 25, ":", true);
+
+	for (idx = 0; idx < stats->ls_num; idx++) {
+		hdr = &stats->ls_cnt_header[idx];
+		if (!(hdr->lc_config & LPROCFS_CNTR_HISTOGRAM))
+			continue;
+
+		lprocfs_stats_collect_hist(stats, idx, &hist);
+		count = 0;
+		first = -1;
+		last = 0;
+		for (i = 0; i < LPROCFS_HIST_BUCKETS; i++) {
+			if (!hist.lh_buckets[i])
+				continue;
+			count += hist.lh_buckets[i];
+			if (first < 0)
+				first = i;
+			last = i;
+		}
+		if (count == 0)
+			continue;
+
+		seq_printf(p, "%s:\n  %-8s %s\n  %-8s %llu\n", hdr->lc_name,
+			   "unit:", hdr->lc_units, "samples:", count);
+		for (i = 0; i < ARRAY_SIZE(pcts); i++)
+			seq_printf(p, "  %-8s %llu\n", pcts[i].name,
+				   lprocfs_hist_percentile(&hist, count,
+							   pcts[i].permille));
+		seq_printf(p, "  %-8s {", "hist:");
+		for (i = first; i <= last; i++)
+			seq_printf(p, "%s %llu: %llu", i == first ? "" : ",",
+				   i == 0 ? 0 : 1ULL << (i - 1),
+				   hist.lh_buckets[i]);
+		seq_puts(p, " }\n");
+	}
+
+	return 0;
+}
+
+static int lprocfs_stats_hist_seq_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, lprocfs_stats_hist_seq_show,
+			   inode->i_private ? inode->i_private :
+					      PDE_DATA(inode));
+}
+
+const struct file_operations ldebugfs_stats_hist_seq_fops = {
+	.owner   = THIS_MODULE,
+	.open    = lprocfs_stats_hist_seq_open,
+	.read    = seq_read,
+	.llseek  = seq_lseek,
+	.release = single_release,
+};
+EXPORT_SYMBOL(ldebugfs_stats_hist_seq_fops);
+
+static const struct proc_ops lprocfs_stats_hist_seq_fops = {
+	PROC_OWNER(THIS_MODULE)
+	.proc_open	= lprocfs_stats_hist_seq_open,
+	.proc_read	= seq_read,
+	.proc_lseek	= seq_lseek,
+	.proc_release	= single_release,
+};
+
+/**
+ * Register a read-only file showing the histograms of the
+ * LPROCFS_CNTR_HISTOGRAM counters of \a stats, which are cleared
+ * along with the stats.
+ */
+int lprocfs_register_stats_hist(struct proc_dir_entry *root, const char *name,
+				struct lprocfs_stats *stats)
+{
+	struct proc_dir_entry *entry;
+
+	LASSERT(root != NULL);
+
+	entry = proc_create_data(name, 0444, root,
+				 &lprocfs_stats_hist_seq_fops, stats);
+	if (!entry)
+		return -ENOMEM;
+	return 0;
+}
+EXPORT_SYMBOL(lprocfs_register_stats_hist);
+
 void lprocfs_counter_init(struct lprocfs_stats *stats, int index,
 			  unsigned conf, const char *name, const char *units)
 {
@@ -1476,6 +1667,17 @@ void lprocfs_counter_init(struct lprocfs_stats *stats, int index,
 	LASSERTF(header != NULL, "Failed to allocate stats header:[%d]%s/%s\n",
 		 index, name, units);
 
+	if ((conf & LPROCFS_CNTR_HISTOGRAM) &&
+	    !(stats->ls_flags & LPROCFS_STATS_FLAG_NOHIST)) {
+		if (!header->lc_hist)
+			header->lc_hist =
+				alloc_percpu(struct lprocfs_counter_hist);
+		if (header->lc_hist)
+			lprocfs_hist_clear(header->lc_hist);
+		else
+			conf &= ~LPROCFS_CNTR_HISTOGRAM;
+	}
+
 	header->lc_config = conf;
 	header->lc_name   = name;
 	header->lc_units  = units;
@@ -1513,6 +1715,10 @@ static const char * const mps_stats[] = {
 	[LPROC_MD_GETXATTR]		= "getxattr",
 	[LPROC_MD_INTENT_GETATTR_ASYNC]	= "intent_getattr_async",
 	[LPROC_MD_REVALIDATE_LOCK]	= "revalidate_lock",
+	[LPROC_MD_BATCH_CREATE]		= "batch_create",
+	[LPROC_MD_BATCH_ADD]		= "batch_add",
+	[LPROC_MD_BATCH_FLUSH]		= "batch_flush",
+	[LPROC_MD_BATCH_STOP]		= "batch_stop",
 };
 
 int lprocfs_alloc_md_stats(struct obd_device *obd,
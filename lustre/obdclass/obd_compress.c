@@ -0,0 +1,307 @@
+/*
+ * GPL HEADER START
+ *
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 only,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License version 2 for more details (a copy is included
+ * in the LICENSE file that accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License
+ * version 2 along with this program; If not, see
+ * http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * GPL HEADER END
+ */
+/*
+ * This file is part of Lustre, http://www.lustre.org/
+ *
+ * Compression functions of BRW bulk data, using the acomp API of the
+ * kernel crypto API.
+ *
+ * Only synchronous acomp transforms are used.  A transform and its request
+ * keep working memory and cannot be used by two threads at once, so idle
+ * ones are kept in a per-algorithm pool instead of being allocated for
+ * every chunk.
+ */
+
+#define DEBUG_SUBSYSTEM S_CLASS
+
+#include <linux/crypto.h>
+#include <linux/scatterlist.h>
+#include <linux/vmalloc.h>
+#ifdef HAVE_CRYPTO_ACOMP
+#include <crypto/acompress.h>
+#endif
+#include <obd_class.h>
+#include <obd_compress.h>
+
+#ifdef HAVE_CRYPTO_ACOMP
+/* a chunk buffer not aligned on a page spans one page more */
+#define OBD_COMPR_SG		((LL_COMPR_CHUNK_SIZE >> PAGE_SHIFT) + 1)
+
+struct obd_compr_tfm {
+	struct list_head	 oct_list;
+	struct crypto_acomp	*oct_tfm;
+	struct acomp_req	*oct_req;
+	struct scatterlist	 oct_src[OBD_COMPR_SG];
+	struct scatterlist	 oct_dst[OBD_COMPR_SG];
+};
+
+struct obd_compr_pool {
+	spinlock_t		 ocp_lock;
+	struct list_head	 ocp_idle;
+	int			 ocp_idle_count;
+	/* algorithm is not available in this kernel */
+	bool			 ocp_unsupported;
+};
+
+static struct obd_compr_pool obd_compr_pools[LL_COMPR_TYPE_MAX];
+
+static void obd_compr_tfm_free(struct obd_compr_tfm *oct)
+{
+	if (oct->oct_req)
+		acomp_request_free(oct->oct_req);
+	if (oct->oct_tfm)
+		crypto_free_acomp(oct->oct_tfm);
+	OBD_FREE_PTR(oct);
+}
+
+static struct obd_compr_tfm *obd_compr_tfm_get(enum ll_compr_type type)
+{
+	struct obd_compr_pool *pool;
+	struct obd_compr_tfm *oct;
+	struct crypto_acomp *tfm;
+
+	if (!ll_compr_type_valid(type))
+		return ERR_PTR(-EINVAL);
+
+	pool = &obd_compr_pools[type];
+	if (pool->ocp_unsupported)
+		return ERR_PTR(-EOPNOTSUPP);
+
+	spin_lock(&pool->ocp_lock);
+	oct = list_first_entry_or_null(&pool->ocp_idle, struct obd_compr_tfm,
+				       oct_list);
+	if (oct) {
+		list_del_init(&oct->oct_list);
+		pool->ocp_idle_count--;
+	}
+	spin_unlock(&pool->ocp_lock);
+	if (oct)
+		return oct;
+
+	OBD_ALLOC_PTR(oct);
+	if (!oct)
+		return ERR_PTR(-ENOMEM);
+
+	/* the chunks are (de)compressed inline, not to wait for them */
+	tfm = crypto_alloc_acomp(ll_compr_type2name(type), 0,
+				 CRYPTO_ALG_ASYNC);
+	if (IS_ERR(tfm)) {
+		OBD_FREE_PTR(oct);
+		if (PTR_ERR(tfm) != -ENOENT)
+			return ERR_CAST(tfm);
+
+		CWARN("compression algorithm '%s' is not available\n",
+		      ll_compr_type2name(type));
+		pool->ocp_unsupported = true;
+		return ERR_PTR(-EOPNOTSUPP);
+	}
+	oct->oct_tfm = tfm;
+
+	oct->oct_req = acomp_request_alloc(tfm);
+	if (!oct->oct_req) {
+		obd_compr_tfm_free(oct);
+		return ERR_PTR(-ENOMEM);
+	}
+	acomp_request_set_callback(oct->oct_req, 0, NULL, NULL);
+	INIT_LIST_HEAD(&oct->oct_list);
+
+	return oct;
+}
+
+static void obd_compr_tfm_put(enum ll_compr_type type,
+			      struct obd_compr_tfm *oct)
+{
+	struct obd_compr_pool *pool = &obd_compr_pools[type];
+
+	spin_lock(&pool->ocp_lock);
+	if (pool->ocp_idle_count < num_online_cpus()) {
+		list_add(&oct->oct_list, &pool->ocp_idle);
+		pool->ocp_idle_count++;
+		oct = NULL;
+	}
+	spin_unlock(&pool->ocp_lock);
+
+	if (oct)
+		obd_compr_tfm_free(oct);
+}
+
+/* describe the \a len bytes at \a buf, kmalloc()ed or vmalloc()ed, in \a sg */
+static int obd_compr_sg_init(struct scatterlist *sg, const void *buf,
+			     unsigned int len)
+{
+	const char *ptr = buf;
+	int n = 0;
+
+	if (len == 0)
+		return -EINVAL;
+
+	sg_init_table(sg, OBD_COMPR_SG);
+	while (len > 0) {
+		unsigned int off = offset_in_page(ptr);
+		unsigned int count = min_t(unsigned int, len, PAGE_SIZE - off);
+		struct page *page;
+
+		if (n == OBD_COMPR_SG)
+			return -E2BIG;
+
+		page = is_vmalloc_addr(ptr) ? vmalloc_to_page(ptr) :
+					      virt_to_page(ptr);
+		sg_set_page(&sg[n++], page, count, off);
+		ptr += count;
+		len -= count;
+	}
+	sg_mark_end(&sg[n - 1]);
+
+	return 0;
+}
+
+static int obd_compr_run(enum ll_compr_type type, bool compress,
+			 const void *src, unsigned int src_len, void *dst,
+			 unsigned int *dst_len)
+{
+	struct obd_compr_tfm *oct;
+	int rc;
+
+	oct = obd_compr_tfm_get(type);
+	if (IS_ERR(oct))
+		return PTR_ERR(oct);
+
+	rc = obd_compr_sg_init(oct->oct_src, src, src_len);
+	if (!rc)
+		rc = obd_compr_sg_init(oct->oct_dst, dst, *dst_len);
+	if (rc)
+		GOTO(out, rc);
+
+	acomp_request_set_params(oct->oct_req, oct->oct_src, oct->oct_dst,
+				 src_len, *dst_len);
+	if (compress)
+		rc = crypto_acomp_compress(oct->oct_req);
+	else
+		rc = crypto_acomp_decompress(oct->oct_req);
+	if (!rc)
+		*dst_len = oct->oct_req->dlen;
+out:
+	obd_compr_tfm_put(type, oct);
+
+	return rc;
+}
+
+bool obd_compress_supported(enum ll_compr_type type)
+{
+	struct obd_compr_tfm *oct;
+
+	oct = obd_compr_tfm_get(type);
+	if (IS_ERR(oct))
+		return false;
+
+	obd_compr_tfm_put(type, oct);
+	return true;
+}
+EXPORT_SYMBOL(obd_compress_supported);
+
+/**
+ * Compress \a src_len bytes at \a src into \a dst.
+ *
+ * \param[in,out] dst_len	size of \a dst on input, length of the
+ *				compressed data on output
+ *
+ * \retval 0		on success
+ * \retval negative	if the data cannot be compressed into \a dst_len
+ *			bytes or on other failures, the caller should send
+ *			the data as is
+ */
+int obd_compress_chunk(enum ll_compr_type type, const void *src,
+		       unsigned int src_len, void *dst, unsigned int *dst_len)
+{
+	return obd_compr_run(type, true, src, src_len, dst, dst_len);
+}
+EXPORT_SYMBOL(obd_compress_chunk);
+
+/**
+ * Decompress \a src_len bytes at \a src into \a dst.
+ *
+ * \param[in,out] dst_len	size of \a dst on input, length of the
+ *				decompressed data on output
+ */
+int obd_decompress_chunk(enum ll_compr_type type, const void *src,
+			 unsigned int src_len, void *dst, unsigned int *dst_len)
+{
+	return obd_compr_run(type, false, src, src_len, dst, dst_len);
+}
+EXPORT_SYMBOL(obd_decompress_chunk);
+
+void obd_compress_init(void)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(obd_compr_pools); i++) {
+		spin_lock_init(&obd_compr_pools[i].ocp_lock);
+		INIT_LIST_HEAD(&obd_compr_pools[i].ocp_idle);
+	}
+}
+
+void obd_compress_fini(void)
+{
+	struct obd_compr_tfm *oct;
+	struct obd_compr_tfm *tmp;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(obd_compr_pools); i++) {
+		struct obd_compr_pool *pool = &obd_compr_pools[i];
+
+		list_for_each_entry_safe(oct, tmp, &pool->ocp_idle, oct_list) {
+			list_del(&oct->oct_list);
+			obd_compr_tfm_free(oct);
+		}
+		pool->ocp_idle_count = 0;
+	}
+}
+#else /* !HAVE_CRYPTO_ACOMP */
+/* no compression without the acomp API, the data is sent as is */
+bool obd_compress_supported(enum ll_compr_type type)
+{
+	return false;
+}
+EXPORT_SYMBOL(obd_compress_supported);
+
+int obd_compress_chunk(enum ll_compr_type type, const void *src,
+		       unsigned int src_len, void *dst, unsigned int *dst_len)
+{
+	return -EOPNOTSUPP;
+}
+EXPORT_SYMBOL(obd_compress_chunk);
+
+int obd_decompress_chunk(enum ll_compr_type type, const void *src,
+			 unsigned int src_len, void *dst, unsigned int *dst_len)
+{
+	return -EOPNOTSUPP;
+}
+EXPORT_SYMBOL(obd_decompress_chunk);
+
+void obd_compress_init(void)
+{
+}
+
+void obd_compress_fini(void)
+{
+}
+#endif /* HAVE_CRYPTO_ACOMP */
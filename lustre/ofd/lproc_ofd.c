@@ -1140,6 +1140,7 @@ int ofd_tunables_init(struct ofd_device *ofd)
 	struct obd_device *obd = ofd_obd(ofd);
 	struct proc_dir_entry *entry;
 	int rc = 0;
+	int i;
 
 	ENTRY;
 	/* lprocfs must be setup before the ofd so state can be safely added
@@ -1187,6 +1188,21 @@ int ofd_tunables_init(struct ofd_device *ofd)
 	}
 
 	ofd_stats_counter_init(obd->obd_stats, 0);
+	/* I/O size and time distributions of the whole target, but not per
+	 * export or job, since each histogram is allocated for every CPU
+	 */
+	for (i = LPROC_OFD_STATS_READ_BYTES; i <= LPROC_OFD_STATS_WRITE; i++) {
+		struct lprocfs_counter_header *hdr;
+
+		hdr = &obd->obd_stats->ls_cnt_header[i];
+		lprocfs_counter_init(obd->obd_stats, i,
+				     hdr->lc_config | LPROCFS_CNTR_HISTOGRAM,
+				     hdr->lc_name, hdr->lc_units);
+	}
+	rc = lprocfs_register_stats_hist(obd->obd_proc_entry, "stats_hist",
+					 obd->obd_stats);
+	if (rc)
+		GOTO(obd_free_stats, rc);
 
 	rc = lprocfs_job_stats_init(obd, LPROC_OFD_STATS_LAST,
 				    ofd_stats_counter_init);
@@ -44,6 +44,7 @@
 
 #include "ofd_internal.h"
 #include <obd_cksum.h>
+#include <obd_compress.h>
 #include <uapi/linux/lustre/lustre_ioctl.h>
 #include <lustre_quota.h>
 #include <lustre_lfsck.h>
@@ -275,6 +276,14 @@ static int ofd_parse_connect_data(const struct lu_env *env,
 	if (!ofd->ofd_lut.lut_dt_conf.ddp_has_lseek_data_hole)
 		data->ocd_connect_flags2 &= ~OBD_CONNECT2_LSEEK;
 
+	/* the layout picks the algorithm of compressed writes, they must all
+	 * be available to decompress them
+	 */
+	if (data->ocd_connect_flags2 & OBD_CONNECT2_WIRE_COMPRESS &&
+	    (!obd_compress_supported(LL_COMPR_TYPE_LZ4) ||
+	     !obd_compress_supported(LL_COMPR_TYPE_ZSTD)))
+		data->ocd_connect_flags2 &= ~OBD_CONNECT2_WIRE_COMPRESS;
+
 	RETURN(0);
 }
 
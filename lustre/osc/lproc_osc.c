@@ -130,12 +130,102 @@ static ssize_t max_rpcs_in_flight_store(struct kobject *kobj,
 	spin_lock(&cli->cl_loi_list_lock);
 	cli->cl_max_rpcs_in_flight = val;
 	client_adjust_max_dirty(cli);
+	if (cli->cl_rif.crt_min > val)
+		cli->cl_rif.crt_min = val;
+	if (cli->cl_rif.crt_enabled && cli->cl_rif.crt_window > val)
+		osc_rif_change(cli, val, RIF_BOUNDS);
 	spin_unlock(&cli->cl_loi_list_lock);
 
 	return count;
 }
 LUSTRE_RW_ATTR(max_rpcs_in_flight);
 
+static ssize_t rpcs_in_flight_auto_show(struct kobject *kobj,
+					struct attribute *attr,
+					char *buf)
+{
+	struct obd_device *obd = container_of(kobj, struct obd_device,
+					      obd_kset.kobj);
+
+	return scnprintf(buf, PAGE_SIZE, "%d\n",
+			 obd->u.cli.cl_rif.crt_enabled);
+}
+
+static ssize_t rpcs_in_flight_auto_store(struct kobject *kobj,
+					 struct attribute *attr,
+					 const char *buffer,
+					 size_t count)
+{
+	struct obd_device *obd = container_of(kobj, struct obd_device,
+					      obd_kset.kobj);
+	struct client_obd *cli = &obd->u.cli;
+	struct client_rif_tuner *crt = &cli->cl_rif;
+	bool val;
+	int rc;
+
+	rc = kstrtobool(buffer, &val);
+	if (rc)
+		return rc;
+
+	spin_lock(&cli->cl_loi_list_lock);
+	if (val && !crt->crt_enabled) {
+		crt->crt_srtt_us = 0;
+		crt->crt_load_pct = 0;
+		memset(crt->crt_base_us, 0, sizeof(crt->crt_base_us));
+		memset(crt->crt_base_next_us, 0,
+		       sizeof(crt->crt_base_next_us));
+		crt->crt_base_start = ktime_get();
+		crt->crt_enabled = true;
+		/* start from the static limit, which is known to work */
+		osc_rif_change(cli, cli->cl_max_rpcs_in_flight, RIF_START);
+	} else if (!val) {
+		crt->crt_enabled = false;
+	}
+	spin_unlock(&cli->cl_loi_list_lock);
+
+	return count;
+}
+LUSTRE_RW_ATTR(rpcs_in_flight_auto);
+
+static ssize_t rpcs_in_flight_min_show(struct kobject *kobj,
+				       struct attribute *attr,
+				       char *buf)
+{
+	struct obd_device *obd = container_of(kobj, struct obd_device,
+					      obd_kset.kobj);
+
+	return scnprintf(buf, PAGE_SIZE, "%u\n", obd->u.cli.cl_rif.crt_min);
+}
+
+static ssize_t rpcs_in_flight_min_store(struct kobject *kobj,
+					struct attribute *attr,
+					const char *buffer,
+					size_t count)
+{
+	struct obd_device *obd = container_of(kobj, struct obd_device,
+					      obd_kset.kobj);
+	struct client_obd *cli = &obd->u.cli;
+	unsigned int val;
+	int rc;
+
+	rc = kstrtouint(buffer, 0, &val);
+	if (rc)
+		return rc;
+
+	spin_lock(&cli->cl_loi_list_lock);
+	if (val == 0 || val > cli->cl_max_rpcs_in_flight) {
+		spin_unlock(&cli->cl_loi_list_lock);
+		return -ERANGE;
+	}
+	cli->cl_rif.crt_min = val;
+	if (cli->cl_rif.crt_enabled && cli->cl_rif.crt_window < val)
+		osc_rif_change(cli, val, RIF_BOUNDS);
+	spin_unlock(&cli->cl_loi_list_lock);
+
+	return count;
+}
+LUSTRE_RW_ATTR(rpcs_in_flight_min);
+
 static ssize_t max_dirty_mb_show(struct kobject *kobj,
 				 struct attribute *attr,
 				 char *buf)
@@ -192,9 +282,8 @@ static int osc_cached_mb_seq_show(struct seq_file *m, void *v)
 	seq_printf(m, "used_mb: %ld\n"
 		   "busy_cnt: %ld\n"
 		   "reclaim: %llu\n",
-		   (atomic_long_read(&cli->cl_lru_in_list) +
-		    atomic_long_read(&cli->cl_lru_busy)) >> shift,
-		    atomic_long_read(&cli->cl_lru_busy),
+		   (cl_lru_in_list(cli) + cl_lru_busy(cli)) >> shift,
+		   cl_lru_busy(cli),
 		   cli->cl_lru_reclaim);
 
 	return 0;
@@ -227,7 +316,7 @@ static ssize_t osc_cached_mb_seq_write(struct file *file,
 
 	pages_number >>= PAGE_SHIFT;
 
-	rc = atomic_long_read(&cli->cl_lru_in_list) - pages_number;
+	rc = cl_lru_in_list(cli) - pages_number;
 	if (rc > 0) {
 		struct lu_env *env;
 		__u16 refcheck;
@@ -244,6 +333,39 @@ static ssize_t osc_cached_mb_seq_write(struct file *file,
 
 LPROC_SEQ_FOPS(osc_cached_mb);
 
+/* per-CPT LRU pages and lock contention, and LRU budget of the cache */
+static int osc_lru_shards_seq_show(struct seq_file *m, void *v)
+{
+	struct obd_device *obd = m->private;
+	struct client_obd *cli = &obd->u.cli;
+	struct cl_client_cache *cache = cli->cl_cache;
+	struct cl_lru_shard *shard;
+	int i;
+
+	if (cli->cl_lru_shards == NULL)
+		return 0;
+
+	cfs_percpt_for_each(shard, i, cli->cl_lru_shards) {
+		seq_printf(m, "- cpt: %d\n"
+			   "  in_list: %ld\n"
+			   "  busy: %ld\n"
+			   "  lock_taken: %llu\n"
+			   "  lock_contended: %llu\n",
+			   i, atomic_long_read(&shard->cls_in_list),
+			   atomic_long_read(&shard->cls_busy),
+			   shard->cls_lock_count, shard->cls_lock_contended);
+		if (cache != NULL)
+			seq_printf(m, "  lru_left: %ld\n"
+				   "  lru_borrowed: %ld\n",
+				   cl_cache_lru_left_cpt(cache, i),
+				   atomic_long_read(
+					&cache->ccc_lru_budget[i]->clb_borrowed));
+	}
+
+	return 0;
+}
+LPROC_SEQ_FOPS_RO(osc_lru_shards);
+
 static ssize_t cur_dirty_bytes_show(struct kobject *kobj,
 				    struct attribute *attr,
 				    char *buf)
@@ -393,6 +515,37 @@ static ssize_t checksums_store(struct kobject *kobj,
 }
 LUSTRE_RW_ATTR(checksums);
 
+static ssize_t write_coalesce_show(struct kobject *kobj,
+				   struct attribute *attr,
+				   char *buf)
+{
+	struct obd_device *obd = container_of(kobj, struct obd_device,
+					      obd_kset.kobj);
+
+	return scnprintf(buf, PAGE_SIZE, "%d\n",
+			 !!obd->u.cli.cl_write_coalesce);
+}
+
+static ssize_t write_coalesce_store(struct kobject *kobj,
+				    struct attribute *attr,
+				    const char *buffer,
+				    size_t count)
+{
+	struct obd_device *obd = container_of(kobj, struct obd_device,
+					      obd_kset.kobj);
+	bool val;
+	int rc;
+
+	rc = kstrtobool(buffer, &val);
+	if (rc)
+		return rc;
+
+	obd->u.cli.cl_write_coalesce = val;
+
+	return count;
+}
+LUSTRE_RW_ATTR(write_coalesce);
+
 DECLARE_CKSUM_NAME;
 
 static int osc_checksum_type_seq_show(struct seq_file *m, void *v)
@@ -549,6 +702,55 @@ static int osc_unstable_stats_seq_show(struct seq_file *m, void *v)
 }
 LPROC_SEQ_FOPS_RO(osc_unstable_stats);
 
+static const char *const osc_rif_reasons[] = {
+	[RIF_START]	= "start",
+	[RIF_GROW]	= "grow",
+	[RIF_LATENCY]	= "latency",
+	[RIF_RESEND]	= "resend",
+	[RIF_BOUNDS]	= "bounds",
+};
+
+static int osc_rpcs_in_flight_window_seq_show(struct seq_file *m, void *v)
+{
+	struct obd_device *obd = m->private;
+	struct client_obd *cli = &obd->u.cli;
+	struct client_rif_tuner *crt = &cli->cl_rif;
+	struct client_rif_change *rcc;
+	struct timespec64 ts;
+	__u64 i;
+
+	spin_lock(&cli->cl_loi_list_lock);
+	seq_printf(m, "enabled: %d\n"
+		   "window: %u\n"
+		   "min: %u\n"
+		   "max: %u\n"
+		   "rpc_time_us: %u\n"
+		   "load_pct: %u\n"
+		   "grown: %llu\n"
+		   "shrunk: %llu\n"
+		   "changes:\n",
+		   crt->crt_enabled, osc_rif_limit(cli), crt->crt_min,
+		   cli->cl_max_rpcs_in_flight, crt->crt_srtt_us,
+		   crt->crt_load_pct, crt->crt_grown, crt->crt_shrunk);
+
+	i = crt->crt_nchanges > CLIENT_RIF_LOG_SIZE ?
+	    crt->crt_nchanges - CLIENT_RIF_LOG_SIZE : 0;
+	for (; i < crt->crt_nchanges; i++) {
+		rcc = &crt->crt_log[i % CLIENT_RIF_LOG_SIZE];
+		ts = ktime_to_timespec64(rcc->rcc_time);
+		seq_printf(m, "  - { time: %lld.%06lu, old: %u, new: %u, "
+			   "reason: %s, rpc_time_us: %u, load_pct: %u }\n",
+			   (s64)ts.tv_sec, ts.tv_nsec / NSEC_PER_USEC,
+			   rcc->rcc_old, rcc->rcc_new,
+			   osc_rif_reasons[rcc->rcc_reason],
+			   rcc->rcc_srtt_us, rcc->rcc_load_pct);
+	}
+	spin_unlock(&cli->cl_loi_list_lock);
+
+	return 0;
+}
+LPROC_SEQ_FOPS_RO(osc_rpcs_in_flight_window);
+
 static ssize_t idle_timeout_show(struct kobject *kobj, struct attribute *attr,
 				 char *buf)
 {
@@ -687,6 +889,8 @@ struct lprocfs_vars lprocfs_osc_obd_vars[] = {
 	  .fops =	&osc_obd_max_pages_per_rpc_fops	},
 	{ .name	=	"osc_cached_mb",
 	  .fops	=	&osc_cached_mb_fops		},
+	{ .name	=	"lru_shards",
+	  .fops	=	&osc_lru_shards_fops		},
 	{ .name =	"cur_grant_bytes",
 	  .fops =	&osc_cur_grant_bytes_fops	},
 	{ .name	=	"checksum_type",
@@ -701,6 +905,8 @@ struct lprocfs_vars lprocfs_osc_obd_vars[] = {
 	  .fops	=	&osc_pinger_recov_fops		},
 	{ .name	=	"unstable_stats",
 	  .fops	=	&osc_unstable_stats_fops	},
+	{ .name	=	"rpcs_in_flight_window",
+	  .fops	=	&osc_rpcs_in_flight_window_fops	},
 	{ NULL }
 };
 
@@ -709,6 +915,7 @@ static int osc_rpc_stats_seq_show(struct seq_file *seq, void *v)
 	struct obd_device *obd = seq->private;
 	struct client_obd *cli = &obd->u.cli;
 	unsigned long read_tot = 0, write_tot = 0, read_cum, write_cum;
+	unsigned long read_avg, write_avg;
 	int i;
 
 	spin_lock(&cli->cl_loi_list_lock);
@@ -723,13 +930,21 @@ static int osc_rpc_stats_seq_show(struct seq_file *seq, void *v)
 	seq_printf(seq, "pending read pages:   %d\n",
 		   atomic_read(&cli->cl_pending_r_pages));
 
+	read_tot = lprocfs_oh_sum(&cli->cl_read_page_hist);
+	write_tot = lprocfs_oh_sum(&cli->cl_write_page_hist);
+
+	/* averages in hundredths of niobufs */
+	read_avg = read_tot ? cli->cl_read_niobufs * 100 / read_tot : 0;
+	write_avg = write_tot ? cli->cl_write_niobufs * 100 / write_tot : 0;
+	seq_printf(seq, "avg read niobufs:     %lu.%02lu\n",
+		   read_avg / 100, read_avg % 100);
+	seq_printf(seq, "avg write niobufs:    %lu.%02lu\n",
+		   write_avg / 100, write_avg % 100);
+
 	seq_printf(seq, "\n\t\t\tread\t\t\twrite\n");
 	seq_printf(seq, "pages per rpc         rpcs   %% cum %% |");
 	seq_printf(seq, "       rpcs   %% cum %%\n");
 
-	read_tot = lprocfs_oh_sum(&cli->cl_read_page_hist);
-	write_tot = lprocfs_oh_sum(&cli->cl_write_page_hist);
-
 	read_cum = 0;
 	write_cum = 0;
 	for (i = 0; i < OBD_HIST_MAX; i++) {
@@ -792,6 +1007,30 @@ static int osc_rpc_stats_seq_show(struct seq_file *seq, void *v)
                         break;
         }
 
+	seq_printf(seq, "\n\t\t\tread\t\t\twrite\n");
+	seq_printf(seq, "niobufs per rpc       rpcs   %% cum %% |");
+	seq_printf(seq, "       rpcs   %% cum %%\n");
+
+	read_tot = lprocfs_oh_sum(&cli->cl_read_nio_hist);
+	write_tot = lprocfs_oh_sum(&cli->cl_write_nio_hist);
+
+	read_cum = 0;
+	write_cum = 0;
+	for (i = 0; i < OBD_HIST_MAX; i++) {
+		unsigned long r = cli->cl_read_nio_hist.oh_buckets[i];
+		unsigned long w = cli->cl_write_nio_hist.oh_buckets[i];
+
+		read_cum += r;
+		write_cum += w;
+		seq_printf(seq, "%d:\t\t%10lu %3u %3u   | %10lu %3u %3u\n",
+			   1 << i, r, pct(r, read_tot),
+			   pct(read_cum, read_tot), w,
+			   pct(w, write_tot),
+			   pct(write_cum, write_tot));
+		if (read_cum == read_tot && write_cum == write_tot)
+			break;
+	}
+
 	spin_unlock(&cli->cl_loi_list_lock);
 
         return 0;
@@ -811,6 +1050,12 @@ static ssize_t osc_rpc_stats_seq_write(struct file *file,
 	lprocfs_oh_clear(&cli->cl_write_page_hist);
 	lprocfs_oh_clear(&cli->cl_read_offset_hist);
 	lprocfs_oh_clear(&cli->cl_write_offset_hist);
+	lprocfs_oh_clear(&cli->cl_read_nio_hist);
+	lprocfs_oh_clear(&cli->cl_write_nio_hist);
+	spin_lock(&cli->cl_loi_list_lock);
+	cli->cl_read_niobufs = 0;
+	cli->cl_write_niobufs = 0;
+	spin_unlock(&cli->cl_loi_list_lock);
 	cli->cl_stats_init = ktime_get();
 
 	return len;
@@ -846,6 +1091,50 @@ static ssize_t osc_stats_seq_write(struct file *file,
 
 LPROC_SEQ_FOPS(osc_stats);
 
+static int osc_compress_stats_seq_show(struct seq_file *seq, void *v)
+{
+	struct obd_device *obd = seq->private;
+	struct client_obd *cli = &obd->u.cli;
+	struct osc_compr_stats stats;
+
+	spin_lock(&cli->cl_loi_list_lock);
+	stats = obd2osc_dev(obd)->od_compr_stats;
+	spin_unlock(&cli->cl_loi_list_lock);
+
+	lprocfs_stats_header(seq, ktime_get(), stats.ocs_init, 25, ":", true);
+	seq_printf(seq, "compressed_rpcs\t\t%llu\n", stats.ocs_rpcs);
+	seq_printf(seq, "skipped_rpcs\t\t%llu\n", stats.ocs_rpcs_skipped);
+	seq_printf(seq, "chunks\t\t\t%llu\n", stats.ocs_chunks);
+	seq_printf(seq, "incompressible_chunks\t%llu\n", stats.ocs_chunks_raw);
+	seq_printf(seq, "bytes_in\t\t%llu\n", stats.ocs_bytes_in);
+	seq_printf(seq, "bytes_out\t\t%llu\n", stats.ocs_bytes_out);
+	/* percentage of the data saved on the wire */
+	seq_printf(seq, "saved_pct\t\t%u\n",
+		   pct(stats.ocs_bytes_in - stats.ocs_bytes_out,
+		       stats.ocs_bytes_in));
+	seq_printf(seq, "compress_usec\t\t%llu\n", stats.ocs_usec);
+
+	return 0;
+}
+
+static ssize_t osc_compress_stats_seq_write(struct file *file,
+					    const char __user *buf,
+					    size_t len, loff_t *off)
+{
+	struct seq_file *seq = file->private_data;
+	struct obd_device *obd = seq->private;
+	struct client_obd *cli = &obd->u.cli;
+	struct osc_compr_stats *stats = &obd2osc_dev(obd)->od_compr_stats;
+
+	spin_lock(&cli->cl_loi_list_lock);
+	memset(stats, 0, sizeof(*stats));
+	stats->ocs_init = ktime_get();
+	spin_unlock(&cli->cl_loi_list_lock);
+
+	return len;
+}
+LPROC_SEQ_FOPS(osc_compress_stats);
+
 int lprocfs_osc_attach_seqstat(struct obd_device *obd)
 {
 	int rc;
@@ -855,9 +1144,29 @@ int lprocfs_osc_attach_seqstat(struct obd_device *obd)
 	if (rc == 0)
 		rc = lprocfs_obd_seq_create(obd, "rpc_stats", 0644,
 					    &osc_rpc_stats_fops, obd);
+	if (rc == 0)
+		rc = lprocfs_obd_seq_create(obd, "compress_stats", 0644,
+					    &osc_compress_stats_fops, obd);
 
 	return rc;
 }
+
+void osc_job_stats_counter_init(struct lprocfs_stats *stats,
+				unsigned int offset)
+{
+	LASSERT(stats && stats->ls_num >= LPROC_OSC_JOB_LAST);
+
+	lprocfs_counter_init(stats, LPROC_OSC_JOB_READ_BYTES,
+			     LPROCFS_TYPE_BYTES_FULL, "read_bytes", "bytes");
+	lprocfs_counter_init(stats, LPROC_OSC_JOB_WRITE_BYTES,
+			     LPROCFS_TYPE_BYTES_FULL, "write_bytes", "bytes");
+	lprocfs_counter_init(stats, LPROC_OSC_JOB_READ,
+			     LPROCFS_TYPE_LATENCY | LPROCFS_CNTR_HISTOGRAM,
+			     "read", "usecs");
+	lprocfs_counter_init(stats, LPROC_OSC_JOB_WRITE,
+			     LPROCFS_TYPE_LATENCY | LPROCFS_CNTR_HISTOGRAM,
+			     "write", "usecs");
+}
 #endif /* CONFIG_PROC_FS */
 
 static struct attribute *osc_attrs[] = {
@@ -871,6 +1180,8 @@ static struct attribute *osc_attrs[] = {
 	&lustre_attr_grant_shrink_interval.attr,
 	&lustre_attr_max_dirty_mb.attr,
 	&lustre_attr_max_rpcs_in_flight.attr,
+	&lustre_attr_rpcs_in_flight_auto.attr,
+	&lustre_attr_rpcs_in_flight_min.attr,
 	&lustre_attr_short_io_bytes.attr,
 	&lustre_attr_resend_count.attr,
 	&lustre_attr_ost_conn_uuid.attr,
@@ -879,6 +1190,7 @@ static struct attribute *osc_attrs[] = {
 	&lustre_attr_idle_timeout.attr,
 	&lustre_attr_idle_connect.attr,
 	&lustre_attr_grant_shrink.attr,
+	&lustre_attr_write_coalesce.attr,
 	NULL,
 };
 
@@ -899,6 +1211,11 @@ int osc_tunables_init(struct obd_device *obd)
 	if (rc)
 		goto obd_cleanup;
 
+	rc = lprocfs_job_stats_register(&obd->u.cli.cl_jobstats,
+					obd->obd_proc_entry, LPROC_OSC_JOB_LAST,
+					osc_job_stats_counter_init);
+	if (rc)
+		goto obd_cleanup;
 #endif /* CONFIG_PROC_FS */
 	rc = sptlrpc_lprocfs_cliobd_attach(obd);
 	if (rc)
@@ -1355,8 +1355,7 @@ static int osc_completion(const struct lu_env *env, struct osc_async_page *oap,
 	       __tmp->cl_lost_grant, __tmp->cl_avail_grant,		\
 	       __tmp->cl_dirty_grant,					\
 	       __tmp->cl_reserved_grant, __tmp->cl_w_in_flight,		\
-	       atomic_long_read(&__tmp->cl_lru_in_list),		\
-	       atomic_long_read(&__tmp->cl_lru_busy),			\
+	       cl_lru_in_list(__tmp), cl_lru_busy(__tmp),		\
 	       atomic_read(&__tmp->cl_lru_shrinkers), ##args);		\
 } while (0)
 
@@ -1630,7 +1629,7 @@ out:
 static int osc_max_rpc_in_flight(struct client_obd *cli, struct osc_object *osc)
 {
 	int hprpc = !!list_empty(&osc->oo_hp_exts);
-	return rpcs_in_flight(cli) >= cli->cl_max_rpcs_in_flight + hprpc;
+	return rpcs_in_flight(cli) >= osc_rif_limit(cli) + hprpc;
 }
 
 /* This maintains the lists of pending pages to read/write for a given object
@@ -1933,7 +1932,7 @@ static unsigned int get_write_extents(struct osc_object *obj,
 		.erd_page_count	= 0,
 		.erd_max_pages	= cli->cl_max_pages_per_rpc,
 		.erd_max_chunks	= osc_max_write_chunks(cli),
-		.erd_max_extents = 256,
+		.erd_max_extents = osc_max_write_extents(cli),
 	};
 
 	assert_osc_object_is_locked(obj);
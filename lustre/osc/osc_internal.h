@@ -208,6 +208,52 @@ static inline unsigned int osc_max_write_chunks(const struct client_obd *cli)
 	return PTLRPC_MAX_BRW_SIZE >> cli->cl_chunkbits;
 }
 
+/*
+ * Every extent of a write RPC takes at least one niobuf. Without
+ * write_coalesce, at most 256 extents are packed in an RPC. With it, they
+ * are limited by the niobufs the OST accepts in one BRW: one per page of
+ * the RPC, and no more than DT_MAX_BRW_PAGES, which the OST request
+ * buffers are sized for and tgt_io_data_unpack() checks.
+ *
+ * All the extents of an RPC belong to a single object: tgt_io_data_unpack()
+ * also rejects more than one obd_ioobj per BRW, so packing several objects
+ * would need a new connect flag.
+ */
+static inline unsigned int osc_max_write_extents(const struct client_obd *cli)
+{
+	if (!cli->cl_write_coalesce)
+		return 256;
+
+	return min_t(unsigned int, cli->cl_max_pages_per_rpc,
+		     DT_MAX_BRW_PAGES);
+}
+
+void osc_rif_change(struct client_obd *cli, __u32 window,
+		    enum client_rif_reason reason);
+
+/**
+ * Limit of the BRW RPCs in flight of \a cli, the auto-tuned window if enabled.
+ */
+static inline __u32 osc_rif_limit(const struct client_obd *cli)
+{
+	if (cli->cl_rif.crt_enabled)
+		return cli->cl_rif.crt_window;
+
+	return cli->cl_max_rpcs_in_flight;
+}
+
+/* per-job counters of client_obd::cl_jobstats */
+enum {
+	LPROC_OSC_JOB_READ_BYTES = 0,
+	LPROC_OSC_JOB_WRITE_BYTES,
+	LPROC_OSC_JOB_READ,
+	LPROC_OSC_JOB_WRITE,
+	LPROC_OSC_JOB_LAST,
+};
+
+void osc_job_stats_counter_init(struct lprocfs_stats *stats,
+				unsigned int offset);
+
 static inline void osc_set_io_portal(struct ptlrpc_request *req)
 {
 	struct obd_import *imp = req->rq_import;
@@ -331,10 +331,16 @@ void osc_page_submit(const struct lu_env *env, struct osc_page *opg,
 /* OSC is a natural place to manage LRU pages as applications are specialized
  * to write OSC by OSC. Ideally, if one OSC is used more frequently it should
  * occupy more LRU slots. On the other hand, we should avoid using up all LRU
- * slots (client_obd::cl_lru_left) otherwise process has to be put into sleep
- * for free LRU slots - this will be very bad so the algorithm requires each
- * OSC to free slots voluntarily to maintain a reasonable number of free slots
- * at any time.
+ * slots (cl_client_cache::ccc_lru_budget) otherwise process has to be put into
+ * sleep for free LRU slots - this will be very bad so the algorithm requires
+ * each OSC to free slots voluntarily to maintain a reasonable number of free
+ * slots at any time.
+ *
+ * Both the LRU list of an OSC and the free LRU slots are split per CPT, see
+ * struct cl_lru_shard and struct cl_lru_budget. A page is added to the shard
+ * of the CPT which allocated it, and its slot is given back to the budget of
+ * that CPT when the page is freed, so I/O threads running on different CPTs
+ * don't contend on the same lock and counters.
  */
 
 static DECLARE_WAIT_QUEUE_HEAD(osc_lru_waitq);
@@ -356,25 +362,73 @@ static inline int lru_shrink_max(struct client_obd *cli)
 	return cli->cl_max_pages_per_rpc * cli->cl_max_rpcs_in_flight;
 }
 
+/**
+ * # of LRU slots moved at once from other CPTs when the budget of the local
+ * CPT is exhausted.
+ */
+static inline long lru_borrow_batch(struct client_obd *cli)
+{
+	return cli->cl_max_pages_per_rpc;
+}
+
+static inline struct cl_lru_shard *osc_lru_shard(struct client_obd *cli,
+						 struct osc_page *opg)
+{
+	return cli->cl_lru_shards[opg->ops_lru_cpt];
+}
+
+static inline void osc_lru_shard_lock(struct cl_lru_shard *shard)
+{
+	if (!spin_trylock(&shard->cls_lock)) {
+		spin_lock(&shard->cls_lock);
+		shard->cls_lock_contended++;
+	}
+	shard->cls_lock_count++;
+}
+
+static inline void osc_lru_shard_unlock(struct cl_lru_shard *shard)
+{
+	spin_unlock(&shard->cls_lock);
+}
+
 /**
  * Check if we can free LRU slots from this OSC. If there exists LRU waiters,
  * we should free slots aggressively. In this way, slots are freed in a steady
  * step to maintain fairness among OSCs.
  *
+ * If \a cpt is not CFS_CPT_ANY, only the shard of this OSC and the LRU budget
+ * of \a cpt are checked against their share of the cache. This doesn't touch
+ * the counters of other CPTs, but is only a hint to queue LRU work.
+ *
  * Return how many LRU pages should be freed.
  */
-static int osc_cache_too_much(struct client_obd *cli)
+static int osc_cache_too_much(struct client_obd *cli, int cpt)
 {
 	struct cl_client_cache *cache = cli->cl_cache;
-	long pages = atomic_long_read(&cli->cl_lru_in_list);
+	unsigned long lru_max;
 	unsigned long budget;
+	long pages;
+	long left;
 
 	LASSERT(cache != NULL);
-	budget = cache->ccc_lru_max / (atomic_read(&cache->ccc_users) - 2);
+	lru_max = cache->ccc_lru_max;
+	budget = lru_max / (atomic_read(&cache->ccc_users) - 2);
+
+	if (cpt == CFS_CPT_ANY) {
+		pages = cl_lru_in_list(cli);
+		left = cl_cache_lru_left(cache);
+	} else {
+		int ncpt = cfs_percpt_number(cli->cl_lru_shards);
+
+		pages = atomic_long_read(&cli->cl_lru_shards[cpt]->cls_in_list);
+		left = cl_cache_lru_left_cpt(cache, cpt);
+		lru_max /= ncpt;
+		budget /= ncpt;
+	}
 
 	/* if it's going to run out LRU slots, we should free some, but not
 	 * too much to maintain faireness among OSCs. */
-	if (atomic_long_read(cli->cl_lru_left) < cache->ccc_lru_max >> 2) {
+	if (left < lru_max >> 2) {
 		if (pages >= budget)
 			return lru_shrink_max(cli);
 		else if (pages >= budget / 2)
@@ -403,7 +457,7 @@ int lru_queue_work(const struct lu_env *env, void *data)
 	int count;
 
 	CDEBUG(D_CACHE, "%s: run LRU work for client obd\n", cli_name(cli));
-	count = osc_cache_too_much(cli);
+	count = osc_cache_too_much(cli, CFS_CPT_ANY);
 	if (count > 0) {
 		int rc = osc_lru_shrink(env, cli, count, false);
 
@@ -418,41 +472,62 @@ int lru_queue_work(const struct lu_env *env, void *data)
 	RETURN(0);
 }
 
+static void osc_lru_add_list(struct client_obd *cli, int cpt,
+			     struct list_head *lru, long npages)
+{
+	struct cl_lru_shard *shard = cli->cl_lru_shards[cpt];
+
+	osc_lru_shard_lock(shard);
+	list_splice_tail_init(lru, &shard->cls_list);
+	atomic_long_sub(npages, &shard->cls_busy);
+	atomic_long_add(npages, &shard->cls_in_list);
+	osc_lru_shard_unlock(shard);
+}
+
 void osc_lru_add_batch(struct client_obd *cli, struct list_head *plist)
 {
 	LIST_HEAD(lru);
 	struct osc_async_page *oap;
 	long npages = 0;
+	long total = 0;
+	int cpt = CFS_CPT_ANY;
 
+	/* pages of an RPC are usually allocated by the same thread, so they
+	 * are added to their shard in runs of the same CPT */
 	list_for_each_entry(oap, plist, oap_pending_item) {
 		struct osc_page *opg = oap2osc_page(oap);
 
 		if (!opg->ops_in_lru)
 			continue;
 
+		if (opg->ops_lru_cpt != cpt && npages > 0) {
+			osc_lru_add_list(cli, cpt, &lru, npages);
+			npages = 0;
+		}
+
+		cpt = opg->ops_lru_cpt;
 		++npages;
+		++total;
 		LASSERT(list_empty(&opg->ops_lru));
 		list_add(&opg->ops_lru, &lru);
 	}
 
-	if (npages > 0) {
-		spin_lock(&cli->cl_lru_list_lock);
-		list_splice_tail(&lru, &cli->cl_lru_list);
-		atomic_long_sub(npages, &cli->cl_lru_busy);
-		atomic_long_add(npages, &cli->cl_lru_in_list);
+	if (npages > 0)
+		osc_lru_add_list(cli, cpt, &lru, npages);
+
+	if (total > 0) {
 		cli->cl_lru_last_used = ktime_get_real_seconds();
-		spin_unlock(&cli->cl_lru_list_lock);
 
 		if (waitqueue_active(&osc_lru_waitq))
 			(void)ptlrpcd_queue_work(cli->cl_lru_work);
 	}
 }
 
-static void __osc_lru_del(struct client_obd *cli, struct osc_page *opg)
+static void __osc_lru_del(struct cl_lru_shard *shard, struct osc_page *opg)
 {
-	LASSERT(atomic_long_read(&cli->cl_lru_in_list) > 0);
+	LASSERT(atomic_long_read(&shard->cls_in_list) > 0);
 	list_del_init(&opg->ops_lru);
-	atomic_long_dec(&cli->cl_lru_in_list);
+	atomic_long_dec(&shard->cls_in_list);
 }
 
 /**
@@ -462,20 +537,22 @@ static void __osc_lru_del(struct client_obd *cli, struct osc_page *opg)
 static void osc_lru_del(struct client_obd *cli, struct osc_page *opg)
 {
 	if (opg->ops_in_lru) {
-		spin_lock(&cli->cl_lru_list_lock);
+		struct cl_lru_shard *shard = osc_lru_shard(cli, opg);
+
+		osc_lru_shard_lock(shard);
 		if (!list_empty(&opg->ops_lru)) {
-			__osc_lru_del(cli, opg);
+			__osc_lru_del(shard, opg);
 		} else {
-			LASSERT(atomic_long_read(&cli->cl_lru_busy) > 0);
-			atomic_long_dec(&cli->cl_lru_busy);
+			LASSERT(atomic_long_read(&shard->cls_busy) > 0);
+			atomic_long_dec(&shard->cls_busy);
 		}
-		spin_unlock(&cli->cl_lru_list_lock);
+		osc_lru_shard_unlock(shard);
 
-		atomic_long_inc(cli->cl_lru_left);
+		cl_cache_lru_put(cli->cl_cache, opg->ops_lru_cpt, 1);
 		/* this is a great place to release more LRU pages if
 		 * this osc occupies too many LRU pages and kernel is
 		 * stealing one of them. */
-		if (osc_cache_too_much(cli)) {
+		if (osc_cache_too_much(cli, opg->ops_lru_cpt)) {
 			CDEBUG(D_CACHE, "%s: queue LRU work\n", cli_name(cli));
 			(void)ptlrpcd_queue_work(cli->cl_lru_work);
 		}
@@ -493,14 +570,16 @@ static void osc_lru_use(struct client_obd *cli, struct osc_page *opg)
 	/* If page is being transferred for the first time,
 	 * ops_lru should be empty */
 	if (opg->ops_in_lru) {
+		struct cl_lru_shard *shard = osc_lru_shard(cli, opg);
+
 		if (list_empty(&opg->ops_lru))
 			return;
-		spin_lock(&cli->cl_lru_list_lock);
+		osc_lru_shard_lock(shard);
 		if (!list_empty(&opg->ops_lru)) {
-			__osc_lru_del(cli, opg);
-			atomic_long_inc(&cli->cl_lru_busy);
+			__osc_lru_del(shard, opg);
+			atomic_long_inc(&shard->cls_busy);
 		}
-		spin_unlock(&cli->cl_lru_list_lock);
+		osc_lru_shard_unlock(shard);
 	}
 }
 
@@ -548,11 +627,14 @@ static inline bool lru_page_busy(struct client_obd *cli, struct cl_page *page)
 }
 
 /**
- * Drop @target of pages from LRU at most.
+ * Drop @target of pages from the LRU shard of CPT @cpt at most, and give
+ * their slots back to the LRU budget of @cpt.
  */
-long osc_lru_shrink(const struct lu_env *env, struct client_obd *cli,
-		   long target, bool force)
+static long osc_lru_shrink_shard(const struct lu_env *env,
+				 struct client_obd *cli, int cpt,
+				 long target, bool force)
 {
+	struct cl_lru_shard *shard = cli->cl_lru_shards[cpt];
 	struct cl_io *io;
 	struct cl_object *clobj = NULL;
 	struct cl_page **pvec;
@@ -563,32 +645,15 @@ long osc_lru_shrink(const struct lu_env *env, struct client_obd *cli,
 	int rc = 0;
 	ENTRY;
 
-	LASSERT(atomic_long_read(&cli->cl_lru_in_list) >= 0);
-	if (atomic_long_read(&cli->cl_lru_in_list) == 0 || target <= 0)
+	if (atomic_long_read(&shard->cls_in_list) == 0)
 		RETURN(0);
 
-	CDEBUG(D_CACHE, "%s: shrinkers: %d, force: %d\n",
-	       cli_name(cli), atomic_read(&cli->cl_lru_shrinkers), force);
-	if (!force) {
-		if (atomic_read(&cli->cl_lru_shrinkers) > 0)
-			RETURN(-EBUSY);
-
-		if (atomic_inc_return(&cli->cl_lru_shrinkers) > 1) {
-			atomic_dec(&cli->cl_lru_shrinkers);
-			RETURN(-EBUSY);
-		}
-	} else {
-		atomic_inc(&cli->cl_lru_shrinkers);
-	}
-
 	pvec = (struct cl_page **)osc_env_info(env)->oti_pvec;
 	io = osc_env_thread_io(env);
 
-	spin_lock(&cli->cl_lru_list_lock);
-	if (force)
-		cli->cl_lru_reclaim++;
-	maxscan = min(target << 1, atomic_long_read(&cli->cl_lru_in_list));
-	while (!list_empty(&cli->cl_lru_list)) {
+	osc_lru_shard_lock(shard);
+	maxscan = min(target << 1, atomic_long_read(&shard->cls_in_list));
+	while (!list_empty(&shard->cls_list)) {
 		struct cl_page *page;
 		bool will_free = false;
 
@@ -598,11 +663,11 @@ long osc_lru_shrink(const struct lu_env *env, struct client_obd *cli,
 		if (--maxscan < 0)
 			break;
 
-		opg = list_first_entry(&cli->cl_lru_list, struct osc_page,
+		opg = list_first_entry(&shard->cls_list, struct osc_page,
 				       ops_lru);
 		page = opg->ops_cl.cpl_page;
 		if (lru_page_busy(cli, page)) {
-			list_move_tail(&opg->ops_lru, &cli->cl_lru_list);
+			list_move_tail(&opg->ops_lru, &shard->cls_list);
 			continue;
 		}
 
@@ -611,7 +676,7 @@ long osc_lru_shrink(const struct lu_env *env, struct client_obd *cli,
 			struct cl_object *tmp = page->cp_obj;
 
 			cl_object_get(tmp);
-			spin_unlock(&cli->cl_lru_list_lock);
+			osc_lru_shard_unlock(shard);
 
 			if (clobj != NULL) {
 				discard_pagevec(env, io, pvec, index);
@@ -627,7 +692,7 @@ long osc_lru_shrink(const struct lu_env *env, struct client_obd *cli,
 			io->ci_ignore_layout = 1;
 			rc = cl_io_init(env, io, CIT_MISC, clobj);
 
-			spin_lock(&cli->cl_lru_list_lock);
+			osc_lru_shard_lock(shard);
 
 			if (rc != 0)
 				break;
@@ -640,7 +705,7 @@ long osc_lru_shrink(const struct lu_env *env, struct client_obd *cli,
 			if (!lru_page_busy(cli, page)) {
 				/* remove it from lru list earlier to avoid
 				 * lock contention */
-				__osc_lru_del(cli, opg);
+				__osc_lru_del(shard, opg);
 				opg->ops_in_lru = 0; /* will be discarded */
 
 				cl_page_get(page);
@@ -651,24 +716,24 @@ long osc_lru_shrink(const struct lu_env *env, struct client_obd *cli,
 		}
 
 		if (!will_free) {
-			list_move_tail(&opg->ops_lru, &cli->cl_lru_list);
+			list_move_tail(&opg->ops_lru, &shard->cls_list);
 			continue;
 		}
 
-		/* Don't discard and free the page with cl_lru_list held */
+		/* Don't discard and free the page with cls_lock held */
 		pvec[index++] = page;
 		if (unlikely(index == OTI_PVEC_SIZE)) {
-			spin_unlock(&cli->cl_lru_list_lock);
+			osc_lru_shard_unlock(shard);
 			discard_pagevec(env, io, pvec, index);
 			index = 0;
 
-			spin_lock(&cli->cl_lru_list_lock);
+			osc_lru_shard_lock(shard);
 		}
 
 		if (++count >= target)
 			break;
 	}
-	spin_unlock(&cli->cl_lru_list_lock);
+	osc_lru_shard_unlock(shard);
 
 	if (clobj != NULL) {
 		discard_pagevec(env, io, pvec, index);
@@ -677,11 +742,61 @@ long osc_lru_shrink(const struct lu_env *env, struct client_obd *cli,
 		cl_object_put(env, clobj);
 	}
 
+	if (count > 0)
+		cl_cache_lru_put(cli->cl_cache, cpt, count);
+	RETURN(count > 0 ? count : rc);
+}
+
+/**
+ * Drop @target of pages from LRU at most.
+ *
+ * The shard of the current CPT is scanned first, so that the slots freed
+ * are likely to be used again by the caller without borrowing.
+ */
+long osc_lru_shrink(const struct lu_env *env, struct client_obd *cli,
+		   long target, bool force)
+{
+	long count = 0;
+	long rc = 0;
+	int ncpt;
+	int cpt;
+	int i;
+	ENTRY;
+
+	if (cl_lru_in_list(cli) == 0 || target <= 0)
+		RETURN(0);
+
+	CDEBUG(D_CACHE, "%s: shrinkers: %d, force: %d\n",
+	       cli_name(cli), atomic_read(&cli->cl_lru_shrinkers), force);
+	if (!force) {
+		if (atomic_read(&cli->cl_lru_shrinkers) > 0)
+			RETURN(-EBUSY);
+
+		if (atomic_inc_return(&cli->cl_lru_shrinkers) > 1) {
+			atomic_dec(&cli->cl_lru_shrinkers);
+			RETURN(-EBUSY);
+		}
+	} else {
+		atomic_inc(&cli->cl_lru_shrinkers);
+		cli->cl_lru_reclaim++;
+	}
+
+	ncpt = cfs_percpt_number(cli->cl_lru_shards);
+	cpt = cfs_cpt_current(cfs_cpt_tab, 1);
+	for (i = 0; i < ncpt && count < target; i++) {
+		if (!force && atomic_read(&cli->cl_lru_shrinkers) > 1)
+			break;
+
+		rc = osc_lru_shrink_shard(env, cli, (cpt + i) % ncpt,
+					  target - count, force);
+		if (rc < 0)
+			break;
+		count += rc;
+	}
+
 	atomic_dec(&cli->cl_lru_shrinkers);
-	if (count > 0) {
-		atomic_long_add(count, cli->cl_lru_left);
+	if (count > 0)
 		wake_up(&osc_lru_waitq);
-	}
 	RETURN(count > 0 ? count : rc);
 }
 EXPORT_SYMBOL(osc_lru_shrink);
@@ -715,7 +830,7 @@ static long osc_lru_reclaim(struct client_obd *cli, unsigned long npages)
 	if (rc >= npages) {
 		CDEBUG(D_CACHE, "%s: reclaimed %ld/%ld pages from LRU\n",
 		       cli_name(cli), rc, npages);
-		if (osc_cache_too_much(cli) > 0)
+		if (osc_cache_too_much(cli, CFS_CPT_ANY) > 0)
 			ptlrpcd_queue_work(cli->cl_lru_work);
 		GOTO(out, rc);
 	} else if (rc > 0) {
@@ -723,8 +838,8 @@ static long osc_lru_reclaim(struct client_obd *cli, unsigned long npages)
 	}
 
 	CDEBUG(D_CACHE, "%s: cli %p no free slots, pages: %ld/%ld, want: %ld\n",
-		cli_name(cli), cli, atomic_long_read(&cli->cl_lru_in_list),
-		atomic_long_read(&cli->cl_lru_busy), npages);
+		cli_name(cli), cli, cl_lru_in_list(cli), cl_lru_busy(cli),
+		npages);
 
 	/* Reclaim LRU slots from other client_obd as it can't free enough
 	 * from its own. This should rarely happen. */
@@ -740,12 +855,11 @@ static long osc_lru_reclaim(struct client_obd *cli, unsigned long npages)
 						  struct client_obd,
 						  cl_lru_osc)) != NULL) {
 		CDEBUG(D_CACHE, "%s: cli %p LRU pages: %ld, busy: %ld.\n",
-		       cli_name(scan), scan,
-		       atomic_long_read(&scan->cl_lru_in_list),
-		       atomic_long_read(&scan->cl_lru_busy));
+		       cli_name(scan), scan, cl_lru_in_list(scan),
+		       cl_lru_busy(scan));
 
 		list_move_tail(&scan->cl_lru_osc, &cache->ccc_lru);
-		if (osc_cache_too_much(scan) > 0) {
+		if (osc_cache_too_much(scan, CFS_CPT_ANY) > 0) {
 			spin_unlock(&cache->ccc_lru_lock);
 
 			rc = osc_lru_shrink(env, scan, npages, true);
@@ -776,20 +890,22 @@ static int osc_lru_alloc(const struct lu_env *env, struct client_obd *cli,
 			 struct osc_page *opg)
 {
 	struct osc_io *oio = osc_env_io(env);
+	struct cl_client_cache *cache = cli->cl_cache;
+	int cpt;
 	int rc = 0;
 
 	ENTRY;
 
-	if (cli->cl_cache == NULL) /* shall not be in LRU */
+	if (cache == NULL) /* shall not be in LRU */
 		RETURN(0);
 
+	cpt = cfs_cpt_current(cfs_cpt_tab, 1);
 	if (oio->oi_lru_reserved > 0) {
 		--oio->oi_lru_reserved;
 		goto out;
 	}
 
-	LASSERT(atomic_long_read(cli->cl_lru_left) >= 0);
-	while (!atomic_long_add_unless(cli->cl_lru_left, -1, 0)) {
+	while (cl_cache_lru_get(cache, cpt, 1, lru_borrow_batch(cli)) == 0) {
 		/* run out of LRU spaces, try to drop some by itself */
 		rc = osc_lru_reclaim(cli, 1);
 		if (rc < 0)
@@ -798,16 +914,15 @@ static int osc_lru_alloc(const struct lu_env *env, struct client_obd *cli,
 			continue;
 		/* IO issued by readahead, don't try hard */
 		if (oio->oi_is_readahead) {
-			if (atomic_long_read(cli->cl_lru_left) > 0)
+			if (cl_cache_lru_left(cache) > 0)
 				continue;
 			rc = -EBUSY;
 			break;
 		}
 
 		cond_resched();
-		rc = l_wait_event_abortable(
-			osc_lru_waitq,
-			atomic_long_read(cli->cl_lru_left) > 0);
+		rc = l_wait_event_abortable(osc_lru_waitq,
+					    cl_cache_lru_left(cache) > 0);
 		if (rc < 0) {
 			rc = -EINTR;
 			break;
@@ -816,7 +931,8 @@ static int osc_lru_alloc(const struct lu_env *env, struct client_obd *cli,
 
 out:
 	if (rc >= 0) {
-		atomic_long_inc(&cli->cl_lru_busy);
+		opg->ops_lru_cpt = cpt;
+		atomic_long_inc(&cli->cl_lru_shards[cpt]->cls_busy);
 		opg->ops_in_lru = 1;
 		rc = 0;
 	}
@@ -827,22 +943,30 @@ out:
 /**
  * osc_lru_reserve() is called to reserve enough LRU slots for I/O.
  *
- * The benefit of doing this is to reduce contention against atomic counter
- * cl_lru_left by changing it from per-page access to per-IO access.
+ * The benefit of doing this is to reduce contention against the LRU budget
+ * by changing it from per-page access to per-IO access. Slots are taken from
+ * the budget of the current CPT, and borrowed from other CPTs only if it is
+ * exhausted.
  */
 unsigned long osc_lru_reserve(struct client_obd *cli, unsigned long npages)
 {
-	unsigned long reserved = 0;
+	struct cl_client_cache *cache = cli->cl_cache;
+	unsigned long reserved;
 	unsigned long max_pages;
-	unsigned long c;
+	int cpt;
 	int rc;
 
+	cpt = cfs_cpt_current(cfs_cpt_tab, 1);
 again:
-	c = atomic_long_read(cli->cl_lru_left);
-	if (c < npages && osc_lru_reclaim(cli, npages) > 0)
-		c = atomic_long_read(cli->cl_lru_left);
+	reserved = cl_cache_lru_get(cache, cpt, npages, lru_borrow_batch(cli));
+	if (reserved != npages) {
+		/* all or nothing, give back what could be taken */
+		cl_cache_lru_put(cache, cpt, reserved);
+		reserved = 0;
+
+		if (osc_lru_reclaim(cli, npages) > 0)
+			goto again;
 
-	if (c < npages) {
 		/*
 		 * Trigger writeback in the hope some LRU slot could
 		 * be freed.
@@ -850,31 +974,20 @@ again:
 		rc = ptlrpcd_queue_work(cli->cl_writeback_work);
 		if (rc)
 			return 0;
-	}
-
-	while (c >= npages) {
-		if (c == atomic_long_cmpxchg(cli->cl_lru_left, c, c - npages)) {
-			reserved = npages;
-			break;
-		}
-		c = atomic_long_read(cli->cl_lru_left);
-	}
 
-	if (reserved != npages) {
 		cond_resched();
-		rc = l_wait_event_abortable(
-			osc_lru_waitq,
-			atomic_long_read(cli->cl_lru_left) > 0);
+		rc = l_wait_event_abortable(osc_lru_waitq,
+					    cl_cache_lru_left(cache) > 0);
 		goto again;
 	}
 
 	max_pages = cli->cl_max_pages_per_rpc * cli->cl_max_rpcs_in_flight;
-	if (atomic_long_read(cli->cl_lru_left) < max_pages) {
+	if (cl_cache_lru_left_cpt(cache, cpt) < max_pages) {
 		/* If there aren't enough pages in the per-OSC LRU then
 		 * wake up the LRU thread to try and clear out space, so
 		 * we don't block if pages are being dirtied quickly. */
-		CDEBUG(D_CACHE, "%s: queue LRU, left: %lu/%ld.\n",
-		       cli_name(cli), atomic_long_read(cli->cl_lru_left),
+		CDEBUG(D_CACHE, "%s: queue LRU, left: %ld/%ld.\n",
+		       cli_name(cli), cl_cache_lru_left_cpt(cache, cpt),
 		       max_pages);
 		(void)ptlrpcd_queue_work(cli->cl_lru_work);
 	}
@@ -891,7 +1004,8 @@ again:
  */
 void osc_lru_unreserve(struct client_obd *cli, unsigned long npages)
 {
-	atomic_long_add(npages, cli->cl_lru_left);
+	cl_cache_lru_put(cli->cl_cache, cfs_cpt_current(cfs_cpt_tab, 1),
+			 npages);
 	wake_up(&osc_lru_waitq);
 }
 
@@ -1084,7 +1198,7 @@ unsigned long osc_cache_shrink_count(struct shrinker *sk,
 
 	spin_lock(&osc_shrink_lock);
 	list_for_each_entry(cli, &osc_shrink_list, cl_shrink_list)
-		cached += atomic_long_read(&cli->cl_lru_in_list);
+		cached += cl_lru_in_list(cli);
 	spin_unlock(&osc_shrink_lock);
 
 	return (cached  * sysctl_vfs_cache_pressure) / 100;
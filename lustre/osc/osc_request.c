@@ -43,6 +43,7 @@
 #include <lustre_obdo.h>
 #include <obd.h>
 #include <obd_cksum.h>
+#include <obd_compress.h>
 #include <obd_class.h>
 #include <lustre_osc.h>
 #include <linux/falloc.h>
@@ -83,6 +84,32 @@ struct osc_ladvise_args {
 };
 
 static void osc_release_ppga(struct brw_page **ppga, size_t count);
+/**
+ * Account a completed BRW RPC to the per-job statistics of \a cli.
+ */
+static void osc_job_stats_brw(struct client_obd *cli,
+			      struct ptlrpc_request *req, int bytes)
+{
+	char *jobid = lustre_msg_get_jobid(req->rq_reqmsg);
+	/* not rq_sent_ns, the wall clock may step */
+	s64 usecs = ktime_us_delta(ktime_get(), req->rq_cli.cr_sent_mono);
+
+	if (jobid == NULL || jobid[0] == '\0')
+		return;
+
+	if (lustre_msg_get_opc(req->rq_reqmsg) == OST_WRITE) {
+		lprocfs_job_stats_add(&cli->cl_jobstats, jobid,
+				      LPROC_OSC_JOB_WRITE_BYTES, bytes);
+		lprocfs_job_stats_add(&cli->cl_jobstats, jobid,
+				      LPROC_OSC_JOB_WRITE, usecs);
+	} else {
+		lprocfs_job_stats_add(&cli->cl_jobstats, jobid,
+				      LPROC_OSC_JOB_READ_BYTES, bytes);
+		lprocfs_job_stats_add(&cli->cl_jobstats, jobid,
+				      LPROC_OSC_JOB_READ, usecs);
+	}
+}
+
 static int brw_interpret(const struct lu_env *env, struct ptlrpc_request *req,
 			 void *data, int rc);
 
@@ -1145,6 +1172,15 @@ static int check_write_rcs(struct ptlrpc_request *req,
                         return(-EPROTO);
                 }
         }
+	if (req->rq_bulk != NULL) {
+		struct ost_body *body;
+
+		/* compressed bulk is smaller than the data written */
+		body = req_capsule_client_get(&req->rq_pill, &RMF_OST_BODY);
+		if (body->oa.o_valid & OBD_MD_FLFLAGS &&
+		    body->oa.o_flags & OBD_FL_COMPRESSED)
+			requested_nob = body->oa.o_compr_nob;
+	}
 	if (req->rq_bulk != NULL &&
 	    req->rq_bulk->bd_nob_transferred != requested_nob) {
                 CERROR("Unexpected # bytes transferred: %d (requested %d)\n",
@@ -1388,6 +1424,176 @@ static inline void osc_release_bounce_pages(struct brw_page **pga,
 #endif
 }
 
+/* copy @len bytes of @buf, or zeros if @buf is NULL, at offset @off of the
+ * bulk held in @pages
+ */
+static int osc_compr_copy_to_pages(struct page **pages, unsigned int off,
+				   const char *buf, unsigned int len)
+{
+	while (len > 0) {
+		struct page **pg = &pages[off >> PAGE_SHIFT];
+		unsigned int poff = off & ~PAGE_MASK;
+		unsigned int count = min_t(unsigned int, len, PAGE_SIZE - poff);
+		char *ptr;
+
+		if (*pg == NULL) {
+			*pg = alloc_page(GFP_NOFS);
+			if (*pg == NULL)
+				return -ENOMEM;
+		}
+
+		ptr = kmap_atomic(*pg);
+		if (buf)
+			memcpy(ptr + poff, buf, count);
+		else
+			memset(ptr + poff, 0, count);
+		kunmap_atomic(ptr);
+
+		if (buf)
+			buf += count;
+		off += count;
+		len -= count;
+	}
+
+	return 0;
+}
+
+/**
+ * Compress the data of an OST_WRITE into newly allocated pages attached to
+ * \a desc, see struct ll_compr_chunk_hdr for the format of the bulk.
+ *
+ * The compressed bulk is only used if it is smaller than the data, so it
+ * never needs more pages than \a desc was prepared for.
+ *
+ * \retval positive	size of the compressed bulk
+ * \retval -E2BIG	the data does not compress
+ * \retval negative	other errors, the caller sends the data as is
+ */
+static int osc_brw_compress(struct client_obd *cli, enum ll_compr_type type,
+			    struct ptlrpc_bulk_desc *desc, u32 page_count,
+			    struct brw_page **pga, int nob)
+{
+	struct osc_compr_stats *stats;
+	struct page **pages;
+	char *src = NULL;
+	char *dst = NULL;
+	unsigned int npages = DIV_ROUND_UP(nob, PAGE_SIZE);
+	unsigned int bulk_nob = 0;
+	unsigned int pg_off = 0;
+	unsigned int chunks = 0;
+	unsigned int chunks_raw = 0;
+	ktime_t kstart = ktime_get();
+	int i = 0;
+	int rc = 0;
+
+	ENTRY;
+	OBD_ALLOC_PTR_ARRAY(pages, npages);
+	if (pages == NULL)
+		RETURN(-ENOMEM);
+	OBD_ALLOC_LARGE(src, LL_COMPR_CHUNK_SIZE);
+	OBD_ALLOC_LARGE(dst, LL_COMPR_CHUNK_SIZE);
+	if (src == NULL || dst == NULL)
+		GOTO(out, rc = -ENOMEM);
+
+	while (i < page_count) {
+		struct ll_compr_chunk_hdr hdr = {
+			.lcch_magic = LL_COMPR_CHUNK_MAGIC,
+			.lcch_type = type,
+		};
+		unsigned int len = 0;
+		unsigned int dst_len;
+		const char *data;
+
+		/* gather one chunk of data */
+		while (len < LL_COMPR_CHUNK_SIZE && i < page_count) {
+			struct brw_page *pg = pga[i];
+			unsigned int count;
+			char *ptr;
+
+			count = min_t(unsigned int, pg->count - pg_off,
+				      LL_COMPR_CHUNK_SIZE - len);
+			ptr = kmap_atomic(pg->pg);
+			memcpy(src + len, ptr + (pg->off & ~PAGE_MASK) + pg_off,
+			       count);
+			kunmap_atomic(ptr);
+
+			len += count;
+			pg_off += count;
+			if (pg_off == pg->count) {
+				pg_off = 0;
+				i++;
+			}
+		}
+
+		dst_len = len;
+		rc = obd_compress_chunk(type, src, len, dst, &dst_len);
+		if (rc == -EOPNOTSUPP || rc == -ENOMEM)
+			GOTO(out, rc);
+		if (rc != 0 || dst_len >= len) {
+			hdr.lcch_type = LL_COMPR_TYPE_NONE;
+			dst_len = len;
+			data = src;
+			chunks_raw++;
+		} else {
+			data = dst;
+		}
+		hdr.lcch_uncompr_size = len;
+		hdr.lcch_compr_size = dst_len;
+		chunks++;
+
+		if (bulk_nob + sizeof(hdr) + ll_compr_round(dst_len) >= nob)
+			GOTO(out, rc = -E2BIG);
+
+		rc = osc_compr_copy_to_pages(pages, bulk_nob,
+					     (const char *)&hdr, sizeof(hdr));
+		if (rc)
+			GOTO(out, rc);
+		bulk_nob += sizeof(hdr);
+
+		rc = osc_compr_copy_to_pages(pages, bulk_nob, data, dst_len);
+		if (rc == 0 && ll_compr_round(dst_len) != dst_len)
+			rc = osc_compr_copy_to_pages(pages, bulk_nob + dst_len,
+						     NULL,
+						     ll_compr_round(dst_len) -
+						     dst_len);
+		if (rc)
+			GOTO(out, rc);
+		bulk_nob += ll_compr_round(dst_len);
+	}
+
+	/* the desc holds its own page references, see pin ops */
+	for (i = 0; i < DIV_ROUND_UP(bulk_nob, PAGE_SIZE); i++)
+		desc->bd_frag_ops->add_kiov_frag(desc, pages[i], 0,
+					min_t(unsigned int, PAGE_SIZE,
+					      bulk_nob - i * PAGE_SIZE));
+	rc = bulk_nob;
+out:
+	stats = &obd2osc_dev(cli->cl_import->imp_obd)->od_compr_stats;
+	spin_lock(&cli->cl_loi_list_lock);
+	if (rc > 0) {
+		stats->ocs_rpcs++;
+		stats->ocs_chunks += chunks;
+		stats->ocs_chunks_raw += chunks_raw;
+		stats->ocs_bytes_in += nob;
+		stats->ocs_bytes_out += bulk_nob;
+	} else {
+		stats->ocs_rpcs_skipped++;
+	}
+	stats->ocs_usec += ktime_us_delta(ktime_get(), kstart);
+	spin_unlock(&cli->cl_loi_list_lock);
+
+	for (i = 0; i < npages; i++)
+		if (pages[i] != NULL)
+			put_page(pages[i]);
+	OBD_FREE_PTR_ARRAY(pages, npages);
+	if (src != NULL)
+		OBD_FREE_LARGE(src, LL_COMPR_CHUNK_SIZE);
+	if (dst != NULL)
+		OBD_FREE_LARGE(dst, LL_COMPR_CHUNK_SIZE);
+
+	RETURN(rc);
+}
+
 static int
 osc_brw_prep_request(int cmd, struct client_obd *cli, struct obdo *oa,
 		     u32 page_count, struct brw_page **pga,
@@ -1407,6 +1613,8 @@ osc_brw_prep_request(int cmd, struct client_obd *cli, struct obdo *oa,
 	struct inode *inode = NULL;
 	bool directio = false;
 	bool enable_checksum = true;
+	enum ll_compr_type compr_type = LL_COMPR_TYPE_NONE;
+	int compr_nob = 0;
 
 	ENTRY;
 	if (pga[0]->pg) {
@@ -1555,6 +1763,19 @@ retry_encrypt:
 		short_io_size = 0;
 	}
 
+	/* the compressed bulk replaces the pages, which cannot be done for
+	 * RDMA-only pages or encrypted data
+	 */
+	if (opc == OST_WRITE && pga[0]->pg &&
+	    !lnet_is_rdma_only_page(pga[0]->pg) &&
+	    imp_connect_compress(cli->cl_import) &&
+	    !(inode && IS_ENCRYPTED(inode))) {
+		struct osc_object *osc = brw_page2oap(pga[0])->oap_obj;
+
+		if (osc && osc->oo_oinfo)
+			compr_type = osc->oo_oinfo->loi_compr_type;
+	}
+
 	/* Check if read/write is small enough to be a short io. */
 	if (short_io_size > cli->cl_max_short_io_bytes || niocount > 1 ||
 	    !imp_connect_shortio(cli->cl_import))
@@ -1600,6 +1821,20 @@ retry_encrypt:
         if (desc == NULL)
                 GOTO(out, rc = -ENOMEM);
         /* NB request now owns desc and will free it when it gets freed */
+
+	/* nor for bulk protected by sptlrpc */
+	if (ll_compr_type_valid(compr_type) &&
+	    !sptlrpc_flavor_has_bulk(&req->rq_flvr)) {
+		for (i = 0; i < page_count; i++)
+			compr_nob += pga[i]->count;
+		compr_nob = osc_brw_compress(cli, compr_type, desc,
+					     page_count, pga, compr_nob);
+		if (compr_nob < 0) {
+			CDEBUG(D_PAGE, "%s: send uncompressed: rc = %d\n",
+			       obd_name, compr_nob);
+			compr_nob = 0;
+		}
+	}
 no_bulk:
         body = req_capsule_client_get(pill, &RMF_OST_BODY);
         ioobj = req_capsule_client_get(pill, &RMF_OBD_IOOBJ);
@@ -1644,6 +1879,15 @@ no_bulk:
 		}
 	}
 
+	if (compr_nob != 0) {
+		if ((body->oa.o_valid & OBD_MD_FLFLAGS) == 0) {
+			body->oa.o_valid |= OBD_MD_FLFLAGS;
+			body->oa.o_flags = 0;
+		}
+		body->oa.o_flags |= OBD_FL_COMPRESSED;
+		body->oa.o_compr_nob = compr_nob;
+	}
+
 	LASSERT(page_count > 0);
 	pg_prev = pga[0];
         for (requested_nob = i = 0; i < page_count; i++, niobuf++) {
@@ -1676,7 +1920,7 @@ no_bulk:
 			       ptr + poff,
 			       pg->count);
 			kunmap_atomic(ptr);
-		} else if (short_io_size == 0) {
+		} else if (short_io_size == 0 && compr_nob == 0) {
 			desc->bd_frag_ops->add_kiov_frag(desc, pg->pg, poff,
 							 pg->count);
 		}
@@ -2334,6 +2578,146 @@ static void osc_release_ppga(struct brw_page **ppga, size_t count)
 	OBD_FREE_PTR_ARRAY_LARGE(ppga, count);
 }
 
+/* the lowest RPC time is tracked over periods of this many seconds */
+#define OSC_RIF_BASE_PERIOD	10
+/* the window shrinks when the RPC time is over this % of its base */
+#define OSC_RIF_CONGESTED_PCT	200
+/* a full window grows while the RPC time is under this % of its base */
+#define OSC_RIF_IDLE_PCT	125
+
+/**
+ * Set the RPCs in flight window of \a cli, within its bounds, and record the
+ * change and its reason for osc.*.rpcs_in_flight_window.
+ */
+void osc_rif_change(struct client_obd *cli, __u32 window,
+		    enum client_rif_reason reason)
+{
+	struct client_rif_tuner *crt = &cli->cl_rif;
+	struct client_rif_change *rcc;
+
+	assert_spin_locked(&cli->cl_loi_list_lock);
+
+	window = clamp(window, crt->crt_min, cli->cl_max_rpcs_in_flight);
+	crt->crt_acked = 0;
+	crt->crt_limited = false;
+	if (window == crt->crt_window && reason != RIF_START)
+		return;
+
+	CDEBUG(D_CACHE, "%s: RPCs in flight window %u -> %u, reason %d, "
+	       "RPC time %uus, load %u%%\n", cli_name(cli), crt->crt_window,
+	       window, reason, crt->crt_srtt_us, crt->crt_load_pct);
+
+	rcc = &crt->crt_log[crt->crt_nchanges++ % CLIENT_RIF_LOG_SIZE];
+	rcc->rcc_time = ktime_get_real();
+	rcc->rcc_old = crt->crt_window;
+	rcc->rcc_new = window;
+	rcc->rcc_reason = reason;
+	rcc->rcc_srtt_us = crt->crt_srtt_us;
+	rcc->rcc_load_pct = crt->crt_load_pct;
+	crt->crt_changed = ktime_get();
+
+	if (window > crt->crt_window)
+		crt->crt_grown++;
+	else if (window < crt->crt_window)
+		crt->crt_shrunk++;
+	crt->crt_window = window;
+}
+
+/**
+ * Account the time of a completed BRW RPC of \a npages and, once per window
+ * of RPCs, grow the window by one if it was full and the RPC time stays close
+ * to the lowest one seen recently, or shrink it by a quarter if the RPC time
+ * grew well over it, i.e. RPCs queue up on the server or in the network.
+ *
+ * As the time of a BRW RPC depends on its size and direction, every RPC is
+ * compared to the lowest time of RPCs of the same direction and of a similar
+ * size, and only that ratio is smoothed.
+ */
+static void osc_rif_sample(struct client_obd *cli, struct ptlrpc_request *req,
+			   u32 npages, int rc)
+{
+	struct client_rif_tuner *crt = &cli->cl_rif;
+	ktime_t now = ktime_get();
+	__u32 *base;
+	__u32 *base_next;
+	__u32 load;
+	__u32 rtt;
+	int write;
+	int bucket;
+
+	assert_spin_locked(&cli->cl_loi_list_lock);
+
+	if (!crt->crt_enabled || rc != 0)
+		return;
+
+	rtt = clamp_t(s64, ktime_us_delta(now, req->rq_cli.cr_sent_mono), 1,
+		      U32_MAX);
+	if (rpcs_in_flight(cli) >= crt->crt_window)
+		crt->crt_limited = true;
+
+	crt->crt_srtt_us = crt->crt_srtt_us == 0 ? rtt :
+			   ((__u64)crt->crt_srtt_us * 7 + rtt) / 8;
+
+	/* let the base follow a slower path or server, as BBR does */
+	if (ktime_after(now, ktime_add(crt->crt_base_start,
+				       ktime_set(OSC_RIF_BASE_PERIOD, 0)))) {
+		for (write = 0; write < 2; write++) {
+			for (bucket = 0; bucket < CLIENT_RIF_BUCKETS;
+			     bucket++) {
+				base = &crt->crt_base_us[write][bucket];
+				base_next =
+					&crt->crt_base_next_us[write][bucket];
+				if (*base_next != 0)
+					*base = *base_next;
+				*base_next = 0;
+			}
+		}
+		crt->crt_base_start = now;
+	}
+
+	write = lustre_msg_get_opc(req->rq_reqmsg) == OST_WRITE;
+	bucket = min_t(int, ilog2(max_t(u32, npages, 1)),
+		       CLIENT_RIF_BUCKETS - 1);
+	base = &crt->crt_base_us[write][bucket];
+	base_next = &crt->crt_base_next_us[write][bucket];
+	if (*base == 0 || rtt < *base)
+		*base = rtt;
+	if (*base_next == 0 || rtt < *base_next)
+		*base_next = rtt;
+
+	load = min_t(__u64, div_u64((__u64)rtt * 100, *base), U32_MAX);
+	crt->crt_load_pct = crt->crt_load_pct == 0 ? load :
+			    ((__u64)crt->crt_load_pct * 7 + load) / 8;
+
+	if (++crt->crt_acked < crt->crt_window)
+		return;
+
+	if (crt->crt_load_pct > OSC_RIF_CONGESTED_PCT) {
+		osc_rif_change(cli, crt->crt_window * 3 / 4, RIF_LATENCY);
+	} else if (crt->crt_limited &&
+		   crt->crt_load_pct < OSC_RIF_IDLE_PCT) {
+		osc_rif_change(cli, crt->crt_window + 1, RIF_GROW);
+	} else {
+		crt->crt_acked = 0;
+		crt->crt_limited = false;
+	}
+}
+
+/**
+ * A BRW RPC is resent because it timed out or the server asked to retry
+ * later, halve the window, at most once per RPC time.
+ */
+static void osc_rif_resend(struct client_obd *cli)
+{
+	struct client_rif_tuner *crt = &cli->cl_rif;
+
+	spin_lock(&cli->cl_loi_list_lock);
+	if (crt->crt_enabled &&
+	    ktime_us_delta(ktime_get(), crt->crt_changed) > crt->crt_srtt_us)
+		osc_rif_change(cli, crt->crt_window / 2, RIF_RESEND);
+	spin_unlock(&cli->cl_loi_list_lock);
+}
+
 static int brw_interpret(const struct lu_env *env,
 			 struct ptlrpc_request *req, void *args, int rc)
 {
@@ -2365,6 +2749,8 @@ static int brw_interpret(const struct lu_env *env,
 		} else if (rc == -EINPROGRESS ||
 			   client_should_resend(aa->aa_resends, aa->aa_cli)) {
 			rc = osc_brw_redo_request(req, aa, rc);
+			if (rc == 0)
+				osc_rif_resend(cli);
 		} else {
 			CERROR("%s: too many resent retries for object: "
 			       "%llu:%llu, rc = %d.\n",
@@ -2449,8 +2835,11 @@ static int brw_interpret(const struct lu_env *env,
 
 	osc_release_ppga(aa->aa_ppga, aa->aa_page_count);
 	ptlrpc_lprocfs_brw(req, transferred);
+	if (rc == 0 && cli->cl_jobstats.ojs_hash != NULL)
+		osc_job_stats_brw(cli, req, transferred);
 
 	spin_lock(&cli->cl_loi_list_lock);
+	osc_rif_sample(cli, req, aa->aa_page_count, rc);
 	/* We need to decrement before osc_ap_completion->osc_wake_cache_waiters
 	 * is called so we know whether to go to sync BRWs or wait for more
 	 * RPCs to complete */
@@ -2632,12 +3021,18 @@ int osc_build_rpc(const struct lu_env *env, struct client_obd *cli,
 		lprocfs_oh_tally(&cli->cl_read_rpc_hist, cli->cl_r_in_flight);
 		lprocfs_oh_tally_log2(&cli->cl_read_offset_hist,
 				      starting_offset + 1);
+		lprocfs_oh_tally_log2(&cli->cl_read_nio_hist,
+				      aa->aa_nio_count);
+		cli->cl_read_niobufs += aa->aa_nio_count;
 	} else {
 		cli->cl_w_in_flight++;
 		lprocfs_oh_tally_log2(&cli->cl_write_page_hist, page_count);
 		lprocfs_oh_tally(&cli->cl_write_rpc_hist, cli->cl_w_in_flight);
 		lprocfs_oh_tally_log2(&cli->cl_write_offset_hist,
 				      starting_offset + 1);
+		lprocfs_oh_tally_log2(&cli->cl_write_nio_hist,
+				      aa->aa_nio_count);
+		cli->cl_write_niobufs += aa->aa_nio_count;
 	}
 	spin_unlock(&cli->cl_loi_list_lock);
 
@@ -3216,7 +3611,7 @@ int osc_set_info_async(const struct lu_env *env, struct obd_export *exp,
 
 	if (KEY_IS(KEY_CACHE_LRU_SHRINK)) {
 		struct client_obd *cli = &obd->u.cli;
-		long nr = atomic_long_read(&cli->cl_lru_in_list) >> 1;
+		long nr = cl_lru_in_list(cli) >> 1;
 		long target = *(long *)val;
 
 		nr = osc_lru_shrink(env, cli, min(nr, target), true);
@@ -3617,6 +4012,7 @@ static int osc_precleanup(struct obd_device *obd)
 	osc_precleanup_common(obd);
 
 	ptlrpc_lprocfs_unregister_obd(obd);
+	lprocfs_job_stats_unregister(&obd->u.cli.cl_jobstats);
 	RETURN(0);
 }
 
@@ -3637,7 +4033,6 @@ int osc_cleanup_common(struct obd_device *obd)
 		spin_lock(&cli->cl_cache->ccc_lru_lock);
 		list_del_init(&cli->cl_lru_osc);
 		spin_unlock(&cli->cl_cache->ccc_lru_lock);
-		cli->cl_lru_left = NULL;
 		cl_cache_decref(cli->cl_cache);
 		cli->cl_cache = NULL;
 	}
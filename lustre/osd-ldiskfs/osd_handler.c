@@ -7715,7 +7715,7 @@ static void osd_key_fini(const struct lu_context *ctx,
 				LASSERT(PageLocked(page));
 				ClearPagePrivate2(page);
 				unlock_page(page);
-				__free_page(page);
+				osd_bulk_pool_put_page(page);
 			}
 		}
 		OBD_FREE_PTR_ARRAY_LARGE(info->oti_dio_pages,
@@ -8078,6 +8078,7 @@ static struct lu_device *osd_device_fini(const struct lu_env *env,
 		osd_oi_fini(osd_oti_get(env), o);
 	if (o->od_extent_bytes_percpu)
 		free_percpu(o->od_extent_bytes_percpu);
+	osd_bulk_pool_cleanup(o);
 	osd_obj_map_fini(o);
 	osd_umount(env, o);
 
@@ -8215,6 +8216,8 @@ static int osd_device_init0(const struct lu_env *env,
 		GOTO(out_procfs, rc);
 	}
 
+	osd_bulk_pool_setup(o);
+
 	RETURN(0);
 
 out_procfs:
@@ -8557,6 +8560,12 @@ static int __init osd_init(void)
 	if (rc)
 		return rc;
 
+	rc = osd_bulk_pool_init();
+	if (rc) {
+		lu_kmem_fini(ldiskfs_caches);
+		return rc;
+	}
+
 #ifdef CONFIG_KALLSYMS
 	priv_security_file_alloc =
 		(void *)cfs_kallsyms_lookup_name("security_file_alloc");
@@ -8565,6 +8574,7 @@ static int __init osd_init(void)
 	rc = class_register_type(&osd_obd_device_ops, NULL, true,
 				 LUSTRE_OSD_LDISKFS_NAME, &osd_device_type);
 	if (rc) {
+		osd_bulk_pool_fini();
 		lu_kmem_fini(ldiskfs_caches);
 		return rc;
 	}
@@ -8593,6 +8603,7 @@ static void __exit osd_exit(void)
 		kobject_put(kobj);
 	}
 	class_unregister_type(LUSTRE_OSD_LDISKFS_NAME);
+	osd_bulk_pool_fini();
 	lu_kmem_fini(ldiskfs_caches);
 }
 
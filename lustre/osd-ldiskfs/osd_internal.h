@@ -277,7 +277,8 @@ struct osd_device {
 	/* Other flags */
 				  od_read_cache:1,
 				  od_writethrough_cache:1,
-				  od_nonrotational:1;
+				  od_nonrotational:1,
+				  od_bulk_pool:1; /* uses osd_bulk_pools */
 
 
 	__u32			  od_dirent_journal;
@@ -474,6 +475,11 @@ enum {
         LPROC_OSD_CACHE_ACCESS  = 4,
         LPROC_OSD_CACHE_HIT     = 5,
         LPROC_OSD_CACHE_MISS    = 6,
+	LPROC_OSD_READ_IO_TIME	= 7,
+	LPROC_OSD_WRITE_IO_TIME	= 8,
+	LPROC_OSD_BULK_POOL_HIT	= 9,
+	LPROC_OSD_BULK_POOL_ALLOC = 10,
+	LPROC_OSD_BULK_POOL_REMOTE = 11,
 
 #if OSD_THANDLE_STATS
         LPROC_OSD_THANDLE_STARTING,
@@ -1578,6 +1584,13 @@ void osd_trunc_unlock_all(const struct lu_env *env, struct list_head *list);
 void osd_process_truncates(const struct lu_env *env, struct list_head *list);
 void osd_execute_truncate(struct osd_object *obj);
 
+int osd_bulk_pool_init(void);
+void osd_bulk_pool_fini(void);
+void osd_bulk_pool_setup(struct osd_device *o);
+void osd_bulk_pool_cleanup(struct osd_device *o);
+void osd_bulk_pool_put_page(struct page *page);
+int osd_bulk_pool_seq_show(struct seq_file *m);
+
 #ifdef HAVE_BIO_ENDIO_USES_ONE_ARG
 #define osd_dio_complete_routine(bio, error) dio_complete_routine(bio)
 #else
@@ -154,6 +154,8 @@ void osd_fini_iobuf(struct osd_device *d, struct osd_iobuf *iobuf)
 				 iobuf->dr_frags);
 		lprocfs_oh_tally_log2(&d->od_brw_stats.bs_hist[BRW_R_IO_TIME+rw],
 				      ktime_to_ms(iobuf->dr_elapsed));
+		lprocfs_counter_add(d->od_stats, LPROC_OSD_READ_IO_TIME + rw,
+				    ktime_to_us(iobuf->dr_elapsed));
 	}
 }
 
@@ -693,6 +695,244 @@ static int osd_map_remote_to_local(loff_t offset, ssize_t len, int *nrpages,
 	RETURN(rc);
 }
 
+/*
+ * Pages of the I/O bypassing the page cache are kept by each service thread
+ * in osd_thread_info::oti_dio_pages and are reused for all its bulk I/O.
+ * With osd_bulk_pool_mb set, the OSTs take them first from a pool
+ * preallocated on the NUMA node(s) of the CPU partition the thread runs on,
+ * so the buffers the network DMAs in and out of stay local to the thread and
+ * to the NI serving that partition.  The pool is sized when the first OST
+ * using it is set up.
+ */
+static unsigned int osd_bulk_pool_mb;
+module_param(osd_bulk_pool_mb, uint, 0644);
+MODULE_PARM_DESC(osd_bulk_pool_mb,
+		 "MiB of bulk I/O pages preallocated for each CPU partition on OSTs (0 to disable, default)");
+
+struct osd_bulk_pool {
+	spinlock_t		obp_lock;
+	struct list_head	obp_pages;
+	/* pages in obp_pages */
+	unsigned int		obp_free;
+	/* pool capacity, zero if no osd device is set up */
+	unsigned int		obp_max;
+};
+
+static struct osd_bulk_pool **osd_bulk_pools;
+static DEFINE_MUTEX(osd_bulk_pool_mutex);
+static int osd_bulk_pool_users;
+
+static struct page *osd_bulk_pool_get_page(int cpt)
+{
+	struct osd_bulk_pool *pool = osd_bulk_pools[cpt];
+	struct page *page = NULL;
+
+	if (!READ_ONCE(pool->obp_free))
+		return NULL;
+
+	spin_lock(&pool->obp_lock);
+	if (pool->obp_free) {
+		page = list_first_entry(&pool->obp_pages, struct page, lru);
+		list_del_init(&page->lru);
+		pool->obp_free--;
+	}
+	spin_unlock(&pool->obp_lock);
+
+	return page;
+}
+
+/* return a page to the pool of its node, or free it if that one is full */
+void osd_bulk_pool_put_page(struct page *page)
+{
+	struct osd_bulk_pool *pool;
+	int cpt;
+
+	cpt = cfs_cpt_of_node(cfs_cpt_tab, page_to_nid(page));
+	if (cpt < 0)
+		goto out_free;
+
+	pool = osd_bulk_pools[cpt];
+	spin_lock(&pool->obp_lock);
+	if (pool->obp_free < pool->obp_max) {
+		list_add(&page->lru, &pool->obp_pages);
+		pool->obp_free++;
+		page = NULL;
+	}
+	spin_unlock(&pool->obp_lock);
+out_free:
+	if (page)
+		__free_page(page);
+}
+
+static void osd_bulk_pool_drain(struct osd_bulk_pool *pool)
+{
+	struct page *page;
+	LIST_HEAD(pages);
+
+	spin_lock(&pool->obp_lock);
+	pool->obp_max = 0;
+	pool->obp_free = 0;
+	list_splice_init(&pool->obp_pages, &pages);
+	spin_unlock(&pool->obp_lock);
+
+	while (!list_empty(&pages)) {
+		page = list_first_entry(&pages, struct page, lru);
+		list_del(&page->lru);
+		__free_page(page);
+	}
+}
+
+/**
+ * Fill the bulk page pools when the first OST using them is set up.
+ *
+ * Allocations are done on the nodes of each partition only, and stop
+ * quietly on failure: the threads then allocate the missing pages later.
+ */
+void osd_bulk_pool_setup(struct osd_device *o)
+{
+	struct osd_bulk_pool *pool;
+	unsigned int max;
+	int i;
+
+	max = READ_ONCE(osd_bulk_pool_mb) << (20 - PAGE_SHIFT);
+	if (!o->od_is_ost || !max)
+		return;
+
+	mutex_lock(&osd_bulk_pool_mutex);
+	o->od_bulk_pool = 1;
+	if (osd_bulk_pool_users++ > 0)
+		goto out;
+
+	cfs_percpt_for_each(pool, i, osd_bulk_pools) {
+		LIST_HEAD(pages);
+		unsigned int count;
+		struct page *page;
+
+		for (count = 0; count < max; count++) {
+			page = cfs_page_cpt_alloc(cfs_cpt_tab, i,
+						  GFP_HIGHUSER | __GFP_THISNODE |
+						  __GFP_NORETRY | __GFP_NOWARN);
+			if (!page)
+				break;
+			list_add(&page->lru, &pages);
+		}
+
+		spin_lock(&pool->obp_lock);
+		list_splice(&pages, &pool->obp_pages);
+		pool->obp_free += count;
+		pool->obp_max = max;
+		spin_unlock(&pool->obp_lock);
+
+		if (count < max)
+			CDEBUG(D_INFO,
+			       "cpt %d: preallocated %u of %u bulk pages\n",
+			       i, count, max);
+	}
+out:
+	mutex_unlock(&osd_bulk_pool_mutex);
+}
+
+void osd_bulk_pool_cleanup(struct osd_device *o)
+{
+	struct osd_bulk_pool *pool;
+	int i;
+
+	if (!o->od_bulk_pool)
+		return;
+
+	mutex_lock(&osd_bulk_pool_mutex);
+	o->od_bulk_pool = 0;
+	LASSERT(osd_bulk_pool_users > 0);
+	if (--osd_bulk_pool_users == 0) {
+		cfs_percpt_for_each(pool, i, osd_bulk_pools)
+			osd_bulk_pool_drain(pool);
+	}
+	mutex_unlock(&osd_bulk_pool_mutex);
+}
+
+int osd_bulk_pool_seq_show(struct seq_file *m)
+{
+	struct osd_bulk_pool *pool;
+	int i;
+
+	seq_printf(m, "%-5s %10s %10s\n", "cpt", "max", "free");
+	cfs_percpt_for_each(pool, i, osd_bulk_pools)
+		seq_printf(m, "%-5d %10u %10u\n", i,
+			   READ_ONCE(pool->obp_max), READ_ONCE(pool->obp_free));
+
+	return 0;
+}
+
+int osd_bulk_pool_init(void)
+{
+	struct osd_bulk_pool *pool;
+	int i;
+
+	osd_bulk_pools = cfs_percpt_alloc(cfs_cpt_tab, sizeof(*pool));
+	if (!osd_bulk_pools)
+		return -ENOMEM;
+
+	cfs_percpt_for_each(pool, i, osd_bulk_pools) {
+		spin_lock_init(&pool->obp_lock);
+		INIT_LIST_HEAD(&pool->obp_pages);
+	}
+
+	return 0;
+}
+
+void osd_bulk_pool_fini(void)
+{
+	struct osd_bulk_pool *pool;
+	int i;
+
+	cfs_percpt_for_each(pool, i, osd_bulk_pools)
+		LASSERT(list_empty(&pool->obp_pages));
+	cfs_percpt_free(osd_bulk_pools);
+}
+
+/**
+ * Allocate a page for the I/O bypassing the page cache.
+ *
+ * On an OST using the bulk page pools, pages come from the pool of the
+ * current CPU partition, or are allocated on its nodes, or as a last resort
+ * are taken from the pool of any other partition.
+ */
+static struct page *osd_bulk_page_alloc(struct osd_device *d, gfp_t gfp_mask)
+{
+	struct page *page;
+	int cpt;
+	int i;
+
+	if (!d->od_bulk_pool)
+		return alloc_page(gfp_mask);
+
+	cpt = cfs_cpt_current(cfs_cpt_tab, 1);
+	page = osd_bulk_pool_get_page(cpt);
+	if (page) {
+		lprocfs_counter_incr(d->od_stats, LPROC_OSD_BULK_POOL_HIT);
+		return page;
+	}
+
+	page = cfs_page_cpt_alloc(cfs_cpt_tab, cpt, gfp_mask);
+	if (page) {
+		lprocfs_counter_incr(d->od_stats, LPROC_OSD_BULK_POOL_ALLOC);
+		return page;
+	}
+
+	for (i = 0; i < cfs_cpt_number(cfs_cpt_tab); i++) {
+		if (i == cpt)
+			continue;
+		page = osd_bulk_pool_get_page(i);
+		if (page) {
+			lprocfs_counter_incr(d->od_stats,
+					     LPROC_OSD_BULK_POOL_REMOTE);
+			return page;
+		}
+	}
+
+	return NULL;
+}
+
 static struct page *osd_get_page(const struct lu_env *env, struct dt_object *dt,
 				 loff_t offset, gfp_t gfp_mask, bool cache)
 {
@@ -734,7 +974,7 @@ static struct page *osd_get_page(const struct lu_env *env, struct dt_object *dt,
 
 	if (unlikely(!page)) {
 		LASSERT(cur < PTLRPC_MAX_BRW_PAGES);
-		page = alloc_page(gfp_mask);
+		page = osd_bulk_page_alloc(d, gfp_mask);
 		if (!page)
 			return NULL;
 		oti->oti_dio_pages[cur] = page;
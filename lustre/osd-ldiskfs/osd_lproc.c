@@ -207,6 +207,23 @@ static int osd_stats_init(struct osd_device *osd)
                 lprocfs_counter_init(osd->od_stats, LPROC_OSD_CACHE_MISS,
                                      LPROCFS_CNTR_AVGMINMAX,
                                      "cache_miss", "pages");
+		lprocfs_counter_init(osd->od_stats, LPROC_OSD_READ_IO_TIME,
+				     LPROCFS_TYPE_LATENCY |
+				     LPROCFS_CNTR_HISTOGRAM,
+				     "read_io_time", "usec");
+		lprocfs_counter_init(osd->od_stats, LPROC_OSD_WRITE_IO_TIME,
+				     LPROCFS_TYPE_LATENCY |
+				     LPROCFS_CNTR_HISTOGRAM,
+				     "write_io_time", "usec");
+		lprocfs_counter_init(osd->od_stats, LPROC_OSD_BULK_POOL_HIT,
+				     LPROCFS_CNTR_AVGMINMAX,
+				     "bulk_pool_hit", "pages");
+		lprocfs_counter_init(osd->od_stats, LPROC_OSD_BULK_POOL_ALLOC,
+				     LPROCFS_CNTR_AVGMINMAX,
+				     "bulk_pool_alloc", "pages");
+		lprocfs_counter_init(osd->od_stats, LPROC_OSD_BULK_POOL_REMOTE,
+				     LPROCFS_CNTR_AVGMINMAX,
+				     "bulk_pool_remote", "pages");
 #if OSD_THANDLE_STATS
                 lprocfs_counter_init(osd->od_stats, LPROC_OSD_THANDLE_STARTING,
                                      LPROCFS_CNTR_AVGMINMAX,
@@ -218,6 +235,12 @@ static int osd_stats_init(struct osd_device *osd)
                                      LPROCFS_CNTR_AVGMINMAX,
                                      "thandle closing", "usec");
 #endif
+		result = lprocfs_register_stats_hist(osd->od_proc_entry,
+						     "stats_hist",
+						     osd->od_stats);
+		if (result)
+			GOTO(out, result);
+
 		result = lprocfs_seq_create(osd->od_proc_entry, "brw_stats",
 					    0644, &osd_brw_stats_fops, osd);
         } else
@@ -605,6 +628,13 @@ static int ldiskfs_osd_oi_scrub_seq_show(struct seq_file *m, void *data)
 
 LDEBUGFS_SEQ_FOPS_RO(ldiskfs_osd_oi_scrub);
 
+static int ldiskfs_osd_bulk_page_pool_seq_show(struct seq_file *m, void *data)
+{
+	return osd_bulk_pool_seq_show(m);
+}
+
+LDEBUGFS_SEQ_FOPS_RO(ldiskfs_osd_bulk_page_pool);
+
 static int ldiskfs_osd_readcache_seq_show(struct seq_file *m, void *data)
 {
 	struct osd_device *osd = osd_dt_dev((struct dt_device *)m->private);
@@ -858,6 +888,8 @@ LUSTRE_RW_ATTR(index_backup);
 struct ldebugfs_vars ldebugfs_osd_obd_vars[] = {
 	{ .name	=	"oi_scrub",
 	  .fops	=	&ldiskfs_osd_oi_scrub_fops	},
+	{ .name	=	"bulk_page_pool",
+	  .fops	=	&ldiskfs_osd_bulk_page_pool_fops	},
 	{ .name	=	"readcache_max_filesize",
 	  .fops	=	&ldiskfs_osd_readcache_fops	},
 	{ .name	=	"readcache_max_io_mb",
@@ -1368,6 +1368,62 @@ static int ptlrpc_check_status(struct ptlrpc_request *req)
 	RETURN(rc);
 }
 
+/**
+ * Attach the sub-reply \a msg of a batched RPC to the sub-request \a req,
+ * which was packed into the batch instead of being sent on its own, so that
+ * it can be completed as if the reply had been received for it directly.
+ *
+ * \a len is the number of bytes left in the batched reply buffer, on success
+ * it is set to the packed size of \a msg.  The status of the sub-request is
+ * stored in \a req->rq_status.
+ */
+int ptlrpc_batch_subreq_reply(struct ptlrpc_request *req,
+			      struct lustre_msg *msg, int *len)
+{
+	int swabbed;
+	int rc;
+
+	ENTRY;
+	LASSERT(req->rq_repbuf == NULL);
+
+	swabbed = __lustre_unpack_msg(msg, *len);
+	if (swabbed < 0)
+		RETURN(swabbed);
+
+	*len = lustre_packed_msg_size(msg);
+	rc = sptlrpc_cli_alloc_repbuf(req, *len);
+	if (rc)
+		RETURN(rc);
+
+	memcpy(req->rq_repbuf, msg, *len);
+	req->rq_repdata = req->rq_repbuf;
+	req->rq_repdata_len = *len;
+	req->rq_repmsg = req->rq_repbuf;
+	req->rq_nob_received = *len;
+	if (swabbed)
+		req_capsule_set_rep_swabbed(&req->rq_pill,
+					    MSG_PTLRPC_HEADER_OFF);
+
+	rc = lustre_unpack_rep_ptlrpc_body(req, MSG_PTLRPC_BODY_OFF);
+	if (rc)
+		RETURN(-EPROTO);
+
+	if (lustre_msg_get_type(req->rq_repmsg) != PTL_RPC_MSG_REPLY &&
+	    lustre_msg_get_type(req->rq_repmsg) != PTL_RPC_MSG_ERR) {
+		DEBUG_REQ(D_ERROR, req, "invalid sub-reply (type=%u)",
+			  lustre_msg_get_type(req->rq_repmsg));
+		RETURN(-EPROTO);
+	}
+
+	spin_lock(&req->rq_lock);
+	req->rq_replied = 1;
+	spin_unlock(&req->rq_lock);
+	req->rq_status = ptlrpc_check_status(req);
+
+	RETURN(0);
+}
+EXPORT_SYMBOL(ptlrpc_batch_subreq_reply);
+
 /**
  * save pre-versions of objects into request for replay.
  * Versions are obtained from server reply.
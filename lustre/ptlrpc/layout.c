@@ -353,6 +353,17 @@ static const struct req_msg_field *mds_rmfid_server[] = {
 	&RMF_RCS,
 };
 
+static const struct req_msg_field *mds_msg_batch_client[] = {
+	&RMF_PTLRPC_BODY,
+	&RMF_MSG_BATCH_HEADER,
+	&RMF_MSG_BATCH_BUF,
+};
+
+static const struct req_msg_field *mds_msg_batch_server[] = {
+	&RMF_PTLRPC_BODY,
+	&RMF_MSG_BATCH_REPLY,
+};
+
 static const struct req_msg_field *obd_connect_client[] = {
 	&RMF_PTLRPC_BODY,
 	&RMF_TGTUUID,
@@ -803,6 +814,7 @@ static struct req_format *req_formats[] = {
 	&RQF_MDS_HSM_REQUEST,
 	&RQF_MDS_SWAP_LAYOUTS,
 	&RQF_MDS_RMFID,
+	&RQF_MDS_MSG_BATCH,
 #ifdef HAVE_SERVER_SUPPORT
 	&RQF_OUT_UPDATE,
 #endif
@@ -1036,6 +1048,20 @@ struct req_msg_field RMF_FID_ARRAY =
 	DEFINE_MSGF("fid_array", 0, -1, NULL, NULL);
 EXPORT_SYMBOL(RMF_FID_ARRAY);
 
+struct req_msg_field RMF_MSG_BATCH_HEADER =
+	DEFINE_MSGF("msg_batch_header", 0, sizeof(struct msg_batch_header),
+		    lustre_swab_msg_batch_header, NULL);
+EXPORT_SYMBOL(RMF_MSG_BATCH_HEADER);
+
+struct req_msg_field RMF_MSG_BATCH_BUF =
+	DEFINE_MSGF("msg_batch_buf", 0, -1, NULL, NULL);
+EXPORT_SYMBOL(RMF_MSG_BATCH_BUF);
+
+struct req_msg_field RMF_MSG_BATCH_REPLY =
+	DEFINE_MSGF("msg_batch_reply", 0, -1,
+		    lustre_swab_msg_batch_reply, NULL);
+EXPORT_SYMBOL(RMF_MSG_BATCH_REPLY);
+
 struct req_msg_field RMF_SYMTGT =
 	DEFINE_MSGF("symtgt", 0, -1, NULL, NULL);
 EXPORT_SYMBOL(RMF_SYMTGT);
@@ -1654,6 +1680,11 @@ struct req_format RQF_MDS_RMFID =
 			mds_rmfid_server);
 EXPORT_SYMBOL(RQF_MDS_RMFID);
 
+struct req_format RQF_MDS_MSG_BATCH =
+	DEFINE_REQ_FMT0("MDS_MSG_BATCH", mds_msg_batch_client,
+			mds_msg_batch_server);
+EXPORT_SYMBOL(RQF_MDS_MSG_BATCH);
+
 struct req_format RQF_LLOG_ORIGIN_HANDLE_CREATE =
         DEFINE_REQ_FMT0("LLOG_ORIGIN_HANDLE_CREATE",
                         llog_origin_handle_create_client, llogd_body_only);
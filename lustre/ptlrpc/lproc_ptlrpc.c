@@ -97,6 +97,9 @@ static struct ll_rpc_opcode {
 	{ MDS_HSM_CT_UNREGISTER, "mds_hsm_ct_unregister" },
 	{ MDS_SWAP_LAYOUTS,	"mds_swap_layouts" },
 	{ MDS_RMFID,        "mds_rmfid" },
+	{ MDS_BATCH,        "mds_batch" },
+	{ MDS_HSM_DATA_VERSION, "mds_hsm_data_version" },
+	{ MDS_MSG_BATCH,    "mds_msg_batch" },
 	{ LDLM_ENQUEUE,     "ldlm_enqueue" },
 	{ LDLM_CONVERT,     "ldlm_convert" },
 	{ LDLM_CANCEL,      "ldlm_cancel" },
@@ -200,9 +203,14 @@ static const char *ll_eopcode2str(__u32 opcode)
 	return ll_eopcode_table[opcode].opname;
 }
 
+/*
+ * Services also keep histograms of the wait and service times of their
+ * requests, in \a name "_hist"; they cost too much memory per CPU for
+ * every client import.
+ */
 static void
 ptlrpc_ldebugfs_register(struct dentry *root, char *dir, char *name,
-			 struct dentry **debugfs_root_ret,
+			 bool service, struct dentry **debugfs_root_ret,
 			 struct lprocfs_stats **stats_ret)
 {
 	struct dentry *svc_debugfs_entry;
@@ -210,6 +218,11 @@ ptlrpc_ldebugfs_register(struct dentry *root, char *dir, char *name,
 	int i;
 	unsigned int svc_counter_config = LPROCFS_CNTR_AVGMINMAX |
 					  LPROCFS_CNTR_STDDEV;
+	unsigned int svc_hist_config = svc_counter_config;
+	char hist_name[32];
+
+	if (service)
+		svc_hist_config |= LPROCFS_CNTR_HISTOGRAM;
 
 	LASSERT(!*debugfs_root_ret);
 	LASSERT(!*stats_ret);
@@ -225,7 +238,7 @@ ptlrpc_ldebugfs_register(struct dentry *root, char *dir, char *name,
 		svc_debugfs_entry = root;
 
 	lprocfs_counter_init(svc_stats, PTLRPC_REQWAIT_CNTR,
-			     svc_counter_config, "req_waittime", "usec");
+			     svc_hist_config, "req_waittime", "usec");
 	lprocfs_counter_init(svc_stats, PTLRPC_REQQDEPTH_CNTR,
 			     svc_counter_config, "req_qdepth", "reqs");
 	lprocfs_counter_init(svc_stats, PTLRPC_REQACTIVE_CNTR,
@@ -234,6 +247,10 @@ ptlrpc_ldebugfs_register(struct dentry *root, char *dir, char *name,
 			     svc_counter_config, "req_timeout", "sec");
 	lprocfs_counter_init(svc_stats, PTLRPC_REQBUF_AVAIL_CNTR,
 			     svc_counter_config, "reqbuf_avail", "bufs");
+	lprocfs_counter_init(svc_stats, PTLRPC_REPCOMMIT_CNTR,
+			     svc_counter_config, "rep_commit_free", "usec");
+	lprocfs_counter_init(svc_stats, PTLRPC_REQSERVICE_CNTR,
+			     svc_hist_config, "req_service", "usec");
 	for (i = 0; i < EXTRA_LAST_OPC; i++) {
 		char *units;
 
@@ -260,6 +277,11 @@ ptlrpc_ldebugfs_register(struct dentry *root, char *dir, char *name,
 
 	debugfs_create_file(name, 0644, svc_debugfs_entry, svc_stats,
 			    &ldebugfs_stats_seq_fops);
+	if (service) {
+		snprintf(hist_name, sizeof(hist_name), "%s_hist", name);
+		debugfs_create_file(hist_name, 0444, svc_debugfs_entry,
+				    svc_stats, &ldebugfs_stats_hist_seq_fops);
+	}
 
 	if (dir)
 		*debugfs_root_ret = svc_debugfs_entry;
@@ -476,6 +498,97 @@ static ssize_t threads_max_store(struct kobject *kobj, struct attribute *attr,
 }
 LUSTRE_RW_ATTR(threads_max);
 
+static ssize_t threads_adaptive_show(struct kobject *kobj,
+				     struct attribute *attr, char *buf)
+{
+	struct ptlrpc_service *svc = container_of(kobj, struct ptlrpc_service,
+						  srv_kobj);
+
+	return sprintf(buf, "%u\n", svc->srv_thrctl_enabled);
+}
+
+static ssize_t threads_adaptive_store(struct kobject *kobj,
+				      struct attribute *attr,
+				      const char *buffer, size_t count)
+{
+	struct ptlrpc_service *svc = container_of(kobj, struct ptlrpc_service,
+						  srv_kobj);
+	bool val;
+	int rc;
+
+	rc = kstrtobool(buffer, &val);
+	if (rc < 0)
+		return rc;
+
+	WRITE_ONCE(svc->srv_thrctl_enabled, val);
+
+	return count;
+}
+LUSTRE_RW_ATTR(threads_adaptive);
+
+static ssize_t threads_adaptive_wait_us_show(struct kobject *kobj,
+					     struct attribute *attr, char *buf)
+{
+	struct ptlrpc_service *svc = container_of(kobj, struct ptlrpc_service,
+						  srv_kobj);
+
+	return sprintf(buf, "%u\n", svc->srv_thrctl_wait_us);
+}
+
+static ssize_t threads_adaptive_wait_us_store(struct kobject *kobj,
+					      struct attribute *attr,
+					      const char *buffer, size_t count)
+{
+	struct ptlrpc_service *svc = container_of(kobj, struct ptlrpc_service,
+						  srv_kobj);
+	unsigned int val;
+	int rc;
+
+	rc = kstrtouint(buffer, 10, &val);
+	if (rc < 0)
+		return rc;
+
+	if (val == 0)
+		return -ERANGE;
+
+	WRITE_ONCE(svc->srv_thrctl_wait_us, val);
+
+	return count;
+}
+LUSTRE_RW_ATTR(threads_adaptive_wait_us);
+
+static ssize_t threads_steal_show(struct kobject *kobj,
+				  struct attribute *attr, char *buf)
+{
+	struct ptlrpc_service *svc = container_of(kobj, struct ptlrpc_service,
+						  srv_kobj);
+
+	return sprintf(buf, "%u\n", svc->srv_steal_enabled);
+}
+
+static ssize_t threads_steal_store(struct kobject *kobj,
+				   struct attribute *attr,
+				   const char *buffer, size_t count)
+{
+	struct ptlrpc_service *svc = container_of(kobj, struct ptlrpc_service,
+						  srv_kobj);
+	bool val;
+	int rc;
+
+	rc = kstrtobool(buffer, &val);
+	if (rc < 0)
+		return rc;
+
+	/* nothing to steal from with a single partition */
+	if (val && svc->srv_ncpts < 2)
+		return -EOPNOTSUPP;
+
+	WRITE_ONCE(svc->srv_steal_enabled, val);
+
+	return count;
+}
+LUSTRE_RW_ATTR(threads_steal);
+
 /**
  * Translates \e ptlrpc_nrs_pol_state values to human-readable strings.
  *
@@ -1123,6 +1236,87 @@ static int ptlrpc_lprocfs_timeouts_seq_show(struct seq_file *m, void *n)
 
 LDEBUGFS_SEQ_FOPS_RO(ptlrpc_lprocfs_timeouts);
 
+static const char * const ptlrpc_thrctl_decisions[] = {
+	[PTLRPC_THRCTL_OFF]	 = "off",
+	[PTLRPC_THRCTL_HOLD]	 = "hold",
+	[PTLRPC_THRCTL_GROW]	 = "grow",
+	[PTLRPC_THRCTL_SHRINK]	 = "shrink",
+	[PTLRPC_THRCTL_CPU_BUSY] = "cpu_busy",
+};
+
+/**
+ * Shows the last decision of the adaptive thread pool controller on each
+ * partition of a service, and the measures it was based on.
+ */
+static int ptlrpc_lprocfs_threads_adaptive_stats_seq_show(struct seq_file *m,
+							  void *n)
+{
+	struct ptlrpc_service *svc = m->private;
+	struct ptlrpc_service_part *svcpt;
+	struct ptlrpc_thrctl tcl;
+	int running;
+	int target;
+	int i;
+
+	ptlrpc_service_for_each_part(svcpt, i, svc) {
+		spin_lock(&svcpt->scp_lock);
+		tcl = svcpt->scp_thrctl;
+		running = svcpt->scp_nthrs_running;
+		target = svcpt->scp_nthrs_target;
+		spin_unlock(&svcpt->scp_lock);
+
+		seq_printf(m, "- cpt: %d\n"
+			   "  threads_running: %d\n"
+			   "  threads_target: %d\n"
+			   "  queue_wait_usec: %llu\n"
+			   "  cpu_busy_pct: %d\n"
+			   "  active_max: %d\n"
+			   "  quiet_intervals: %d\n"
+			   "  decision: %s\n"
+			   "  grown: %llu\n"
+			   "  shrunk: %llu\n",
+			   svcpt->scp_cpt, running, target, tcl.tcl_wait_us,
+			   tcl.tcl_cpu_busy, tcl.tcl_active, tcl.tcl_quiet,
+			   ptlrpc_thrctl_decisions[tcl.tcl_decision],
+			   tcl.tcl_grown, tcl.tcl_shrunk);
+	}
+
+	return 0;
+}
+
+LDEBUGFS_SEQ_FOPS_RO(ptlrpc_lprocfs_threads_adaptive_stats);
+
+/**
+ * Shows, for each partition of a service, how many of its requests were
+ * handled by threads of other partitions, and how many requests of other
+ * partitions its threads handled.
+ */
+static int ptlrpc_lprocfs_threads_steal_stats_seq_show(struct seq_file *m,
+						       void *n)
+{
+	struct ptlrpc_service *svc = m->private;
+	struct ptlrpc_service_part *svcpt;
+	__u64 stolen;
+	__u64 steals;
+	int i;
+
+	ptlrpc_service_for_each_part(svcpt, i, svc) {
+		spin_lock(&svcpt->scp_req_lock);
+		stolen = svcpt->scp_nreqs_stolen;
+		steals = svcpt->scp_nreqs_steals;
+		spin_unlock(&svcpt->scp_req_lock);
+
+		seq_printf(m, "- cpt: %d\n"
+			   "  stolen_rpcs: %llu\n"
+			   "  steal_rpcs: %llu\n",
+			   svcpt->scp_cpt, stolen, steals);
+	}
+
+	return 0;
+}
+
+LDEBUGFS_SEQ_FOPS_RO(ptlrpc_lprocfs_threads_steal_stats);
+
 static ssize_t high_priority_ratio_show(struct kobject *kobj,
 					struct attribute *attr,
 					char *buf)
@@ -1159,6 +1353,9 @@ static struct attribute *ptlrpc_svc_attrs[] = {
 	&lustre_attr_threads_min.attr,
 	&lustre_attr_threads_started.attr,
 	&lustre_attr_threads_max.attr,
+	&lustre_attr_threads_adaptive.attr,
+	&lustre_attr_threads_adaptive_wait_us.attr,
+	&lustre_attr_threads_steal.attr,
 	&lustre_attr_high_priority_ratio.attr,
 	NULL,
 };
@@ -1214,6 +1411,12 @@ void ptlrpc_ldebugfs_register_service(struct dentry *entry,
 		{ .name = "req_buffers_max",
 		  .fops = &ptlrpc_lprocfs_req_buffers_max_fops,
 		  .data = svc },
+		{ .name = "threads_adaptive_stats",
+		  .fops = &ptlrpc_lprocfs_threads_adaptive_stats_fops,
+		  .data = svc },
+		{ .name = "threads_steal_stats",
+		  .fops = &ptlrpc_lprocfs_threads_steal_stats_fops,
+		  .data = svc },
 		{ NULL }
 	};
 	static const struct file_operations req_history_fops = {
@@ -1224,7 +1427,7 @@ void ptlrpc_ldebugfs_register_service(struct dentry *entry,
 		.release	= lprocfs_seq_release,
 	};
 
-	ptlrpc_ldebugfs_register(entry, svc->srv_name, "stats",
+	ptlrpc_ldebugfs_register(entry, svc->srv_name, "stats", true,
 				 &svc->srv_debugfs_entry, &svc->srv_stats);
 	if (!svc->srv_debugfs_entry)
 		return;
@@ -1237,7 +1440,7 @@ void ptlrpc_ldebugfs_register_service(struct dentry *entry,
 
 void ptlrpc_lprocfs_register_obd(struct obd_device *obd)
 {
-	ptlrpc_ldebugfs_register(obd->obd_debugfs_entry, NULL, "stats",
+	ptlrpc_ldebugfs_register(obd->obd_debugfs_entry, NULL, "stats", false,
 				 &obd->obd_svc_debugfs_entry,
 				 &obd->obd_svc_stats);
 }
@@ -921,6 +921,7 @@ int ptl_send_rpc(struct ptlrpc_request *request, int noreply)
 	OBD_FAIL_TIMEOUT(OBD_FAIL_PTLRPC_DELAY_SEND, request->rq_timeout + 5);
 
 	request->rq_sent_ns = ktime_get_real();
+	request->rq_cli.cr_sent_mono = ktime_get();
 	request->rq_sent = ktime_get_real_seconds();
 	/* We give the server rq_timeout secs to process the req, and
 	 * add the network latency for our local timeout.
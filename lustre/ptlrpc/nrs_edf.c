@@ -0,0 +1,687 @@
+/*
+ * GPL HEADER START
+ *
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 only,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License version 2 for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; If not, see
+ * http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * GPL HEADER END
+ */
+/*
+ * lustre/ptlrpc/nrs_edf.c
+ *
+ * Network Request Scheduler (NRS) EDF policy
+ *
+ * Earliest Deadline First scheduling against per-class queue latency targets.
+ */
+/**
+ * \addtogoup nrs
+ * @{
+ */
+
+#define DEBUG_SUBSYSTEM S_RPC
+#include <obd_support.h>
+#include <obd_class.h>
+#include <lustre_net.h>
+#include <lprocfs_status.h>
+#include "ptlrpc_internal.h"
+
+/**
+ * \name EDF policy
+ *
+ * Each request is given a deadline, its arrival time plus the latency target
+ * of its class, and requests are served in deadline order. Classes are
+ * defined by the rules written to nrs_edf_rule, whose conditions have the
+ * format of the TBF generic rules, i.e.
+ *
+ * lctl set_param mds.MDS.mdt.nrs_edf_rule="start ls opcode={mds_getattr
+ *	mds_readpage ldlm_enqueue} slo_ms=20"
+ *
+ * Requests not matching any rule belong to the "default" class. Giving a
+ * short target to interactive metadata operations lets them overtake a flood
+ * of creates, while the latter are still served once their own, longer,
+ * deadline comes. Requests are not reordered across the regular and
+ * high-priority NRS heads, as ptlrpc_server_allow_high() still decides which
+ * head is served.
+ *
+ * @{
+ */
+
+#define NRS_POL_NAME_EDF	"edf"
+
+#define NRS_EDF_SLO_MS_DEF	1000
+#define NRS_EDF_SLO_MS_MAX	(3600 * MSEC_PER_SEC)
+#define NRS_EDF_DEFAULT_CLASS	"default"
+
+/**
+ * Binary heap predicate.
+ *
+ * \retval 0 e1 > e2
+ * \retval 1 e1 <= e2
+ */
+static int
+edf_req_compare(struct binheap_node *e1, struct binheap_node *e2)
+{
+	struct ptlrpc_nrs_request *nrq1;
+	struct ptlrpc_nrs_request *nrq2;
+
+	nrq1 = container_of(e1, struct ptlrpc_nrs_request, nr_node);
+	nrq2 = container_of(e2, struct ptlrpc_nrs_request, nr_node);
+
+	if (ktime_before(nrq1->nr_u.edf.er_deadline,
+			 nrq2->nr_u.edf.er_deadline))
+		return 1;
+	if (ktime_after(nrq1->nr_u.edf.er_deadline,
+			nrq2->nr_u.edf.er_deadline))
+		return 0;
+
+	return nrq1->nr_u.edf.er_sequence < nrq2->nr_u.edf.er_sequence;
+}
+
+static struct binheap_ops nrs_edf_heap_ops = {
+	.hop_enter	= NULL,
+	.hop_exit	= NULL,
+	.hop_compare	= edf_req_compare,
+};
+
+static unsigned int nrs_edf_hist_index(__u64 usec)
+{
+	unsigned int msb;
+
+	usec = min_t(__u64, usec, U32_MAX);
+	if (usec < (1 << NRS_EDF_HIST_SUB_BITS))
+		return usec;
+
+	msb = fls64(usec) - 1;
+	return ((msb - NRS_EDF_HIST_SUB_BITS + 1) << NRS_EDF_HIST_SUB_BITS) +
+	       ((usec >> (msb - NRS_EDF_HIST_SUB_BITS)) &
+		((1 << NRS_EDF_HIST_SUB_BITS) - 1));
+}
+
+/* upper bound, exclusive, of the latencies counted in bucket \a i */
+static __u64 nrs_edf_hist_bound(unsigned int i)
+{
+	unsigned int shift;
+
+	if (i < (1 << NRS_EDF_HIST_SUB_BITS))
+		return i + 1;
+
+	shift = (i >> NRS_EDF_HIST_SUB_BITS) - 1;
+	return ((__u64)(i & ((1 << NRS_EDF_HIST_SUB_BITS) - 1)) +
+		(1 << NRS_EDF_HIST_SUB_BITS) + 1) << shift;
+}
+
+/* latency under which \a permille of the requests of \a class were started */
+static __u64 nrs_edf_percentile(struct nrs_edf_class *class,
+				unsigned int permille)
+{
+	__u64 target;
+	__u64 sum = 0;
+	int i;
+
+	if (class->ec_served == 0)
+		return 0;
+
+	target = DIV_ROUND_UP_ULL(class->ec_served * permille, 1000);
+	for (i = 0; i < NRS_EDF_HIST_BUCKETS; i++) {
+		sum += class->ec_hist[i];
+		if (sum >= target)
+			break;
+	}
+	return nrs_edf_hist_bound(min(i, NRS_EDF_HIST_BUCKETS - 1));
+}
+
+static const struct nrs_cond_class_conf nrs_edf_class_conf = {
+	.ccc_policy	= NRS_POL_NAME_EDF,
+	.ccc_wr_opc	= NRS_CTL_EDF_WR_RULE,
+	.ccc_size	= sizeof(struct nrs_edf_class),
+	.ccc_key	= "slo_ms",
+	.ccc_def	= NRS_EDF_SLO_MS_DEF,
+	.ccc_max	= NRS_EDF_SLO_MS_MAX,
+};
+
+/**
+ * Called when an EDF policy instance is started.
+ *
+ * \param[in] policy the policy
+ *
+ * \retval -ENOMEM OOM error
+ * \retval 0	   success
+ */
+static int nrs_edf_start(struct ptlrpc_nrs_policy *policy, char *arg)
+{
+	struct nrs_edf_head *head;
+	struct nrs_cond_class *class;
+	int rc = 0;
+	ENTRY;
+
+	OBD_CPT_ALLOC_PTR(head, nrs_pol2cptab(policy), nrs_pol2cptid(policy));
+	if (head == NULL)
+		RETURN(-ENOMEM);
+
+	head->eh_binheap = binheap_create(&nrs_edf_heap_ops,
+					  CBH_FLAG_ATOMIC_GROW, 4096, NULL,
+					  nrs_pol2cptab(policy),
+					  nrs_pol2cptid(policy));
+	if (head->eh_binheap == NULL)
+		GOTO(out_head, rc = -ENOMEM);
+
+	class = nrs_cond_class_alloc(policy, &nrs_edf_class_conf,
+				     NRS_EDF_DEFAULT_CLASS, NULL,
+				     NRS_EDF_SLO_MS_DEF);
+	if (IS_ERR(class))
+		GOTO(out_binheap, rc = PTR_ERR(class));
+
+	spin_lock_init(&head->eh_lock);
+	INIT_LIST_HEAD(&head->eh_classes);
+	list_add(&class->cc_linkage, &head->eh_classes);
+
+	policy->pol_private = head;
+
+	RETURN(0);
+
+out_binheap:
+	binheap_destroy(head->eh_binheap);
+out_head:
+	OBD_FREE_PTR(head);
+
+	RETURN(rc);
+}
+
+/**
+ * Called when an EDF policy instance is stopped, once it has no more pending
+ * requests to serve.
+ *
+ * \param[in] policy the policy
+ */
+static void nrs_edf_stop(struct ptlrpc_nrs_policy *policy)
+{
+	struct nrs_edf_head *head = policy->pol_private;
+	struct nrs_cond_class *class;
+	struct nrs_cond_class *tmp;
+	ENTRY;
+
+	LASSERT(head != NULL);
+	LASSERT(binheap_is_empty(head->eh_binheap));
+
+	list_for_each_entry_safe(class, tmp, &head->eh_classes, cc_linkage) {
+		LASSERTF(class->cc_ref == 1, "Busy EDF class %s with %d refs\n",
+			 class->cc_name, class->cc_ref);
+		list_del_init(&class->cc_linkage);
+		nrs_cond_class_put(&nrs_edf_class_conf, class);
+	}
+	binheap_destroy(head->eh_binheap);
+
+	OBD_FREE_PTR(head);
+	EXIT;
+}
+
+static int nrs_edf_stats_dump(struct nrs_edf_head *head, struct seq_file *m)
+{
+	struct nrs_edf_class *class;
+
+	spin_lock(&head->eh_lock);
+	list_for_each_entry(class, &head->eh_classes, ec_class.cc_linkage)
+		seq_printf(m, "- class: %s\n"
+			   "  slo_ms: %u\n"
+			   "  served_rpcs: %llu\n"
+			   "  missed_rpcs: %llu\n"
+			   "  p50_usec: %llu\n"
+			   "  p99_usec: %llu\n"
+			   "  p999_usec: %llu\n",
+			   class->ec_class.cc_name, class->ec_class.cc_value,
+			   class->ec_served, class->ec_missed,
+			   nrs_edf_percentile(class, 500),
+			   nrs_edf_percentile(class, 990),
+			   nrs_edf_percentile(class, 999));
+	spin_unlock(&head->eh_lock);
+
+	return 0;
+}
+
+static void nrs_edf_stats_clear(struct nrs_edf_head *head)
+{
+	struct nrs_edf_class *class;
+
+	spin_lock(&head->eh_lock);
+	list_for_each_entry(class, &head->eh_classes, ec_class.cc_linkage) {
+		class->ec_served = 0;
+		class->ec_missed = 0;
+		memset(class->ec_hist, 0, sizeof(class->ec_hist));
+	}
+	spin_unlock(&head->eh_lock);
+}
+
+/**
+ * Performs a policy-specific ctl function on EDF policy instances; similar
+ * to ioctl.
+ *
+ * \param[in]	  policy the policy instance
+ * \param[in]	  opc	 the opcode
+ * \param[in,out] arg	 used for passing parameters and information
+ *
+ * \pre assert_spin_locked(&policy->pol_nrs->->nrs_lock)
+ * \post assert_spin_locked(&policy->pol_nrs->->nrs_lock)
+ *
+ * \retval 0   operation carried out successfully
+ * \retval -ve error
+ */
+static int nrs_edf_ctl(struct ptlrpc_nrs_policy *policy,
+		       enum ptlrpc_nrs_ctl opc, void *arg)
+{
+	struct nrs_edf_head *head = policy->pol_private;
+	int rc = 0;
+	ENTRY;
+
+	assert_spin_locked(&policy->pol_nrs->nrs_lock);
+
+	switch ((enum nrs_ctl_edf)opc) {
+	default:
+		RETURN(-EINVAL);
+
+	case NRS_CTL_EDF_RD_RULE: {
+		struct seq_file *m = arg;
+
+		seq_printf(m, "CPT %d:\n", nrs_pol2cptid(policy));
+		nrs_cond_class_dump(&nrs_edf_class_conf, &head->eh_classes,
+				    &head->eh_lock, m);
+		}
+		break;
+
+	case NRS_CTL_EDF_WR_RULE:
+		rc = nrs_cond_class_command(policy, &nrs_edf_class_conf,
+					    &head->eh_classes, &head->eh_lock,
+					    arg);
+		break;
+
+	case NRS_CTL_EDF_RD_STATS: {
+		struct seq_file *m = arg;
+
+		seq_printf(m, "CPT %d:\n", nrs_pol2cptid(policy));
+		rc = nrs_edf_stats_dump(head, m);
+		}
+		break;
+
+	case NRS_CTL_EDF_CLEAR_STATS:
+		nrs_edf_stats_clear(head);
+		break;
+	}
+
+	RETURN(rc);
+}
+
+/**
+ * Obtains resources from EDF policy instances. The top-level resource lives
+ * inside \e nrs_edf_head and the second-level resource inside the
+ * \e nrs_edf_class of the request.
+ *
+ * \param[in]  policy	  the policy for which resources are being taken for
+ *			  request \a nrq
+ * \param[in]  nrq	  the request for which resources are being taken
+ * \param[in]  parent	  parent resource, embedded in nrs_edf_head
+ * \param[out] resp	  resources references are placed in this array
+ * \param[in]  moving_req signifies limited caller context; unused in this
+ *			  policy
+ *
+ * \retval 0   we are returning a top-level, parent resource
+ * \retval 1   we are returning a bottom-level resource, one that is embedded
+ *	       in an nrs_edf_class object
+ *
+ * \see nrs_resource_get_safe()
+ */
+static int nrs_edf_res_get(struct ptlrpc_nrs_policy *policy,
+			   struct ptlrpc_nrs_request *nrq,
+			   const struct ptlrpc_nrs_resource *parent,
+			   struct ptlrpc_nrs_resource **resp, bool moving_req)
+{
+	struct nrs_edf_head *head;
+	struct nrs_edf_class *class;
+	struct ptlrpc_request *req;
+	struct tbf_id id;
+	char *jobid;
+	u32 opc;
+
+	if (parent == NULL) {
+		*resp = &((struct nrs_edf_head *)policy->pol_private)->eh_res;
+		return 0;
+	}
+
+	head = container_of(parent, struct nrs_edf_head, eh_res);
+	req = container_of(nrq, struct ptlrpc_request, rq_nrq);
+
+	opc = lustre_msg_get_opc(req->rq_reqmsg);
+	jobid = lustre_msg_get_jobid(req->rq_reqmsg);
+	if (jobid == NULL)
+		jobid = "";
+	nrs_tbf_id_cli_set(req, &id, NRS_TBF_FLAG_UID | NRS_TBF_FLAG_GID);
+
+	/* the default class is the last one and matches any request */
+	spin_lock(&head->eh_lock);
+	list_for_each_entry(class, &head->eh_classes, ec_class.cc_linkage) {
+		if (list_empty(&class->ec_class.cc_conds) ||
+		    nrs_tbf_conds_match(&class->ec_class.cc_conds,
+					req->rq_peer.nid, jobid, opc, id))
+			break;
+	}
+	class->ec_class.cc_ref++;
+	spin_unlock(&head->eh_lock);
+
+	*resp = &class->ec_res;
+
+	return 1;
+}
+
+/**
+ * Called when releasing references to the resource hierachy obtained for a
+ * request for scheduling using the EDF policy.
+ *
+ * \param[in] policy   the policy the resource belongs to
+ * \param[in] res      the resource to be released
+ */
+static void nrs_edf_res_put(struct ptlrpc_nrs_policy *policy,
+			    const struct ptlrpc_nrs_resource *res)
+{
+	struct nrs_edf_head *head;
+	struct nrs_edf_class *class;
+
+	/**
+	 * Do nothing for freeing parent, nrs_edf_head resources
+	 */
+	if (res->res_parent == NULL)
+		return;
+
+	class = container_of(res, struct nrs_edf_class, ec_res);
+	head = container_of(res->res_parent, struct nrs_edf_head, eh_res);
+
+	spin_lock(&head->eh_lock);
+	nrs_cond_class_put(&nrs_edf_class_conf, &class->ec_class);
+	spin_unlock(&head->eh_lock);
+}
+
+/**
+ * Called when getting a request from the EDF policy for handling; the request
+ * with the earliest deadline is returned.
+ *
+ * \param[in] policy the policy being polled
+ * \param[in] peek   when set, signifies that we just want to examine the
+ *		     request, and not handle it, so the request is not removed
+ *		     from the policy.
+ * \param[in] force  force the policy to return a request; unused in this policy
+ *
+ * \retval the request to be handled
+ * \retval NULL no request available
+ *
+ * \see ptlrpc_nrs_req_get_nolock()
+ * \see nrs_request_get()
+ */
+static
+struct ptlrpc_nrs_request *nrs_edf_req_get(struct ptlrpc_nrs_policy *policy,
+					   bool peek, bool force)
+{
+	struct nrs_edf_head *head = policy->pol_private;
+	struct binheap_node *node = binheap_root(head->eh_binheap);
+	struct ptlrpc_nrs_request *nrq;
+	struct nrs_edf_class *class;
+	struct ptlrpc_request *req;
+	ktime_t now;
+	s64 latency;
+
+	nrq = unlikely(node == NULL) ? NULL :
+	      container_of(node, struct ptlrpc_nrs_request, nr_node);
+
+	if (peek || nrq == NULL)
+		return nrq;
+
+	binheap_remove(head->eh_binheap, &nrq->nr_node);
+
+	req = container_of(nrq, struct ptlrpc_request, rq_nrq);
+	class = container_of(nrs_request_resource(nrq), struct nrs_edf_class,
+			     ec_res);
+	now = ktime_get_real();
+	latency = ktime_us_delta(now, timespec64_to_ktime(req->rq_arrival_time));
+
+	spin_lock(&head->eh_lock);
+	class->ec_served++;
+	if (ktime_after(now, nrq->nr_u.edf.er_deadline))
+		class->ec_missed++;
+	class->ec_hist[nrs_edf_hist_index(max_t(s64, latency, 0))]++;
+	spin_unlock(&head->eh_lock);
+
+	CDEBUG(D_RPCTRACE,
+	       "NRS: starting to handle %s request from %s, class %s, waited %lld us\n",
+	       NRS_POL_NAME_EDF, libcfs_id2str(req->rq_peer),
+	       class->ec_class.cc_name, latency);
+
+	return nrq;
+}
+
+/**
+ * Adds request \a nrq to an EDF \a policy instance's set of queued requests,
+ * with a deadline given by the latency target of its class.
+ *
+ * \param[in] policy the policy
+ * \param[in] nrq    the request to add
+ *
+ * \retval 0	request successfully added
+ * \retval != 0 error
+ */
+static int nrs_edf_req_add(struct ptlrpc_nrs_policy *policy,
+			   struct ptlrpc_nrs_request *nrq)
+{
+	struct nrs_edf_head *head = policy->pol_private;
+	struct ptlrpc_request *req;
+	struct nrs_edf_class *class;
+
+	req = container_of(nrq, struct ptlrpc_request, rq_nrq);
+	class = container_of(nrs_request_resource(nrq), struct nrs_edf_class,
+			     ec_res);
+
+	nrq->nr_u.edf.er_deadline =
+		ktime_add_ms(timespec64_to_ktime(req->rq_arrival_time),
+			     READ_ONCE(class->ec_class.cc_value));
+	nrq->nr_u.edf.er_sequence = head->eh_sequence++;
+
+	return binheap_insert(head->eh_binheap, &nrq->nr_node);
+}
+
+/**
+ * Removes request \a nrq from an EDF \a policy instance's set of queued
+ * requests.
+ *
+ * \param[in] policy the policy
+ * \param[in] nrq    the request to remove
+ */
+static void nrs_edf_req_del(struct ptlrpc_nrs_policy *policy,
+			    struct ptlrpc_nrs_request *nrq)
+{
+	struct nrs_edf_head *head = policy->pol_private;
+
+	binheap_remove(head->eh_binheap, &nrq->nr_node);
+}
+
+/**
+ * Called right after the request \a nrq finishes being handled by EDF policy
+ * instance \a policy.
+ *
+ * \param[in] policy the policy that handled the request
+ * \param[in] nrq    the request that was handled
+ */
+static void nrs_edf_req_stop(struct ptlrpc_nrs_policy *policy,
+			     struct ptlrpc_nrs_request *nrq)
+{
+	struct ptlrpc_request *req = container_of(nrq, struct ptlrpc_request,
+						  rq_nrq);
+
+	CDEBUG(D_RPCTRACE, "NRS: finished handling %s request from %s\n",
+	       NRS_POL_NAME_EDF, libcfs_id2str(req->rq_peer));
+}
+
+/**
+ * debugfs interface
+ */
+
+/**
+ * Lists the classes of EDF policy instances, newest first, with their
+ * conditions and latency target.
+ *
+ * For example:
+ *
+ *	regular_requests:
+ *	CPT 0:
+ *	ls opcode={mds_getattr mds_readpage} slo_ms=20, ref 0
+ *	default * slo_ms=1000, ref 3
+ */
+static int
+ptlrpc_lprocfs_nrs_edf_rule_seq_show(struct seq_file *m, void *data)
+{
+	return nrs_cond_lprocfs_dump(&nrs_edf_class_conf, m,
+				     NRS_CTL_EDF_RD_RULE);
+}
+
+/**
+ * Starts, changes or stops a class of EDF policy instances on both NRS heads
+ * of a service, or on the head given by a "reg" or "hp" prefix.
+ *
+ * For example:
+ *
+ * lctl set_param mds.MDS.mdt.nrs_edf_rule="start ls opcode={mds_getattr}
+ *	slo_ms=20"
+ * lctl set_param mds.MDS.mdt.nrs_edf_rule="change default slo_ms=5000"
+ * lctl set_param mds.MDS.mdt.nrs_edf_rule="reg stop ls"
+ */
+static ssize_t
+ptlrpc_lprocfs_nrs_edf_rule_seq_write(struct file *file,
+				      const char __user *buffer,
+				      size_t count, loff_t *off)
+{
+	return nrs_cond_rule_write(&nrs_edf_class_conf, file, buffer, count);
+}
+
+LDEBUGFS_SEQ_FOPS(ptlrpc_lprocfs_nrs_edf_rule);
+
+/**
+ * Shows, for each class of EDF policy instances, the number of requests
+ * served, the number of them started after their deadline, and the 50th, 99th
+ * and 99.9th percentiles of the time spent in the queue. Percentiles are the
+ * upper bound of the histogram bucket they fall in.
+ *
+ * For example:
+ *
+ *	regular_requests:
+ *	CPT 0:
+ *	- class: ls
+ *	  slo_ms: 20
+ *	  served_rpcs: 10452
+ *	  missed_rpcs: 3
+ *	  p50_usec: 96
+ *	  p99_usec: 3584
+ *	  p999_usec: 24576
+ */
+static int
+ptlrpc_lprocfs_nrs_edf_stats_seq_show(struct seq_file *m, void *data)
+{
+	return nrs_cond_lprocfs_dump(&nrs_edf_class_conf, m,
+				     NRS_CTL_EDF_RD_STATS);
+}
+
+/**
+ * Writing "clear" resets the statistics of EDF policy instances.
+ */
+static ssize_t
+ptlrpc_lprocfs_nrs_edf_stats_seq_write(struct file *file,
+				       const char __user *buffer,
+				       size_t count, loff_t *off)
+{
+	struct seq_file *m = file->private_data;
+	struct ptlrpc_service *svc = m->private;
+	char kernbuf[8];
+	int rc;
+
+	if (count > sizeof(kernbuf) - 1)
+		return -EINVAL;
+
+	if (copy_from_user(kernbuf, buffer, count))
+		return -EFAULT;
+
+	kernbuf[count] = '\0';
+	if (strcmp(strim(kernbuf), "clear") != 0)
+		return -EINVAL;
+
+	rc = ptlrpc_nrs_policy_control(svc, PTLRPC_NRS_QUEUE_BOTH,
+				       NRS_POL_NAME_EDF,
+				       NRS_CTL_EDF_CLEAR_STATS, false, NULL);
+	if (rc == -ENODEV && !nrs_svc_has_hp(svc))
+		rc = 0;
+
+	return rc ? rc : count;
+}
+
+LDEBUGFS_SEQ_FOPS(ptlrpc_lprocfs_nrs_edf_stats);
+
+/**
+ * Initializes an EDF policy's lprocfs interface for service \a svc
+ *
+ * \param[in] svc the service
+ *
+ * \retval 0	success
+ * \retval != 0	error
+ */
+static int nrs_edf_lprocfs_init(struct ptlrpc_service *svc)
+{
+	struct ldebugfs_vars nrs_edf_lprocfs_vars[] = {
+		{ .name		= "nrs_edf_rule",
+		  .fops		= &ptlrpc_lprocfs_nrs_edf_rule_fops,
+		  .data		= svc },
+		{ .name		= "nrs_edf_stats",
+		  .fops		= &ptlrpc_lprocfs_nrs_edf_stats_fops,
+		  .data		= svc },
+		{ NULL }
+	};
+
+	if (!svc->srv_debugfs_entry)
+		return 0;
+
+	ldebugfs_add_vars(svc->srv_debugfs_entry, nrs_edf_lprocfs_vars, NULL);
+
+	return 0;
+}
+
+/**
+ * EDF policy operations
+ */
+static const struct ptlrpc_nrs_pol_ops nrs_edf_ops = {
+	.op_policy_start	= nrs_edf_start,
+	.op_policy_stop		= nrs_edf_stop,
+	.op_policy_ctl		= nrs_edf_ctl,
+	.op_res_get		= nrs_edf_res_get,
+	.op_res_put		= nrs_edf_res_put,
+	.op_req_get		= nrs_edf_req_get,
+	.op_req_enqueue		= nrs_edf_req_add,
+	.op_req_dequeue		= nrs_edf_req_del,
+	.op_req_stop		= nrs_edf_req_stop,
+	.op_lprocfs_init	= nrs_edf_lprocfs_init,
+};
+
+/**
+ * EDF policy configuration
+ */
+struct ptlrpc_nrs_pol_conf nrs_conf_edf = {
+	.nc_name		= NRS_POL_NAME_EDF,
+	.nc_ops			= &nrs_edf_ops,
+	.nc_compat		= nrs_policy_compat_all,
+};
+
+/** @} EDF policy */
+
+/** @} nrs */
@@ -1588,8 +1588,8 @@ static int ldlm_tbf_id_cli_set(struct ptlrpc_request *req,
 	return 0;
 }
 
-static int nrs_tbf_id_cli_set(struct ptlrpc_request *req, struct tbf_id *id,
-			      enum nrs_tbf_flag ti_type)
+int nrs_tbf_id_cli_set(struct ptlrpc_request *req, struct tbf_id *id,
+		       enum nrs_tbf_flag ti_type)
 {
 	u32 opc = lustre_msg_get_opc(req->rq_reqmsg);
 	struct req_format *fmt = req_fmt(opc);
@@ -1787,8 +1787,7 @@ nrs_tbf_conjunction_free(struct nrs_tbf_conjunction *conjunction)
 	OBD_FREE_PTR(conjunction);
 }
 
-static void
-nrs_tbf_conds_free(struct list_head *cond_list)
+void nrs_tbf_conds_free(struct list_head *cond_list)
 {
 	struct nrs_tbf_conjunction *conjunction;
 	struct nrs_tbf_conjunction *n;
@@ -1919,8 +1918,13 @@ nrs_tbf_conjunction_parse(struct cfs_lstr *src, struct list_head *cond_list)
 	return rc;
 }
 
-static int
-nrs_tbf_conds_parse(char *str, int len, struct list_head *cond_list)
+/**
+ * Parses a disjunction of conjunctions of expressions, such as
+ * "jobid={dd.*}&uid={500},nid={192.168.1.[1-10]@tcp}", into \a cond_list.
+ *
+ * Also used by the WFQ policy to classify requests.
+ */
+int nrs_tbf_conds_parse(char *str, int len, struct list_head *cond_list)
 {
 	struct cfs_lstr src;
 	struct cfs_lstr res;
@@ -1967,20 +1971,19 @@ static int
 nrs_tbf_id_list_match(struct list_head *id_list, struct tbf_id id);
 
 static int
-nrs_tbf_expression_match(struct nrs_tbf_expression *expr,
-			 struct nrs_tbf_rule *rule,
-			 struct nrs_tbf_client *cli)
+nrs_tbf_expression_match(struct nrs_tbf_expression *expr, lnet_nid_t nid,
+			 char *jobid, u32 opcode, struct tbf_id id)
 {
 	switch (expr->te_field) {
 	case NRS_TBF_FIELD_NID:
-		return cfs_match_nid(cli->tc_nid, &expr->te_cond);
+		return cfs_match_nid(nid, &expr->te_cond);
 	case NRS_TBF_FIELD_JOBID:
-		return nrs_tbf_jobid_list_match(&expr->te_cond, cli->tc_jobid);
+		return nrs_tbf_jobid_list_match(&expr->te_cond, jobid);
 	case NRS_TBF_FIELD_OPCODE:
-		return cfs_bitmap_check(expr->te_opcodes, cli->tc_opcode);
+		return cfs_bitmap_check(expr->te_opcodes, opcode);
 	case NRS_TBF_FIELD_UID:
 	case NRS_TBF_FIELD_GID:
-		return nrs_tbf_id_list_match(&expr->te_cond, cli->tc_id);
+		return nrs_tbf_id_list_match(&expr->te_cond, id);
 	default:
 		return 0;
 	}
@@ -1988,14 +1991,15 @@ nrs_tbf_expression_match(struct nrs_tbf_expression *expr,
 
 static int
 nrs_tbf_conjunction_match(struct nrs_tbf_conjunction *conjunction,
-			  struct nrs_tbf_rule *rule,
-			  struct nrs_tbf_client *cli)
+			  lnet_nid_t nid, char *jobid, u32 opcode,
+			  struct tbf_id id)
 {
 	struct nrs_tbf_expression *expr;
 	int matched;
 
 	list_for_each_entry(expr, &conjunction->tc_expressions, te_linkage) {
-		matched = nrs_tbf_expression_match(expr, rule, cli);
+		matched = nrs_tbf_expression_match(expr, nid, jobid, opcode,
+						   id);
 		if (!matched)
 			return 0;
 	}
@@ -2003,14 +2007,22 @@ nrs_tbf_conjunction_match(struct nrs_tbf_conjunction *conjunction,
 	return 1;
 }
 
-static int
-nrs_tbf_cond_match(struct nrs_tbf_rule *rule, struct nrs_tbf_client *cli)
+/**
+ * Checks whether a request with the given properties matches the conditions
+ * parsed by nrs_tbf_conds_parse() into \a cond_list.
+ *
+ * \retval 1 matched
+ * \retval 0 not matched
+ */
+int nrs_tbf_conds_match(struct list_head *cond_list, lnet_nid_t nid,
+			char *jobid, u32 opcode, struct tbf_id id)
 {
 	struct nrs_tbf_conjunction *conjunction;
 	int matched;
 
-	list_for_each_entry(conjunction, &rule->tr_conds, tc_linkage) {
-		matched = nrs_tbf_conjunction_match(conjunction, rule, cli);
+	list_for_each_entry(conjunction, cond_list, tc_linkage) {
+		matched = nrs_tbf_conjunction_match(conjunction, nid, jobid,
+						    opcode, id);
 		if (matched)
 			return 1;
 	}
@@ -2018,6 +2030,174 @@ nrs_tbf_cond_match(struct nrs_tbf_rule *rule, struct nrs_tbf_client *cli)
 	return 0;
 }
 
+/**
+ * Allocates a class of the WFQ or EDF policy, as a structure of
+ * nrs_cond_class_conf::ccc_size bytes starting with the class.
+ *
+ * \param[in] conds_str	conditions of the class, NULL for the default class
+ *
+ * \retval the class, holding one reference
+ * \retval ERR_PTR(-ve) error
+ */
+struct nrs_cond_class *
+nrs_cond_class_alloc(struct ptlrpc_nrs_policy *policy,
+		     const struct nrs_cond_class_conf *conf, const char *name,
+		     const char *conds_str, __u32 value)
+{
+	struct nrs_cond_class *class;
+	int rc;
+
+	OBD_CPT_ALLOC(class, nrs_pol2cptab(policy), nrs_pol2cptid(policy),
+		      conf->ccc_size);
+	if (class == NULL)
+		return ERR_PTR(-ENOMEM);
+
+	strlcpy(class->cc_name, name, sizeof(class->cc_name));
+	INIT_LIST_HEAD(&class->cc_linkage);
+	INIT_LIST_HEAD(&class->cc_conds);
+	class->cc_value = value;
+	class->cc_ref = 1;
+	if (conf->ccc_init != NULL)
+		conf->ccc_init(class);
+
+	if (conds_str == NULL)
+		return class;
+
+	OBD_ALLOC(class->cc_conds_str, strlen(conds_str) + 1);
+	if (class->cc_conds_str == NULL)
+		GOTO(out_free, rc = -ENOMEM);
+	memcpy(class->cc_conds_str, conds_str, strlen(conds_str));
+
+	rc = nrs_tbf_conds_parse(class->cc_conds_str,
+				 strlen(class->cc_conds_str),
+				 &class->cc_conds);
+	if (rc == 0 && list_empty(&class->cc_conds))
+		rc = -EINVAL;
+	if (rc == 0)
+		return class;
+
+	nrs_tbf_conds_free(&class->cc_conds);
+	OBD_FREE(class->cc_conds_str, strlen(class->cc_conds_str) + 1);
+out_free:
+	OBD_FREE(class, conf->ccc_size);
+	return ERR_PTR(rc);
+}
+
+void nrs_cond_class_put(const struct nrs_cond_class_conf *conf,
+			struct nrs_cond_class *class)
+{
+	if (--class->cc_ref > 0)
+		return;
+
+	LASSERT(list_empty(&class->cc_linkage));
+	if (class->cc_conds_str != NULL) {
+		nrs_tbf_conds_free(&class->cc_conds);
+		OBD_FREE(class->cc_conds_str, strlen(class->cc_conds_str) + 1);
+	}
+	OBD_FREE(class, conf->ccc_size);
+}
+
+static struct nrs_cond_class *
+nrs_cond_class_find(struct list_head *classes, const char *name)
+{
+	struct nrs_cond_class *class;
+
+	list_for_each_entry(class, classes, cc_linkage) {
+		if (strcmp(class->cc_name, name) == 0)
+			return class;
+	}
+	return NULL;
+}
+
+/**
+ * Starts, changes or stops a class of a WFQ or EDF policy instance. A new
+ * value applies to requests classified from now on, and a stopped class is
+ * freed once the requests holding it are done.
+ *
+ * \param[in] classes	class list of the policy instance, newest first
+ * \param[in] lock	protects \a classes
+ *
+ * \retval 0   success
+ * \retval -ve error
+ */
+int nrs_cond_class_command(struct ptlrpc_nrs_policy *policy,
+			   const struct nrs_cond_class_conf *conf,
+			   struct list_head *classes, spinlock_t *lock,
+			   struct nrs_cond_cmd *cmd)
+{
+	struct nrs_cond_class *class;
+	struct nrs_cond_class *new = NULL;
+	int rc = 0;
+
+	/* allocate outside of the lock, which is taken by res_get() */
+	if (cmd->cc_cmd == NRS_COND_CMD_START) {
+		new = nrs_cond_class_alloc(policy, conf, cmd->cc_name,
+					   cmd->cc_conds_str, cmd->cc_value);
+		if (IS_ERR(new))
+			return PTR_ERR(new);
+	}
+
+	spin_lock(lock);
+	class = nrs_cond_class_find(classes, cmd->cc_name);
+	switch (cmd->cc_cmd) {
+	case NRS_COND_CMD_START:
+		if (class != NULL)
+			GOTO(out, rc = -EEXIST);
+		list_add(&new->cc_linkage, classes);
+		new = NULL;
+		break;
+	case NRS_COND_CMD_CHANGE:
+		if (class == NULL)
+			GOTO(out, rc = -ENOENT);
+		WRITE_ONCE(class->cc_value, cmd->cc_value);
+		break;
+	case NRS_COND_CMD_STOP:
+		if (class == NULL)
+			GOTO(out, rc = -ENOENT);
+		if (list_empty(&class->cc_conds))
+			GOTO(out, rc = -EPERM);
+		list_del_init(&class->cc_linkage);
+		nrs_cond_class_put(conf, class);
+		break;
+	default:
+		rc = -EINVAL;
+		break;
+	}
+out:
+	spin_unlock(lock);
+	if (new != NULL)
+		nrs_cond_class_put(conf, new);
+
+	return rc;
+}
+
+/**
+ * Lists the classes of a WFQ or EDF policy instance, i.e.
+ *
+ *	big jobid={dd.0} weight=4, ref 1
+ *	default * weight=1, ref 0
+ */
+void nrs_cond_class_dump(const struct nrs_cond_class_conf *conf,
+			 struct list_head *classes, spinlock_t *lock,
+			 struct seq_file *m)
+{
+	struct nrs_cond_class *class;
+
+	spin_lock(lock);
+	list_for_each_entry(class, classes, cc_linkage)
+		seq_printf(m, "%s %s %s=%u, ref %d\n", class->cc_name,
+			   class->cc_conds_str ?: "*", conf->ccc_key,
+			   class->cc_value, class->cc_ref - 1);
+	spin_unlock(lock);
+}
+
+static int
+nrs_tbf_cond_match(struct nrs_tbf_rule *rule, struct nrs_tbf_client *cli)
+{
+	return nrs_tbf_conds_match(&rule->tr_conds, cli->tc_nid, cli->tc_jobid,
+				   cli->tc_opcode, cli->tc_id);
+}
+
 static void
 nrs_tbf_generic_rule_fini(struct nrs_tbf_rule *rule)
 {
@@ -3648,6 +3828,207 @@ out:
 
 LDEBUGFS_SEQ_FOPS(ptlrpc_lprocfs_nrs_tbf_rule);
 
+/**
+ * Dumps the rules or the statistics of the WFQ or EDF policy instances on the
+ * regular and high-priority NRS heads of a service.
+ */
+int nrs_cond_lprocfs_dump(const struct nrs_cond_class_conf *conf,
+			  struct seq_file *m, enum ptlrpc_nrs_ctl opc)
+{
+	struct ptlrpc_service *svc = m->private;
+	int rc;
+
+	seq_printf(m, "regular_requests:\n");
+	/**
+	 * Perform two separate calls to this as only one of the NRS heads'
+	 * policies may be in the ptlrpc_nrs_pol_state::NRS_POL_STATE_STARTED or
+	 * ptlrpc_nrs_pol_state::NRS_POL_STATE_STOPPING state.
+	 */
+	rc = ptlrpc_nrs_policy_control(svc, PTLRPC_NRS_QUEUE_REG,
+				       conf->ccc_policy, opc, false, m);
+	/**
+	 * Ignore -ENODEV as the regular NRS head's policy may be in the
+	 * ptlrpc_nrs_pol_state::NRS_POL_STATE_STOPPED state.
+	 */
+	if (rc != 0 && rc != -ENODEV)
+		return rc;
+
+	if (!nrs_svc_has_hp(svc))
+		return rc;
+
+	seq_printf(m, "high_priority_requests:\n");
+	return ptlrpc_nrs_policy_control(svc, PTLRPC_NRS_QUEUE_HP,
+					 conf->ccc_policy, opc, false, m);
+}
+
+static bool nrs_cond_class_name_is_valid(const char *name)
+{
+	int i;
+
+	if (strlen(name) == 0 || strlen(name) >= MAX_TBF_NAME)
+		return false;
+
+	for (i = 0; i < strlen(name); i++) {
+		if (!isalnum(name[i]) && name[i] != '_')
+			return false;
+	}
+	return true;
+}
+
+/**
+ * Parses a rule command of the WFQ or EDF policy, one of:
+ *
+ *	start <name> <conditions> [<key>=<value>]
+ *	change <name> <key>=<value>
+ *	stop <name>
+ *
+ * where <key> is nrs_cond_class_conf::ccc_key. The strings of \a cmd point
+ * into \a buffer.
+ */
+static int nrs_cond_parse_cmd(const struct nrs_cond_class_conf *conf,
+			      char *buffer, struct nrs_cond_cmd *cmd)
+{
+	char *token;
+	char *val;
+	char *key;
+	unsigned int value;
+	int rc;
+
+	memset(cmd, 0, sizeof(*cmd));
+
+	val = buffer;
+	token = strsep(&val, " ");
+	if (val == NULL || strlen(val) == 0)
+		return -EINVAL;
+
+	/* Type of the command */
+	if (strcmp(token, "start") == 0)
+		cmd->cc_cmd = NRS_COND_CMD_START;
+	else if (strcmp(token, "change") == 0)
+		cmd->cc_cmd = NRS_COND_CMD_CHANGE;
+	else if (strcmp(token, "stop") == 0)
+		cmd->cc_cmd = NRS_COND_CMD_STOP;
+	else
+		return -EINVAL;
+
+	/* Name of the class */
+	token = strsep(&val, " ");
+	if ((val == NULL && cmd->cc_cmd != NRS_COND_CMD_STOP) ||
+	    !nrs_cond_class_name_is_valid(token))
+		return -EINVAL;
+	cmd->cc_name = token;
+
+	if (cmd->cc_cmd == NRS_COND_CMD_START) {
+		/* Conditions, up to the last '}' */
+		cmd->cc_conds_str = val;
+		val = strrchr(val, '}');
+		if (val == NULL)
+			return -EINVAL;
+
+		/* Skip '}' */
+		val++;
+		if (*val == '\0') {
+			val = NULL;
+		} else if (*val == ' ') {
+			*val = '\0';
+			val++;
+		} else {
+			return -EINVAL;
+		}
+		cmd->cc_value = conf->ccc_def;
+	}
+
+	while (val != NULL && strlen(val) != 0) {
+		if (cmd->cc_cmd == NRS_COND_CMD_STOP)
+			return -EINVAL;
+
+		token = strsep(&val, " ");
+		key = strsep(&token, "=");
+		if (token == NULL || strcmp(key, conf->ccc_key) != 0)
+			return -EINVAL;
+
+		rc = kstrtouint(token, 10, &value);
+		if (rc)
+			return rc;
+		if (value == 0 || value > conf->ccc_max)
+			return -EINVAL;
+		cmd->cc_value = value;
+	}
+
+	if (cmd->cc_cmd == NRS_COND_CMD_CHANGE && cmd->cc_value == 0)
+		return -EINVAL;
+
+	return 0;
+}
+
+#define LPROCFS_WR_NRS_COND_MAX_CMD (4096)
+
+/**
+ * Starts, changes or stops a class of WFQ or EDF policy instances on both NRS
+ * heads of a service, or on the head given by a "reg" or "hp" prefix.
+ */
+ssize_t nrs_cond_rule_write(const struct nrs_cond_class_conf *conf,
+			    struct file *file, const char __user *buffer,
+			    size_t count)
+{
+	struct seq_file *m = file->private_data;
+	struct ptlrpc_service *svc = m->private;
+	enum ptlrpc_nrs_queue_type queue = PTLRPC_NRS_QUEUE_BOTH;
+	struct nrs_cond_cmd cmd;
+	char *kernbuf;
+	char *token;
+	char *val;
+	int rc;
+
+	if (count > LPROCFS_WR_NRS_COND_MAX_CMD - 1)
+		return -EINVAL;
+
+	OBD_ALLOC(kernbuf, LPROCFS_WR_NRS_COND_MAX_CMD);
+	if (kernbuf == NULL)
+		return -ENOMEM;
+
+	if (copy_from_user(kernbuf, buffer, count))
+		GOTO(out, rc = -EFAULT);
+	if (count > 0 && kernbuf[count - 1] == '\n')
+		kernbuf[count - 1] = '\0';
+
+	val = kernbuf;
+	token = strsep(&val, " ");
+	if (val == NULL)
+		GOTO(out, rc = -EINVAL);
+
+	if (strcmp(token, "reg") == 0) {
+		queue = PTLRPC_NRS_QUEUE_REG;
+	} else if (strcmp(token, "hp") == 0) {
+		queue = PTLRPC_NRS_QUEUE_HP;
+	} else {
+		kernbuf[strlen(token)] = ' ';
+		val = kernbuf;
+	}
+
+	if (queue == PTLRPC_NRS_QUEUE_HP && !nrs_svc_has_hp(svc))
+		GOTO(out, rc = -ENODEV);
+	else if (queue == PTLRPC_NRS_QUEUE_BOTH && !nrs_svc_has_hp(svc))
+		queue = PTLRPC_NRS_QUEUE_REG;
+
+	rc = nrs_cond_parse_cmd(conf, val, &cmd);
+	if (rc)
+		GOTO(out, rc);
+
+	/**
+	 * Serialize NRS core lprocfs operations with policy registration/
+	 * unregistration.
+	 */
+	mutex_lock(&nrs_core.nrs_mutex);
+	rc = ptlrpc_nrs_policy_control(svc, queue, conf->ccc_policy,
+				       conf->ccc_wr_opc, false, &cmd);
+	mutex_unlock(&nrs_core.nrs_mutex);
+out:
+	OBD_FREE(kernbuf, LPROCFS_WR_NRS_COND_MAX_CMD);
+
+	return rc ? rc : count;
+}
+
 /**
  * Initializes a TBF policy's lprocfs interface for service \a svc
  *
@@ -0,0 +1,1001 @@
+/*
+ * GPL HEADER START
+ *
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 only,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License version 2 for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; If not, see
+ * http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * GPL HEADER END
+ */
+/*
+ * lustre/ptlrpc/nrs_wfq.c
+ *
+ * Network Request Scheduler (NRS) WFQ policy
+ *
+ * Weighted fair sharing of a service between flows of requests, by Deficit
+ * Round Robin.
+ */
+/**
+ * \addtogoup nrs
+ * @{
+ */
+
+#define DEBUG_SUBSYSTEM S_RPC
+#include <obd_support.h>
+#include <obd_class.h>
+#include <lustre_net.h>
+#include <lprocfs_status.h>
+#include "ptlrpc_internal.h"
+
+/**
+ * \name WFQ policy
+ *
+ * Requests are grouped into flows by jobid, uid, gid, project ID or client
+ * NID, as chosen when starting the policy. Flows are served in round robin
+ * order; every round each flow may be served up to nrs_wfq_head::wh_quantum
+ * bytes multiplied by the weight of its class, the unused part being carried
+ * over to the next round while the flow has requests queued (Deficit Round
+ * Robin, M. Shreedhar and G. Varghese, SIGCOMM '95).
+ *
+ * Requests are assigned to classes by the rules written to nrs_wfq_rule,
+ * whose conditions have the format of the TBF generic rules, i.e.
+ *
+ * lctl set_param ost.OSS.ost_io.nrs_wfq_rule="start big jobid={dd.0} weight=4"
+ *
+ * Requests not matching any rule belong to the "default" class of weight 1.
+ * The policy is work conserving: an idle flow does not hold back others, so
+ * that the weights only matter when flows compete for the service threads.
+ *
+ * @{
+ */
+
+#define NRS_POL_NAME_WFQ	"wfq"
+
+/** Bytes served per round to a flow of weight 1, by default */
+#define NRS_WFQ_QUANTUM_DEF	(1 << 20)
+#define NRS_WFQ_QUANTUM_MAX	(64 << 20)
+#define NRS_WFQ_WEIGHT_MAX	65535
+#define NRS_WFQ_DEFAULT_CLASS	"default"
+
+static const char *nrs_wfq_key_names[] = {
+	[NRS_WFQ_KEY_JOBID]	= "jobid",
+	[NRS_WFQ_KEY_UID]	= "uid",
+	[NRS_WFQ_KEY_GID]	= "gid",
+	[NRS_WFQ_KEY_PROJID]	= "projid",
+	[NRS_WFQ_KEY_NID]	= "nid",
+};
+
+static const struct rhashtable_params nrs_wfq_hash_params = {
+	.key_len	= sizeof(struct nrs_wfq_key),
+	.key_offset	= offsetof(struct nrs_wfq_flow, wf_key),
+	.head_offset	= offsetof(struct nrs_wfq_flow, wf_rhead),
+};
+
+static void nrs_wfq_class_init(struct nrs_cond_class *class)
+{
+	struct nrs_wfq_class *wfq_class;
+
+	wfq_class = container_of(class, struct nrs_wfq_class, wc_class);
+	spin_lock_init(&wfq_class->wc_delay_hist.oh_lock);
+}
+
+static const struct nrs_cond_class_conf nrs_wfq_class_conf = {
+	.ccc_policy	= NRS_POL_NAME_WFQ,
+	.ccc_wr_opc	= NRS_CTL_WFQ_WR_RULE,
+	.ccc_size	= sizeof(struct nrs_wfq_class),
+	.ccc_key	= "weight",
+	.ccc_def	= 1,
+	.ccc_max	= NRS_WFQ_WEIGHT_MAX,
+	.ccc_init	= nrs_wfq_class_init,
+};
+
+static void nrs_wfq_class_put(struct nrs_wfq_class *class)
+{
+	nrs_cond_class_put(&nrs_wfq_class_conf, &class->wc_class);
+}
+
+/**
+ * Finds the class of a request; classes are checked from the newest to the
+ * oldest, the default class being the last one and matching any request.
+ */
+static struct nrs_wfq_class *
+nrs_wfq_classify(struct nrs_wfq_head *head, lnet_nid_t nid, char *jobid,
+		 u32 opc, struct tbf_id id)
+{
+	struct nrs_wfq_class *class;
+
+	list_for_each_entry(class, &head->wh_classes, wc_class.cc_linkage) {
+		if (list_empty(&class->wc_class.cc_conds) ||
+		    nrs_tbf_conds_match(&class->wc_class.cc_conds, nid, jobid,
+					opc, id))
+			return class;
+	}
+	LBUG();
+	return NULL;
+}
+
+static void nrs_wfq_flow_exit(void *vflow, void *data)
+{
+	struct nrs_wfq_flow *flow = vflow;
+
+	LASSERTF(flow->wf_ref == 0, "Busy WFQ flow %s with %d refs\n",
+		 flow->wf_key.wk_id, flow->wf_ref);
+	nrs_wfq_class_put(flow->wf_key.wk_class);
+	OBD_FREE_PTR(flow);
+}
+
+/**
+ * Called when a WFQ policy instance is started.
+ *
+ * \param[in] policy the policy
+ * \param[in] arg    the property flows are formed by, jobid by default
+ *
+ * \retval -ENOMEM OOM error
+ * \retval 0	   success
+ */
+static int nrs_wfq_start(struct ptlrpc_nrs_policy *policy, char *arg)
+{
+	struct nrs_wfq_head *head;
+	struct nrs_cond_class *class;
+	int key_type = NRS_WFQ_KEY_JOBID;
+	int rc;
+	ENTRY;
+
+	if (arg != NULL) {
+		for (key_type = 0; key_type < ARRAY_SIZE(nrs_wfq_key_names);
+		     key_type++) {
+			if (strcmp(arg, nrs_wfq_key_names[key_type]) == 0)
+				break;
+		}
+		if (key_type == ARRAY_SIZE(nrs_wfq_key_names))
+			RETURN(-ENOTSUPP);
+	}
+
+	OBD_CPT_ALLOC_PTR(head, nrs_pol2cptab(policy), nrs_pol2cptid(policy));
+	if (head == NULL)
+		RETURN(-ENOMEM);
+
+	rc = rhashtable_init(&head->wh_flow_hash, &nrs_wfq_hash_params);
+	if (rc)
+		GOTO(out_head, rc);
+
+	class = nrs_cond_class_alloc(policy, &nrs_wfq_class_conf,
+				     NRS_WFQ_DEFAULT_CLASS, NULL, 1);
+	if (IS_ERR(class))
+		GOTO(out_hash, rc = PTR_ERR(class));
+
+	spin_lock_init(&head->wh_lock);
+	INIT_LIST_HEAD(&head->wh_classes);
+	INIT_LIST_HEAD(&head->wh_active);
+	list_add(&class->cc_linkage, &head->wh_classes);
+	head->wh_key_type = key_type;
+	head->wh_quantum = NRS_WFQ_QUANTUM_DEF;
+
+	policy->pol_private = head;
+
+	RETURN(0);
+
+out_hash:
+	rhashtable_destroy(&head->wh_flow_hash);
+out_head:
+	OBD_FREE_PTR(head);
+
+	RETURN(rc);
+}
+
+/**
+ * Called when a WFQ policy instance is stopped, once it has no more pending
+ * requests to serve.
+ *
+ * \param[in] policy the policy
+ */
+static void nrs_wfq_stop(struct ptlrpc_nrs_policy *policy)
+{
+	struct nrs_wfq_head *head = policy->pol_private;
+	struct nrs_cond_class *class;
+	struct nrs_cond_class *tmp;
+	ENTRY;
+
+	LASSERT(head != NULL);
+	LASSERT(list_empty(&head->wh_active));
+
+	rhashtable_free_and_destroy(&head->wh_flow_hash, nrs_wfq_flow_exit,
+				    NULL);
+
+	list_for_each_entry_safe(class, tmp, &head->wh_classes, cc_linkage) {
+		list_del_init(&class->cc_linkage);
+		nrs_cond_class_put(&nrs_wfq_class_conf, class);
+	}
+
+	OBD_FREE_PTR(head);
+	EXIT;
+}
+
+static int nrs_wfq_stats_dump(struct nrs_wfq_head *head, struct seq_file *m)
+{
+	struct nrs_wfq_class *class;
+	int i;
+
+	spin_lock(&head->wh_lock);
+	list_for_each_entry(class, &head->wh_classes, wc_class.cc_linkage) {
+		struct obd_histogram *hist = &class->wc_delay_hist;
+
+		seq_printf(m, "- class: %s\n"
+			   "  weight: %u\n"
+			   "  served_rpcs: %llu\n"
+			   "  served_bytes: %llu\n"
+			   "  delay_usec:\n",
+			   class->wc_class.cc_name, class->wc_class.cc_value,
+			   class->wc_served_rpcs, class->wc_served_bytes);
+		/* requests which waited less than the given time */
+		for (i = 0; i < OBD_HIST_MAX; i++) {
+			if (hist->oh_buckets[i] == 0)
+				continue;
+			seq_printf(m, "    %lu: %lu\n", 1UL << (i + 1),
+				   hist->oh_buckets[i]);
+		}
+	}
+	spin_unlock(&head->wh_lock);
+
+	return 0;
+}
+
+/**
+ * Performs a policy-specific ctl function on WFQ policy instances; similar
+ * to ioctl.
+ *
+ * \param[in]	  policy the policy instance
+ * \param[in]	  opc	 the opcode
+ * \param[in,out] arg	 used for passing parameters and information
+ *
+ * \pre assert_spin_locked(&policy->pol_nrs->->nrs_lock)
+ * \post assert_spin_locked(&policy->pol_nrs->->nrs_lock)
+ *
+ * \retval 0   operation carried out successfully
+ * \retval -ve error
+ */
+static int nrs_wfq_ctl(struct ptlrpc_nrs_policy *policy,
+		       enum ptlrpc_nrs_ctl opc, void *arg)
+{
+	struct nrs_wfq_head *head = policy->pol_private;
+	int rc = 0;
+	ENTRY;
+
+	assert_spin_locked(&policy->pol_nrs->nrs_lock);
+
+	switch ((enum nrs_ctl_wfq)opc) {
+	default:
+		RETURN(-EINVAL);
+
+	case NRS_CTL_WFQ_RD_RULE: {
+		struct seq_file *m = arg;
+
+		seq_printf(m, "CPT %d:\n", nrs_pol2cptid(policy));
+		nrs_cond_class_dump(&nrs_wfq_class_conf, &head->wh_classes,
+				    &head->wh_lock, m);
+		}
+		break;
+
+	case NRS_CTL_WFQ_WR_RULE:
+		rc = nrs_cond_class_command(policy, &nrs_wfq_class_conf,
+					    &head->wh_classes, &head->wh_lock,
+					    arg);
+		break;
+
+	case NRS_CTL_WFQ_RD_STATS: {
+		struct seq_file *m = arg;
+
+		seq_printf(m, "CPT %d:\n", nrs_pol2cptid(policy));
+		rc = nrs_wfq_stats_dump(head, m);
+		}
+		break;
+
+	case NRS_CTL_WFQ_RD_QUANTUM:
+		*(__u32 *)arg = head->wh_quantum;
+		break;
+
+	case NRS_CTL_WFQ_WR_QUANTUM:
+		head->wh_quantum = *(__u32 *)arg;
+		LASSERT(head->wh_quantum != 0);
+		break;
+	}
+
+	RETURN(rc);
+}
+
+/**
+ * Gets the bulk size and the project ID of OST_READ and OST_WRITE requests.
+ */
+static void nrs_wfq_req_bulk(struct ptlrpc_request *req, __u32 *bytes,
+			     __u32 *projid)
+{
+	u32 opc = lustre_msg_get_opc(req->rq_reqmsg);
+	struct niobuf_remote *nb;
+	struct ost_body *body;
+	bool fmt_unset = false;
+	int nrbufs;
+	int i;
+
+	*bytes = 0;
+	*projid = 0;
+	if (opc != OST_READ && opc != OST_WRITE)
+		return;
+
+	/* see nrs_tbf_id_cli_set() */
+	req_capsule_init(&req->rq_pill, req, RCL_SERVER);
+	if (req->rq_pill.rc_fmt == NULL) {
+		req_capsule_set(&req->rq_pill, opc == OST_READ ?
+				&RQF_OST_BRW_READ : &RQF_OST_BRW_WRITE);
+		fmt_unset = true;
+	}
+
+	body = req_capsule_client_get(&req->rq_pill, &RMF_OST_BODY);
+	if (body != NULL && body->oa.o_valid & OBD_MD_FLPROJID)
+		*projid = body->oa.o_projid;
+
+	nb = req_capsule_client_get(&req->rq_pill, &RMF_NIOBUF_REMOTE);
+	if (nb != NULL) {
+		nrbufs = req_capsule_get_size(&req->rq_pill,
+					      &RMF_NIOBUF_REMOTE,
+					      RCL_CLIENT) / sizeof(*nb);
+		for (i = 0; i < nrbufs; i++)
+			*bytes += nb[i].rnb_len;
+	}
+
+	if (fmt_unset)
+		req->rq_pill.rc_fmt = NULL;
+}
+
+/**
+ * Obtains resources from WFQ policy instances. The top-level resource lives
+ * inside \e nrs_wfq_head and the second-level resource inside
+ * \e nrs_wfq_flow object instances.
+ *
+ * \param[in]  policy	  the policy for which resources are being taken for
+ *			  request \a nrq
+ * \param[in]  nrq	  the request for which resources are being taken
+ * \param[in]  parent	  parent resource, embedded in nrs_wfq_head
+ * \param[out] resp	  resources references are placed in this array
+ * \param[in]  moving_req signifies limited caller context; used to perform
+ *			  memory allocations in an atomic context in this
+ *			  policy
+ *
+ * \retval 0   we are returning a top-level, parent resource
+ * \retval 1   we are returning a bottom-level resource, one that is embedded
+ *	       in an nrs_wfq_flow object
+ *
+ * \see nrs_resource_get_safe()
+ */
+static int nrs_wfq_res_get(struct ptlrpc_nrs_policy *policy,
+			   struct ptlrpc_nrs_request *nrq,
+			   const struct ptlrpc_nrs_resource *parent,
+			   struct ptlrpc_nrs_resource **resp, bool moving_req)
+{
+	struct nrs_wfq_head *head;
+	struct nrs_wfq_class *class;
+	struct nrs_wfq_flow *flow;
+	struct nrs_wfq_flow *tmp;
+	struct ptlrpc_request *req;
+	struct nrs_wfq_key key;
+	struct tbf_id id;
+	char *jobid;
+	__u32 projid;
+	u32 opc;
+
+	if (parent == NULL) {
+		*resp = &((struct nrs_wfq_head *)policy->pol_private)->wh_res;
+		return 0;
+	}
+
+	head = container_of(parent, struct nrs_wfq_head, wh_res);
+	req = container_of(nrq, struct ptlrpc_request, rq_nrq);
+
+	opc = lustre_msg_get_opc(req->rq_reqmsg);
+	jobid = lustre_msg_get_jobid(req->rq_reqmsg);
+	if (jobid == NULL)
+		jobid = "";
+	nrs_tbf_id_cli_set(req, &id, NRS_TBF_FLAG_UID | NRS_TBF_FLAG_GID);
+	nrs_wfq_req_bulk(req, &nrq->nr_u.wfq.wr_bytes, &projid);
+	/* requests without bulk data are charged as a page */
+	nrq->nr_u.wfq.wr_cost = max_t(__u32, nrq->nr_u.wfq.wr_bytes,
+				      PAGE_SIZE);
+
+	memset(&key, 0, sizeof(key));
+	switch (head->wh_key_type) {
+	case NRS_WFQ_KEY_JOBID:
+		strlcpy(key.wk_id, jobid, sizeof(key.wk_id));
+		break;
+	case NRS_WFQ_KEY_UID:
+		snprintf(key.wk_id, sizeof(key.wk_id), "%u", id.ti_uid);
+		break;
+	case NRS_WFQ_KEY_GID:
+		snprintf(key.wk_id, sizeof(key.wk_id), "%u", id.ti_gid);
+		break;
+	case NRS_WFQ_KEY_PROJID:
+		snprintf(key.wk_id, sizeof(key.wk_id), "%u", projid);
+		break;
+	case NRS_WFQ_KEY_NID:
+		libcfs_nid2str_r(req->rq_peer.nid, key.wk_id,
+				 sizeof(key.wk_id));
+		break;
+	}
+
+	spin_lock(&head->wh_lock);
+	class = nrs_wfq_classify(head, req->rq_peer.nid, jobid, opc, id);
+	key.wk_class = class;
+	flow = rhashtable_lookup_fast(&head->wh_flow_hash, &key,
+				      nrs_wfq_hash_params);
+	if (flow != NULL) {
+		flow->wf_ref++;
+		spin_unlock(&head->wh_lock);
+		goto out;
+	}
+	/* the new flow holds a reference on its class */
+	class->wc_class.cc_ref++;
+	spin_unlock(&head->wh_lock);
+
+	OBD_CPT_ALLOC_GFP(flow, nrs_pol2cptab(policy), nrs_pol2cptid(policy),
+			  sizeof(*flow), moving_req ? GFP_ATOMIC : GFP_NOFS);
+	if (flow == NULL) {
+		spin_lock(&head->wh_lock);
+		nrs_wfq_class_put(class);
+		spin_unlock(&head->wh_lock);
+		return -ENOMEM;
+	}
+
+	flow->wf_key = key;
+	INIT_LIST_HEAD(&flow->wf_active);
+	INIT_LIST_HEAD(&flow->wf_queue);
+	flow->wf_ref = 1;
+
+	spin_lock(&head->wh_lock);
+	tmp = rhashtable_lookup_get_insert_fast(&head->wh_flow_hash,
+						&flow->wf_rhead,
+						nrs_wfq_hash_params);
+	if (tmp != NULL) {
+		/* insertion failed */
+		nrs_wfq_class_put(class);
+		if (!IS_ERR(tmp))
+			tmp->wf_ref++;
+	}
+	spin_unlock(&head->wh_lock);
+
+	if (tmp != NULL) {
+		OBD_FREE_PTR(flow);
+		if (IS_ERR(tmp))
+			return PTR_ERR(tmp);
+		flow = tmp;
+	}
+out:
+	*resp = &flow->wf_res;
+
+	return 1;
+}
+
+/**
+ * Called when releasing references to the resource hierachy obtained for a
+ * request for scheduling using the WFQ policy. Flows are freed once they have
+ * no requests, so that the memory used does not grow with the number of jobs
+ * ever seen; an idle flow loses its deficit anyway.
+ *
+ * \param[in] policy   the policy the resource belongs to
+ * \param[in] res      the resource to be released
+ */
+static void nrs_wfq_res_put(struct ptlrpc_nrs_policy *policy,
+			    const struct ptlrpc_nrs_resource *res)
+{
+	struct nrs_wfq_head *head;
+	struct nrs_wfq_flow *flow;
+
+	/**
+	 * Do nothing for freeing parent, nrs_wfq_head resources
+	 */
+	if (res->res_parent == NULL)
+		return;
+
+	flow = container_of(res, struct nrs_wfq_flow, wf_res);
+	head = container_of(res->res_parent, struct nrs_wfq_head, wh_res);
+
+	spin_lock(&head->wh_lock);
+	if (--flow->wf_ref > 0) {
+		spin_unlock(&head->wh_lock);
+		return;
+	}
+
+	LASSERT(list_empty(&flow->wf_queue));
+	rhashtable_remove_fast(&head->wh_flow_hash, &flow->wf_rhead,
+			       nrs_wfq_hash_params);
+	nrs_wfq_class_put(flow->wf_key.wk_class);
+	spin_unlock(&head->wh_lock);
+
+	OBD_FREE_PTR(flow);
+}
+
+static inline struct ptlrpc_nrs_request *
+nrs_wfq_flow_first(struct nrs_wfq_flow *flow)
+{
+	return list_first_entry(&flow->wf_queue, struct ptlrpc_nrs_request,
+				nr_u.wfq.wr_list);
+}
+
+static void nrs_wfq_flow_dequeue(struct nrs_wfq_flow *flow,
+				 struct ptlrpc_nrs_request *nrq)
+{
+	list_del_init(&nrq->nr_u.wfq.wr_list);
+	if (list_empty(&flow->wf_queue)) {
+		list_del_init(&flow->wf_active);
+		flow->wf_deficit = 0;
+	}
+}
+
+/* Bytes credited to \a flow every round */
+static inline __u64 nrs_wfq_flow_quantum(struct nrs_wfq_flow *flow,
+					 __u32 quantum)
+{
+	struct nrs_wfq_class *class = flow->wf_key.wk_class;
+
+	return (__u64)quantum * READ_ONCE(class->wc_class.cc_value);
+}
+
+/**
+ * Finds the active flow to be served next, without changing any deficit.
+ *
+ * A flow has to wait DIV_ROUND_UP(cost - deficit, quantum) rounds before it
+ * can be served its first request. The flow waiting the fewest rounds is
+ * served first, ties going to the flow found first in round order, which is
+ * the one Deficit Round Robin would have reached first.
+ *
+ * \param[in]  head    the WFQ policy instance
+ * \param[in]  quantum the quantum of the instance
+ * \param[out] rounds  the rounds the flow has to wait
+ *
+ * \retval the flow to be served next
+ * \retval NULL no request queued
+ */
+static struct nrs_wfq_flow *nrs_wfq_flow_next(struct nrs_wfq_head *head,
+					      __u32 quantum, __u64 *rounds)
+{
+	struct nrs_wfq_flow *next = NULL;
+	struct nrs_wfq_flow *flow;
+	__u64 min = U64_MAX;
+
+	list_for_each_entry(flow, &head->wh_active, wf_active) {
+		__u64 cost = nrs_wfq_flow_first(flow)->nr_u.wfq.wr_cost;
+		__u64 q;
+		__u64 r = 0;
+
+		if (flow->wf_deficit < cost) {
+			q = nrs_wfq_flow_quantum(flow, quantum);
+			r = div64_u64(cost - flow->wf_deficit + q - 1, q);
+		}
+
+		if (r < min) {
+			min = r;
+			next = flow;
+			if (r == 0)
+				break;
+		}
+	}
+
+	*rounds = min;
+
+	return next;
+}
+
+/**
+ * Called when getting a request from the WFQ policy for handling.
+ *
+ * The flow chosen by nrs_wfq_flow_next() is served. Unless just peeking, the
+ * rounds it waited for are then accounted at once: every flow ahead of it in
+ * the round gets one quantum times the weight of its class more than the
+ * others, and those flows move to the end of the round.
+ *
+ * \param[in] policy the policy being polled
+ * \param[in] peek   when set, signifies that we just want to examine the
+ *		     request, and not handle it, so the request is not removed
+ *		     from the policy.
+ * \param[in] force  force the policy to return a request; unused in this policy
+ *
+ * \retval the request to be handled
+ * \retval NULL no request available
+ *
+ * \see ptlrpc_nrs_req_get_nolock()
+ * \see nrs_request_get()
+ */
+static
+struct ptlrpc_nrs_request *nrs_wfq_req_get(struct ptlrpc_nrs_policy *policy,
+					   bool peek, bool force)
+{
+	struct nrs_wfq_head *head = policy->pol_private;
+	__u32 quantum = READ_ONCE(head->wh_quantum);
+	struct ptlrpc_nrs_request *nrq;
+	struct nrs_wfq_class *class;
+	struct ptlrpc_request *req;
+	struct nrs_wfq_flow *flow;
+	struct nrs_wfq_flow *tmp;
+	bool ahead = true;
+	__u64 rounds;
+	__u64 cost;
+	s64 delay;
+
+	flow = nrs_wfq_flow_next(head, quantum, &rounds);
+	if (flow == NULL)
+		return NULL;
+
+	nrq = nrs_wfq_flow_first(flow);
+	if (peek)
+		return nrq;
+
+	list_for_each_entry(tmp, &head->wh_active, wf_active) {
+		if (tmp == flow) {
+			ahead = false;
+			if (rounds == 0)
+				break;
+		}
+		tmp->wf_deficit += (rounds + ahead) *
+				   nrs_wfq_flow_quantum(tmp, quantum);
+	}
+
+	while ((tmp = list_first_entry(&head->wh_active, struct nrs_wfq_flow,
+				       wf_active)) != flow)
+		list_move_tail(&tmp->wf_active, &head->wh_active);
+
+	/* the class weight may have been changed meanwhile */
+	cost = nrq->nr_u.wfq.wr_cost;
+	flow->wf_deficit = max(flow->wf_deficit, cost) - cost;
+	nrs_wfq_flow_dequeue(flow, nrq);
+
+	req = container_of(nrq, struct ptlrpc_request, rq_nrq);
+	delay = ktime_us_delta(ktime_get_real(),
+			       timespec64_to_ktime(req->rq_arrival_time));
+	class = flow->wf_key.wk_class;
+
+	spin_lock(&head->wh_lock);
+	class->wc_served_rpcs++;
+	class->wc_served_bytes += nrq->nr_u.wfq.wr_bytes;
+	spin_unlock(&head->wh_lock);
+	lprocfs_oh_tally_log2(&class->wc_delay_hist, max_t(s64, delay, 0));
+
+	CDEBUG(D_RPCTRACE,
+	       "NRS: starting to handle %s request from %s, class %s, flow %s\n",
+	       NRS_POL_NAME_WFQ, libcfs_id2str(req->rq_peer),
+	       class->wc_class.cc_name, flow->wf_key.wk_id);
+
+	return nrq;
+}
+
+/**
+ * Adds request \a nrq to a WFQ \a policy instance's set of queued requests.
+ * A flow becoming active starts at the end of the current round with no
+ * deficit.
+ *
+ * \param[in] policy the policy
+ * \param[in] nrq    the request to add
+ *
+ * \retval 0	request successfully added
+ */
+static int nrs_wfq_req_add(struct ptlrpc_nrs_policy *policy,
+			   struct ptlrpc_nrs_request *nrq)
+{
+	struct nrs_wfq_head *head;
+	struct nrs_wfq_flow *flow;
+
+	flow = container_of(nrs_request_resource(nrq),
+			    struct nrs_wfq_flow, wf_res);
+	head = container_of(nrs_request_resource(nrq)->res_parent,
+			    struct nrs_wfq_head, wh_res);
+
+	if (list_empty(&flow->wf_queue))
+		list_add_tail(&flow->wf_active, &head->wh_active);
+	list_add_tail(&nrq->nr_u.wfq.wr_list, &flow->wf_queue);
+
+	return 0;
+}
+
+/**
+ * Removes request \a nrq from a WFQ \a policy instance's set of queued
+ * requests.
+ *
+ * \param[in] policy the policy
+ * \param[in] nrq    the request to remove
+ */
+static void nrs_wfq_req_del(struct ptlrpc_nrs_policy *policy,
+			    struct ptlrpc_nrs_request *nrq)
+{
+	struct nrs_wfq_flow *flow;
+
+	flow = container_of(nrs_request_resource(nrq),
+			    struct nrs_wfq_flow, wf_res);
+	nrs_wfq_flow_dequeue(flow, nrq);
+}
+
+/**
+ * Called right after the request \a nrq finishes being handled by WFQ policy
+ * instance \a policy.
+ *
+ * \param[in] policy the policy that handled the request
+ * \param[in] nrq    the request that was handled
+ */
+static void nrs_wfq_req_stop(struct ptlrpc_nrs_policy *policy,
+			     struct ptlrpc_nrs_request *nrq)
+{
+	struct ptlrpc_request *req = container_of(nrq, struct ptlrpc_request,
+						  rq_nrq);
+
+	CDEBUG(D_RPCTRACE,
+	       "NRS: finished handling %s request from %s, %u bytes\n",
+	       NRS_POL_NAME_WFQ, libcfs_id2str(req->rq_peer),
+	       nrq->nr_u.wfq.wr_bytes);
+}
+
+/**
+ * debugfs interface
+ */
+
+/**
+ * Lists the classes of WFQ policy instances, newest first, with their
+ * conditions and weight.
+ *
+ * For example:
+ *
+ *	regular_requests:
+ *	CPT 0:
+ *	big jobid={dd.0} weight=4, ref 1
+ *	default * weight=1, ref 0
+ */
+static int
+ptlrpc_lprocfs_nrs_wfq_rule_seq_show(struct seq_file *m, void *data)
+{
+	return nrs_cond_lprocfs_dump(&nrs_wfq_class_conf, m,
+				     NRS_CTL_WFQ_RD_RULE);
+}
+
+/**
+ * Starts, changes or stops a class of WFQ policy instances on both NRS heads
+ * of a service, or on the head given by a "reg" or "hp" prefix.
+ *
+ * For example:
+ *
+ * lctl set_param ost.OSS.ost_io.nrs_wfq_rule="start big jobid={dd.0} weight=4"
+ * lctl set_param ost.OSS.ost_io.nrs_wfq_rule="change big weight=2"
+ * lctl set_param ost.OSS.ost_io.nrs_wfq_rule="reg stop big"
+ */
+static ssize_t
+ptlrpc_lprocfs_nrs_wfq_rule_seq_write(struct file *file,
+				      const char __user *buffer,
+				      size_t count, loff_t *off)
+{
+	return nrs_cond_rule_write(&nrs_wfq_class_conf, file, buffer, count);
+}
+
+LDEBUGFS_SEQ_FOPS(ptlrpc_lprocfs_nrs_wfq_rule);
+
+/**
+ * Shows, for each class of WFQ policy instances, the number of requests and
+ * bytes served, and a histogram of the time spent by requests in the queue;
+ * each line of delay_usec gives the number of requests which waited less
+ * than the given number of microseconds.
+ */
+static int
+ptlrpc_lprocfs_nrs_wfq_stats_seq_show(struct seq_file *m, void *data)
+{
+	return nrs_cond_lprocfs_dump(&nrs_wfq_class_conf, m,
+				     NRS_CTL_WFQ_RD_STATS);
+}
+
+LDEBUGFS_SEQ_FOPS_RO(ptlrpc_lprocfs_nrs_wfq_stats);
+
+/**
+ * Retrieves the DRR quantum, in bytes, of WFQ policy instances on both the
+ * regular and high-priority NRS head of a service.
+ *
+ * For example:
+ *
+ *	reg_quantum:1048576
+ *	hp_quantum:1048576
+ */
+static int
+ptlrpc_lprocfs_nrs_wfq_quantum_seq_show(struct seq_file *m, void *data)
+{
+	struct ptlrpc_service *svc = m->private;
+	__u32 quantum;
+	int rc;
+
+	rc = ptlrpc_nrs_policy_control(svc, PTLRPC_NRS_QUEUE_REG,
+				       NRS_POL_NAME_WFQ,
+				       NRS_CTL_WFQ_RD_QUANTUM,
+				       true, &quantum);
+	if (rc == 0)
+		seq_printf(m, NRS_LPROCFS_QUANTUM_NAME_REG"%u\n", quantum);
+	else if (rc != -ENODEV)
+		return rc;
+
+	if (!nrs_svc_has_hp(svc))
+		return rc;
+
+	rc = ptlrpc_nrs_policy_control(svc, PTLRPC_NRS_QUEUE_HP,
+				       NRS_POL_NAME_WFQ,
+				       NRS_CTL_WFQ_RD_QUANTUM,
+				       true, &quantum);
+	if (rc == 0)
+		seq_printf(m, NRS_LPROCFS_QUANTUM_NAME_HP"%u\n", quantum);
+	else if (rc != -ENODEV)
+		return rc;
+
+	return rc;
+}
+
+/**
+ * Sets the DRR quantum of WFQ policy instances of a service, in the same
+ * formats as nrs_crrn_quantum, e.g.
+ *
+ * lctl set_param ost.OSS.ost_io.nrs_wfq_quantum=reg_quantum:4194304
+ */
+static ssize_t
+ptlrpc_lprocfs_nrs_wfq_quantum_seq_write(struct file *file,
+					 const char __user *buffer,
+					 size_t count, loff_t *off)
+{
+	struct seq_file *m = file->private_data;
+	struct ptlrpc_service *svc = m->private;
+	enum ptlrpc_nrs_queue_type queue = 0;
+	char kernbuf[64];
+	char *val;
+	__u32 quantum_reg;
+	__u32 quantum_hp;
+	/** lprocfs_find_named_value() modifies its argument, so keep a copy */
+	size_t count_copy;
+	int rc = 0;
+	int rc2 = 0;
+
+	if (count > (sizeof(kernbuf) - 1))
+		return -EINVAL;
+
+	if (copy_from_user(kernbuf, buffer, count))
+		return -EFAULT;
+
+	kernbuf[count] = '\0';
+
+	count_copy = count;
+	val = lprocfs_find_named_value(kernbuf, NRS_LPROCFS_QUANTUM_NAME_REG,
+				       &count_copy);
+	if (val != kernbuf) {
+		rc = kstrtouint(val, 10, &quantum_reg);
+		if (rc)
+			return rc;
+
+		queue |= PTLRPC_NRS_QUEUE_REG;
+	}
+
+	count_copy = count;
+	val = lprocfs_find_named_value(kernbuf, NRS_LPROCFS_QUANTUM_NAME_HP,
+				       &count_copy);
+	if (val != kernbuf) {
+		if (!nrs_svc_has_hp(svc))
+			return -ENODEV;
+
+		rc = kstrtouint(val, 10, &quantum_hp);
+		if (rc)
+			return rc;
+
+		queue |= PTLRPC_NRS_QUEUE_HP;
+	}
+
+	if (queue == 0) {
+		rc = kstrtouint(kernbuf, 10, &quantum_reg);
+		if (rc)
+			return rc;
+
+		queue = PTLRPC_NRS_QUEUE_REG;
+
+		if (nrs_svc_has_hp(svc)) {
+			queue |= PTLRPC_NRS_QUEUE_HP;
+			quantum_hp = quantum_reg;
+		}
+	}
+
+	if ((((queue & PTLRPC_NRS_QUEUE_REG) != 0) &&
+	    (quantum_reg > NRS_WFQ_QUANTUM_MAX || quantum_reg == 0)) ||
+	    (((queue & PTLRPC_NRS_QUEUE_HP) != 0) &&
+	    (quantum_hp > NRS_WFQ_QUANTUM_MAX || quantum_hp == 0)))
+		return -EINVAL;
+
+	/**
+	 * See ptlrpc_lprocfs_nrs_crrn_quantum_seq_write() for the handling of
+	 * -ENODEV.
+	 */
+	if ((queue & PTLRPC_NRS_QUEUE_REG) != 0) {
+		rc = ptlrpc_nrs_policy_control(svc, PTLRPC_NRS_QUEUE_REG,
+					       NRS_POL_NAME_WFQ,
+					       NRS_CTL_WFQ_WR_QUANTUM, false,
+					       &quantum_reg);
+		if ((rc < 0 && rc != -ENODEV) ||
+		    (rc == -ENODEV && queue == PTLRPC_NRS_QUEUE_REG))
+			return rc;
+	}
+
+	if ((queue & PTLRPC_NRS_QUEUE_HP) != 0) {
+		rc2 = ptlrpc_nrs_policy_control(svc, PTLRPC_NRS_QUEUE_HP,
+						NRS_POL_NAME_WFQ,
+						NRS_CTL_WFQ_WR_QUANTUM, false,
+						&quantum_hp);
+		if ((rc2 < 0 && rc2 != -ENODEV) ||
+		    (rc2 == -ENODEV && queue == PTLRPC_NRS_QUEUE_HP))
+			return rc2;
+	}
+
+	return rc == -ENODEV && rc2 == -ENODEV ? -ENODEV : count;
+}
+
+LDEBUGFS_SEQ_FOPS(ptlrpc_lprocfs_nrs_wfq_quantum);
+
+/**
+ * Initializes a WFQ policy's lprocfs interface for service \a svc
+ *
+ * \param[in] svc the service
+ *
+ * \retval 0	success
+ * \retval != 0	error
+ */
+static int nrs_wfq_lprocfs_init(struct ptlrpc_service *svc)
+{
+	struct ldebugfs_vars nrs_wfq_lprocfs_vars[] = {
+		{ .name		= "nrs_wfq_rule",
+		  .fops		= &ptlrpc_lprocfs_nrs_wfq_rule_fops,
+		  .data		= svc },
+		{ .name		= "nrs_wfq_stats",
+		  .fops		= &ptlrpc_lprocfs_nrs_wfq_stats_fops,
+		  .data		= svc },
+		{ .name		= "nrs_wfq_quantum",
+		  .fops		= &ptlrpc_lprocfs_nrs_wfq_quantum_fops,
+		  .data		= svc },
+		{ NULL }
+	};
+
+	if (!svc->srv_debugfs_entry)
+		return 0;
+
+	ldebugfs_add_vars(svc->srv_debugfs_entry, nrs_wfq_lprocfs_vars, NULL);
+
+	return 0;
+}
+
+/**
+ * WFQ policy operations
+ */
+static const struct ptlrpc_nrs_pol_ops nrs_wfq_ops = {
+	.op_policy_start	= nrs_wfq_start,
+	.op_policy_stop		= nrs_wfq_stop,
+	.op_policy_ctl		= nrs_wfq_ctl,
+	.op_res_get		= nrs_wfq_res_get,
+	.op_res_put		= nrs_wfq_res_put,
+	.op_req_get		= nrs_wfq_req_get,
+	.op_req_enqueue		= nrs_wfq_req_add,
+	.op_req_dequeue		= nrs_wfq_req_del,
+	.op_req_stop		= nrs_wfq_req_stop,
+	.op_lprocfs_init	= nrs_wfq_lprocfs_init,
+};
+
+/**
+ * WFQ policy configuration
+ */
+struct ptlrpc_nrs_pol_conf nrs_conf_wfq = {
+	.nc_name		= NRS_POL_NAME_WFQ,
+	.nc_ops			= &nrs_wfq_ops,
+	.nc_compat		= nrs_policy_compat_all,
+};
+
+/** @} WFQ policy */
+
+/** @} nrs */
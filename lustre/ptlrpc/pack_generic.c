@@ -1823,7 +1823,7 @@ void lustre_swab_obdo(struct obdo *o)
 	__swab32s(&o->o_gid_h);
 	__swab64s(&o->o_data_version);
 	__swab32s(&o->o_projid);
-	BUILD_BUG_ON(offsetof(typeof(*o), o_padding_4) == 0);
+	__swab32s(&o->o_compr_nob);
 	BUILD_BUG_ON(offsetof(typeof(*o), o_padding_5) == 0);
 	BUILD_BUG_ON(offsetof(typeof(*o), o_padding_6) == 0);
 
@@ -1868,6 +1868,15 @@ void lustre_swab_niobuf_remote(struct niobuf_remote *nbr)
 	__swab32s(&nbr->rnb_flags);
 }
 
+void lustre_swab_ll_compr_chunk_hdr(struct ll_compr_chunk_hdr *hdr)
+{
+	__swab32s(&hdr->lcch_magic);
+	__swab32s(&hdr->lcch_uncompr_size);
+	__swab32s(&hdr->lcch_compr_size);
+	BUILD_BUG_ON(offsetof(typeof(*hdr), lcch_padding_1) == 0);
+	BUILD_BUG_ON(offsetof(typeof(*hdr), lcch_padding_2) == 0);
+}
+
 void lustre_swab_ost_body(struct ost_body *b)
 {
 	lustre_swab_obdo(&b->oa);
@@ -2350,6 +2359,9 @@ void lustre_print_user_md(unsigned int lvl, struct lov_user_md *lum,
 		if (ent->lcme_flags & LCME_FL_NOSYNC)
 			CDEBUG(lvl, "\tlcme_timestamp: %llu\n",
 					ent->lcme_timestamp);
+		if (ent->lcme_compr_type != LL_COMPR_TYPE_NONE)
+			CDEBUG(lvl, "\tlcme_compr_type: %s\n",
+			       ll_compr_type2name(ent->lcme_compr_type));
 		CDEBUG(lvl, "\tlcme_extent.e_start: %llu\n",
 		       ent->lcme_extent.e_start);
 		CDEBUG(lvl, "\tlcme_extent.e_end: %llu\n",
@@ -2445,6 +2457,7 @@ void lustre_swab_lov_comp_md_v1(struct lov_comp_md_v1 *lum)
 		__swab32s(&ent->lcme_size);
 		__swab32s(&ent->lcme_layout_gen);
 		BUILD_BUG_ON(offsetof(typeof(*ent), lcme_padding_1) == 0);
+		BUILD_BUG_ON(offsetof(typeof(*ent), lcme_padding_2) == 0);
 
 		v1 = (struct lov_user_md_v1 *)((char *)lum + off);
 		stripe_count = v1->lmm_stripe_count;
@@ -2906,6 +2919,22 @@ void lustre_swab_close_data_resync_done(struct close_data_resync_done *resync)
 }
 EXPORT_SYMBOL(lustre_swab_close_data_resync_done);
 
+void lustre_swab_msg_batch_header(struct msg_batch_header *mbh)
+{
+	__swab32s(&mbh->mbh_magic);
+	__swab32s(&mbh->mbh_count);
+	__swab32s(&mbh->mbh_reply_size);
+	__swab32s(&mbh->mbh_padding);
+}
+
+/* sub-reply messages are swabbed one by one when they are unpacked */
+void lustre_swab_msg_batch_reply(struct msg_batch_reply *mbr)
+{
+	__swab32s(&mbr->mbr_magic);
+	__swab16s(&mbr->mbr_count);
+	__swab16s(&mbr->mbr_padding);
+}
+
 void lustre_swab_lfsck_request(struct lfsck_request *lr)
 {
 	__swab32s(&lr->lr_event);
@@ -52,6 +52,50 @@ extern struct ptlrpc_nrs_pol_conf nrs_conf_crrn;
 extern struct ptlrpc_nrs_pol_conf nrs_conf_orr;
 extern struct ptlrpc_nrs_pol_conf nrs_conf_trr;
 extern struct ptlrpc_nrs_pol_conf nrs_conf_tbf;
+extern struct ptlrpc_nrs_pol_conf nrs_conf_wfq;
+extern struct ptlrpc_nrs_pol_conf nrs_conf_edf;
+
+/* nrs_tbf.c, also used by the WFQ and EDF policies for request classification */
+int nrs_tbf_id_cli_set(struct ptlrpc_request *req, struct tbf_id *id,
+		       enum nrs_tbf_flag ti_type);
+int nrs_tbf_conds_parse(char *str, int len, struct list_head *cond_list);
+void nrs_tbf_conds_free(struct list_head *cond_list);
+int nrs_tbf_conds_match(struct list_head *cond_list, lnet_nid_t nid,
+			char *jobid, u32 opcode, struct tbf_id id);
+
+/** Describes the classes of the WFQ or EDF policy and their rules */
+struct nrs_cond_class_conf {
+	char			*ccc_policy;
+	/** Policy ctl opcode passing a struct nrs_cond_cmd */
+	enum ptlrpc_nrs_ctl	 ccc_wr_opc;
+	/** Size of the class structure of the policy */
+	size_t			 ccc_size;
+	/** Rule option giving the value of a class, i.e. "weight" */
+	const char		*ccc_key;
+	__u32			 ccc_def;
+	__u32			 ccc_max;
+	/** Initializes the policy part of a new class, optional */
+	void			(*ccc_init)(struct nrs_cond_class *class);
+};
+
+struct nrs_cond_class *
+nrs_cond_class_alloc(struct ptlrpc_nrs_policy *policy,
+		     const struct nrs_cond_class_conf *conf, const char *name,
+		     const char *conds_str, __u32 value);
+void nrs_cond_class_put(const struct nrs_cond_class_conf *conf,
+			struct nrs_cond_class *class);
+int nrs_cond_class_command(struct ptlrpc_nrs_policy *policy,
+			   const struct nrs_cond_class_conf *conf,
+			   struct list_head *classes, spinlock_t *lock,
+			   struct nrs_cond_cmd *cmd);
+void nrs_cond_class_dump(const struct nrs_cond_class_conf *conf,
+			 struct list_head *classes, spinlock_t *lock,
+			 struct seq_file *m);
+int nrs_cond_lprocfs_dump(const struct nrs_cond_class_conf *conf,
+			  struct seq_file *m, enum ptlrpc_nrs_ctl opc);
+ssize_t nrs_cond_rule_write(const struct nrs_cond_class_conf *conf,
+			    struct file *file, const char __user *buffer,
+			    size_t count);
 #endif /* HAVE_SERVER_SUPPORT */
 
 /**
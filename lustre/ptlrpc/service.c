@@ -33,6 +33,7 @@
 
 #include <linux/kthread.h>
 #include <linux/ratelimit.h>
+#include <linux/tick.h>
 
 #include <obd_support.h>
 #include <obd_class.h>
@@ -64,6 +65,14 @@ static void ptlrpc_server_hpreq_fini(struct ptlrpc_request *req);
 static void ptlrpc_at_remove_timed(struct ptlrpc_request *req);
 static int ptlrpc_start_threads(struct ptlrpc_service *svc);
 static int ptlrpc_start_thread(struct ptlrpc_service_part *svcpt, int wait);
+static void ptlrpc_thrctl_work(struct work_struct *work);
+
+/* adaptive thread pool controller, see ptlrpc_thrctl_part() */
+#define PTLRPC_THRCTL_INTERVAL	1	/* seconds */
+#define PTLRPC_THRCTL_WAIT_US	1000
+#define PTLRPC_THRCTL_CPU_BUSY	90	/* percent */
+#define PTLRPC_THRCTL_QUIET	5
+#define PTLRPC_THRCTL_SPARE	2
 
 /** Holds a list of all PTLRPC services */
 LIST_HEAD(ptlrpc_all_services);
@@ -205,9 +214,9 @@ struct ptlrpc_hr_partition;
 
 struct ptlrpc_hr_thread {
 	int				hrt_id;		/* thread ID */
-	spinlock_t			hrt_lock;
 	wait_queue_head_t		hrt_waitq;
-	struct list_head		hrt_queue;
+	/* replies to handle, newest first, added without locking */
+	struct llist_head		hrt_queue;
 	struct ptlrpc_hr_partition	*hrt_partition;
 };
 
@@ -242,7 +251,9 @@ struct ptlrpc_hr_service {
 };
 
 struct rs_batch {
-	struct list_head			rsb_replies;
+	/* replies of the batch, newest first */
+	struct llist_node		*rsb_first;
+	struct llist_node		*rsb_last;
 	unsigned int			rsb_n_replies;
 	struct ptlrpc_service_part	*rsb_svcpt;
 };
@@ -252,8 +263,12 @@ static struct ptlrpc_hr_service		ptlrpc_hr;
 
 /**
  * maximum mumber of replies scheduled in one batch
+ *
+ * Dispatching a batch is a single atomic operation on the queue of the reply
+ * handling thread, which is only woken up if it had nothing to do, so the
+ * batches are mainly limited by the scp_rep_lock hold time.
  */
-#define MAX_SCHEDULED 256
+#define MAX_SCHEDULED 1024
 
 /**
  * Initialize a reply batch.
@@ -263,7 +278,6 @@ static struct ptlrpc_hr_service		ptlrpc_hr;
 static void rs_batch_init(struct rs_batch *b)
 {
 	memset(b, 0, sizeof(*b));
-	INIT_LIST_HEAD(&b->rsb_replies);
 }
 
 /**
@@ -304,11 +318,11 @@ static void rs_batch_dispatch(struct rs_batch *b)
 
 		hrt = ptlrpc_hr_select(b->rsb_svcpt);
 
-		spin_lock(&hrt->hrt_lock);
-		list_splice_init(&b->rsb_replies, &hrt->hrt_queue);
-		spin_unlock(&hrt->hrt_lock);
-
-		wake_up(&hrt->hrt_waitq);
+		if (llist_add_batch(b->rsb_first, b->rsb_last,
+				    &hrt->hrt_queue))
+			wake_up(&hrt->hrt_waitq);
+		b->rsb_first = NULL;
+		b->rsb_last = NULL;
 		b->rsb_n_replies = 0;
 	}
 }
@@ -335,10 +349,16 @@ static void rs_batch_add(struct rs_batch *b, struct ptlrpc_reply_state *rs)
 	spin_lock(&rs->rs_lock);
 	rs->rs_scheduled_ever = 1;
 	if (rs->rs_scheduled == 0) {
-		list_move(&rs->rs_list, &b->rsb_replies);
+		list_del_init(&rs->rs_list);
+		rs->rs_hr_node.next = b->rsb_first;
+		b->rsb_first = &rs->rs_hr_node;
+		if (b->rsb_last == NULL)
+			b->rsb_last = &rs->rs_hr_node;
 		rs->rs_scheduled = 1;
 		b->rsb_n_replies++;
 	}
+	if (!rs->rs_committed)
+		rs->rs_commit_time = ktime_get();
 	rs->rs_committed = 1;
 	spin_unlock(&rs->rs_lock);
 }
@@ -375,11 +395,8 @@ void ptlrpc_dispatch_difficult_reply(struct ptlrpc_reply_state *rs)
 
 	hrt = ptlrpc_hr_select(rs->rs_svcpt);
 
-	spin_lock(&hrt->hrt_lock);
-	list_add_tail(&rs->rs_list, &hrt->hrt_queue);
-	spin_unlock(&hrt->hrt_lock);
-
-	wake_up(&hrt->hrt_waitq);
+	if (llist_add(&rs->rs_hr_node, &hrt->hrt_queue))
+		wake_up(&hrt->hrt_waitq);
 	EXIT;
 }
 
@@ -603,6 +620,56 @@ static void ptlrpc_server_nthreads_check(struct ptlrpc_service *svc,
 	}
 }
 
+static unsigned int ptlrpc_service_part_distance(struct ptlrpc_service *svc,
+						 int i, int j)
+{
+	return cfs_cpt_distance(svc->srv_cptable, svc->srv_parts[i]->scp_cpt,
+				svc->srv_parts[j]->scp_cpt);
+}
+
+/**
+ * Sort the other partitions of each partition of \a svc by CPT distance,
+ * for threads to steal requests from the nearest ones first.
+ */
+static int ptlrpc_service_steal_init(struct ptlrpc_service *svc)
+{
+	struct ptlrpc_service_part *svcpt;
+	unsigned int distance;
+	int *order;
+	int n;
+	int i;
+	int j;
+	int k;
+
+	if (svc->srv_ncpts < 2)
+		return 0;
+
+	ptlrpc_service_for_each_part(svcpt, i, svc) {
+		OBD_CPT_ALLOC(order, svc->srv_cptable, svcpt->scp_cpt,
+			      (svc->srv_ncpts - 1) * sizeof(*order));
+		if (order == NULL)
+			return -ENOMEM;
+
+		for (j = 0, n = 0; j < svc->srv_ncpts; j++) {
+			if (j == i)
+				continue;
+
+			distance = ptlrpc_service_part_distance(svc, i, j);
+			for (k = n; k > 0; k--) {
+				if (ptlrpc_service_part_distance(svc, i,
+						order[k - 1]) <= distance)
+					break;
+				order[k] = order[k - 1];
+			}
+			order[k] = j;
+			n++;
+		}
+		svcpt->scp_steal_order = order;
+	}
+
+	return 0;
+}
+
 /**
  * Initialize percpt data for a service
  */
@@ -780,6 +847,8 @@ struct ptlrpc_service *ptlrpc_register_service(struct ptlrpc_service_conf *conf,
 
 	/* public members */
 	spin_lock_init(&service->srv_lock);
+	service->srv_thrctl_wait_us	= PTLRPC_THRCTL_WAIT_US;
+	INIT_DELAYED_WORK(&service->srv_thrctl_work, ptlrpc_thrctl_work);
 	service->srv_name		= conf->psc_name;
 	service->srv_watchdog_factor	= conf->psc_watchdog_factor;
 	INIT_LIST_HEAD(&service->srv_list); /* for safty of cleanup */
@@ -830,6 +899,10 @@ struct ptlrpc_service *ptlrpc_register_service(struct ptlrpc_service_conf *conf,
 			GOTO(failed, rc);
 	}
 
+	rc = ptlrpc_service_steal_init(service);
+	if (rc != 0)
+		GOTO(failed, rc);
+
 	ptlrpc_server_nthreads_check(service, conf);
 
 	rc = LNetSetLazyPortal(service->srv_req_portal);
@@ -862,6 +935,9 @@ struct ptlrpc_service *ptlrpc_register_service(struct ptlrpc_service_conf *conf,
 		GOTO(failed, rc);
 	}
 
+	schedule_delayed_work(&service->srv_thrctl_work,
+			      cfs_time_seconds(PTLRPC_THRCTL_INTERVAL));
+
 	RETURN(service);
 failed:
 	ptlrpc_unregister_service(service);
@@ -1069,6 +1145,112 @@ void ptlrpc_request_change_export(struct ptlrpc_request *req,
 	class_export_rpc_inc(export);
 }
 
+/**
+ * Prepare \a sub to execute the sub-request \a msg of the batched request
+ * \a req.  The sub-request borrows the export, service thread, security
+ * context and credentials of \a req, which must outlive it, and never goes
+ * through the request queues or the network on its own.
+ *
+ * \a len is the number of bytes left in the batched request buffer, on
+ * success it is set to the packed size of \a msg.
+ */
+int ptlrpc_batch_subreq_init(struct ptlrpc_request *req,
+			     struct ptlrpc_request *sub,
+			     struct lustre_msg *msg, int *len)
+{
+	int rc;
+
+	ENTRY;
+
+	memset(sub, 0, sizeof(*sub));
+	ptlrpc_srv_req_init(sub);
+	req_capsule_init(&sub->rq_pill, sub, RCL_SERVER);
+
+	sub->rq_type = PTL_RPC_MSG_REQUEST;
+	sub->rq_export = req->rq_export;
+	sub->rq_svc_thread = req->rq_svc_thread;
+	sub->rq_rqbd = req->rq_rqbd;
+	sub->rq_svc_ctx = req->rq_svc_ctx;
+	sub->rq_flvr = req->rq_flvr;
+	sub->rq_sp_from = req->rq_sp_from;
+	sub->rq_auth_gss = req->rq_auth_gss;
+	sub->rq_auth_usr_root = req->rq_auth_usr_root;
+	sub->rq_auth_usr_mdt = req->rq_auth_usr_mdt;
+	sub->rq_auth_usr_ost = req->rq_auth_usr_ost;
+	sub->rq_auth_uid = req->rq_auth_uid;
+	sub->rq_auth_mapped_uid = req->rq_auth_mapped_uid;
+	sub->rq_user_desc = req->rq_user_desc;
+	sub->rq_peer = req->rq_peer;
+	sub->rq_self = req->rq_self;
+	sub->rq_xid = req->rq_xid;
+	sub->rq_arrival_time = req->rq_arrival_time;
+	sub->rq_deadline = req->rq_deadline;
+
+	sub->rq_reqmsg = msg;
+	rc = ptlrpc_unpack_req_msg(sub, *len);
+	if (rc) {
+		DEBUG_REQ(D_ERROR, req, "bad batched sub-request: rc = %d", rc);
+		RETURN(-EPROTO);
+	}
+
+	*len = lustre_packed_msg_size(msg);
+	sub->rq_reqlen = *len;
+	sub->rq_reqdata_len = *len;
+	rc = lustre_unpack_req_ptlrpc_body(sub, MSG_PTLRPC_BODY_OFF);
+	if (rc)
+		RETURN(-EPROTO);
+
+	/* the whole batch is resent, so is every sub-request in it */
+	if (lustre_msg_get_flags(req->rq_reqmsg) & MSG_RESENT)
+		lustre_msg_add_flags(msg, MSG_RESENT);
+
+	RETURN(0);
+}
+EXPORT_SYMBOL(ptlrpc_batch_subreq_init);
+
+/**
+ * Finish the sub-request \a sub of a batched request: copy its reply, with
+ * the status from \a sub->rq_status, to \a buf and release its reply state.
+ * If the handler did not pack a reply, an error reply is generated.
+ *
+ * \retval	size of the sub-reply copied to \a buf
+ * \retval	negative errno if the sub-reply did not fit into \a size bytes
+ */
+int ptlrpc_batch_subreq_fini(struct ptlrpc_request *sub, void *buf, int size)
+{
+	struct lustre_msg *repmsg;
+	int len;
+
+	ENTRY;
+
+	if (sub->rq_reply_state == NULL) {
+		int rc = lustre_pack_reply(sub, 1, NULL, NULL);
+
+		if (rc)
+			RETURN(rc);
+		sub->rq_type = PTL_RPC_MSG_ERR;
+	} else {
+		sub->rq_type = PTL_RPC_MSG_REPLY;
+	}
+
+	repmsg = sub->rq_repmsg;
+	lustre_msg_set_type(repmsg, sub->rq_type);
+	lustre_msg_set_status(repmsg, ptlrpc_status_hton(sub->rq_status));
+	lustre_msg_set_opc(repmsg, lustre_msg_get_opc(sub->rq_reqmsg));
+
+	len = lustre_packed_msg_size(repmsg);
+	if (len <= size)
+		memcpy(buf, repmsg, len);
+	else
+		len = -EOVERFLOW;
+
+	ptlrpc_req_drop_rs(sub);
+	sub->rq_svc_ctx = NULL;
+
+	RETURN(len);
+}
+EXPORT_SYMBOL(ptlrpc_batch_subreq_fini);
+
 /**
  * to finish a request: stop sending more early replies, and release
  * the request.
@@ -1089,12 +1271,23 @@ static void ptlrpc_server_finish_active_request(
 					struct ptlrpc_service_part *svcpt,
 					struct ptlrpc_request *req)
 {
-	spin_lock(&svcpt->scp_req_lock);
+	struct ptlrpc_service_part *owner = req->rq_rqbd->rqbd_svcpt;
+
+	spin_lock(&owner->scp_req_lock);
 	ptlrpc_nrs_req_stop_nolock(req);
-	svcpt->scp_nreqs_active--;
-	if (req->rq_hp)
-		svcpt->scp_nhreqs_active--;
-	spin_unlock(&svcpt->scp_req_lock);
+	if (owner == svcpt) {
+		svcpt->scp_nreqs_active--;
+		if (req->rq_hp)
+			svcpt->scp_nhreqs_active--;
+	}
+	spin_unlock(&owner->scp_req_lock);
+
+	/* a stolen request is accounted to the partition which handled it */
+	if (owner != svcpt) {
+		spin_lock(&svcpt->scp_req_lock);
+		svcpt->scp_nreqs_active--;
+		spin_unlock(&svcpt->scp_req_lock);
+	}
 
 	ptlrpc_nrs_req_finalize(req);
 
@@ -1953,6 +2146,12 @@ static bool ptlrpc_server_allow_normal(struct ptlrpc_service_part *svcpt,
 	if (force)
 		return true;
 
+	/* one normal ost_io request at a time, to make them queue in NRS */
+	if (unlikely(svcpt->scp_service->srv_req_portal == OST_IO_PORTAL &&
+		     CFS_FAIL_PRECHECK(OBD_FAIL_PTLRPC_OST_IO_SERIAL)) &&
+	    svcpt->scp_nreqs_active > svcpt->scp_nhreqs_active)
+		return false;
+
 	if (ptlrpc_nrs_req_throttling_nolock(svcpt, false))
 		return false;
 
@@ -2026,6 +2225,16 @@ got_request:
 	if (req->rq_hp)
 		svcpt->scp_nhreqs_active++;
 
+	if (svcpt->scp_service->srv_thrctl_enabled) {
+		s64 wait = ktime_us_delta(ktime_get_real(),
+				timespec64_to_ktime(req->rq_arrival_time));
+
+		svcpt->scp_thrctl_wait_sum += max_t(s64, wait, 0);
+		svcpt->scp_thrctl_nreqs++;
+		if (svcpt->scp_nreqs_active > svcpt->scp_thrctl_active_max)
+			svcpt->scp_thrctl_active_max = svcpt->scp_nreqs_active;
+	}
+
 	spin_unlock(&svcpt->scp_req_lock);
 
 	if (likely(req->rq_export))
@@ -2034,6 +2243,121 @@ got_request:
 	RETURN(req);
 }
 
+/**
+ * Work stealing between partitions.
+ *
+ * A partition whose threads are all busy while regular requests are queued
+ * wakes up an idle thread of the nearest partition having some, which takes
+ * the next request in the NRS order of the overloaded partition. High
+ * priority requests are never stolen, and a partition only lends threads
+ * while it keeps enough idle ones for its own high priority requests.
+ */
+
+/* \a svcpt cannot start its queued regular requests on its own threads */
+static bool ptlrpc_server_steal_pending(struct ptlrpc_service_part *svcpt)
+{
+	return svcpt->scp_nreqs_active >= svcpt->scp_nthrs_running - 1 &&
+	       !ptlrpc_nrs_req_throttling_nolock(svcpt, false) &&
+	       ptlrpc_nrs_req_pending_nolock(svcpt, false);
+}
+
+/* \a svcpt may lend a thread to other partitions */
+static bool ptlrpc_server_steal_spare(struct ptlrpc_service_part *svcpt)
+{
+	return svcpt->scp_nreqs_active < svcpt->scp_nthrs_running - 2;
+}
+
+static bool ptlrpc_server_steal_wanted(struct ptlrpc_service_part *svcpt)
+{
+	struct ptlrpc_service *svc = svcpt->scp_service;
+	int i;
+
+	if (svcpt->scp_steal_order == NULL ||
+	    !READ_ONCE(svc->srv_steal_enabled) ||
+	    !ptlrpc_server_steal_spare(svcpt))
+		return false;
+
+	for (i = 0; i < svc->srv_ncpts - 1; i++) {
+		if (ptlrpc_server_steal_pending(
+				svc->srv_parts[svcpt->scp_steal_order[i]]))
+			return true;
+	}
+	return false;
+}
+
+/* wake up an idle thread near \a svcpt if it cannot keep up */
+static void ptlrpc_server_steal_kick(struct ptlrpc_service_part *svcpt)
+{
+	struct ptlrpc_service *svc = svcpt->scp_service;
+	struct ptlrpc_service_part *sibling;
+	int i;
+
+	if (svcpt->scp_steal_order == NULL ||
+	    !READ_ONCE(svc->srv_steal_enabled) ||
+	    !ptlrpc_server_steal_pending(svcpt))
+		return;
+
+	for (i = 0; i < svc->srv_ncpts - 1; i++) {
+		sibling = svc->srv_parts[svcpt->scp_steal_order[i]];
+		if (ptlrpc_server_steal_spare(sibling) &&
+		    !ptlrpc_server_request_pending(sibling, false)) {
+			wake_up(&sibling->scp_waitq);
+			break;
+		}
+	}
+}
+
+/**
+ * Fetch a regular request queued on another partition for a thread of
+ * \a svcpt, nearest partitions first. The request is accounted as active on
+ * \a svcpt.
+ */
+static struct ptlrpc_request *
+ptlrpc_server_request_steal(struct ptlrpc_service_part *svcpt)
+{
+	struct ptlrpc_service *svc = svcpt->scp_service;
+	struct ptlrpc_service_part *victim;
+	struct ptlrpc_request *req = NULL;
+	int i;
+
+	ENTRY;
+
+	/* reserve this thread first so that partitions cannot lend it twice */
+	spin_lock(&svcpt->scp_req_lock);
+	if (!ptlrpc_server_steal_spare(svcpt)) {
+		spin_unlock(&svcpt->scp_req_lock);
+		RETURN(NULL);
+	}
+	svcpt->scp_nreqs_active++;
+	spin_unlock(&svcpt->scp_req_lock);
+
+	for (i = 0; i < svc->srv_ncpts - 1 && req == NULL; i++) {
+		victim = svc->srv_parts[svcpt->scp_steal_order[i]];
+		if (!ptlrpc_server_steal_pending(victim))
+			continue;
+
+		spin_lock(&victim->scp_req_lock);
+		if (ptlrpc_server_steal_pending(victim)) {
+			req = ptlrpc_nrs_req_get_nolock(victim, false, false);
+			if (req != NULL)
+				victim->scp_nreqs_stolen++;
+		}
+		spin_unlock(&victim->scp_req_lock);
+	}
+
+	spin_lock(&svcpt->scp_req_lock);
+	if (req != NULL)
+		svcpt->scp_nreqs_steals++;
+	else
+		svcpt->scp_nreqs_active--;
+	spin_unlock(&svcpt->scp_req_lock);
+
+	if (req != NULL && likely(req->rq_export))
+		class_export_rpc_inc(req->rq_export);
+
+	RETURN(req);
+}
+
 /**
  * Handle freshly incoming reqs, add to timed early reply list,
  * pass on to regular request queue.
@@ -2210,6 +2534,7 @@ static int ptlrpc_server_handle_req_in(struct ptlrpc_service_part *svcpt,
 		GOTO(err_req, rc);
 
 	wake_up(&svcpt->scp_waitq);
+	ptlrpc_server_steal_kick(svcpt);
 	RETURN(1);
 
 err_req:
@@ -2223,7 +2548,8 @@ err_req:
  * Calls handler function from service to do actual processing.
  */
 static int ptlrpc_server_handle_request(struct ptlrpc_service_part *svcpt,
-					struct ptlrpc_thread *thread)
+					struct ptlrpc_thread *thread,
+					bool steal)
 {
 	struct ptlrpc_service *svc = svcpt->scp_service;
 	struct ptlrpc_request *request;
@@ -2236,7 +2562,10 @@ static int ptlrpc_server_handle_request(struct ptlrpc_service_part *svcpt,
 
 	ENTRY;
 
-	request = ptlrpc_server_request_get(svcpt, false);
+	if (steal)
+		request = ptlrpc_server_request_steal(svcpt);
+	else
+		request = ptlrpc_server_request_get(svcpt, false);
 	if (request == NULL)
 		RETURN(0);
 
@@ -2351,6 +2680,9 @@ put_conn:
 	       request->rq_status,
 	       (request->rq_repmsg ?
 	       lustre_msg_get_status(request->rq_repmsg) : -999));
+	if (likely(svc->srv_stats != NULL))
+		lprocfs_counter_add(svc->srv_stats, PTLRPC_REQSERVICE_CNTR,
+				    timediff_usecs);
 	if (likely(svc->srv_stats != NULL && request->rq_reqmsg != NULL)) {
 		__u32 op = lustre_msg_get_opc(request->rq_reqmsg);
 		int opc = opcode_offset(op);
@@ -2520,6 +2852,11 @@ static int ptlrpc_handle_rs(struct ptlrpc_reply_state *rs)
 
 		class_export_put(exp);
 		rs->rs_export = NULL;
+		if (rs->rs_commit_time != 0 && svc->srv_stats != NULL)
+			lprocfs_counter_add(svc->srv_stats,
+					    PTLRPC_REPCOMMIT_CNTR,
+					    ktime_us_delta(ktime_get(),
+							   rs->rs_commit_time));
 		ptlrpc_rs_decref(rs);
 		if (atomic_dec_and_test(&svcpt->scp_nreps_difficult) &&
 		    svc->srv_is_stopping)
@@ -2564,6 +2901,17 @@ static inline int ptlrpc_threads_enough(struct ptlrpc_service_part *svcpt)
 	       (svcpt->scp_service->srv_ops.so_hpreq_handler != NULL);
 }
 
+/**
+ * most threads allowed to run, lowered by the adaptive controller
+ */
+static inline int ptlrpc_threads_ceiling(struct ptlrpc_service_part *svcpt)
+{
+	int limit = svcpt->scp_service->srv_nthrs_cpt_limit;
+	int target = READ_ONCE(svcpt->scp_nthrs_target);
+
+	return target > 0 ? min(target, limit) : limit;
+}
+
 /**
  * allowed to create more threads
  * user can call it w/o any lock but need to hold
@@ -2573,7 +2921,7 @@ static inline int ptlrpc_threads_increasable(struct ptlrpc_service_part *svcpt)
 {
 	return svcpt->scp_nthrs_running +
 	       svcpt->scp_nthrs_starting <
-	       svcpt->scp_service->srv_nthrs_cpt_limit;
+	       ptlrpc_threads_ceiling(svcpt);
 }
 
 /**
@@ -2596,7 +2944,7 @@ static inline bool ptlrpc_thread_should_stop(struct ptlrpc_thread *thread)
 {
 	struct ptlrpc_service_part *svcpt = thread->t_svcpt;
 
-	return thread->t_id >= svcpt->scp_service->srv_nthrs_cpt_limit &&
+	return thread->t_id >= ptlrpc_threads_ceiling(svcpt) &&
 		thread->t_id == svcpt->scp_thr_nextid - 1;
 }
 
@@ -2619,6 +2967,188 @@ static inline void ptlrpc_thread_stop(struct ptlrpc_thread *thread)
 	spin_unlock(&svcpt->scp_lock);
 }
 
+/* CPU busy percentage of the partition since the last call, -1 if unknown */
+static int ptlrpc_thrctl_cpu_busy(struct ptlrpc_service_part *svcpt)
+{
+	struct ptlrpc_thrctl *tcl = &svcpt->scp_thrctl;
+	cpumask_var_t *mask;
+	u64 cpu_idle;
+	u64 cpu_wall;
+	u64 idle = 0;
+	u64 wall = 0;
+	int busy = -1;
+	int cpu;
+
+	mask = cfs_cpt_cpumask(svcpt->scp_service->srv_cptable,
+			       svcpt->scp_cpt);
+	for_each_cpu_and(cpu, *mask, cpu_online_mask) {
+		cpu_idle = get_cpu_idle_time_us(cpu, &cpu_wall);
+		/* idle time is only accounted with NO_HZ */
+		if (cpu_idle == -1ULL)
+			return -1;
+		idle += cpu_idle;
+		wall += cpu_wall;
+
+		cpu_idle = get_cpu_iowait_time_us(cpu, NULL);
+		if (cpu_idle != -1ULL)
+			idle += cpu_idle;
+	}
+
+	/* CPUs going offline make the sums go backward, skip a sample */
+	if (tcl->tcl_cpu_wall != 0 && wall > tcl->tcl_cpu_wall &&
+	    idle >= tcl->tcl_cpu_idle) {
+		u64 dwall = wall - tcl->tcl_cpu_wall;
+		u64 didle = idle - tcl->tcl_cpu_idle;
+
+		busy = didle >= dwall ? 0 : div64_u64((dwall - didle) * 100,
+						      dwall);
+	}
+	tcl->tcl_cpu_idle = idle;
+	tcl->tcl_cpu_wall = wall;
+
+	return busy;
+}
+
+/**
+ * Adaptive sizing of service thread pools.
+ *
+ * Every PTLRPC_THRCTL_INTERVAL seconds the number of threads wanted on each
+ * partition is raised when requests waited in the queue for longer than
+ * ptlrpc_service::srv_thrctl_wait_us, unless the CPUs of the partition are
+ * already saturated, and lowered after PTLRPC_THRCTL_QUIET intervals of short
+ * waits with more than PTLRPC_THRCTL_SPARE idle threads. The pool grows fast
+ * and shrinks slowly, between threads_min and threads_max; threads are still
+ * started on demand, up to the wanted number.
+ */
+static void ptlrpc_thrctl_part(struct ptlrpc_service_part *svcpt)
+{
+	struct ptlrpc_service *svc = svcpt->scp_service;
+	struct ptlrpc_thrctl *tcl = &svcpt->scp_thrctl;
+	struct ptlrpc_thread *thread;
+	struct ptlrpc_thread *last;
+	bool enabled = READ_ONCE(svc->srv_thrctl_enabled);
+	bool pending;
+	__u64 wait_sum;
+	__u32 nreqs;
+	int active;
+	int target;
+	int limit;
+	int init;
+	int busy;
+	int idle;
+
+	spin_lock(&svcpt->scp_req_lock);
+	wait_sum = svcpt->scp_thrctl_wait_sum;
+	nreqs = svcpt->scp_thrctl_nreqs;
+	active = svcpt->scp_thrctl_active_max;
+	svcpt->scp_thrctl_wait_sum = 0;
+	svcpt->scp_thrctl_nreqs = 0;
+	svcpt->scp_thrctl_active_max = svcpt->scp_nreqs_active;
+	pending = ptlrpc_server_request_pending(svcpt, false);
+	spin_unlock(&svcpt->scp_req_lock);
+
+	if (!enabled) {
+		spin_lock(&svcpt->scp_lock);
+		svcpt->scp_nthrs_target = 0;
+		tcl->tcl_decision = PTLRPC_THRCTL_OFF;
+		tcl->tcl_quiet = 0;
+		tcl->tcl_cpu_wall = 0;
+		spin_unlock(&svcpt->scp_lock);
+		return;
+	}
+
+	busy = ptlrpc_thrctl_cpu_busy(svcpt);
+
+	spin_lock(&svcpt->scp_lock);
+	init = svc->srv_nthrs_cpt_init;
+	limit = svc->srv_nthrs_cpt_limit;
+	target = svcpt->scp_nthrs_target ?: svcpt->scp_nthrs_running;
+	target = clamp(target, init, limit);
+	idle = svcpt->scp_nthrs_running - active;
+
+	tcl->tcl_wait_us = nreqs != 0 ? div_u64(wait_sum, nreqs) : 0;
+	tcl->tcl_cpu_busy = busy;
+	tcl->tcl_active = active;
+	tcl->tcl_decision = PTLRPC_THRCTL_HOLD;
+
+	/* nothing was started while requests are queued: all threads stuck */
+	if (tcl->tcl_wait_us > svc->srv_thrctl_wait_us ||
+	    (nreqs == 0 && pending)) {
+		tcl->tcl_quiet = 0;
+		if (busy >= PTLRPC_THRCTL_CPU_BUSY) {
+			/* more threads would only contend for the same CPUs */
+			tcl->tcl_decision = PTLRPC_THRCTL_CPU_BUSY;
+		} else if (target < limit) {
+			target = min(limit, target + max(1, target / 4));
+			tcl->tcl_decision = PTLRPC_THRCTL_GROW;
+			tcl->tcl_grown++;
+		}
+	} else if (tcl->tcl_wait_us < svc->srv_thrctl_wait_us / 4 &&
+		   idle > PTLRPC_THRCTL_SPARE && target > init) {
+		if (++tcl->tcl_quiet >= PTLRPC_THRCTL_QUIET) {
+			target = min(target, svcpt->scp_nthrs_running);
+			target = max(init, target -
+				     max(1, (idle - PTLRPC_THRCTL_SPARE) / 4));
+			tcl->tcl_decision = PTLRPC_THRCTL_SHRINK;
+			tcl->tcl_shrunk++;
+		}
+	} else {
+		tcl->tcl_quiet = 0;
+	}
+	svcpt->scp_nthrs_target = target;
+
+	/*
+	 * Stop the highest numbered threads first so that thread index values
+	 * stay contiguous, waking them up as they may sleep until the next
+	 * request otherwise.
+	 */
+	while (svcpt->scp_nthrs_starting == 0 &&
+	       svcpt->scp_thr_nextid > target) {
+		last = NULL;
+		list_for_each_entry(thread, &svcpt->scp_threads, t_link) {
+			if (thread->t_id == svcpt->scp_thr_nextid - 1 &&
+			    thread_is_running(thread) &&
+			    !thread_is_stopping(thread)) {
+				last = thread;
+				break;
+			}
+		}
+		if (last == NULL)
+			break;
+
+		ptlrpc_stop_thread(last);
+		svcpt->scp_thr_nextid--;
+		wake_up_process(last->t_task);
+	}
+	spin_unlock(&svcpt->scp_lock);
+
+	CDEBUG(D_RPCTRACE,
+	       "%s[%d]: wait %llu us, cpu %d%%, active %d/%d, target %d\n",
+	       svc->srv_name, svcpt->scp_cpt, tcl->tcl_wait_us, busy, active,
+	       svcpt->scp_nthrs_running, target);
+
+	if (tcl->tcl_decision == PTLRPC_THRCTL_GROW &&
+	    ptlrpc_threads_need_create(svcpt))
+		ptlrpc_start_thread(svcpt, 0);
+}
+
+static void ptlrpc_thrctl_work(struct work_struct *work)
+{
+	struct ptlrpc_service *svc = container_of(work, struct ptlrpc_service,
+						  srv_thrctl_work.work);
+	struct ptlrpc_service_part *svcpt;
+	int i;
+
+	if (svc->srv_is_stopping)
+		return;
+
+	ptlrpc_service_for_each_part(svcpt, i, svc)
+		ptlrpc_thrctl_part(svcpt);
+
+	schedule_delayed_work(&svc->srv_thrctl_work,
+			      cfs_time_seconds(PTLRPC_THRCTL_INTERVAL));
+}
+
 static inline int ptlrpc_rqbd_pending(struct ptlrpc_service_part *svcpt)
 {
 	return !list_empty(&svcpt->scp_rqbd_idle) &&
@@ -2711,6 +3241,7 @@ ptlrpc_wait_event(struct ptlrpc_service_part *svcpt,
 			ptlrpc_thread_stopping(thread) ||
 			ptlrpc_server_request_incoming(svcpt) ||
 			ptlrpc_server_request_pending(svcpt, false) ||
+			ptlrpc_server_steal_wanted(svcpt) ||
 			ptlrpc_rqbd_pending(svcpt) ||
 			ptlrpc_at_check(svcpt));
 	else if (wait_event_idle_exclusive_lifo_timeout(
@@ -2718,6 +3249,7 @@ ptlrpc_wait_event(struct ptlrpc_service_part *svcpt,
 			 ptlrpc_thread_stopping(thread) ||
 			 ptlrpc_server_request_incoming(svcpt) ||
 			 ptlrpc_server_request_pending(svcpt, false) ||
+			 ptlrpc_server_steal_wanted(svcpt) ||
 			 ptlrpc_rqbd_pending(svcpt) ||
 			 ptlrpc_at_check(svcpt),
 			 svcpt->scp_rqbd_timeout) == 0)
@@ -2745,6 +3277,7 @@ static int ptlrpc_main(void *arg)
 	struct ptlrpc_reply_state *rs;
 	struct group_info *ginfo = NULL;
 	struct lu_env *env;
+	bool reap = false;
 	int counter = 0, rc = 0;
 
 	ENTRY;
@@ -2871,7 +3404,11 @@ static int ptlrpc_main(void *arg)
 
 		if (ptlrpc_server_request_pending(svcpt, false)) {
 			lu_context_enter(&env->le_ctx);
-			ptlrpc_server_handle_request(svcpt, thread);
+			ptlrpc_server_handle_request(svcpt, thread, false);
+			lu_context_exit(&env->le_ctx);
+		} else if (ptlrpc_server_steal_wanted(svcpt)) {
+			lu_context_enter(&env->le_ctx);
+			ptlrpc_server_handle_request(svcpt, thread, true);
 			lu_context_exit(&env->le_ctx);
 		}
 
@@ -2922,24 +3459,48 @@ out:
 	thread->t_id = rc;
 	thread_add_flags(thread, SVC_STOPPED);
 
+	/*
+	 * Nobody waits for a thread stopped while the service is running,
+	 * i.e. by the adaptive controller or a lower threads_max, free it
+	 * now rather than keeping it until the service is stopped.
+	 */
+	if (rc == 0 && !svc->srv_is_stopping) {
+		list_del(&thread->t_link);
+		reap = true;
+	}
+
 	wake_up(&thread->t_ctl_waitq);
 	spin_unlock(&svcpt->scp_lock);
 
+	if (reap)
+		OBD_FREE_PTR(thread);
+
 	return rc;
 }
 
 static int hrt_dont_sleep(struct ptlrpc_hr_thread *hrt,
-			  struct list_head *replies)
+			  struct llist_node **replies)
 {
-	int result;
-
-	spin_lock(&hrt->hrt_lock);
-
-	list_splice_init(&hrt->hrt_queue, replies);
-	result = ptlrpc_hr.hr_stopping || !list_empty(replies);
+	*replies = llist_del_all(&hrt->hrt_queue);
+	return ptlrpc_hr.hr_stopping || *replies != NULL;
+}
 
-	spin_unlock(&hrt->hrt_lock);
-	return result;
+/**
+ * Reverse the replies taken from the queue of a reply handling thread, so
+ * that they are handled in the order they were dispatched.
+ */
+static struct llist_node *hrt_replies_reverse(struct llist_node *node)
+{
+	struct llist_node *reversed = NULL;
+	struct llist_node *next;
+
+	while (node != NULL) {
+		next = node->next;
+		node->next = reversed;
+		reversed = node;
+		node = next;
+	}
+	return reversed;
 }
 
 /**
@@ -2950,7 +3511,7 @@ static int ptlrpc_hr_main(void *arg)
 {
 	struct ptlrpc_hr_thread *hrt = (struct ptlrpc_hr_thread *)arg;
 	struct ptlrpc_hr_partition *hrp = hrt->hrt_partition;
-	LIST_HEAD(replies);
+	struct llist_node *replies;
 	struct lu_env *env;
 	int rc;
 
@@ -2983,13 +3544,14 @@ static int ptlrpc_hr_main(void *arg)
 	while (!ptlrpc_hr.hr_stopping) {
 		wait_event_idle(hrt->hrt_waitq, hrt_dont_sleep(hrt, &replies));
 
-		while (!list_empty(&replies)) {
+		replies = hrt_replies_reverse(replies);
+		while (replies != NULL) {
 			struct ptlrpc_reply_state *rs;
 
-			rs = list_entry(replies.prev,
-					struct ptlrpc_reply_state,
-					rs_list);
-			list_del_init(&rs->rs_list);
+			rs = llist_entry(replies, struct ptlrpc_reply_state,
+					 rs_hr_node);
+			/* rs can be dispatched again or freed once handled */
+			replies = replies->next;
 			/* refill keys if needed */
 			lu_env_refill(env);
 			lu_context_enter(&env->le_ctx);
@@ -3164,6 +3726,8 @@ static int ptlrpc_start_threads(struct ptlrpc_service *svc)
  failed:
 	CERROR("cannot start %s thread #%d_%d: rc %d\n",
 	       svc->srv_thread_name, i, j, rc);
+	/* threads must not free themselves while being waited for */
+	svc->srv_is_stopping = 1;
 	ptlrpc_stop_all_threads(svc);
 	RETURN(rc);
 }
@@ -3326,8 +3890,7 @@ int ptlrpc_hr_init(void)
 			hrt->hrt_id = i;
 			hrt->hrt_partition = hrp;
 			init_waitqueue_head(&hrt->hrt_waitq);
-			spin_lock_init(&hrt->hrt_lock);
-			INIT_LIST_HEAD(&hrt->hrt_queue);
+			init_llist_head(&hrt->hrt_queue);
 		}
 	}
 
@@ -3565,6 +4128,13 @@ ptlrpc_service_free(struct ptlrpc_service *svc)
 					   array->paa_size);
 			array->paa_reqs_count = NULL;
 		}
+
+		if (svcpt->scp_steal_order != NULL) {
+			OBD_FREE(svcpt->scp_steal_order,
+				 (svc->srv_ncpts - 1) *
+				 sizeof(*svcpt->scp_steal_order));
+			svcpt->scp_steal_order = NULL;
+		}
 	}
 
 	ptlrpc_service_for_each_part(svcpt, i, svc)
@@ -3590,6 +4160,7 @@ int ptlrpc_unregister_service(struct ptlrpc_service *service)
 	mutex_unlock(&ptlrpc_all_services_mutex);
 
 	ptlrpc_service_del_atimer(service);
+	cancel_delayed_work_sync(&service->srv_thrctl_work);
 	ptlrpc_stop_all_threads(service);
 
 	ptlrpc_service_unlink_rqbd(service);
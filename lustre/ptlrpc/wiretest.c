@@ -181,7 +181,13 @@ void lustre_assert_wire_constants(void)
 		 (long long)MDS_SWAP_LAYOUTS);
 	LASSERTF(MDS_RMFID == 62, "found %lld\n",
 		 (long long)MDS_RMFID);
-	LASSERTF(MDS_LAST_OPC == 63, "found %lld\n",
+	LASSERTF(MDS_BATCH == 63, "found %lld\n",
+		 (long long)MDS_BATCH);
+	LASSERTF(MDS_HSM_DATA_VERSION == 64, "found %lld\n",
+		 (long long)MDS_HSM_DATA_VERSION);
+	LASSERTF(MDS_MSG_BATCH == 65, "found %lld\n",
+		 (long long)MDS_MSG_BATCH);
+	LASSERTF(MDS_LAST_OPC == 64, "found %lld\n",
 		 (long long)MDS_LAST_OPC);
 	LASSERTF(REINT_SETATTR == 1, "found %lld\n",
 		 (long long)REINT_SETATTR);
@@ -666,6 +672,10 @@ void lustre_assert_wire_constants(void)
 		(unsigned)LUDA_TYPE);
 	LASSERTF(LUDA_64BITHASH == 0x00000004UL, "found 0x%.8xUL\n",
 		(unsigned)LUDA_64BITHASH);
+	LASSERTF(LUDA_ATTRS == 0x00000008UL, "found 0x%.8xUL\n",
+		(unsigned)LUDA_ATTRS);
+	LASSERTF(LUDA_LAYOUT == 0x00000010UL, "found 0x%.8xUL\n",
+		(unsigned)LUDA_LAYOUT);
 
 	/* Checks for struct luda_type */
 	LASSERTF((int)sizeof(struct luda_type) == 2, "found %lld\n",
@@ -675,6 +685,66 @@ void lustre_assert_wire_constants(void)
 	LASSERTF((int)sizeof(((struct luda_type *)0)->lt_type) == 2, "found %lld\n",
 		 (long long)(int)sizeof(((struct luda_type *)0)->lt_type));
 
+	/* Checks for struct luda_attrs */
+	LASSERTF((int)sizeof(struct luda_attrs) == 80, "found %lld\n",
+		 (long long)(int)sizeof(struct luda_attrs));
+	LASSERTF((int)offsetof(struct luda_attrs, lda_valid) == 0, "found %lld\n",
+		 (long long)(int)offsetof(struct luda_attrs, lda_valid));
+	LASSERTF((int)sizeof(((struct luda_attrs *)0)->lda_valid) == 8, "found %lld\n",
+		 (long long)(int)sizeof(((struct luda_attrs *)0)->lda_valid));
+	LASSERTF((int)offsetof(struct luda_attrs, lda_size) == 8, "found %lld\n",
+		 (long long)(int)offsetof(struct luda_attrs, lda_size));
+	LASSERTF((int)sizeof(((struct luda_attrs *)0)->lda_size) == 8, "found %lld\n",
+		 (long long)(int)sizeof(((struct luda_attrs *)0)->lda_size));
+	LASSERTF((int)offsetof(struct luda_attrs, lda_blocks) == 16, "found %lld\n",
+		 (long long)(int)offsetof(struct luda_attrs, lda_blocks));
+	LASSERTF((int)sizeof(((struct luda_attrs *)0)->lda_blocks) == 8, "found %lld\n",
+		 (long long)(int)sizeof(((struct luda_attrs *)0)->lda_blocks));
+	LASSERTF((int)offsetof(struct luda_attrs, lda_atime) == 24, "found %lld\n",
+		 (long long)(int)offsetof(struct luda_attrs, lda_atime));
+	LASSERTF((int)sizeof(((struct luda_attrs *)0)->lda_atime) == 8, "found %lld\n",
+		 (long long)(int)sizeof(((struct luda_attrs *)0)->lda_atime));
+	LASSERTF((int)offsetof(struct luda_attrs, lda_mtime) == 32, "found %lld\n",
+		 (long long)(int)offsetof(struct luda_attrs, lda_mtime));
+	LASSERTF((int)sizeof(((struct luda_attrs *)0)->lda_mtime) == 8, "found %lld\n",
+		 (long long)(int)sizeof(((struct luda_attrs *)0)->lda_mtime));
+	LASSERTF((int)offsetof(struct luda_attrs, lda_ctime) == 40, "found %lld\n",
+		 (long long)(int)offsetof(struct luda_attrs, lda_ctime));
+	LASSERTF((int)sizeof(((struct luda_attrs *)0)->lda_ctime) == 8, "found %lld\n",
+		 (long long)(int)sizeof(((struct luda_attrs *)0)->lda_ctime));
+	LASSERTF((int)offsetof(struct luda_attrs, lda_mode) == 48, "found %lld\n",
+		 (long long)(int)offsetof(struct luda_attrs, lda_mode));
+	LASSERTF((int)sizeof(((struct luda_attrs *)0)->lda_mode) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct luda_attrs *)0)->lda_mode));
+	LASSERTF((int)offsetof(struct luda_attrs, lda_uid) == 52, "found %lld\n",
+		 (long long)(int)offsetof(struct luda_attrs, lda_uid));
+	LASSERTF((int)sizeof(((struct luda_attrs *)0)->lda_uid) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct luda_attrs *)0)->lda_uid));
+	LASSERTF((int)offsetof(struct luda_attrs, lda_gid) == 56, "found %lld\n",
+		 (long long)(int)offsetof(struct luda_attrs, lda_gid));
+	LASSERTF((int)sizeof(((struct luda_attrs *)0)->lda_gid) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct luda_attrs *)0)->lda_gid));
+	LASSERTF((int)offsetof(struct luda_attrs, lda_nlink) == 60, "found %lld\n",
+		 (long long)(int)offsetof(struct luda_attrs, lda_nlink));
+	LASSERTF((int)sizeof(((struct luda_attrs *)0)->lda_nlink) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct luda_attrs *)0)->lda_nlink));
+	LASSERTF((int)offsetof(struct luda_attrs, lda_flags) == 64, "found %lld\n",
+		 (long long)(int)offsetof(struct luda_attrs, lda_flags));
+	LASSERTF((int)sizeof(((struct luda_attrs *)0)->lda_flags) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct luda_attrs *)0)->lda_flags));
+	LASSERTF((int)offsetof(struct luda_attrs, lda_projid) == 68, "found %lld\n",
+		 (long long)(int)offsetof(struct luda_attrs, lda_projid));
+	LASSERTF((int)sizeof(((struct luda_attrs *)0)->lda_projid) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct luda_attrs *)0)->lda_projid));
+	LASSERTF((int)offsetof(struct luda_attrs, lda_lmm_size) == 72, "found %lld\n",
+		 (long long)(int)offsetof(struct luda_attrs, lda_lmm_size));
+	LASSERTF((int)sizeof(((struct luda_attrs *)0)->lda_lmm_size) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct luda_attrs *)0)->lda_lmm_size));
+	LASSERTF((int)offsetof(struct luda_attrs, lda_padding) == 76, "found %lld\n",
+		 (long long)(int)offsetof(struct luda_attrs, lda_padding));
+	LASSERTF((int)sizeof(((struct luda_attrs *)0)->lda_padding) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct luda_attrs *)0)->lda_padding));
+
 	/* Checks for struct lu_dirpage */
 	LASSERTF((int)sizeof(struct lu_dirpage) == 24, "found %lld\n",
 		 (long long)(int)sizeof(struct lu_dirpage));
@@ -1400,6 +1470,12 @@ void lustre_assert_wire_constants(void)
 		 OBD_CONNECT2_PCCRO);
 	LASSERTF(OBD_CONNECT2_ATOMIC_OPEN_LOCK == 0x4000000ULL, "found 0x%.16llxULL\n",
 		 OBD_CONNECT2_ATOMIC_OPEN_LOCK);
+	LASSERTF(OBD_CONNECT2_WIRE_COMPRESS == 0x800000000ULL, "found 0x%.16llxULL\n",
+		 OBD_CONNECT2_WIRE_COMPRESS);
+	LASSERTF(OBD_CONNECT2_READDIR_PLUS == 0x1000000000ULL, "found 0x%.16llxULL\n",
+		 OBD_CONNECT2_READDIR_PLUS);
+	LASSERTF(OBD_CONNECT2_MSG_BATCH == 0x2000000000ULL, "found 0x%.16llxULL\n",
+		 OBD_CONNECT2_MSG_BATCH);
 	LASSERTF(OBD_CKSUM_CRC32 == 0x00000001UL, "found 0x%.8xUL\n",
 		(unsigned)OBD_CKSUM_CRC32);
 	LASSERTF(OBD_CKSUM_ADLER == 0x00000002UL, "found 0x%.8xUL\n",
@@ -1554,10 +1630,10 @@ void lustre_assert_wire_constants(void)
 		 (long long)(int)offsetof(struct obdo, o_projid));
 	LASSERTF((int)sizeof(((struct obdo *)0)->o_projid) == 4, "found %lld\n",
 		 (long long)(int)sizeof(((struct obdo *)0)->o_projid));
-	LASSERTF((int)offsetof(struct obdo, o_padding_4) == 188, "found %lld\n",
-		 (long long)(int)offsetof(struct obdo, o_padding_4));
-	LASSERTF((int)sizeof(((struct obdo *)0)->o_padding_4) == 4, "found %lld\n",
-		 (long long)(int)sizeof(((struct obdo *)0)->o_padding_4));
+	LASSERTF((int)offsetof(struct obdo, o_compr_nob) == 188, "found %lld\n",
+		 (long long)(int)offsetof(struct obdo, o_compr_nob));
+	LASSERTF((int)sizeof(((struct obdo *)0)->o_compr_nob) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct obdo *)0)->o_compr_nob));
 	LASSERTF((int)offsetof(struct obdo, o_padding_5) == 192, "found %lld\n",
 		 (long long)(int)offsetof(struct obdo, o_padding_5));
 	LASSERTF((int)sizeof(((struct obdo *)0)->o_padding_5) == 8, "found %lld\n",
@@ -1690,6 +1766,7 @@ void lustre_assert_wire_constants(void)
 	BUILD_BUG_ON(OBD_FL_NOSPC_BLK != 0x00100000);
 	BUILD_BUG_ON(OBD_FL_FLUSH != 0x00200000);
 	BUILD_BUG_ON(OBD_FL_SHORT_IO != 0x00400000);
+	BUILD_BUG_ON(OBD_FL_COMPRESSED != 0x01000000);
 
 	/* Checks for struct lov_ost_data_v1 */
 	LASSERTF((int)sizeof(struct lov_ost_data_v1) == 24, "found %lld\n",
@@ -1817,10 +1894,18 @@ void lustre_assert_wire_constants(void)
 		 (long long)(int)offsetof(struct lov_comp_md_entry_v1, lcme_timestamp));
 	LASSERTF((int)sizeof(((struct lov_comp_md_entry_v1 *)0)->lcme_timestamp) == 8, "found %lld\n",
 		 (long long)(int)sizeof(((struct lov_comp_md_entry_v1 *)0)->lcme_timestamp));
-	LASSERTF((int)offsetof(struct lov_comp_md_entry_v1, lcme_padding_1) == 44, "found %lld\n",
+	LASSERTF((int)offsetof(struct lov_comp_md_entry_v1, lcme_compr_type) == 44, "found %lld\n",
+		 (long long)(int)offsetof(struct lov_comp_md_entry_v1, lcme_compr_type));
+	LASSERTF((int)sizeof(((struct lov_comp_md_entry_v1 *)0)->lcme_compr_type) == 1, "found %lld\n",
+		 (long long)(int)sizeof(((struct lov_comp_md_entry_v1 *)0)->lcme_compr_type));
+	LASSERTF((int)offsetof(struct lov_comp_md_entry_v1, lcme_padding_1) == 45, "found %lld\n",
 		 (long long)(int)offsetof(struct lov_comp_md_entry_v1, lcme_padding_1));
-	LASSERTF((int)sizeof(((struct lov_comp_md_entry_v1 *)0)->lcme_padding_1) == 4, "found %lld\n",
+	LASSERTF((int)sizeof(((struct lov_comp_md_entry_v1 *)0)->lcme_padding_1) == 1, "found %lld\n",
 		 (long long)(int)sizeof(((struct lov_comp_md_entry_v1 *)0)->lcme_padding_1));
+	LASSERTF((int)offsetof(struct lov_comp_md_entry_v1, lcme_padding_2) == 46, "found %lld\n",
+		 (long long)(int)offsetof(struct lov_comp_md_entry_v1, lcme_padding_2));
+	LASSERTF((int)sizeof(((struct lov_comp_md_entry_v1 *)0)->lcme_padding_2) == 2, "found %lld\n",
+		 (long long)(int)sizeof(((struct lov_comp_md_entry_v1 *)0)->lcme_padding_2));
 	BUILD_BUG_ON(LCME_FL_STALE != 0x00000001);
 	BUILD_BUG_ON(LCME_FL_PREF_RD != 0x00000002);
 	BUILD_BUG_ON(LCME_FL_PREF_WR != 0x00000004);
@@ -2349,6 +2434,42 @@ void lustre_assert_wire_constants(void)
 	LASSERTF(OBD_BRW_SYS_RESOURCE == 0x40000, "found 0x%.8x\n",
 		OBD_BRW_SYS_RESOURCE);
 
+	/* Checks for struct ll_compr_chunk_hdr */
+	LASSERTF((int)sizeof(struct ll_compr_chunk_hdr) == 16, "found %lld\n",
+		 (long long)(int)sizeof(struct ll_compr_chunk_hdr));
+	LASSERTF((int)offsetof(struct ll_compr_chunk_hdr, lcch_magic) == 0, "found %lld\n",
+		 (long long)(int)offsetof(struct ll_compr_chunk_hdr, lcch_magic));
+	LASSERTF((int)sizeof(((struct ll_compr_chunk_hdr *)0)->lcch_magic) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct ll_compr_chunk_hdr *)0)->lcch_magic));
+	LASSERTF((int)offsetof(struct ll_compr_chunk_hdr, lcch_type) == 4, "found %lld\n",
+		 (long long)(int)offsetof(struct ll_compr_chunk_hdr, lcch_type));
+	LASSERTF((int)sizeof(((struct ll_compr_chunk_hdr *)0)->lcch_type) == 1, "found %lld\n",
+		 (long long)(int)sizeof(((struct ll_compr_chunk_hdr *)0)->lcch_type));
+	LASSERTF((int)offsetof(struct ll_compr_chunk_hdr, lcch_padding_1) == 5, "found %lld\n",
+		 (long long)(int)offsetof(struct ll_compr_chunk_hdr, lcch_padding_1));
+	LASSERTF((int)sizeof(((struct ll_compr_chunk_hdr *)0)->lcch_padding_1) == 1, "found %lld\n",
+		 (long long)(int)sizeof(((struct ll_compr_chunk_hdr *)0)->lcch_padding_1));
+	LASSERTF((int)offsetof(struct ll_compr_chunk_hdr, lcch_padding_2) == 6, "found %lld\n",
+		 (long long)(int)offsetof(struct ll_compr_chunk_hdr, lcch_padding_2));
+	LASSERTF((int)sizeof(((struct ll_compr_chunk_hdr *)0)->lcch_padding_2) == 2, "found %lld\n",
+		 (long long)(int)sizeof(((struct ll_compr_chunk_hdr *)0)->lcch_padding_2));
+	LASSERTF((int)offsetof(struct ll_compr_chunk_hdr, lcch_uncompr_size) == 8, "found %lld\n",
+		 (long long)(int)offsetof(struct ll_compr_chunk_hdr, lcch_uncompr_size));
+	LASSERTF((int)sizeof(((struct ll_compr_chunk_hdr *)0)->lcch_uncompr_size) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct ll_compr_chunk_hdr *)0)->lcch_uncompr_size));
+	LASSERTF((int)offsetof(struct ll_compr_chunk_hdr, lcch_compr_size) == 12, "found %lld\n",
+		 (long long)(int)offsetof(struct ll_compr_chunk_hdr, lcch_compr_size));
+	LASSERTF((int)sizeof(((struct ll_compr_chunk_hdr *)0)->lcch_compr_size) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct ll_compr_chunk_hdr *)0)->lcch_compr_size));
+	BUILD_BUG_ON(LL_COMPR_CHUNK_MAGIC != 0xC0DEC0DE);
+	BUILD_BUG_ON(LL_COMPR_CHUNK_SIZE != (64 * 1024));
+	LASSERTF(LL_COMPR_TYPE_NONE == 0, "found %lld\n",
+		 (long long)LL_COMPR_TYPE_NONE);
+	LASSERTF(LL_COMPR_TYPE_LZ4 == 1, "found %lld\n",
+		 (long long)LL_COMPR_TYPE_LZ4);
+	LASSERTF(LL_COMPR_TYPE_ZSTD == 2, "found %lld\n",
+		 (long long)LL_COMPR_TYPE_ZSTD);
+
 	/* Checks for struct ost_body */
 	LASSERTF((int)sizeof(struct ost_body) == 208, "found %lld\n",
 		 (long long)(int)sizeof(struct ost_body));
@@ -5341,6 +5462,49 @@ void lustre_assert_wire_constants(void)
 	LASSERTF((int)sizeof(((struct out_update_buffer *)0)->oub_padding) == 4, "found %lld\n",
 		 (long long)(int)sizeof(((struct out_update_buffer *)0)->oub_padding));
 
+	/* Checks for struct msg_batch_header */
+	LASSERTF((int)sizeof(struct msg_batch_header) == 16, "found %lld\n",
+		 (long long)(int)sizeof(struct msg_batch_header));
+	LASSERTF((int)offsetof(struct msg_batch_header, mbh_magic) == 0, "found %lld\n",
+		 (long long)(int)offsetof(struct msg_batch_header, mbh_magic));
+	LASSERTF((int)sizeof(((struct msg_batch_header *)0)->mbh_magic) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct msg_batch_header *)0)->mbh_magic));
+	LASSERTF((int)offsetof(struct msg_batch_header, mbh_count) == 4, "found %lld\n",
+		 (long long)(int)offsetof(struct msg_batch_header, mbh_count));
+	LASSERTF((int)sizeof(((struct msg_batch_header *)0)->mbh_count) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct msg_batch_header *)0)->mbh_count));
+	LASSERTF((int)offsetof(struct msg_batch_header, mbh_reply_size) == 8, "found %lld\n",
+		 (long long)(int)offsetof(struct msg_batch_header, mbh_reply_size));
+	LASSERTF((int)sizeof(((struct msg_batch_header *)0)->mbh_reply_size) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct msg_batch_header *)0)->mbh_reply_size));
+	LASSERTF((int)offsetof(struct msg_batch_header, mbh_padding) == 12, "found %lld\n",
+		 (long long)(int)offsetof(struct msg_batch_header, mbh_padding));
+	LASSERTF((int)sizeof(((struct msg_batch_header *)0)->mbh_padding) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct msg_batch_header *)0)->mbh_padding));
+	BUILD_BUG_ON(MSG_BATCH_HEADER_MAGIC != 0xBA7C0001);
+	BUILD_BUG_ON(MSG_BATCH_MAX_COUNT != 64);
+
+	/* Checks for struct msg_batch_reply */
+	LASSERTF((int)sizeof(struct msg_batch_reply) == 8, "found %lld\n",
+		 (long long)(int)sizeof(struct msg_batch_reply));
+	LASSERTF((int)offsetof(struct msg_batch_reply, mbr_magic) == 0, "found %lld\n",
+		 (long long)(int)offsetof(struct msg_batch_reply, mbr_magic));
+	LASSERTF((int)sizeof(((struct msg_batch_reply *)0)->mbr_magic) == 4, "found %lld\n",
+		 (long long)(int)sizeof(((struct msg_batch_reply *)0)->mbr_magic));
+	LASSERTF((int)offsetof(struct msg_batch_reply, mbr_count) == 4, "found %lld\n",
+		 (long long)(int)offsetof(struct msg_batch_reply, mbr_count));
+	LASSERTF((int)sizeof(((struct msg_batch_reply *)0)->mbr_count) == 2, "found %lld\n",
+		 (long long)(int)sizeof(((struct msg_batch_reply *)0)->mbr_count));
+	LASSERTF((int)offsetof(struct msg_batch_reply, mbr_padding) == 6, "found %lld\n",
+		 (long long)(int)offsetof(struct msg_batch_reply, mbr_padding));
+	LASSERTF((int)sizeof(((struct msg_batch_reply *)0)->mbr_padding) == 2, "found %lld\n",
+		 (long long)(int)sizeof(((struct msg_batch_reply *)0)->mbr_padding));
+	LASSERTF((int)offsetof(struct msg_batch_reply, mbr_repmsg) == 8, "found %lld\n",
+		 (long long)(int)offsetof(struct msg_batch_reply, mbr_repmsg));
+	LASSERTF((int)sizeof(((struct msg_batch_reply *)0)->mbr_repmsg) == 0, "found %lld\n",
+		 (long long)(int)sizeof(((struct msg_batch_reply *)0)->mbr_repmsg));
+	BUILD_BUG_ON(MSG_BATCH_REPLY_MAGIC != 0xBA7C0002);
+
 	/* Checks for struct nodemap_cluster_rec */
 	LASSERTF((int)sizeof(struct nodemap_cluster_rec) == 32, "found %lld\n",
 		 (long long)(int)sizeof(struct nodemap_cluster_rec));
@@ -42,6 +42,8 @@
 #include <obd.h>
 #include <obd_class.h>
 #include <obd_cksum.h>
+#include <obd_compress.h>
+#include <lustre_swab.h>
 #include <lustre_lfsck.h>
 #include <lustre_nodemap.h>
 #include <lustre_acl.h>
@@ -2534,6 +2536,176 @@ static int tgt_shortio2pages(struct niobuf_local *local, int npages,
 	return 0;
 }
 
+/* add pages to \a desc to receive a compressed bulk of \a nob bytes */
+static int tgt_compr_bulk_prep(struct ptlrpc_bulk_desc *desc, int nob)
+{
+	while (nob > 0) {
+		struct page *page;
+		int len = min_t(int, nob, PAGE_SIZE);
+
+		page = alloc_page(GFP_NOFS);
+		if (page == NULL)
+			return -ENOMEM;
+
+		/* the desc holds its own page reference, see pin ops */
+		desc->bd_frag_ops->add_kiov_frag(desc, page, 0, len);
+		put_page(page);
+		nob -= len;
+	}
+
+	return 0;
+}
+
+/* copy \a len bytes at offset \a off of the bulk in \a desc to \a buf */
+static void tgt_compr_bulk_copy(struct ptlrpc_bulk_desc *desc,
+				unsigned int off, char *buf, unsigned int len)
+{
+	while (len > 0) {
+		struct page *page = desc->bd_vec[off >> PAGE_SHIFT].bv_page;
+		unsigned int poff = off & ~PAGE_MASK;
+		unsigned int count = min_t(unsigned int, len, PAGE_SIZE - poff);
+		char *ptr;
+
+		ptr = kmap_atomic(page);
+		memcpy(buf, ptr + poff, count);
+		kunmap_atomic(ptr);
+
+		buf += count;
+		off += count;
+		len -= count;
+	}
+}
+
+/**
+ * Decompress the chunks of a compressed OST_WRITE bulk into the local
+ * niobuf pages, see struct ll_compr_chunk_hdr for the format of the bulk.
+ *
+ * The OSD is then given the uncompressed data, compression is not kept on
+ * disk.
+ *
+ * \param[in] tgt	target receiving the write
+ * \param[in] desc	bulk descriptor holding the compressed data
+ * \param[in] bulk_nob	size of the compressed bulk
+ * \param[in] local	local niobufs to fill
+ * \param[in] npages	number of local niobufs
+ *
+ * \retval 0		on success
+ * \retval -EAGAIN	if the bulk is malformed, so that the client resends
+ *			it as for a bulk transfer error
+ * \retval negative	other errors
+ */
+static int tgt_brw_decompress(struct lu_target *tgt,
+			      struct ptlrpc_bulk_desc *desc, int bulk_nob,
+			      struct niobuf_local *local, int npages)
+{
+	struct ll_compr_chunk_hdr hdr;
+	char *src = NULL;
+	char *dst = NULL;
+	unsigned int off = 0;
+	unsigned int lnb_off = 0;
+	long long data_nob = 0;
+	ktime_t kstart = ktime_get();
+	int i = 0;
+	int rc = 0;
+
+	ENTRY;
+	OBD_ALLOC_LARGE(src, LL_COMPR_CHUNK_SIZE);
+	OBD_ALLOC_LARGE(dst, LL_COMPR_CHUNK_SIZE);
+	if (src == NULL || dst == NULL)
+		GOTO(out, rc = -ENOMEM);
+
+	while (off < bulk_nob) {
+		const char *data;
+		unsigned int len;
+
+		if (off + sizeof(hdr) > bulk_nob)
+			GOTO(out, rc = -EPROTO);
+
+		tgt_compr_bulk_copy(desc, off, (char *)&hdr, sizeof(hdr));
+		off += sizeof(hdr);
+		if (hdr.lcch_magic == __swab32(LL_COMPR_CHUNK_MAGIC))
+			lustre_swab_ll_compr_chunk_hdr(&hdr);
+
+		if (hdr.lcch_magic != LL_COMPR_CHUNK_MAGIC ||
+		    hdr.lcch_uncompr_size == 0 ||
+		    hdr.lcch_uncompr_size > LL_COMPR_CHUNK_SIZE ||
+		    hdr.lcch_compr_size > hdr.lcch_uncompr_size ||
+		    off + hdr.lcch_compr_size > bulk_nob)
+			GOTO(out, rc = -EPROTO);
+
+		tgt_compr_bulk_copy(desc, off, src, hdr.lcch_compr_size);
+		off += ll_compr_round(hdr.lcch_compr_size);
+
+		len = hdr.lcch_uncompr_size;
+		if (hdr.lcch_type == LL_COMPR_TYPE_NONE) {
+			if (hdr.lcch_compr_size != len)
+				GOTO(out, rc = -EPROTO);
+			data = src;
+		} else {
+			rc = obd_decompress_chunk(hdr.lcch_type, src,
+						  hdr.lcch_compr_size, dst,
+						  &len);
+			if (rc == 0 && len != hdr.lcch_uncompr_size)
+				rc = -EPROTO;
+			if (rc)
+				GOTO(out, rc);
+			data = dst;
+		}
+
+		/* copy the chunk to the local pages, in order */
+		while (len > 0) {
+			unsigned int count;
+			char *ptr;
+
+			while (i < npages && local[i].lnb_len == 0)
+				i++;
+			if (i == npages)
+				GOTO(out, rc = -EPROTO);
+
+			count = min_t(unsigned int, len,
+				      local[i].lnb_len - lnb_off);
+			ptr = kmap_atomic(local[i].lnb_page);
+			memcpy(ptr + (local[i].lnb_page_offset & ~PAGE_MASK) +
+			       lnb_off, data, count);
+			kunmap_atomic(ptr);
+
+			data += count;
+			len -= count;
+			lnb_off += count;
+			data_nob += count;
+			if (lnb_off == local[i].lnb_len) {
+				lnb_off = 0;
+				i++;
+			}
+		}
+	}
+
+	/* all the data must be in the bulk */
+	while (i < npages && local[i].lnb_len == 0)
+		i++;
+	if (i != npages)
+		rc = -EPROTO;
+out:
+	if (src != NULL)
+		OBD_FREE_LARGE(src, LL_COMPR_CHUNK_SIZE);
+	if (dst != NULL)
+		OBD_FREE_LARGE(dst, LL_COMPR_CHUNK_SIZE);
+
+	if (rc == 0) {
+		atomic64_inc(&tgt->lut_compr_rpcs);
+		atomic64_add(bulk_nob, &tgt->lut_compr_bulk_bytes);
+		atomic64_add(data_nob, &tgt->lut_compr_data_bytes);
+		atomic64_add(ktime_us_delta(ktime_get(), kstart),
+			     &tgt->lut_compr_usec);
+	} else if (rc != -ENOMEM && rc != -EOPNOTSUPP) {
+		CERROR("%s: bad compressed bulk at %u/%d: rc = %d\n",
+		       tgt_name(tgt), off, bulk_nob, rc);
+		rc = -EAGAIN;
+	}
+
+	RETURN(rc);
+}
+
 static void tgt_warn_on_cksum(struct ptlrpc_request *req,
 			      struct ptlrpc_bulk_desc *desc,
 			      struct niobuf_local *local_nb, int npages,
@@ -2749,6 +2921,40 @@ int tgt_brw_write(struct tgt_session_info *tsi)
 		rc = tgt_shortio2pages(local_nb, npages, short_io_buf,
 				       short_io_size);
 		desc = NULL;
+	} else if (body->oa.o_valid & OBD_MD_FLFLAGS &&
+		   body->oa.o_flags & OBD_FL_COMPRESSED) {
+		int nob = 0;
+
+		/* the client only compresses if it saves some bulk */
+		for (i = 0; i < npages; i++)
+			nob += local_nb[i].lnb_len;
+		if (!exp_connect_compress(exp) || body->oa.o_compr_nob == 0 ||
+		    body->oa.o_compr_nob >= nob)
+			GOTO(skip_transfer, rc = -EPROTO);
+
+		desc = ptlrpc_prep_bulk_exp(req,
+					    DIV_ROUND_UP(body->oa.o_compr_nob,
+							 PAGE_SIZE),
+					    ioobj_max_brw_get(ioo),
+					    PTLRPC_BULK_GET_SINK,
+					    OST_BULK_PORTAL,
+					    &ptlrpc_bulk_kiov_pin_ops);
+		if (desc == NULL)
+			GOTO(skip_transfer, rc = -ENOMEM);
+
+		rc = tgt_compr_bulk_prep(desc, body->oa.o_compr_nob);
+		if (rc == 0)
+			rc = sptlrpc_svc_prep_bulk(req, desc);
+		if (rc != 0)
+			GOTO(skip_transfer, rc);
+
+		rc = target_bulk_io(exp, desc);
+		no_reply = rc != 0;
+		if (rc == 0)
+			rc = tgt_brw_decompress(tsi->tsi_tgt, desc,
+						body->oa.o_compr_nob,
+						local_nb, npages);
+		GOTO(skip_transfer, rc);
 	} else {
 		desc = ptlrpc_prep_bulk_exp(req, npages, ioobj_max_brw_get(ioo),
 					    PTLRPC_BULK_GET_SINK,
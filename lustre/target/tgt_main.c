@@ -235,6 +235,58 @@ ssize_t tgt_fmd_seconds_store(struct kobject *kobj, struct attribute *attr,
 }
 LUSTRE_RW_ATTR(tgt_fmd_seconds);
 
+/**
+ * Show the stats of compressed BRW writes received by the target.
+ *
+ * \param[in] kobj	kobject
+ * \param[in] attr	attribute to show
+ * \param[in] buf	buffer for data
+ *
+ * \retval		0 and buffer filled with data on success
+ * \retval		negative value on error
+ */
+static ssize_t compress_stats_show(struct kobject *kobj, struct attribute *attr,
+				   char *buf)
+{
+	struct obd_device *obd = container_of(kobj, struct obd_device,
+					      obd_kset.kobj);
+	struct lu_target *lut = obd->u.obt.obt_lut;
+
+	return sprintf(buf, "rpcs: %lld\nbulk_bytes: %lld\ndata_bytes: %lld\n"
+		       "decompress_usec: %lld\n",
+		       (s64)atomic64_read(&lut->lut_compr_rpcs),
+		       (s64)atomic64_read(&lut->lut_compr_bulk_bytes),
+		       (s64)atomic64_read(&lut->lut_compr_data_bytes),
+		       (s64)atomic64_read(&lut->lut_compr_usec));
+}
+
+/**
+ * Clear the stats of compressed BRW writes, any value can be written.
+ *
+ * \param[in] kobj	kobject
+ * \param[in] attr	attribute to show
+ * \param[in] buf	buffer for data
+ * \param[in] count	buffer size
+ *
+ * \retval		\a count
+ */
+static ssize_t compress_stats_store(struct kobject *kobj,
+				    struct attribute *attr,
+				    const char *buffer, size_t count)
+{
+	struct obd_device *obd = container_of(kobj, struct obd_device,
+					      obd_kset.kobj);
+	struct lu_target *lut = obd->u.obt.obt_lut;
+
+	atomic64_set(&lut->lut_compr_rpcs, 0);
+	atomic64_set(&lut->lut_compr_bulk_bytes, 0);
+	atomic64_set(&lut->lut_compr_data_bytes, 0);
+	atomic64_set(&lut->lut_compr_usec, 0);
+
+	return count;
+}
+LUSTRE_RW_ATTR(compress_stats);
+
 /* These two aliases are old names and kept for compatibility, they were
  * changed to 'tgt_fmd_count' and 'tgt_fmd_seconds'.
  * This change was made in Lustre 2.13, so these aliases can be removed
@@ -251,6 +303,7 @@ static const struct attribute *tgt_attrs[] = {
 	&lustre_attr_tgt_fmd_seconds.attr,
 	&tgt_fmd_count_compat.attr,
 	&tgt_fmd_seconds_compat.attr,
+	&lustre_attr_compress_stats.attr,
 	NULL,
 };
 
@@ -589,6 +642,10 @@ int tgt_init(const struct lu_env *env, struct lu_target *lut,
 
 	lut->lut_fmd_max_num = LUT_FMD_MAX_NUM_DEFAULT;
 	lut->lut_fmd_max_age = LUT_FMD_MAX_AGE_DEFAULT;
+	atomic64_set(&lut->lut_compr_rpcs, 0);
+	atomic64_set(&lut->lut_compr_bulk_bytes, 0);
+	atomic64_set(&lut->lut_compr_data_bytes, 0);
+	atomic64_set(&lut->lut_compr_usec, 0);
 
 	atomic_set(&lut->lut_sync_count, 0);
 
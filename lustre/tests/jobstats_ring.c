@@ -0,0 +1,182 @@
+/*
+ * GPL HEADER START
+ *
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 only,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License version 2 for more details (a copy is included
+ * in the LICENSE file that accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License
+ * version 2 along with this program; If not, see
+ * http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * GPL HEADER END
+ */
+/*
+ * This file is part of Lustre, http://www.lustre.org/
+ */
+
+/*
+ * Syncs and maps a job_stats_ring file, checks its layout and consumes all
+ * the published records.  Prints one line per non-empty counter of each
+ * record: "jobid counter count min max sum hist", where hist is the number
+ * of samples in the histogram of the counter, or "-" if it has none.
+ * Fails if the layout is inconsistent, or a histogram does not account for
+ * all the samples of its counter.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <linux/lustre/lustre_jobstats.h>
+
+static int check_record(struct jobstats_ring_header *hdr,
+			struct jobstats_ring_record *rec)
+{
+	struct jobstats_ring_hist *hists;
+	int rc = 0;
+	int i, j;
+
+	hists = (void *)&rec->jrr_counters[hdr->jrh_ncounters];
+	for (i = 0; i < hdr->jrh_ncounters; i++) {
+		struct jobstats_ring_counter_desc *desc = &hdr->jrh_counters[i];
+		struct jobstats_ring_counter *cntr = &rec->jrr_counters[i];
+		unsigned long long samples = 0;
+
+		if (cntr->jrc_count == 0)
+			continue;
+
+		printf("%.*s %s %llu %llu %llu %llu ", LUSTRE_JOBID_SIZE,
+		       rec->jrr_jobid, desc->jcd_name,
+		       (unsigned long long)cntr->jrc_count,
+		       (unsigned long long)cntr->jrc_min,
+		       (unsigned long long)cntr->jrc_max,
+		       (unsigned long long)cntr->jrc_sum);
+
+		if (desc->jcd_hist == JOBSTATS_RING_NO_HIST) {
+			printf("-\n");
+			continue;
+		}
+
+		if (desc->jcd_hist >= hdr->jrh_nhists) {
+			printf("?\n");
+			fprintf(stderr, "%s: bad histogram %u\n",
+				desc->jcd_name, desc->jcd_hist);
+			rc = -EINVAL;
+			continue;
+		}
+
+		for (j = 0; j < JOBSTATS_RING_HIST_BUCKETS; j++)
+			samples += hists[desc->jcd_hist].jrhi_buckets[j];
+		printf("%llu\n", samples);
+		if (samples != cntr->jrc_count) {
+			fprintf(stderr, "%s: %llu samples, %llu in histogram\n",
+				desc->jcd_name,
+				(unsigned long long)cntr->jrc_count, samples);
+			rc = -EINVAL;
+		}
+	}
+
+	return rc;
+}
+
+int main(int argc, char **argv)
+{
+	struct jobstats_ring_header *hdr;
+	size_t record_size;
+	size_t size;
+	__u64 head, tail;
+	void *ring;
+	int rc = 0;
+	int fd;
+
+	if (argc != 2) {
+		fprintf(stderr, "usage: %s <job_stats_ring>\n", argv[0]);
+		return 1;
+	}
+
+	fd = open(argv[1], O_RDWR);
+	if (fd < 0) {
+		fprintf(stderr, "open %s: %s\n", argv[1], strerror(errno));
+		return 1;
+	}
+
+	if (write(fd, "sync", 4) != 4) {
+		fprintf(stderr, "sync %s: %s\n", argv[1], strerror(errno));
+		return 1;
+	}
+
+	/* proc files have no size, map the header first to learn it */
+	ring = mmap(NULL, sysconf(_SC_PAGESIZE), PROT_READ | PROT_WRITE,
+		    MAP_SHARED, fd, 0);
+	if (ring == MAP_FAILED) {
+		fprintf(stderr, "mmap %s: %s\n", argv[1], strerror(errno));
+		return 1;
+	}
+	hdr = ring;
+
+	if (hdr->jrh_magic != JOBSTATS_RING_MAGIC ||
+	    hdr->jrh_version != JOBSTATS_RING_VERSION ||
+	    hdr->jrh_hist_buckets != JOBSTATS_RING_HIST_BUCKETS) {
+		fprintf(stderr, "%s: bad magic %#x version %u buckets %u\n",
+			argv[1], hdr->jrh_magic, hdr->jrh_version,
+			hdr->jrh_hist_buckets);
+		return 1;
+	}
+
+	record_size = sizeof(struct jobstats_ring_record) +
+		      hdr->jrh_ncounters *
+		      sizeof(struct jobstats_ring_counter) +
+		      hdr->jrh_nhists * sizeof(struct jobstats_ring_hist);
+	if (hdr->jrh_record_size != record_size ||
+	    hdr->jrh_header_size < sizeof(*hdr) + hdr->jrh_ncounters *
+				   sizeof(hdr->jrh_counters[0])) {
+		fprintf(stderr, "%s: bad header size %u record size %u\n",
+			argv[1], hdr->jrh_header_size, hdr->jrh_record_size);
+		return 1;
+	}
+
+	size = hdr->jrh_header_size +
+	       (size_t)hdr->jrh_nrecords * hdr->jrh_record_size;
+	munmap(ring, sysconf(_SC_PAGESIZE));
+	ring = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (ring == MAP_FAILED) {
+		fprintf(stderr, "mmap %s: %s\n", argv[1], strerror(errno));
+		return 1;
+	}
+	hdr = ring;
+
+	head = __atomic_load_n(&hdr->jrh_head, __ATOMIC_ACQUIRE);
+	tail = hdr->jrh_tail;
+	if (tail > head || head - tail > hdr->jrh_nrecords) {
+		fprintf(stderr, "%s: bad head %llu tail %llu\n", argv[1],
+			(unsigned long long)head, (unsigned long long)tail);
+		return 1;
+	}
+
+	for (; tail < head; tail++) {
+		struct jobstats_ring_record *rec;
+
+		rec = ring + hdr->jrh_header_size +
+		      (tail % hdr->jrh_nrecords) * hdr->jrh_record_size;
+		if (check_record(hdr, rec))
+			rc = 1;
+	}
+	__atomic_store_n(&hdr->jrh_tail, tail, __ATOMIC_RELEASE);
+
+	munmap(ring, size);
+	close(fd);
+
+	return rc;
+}
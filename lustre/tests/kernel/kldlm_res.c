@@ -0,0 +1,253 @@
+/*
+ * GPL HEADER START
+ *
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 only,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License version 2 for more details (a copy is included
+ * in the LICENSE file that accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License
+ * version 2 along with this program; If not, see
+ * http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * GPL HEADER END
+ */
+
+/*
+ * Microbenchmark of ldlm_resource_get() and ldlm_resource_putref().
+ *
+ * A set of resources is created in the namespace of the given obd device,
+ * then one thread per online CPU repeatedly looks them up and releases
+ * them, as done by every lock enqueue, match and cancel.  Each lookup must
+ * return the resource created for its name, the lookup rate is then
+ * printed to the console.  Like kinode, the module refuses to load once
+ * the run is complete.
+ */
+
+#include <linux/module.h>
+#include <linux/kernel.h>
+#include <linux/completion.h>
+#include <linux/kthread.h>
+#include <linux/cpu.h>
+
+#include <obd_class.h>
+#include <lustre_dlm.h>
+
+/* Random ID passed by userspace, and printed in messages, used to
+ * separate different runs of that module. */
+static int run_id;
+module_param(run_id, int, 0644);
+MODULE_PARM_DESC(run_id, "run ID");
+
+/* Name of the obd device whose namespace is used */
+static char obdname[MAX_OBD_NAME];
+module_param_string(obdname, obdname, sizeof(obdname), 0644);
+MODULE_PARM_DESC(obdname, "name of obd device with the ldlm namespace");
+
+static unsigned int nres = 1024;
+module_param(nres, uint, 0644);
+MODULE_PARM_DESC(nres, "number of resources looked up");
+
+static unsigned int loops = 1000000;
+module_param(loops, uint, 0644);
+MODULE_PARM_DESC(loops, "lookups done by each thread");
+
+#define PREFIX "lustre_kldlm_res_%u:"
+
+/* outside of any FID sequence used by Lustre */
+#define KLDLM_RES_SEQ	0xffffffffbe000000ULL
+
+struct kldlm_res_thread {
+	struct task_struct	*krt_task;
+	struct ldlm_namespace	*krt_ns;
+	struct ldlm_resource	**krt_resources;
+	struct completion	*krt_start;
+	unsigned int		 krt_cpu;
+	int			 krt_rc;
+	u64			 krt_ns_elapsed;
+};
+
+static atomic_t kldlm_res_running;
+static DECLARE_COMPLETION(kldlm_res_done);
+
+static void kldlm_res_name(struct ldlm_res_id *name, unsigned int i)
+{
+	memset(name, 0, sizeof(*name));
+	name->name[LUSTRE_RES_ID_SEQ_OFF] = KLDLM_RES_SEQ;
+	name->name[LUSTRE_RES_ID_VER_OID_OFF] = i + 1;
+}
+
+static int kldlm_res_thread_main(void *data)
+{
+	struct kldlm_res_thread *krt = data;
+	struct ldlm_resource *res;
+	struct ldlm_res_id name;
+	ktime_t start;
+	unsigned int idx;
+	unsigned int i;
+
+	wait_for_completion(krt->krt_start);
+
+	start = ktime_get();
+	for (i = 0; i < loops; i++) {
+		/* each thread walks the resources in a different order */
+		idx = (i + krt->krt_cpu * 7919) % nres;
+		kldlm_res_name(&name, idx);
+		res = ldlm_resource_get(krt->krt_ns, NULL, &name,
+					LDLM_PLAIN, 0);
+		if (IS_ERR(res)) {
+			krt->krt_rc = PTR_ERR(res);
+			break;
+		}
+		/* the resource held since before the threads started */
+		if (res != krt->krt_resources[idx]) {
+			pr_err(PREFIX " CPU %u: resource %u looked up as %p, not %p\n",
+			       run_id, krt->krt_cpu, idx, res,
+			       krt->krt_resources[idx]);
+			ldlm_resource_putref(res);
+			krt->krt_rc = -EIO;
+			break;
+		}
+		ldlm_resource_putref(res);
+
+		if ((i & 1023) == 0)
+			cond_resched();
+	}
+	krt->krt_ns_elapsed = ktime_to_ns(ktime_sub(ktime_get(), start));
+
+	if (atomic_dec_and_test(&kldlm_res_running))
+		complete(&kldlm_res_done);
+
+	return 0;
+}
+
+static int kldlm_res_run(struct ldlm_namespace *ns)
+{
+	struct kldlm_res_thread *threads = NULL;
+	struct ldlm_resource **resources;
+	DECLARE_COMPLETION_ONSTACK(start);
+	unsigned int nthreads = 0;
+	u64 max_elapsed = 0;
+	u64 total = 0;
+	unsigned int cpu;
+	unsigned int i;
+	int rc = 0;
+
+	OBD_ALLOC_PTR_ARRAY_LARGE(resources, nres);
+	if (!resources)
+		return -ENOMEM;
+	OBD_ALLOC_PTR_ARRAY(threads, num_possible_cpus());
+	if (!threads)
+		GOTO(out_free, rc = -ENOMEM);
+
+	/* keep a reference on every resource, so that the threads only
+	 * measure the lookup and not the creation of resources */
+	for (i = 0; i < nres; i++) {
+		struct ldlm_res_id name;
+
+		kldlm_res_name(&name, i);
+		resources[i] = ldlm_resource_get(ns, NULL, &name,
+						 LDLM_PLAIN, 1);
+		if (IS_ERR(resources[i])) {
+			rc = PTR_ERR(resources[i]);
+			resources[i] = NULL;
+			GOTO(out_put, rc);
+		}
+	}
+
+	cpus_read_lock();
+	atomic_set(&kldlm_res_running, 1);
+	for_each_online_cpu(cpu) {
+		struct kldlm_res_thread *krt = &threads[nthreads];
+
+		krt->krt_ns = ns;
+		krt->krt_resources = resources;
+		krt->krt_start = &start;
+		krt->krt_cpu = cpu;
+		krt->krt_task = kthread_create(kldlm_res_thread_main, krt,
+					       "kldlm_res_%u", cpu);
+		if (IS_ERR(krt->krt_task)) {
+			rc = PTR_ERR(krt->krt_task);
+			break;
+		}
+		kthread_bind(krt->krt_task, cpu);
+		atomic_inc(&kldlm_res_running);
+		wake_up_process(krt->krt_task);
+		nthreads++;
+	}
+	cpus_read_unlock();
+
+	complete_all(&start);
+	if (!atomic_dec_and_test(&kldlm_res_running))
+		wait_for_completion(&kldlm_res_done);
+
+	for (i = 0; i < nthreads; i++) {
+		if (threads[i].krt_rc && !rc)
+			rc = threads[i].krt_rc;
+		max_elapsed = max(max_elapsed, threads[i].krt_ns_elapsed);
+		total += loops;
+	}
+	if (rc)
+		GOTO(out_put, rc);
+
+	/* below message is checked in sanity.sh test_434 */
+	pr_info(PREFIX " %u threads, %u resources: %llu lookups in %llu us, %llu lookups/s\n",
+		run_id, nthreads, nres, total, max_elapsed / NSEC_PER_USEC,
+		max_elapsed ? total * NSEC_PER_SEC / max_elapsed : 0);
+
+out_put:
+	for (i = 0; i < nres; i++)
+		if (resources[i])
+			ldlm_resource_putref(resources[i]);
+out_free:
+	if (threads)
+		OBD_FREE_PTR_ARRAY(threads, num_possible_cpus());
+	OBD_FREE_PTR_ARRAY_LARGE(resources, nres);
+
+	return rc;
+}
+
+static int __init kldlm_res_init(void)
+{
+	struct obd_device *obd;
+	int rc;
+
+	if (nres == 0 || loops == 0) {
+		pr_err(PREFIX " invalid nres %u or loops %u\n",
+		       run_id, nres, loops);
+		goto out;
+	}
+
+	obd = class_name2obd(obdname);
+	if (!obd || !obd->obd_namespace) {
+		pr_err(PREFIX " no namespace for obd '%s'\n", run_id, obdname);
+		goto out;
+	}
+
+	rc = kldlm_res_run(obd->obd_namespace);
+	if (rc)
+		pr_err(PREFIX " benchmark failed: rc = %d\n", run_id, rc);
+
+out:
+	/* Don't load. */
+	return -EINVAL;
+}
+
+static void __exit kldlm_res_exit(void)
+{
+}
+
+MODULE_AUTHOR("OpenSFS, Inc. <http://www.lustre.org/>");
+MODULE_DESCRIPTION("Lustre ldlm resource lookup benchmark module");
+MODULE_VERSION(LUSTRE_VERSION_STRING);
+MODULE_LICENSE("GPL");
+
+module_init(kldlm_res_init);
+module_exit(kldlm_res_exit);
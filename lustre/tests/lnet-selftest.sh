@@ -37,6 +37,13 @@ fi
 
 lst_TESTS=${lst_TESTS:-"write read ping"}
 
+ping_rate_DURATION=${ping_rate_DURATION:-60}
+[ "$SLOW" = no ] && ping_rate_DURATION=20
+ping_rate_CONCR=${ping_rate_CONCR:-64}
+# ksocklnd sched_busy_poll (usecs) and sched_rx_batch to compare against
+ping_rate_BUSY_POLL=${ping_rate_BUSY_POLL:-50}
+ping_rate_RX_BATCH=${ping_rate_RX_BATCH:-16}
+
 # "none" -> LST_BRW_CHECK_NONE
 # "full" -> LST_BRW_CHECK_FULL
 # "simple" -> LST_BRW_CHECK_SIMPLE
@@ -208,6 +215,123 @@ test_smoke () {
 }
 run_test smoke "lst regression test"
 
+# make a batch of small messages only, and report its message rate
+test_ping_rate_sub () {
+	local servers=$1
+	local clients=$2
+
+	local nc=$(echo ${clients//,/ } | wc -w)
+	local ns=$(echo ${servers//,/ } | wc -w)
+
+	echo '#!/bin/bash'
+	echo 'set -e'
+
+	echo "$LST new_session --timeo 100000 pr"
+	echo "$LST add_group c $(nids_list $clients)"
+	echo "$LST add_group s $(nids_list $servers)"
+	echo "$LST add_batch b"
+	echo "$LST add_test --batch b --concurrency $ping_rate_CONCR" \
+		"--distribute ${nc}:${ns} --from c --to s ping"
+	echo "$LST run b"
+	echo "sleep 1"
+	echo "$LST stat --rate --delay $ping_rate_DURATION --count 1 c s"
+	echo "$LST stop b"
+}
+
+# set ksocklnd scheduler tunables on all nodes
+ping_rate_set_socklnd () {
+	local nodes=$(comma_list $(all_nodes))
+	local param=/sys/module/ksocklnd/parameters
+
+	do_nodes $nodes "echo $1 > $param/sched_busy_poll;
+			 echo $2 > $param/sched_rx_batch" ||
+		error "cannot set ksocklnd sched_busy_poll=$1 sched_rx_batch=$2"
+}
+
+test_ping_rate () {
+	lst_prepare
+
+	local runlst=$TMP/ping_rate.sh
+	local log=$TMP/$tfile.log
+	local modes="default"
+	local mode
+	local rc
+
+	test_ping_rate_sub $lst_SERVERS $lst_CLIENTS > $runlst
+	cat $runlst
+
+	# with socklnd, compare against the busy-poll scheduler
+	[[ $NETTYPE =~ tcp ]] && modes+=" busy_poll"
+
+	for mode in $modes; do
+		[ $mode = busy_poll ] &&
+			ping_rate_set_socklnd $ping_rate_BUSY_POLL \
+					      $ping_rate_RX_BATCH
+		echo "ping rate with $mode scheduling:"
+		run_lst $runlst | tee -a $log
+		rc=${PIPESTATUS[0]}
+		[ $mode = busy_poll ] && ping_rate_set_socklnd 0 1
+		[ $rc = 0 ] || { _restore_mount; error "$runlst failed: $rc"; }
+		lst_end_session --verbose | tee -a $log
+	done
+
+	check_lst_err $log
+	lst_cleanup_all
+}
+run_test ping_rate "lst small message rate"
+
+test_rx_direct () {
+	[[ $NETTYPE =~ tcp ]] || skip "need tcp NETTYPE"
+
+	local nodes=$(comma_list $(all_nodes))
+	local param=/sys/module/ksocklnd/parameters/rx_direct
+	local stats=/sys/kernel/debug/lnet/socklnd_rx_stats
+	local runlst=$TMP/rx_direct.sh
+	local log=$TMP/$tfile.log
+	local nc=$(echo ${lst_CLIENTS//,/ } | wc -w)
+	local ns=$(echo ${lst_SERVERS//,/ } | wc -w)
+	local direct
+	local rc
+
+	lst_prepare
+
+	do_nodes $nodes "echo 1 > $param; echo 0 > $stats" ||
+		error "cannot enable ksocklnd rx_direct"
+	stack_trap "do_nodes $nodes 'echo 0 > $param'" EXIT
+
+	cat > $runlst <<-EOF
+	#!/bin/bash
+	set -e
+	$LST new_session --timeo 100000 rxd
+	$LST add_group c $(nids_list $lst_CLIENTS)
+	$LST add_group s $(nids_list $lst_SERVERS)
+	$LST add_batch b
+	$LST add_test --batch b --concurrency 8 --distribute ${nc}:${ns} \\
+		--from c --to s brw write check=full size=1M
+	$LST add_test --batch b --concurrency 8 --distribute ${nc}:${ns} \\
+		--from c --to s brw read check=full size=1M
+	$LST run b
+	sleep 30
+	$LST stat --delay 10 --count 1 c s
+	$LST stop b
+	EOF
+	cat $runlst
+
+	run_lst $runlst | tee $log
+	rc=${PIPESTATUS[0]}
+	[ $rc = 0 ] || { _restore_mount; error "$runlst failed: $rc"; }
+	lst_end_session --verbose | tee -a $log
+
+	# data is checked by the brw tests
+	check_lst_err $log
+	lst_cleanup_all
+
+	direct=$(do_nodes $nodes "cat $stats" |
+		 awk '/direct:/ { sum += $NF } END { print sum + 0 }')
+	(( direct > 0 )) || error "no payload received directly"
+}
+run_test rx_direct "socklnd direct receive into payload pages"
+
 complete $SECONDS
 _restore_mount
 check_and_cleanup_lustre
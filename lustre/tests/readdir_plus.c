@@ -0,0 +1,123 @@
+/*
+ * GPL HEADER START
+ *
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 only,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License version 2 for more details (a copy is included
+ * in the LICENSE file that accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License
+ * version 2 along with this program; If not, see
+ * http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * GPL HEADER END
+ */
+/*
+ * This file is part of Lustre, http://www.lustre.org/
+ */
+
+/*
+ * Lists a directory with llapi_readdir_plus(), one entry per line:
+ * "name flags mode size stripes" where flags are the OBD_MD_FL* flags of the
+ * valid attributes, size is "-" if neither the size nor the lazy size is
+ * valid, and stripes is the stripe count of the first component of the
+ * layout, or "-" if no layout was returned.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <lustre/lustreapi.h>
+#include <linux/lustre/lustre_idl.h>
+
+#define READDIR_PLUS_BUFSIZE	(64 * 1024)
+
+static void print_stripes(struct ll_readdir_plus_ent *lrpe)
+{
+	struct llapi_layout *layout;
+	uint64_t count;
+
+	if (lrpe->lrpe_lmm_size == 0) {
+		printf("-\n");
+		return;
+	}
+
+	layout = llapi_layout_get_by_xattr(ll_readdir_plus_lmm(lrpe),
+					   lrpe->lrpe_lmm_size, 0);
+	if (layout == NULL ||
+	    llapi_layout_comp_use(layout, LLAPI_LAYOUT_COMP_USE_FIRST) < 0 ||
+	    llapi_layout_stripe_count_get(layout, &count) < 0)
+		printf("?\n");
+	else
+		printf("%llu\n", (unsigned long long)count);
+	llapi_layout_free(layout);
+}
+
+int main(int argc, char **argv)
+{
+	__u64 offset = 0;
+	char *buf;
+	int fd;
+	int rc;
+
+	if (argc != 2) {
+		fprintf(stderr, "usage: %s <dir>\n", argv[0]);
+		return 1;
+	}
+
+	fd = open(argv[1], O_RDONLY | O_DIRECTORY);
+	if (fd < 0) {
+		fprintf(stderr, "open(%s) error: %s\n", argv[1],
+			strerror(errno));
+		return 1;
+	}
+
+	buf = malloc(READDIR_PLUS_BUFSIZE);
+	if (buf == NULL) {
+		fprintf(stderr, "cannot allocate buffer\n");
+		close(fd);
+		return 1;
+	}
+
+	while (offset != LUSTRE_EOF) {
+		struct ll_readdir_plus_ent *lrpe = (void *)buf;
+		int i;
+
+		rc = llapi_readdir_plus(fd, &offset, buf, READDIR_PLUS_BUFSIZE);
+		if (rc < 0) {
+			fprintf(stderr, "readdir_plus(%s) error: %s\n",
+				argv[1], strerror(-rc));
+			break;
+		}
+
+		for (i = 0; i < rc; i++) {
+			printf("%s %#llx %o ", lrpe->lrpe_name,
+			       (unsigned long long)lrpe->lrpe_flags,
+			       lrpe->lrpe_stx.stx_mode);
+			if (lrpe->lrpe_flags &
+			    (OBD_MD_FLSIZE | OBD_MD_FLLAZYSIZE))
+				printf("%llu ", (unsigned long long)
+				       lrpe->lrpe_stx.stx_size);
+			else
+				printf("- ");
+			print_stripes(lrpe);
+			lrpe = (void *)lrpe + lrpe->lrpe_reclen;
+		}
+		rc = 0;
+	}
+
+	free(buf);
+	close(fd);
+
+	return rc ? 1 : 0;
+}
@@ -2045,6 +2045,182 @@ test_214() {
 }
 run_test 214 "Check local NI status when link is downed"
 
+rail_stat() {
+	local nid=$1
+	local stat=$2
+
+	$LNETCTL stats show | grep -A 5 -- "- nid: $nid$" |
+		awk '/'$stat':/ { print $2; exit }'
+}
+
+# run 64 lst "brw $2" of 1MiB from NID $1 to itself
+rail_brw() {
+	local nid=$1
+	local op=$2
+
+	export LST_SESSION=$$
+	$LST new_session --timeo 100 $tfile || error "lst new_session failed"
+	$LST add_group c $nid && $LST add_group s $nid &&
+		$LST add_batch b &&
+		$LST add_test --batch b --loop 64 --from c --to s \
+			brw $op size=1M ||
+		error "lst failed to set up the $op test"
+	$LST run b || error "lst run failed"
+	sleep 5
+	$LST stop b
+	$LST end_session
+}
+
+test_215() {
+	[[ -n "$LST" && -x "$LST" ]] || skip_env "lst not found LST=$LST"
+
+	cleanup_netns || error "Failed to cleanup netns before test execution"
+	cleanup_lnet || error "Failed to unload modules before test execution"
+
+	setup_fakeif || error "Failed to add fake IF"
+	have_interface "$FAKE_IF" ||
+		error "Expect $FAKE_IF configured but not found"
+
+	reinit_dlc || return $?
+	add_net "tcp" "${INTERFACES[0]}" || return $?
+	add_net "tcp" "$FAKE_IF" || return $?
+
+	do_lnetctl set bulk_stripe 65536 ||
+		error "failed to set bulk_stripe"
+	$LNETCTL global show | grep -q "bulk_stripe: 65536" ||
+		error "bulk_stripe not set"
+	do_lnetctl set bulk_stripe -1 &&
+		error "negative bulk_stripe should fail"
+
+	local nid1=$($LCTL list_nids | head -n 1)
+	local nid2=$($LCTL list_nids | tail --lines 1)
+
+	# this node is its own MR peer, with both NIDs
+	do_lnetctl discover $nid1 || error "failed to discover $nid1"
+	$LNETCTL peer show --nid $nid1 | grep -q -- "- nid: $nid2$" ||
+		error "$nid2 is not a NID of peer $nid1"
+
+	load_module ../lnet/selftest/lnet_selftest ||
+		error "Failed to load lnet_selftest"
+	stack_trap "lsmod | grep -q lnet_selftest && rmmod lnet_selftest" EXIT
+
+	local stripes=$(rail_stat $nid1 stripe_count)
+	local recv1=$(rail_stat $nid1 recv_bytes)
+	local recv2=$(rail_stat $nid2 recv_bytes)
+
+	[[ -n "$stripes" && -n "$recv1" && -n "$recv2" ]] ||
+		error "no rail statistics for $nid1 and $nid2"
+
+	# the server side PUTs the bulk of "brw read" from the NI the
+	# request came in on, $nid1, and only the peer NIs are striped over
+	rail_brw $nid1 read
+	(( $(rail_stat $nid1 stripe_count) > stripes )) ||
+		error "no PUTs striped over $nid1"
+	(( $(rail_stat $nid1 recv_bytes) - recv1 >= 1048576 )) ||
+		error "no bulk received over $nid1"
+	(( $(rail_stat $nid2 recv_bytes) - recv2 >= 1048576 )) ||
+		error "no bulk received over $nid2"
+
+	# the server side GETs the bulk of "brw write", which the peer NIs
+	# then send back in the REPLYs
+	stripes=$(rail_stat $nid1 stripe_count)
+	local send1=$(rail_stat $nid1 send_bytes)
+	local send2=$(rail_stat $nid2 send_bytes)
+
+	rail_brw $nid1 write
+	(( $(rail_stat $nid1 stripe_count) > stripes )) ||
+		error "no GETs striped over $nid1"
+	(( $(rail_stat $nid1 send_bytes) - send1 >= 1048576 )) ||
+		error "no bulk sent over $nid1"
+	(( $(rail_stat $nid2 send_bytes) - send2 >= 1048576 )) ||
+		error "no bulk sent over $nid2"
+	(( $(rail_stat $nid1 stripe_inflight) == 0 )) ||
+		error "striped GETs still in flight over $nid1"
+
+	do_lnetctl set bulk_stripe 0 ||
+		error "failed to reset bulk_stripe"
+}
+run_test 215 "Check bulk PUTs and GETs are striped over the NIs of an MR peer"
+
+test_216() {
+	reinit_dlc || return $?
+	add_net "tcp" "${INTERFACES[0]}" || return $?
+
+	local lnid=$(lctl list_nids | head -n 1)
+
+	local rtt
+	local i
+
+	# pings are tracked GETs, their REPLYs sample the round-trip time
+	for i in {1..5}; do
+		do_lnetctl ping $lnid || error "failed to ping myself"
+	done
+
+	rtt=$($LNETCTL peer show -v --nid $lnid |
+	      awk '/rtt_usec:/ { print $2; exit }')
+	[[ $rtt =~ ^[0-9]+$ ]] && (( rtt > 0 )) ||
+		error "bad round-trip time '$rtt' for peer NI $lnid"
+	# goodput is only sampled by bulk transfers, which pings are not
+	$LNETCTL peer show -v --nid $lnid | grep -q "goodput:" ||
+		error "no goodput for peer NI $lnid"
+
+	rtt=$($LNETCTL stats show | grep -A 8 "nid: $lnid" |
+	      awk '/rtt_usec:/ { print $2; exit }')
+	[[ $rtt =~ ^[0-9]+$ ]] && (( rtt > 0 )) ||
+		error "bad round-trip time '$rtt' for local NI $lnid"
+}
+run_test 216 "Check round-trip time and goodput of local and peer NIs"
+
+test_217() {
+	reinit_dlc || return $?
+	add_net "tcp" "${INTERFACES[0]}" || return $?
+
+	local param=/sys/module/lnet/parameters/auto_router_buffers
+	local waits=/sys/kernel/debug/lnet/buffer_waits
+	local before
+	local after
+	local i
+
+	[[ -f $param ]] || skip "no auto-sized router buffers"
+
+	do_lnetctl set routing 1 || error "failed to enable routing"
+	do_lnetctl set tiny_buffers 65536 ||
+		error "failed to set tiny_buffers"
+	before=$($LNETCTL routing show | grep -A 2 "tiny:" |
+		 awk '/nbuffers:/ { print $2; exit }')
+
+	echo 1 > $param || error "failed to enable auto_router_buffers"
+	stack_trap "echo 0 > $param" EXIT
+
+	# idle pools give half of their idle buffers back every 10s
+	sleep 25
+	after=$($LNETCTL routing show | grep -A 2 "tiny:" |
+		awk '/nbuffers:/ { print $2; exit }')
+	(( after < before )) ||
+		error "idle tiny pool not shrunk: $before -> $after buffers"
+
+	# pretend a message waited for the first tiny pool, so that it grows,
+	# and check it before the next adjustment shrinks it back
+	#define CFS_FAIL_LNET_RTRBUF_WAIT	0xe001
+	$LCTL set_param fail_loc=0x8000e001
+	before=$after
+	for i in {1..11}; do
+		sleep 1
+		after=$($LNETCTL routing show | grep -A 2 "tiny:" |
+			awk '/nbuffers:/ { print $2; exit }')
+		(( after > before )) && break
+	done
+	$LCTL set_param fail_loc=0
+	(( after > before )) ||
+		error "waited for tiny pool not grown: $before -> $after buffers"
+
+	grep -q "usecs:count" $waits || error "no router buffer wait stats"
+	echo 0 > $waits || error "failed to reset router buffer wait stats"
+
+	do_lnetctl set routing 0 || error "failed to disable routing"
+}
+run_test 217 "Check auto-sizing of router buffer pools"
+
 test_230() {
 	# LU-12815
 	echo "Check valid values; Should succeed"
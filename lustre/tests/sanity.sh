@@ -1499,6 +1499,108 @@ test_24G () {
 }
 run_test 24G "migrate symlink in rename"
 
+test_24H() {
+	[[ $($LCTL get_param mdc.*.import) =~ connect_flags.*readdir_plus ]] ||
+		skip "MDS does not support readdir_plus"
+	which readdir_plus || skip_env "no readdir_plus program"
+
+	local num=100
+	local bs=4096
+	local before
+	local after
+	local i
+
+	test_mkdir -i 0 -c 1 $DIR/$tdir || error "mkdir $tdir failed"
+	$LFS setstripe -c 1 $DIR/$tdir || error "setstripe $tdir failed"
+	for ((i = 1; i <= num; i++)); do
+		dd if=/dev/zero of=$DIR/$tdir/f$i bs=$bs count=$i \
+			status=none || error "write f$i failed"
+	done
+	cancel_lru_locks mdc
+
+	before=$($LCTL get_param -n mdc.*.stats |
+		 awk '/ldlm_ibits_enqueue|mds_getattr/ { sum += $2 }
+		      END { print sum + 0 }')
+	readdir_plus $DIR/$tdir > $TMP/$tfile.out ||
+		error "readdir_plus $tdir failed"
+	stack_trap "rm -f $TMP/$tfile.out"
+	after=$($LCTL get_param -n mdc.*.stats |
+		awk '/ldlm_ibits_enqueue|mds_getattr/ { sum += $2 }
+		     END { print sum + 0 }')
+
+	(( $(wc -l < $TMP/$tfile.out) == num )) ||
+		error "$(wc -l < $TMP/$tfile.out) entries != $num"
+	(( after == before )) ||
+		error "$((after - before)) getattr RPCs during readdir_plus"
+
+	# lazy size of each file, updated upon close, and its layout
+	while read name flags mode size stripes; do
+		i=${name#f}
+		[[ "$size" == "$((i * bs))" ]] ||
+			error "$name lazy size $size != $((i * bs))"
+		[[ "$stripes" == "1" ]] ||
+			error "$name stripe count '$stripes' != 1"
+	done < $TMP/$tfile.out
+
+	# entry attributes need search permission on the directory, as stat
+	[ $RUNAS_ID -eq $UID ] && return 0
+	chmod 0644 $DIR/$tdir || error "chmod $tdir failed"
+	$RUNAS $(which readdir_plus) $DIR/$tdir > /dev/null &&
+		error "readdir_plus $tdir worked without search permission"
+	return 0
+}
+run_test 24H "readdir-plus returns lazy attributes with entries"
+
+test_24I() {
+	[[ $($LCTL get_param mdc.*.import) =~ connect_flags.*readdir_plus ]] ||
+		skip "MDS does not support readdir_plus"
+
+	local num=100
+	local age=5
+	local modes=(600 640 644 660 664 666)
+	local old=$($LCTL get_param -n llite.*.readdir_plus_max_age | head -1)
+	local before
+	local after
+	local i
+
+	test_mkdir -i 0 -c 1 $DIR/$tdir || error "mkdir $tdir failed"
+	# FIFOs need neither a glimpse nor a readlink for ls -l
+	for ((i = 0; i < num; i++)); do
+		mkfifo -m ${modes[i % ${#modes[@]}]} $DIR/$tdir/p$i ||
+			error "mkfifo p$i failed"
+	done
+	cancel_lru_locks mdc
+	ls -l $DIR/$tdir > $TMP/$tfile.plain || error "ls -l $tdir failed"
+	stack_trap "rm -f $TMP/$tfile.plain $TMP/$tfile.plus"
+
+	$LCTL set_param llite.*.readdir_plus_max_age=$age
+	stack_trap "$LCTL set_param llite.*.readdir_plus_max_age=$old"
+	cancel_lru_locks mdc
+
+	before=$($LCTL get_param -n mdc.*.stats |
+		 awk '/ldlm_ibits_enqueue|mds_getattr/ { sum += $2 }
+		      END { print sum + 0 }')
+	ls -l $DIR/$tdir > $TMP/$tfile.plus || error "ls -l $tdir failed"
+	after=$($LCTL get_param -n mdc.*.stats |
+		awk '/ldlm_ibits_enqueue|mds_getattr/ { sum += $2 }
+		     END { print sum + 0 }')
+
+	diff $TMP/$tfile.plain $TMP/$tfile.plus ||
+		error "ls -l differs with readdir-plus"
+	(( after - before < num / 10 )) ||
+		error "$((after - before)) getattr RPCs for ls -l of $num"
+
+	# the dentries expire, so stat gets the attributes from the MDT again
+	sleep $((age + 1))
+	before=$after
+	stat $DIR/$tdir/p0 > /dev/null || error "stat p0 failed"
+	after=$($LCTL get_param -n mdc.*.stats |
+		awk '/ldlm_ibits_enqueue|mds_getattr/ { sum += $2 }
+		     END { print sum + 0 }')
+	(( after > before )) || error "stat p0 used expired attributes"
+}
+run_test 24I "readdir-plus sets up dentries and inodes for ls -l"
+
 test_25a() {
 	echo '== symlink sanity ============================================='
 
@@ -9927,6 +10029,31 @@ test_77o() {
 }
 run_test 77o "Verify checksum_type for server (mdt and ofd(obdfilter))"
 
+test_77p() {
+	$LCTL get_param -n osc.*.import | grep -q "wire_compress" ||
+		skip "OSTs do not support BRW compression"
+
+	local file=$DIR/$tfile
+
+	$LFS setstripe -c 1 -i 0 --compress lz4 $file ||
+		error "setstripe --compress lz4 $file failed"
+	$LFS getstripe -v $file | grep -q "lcme_compr_type:.*lz4" ||
+		error "lcme_compr_type not set on $file"
+
+	$LCTL set_param osc.*.compress_stats=clear
+	dd if=/dev/zero of=$file bs=1M count=4 oflag=direct ||
+		error "dd to $file failed"
+
+	local rpcs=$($LCTL get_param -n osc.*OST0000*.compress_stats |
+		     awk '/compressed_rpcs/ { print $2 }')
+
+	(( ${rpcs:-0} > 0 )) || error "no write RPC compressed"
+
+	cancel_lru_locks osc
+	cmp -n 4194304 /dev/zero $file || error "data mismatch in $file"
+}
+run_test 77p "Verify BRW write compression with lz4 component"
+
 cleanup_test_78() {
 	trap 0
 	rm -f $DIR/$tfile
@@ -10597,6 +10724,49 @@ test_101j() {
 }
 run_test 101j "A complete read block should be submitted when no RA"
 
+test_101k() {
+	local streams=$($LCTL get_param -n llite.*.read_ahead_streams |
+			head -n 1)
+	[[ -n "$streams" ]] || skip "multi-stream readahead is not supported"
+	stack_trap "$LCTL set_param -n llite.*.read_ahead_streams=$streams"
+
+	local mb=32
+	local cmd="o"
+	local i
+
+	$LFS setstripe -i 0 -c 1 $DIR/$tfile ||
+		error "setstripe $DIR/$tfile failed"
+	dd if=/dev/zero of=$DIR/$tfile bs=1M count=$((mb * 2)) ||
+		error "dd $DIR/$tfile failed"
+
+	# one reader interleaving two sequential streams on the same fd
+	for ((i = 0; i < mb; i++)); do
+		cmd+="z$((i * 1048576))r1048576"
+		cmd+="z$(((mb + i) * 1048576))r1048576"
+	done
+	cmd+="c"
+
+	local -a misses
+	local n
+
+	for n in 1 2; do
+		$LCTL set_param -n llite.*.read_ahead_streams=$n
+		cancel_lru_locks osc
+		$LCTL set_param -n llite.*.read_ahead_stats=0
+		$MULTIOP $DIR/$tfile $cmd || error "multiop $n streams failed"
+		misses[$n]=$($LCTL get_param -n llite.*.read_ahead_stats |
+			     get_named_value 'misses' | calc_total)
+	done
+
+	local hits=$($LCTL get_param -n llite.*.read_ahead_stats |
+		     get_named_value 'stream1_hits' | calc_total)
+
+	(( hits > 0 )) || error "no readahead hit on the second stream"
+	(( misses[2] <= misses[1] )) ||
+		error "${misses[2]} misses with 2 streams > ${misses[1]} with 1"
+}
+run_test 101k "readahead of interleaved sequential streams"
+
 setup_test102() {
 	test_mkdir $DIR/$tdir
 	chown $RUNAS_ID $DIR/$tdir
@@ -11749,6 +11919,138 @@ test_115() {
 }
 run_test 115 "verify dynamic thread creation===================="
 
+test_115b() {
+	remote_ost_nodsh && skip "remote OST with nodsh"
+
+	local param=ost.OSS.ost_io
+	local save_params="$TMP/sanity-$TESTNAME.parameters"
+
+	do_facet ost1 $LCTL get_param -n $param.threads_adaptive ||
+		skip "no adaptive service threads"
+
+	save_lustre_params ost1 "$param.threads_adaptive" > $save_params
+	stack_trap "restore_lustre_params < $save_params; rm -f $save_params"
+
+	do_facet ost1 $LCTL set_param $param.threads_adaptive_wait_us=0 &&
+		error "zero wait target should be refused"
+	do_facet ost1 $LCTL set_param $param.threads_adaptive=1 ||
+		error "failed to enable adaptive threads"
+
+	# let the controller sample a few intervals while I/O is running
+	test_mkdir $DIR/$tdir
+	$LFS setstripe -c 1 -i 0 $DIR/$tdir
+	for i in {1..8}; do
+		dd if=/dev/zero of=$DIR/$tdir/$tfile.$i bs=1M count=16 \
+			oflag=direct &
+	done
+	wait
+	sleep 3
+
+	local stats=$(do_facet ost1 $LCTL get_param -n \
+		$param.threads_adaptive_stats)
+	echo "$stats"
+	echo "$stats" | grep -E -q "decision: (hold|grow|shrink|cpu_busy)" ||
+		error "adaptive controller not running"
+
+	local tmin=$(do_facet ost1 $LCTL get_param -n $param.threads_min)
+	local tmax=$(do_facet ost1 $LCTL get_param -n $param.threads_max)
+	local started=$(do_facet ost1 $LCTL get_param -n \
+		$param.threads_started)
+	(( started >= tmin && started <= tmax )) ||
+		error "$started threads not within [$tmin, $tmax]"
+
+	do_facet ost1 $LCTL set_param $param.threads_adaptive=0
+	sleep 2
+	do_facet ost1 $LCTL get_param -n $param.threads_adaptive_stats |
+		grep -q "decision: off" || error "adaptive controller not stopped"
+}
+run_test 115b "adaptive service thread pool sizing"
+
+test_115c() {
+	remote_ost_nodsh && skip "remote OST with nodsh"
+
+	local param=ost.OSS.ost_io
+	local rif=osc.$FSNAME-OST0000*.max_rpcs_in_flight
+	local save_params="$TMP/sanity-$TESTNAME.parameters"
+	local nwriters
+	local stolen
+	local steals
+	local steals0
+	local stats
+	local i
+
+	do_facet ost1 $LCTL get_param -n $param.threads_steal ||
+		skip "no service thread work stealing"
+
+	save_lustre_params ost1 "$param.threads_steal" > $save_params
+	save_lustre_params ost1 "$param.threads_max" >> $save_params
+	save_lustre_params client "$rif" >> $save_params
+	stack_trap "restore_lustre_params < $save_params; rm -f $save_params"
+
+	do_facet ost1 $LCTL set_param $param.threads_steal=1 ||
+		skip "single CPT on ost1"
+
+	# the RPCs of a client arrive on one CPT: keep its threads busy with
+	# more RPCs than they are, so that the other CPTs steal some
+	do_facet ost1 $LCTL set_param \
+		$param.threads_max=$(do_facet ost1 $LCTL get_param -n \
+				     $param.threads_min)
+	nwriters=$(($(do_facet ost1 $LCTL get_param -n \
+		      $param.threads_started) + 16))
+	(( nwriters <= 256 )) || nwriters=256
+	$LCTL set_param $rif=$nwriters
+
+	steals0=$(do_facet ost1 $LCTL get_param -n $param.threads_steal_stats |
+		  awk '/steal_rpcs/ { n += $2 } END { print n + 0 }')
+	test_mkdir $DIR/$tdir
+	$LFS setstripe -c 1 -i 0 $DIR/$tdir
+	#define OBD_FAIL_PTLRPC_PAUSE_REQ	0x50a
+	do_facet ost1 $LCTL set_param fail_val=100 fail_loc=0x50a
+	stack_trap "do_facet ost1 $LCTL set_param fail_val=0 fail_loc=0"
+	for ((i = 1; i <= nwriters; i++)); do
+		dd if=/dev/zero of=$DIR/$tdir/$tfile.$i bs=1M count=4 \
+			oflag=direct 2> /dev/null &
+	done
+	wait
+	do_facet ost1 $LCTL set_param fail_val=0 fail_loc=0
+
+	for ((i = 1; i <= nwriters; i++)); do
+		cmp -n 4M /dev/zero $DIR/$tdir/$tfile.$i ||
+			error "$tfile.$i corrupted"
+	done
+
+	stats=$(do_facet ost1 $LCTL get_param -n $param.threads_steal_stats)
+	stolen=$(echo "$stats" | awk '/stolen_rpcs/ { n += $2 }
+				      END { print n + 0 }')
+	steals=$(echo "$stats" | awk '/steal_rpcs/ { n += $2 }
+				      END { print n + 0 }')
+	(( steals > steals0 )) || error "no RPCs stolen from the busy CPT"
+	(( stolen == steals )) ||
+		error "$stolen stolen RPCs but $steals steals"
+}
+run_test 115c "service thread work stealing between CPTs"
+
+test_115d() {
+	remote_mds_nodsh && skip "remote MDS with nodsh"
+
+	local param=mds.MDS.mdt.stats
+	local samples
+
+	do_facet $SINGLEMDS $LCTL set_param $param=clear
+	test_mkdir -i 0 $DIR/$tdir
+	createmany -o $DIR/$tdir/$tfile 100 || error "createmany failed"
+	do_facet $SINGLEMDS $LCTL set_param -n osd*.*MDT0000.force_sync=1
+	# replies are freed once acked by the client after the commit
+	wait_update_facet $SINGLEMDS \
+		"$LCTL get_param -n $param | grep -c rep_commit_free" 1 30 ||
+		error "no reply commit latency in $param"
+	samples=$(do_facet $SINGLEMDS $LCTL get_param -n $param |
+		  awk '/^rep_commit_free/ { print $2 }')
+	(( samples > 0 )) ||
+		error "no rep_commit_free samples in $param: '$samples'"
+}
+run_test 115d "reply commit to free latency is accounted"
+
 free_min_max () {
 	wait_delete_completed
 	AVAIL=($(lctl get_param -n osc.*[oO][sS][cC]-[^M]*.kbytesavail))
@@ -12359,6 +12661,74 @@ test_118n()
 }
 run_test 118n "statfs() sends OST_STATFS requests in parallel"
 
+test_118o() {
+	local osc=$($LCTL get_param -N osc.*OST0000-osc-[^mM]* | head -n1)
+	local save_params="$TMP/sanity-$TESTNAME.parameters"
+	local window
+	local grown
+	local shrunk
+	local i
+
+	$LCTL get_param -n $osc.rpcs_in_flight_auto > /dev/null ||
+		skip "no RPCs in flight auto-tuning"
+
+	save_lustre_params client "$osc.max_rpcs_in_flight" > $save_params
+	save_lustre_params client "$osc.rpcs_in_flight_min" >> $save_params
+	save_lustre_params client "$osc.rpcs_in_flight_auto" >> $save_params
+	stack_trap "restore_lustre_params < $save_params; rm -f $save_params"
+
+	$LCTL set_param $osc.max_rpcs_in_flight=8 $osc.rpcs_in_flight_min=2
+	$LCTL set_param $osc.rpcs_in_flight_auto=1
+
+	$LFS setstripe -c 1 -i 0 $DIR/$tfile || error "setstripe failed"
+	for i in {0..7}; do
+		dd if=/dev/zero of=$DIR/$tfile bs=1M count=16 seek=$((i * 16)) \
+			conv=notrunc oflag=direct &
+	done
+	wait
+
+	window=$($LCTL get_param -n $osc.rpcs_in_flight_window |
+		 awk '/^window:/ { print $2 }')
+	(( window >= 2 && window <= 8 )) ||
+		error "window $window is out of bounds [2, 8]"
+	$LCTL get_param -n $osc.rpcs_in_flight_window | grep -q "reason: start" ||
+		error "auto-tuning start not recorded"
+
+	# RPCs held on the OST take much longer than the base time
+	#define OBD_FAIL_OST_BRW_PAUSE_BULK 0x214
+	do_facet ost1 $LCTL set_param fail_loc=0x214 fail_val=1
+	stack_trap "do_facet ost1 $LCTL set_param fail_loc=0 fail_val=0"
+	for i in {0..7}; do
+		dd if=/dev/zero of=$DIR/$tfile bs=1M count=4 seek=$((i * 16)) \
+			conv=notrunc oflag=direct &
+	done
+	wait
+	do_facet ost1 $LCTL set_param fail_loc=0 fail_val=0
+
+	shrunk=$($LCTL get_param -n $osc.rpcs_in_flight_window |
+		 awk '/^shrunk:/ { print $2 }')
+	(( shrunk > 0 )) || error "window not shrunk on slow RPCs"
+	$LCTL get_param -n $osc.rpcs_in_flight_window |
+		grep -q "reason: latency" || error "latency shrink not recorded"
+
+	# back to the base time, a full window grows again
+	for i in {0..7}; do
+		dd if=/dev/zero of=$DIR/$tfile bs=1M count=32 seek=$((i * 32)) \
+			conv=notrunc oflag=direct &
+	done
+	wait
+
+	grown=$($LCTL get_param -n $osc.rpcs_in_flight_window |
+		awk '/^grown:/ { print $2 }')
+	(( grown > 0 )) || error "window not grown after slow RPCs"
+
+	$LCTL set_param $osc.max_rpcs_in_flight=1
+	window=$($LCTL get_param -n $osc.rpcs_in_flight_window |
+		 awk '/^window:/ { print $2 }')
+	(( window == 1 )) || error "window $window not lowered to new max 1"
+}
+run_test 118o "RPCs in flight auto-tuning grows, shrinks, stays in bounds"
+
 test_119a() # bug 11737
 {
         BSIZE=$((512 * 1024))
@@ -12864,6 +13234,154 @@ test_123c() {
 }
 run_test 123c "Can not initialize inode warning on DNE statahead"
 
+test_123d() {
+	[ $PARALLEL == "yes" ] && skip "skip parallel run"
+	$LCTL get_param -n mdc.$FSNAME-MDT0000*.import |
+		grep -q 'connect_flags:.*msg_batch' ||
+		skip "MDS does not support batched RPC"
+
+	local num=1000
+	local batch_max
+	local batches
+	local enqueues
+
+	test_mkdir -i 0 -c 1 $DIR/$tdir
+	createmany -m $DIR/$tdir/$tfile $num ||
+		error "createmany $DIR/$tdir/$tfile failed"
+
+	batch_max=$($LCTL get_param -n llite.*.statahead_batch_max | head -n1)
+	stack_trap "$LCTL set_param llite.*.statahead_batch_max=$batch_max"
+	$LCTL set_param llite.*.statahead_batch_max=32
+
+	cancel_lru_locks mdc
+	$LCTL set_param mdc.*.stats=clear
+	ls -l $DIR/$tdir > /dev/null || error "ls -l $DIR/$tdir failed"
+
+	batches=$(calc_stats mdc.*.stats mds_msg_batch)
+	enqueues=$(calc_stats mdc.*.stats ldlm_ibits_enqueue)
+	(( batches > 0 )) || error "statahead did not send batched RPCs"
+	(( enqueues < num / 2 )) ||
+		error "too many enqueue RPCs: $enqueues for $num files"
+}
+run_test 123d "statahead batches getattrs into one RPC"
+
+test_123e() {
+	$LCTL get_param -n llite.*.statahead_fname > /dev/null ||
+		skip "client does not support statahead by file name"
+
+	local num=1000
+	local hits
+
+	test_mkdir -i 0 -c 1 $DIR/$tdir
+	createmany -m $DIR/$tdir/$tfile. $num ||
+		error "createmany $DIR/$tdir/$tfile. failed"
+
+	stack_trap "$LCTL set_param llite.*.statahead_fname=$($LCTL get_param \
+		-n llite.*.statahead_fname | head -n1)"
+	$LCTL set_param llite.*.statahead_fname=1
+
+	cancel_lru_locks mdc
+	hits=$($LCTL get_param -n llite.*.statahead_stats |
+	       awk '/^fname total/ { print $5 }')
+	# stat the files by name without readdir, in two processes whose
+	# stats interleave, each following its own sequence of names
+	stat $(seq -f "$DIR/$tdir/$tfile.%g" 0 $((num / 2 - 1))) \
+		> /dev/null &
+	local pid=$!
+	stat $(seq -f "$DIR/$tdir/$tfile.%g" $((num / 2)) $((num - 1))) \
+		> /dev/null || error "stat $DIR/$tdir/$tfile.* failed"
+	wait $pid || error "stat $DIR/$tdir/$tfile.* failed"
+
+	hits=$(($($LCTL get_param -n llite.*.statahead_stats |
+		  awk '/^fname total/ { print $5 }') - hits))
+	echo "statahead by file name hits: $hits"
+	(( hits > num / 2 )) ||
+		error "statahead by file name hit $hits times for $num files"
+}
+run_test 123e "statahead detects file names with increasing index"
+
+test_123f() {
+	which statahead_names || skip_env "no statahead_names program"
+
+	local num=1000
+	local stats
+	local total
+	local hits
+
+	test_mkdir -i 0 -c 1 $DIR/$tdir
+	createmany -m $DIR/$tdir/$tfile. $num ||
+		error "createmany $DIR/$tdir/$tfile. failed"
+
+	cancel_lru_locks mdc
+	stats=($($LCTL get_param -n llite.*.statahead_stats |
+		 awk '/^advise total/ { print $3, $5 }'))
+	# names in random order, so that only the given list can predict them
+	statahead_names $DIR/$tdir $(seq -f "$tfile.%g" 0 $((num - 1)) |
+				     shuf) ||
+		error "statahead_names $DIR/$tdir failed"
+
+	total=($($LCTL get_param -n llite.*.statahead_stats |
+		 awk '/^advise total/ { print $3, $5 }'))
+	hits=$((total[1] - stats[1]))
+	total=$((total[0] - stats[0]))
+	echo "statahead by given names threads: $total hits: $hits"
+	(( total == 1 )) ||
+		error "$total statahead threads started for the given names"
+	(( hits > num / 2 )) ||
+		error "statahead by given names hit $hits times for $num files"
+
+	# looking up the names needs search permission on the directory
+	[ $RUNAS_ID -eq $UID ] && return 0
+	chmod 0644 $DIR/$tdir || error "chmod $tdir failed"
+	cancel_lru_locks mdc
+	stats=$($LCTL get_param -n llite.*.statahead_stats |
+		awk '/^advise total/ { print $3 }')
+	$RUNAS $(which statahead_names) $DIR/$tdir $tfile.0 $tfile.1 &&
+		error "statahead_names $tdir worked without search permission"
+	total=$($LCTL get_param -n llite.*.statahead_stats |
+		awk '/^advise total/ { print $3 }')
+	(( total == stats )) ||
+		error "statahead started without search permission"
+	return 0
+}
+run_test 123f "statahead prefetches the names given by the user"
+
+test_123g() {
+	[ $PARALLEL == "yes" ] && skip "skip parallel run"
+	$LCTL get_param -n mdc.$FSNAME-MDT0000*.import |
+		grep -q 'connect_flags:.*msg_batch' ||
+		skip "MDS does not support batched RPC"
+
+	local ns="ldlm.namespaces.mdt-$FSNAME-MDT0000*.lock_count"
+	local num=1000
+	local batch_max
+	local locks
+
+	test_mkdir -i 0 -c 1 $DIR/$tdir
+	createmany -m $DIR/$tdir/$tfile $num ||
+		error "createmany $DIR/$tdir/$tfile failed"
+
+	batch_max=$($LCTL get_param -n llite.*.statahead_batch_max | head -n1)
+	stack_trap "$LCTL set_param llite.*.statahead_batch_max=$batch_max"
+	$LCTL set_param llite.*.statahead_batch_max=32
+
+	cancel_lru_locks mdc
+	locks=$(do_facet mds1 $LCTL get_param -n $ns)
+
+	#define OBD_FAIL_MDS_BATCH_REPLY_SHORT	0x16e
+	do_facet mds1 $LCTL set_param fail_loc=0x16e
+	stack_trap "do_facet mds1 $LCTL set_param fail_loc=0"
+	# the sub-requests without reply room are not executed
+	ls -l $DIR/$tdir > /dev/null || error "ls -l $DIR/$tdir failed"
+	do_facet mds1 $LCTL set_param fail_loc=0
+
+	# and were not granted locks the client does not know about
+	cancel_lru_locks mdc
+	wait_update_facet mds1 "$LCTL get_param -n $ns" $locks ||
+		error "MDT locks left after the batched reply was full"
+}
+run_test 123g "batched getattrs are not executed without reply room"
+
 test_124a() {
 	[ $PARALLEL == "yes" ] && skip "skip parallel run"
 	$LCTL get_param -n mdc.*.connect_flags | grep -q lru_resize ||
@@ -14220,6 +14738,84 @@ test_133h() {
 }
 run_test 133h "Proc files should end with newlines"
 
+test_133i() {
+	[ $PARALLEL == "yes" ] && skip "skip parallel run"
+	remote_ost_nodsh && skip "remote OST with nodsh"
+
+	local hist
+
+	$LFS setstripe -c 1 -i 0 $DIR/$tfile
+	do_facet ost1 $LCTL set_param obdfilter.*.stats=clear
+
+	dd if=/dev/zero of=$DIR/$tfile bs=1M count=4 oflag=direct ||
+		error "dd failed"
+
+	hist=$(do_facet ost1 $LCTL get_param -n obdfilter.*OST0000*.stats_hist)
+	echo "$hist" | grep -A 2 "^write_bytes:" | grep -q "samples: *4$" ||
+		error "no write_bytes histogram"
+	echo "$hist" | grep -A 10 "^write_bytes:" | grep -q "p99: *2097152$" ||
+		error "wrong write_bytes p99"
+
+	hist=$(do_facet ost1 $LCTL get_param -n ost.OSS.ost_io.stats_hist)
+	echo "$hist" | grep -q "^req_service:" ||
+		error "no req_service histogram"
+
+	[[ "$ost1_FSTYPE" == ldiskfs ]] || return 0
+
+	hist=$(do_facet ost1 $LCTL get_param -n osd-*.*OST0000*.stats_hist)
+	echo "$hist" | grep -q "^write_io_time:" ||
+		error "no write_io_time histogram"
+}
+run_test 133i "Verify lprocfs counter histograms"
+
+test_133j() {
+	remote_ost_nodsh && skip "remote OST with nodsh"
+	[[ "$ost1_FSTYPE" == ldiskfs ]] || skip "ldiskfs only"
+
+	local param=/sys/module/osd_ldiskfs/parameters/osd_bulk_pool_mb
+	local pool_mb=16
+	local old_mb
+	local page_size
+	local pool
+	local hits
+
+	old_mb=$(do_facet ost1 cat $param) || skip "no bulk page pool"
+	page_size=$(do_facet ost1 getconf PAGE_SIZE)
+
+	# pools are filled by the first OST set up, pages are taken from
+	# them by the new ost_io threads
+	stack_trap "do_facet ost1 'echo $old_mb > $param'; stopall; setupall" \
+		EXIT
+	do_facet ost1 "echo $pool_mb > $param" ||
+		error "cannot set osd_bulk_pool_mb"
+	stopall
+	setupall
+
+	pool=$(do_facet ost1 $LCTL get_param -n \
+		osd-ldiskfs.*OST0000*.bulk_page_pool)
+	echo "$pool" | awk -v max=$((pool_mb * 1048576 / page_size)) '
+		NR == 1 { next }
+		$2 != max || $3 > $2 { bad = 1 }
+		END { exit (NR < 2 || bad) }' ||
+		error "bad bulk_page_pool, expected $pool_mb MiB per cpt"
+
+	set_osd_param $(facet_active_host ost1) '' read_cache_enable 0
+	set_osd_param $(facet_active_host ost1) '' writethrough_cache_enable 0
+	$LFS setstripe -c 1 -i 0 $DIR/$tfile
+	dd if=/dev/zero of=$DIR/$tfile bs=1M count=4 oflag=direct ||
+		error "dd failed"
+
+	hits=$(do_facet ost1 $LCTL get_param -n osd-ldiskfs.*OST0000*.stats |
+	       awk '/^bulk_pool_hit / { print $2 }')
+	(( hits > 0 )) || error "no pages taken from the bulk page pool"
+
+	# the MDTs never use it
+	do_facet mds1 $LCTL get_param -n osd-ldiskfs.*MDT0000*.stats |
+		grep -q "^bulk_pool" && error "MDT used the bulk page pool"
+	return 0
+}
+run_test 133j "Verify osd-ldiskfs bulk page pool"
+
 test_134a() {
 	remote_mds_nodsh && skip "remote MDS with nodsh"
 	[[ $MDS1_VERSION -lt $(version_code 2.7.54) ]] &&
@@ -18348,6 +18944,60 @@ test_205c() {
 }
 run_test 205c "Verify client stats format"
 
+test_205d() {
+	which jobstats_ring || skip_env "no jobstats_ring program"
+
+	local old_jobvar=$($LCTL get_param -n jobid_var)
+	local old_jobname=$($LCTL get_param -n jobid_name)
+	local jobid=id.$testnum.$RANDOM
+	local ring
+
+	stack_trap "$LCTL set_param jobid_var=$old_jobvar \
+		    jobid_name=$old_jobname" EXIT
+	$LCTL set_param jobid_var=nodelocal jobid_name=$jobid
+	stack_trap "$LCTL set_param llite.*.job_stats_enable=0" EXIT
+	$LCTL set_param llite.*.job_stats_enable=1
+
+	$LFS setstripe -c 1 -i 0 $DIR/$tfile
+	$LCTL set_param llite.*.job_stats=clear osc.*.job_stats=clear
+	dd if=/dev/zero of=$DIR/$tfile bs=4k count=1 oflag=sync ||
+		error "dd failed"
+
+	$LCTL get_param -n llite.*.job_stats | grep -A 30 "job_id:.*$jobid" |
+		grep -q "write_bytes:.*samples: *1,.*max: *4096" ||
+		error "no llite job stats for $jobid"
+
+	$LCTL get_param -n osc.*OST0000*.job_stats |
+		grep -A 10 "job_id:.*$jobid" |
+		grep -q "write:.*samples: *1,.*hist: { [0-9]*: 1 }" ||
+		error "no osc job stats for $jobid"
+
+	# "jobid counter count min max sum hist"
+	ring=$(ls /proc/fs/lustre/llite/*/job_stats_ring | head -1)
+	[[ -n "$ring" ]] || error "no llite job_stats_ring found"
+	jobstats_ring $ring > $TMP/$tfile.llite ||
+		error "bad records in $ring"
+	stack_trap "rm -f $TMP/$tfile.llite $TMP/$tfile.osc" EXIT
+	grep -q "^$jobid write_bytes 1 4096 4096 4096 -$" $TMP/$tfile.llite ||
+		error "no write_bytes record for $jobid in $ring"
+	grep -q "^$jobid write 1 [0-9]* [0-9]* [0-9]* 1$" $TMP/$tfile.llite ||
+		error "no write latency histogram for $jobid in $ring"
+
+	ring=$(ls /proc/fs/lustre/osc/*OST0000*/job_stats_ring | head -1)
+	[[ -n "$ring" ]] || error "no osc job_stats_ring found"
+	jobstats_ring $ring > $TMP/$tfile.osc || error "bad records in $ring"
+	grep -q "^$jobid write_bytes 1 4096 4096 4096 -$" $TMP/$tfile.osc ||
+		error "no write_bytes record for $jobid in $ring"
+	grep -q "^$jobid write 1 [0-9]* [0-9]* [0-9]* 1$" $TMP/$tfile.osc ||
+		error "no write latency histogram for $jobid in $ring"
+
+	# records are consumed, and unchanged jobs are not published again
+	jobstats_ring $ring | grep -q "^$jobid " &&
+		error "$jobid published again without updates"
+	return 0
+}
+run_test 205d "Verify client job stats"
+
 # LU-1480, LU-1773 and LU-1657
 test_206() {
 	mkdir -p $DIR/$tdir
@@ -20302,6 +20952,48 @@ test_231b() {
 }
 run_test 231b "must not assert on fully utilized OST request buffer"
 
+test_231c() {
+	[ "$ost1_FSTYPE" == "ldiskfs" ] || skip "ldiskfs only test"
+
+	local max_pages=$($LCTL get_param -n osc.*.max_pages_per_rpc | head -n1)
+	local pages=$((max_pages / 2))
+	local i
+
+	(( pages > 256 )) || skip "max_pages_per_rpc $max_pages is too small"
+
+	$LCTL get_param -n osc.*.write_coalesce > /dev/null ||
+		skip "no write_coalesce support"
+
+	$LFS setstripe -c 1 -i 0 $DIR/$tfile || error "setstripe failed"
+	$LCTL set_param osc.*.write_coalesce=1
+	$LCTL set_param -n osc.*.rpc_stats=0
+	stop_writeback
+
+	# one discontiguous page out of two, all in a single write RPC
+	for ((i = 0; i < pages; i++)); do
+		dd if=/dev/zero of=$DIR/$tfile conv=notrunc bs=$PAGE_SIZE \
+			seek=$((2 * i)) count=1 &>/dev/null || break
+	done
+	sync
+
+	start_writeback
+	$LCTL set_param osc.*.write_coalesce=0
+	(( i == pages )) || error "dd seek=$((2 * i)) failed"
+
+	local stats=$($LCTL get_param -n osc.*-OST0000-*.rpc_stats)
+	local niobufs=$(echo "$stats" |
+			awk '/avg write niobufs:/ { print int($4) }')
+	local rpcs=$(echo "$stats" |
+		     awk '/niobufs per rpc/ { nio = 1; next }
+			  nio && /^[0-9]+:/ { sum += $6 }
+			  END { print sum + 0 }')
+
+	(( rpcs == 1 )) || error "$rpcs write RPCs, not 1"
+	(( niobufs == pages )) ||
+		error "$niobufs niobufs per write RPC, not $pages"
+}
+run_test 231c "discontiguous writes are coalesced with write_coalesce"
+
 test_232a() {
 	mkdir -p $DIR/$tdir
 	$LFS setstripe -c1 -i0 $DIR/$tdir/$tfile
@@ -22609,6 +23301,36 @@ test_273b() {
 }
 run_test 273b "DoM: race writeback and object destroy"
 
+test_274() {
+	local osc="osc.$FSNAME-OST0000-osc-[^mM]*"
+
+	$LCTL get_param -n $osc.lru_shards > /dev/null 2>&1 ||
+		skip "osc LRU shards not supported"
+
+	$LFS setstripe -c 1 -i 0 $DIR/$tfile || error "setstripe failed"
+	cancel_lru_locks osc
+	dd if=/dev/zero of=$DIR/$tfile bs=1M count=4 conv=fsync ||
+		error "dd failed"
+	$LCTL get_param $osc.lru_shards
+
+	local page_size=$(get_page_size client)
+	local pages=$($LCTL get_param -n $osc.lru_shards |
+		      awk '/ in_list:| busy:/ { n += $2 } END { print n }')
+	local used=$($LCTL get_param -n $osc.osc_cached_mb |
+		     awk '/^used_mb:/ { print $2 }')
+
+	(( pages * page_size >= 4 * 1048576 )) ||
+		error "only $pages pages in LRU shards after 4MiB write"
+	(( pages * page_size / 1048576 == used )) ||
+		error "LRU shards have $pages pages, osc_cached_mb $used MiB"
+
+	cancel_lru_locks osc
+	pages=$($LCTL get_param -n $osc.lru_shards |
+		awk '/ in_list:/ { n += $2 } END { print n }')
+	(( pages == 0 )) || error "$pages pages left in LRU shards"
+}
+run_test 274 "per-CPT osc LRU shards account cached pages"
+
 test_275() {
 	remote_ost_nodsh && skip "remote OST with nodsh"
 	[ $OST1_VERSION -lt $(version_code 2.10.57) ] &&
@@ -24366,6 +25088,97 @@ test_398n() { #  LU-13798
 }
 run_test 398n "test append with parallel DIO"
 
+test_398o() {
+	local dio_file=$DIR/$tfile.dio
+
+	$LCTL get_param -n llite.*.unaligned_dio > /dev/null ||
+		skip "client does not support unaligned DIO"
+
+	$LFS setstripe -C 2 -S 1M $DIR/$tfile $dio_file
+	stack_trap "rm -f $DIR/$tfile $dio_file"
+
+	dd if=/dev/urandom of=$DIR/$tfile bs=1M count=9 ||
+		error "dd to create source file failed"
+
+	# write in record sizes which are neither page nor stripe aligned,
+	# so chunks span stripes and start and end mid-page
+	dd if=$DIR/$tfile of=$dio_file bs=1000003 oflag=direct ||
+		error "unaligned dio write failed"
+	cancel_lru_locks osc
+	cmp $DIR/$tfile $dio_file || error "file diff after unaligned dio write"
+
+	# unaligned dio read back, with and without parallel dio
+	dd if=$dio_file of=$DIR/$tfile.2 bs=7777 iflag=direct ||
+		error "unaligned dio read failed"
+	stack_trap "rm -f $DIR/$tfile.2"
+	cmp $DIR/$tfile $DIR/$tfile.2 ||
+		error "file diff after unaligned dio read"
+
+	local parallel=$($LCTL get_param -n llite.*.parallel_dio | head -n1)
+
+	$LCTL set_param llite.*.parallel_dio=0
+	stack_trap "$LCTL set_param llite.*.parallel_dio=$parallel"
+	dd if=$dio_file of=$DIR/$tfile.2 bs=1000003 iflag=direct skip=1 seek=1 ||
+		error "unaligned non-parallel dio read failed"
+	cmp $DIR/$tfile $DIR/$tfile.2 ||
+		error "file diff after unaligned non-parallel dio read"
+
+	$LCTL set_param llite.*.unaligned_dio=0
+	stack_trap "$LCTL set_param llite.*.unaligned_dio=1"
+	dd if=$DIR/$tfile of=$dio_file bs=4097 count=1 oflag=direct &&
+		error "unaligned dio write should fail when disabled"
+	true
+}
+run_test 398o "verify unaligned dio via bounce pages"
+
+test_398p() {
+	$LCTL get_param -n llite.*.hybrid_io > /dev/null ||
+		skip "client does not support hybrid IO"
+
+	local hybrid=$($LCTL get_param -n llite.*.hybrid_io | head -n1)
+	local rthresh=$($LCTL get_param -n \
+		llite.*.hybrid_io_read_threshold_bytes | head -n1)
+	local wthresh=$($LCTL get_param -n \
+		llite.*.hybrid_io_write_threshold_bytes | head -n1)
+
+	stack_trap "$LCTL set_param llite.*.hybrid_io=$hybrid \
+		llite.*.hybrid_io_read_threshold_bytes=$rthresh \
+		llite.*.hybrid_io_write_threshold_bytes=$wthresh"
+	$LCTL set_param llite.*.hybrid_io=1 \
+		llite.*.hybrid_io_read_threshold_bytes=1M \
+		llite.*.hybrid_io_write_threshold_bytes=1M
+
+	$LFS setstripe -C 2 -S 1M $DIR/$tfile
+	stack_trap "rm -f $DIR/$tfile $TMP/$tfile"
+	dd if=/dev/urandom of=$TMP/$tfile bs=4M count=4 ||
+		error "dd to create source file failed"
+
+	$LCTL set_param llite.*.stats=clear
+	dd if=$TMP/$tfile of=$DIR/$tfile bs=4M count=4 ||
+		error "hybrid write failed"
+	local bytes=$($LCTL get_param -n llite.*.stats |
+		      awk '/^hybrid_write_bytes/ { print $7 }')
+	(( bytes == 16777216 )) ||
+		error "hybrid_write_bytes $bytes != 16777216"
+
+	# small writes must still go through the page cache
+	dd if=$TMP/$tfile of=$DIR/$tfile bs=64k count=1 conv=notrunc ||
+		error "small write failed"
+	bytes=$($LCTL get_param -n llite.*.stats |
+		awk '/^hybrid_write_bytes/ { print $7 }')
+	(( bytes == 16777216 )) || error "small write switched to DIO"
+
+	cancel_lru_locks osc
+	dd if=$DIR/$tfile of=/dev/null bs=4M ||
+		error "hybrid read failed"
+	bytes=$($LCTL get_param -n llite.*.stats |
+		awk '/^hybrid_read_bytes/ { print $7 }')
+	(( bytes == 16777216 )) ||
+		error "hybrid_read_bytes $bytes != 16777216"
+	cmp $TMP/$tfile $DIR/$tfile || error "data mismatch after hybrid IO"
+}
+run_test 398p "switch large buffered IO to DIO with hybrid_io"
+
 test_fake_rw() {
 	local read_write=$1
 	if [ "$read_write" = "write" ]; then
@@ -26323,6 +27136,65 @@ test_432() {
 }
 run_test 432 "mv dir from outside Lustre"
 
+test_433() {
+	local ll_opencache_hold_ms="llite.*.opencache_hold_ms"
+	local llite_stats="llite.$FSNAME-*.stats"
+	local mdc_rpcstats="mdc.$FSNAME-MDT0000-*.stats"
+	local old_hold=$($LCTL get_param -n $ll_opencache_hold_ms | head -1)
+	local hits
+	local closes
+
+	[[ -n "$old_hold" ]] || skip "client does not have opencache_hold_ms"
+
+	set_opencache 1
+	stack_trap "restore_opencache"
+	$LCTL set_param $ll_opencache_hold_ms=3000
+	stack_trap "$LCTL set_param $ll_opencache_hold_ms=$old_hold"
+
+	touch $DIR/$tfile || error "touch $tfile failed"
+	cancel_lru_locks mdc
+	$LCTL set_param $llite_stats=clear $mdc_rpcstats=clear
+
+	for i in {1..10}; do
+		$MULTIOP $DIR/$tfile oc || error "multiop failed"
+	done
+
+	hits=$(calc_stats $llite_stats opencache_hit)
+	closes=$(calc_stats $mdc_rpcstats mds_close)
+	echo "$hits cached opens, $closes close RPCs"
+	(( hits >= 8 )) || error "only $hits of 10 opens reused the handle"
+	(( closes == 0 )) || error "$closes close RPCs with a cached handle"
+
+	# the cached handle is closed once unused for opencache_hold_ms
+	sleep 5
+	closes=$(calc_stats $mdc_rpcstats mds_close)
+	(( closes == 1 )) || error "$closes close RPCs after opencache_hold_ms"
+}
+run_test 433 "open handles are cached for opencache_hold_ms"
+
+test_434() {
+	local kmod=$LUSTRE/tests/kernel/kldlm_res.ko
+	local run_id=$RANDOM
+	local obd
+
+	[ -f $kmod ] || skip "Need MODULES build"
+
+	obd=$($LCTL dl | awk '/ osc / { print $4; exit }')
+	[[ -n "$obd" ]] || skip "no OSC device"
+
+	# The module does not stay loaded, it looks up resources from all
+	# CPUs in the namespace of the first OSC, and prints the lookup rate
+	# only if every lookup returned the resource created for its name.
+	insmod $kmod run_id=$run_id obdname=$obd nres=4096 loops=200000 \
+		&> /dev/null
+
+	dmesg | grep "lustre_kldlm_res_$run_id:" ||
+		error "no output from kldlm_res"
+	dmesg | grep -q "lustre_kldlm_res_$run_id:.* lookups/s" ||
+		error "ldlm resource lookup returned a wrong resource or failed"
+}
+run_test 434 "ldlm resource lookup finds the right resource on all CPUs"
+
 prep_801() {
 	[[ $MDS1_VERSION -lt $(version_code 2.9.55) ]] ||
 	[[ $OST1_VERSION -lt $(version_code 2.9.55) ]] &&
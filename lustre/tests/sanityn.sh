@@ -4429,6 +4429,168 @@ test_77o() {
 }
 run_test 77o "Changing rank should not panic"
 
+# bytes served by the NRS WFQ class $1 of ost_io on ost1
+nrs_wfq_served_bytes() {
+	do_facet ost1 $LCTL get_param -n ost.OSS.ost_io.nrs_wfq_stats |
+		awk -v class=$1 '$2 == "class:" { found = $3 == class }
+				 found && $1 == "served_bytes:" { sum += $2 }
+				 END { print sum + 0 }'
+}
+
+test_77p() {
+	local oss=$(comma_list $(osts_nodes))
+	local ddcopy=$TMP/wfq_dd
+	local dir=$DIR/$tdir.wfq
+	local pids_dd=()
+	local dd0
+	local def0
+	local dd
+	local def
+	local rc=0
+	local i
+
+	# jobid of the dd copy is wfq_dd.<uid>, which is in the default class
+	local saved_jobid_var=$($LCTL get_param -n jobid_var)
+	if [ $saved_jobid_var != procname_uid ]; then
+		set_persistent_param_and_check client \
+			"jobid_var" "$FSNAME.sys.jobid_var" procname_uid
+		stack_trap "set_persistent_param_and_check client \
+			jobid_var $FSNAME.sys.jobid_var $saved_jobid_var" EXIT
+	fi
+
+	do_nodes $oss $LCTL set_param \
+		ost.OSS.ost_io.nrs_policies="wfq\ jobid" || rc=$?
+	[[ $rc -eq 3 ]] && skip "no NRS WFQ exists"
+	[[ $rc -ne 0 ]] && error "failed to set WFQ jobid policy"
+	stack_trap "do_nodes $oss $LCTL set_param \
+		ost.OSS.ost_io.nrs_policies=fifo" EXIT
+
+	do_facet ost1 $LCTL set_param \
+		ost.OSS.ost_io.nrs_wfq_rule="start\ dd_class\ jobid={dd.*}\ weight=4" ||
+		error "failed to start WFQ rule"
+	do_facet ost1 $LCTL set_param \
+		ost.OSS.ost_io.nrs_wfq_rule="start\ dd_class\ jobid={dd.*}" &&
+		error "WFQ rule should not be started twice"
+	do_facet ost1 $LCTL set_param \
+		ost.OSS.ost_io.nrs_wfq_rule="stop\ default" &&
+		error "default WFQ class should not be stopped"
+	do_facet ost1 $LCTL get_param -n ost.OSS.ost_io.nrs_wfq_rule |
+		grep -q "dd_class jobid={dd.\*} weight=4" ||
+		error "WFQ rule not listed"
+
+	nrs_write_read
+
+	# weights only matter while the classes compete for the service, so
+	# serve one ost_io request at a time and keep both classes queued
+	cp $(which dd) $ddcopy || error "cp dd failed"
+	stack_trap "rm -f $ddcopy"
+	mkdir $dir || error "mkdir $dir failed"
+	stack_trap "rm -rf $dir"
+	$LFS setstripe -c 1 -i 0 $dir || error "setstripe $dir failed"
+	local rif=osc.$FSNAME-OST0000*.max_rpcs_in_flight
+	local max_rpcs=$($LCTL get_param -n $rif | head -n1)
+
+	$LCTL set_param $rif=32
+	stack_trap "$LCTL set_param $rif=$max_rpcs"
+
+	dd0=$(nrs_wfq_served_bytes dd_class)
+	def0=$(nrs_wfq_served_bytes default)
+	#define OBD_FAIL_PTLRPC_OST_IO_SERIAL	0x535
+	do_facet ost1 $LCTL set_param fail_loc=0x535
+	stack_trap "do_facet ost1 $LCTL set_param fail_loc=0"
+	for i in {1..8}; do
+		dd if=/dev/zero of=$dir/dd$i bs=1M count=16 oflag=direct \
+			2> /dev/null &
+		pids_dd+=($!)
+		$ddcopy if=/dev/zero of=$dir/def$i bs=1M count=16 \
+			oflag=direct 2> /dev/null &
+	done
+	wait ${pids_dd[@]} || error "dd in dd_class failed"
+	dd=$(($(nrs_wfq_served_bytes dd_class) - dd0))
+	def=$(($(nrs_wfq_served_bytes default) - def0))
+	do_facet ost1 $LCTL set_param fail_loc=0
+	wait
+
+	echo "served dd_class (weight 4): $dd bytes, default: $def bytes"
+	(( def > 0 )) || error "default class starved"
+	(( dd >= 2 * def )) ||
+		error "dd_class served $dd bytes, default $def, weights 4:1"
+
+	do_facet ost1 $LCTL set_param \
+		ost.OSS.ost_io.nrs_wfq_rule="change\ dd_class\ weight=2" ||
+		error "failed to change WFQ rule"
+	do_facet ost1 $LCTL set_param ost.OSS.ost_io.nrs_wfq_quantum=65536 ||
+		error "failed to set WFQ quantum"
+	nrs_write_read
+
+	do_facet ost1 $LCTL set_param \
+		ost.OSS.ost_io.nrs_wfq_rule="stop\ dd_class" ||
+		error "failed to stop WFQ rule"
+	nrs_write_read
+}
+run_test 77p "check WFQ jobid NRS policy"
+
+test_77q() {
+	local rc=0
+
+	do_facet mds1 $LCTL set_param mds.MDS.mdt.nrs_policies="edf" || rc=$?
+	[[ $rc -eq 3 ]] && skip "no NRS EDF exists"
+	[[ $rc -ne 0 ]] && error "failed to set EDF policy"
+	stack_trap "do_facet mds1 $LCTL set_param \
+		mds.MDS.mdt.nrs_policies=fifo" EXIT
+
+	do_facet mds1 $LCTL set_param mds.MDS.mdt.nrs_edf_rule=\
+"start\ getattr\ opcode={mds_getattr\ ldlm_enqueue}\ slo_ms=10" ||
+		error "failed to start EDF rule"
+	do_facet mds1 $LCTL set_param \
+		mds.MDS.mdt.nrs_edf_rule="stop\ default" &&
+		error "default EDF class should not be stopped"
+	do_facet mds1 $LCTL set_param \
+		mds.MDS.mdt.nrs_edf_rule="change\ default\ slo_ms=2000" ||
+		error "failed to change default EDF class"
+	do_facet mds1 $LCTL get_param -n mds.MDS.mdt.nrs_edf_rule |
+		grep -q "getattr opcode={mds_getattr ldlm_enqueue} slo_ms=10" ||
+		error "EDF rule not listed"
+	do_facet mds1 $LCTL set_param mds.MDS.mdt.nrs_edf_rule=\
+"start\ readdir\ opcode={mds_readpage}\ slo_ms=20" ||
+		error "failed to start second EDF rule"
+
+	# classes are matched newest first, the default class last
+	local order=$(do_facet mds1 $LCTL get_param -n \
+		mds.MDS.mdt.nrs_edf_rule |
+		awk '/^CPT/ { n++; next } n == 1 && !/:$/ { print $1 }' |
+		xargs)
+	[[ "$order" == "readdir getattr default" ]] ||
+		error "EDF classes in wrong order: '$order'"
+
+	do_facet mds1 $LCTL set_param mds.MDS.mdt.nrs_edf_stats=clear ||
+		error "failed to clear EDF stats"
+
+	test_mkdir $DIR1/$tdir
+	createmany -o $DIR1/$tdir/f- 100 || error "createmany failed"
+	cancel_lru_locks mdc
+	ls -l $DIR2/$tdir > /dev/null || error "ls failed"
+	stat $DIR2/$tdir/f-* > /dev/null || error "stat failed"
+
+	local served=$(do_facet mds1 $LCTL get_param -n \
+		mds.MDS.mdt.nrs_edf_stats |
+		awk '/class: getattr/ { found = 1 }
+		     found && /served_rpcs/ { sum += $2; found = 0 }
+		     END { print sum + 0 }')
+	(( served > 0 )) || error "no RPCs served for getattr class"
+	do_facet mds1 $LCTL get_param -n mds.MDS.mdt.nrs_edf_stats |
+		grep -q "p999_usec" || error "no EDF latency percentiles"
+
+	do_facet mds1 $LCTL set_param \
+		mds.MDS.mdt.nrs_edf_rule="stop\ getattr" ||
+		error "failed to stop EDF rule"
+	do_facet mds1 $LCTL set_param \
+		mds.MDS.mdt.nrs_edf_rule="stop\ readdir" ||
+		error "failed to stop second EDF rule"
+	unlinkmany $DIR1/$tdir/f- 100 || error "unlinkmany failed"
+}
+run_test 77q "check EDF NRS policy"
+
 test_78() { #LU-6673
 	local rc
 
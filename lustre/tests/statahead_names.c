@@ -0,0 +1,76 @@
+/*
+ * GPL HEADER START
+ *
+ * DO NOT ALTER OR REMOVE COPYRIGHT NOTICES OR THIS FILE HEADER.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 only,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License version 2 for more details (a copy is included
+ * in the LICENSE file that accompanied this code).
+ *
+ * You should have received a copy of the GNU General Public License
+ * version 2 along with this program; If not, see
+ * http://www.gnu.org/licenses/gpl-2.0.html
+ *
+ * GPL HEADER END
+ */
+/*
+ * This file is part of Lustre, http://www.lustre.org/
+ */
+
+/*
+ * Gives the names of the files to stat in a directory to statahead with
+ * llapi_statahead_names(), then stats them in the same order.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <lustre/lustreapi.h>
+
+int main(int argc, char **argv)
+{
+	struct stat st;
+	int rc = 0;
+	int fd;
+	int i;
+
+	if (argc < 3) {
+		fprintf(stderr, "usage: %s <dir> <name>...\n", argv[0]);
+		return 1;
+	}
+
+	fd = open(argv[1], O_RDONLY | O_DIRECTORY);
+	if (fd < 0) {
+		fprintf(stderr, "open(%s) error: %s\n", argv[1],
+			strerror(errno));
+		return 1;
+	}
+
+	if (llapi_statahead_names(fd, argc - 2, (const char **)argv + 2)) {
+		fprintf(stderr, "statahead_names(%s) error: %s\n", argv[1],
+			strerror(errno));
+		close(fd);
+		return 1;
+	}
+
+	for (i = 2; i < argc; i++) {
+		if (fstatat(fd, argv[i], &st, 0) < 0) {
+			fprintf(stderr, "stat(%s/%s) error: %s\n", argv[1],
+				argv[i], strerror(errno));
+			rc = 1;
+		}
+	}
+
+	close(fd);
+
+	return rc;
+}
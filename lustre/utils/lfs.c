@@ -196,6 +196,7 @@ static inline int lfs_mirror_delete(int argc, char **argv)
 	"                 [--stripe-index|-i START_OST_IDX]\n"		\
 	"                 [--stripe-size|-S STRIPE_SIZE]\n"		\
 	"                 [--extension-size|--ext-size|-z]\n"		\
+	"                 [--compress COMPRESS_TYPE]\n"		\
 	"                 [--help|-h] [--layout|-L PATTERN]\n"		\
 	"                 [--mirror_count|-N[MIRROR_COUNT]]\n"		\
 	"                 [--ost|-o OST_INDICES]\n"			\
@@ -216,6 +217,9 @@ static inline int lfs_mirror_delete(int argc, char **argv)
 	"\t              Number of bytes the previous component is extended\n" \
 	"\t              each time. Optional K, M, or G suffix (for KB,\n"     \
 	"\t              MB, GB respectively)\n"			       \
+	"\tCOMPRESS_TYPE:\n"						       \
+	"\t              Algorithm compressing the data written to OSTs\n"  \
+	"\t              over the network: none, lz4 or zstd (default none)\n"\
 	"\tPOOL_NAME:    Name of OST pool to use (default none)\n"	       \
 	"\tLAYOUT:       stripe pattern type: raid0, mdt (default raid0)\n"    \
 	"\tOST_INDICES:  List of OST indices, can be repeated multiple times\n"\
@@ -2645,6 +2649,7 @@ struct lfs_setstripe_args {
 	bool			 lsa_extension_comp;
 	__u32			*lsa_tgts;
 	char			*lsa_pool_name;
+	enum ll_compr_type	 lsa_compr_type;
 };
 
 static inline void setstripe_args_init(struct lfs_setstripe_args *lsa)
@@ -2696,6 +2701,7 @@ static inline bool setstripe_args_specified(struct lfs_setstripe_args *lsa)
 		lsa->lsa_stripe_count != LLAPI_LAYOUT_DEFAULT ||
 		lsa->lsa_stripe_off != LLAPI_LAYOUT_DEFAULT ||
 		lsa->lsa_pattern != LLAPI_LAYOUT_RAID0 ||
+		lsa->lsa_compr_type != LL_COMPR_TYPE_NONE ||
 		lsa->lsa_comp_end != 0);
 }
 
@@ -2920,6 +2926,14 @@ new_comp:
 		}
 	}
 
+	rc = llapi_layout_compress_set(layout, lsa->lsa_compr_type);
+	if (rc) {
+		fprintf(stderr, "Set compression type %s failed: %s\n",
+			ll_compr_type2name(lsa->lsa_compr_type),
+			strerror(errno));
+		return rc;
+	}
+
 	rc = lsa_args_stripe_count_check(lsa);
 	if (rc)
 		return rc;
@@ -3093,6 +3107,17 @@ static int build_layout_from_yaml_node(struct cYAML *node,
 					 * the layout for a new file
 					 */
 					lsa->lsa_comp_flags &= LCME_TEMPLATE_FLAGS;
+				} else if (!strcmp(string, "lcme_compr_type")) {
+					enum ll_compr_type ct;
+
+					for (ct = LL_COMPR_TYPE_NONE;
+					     ct < LL_COMPR_TYPE_MAX; ct++)
+						if (!strcmp(node->cy_valuestring,
+						    ll_compr_type2name(ct)))
+							break;
+					if (ct == LL_COMPR_TYPE_MAX)
+						return -EINVAL;
+					lsa->lsa_compr_type = ct;
 				}
 			} else if (node->cy_type == CYAML_TYPE_NUMBER) {
 				if (!strcmp(string, "lcm_mirror_count")) {
@@ -3457,6 +3482,7 @@ enum {
 	LFS_NEWERXY_OPT,
 	LFS_INHERIT_RR_OPT,
 	LFS_FIND_PERM,
+	LFS_COMPRESS_OPT,
 };
 
 #ifndef LCME_USER_MIRROR_FLAGS
@@ -3547,6 +3573,8 @@ static int lfs_setstripe_internal(int argc, char **argv,
 			.name = "mode",		.has_arg = required_argument},
 	{ .val = LFS_LAYOUT_COPY,
 			.name = "copy",		.has_arg = required_argument},
+	{ .val = LFS_COMPRESS_OPT,
+			.name = "compress",	.has_arg = required_argument},
 	{ .val = 'c',	.name = "stripe-count",	.has_arg = required_argument},
 	{ .val = 'c',	.name = "stripe_count",	.has_arg = required_argument},
 	{ .val = 'c',	.name = "mdt-count",	.has_arg = required_argument},
@@ -3646,6 +3674,22 @@ static int lfs_setstripe_internal(int argc, char **argv,
 		case LFS_COMP_NO_VERIFY_OPT:
 			mirror_flags |= MF_NO_VERIFY;
 			break;
+		case LFS_COMPRESS_OPT: {
+			enum ll_compr_type ct;
+
+			for (ct = LL_COMPR_TYPE_NONE; ct < LL_COMPR_TYPE_MAX;
+			     ct++)
+				if (strcmp(optarg, ll_compr_type2name(ct)) == 0)
+					break;
+			if (ct == LL_COMPR_TYPE_MAX) {
+				fprintf(stderr,
+					"%s %s: invalid compression type '%s'\n",
+					progname, argv[0], optarg);
+				goto usage_error;
+			}
+			lsa.lsa_compr_type = ct;
+			break;
+		}
 		case LFS_MIRROR_ID_OPT: {
 			unsigned long int id;
 
@@ -4151,6 +4195,10 @@ static int lfs_setstripe_internal(int argc, char **argv,
 			lsa.lsa_comp_end = LUSTRE_EOF;
 	}
 
+	/* the compression type is only stored in composite layouts */
+	if (lsa.lsa_compr_type != LL_COMPR_TYPE_NONE && lsa.lsa_comp_end == 0)
+		lsa.lsa_comp_end = LUSTRE_EOF;
+
 	if (lsa.lsa_comp_end != 0) {
 		result = comp_args_to_layout(lpp, &lsa, true);
 		if (result) {
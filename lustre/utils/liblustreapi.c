@@ -3565,6 +3565,17 @@ static void lov_dump_comp_v1_entry(struct find_param *param,
 
 		separator = "\n";
 	}
+	/* print compression type of a component compressing writes */
+	if ((verbose & VERBOSE_COMP_FLAGS) &&
+	    entry->lcme_compr_type != LL_COMPR_TYPE_NONE) {
+		llapi_printf(LLAPI_MSG_NORMAL, "%s", separator);
+		if (verbose & ~VERBOSE_COMP_FLAGS)
+			llapi_printf(LLAPI_MSG_NORMAL,
+				     "%4slcme_compr_type:     ", " ");
+		llapi_printf(LLAPI_MSG_NORMAL, "%s",
+			     ll_compr_type2name(entry->lcme_compr_type));
+		separator = "\n";
+	}
 
 	if (verbose & VERBOSE_COMP_START) {
 		llapi_printf(LLAPI_MSG_NORMAL, "%s", separator);
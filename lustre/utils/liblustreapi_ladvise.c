@@ -27,6 +27,7 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 #include <stdbool.h>
 #include <sys/time.h>
@@ -99,3 +100,55 @@ out:
 	return rc;
 }
 
+/*
+ * Advise the client to fetch the attributes of files in a directory ahead of
+ * stat(), in the order they will be stat'ed.
+ *
+ * \param dirfd   Directory the files are in.
+ * \param count   Number of names.
+ * \param names   Names of the files.
+ *
+ * \retval 0 on success.
+ * \retval -1 on failure, errno set
+ */
+int llapi_statahead_names(int dirfd, int count, const char **names)
+{
+	struct ll_statahead_names *lsn;
+	size_t size = 0;
+	char *ptr;
+	int rc;
+	int i;
+
+	if (count < 1) {
+		errno = EINVAL;
+		llapi_error(LLAPI_MSG_ERROR, -EINVAL,
+			    "bad name number %d", count);
+		return -1;
+	}
+
+	for (i = 0; i < count; i++)
+		size += strlen(names[i]) + 1;
+
+	lsn = calloc(1, sizeof(*lsn) + size);
+	if (lsn == NULL) {
+		errno = ENOMEM;
+		llapi_error(LLAPI_MSG_ERROR, -ENOMEM, "not enough memory");
+		return -1;
+	}
+	lsn->lsn_count = count;
+	lsn->lsn_size = size;
+
+	ptr = lsn->lsn_names;
+	for (i = 0; i < count; i++)
+		ptr = stpcpy(ptr, names[i]) + 1;
+
+	rc = ioctl(dirfd, LL_IOC_STATAHEAD_NAMES, lsn);
+	if (rc < 0)
+		llapi_error(LLAPI_MSG_ERROR, -errno,
+			    "cannot give statahead names");
+	else
+		rc = 0;
+
+	free(lsn);
+	return rc;
+}
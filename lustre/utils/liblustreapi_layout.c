@@ -37,6 +37,7 @@
 #include <assert.h>
 #include <sys/xattr.h>
 #include <sys/param.h>
+#include <sys/ioctl.h>
 
 #include <libcfs/util/list.h>
 #include <lustre/lustreapi.h>
@@ -61,6 +62,7 @@ struct llapi_layout_comp {
 	uint32_t		llc_id;		/* unique ID of component */
 	uint32_t		llc_flags;	/* LCME_FL_* flags */
 	uint64_t		llc_timestamp;	/* snapshot timestamp */
+	uint8_t			llc_compr_type;	/* enum ll_compr_type */
 	struct list_head	llc_list;	/* linked to the llapi_layout
 						   components list */
 	bool		llc_ondisk;
@@ -542,6 +544,7 @@ struct llapi_layout *llapi_layout_get_by_xattr(void *lov_xattr,
 			comp->llc_flags = ent->lcme_flags;
 			if (comp->llc_flags & LCME_FL_NOSYNC)
 				comp->llc_timestamp = ent->lcme_timestamp;
+			comp->llc_compr_type = ent->lcme_compr_type;
 		} else {
 			comp->llc_extent.e_start = 0;
 			comp->llc_extent.e_end = LUSTRE_EOF;
@@ -783,6 +786,7 @@ llapi_layout_to_lum(const struct llapi_layout *layout)
 			ent->lcme_flags = comp->llc_flags;
 			if (ent->lcme_flags & LCME_FL_NOSYNC)
 				ent->lcme_timestamp = comp->llc_timestamp;
+			ent->lcme_compr_type = comp->llc_compr_type;
 			ent->lcme_extent.e_start = comp->llc_extent.e_start;
 			ent->lcme_extent.e_end = comp->llc_extent.e_end;
 			ent->lcme_size = blob_size;
@@ -1818,6 +1822,67 @@ int llapi_layout_comp_extent_set(struct llapi_layout *layout,
 	return 0;
 }
 
+/**
+ * Gets the compression type of BRW writes of the current component.
+ *
+ * \param[in] layout	the layout component
+ * \param[out] type	stored the returned enum ll_compr_type
+ *
+ * \retval	0 on success
+ * \retval	<0 if error occurs
+ */
+int llapi_layout_compress_get(const struct llapi_layout *layout,
+			      enum ll_compr_type *type)
+{
+	struct llapi_layout_comp *comp;
+
+	comp = __llapi_layout_cur_comp(layout);
+	if (comp == NULL)
+		return -1;
+
+	if (type == NULL) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	*type = comp->llc_compr_type;
+
+	return 0;
+}
+
+/**
+ * Sets the compression type of BRW writes of the current component.
+ *
+ * The compression type is stored in the component entry, so this makes
+ * the layout composite.
+ *
+ * \param[in] layout	the layout component
+ * \param[in] type	enum ll_compr_type to set
+ *
+ * \retval	0 on success
+ * \retval	<0 if error occurs
+ */
+int llapi_layout_compress_set(struct llapi_layout *layout,
+			      enum ll_compr_type type)
+{
+	struct llapi_layout_comp *comp;
+
+	comp = __llapi_layout_cur_comp(layout);
+	if (comp == NULL)
+		return -1;
+
+	if (type >= LL_COMPR_TYPE_MAX) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	comp->llc_compr_type = type;
+	if (type != LL_COMPR_TYPE_NONE)
+		layout->llot_is_composite = true;
+
+	return 0;
+}
+
 /**
  * Gets the attribute flags of the current component.
  *
@@ -3631,3 +3696,50 @@ int llapi_get_lum_dir(const char *path, __u64 *valid, lstatx_t *statx,
 	close(dir_fd);
 	return rc;
 }
+
+/**
+ * Read the entries of a directory with their lazy attributes, without a
+ * getattr RPC per entry if the MDT supports readdir-plus.
+ *
+ * \param dir_fd	Directory to read.
+ * \param offset	Directory hash to start from, 0 for the first call.
+ *			Updated to the hash to continue from, LUSTRE_EOF
+ *			once all the entries were read.
+ * \param buf		Buffer for struct ll_readdir_plus_ent records, the
+ *			next record is lrpe_reclen bytes after the previous.
+ * \param size		Size of \a buf in bytes.
+ *
+ * \retval		number of entries in \a buf, 0 at the end of the
+ *			directory
+ * \retval		negative errno on failure, -EOVERFLOW if \a buf is too
+ *			small for a single entry
+ */
+int llapi_readdir_plus(int dir_fd, __u64 *offset, void *buf, size_t size)
+{
+	struct ll_readdir_plus *lrp;
+	int rc;
+
+	if (size > UINT_MAX)
+		size = UINT_MAX & ~7U;
+
+	lrp = malloc(sizeof(*lrp) + size);
+	if (lrp == NULL)
+		return -ENOMEM;
+
+	lrp->lrp_offset = *offset;
+	lrp->lrp_size = size;
+	lrp->lrp_count = 0;
+
+	rc = ioctl(dir_fd, LL_IOC_READDIR_PLUS, lrp);
+	if (rc < 0) {
+		rc = -errno;
+		goto out;
+	}
+
+	memcpy(buf, lrp->lrp_buf, size);
+	*offset = lrp->lrp_offset;
+	rc = lrp->lrp_count;
+out:
+	free(lrp);
+	return rc;
+}
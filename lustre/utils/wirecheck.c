@@ -321,6 +321,8 @@ check_lu_dirent(void)
 	CHECK_VALUE_X(LUDA_FID);
 	CHECK_VALUE_X(LUDA_TYPE);
 	CHECK_VALUE_X(LUDA_64BITHASH);
+	CHECK_VALUE_X(LUDA_ATTRS);
+	CHECK_VALUE_X(LUDA_LAYOUT);
 }
 
 static void
@@ -331,6 +333,27 @@ check_luda_type(void)
 	CHECK_MEMBER(luda_type, lt_type);
 }
 
+static void
+check_luda_attrs(void)
+{
+	BLANK_LINE();
+	CHECK_STRUCT(luda_attrs);
+	CHECK_MEMBER(luda_attrs, lda_valid);
+	CHECK_MEMBER(luda_attrs, lda_size);
+	CHECK_MEMBER(luda_attrs, lda_blocks);
+	CHECK_MEMBER(luda_attrs, lda_atime);
+	CHECK_MEMBER(luda_attrs, lda_mtime);
+	CHECK_MEMBER(luda_attrs, lda_ctime);
+	CHECK_MEMBER(luda_attrs, lda_mode);
+	CHECK_MEMBER(luda_attrs, lda_uid);
+	CHECK_MEMBER(luda_attrs, lda_gid);
+	CHECK_MEMBER(luda_attrs, lda_nlink);
+	CHECK_MEMBER(luda_attrs, lda_flags);
+	CHECK_MEMBER(luda_attrs, lda_projid);
+	CHECK_MEMBER(luda_attrs, lda_lmm_size);
+	CHECK_MEMBER(luda_attrs, lda_padding);
+}
+
 static void
 check_lu_dirpage(void)
 {
@@ -642,6 +665,9 @@ check_obd_connect_data(void)
 	CHECK_DEFINE_64X(OBD_CONNECT2_BATCH_RPC);
 	CHECK_DEFINE_64X(OBD_CONNECT2_PCCRO);
 	CHECK_DEFINE_64X(OBD_CONNECT2_ATOMIC_OPEN_LOCK);
+	CHECK_DEFINE_64X(OBD_CONNECT2_WIRE_COMPRESS);
+	CHECK_DEFINE_64X(OBD_CONNECT2_READDIR_PLUS);
+	CHECK_DEFINE_64X(OBD_CONNECT2_MSG_BATCH);
 
 	CHECK_VALUE_X(OBD_CKSUM_CRC32);
 	CHECK_VALUE_X(OBD_CKSUM_ADLER);
@@ -698,7 +724,7 @@ check_obdo(void)
 	CHECK_MEMBER(obdo, o_gid_h);
 	CHECK_MEMBER(obdo, o_data_version);
 	CHECK_MEMBER(obdo, o_projid);
-	CHECK_MEMBER(obdo, o_padding_4);
+	CHECK_MEMBER(obdo, o_compr_nob);
 	CHECK_MEMBER(obdo, o_padding_5);
 	CHECK_MEMBER(obdo, o_padding_6);
 
@@ -781,6 +807,7 @@ check_obdo(void)
 	CHECK_CVALUE_X(OBD_FL_NOSPC_BLK);
 	CHECK_CVALUE_X(OBD_FL_FLUSH);
 	CHECK_CVALUE_X(OBD_FL_SHORT_IO);
+	CHECK_CVALUE_X(OBD_FL_COMPRESSED);
 }
 
 static void
@@ -844,7 +871,9 @@ check_lov_comp_md_entry_v1(void)
 	CHECK_MEMBER(lov_comp_md_entry_v1, lcme_size);
 	CHECK_MEMBER(lov_comp_md_entry_v1, lcme_layout_gen);
 	CHECK_MEMBER(lov_comp_md_entry_v1, lcme_timestamp);
+	CHECK_MEMBER(lov_comp_md_entry_v1, lcme_compr_type);
 	CHECK_MEMBER(lov_comp_md_entry_v1, lcme_padding_1);
+	CHECK_MEMBER(lov_comp_md_entry_v1, lcme_padding_2);
 
 	CHECK_CVALUE_X(LCME_FL_STALE);
 	CHECK_CVALUE_X(LCME_FL_PREF_RD);
@@ -1091,6 +1120,24 @@ check_niobuf_remote(void)
 	CHECK_DEFINE_X(OBD_BRW_SYS_RESOURCE);
 }
 
+static void
+check_ll_compr_chunk_hdr(void)
+{
+	BLANK_LINE();
+	CHECK_STRUCT(ll_compr_chunk_hdr);
+	CHECK_MEMBER(ll_compr_chunk_hdr, lcch_magic);
+	CHECK_MEMBER(ll_compr_chunk_hdr, lcch_type);
+	CHECK_MEMBER(ll_compr_chunk_hdr, lcch_padding_1);
+	CHECK_MEMBER(ll_compr_chunk_hdr, lcch_padding_2);
+	CHECK_MEMBER(ll_compr_chunk_hdr, lcch_uncompr_size);
+	CHECK_MEMBER(ll_compr_chunk_hdr, lcch_compr_size);
+	CHECK_CDEFINE(LL_COMPR_CHUNK_MAGIC);
+	CHECK_CDEFINE(LL_COMPR_CHUNK_SIZE);
+	CHECK_VALUE(LL_COMPR_TYPE_NONE);
+	CHECK_VALUE(LL_COMPR_TYPE_LZ4);
+	CHECK_VALUE(LL_COMPR_TYPE_ZSTD);
+}
+
 static void
 check_ost_body(void)
 {
@@ -2539,6 +2586,31 @@ static void check_out_update_buffer(void)
 	CHECK_MEMBER(out_update_buffer, oub_padding);
 }
 
+static void check_msg_batch_header(void)
+{
+	BLANK_LINE();
+	CHECK_STRUCT(msg_batch_header);
+	CHECK_MEMBER(msg_batch_header, mbh_magic);
+	CHECK_MEMBER(msg_batch_header, mbh_count);
+	CHECK_MEMBER(msg_batch_header, mbh_reply_size);
+	CHECK_MEMBER(msg_batch_header, mbh_padding);
+
+	CHECK_CDEFINE(MSG_BATCH_HEADER_MAGIC);
+	CHECK_CDEFINE(MSG_BATCH_MAX_COUNT);
+}
+
+static void check_msg_batch_reply(void)
+{
+	BLANK_LINE();
+	CHECK_STRUCT(msg_batch_reply);
+	CHECK_MEMBER(msg_batch_reply, mbr_magic);
+	CHECK_MEMBER(msg_batch_reply, mbr_count);
+	CHECK_MEMBER(msg_batch_reply, mbr_padding);
+	CHECK_MEMBER(msg_batch_reply, mbr_repmsg);
+
+	CHECK_CDEFINE(MSG_BATCH_REPLY_MAGIC);
+}
+
 static void check_nodemap_cluster_rec(void)
 {
 	BLANK_LINE();
@@ -2888,6 +2960,9 @@ main(int argc, char **argv)
 	CHECK_VALUE(MDS_HSM_CT_UNREGISTER);
 	CHECK_VALUE(MDS_SWAP_LAYOUTS);
 	CHECK_VALUE(MDS_RMFID);
+	CHECK_VALUE(MDS_BATCH);
+	CHECK_VALUE(MDS_HSM_DATA_VERSION);
+	CHECK_VALUE(MDS_MSG_BATCH);
 	CHECK_VALUE(MDS_LAST_OPC);
 
 	CHECK_VALUE(REINT_SETATTR);
@@ -3058,6 +3133,7 @@ main(int argc, char **argv)
 	check_ost_id();
 	check_lu_dirent();
 	check_luda_type();
+	check_luda_attrs();
 	check_lu_dirpage();
 	check_lu_ladvise();
 	check_ladvise_hdr();
@@ -3083,6 +3159,7 @@ main(int argc, char **argv)
 	printf("#endif /* HAVE_SERVER_SUPPORT */\n");
 #endif /* !HAVE_NATIVE_LINUX_CLIENT */
 	check_niobuf_remote();
+	check_ll_compr_chunk_hdr();
 	check_ost_body();
 	check_ll_fid();
 	check_mds_op_bias();
@@ -3185,6 +3262,8 @@ printf("#endif /* HAVE_SERVER_SUPPORT */\n");
 	check_object_update_reply();
 	check_out_update_header();
 	check_out_update_buffer();
+	check_msg_batch_header();
+	check_msg_batch_reply();
 
 	check_nodemap_cluster_rec();
 	check_nodemap_range_rec();